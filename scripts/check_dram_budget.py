@@ -0,0 +1,37 @@
+import sys
+from pathlib import Path
+
+Import("env")
+
+sys.path.insert(0, str(Path(env["PROJECT_DIR"]) / "scripts"))
+import dram_report  # noqa: E402
+
+
+# Larger installations (custom_chromance_wiring) scale the per-LED buffers; such envs can raise the budgets:
+#   custom_dram_budget = 160000
+#   custom_dram_symbol_budget = 32768
+TOTAL_BUDGET = int(env.GetProjectOption("custom_dram_budget", str(dram_report.DRAM_BUDGET_BYTES)), 0)
+SYMBOL_BUDGET = int(env.GetProjectOption("custom_dram_symbol_budget", str(dram_report.SYMBOL_BUDGET_BYTES)), 0)
+
+
+def _objdump() -> str:
+    # Same toolchain directory and prefix as the compiler (xtensa-esp32-elf-gcc -> xtensa-esp32-elf-objdump).
+    cc = env.subst("$CC")
+    return cc[: -len("gcc")] + "objdump" if cc.endswith("gcc") else "objdump"
+
+
+def _check(target, source, env):
+    elf = Path(str(target[0]))
+    report = dram_report.read_report(elf, env.WhereIs(_objdump()) or _objdump())
+    text = dram_report.format_report(report, total_budget=TOTAL_BUDGET)
+    out = elf.parent / "dram_report.txt"
+    out.write_text(text + "\n")
+
+    print(dram_report.format_report(report, total_budget=TOTAL_BUDGET, top=15))
+    print(f"DRAM report: {out}")
+    errors = dram_report.check_budgets(report, total_budget=TOTAL_BUDGET, symbol_budget=SYMBOL_BUDGET)
+    if errors:
+        raise RuntimeError("DRAM budget exceeded:\n  " + "\n  ".join(errors))
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", _check)
@@ -12,6 +12,7 @@ def _find_partition_csv() -> Path:
     name = env.GetProjectOption("board_build.partitions")
     packages = Path(env["PROJECT_PACKAGES_DIR"])
     candidates = [
+        Path(env["PROJECT_DIR"]) / name,  # project-local tables such as partitions_mapping.csv
         packages / "framework-arduinoespressif32" / "tools" / "partitions" / name,
         packages / "framework-arduinoespressif32" / "tools" / "partitions" / "default.csv",
     ]
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+Static DRAM report and budget check for a linked firmware ELF.
+
+Lists every data object the linker placed in DRAM (initialized data and zero-initialized bss), largest first,
+with per-section totals, and checks them against budgets:
+  - the total static DRAM (framework included), which is what the heap has to give up;
+  - each of our own objects (chromance:: and anonymous-namespace symbols), by default SYMBOL_BUDGET_BYTES, or
+    its entry in SYMBOL_BUDGETS.
+
+Framework objects count toward the total only. PlatformIO runs this after every firmware link
+(scripts/check_dram_budget.py); by hand:
+  python3 scripts/dram_report.py .pio/build/runtime/firmware.elf --objdump xtensa-esp32-elf-objdump
+"""
+
+from __future__ import annotations
+
+import argparse
+import re
+import subprocess
+import sys
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Dict, List, Optional, Sequence, Tuple
+
+
+# ESP32 data RAM sections: .dram0.data (initialized, copied from flash at boot), .dram0.bss and .noinit.
+DRAM_SECTION_PREFIXES: Tuple[str, ...] = (".dram0.", ".noinit")
+
+# Total static DRAM, framework included. The ESP32 has ~320 KiB of data RAM; WiFi, lwIP, the web server and
+# ArduinoJson documents allocate from what static data leaves over.
+DRAM_BUDGET_BYTES = 128 * 1024
+# Any one of our objects without its own entry below.
+SYMBOL_BUDGET_BYTES = 16 * 1024
+# Demangled names of our biggest fixed-size objects, budgeted close to their size so growth shows up in review.
+SYMBOL_BUDGETS: Dict[str, int] = {
+    "(anonymous namespace)::control_channel": 12 * 1024,
+    "(anonymous namespace)::audio_in": 12 * 1024,
+    "(anonymous namespace)::effect_catalog": 2 * 1024,
+    "(anonymous namespace)::webui": 4 * 1024,
+}
+
+_SECTION_RE = re.compile(r"^\s*\d+\s+(\S+)\s+([0-9a-fA-F]+)\s+[0-9a-fA-F]+\s+[0-9a-fA-F]+\s+[0-9a-fA-F]+\s")
+_SYMBOL_RE = re.compile(r"^[0-9a-fA-F]+\s(.{7})\s(\S+)\s+([0-9a-fA-F]+)\s+(.+)$")
+
+
+@dataclass(frozen=True)
+class DramObject:
+    name: str
+    section: str
+    size: int
+
+
+@dataclass(frozen=True)
+class DramReport:
+    sections: Dict[str, int]  # DRAM section -> size from the section headers
+    objects: List[DramObject]  # largest first
+
+    @property
+    def total(self) -> int:
+        return sum(self.sections.values())
+
+
+def is_dram_section(name: str, prefixes: Sequence[str] = DRAM_SECTION_PREFIXES) -> bool:
+    return any(name == p or name.startswith(p) for p in prefixes)
+
+
+def parse_objdump(text: str, prefixes: Sequence[str] = DRAM_SECTION_PREFIXES) -> DramReport:
+    """Parses `objdump -h -t -w -C` output."""
+    sections: Dict[str, int] = {}
+    objects: List[DramObject] = []
+    in_symbols = False
+    for line in text.splitlines():
+        if line.startswith("SYMBOL TABLE"):
+            in_symbols = True
+            continue
+        if not in_symbols:
+            m = _SECTION_RE.match(line)
+            if m and is_dram_section(m.group(1), prefixes):
+                sections[m.group(1)] = sections.get(m.group(1), 0) + int(m.group(2), 16)
+            continue
+        m = _SYMBOL_RE.match(line)
+        if not m or "O" not in m.group(1) or not is_dram_section(m.group(2), prefixes):
+            continue
+        size = int(m.group(3), 16)
+        if size > 0:
+            objects.append(DramObject(name=m.group(4).strip(), section=m.group(2), size=size))
+    objects.sort(key=lambda o: (-o.size, o.name))
+    return DramReport(sections=sections, objects=objects)
+
+
+def is_own_symbol(name: str) -> bool:
+    return name.startswith("(anonymous namespace)::") or "chromance::" in name
+
+
+def check_budgets(
+    report: DramReport,
+    *,
+    total_budget: int = DRAM_BUDGET_BYTES,
+    symbol_budget: int = SYMBOL_BUDGET_BYTES,
+    symbol_budgets: Optional[Dict[str, int]] = None,
+) -> List[str]:
+    """Returns one message per exceeded budget (empty when everything fits)."""
+    budgets = SYMBOL_BUDGETS if symbol_budgets is None else symbol_budgets
+    errors: List[str] = []
+    if report.total > total_budget:
+        errors.append(f"static DRAM {report.total} B exceeds budget {total_budget} B")
+    for o in report.objects:
+        limit = budgets.get(o.name, symbol_budget if is_own_symbol(o.name) else None)
+        if limit is not None and o.size > limit:
+            errors.append(f"{o.name} ({o.section}) is {o.size} B, budget {limit} B")
+    return errors
+
+
+def format_report(report: DramReport, *, total_budget: int = DRAM_BUDGET_BYTES, top: Optional[int] = None) -> str:
+    lines = [f"static DRAM: {report.total} B of {total_budget} B budget"]
+    for name, size in sorted(report.sections.items()):
+        lines.append(f"  {name:<14} {size:>8}")
+    listed = report.objects if top is None else report.objects[:top]
+    lines.append(f"objects ({len(listed)} of {len(report.objects)}, largest first):")
+    for o in listed:
+        lines.append(f"  {o.size:>8}  {o.section:<14} {o.name}")
+    return "\n".join(lines)
+
+
+def read_report(elf: Path, objdump: str = "objdump", prefixes: Sequence[str] = DRAM_SECTION_PREFIXES) -> DramReport:
+    text = subprocess.run([objdump, "-h", "-t", "-w", "-C", str(elf)], check=True, capture_output=True, text=True)
+    return parse_objdump(text.stdout, prefixes)
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("elf", type=Path, help="Linked firmware ELF")
+    ap.add_argument("--objdump", default="objdump", help="objdump for the ELF's target (xtensa-esp32-elf-objdump)")
+    ap.add_argument("--sections", nargs="+", default=list(DRAM_SECTION_PREFIXES), help="DRAM section prefixes")
+    ap.add_argument("--budget", type=int, default=DRAM_BUDGET_BYTES, help="Total static DRAM budget (bytes)")
+    ap.add_argument("--symbol-budget", type=int, default=SYMBOL_BUDGET_BYTES, help="Per-object budget (bytes)")
+    ap.add_argument("--top", type=int, default=30, help="Objects to list (0 = all)")
+    args = ap.parse_args()
+
+    report = read_report(args.elf, args.objdump, args.sections)
+    print(format_report(report, total_budget=args.budget, top=args.top or None))
+    errors = check_budgets(report, total_budget=args.budget, symbol_budget=args.symbol_budget)
+    for e in errors:
+        print(f"DRAM budget exceeded: {e}", file=sys.stderr)
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
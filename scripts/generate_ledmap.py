@@ -11,12 +11,25 @@ Output:
 Wiring JSON format (minimal):
 {
   "strips": [
-    { "name": "strip1", "segments": [ {"seg": 1, "dir": "a_to_b"}, {"seg": 2, "dir": "b_to_a"} ] },
+    { "name": "strip1", "pins": {"data": 23, "clock": 22},
+      "segments": [ {"seg": 1, "dir": "a_to_b"}, {"seg": 2, "dir": "b_to_a"} ] },
     { "name": "strip2", "segments": [ ... ] }
   ]
 }
 
 Where seg is 1..40 referencing SEGMENTS below, and dir selects which endpoint is LED0->LED13.
+"pins" is optional; strips without it are emitted with pin 255 (not driven).
+
+Multi-panel installations add a "panels" list of vertex-grid offsets:
+  "panels": [ {"offset": [0, 0]}, {"offset": [6, 2]} ]
+Panel p contributes SEGMENTS shifted by its offset as segment ids p*40+1..p*40+40; vertices that coincide
+across panels are shared. Without "panels" the topology is the single canonical panel.
+
+Walls driven by several controllers add a "nodes" list that splits the strips between them:
+  "nodes": [ {"name": "top", "strips": ["strip1", "strip2"]}, {"name": "bottom", "strips": ["strip3"]} ]
+Each node drives a run of consecutive strips (so its LEDs are one global index range), and every strip belongs
+to exactly one node. --out-node-headers writes one header per node: the full global tables, with only that
+node's strips pinned, plus its LED range and per-segment roles (its own, halo, another node's).
 """
 
 from __future__ import annotations
@@ -24,16 +37,33 @@ from __future__ import annotations
 import argparse
 import json
 import math
-from dataclasses import dataclass
+import re
+import struct
+from dataclasses import dataclass, replace
 from pathlib import Path
-from typing import Dict, Iterable, List, Sequence, Tuple
+from typing import Dict, Iterable, List, Optional, Sequence, Tuple
 
 
 LEDS_PER_SEGMENT = 14
+UNASSIGNED_PIN = 255
+# Segment and vertex ids are uint8_t in the generated tables, and 255 is the "no vertex" sentinel in core.
+MAX_TOPOLOGY_IDS = 254
+# Per-segment node roles (core/mapping/node_partition.h).
+ROLE_REMOTE = 0
+ROLE_LOCAL = 1
+ROLE_HALO = 2
+# Raster units per vertex grid step (x, y).
+RASTER_SCALE = (28, 14)
+# Mapping blob (core/mapping/mapping_blob.h): the header's tables as a flash image loaded at boot.
+BLOB_VERSION = 1
+BLOB_HEADER_BYTES = 72
+BLOB_VERSION_STRING_BYTES = 32
+
+Segment = Tuple[Tuple[int, int], Tuple[int, int]]
 
 # Segment topology list (40 undirected edges) in vertex coordinates (vx, vy).
 # Endpoints are labeled (a, b); wiring chooses direction a_to_b vs b_to_a.
-SEGMENTS: List[Tuple[Tuple[int, int], Tuple[int, int]]] = [
+SEGMENTS: List[Segment] = [
     ((0, 1), (0, 3)),
     ((0, 1), (1, 0)),
     ((0, 1), (1, 2)),
@@ -79,20 +109,43 @@ SEGMENTS: List[Tuple[Tuple[int, int], Tuple[int, int]]] = [
 
 @dataclass(frozen=True)
 class SegmentRef:
-    seg: int  # 1..40
+    seg: int  # 1..SEGMENT_COUNT
     direction: str  # "a_to_b" or "b_to_a"
 
 @dataclass(frozen=True)
 class OrderedSegment:
-    seg: int  # 1..40
+    seg: int  # 1..SEGMENT_COUNT
     direction: str  # "a_to_b" or "b_to_a"
     strip_index: int  # 0-based, per wiring file order
     segment_index_in_strip: int  # 0-based, per wiring file order
 
+@dataclass(frozen=True)
+class StripInfo:
+    segment_count: int
+    data_pin: int
+    clock_pin: int
+    name: str = ""
+
+@dataclass(frozen=True)
+class NodeInfo:
+    name: str
+    first_strip: int
+    strip_count: int
+
+@dataclass(frozen=True)
+class NodeView:
+    index: int
+    count: int
+    name: str
+    led_first: int
+    led_count: int
+    strip_node: List[int]  # per strip
+    seg_role: List[int]  # per segment id, index 0 unused
+
 
 def vertex_to_raster(vx: int, vy: int) -> Tuple[int, int]:
     # Default deterministic projection (see docs/architecture/wled_integration_preplan.md).
-    return (28 * vx, 14 * vy)
+    return (RASTER_SCALE[0] * vx, RASTER_SCALE[1] * vy)
 
 def round_half_away_from_zero(v: float) -> int:
     # Python's built-in round() uses bankers rounding (ties-to-even), which can
@@ -113,23 +166,164 @@ def sample_segment_pixels(p0: Tuple[int, int], p1: Tuple[int, int]) -> List[Tupl
     return out
 
 
-def parse_wiring(path: Path) -> Tuple[str, bool, List[OrderedSegment]]:
+def build_topology(offsets: Sequence[Tuple[int, int]]) -> List[Segment]:
+    topology: List[Segment] = []
+    seen: Dict[Tuple[Tuple[int, int], Tuple[int, int]], int] = {}
+    for (dx, dy) in offsets:
+        for (va, vb) in SEGMENTS:
+            a = (va[0] + dx, va[1] + dy)
+            b = (vb[0] + dx, vb[1] + dy)
+            key = (min(a, b), max(a, b))
+            if key in seen:
+                raise ValueError(f"panel offsets overlap: segment {len(topology) + 1} duplicates {seen[key]}")
+            seen[key] = len(topology) + 1
+            topology.append((a, b))
+
+    vertices = {v for seg in topology for v in seg}
+    if len(topology) > MAX_TOPOLOGY_IDS or len(vertices) > MAX_TOPOLOGY_IDS:
+        raise ValueError(f"topology too large: {len(topology)} segments, {len(vertices)} vertices")
+    if any(not (-128 <= c <= 127) for v in vertices for c in v):
+        raise ValueError("panel offsets move vertices outside the int8 vertex grid")
+    return topology
+
+
+def parse_panels(data: dict) -> List[Tuple[int, int]]:
+    panels = data.get("panels")
+    if panels is None:
+        return [(0, 0)]
+    if not isinstance(panels, list) or not panels:
+        raise ValueError("'panels' must be a non-empty list")
+    offsets: List[Tuple[int, int]] = []
+    for p in panels:
+        off = p.get("offset")
+        if not isinstance(off, list) or len(off) != 2:
+            raise ValueError("each panel must have 'offset': [dvx, dvy]")
+        offsets.append((int(off[0]), int(off[1])))
+    return offsets
+
+
+def parse_pin(strip: dict, name: str) -> int:
+    pins = strip.get("pins")
+    if pins is None:
+        return UNASSIGNED_PIN
+    pin = int(pins[name])
+    if not (0 <= pin < UNASSIGNED_PIN):
+        raise ValueError(f"invalid {name} pin {pin} for strip {strip.get('name')}")
+    return pin
+
+
+def parse_nodes(data: dict, strips: Sequence[StripInfo]) -> List[NodeInfo]:
+    nodes = data.get("nodes")
+    if nodes is None:
+        return []
+    if not isinstance(nodes, list) or not nodes or len(nodes) > 32:
+        raise ValueError("'nodes' must be a list of 1..32 nodes")
+    strip_index = {s.name: i for i, s in enumerate(strips)}
+    if len(strip_index) != len(strips):
+        raise ValueError("strip names must be unique when 'nodes' are used")
+    out: List[NodeInfo] = []
+    next_strip = 0
+    for n in nodes:
+        name = str(n.get("name", ""))
+        if not re.fullmatch(r"[a-z][a-z0-9_]{0,15}", name) or any(o.name == name for o in out):
+            raise ValueError(f"node names must be unique lowercase identifiers: {name!r}")
+        names = n.get("strips")
+        if not isinstance(names, list) or not names:
+            raise ValueError(f"node {name} must list its 'strips'")
+        indices = []
+        for strip_name in names:
+            if strip_name not in strip_index:
+                raise ValueError(f"node {name} references unknown strip {strip_name!r}")
+            indices.append(strip_index[strip_name])
+        if indices != list(range(next_strip, next_strip + len(indices))):
+            raise ValueError(f"node {name} must drive the next consecutive strips in wiring order")
+        out.append(NodeInfo(name=name, first_strip=next_strip, strip_count=len(indices)))
+        next_strip += len(indices)
+    if next_strip != len(strips):
+        raise ValueError(f"strips not assigned to a node: {[s.name for s in strips[next_strip:]]}")
+    return out
+
+
+def build_node_view(
+    topology: Sequence[Segment],
+    strips: Sequence[StripInfo],
+    ordered: Sequence[OrderedSegment],
+    nodes: Sequence[NodeInfo],
+    index: int,
+) -> NodeView:
+    # Without nodes the wall is one node driving every strip.
+    if not nodes:
+        nodes = [NodeInfo(name="", first_strip=0, strip_count=len(strips))]
+    strip_node = [0] * len(strips)
+    for n, node in enumerate(nodes):
+        for s in range(node.first_strip, node.first_strip + node.strip_count):
+            strip_node[s] = n
+
+    seg_node = [-1] * (len(topology) + 1)
+    for os in ordered:
+        seg_node[os.seg] = strip_node[os.strip_index]
+    seg_role = [ROLE_LOCAL if seg_node[seg] == index else ROLE_REMOTE for seg in range(len(topology) + 1)]
+    seg_role[0] = ROLE_REMOTE
+
+    # Halo: wired segments of other nodes that share a vertex with one of ours. Effects that spread along the
+    # topology (wavefronts, comets) cross the node boundary through these.
+    local_vertices = {v for seg, role in enumerate(seg_role) if role == ROLE_LOCAL for v in topology[seg - 1]}
+    for seg in range(1, len(topology) + 1):
+        if seg_node[seg] not in (-1, index) and any(v in local_vertices for v in topology[seg - 1]):
+            seg_role[seg] = ROLE_HALO
+
+    leds = [i for i, os in enumerate(ordered) if strip_node[os.strip_index] == index]
+    led_first = leds[0] * LEDS_PER_SEGMENT if leds else 0
+    return NodeView(
+        index=index,
+        count=len(nodes),
+        name=nodes[index].name,
+        led_first=led_first,
+        led_count=len(leds) * LEDS_PER_SEGMENT,
+        strip_node=strip_node,
+        seg_role=seg_role,
+    )
+
+
+def node_strips(strips: Sequence[StripInfo], view: NodeView) -> List[StripInfo]:
+    # A node only drives its own strips; the others stay in the tables (global indices) without pins.
+    return [
+        s if view.strip_node[i] == view.index else replace(s, data_pin=UNASSIGNED_PIN, clock_pin=UNASSIGNED_PIN)
+        for i, s in enumerate(strips)
+    ]
+
+
+def parse_wiring(
+    path: Path,
+) -> Tuple[str, bool, List[Segment], List[StripInfo], List[OrderedSegment], List[NodeInfo]]:
     data = json.loads(path.read_text())
     mapping_version = str(data.get("mappingVersion", ""))
     is_bench_subset = bool(data.get("isBenchSubset", False))
+    topology = build_topology(parse_panels(data))
     strips = data.get("strips")
     if not isinstance(strips, list) or not strips:
         raise ValueError("wiring JSON must contain non-empty 'strips' list")
+    if len(strips) > 127:
+        raise ValueError("at most 127 strips are supported")
 
     ordered: List[OrderedSegment] = []
+    strip_infos: List[StripInfo] = []
     for strip_index, strip in enumerate(strips):
         segs = strip.get("segments")
         if not isinstance(segs, list) or not segs:
             raise ValueError("each strip must contain non-empty 'segments' list")
+        strip_infos.append(
+            StripInfo(
+                segment_count=len(segs),
+                data_pin=parse_pin(strip, "data"),
+                clock_pin=parse_pin(strip, "clock"),
+                name=str(strip.get("name", f"strip{strip_index + 1}")),
+            )
+        )
         for segment_index_in_strip, s in enumerate(segs):
             seg = int(s["seg"])
             direction = str(s["dir"])
-            if seg < 1 or seg > len(SEGMENTS):
+            if seg < 1 or seg > len(topology):
                 raise ValueError(f"segment id out of range: {seg}")
             if direction not in ("a_to_b", "b_to_a"):
                 raise ValueError(f"invalid dir for seg {seg}: {direction}")
@@ -147,20 +341,56 @@ def parse_wiring(path: Path) -> Tuple[str, bool, List[OrderedSegment]]:
         dupes = sorted({s for s in used if used.count(s) > 1})
         raise ValueError(f"wiring contains duplicate segment ids: dupes={dupes}")
     if not is_bench_subset:
-        if len(set(used)) != len(SEGMENTS):
-            missing = sorted(set(range(1, len(SEGMENTS) + 1)) - set(used))
+        if len(set(used)) != len(topology):
+            missing = sorted(set(range(1, len(topology) + 1)) - set(used))
             raise ValueError(f"wiring must reference each segment exactly once; missing={missing}")
     else:
         if not used:
             raise ValueError("bench wiring must reference at least one segment")
 
-    return mapping_version, is_bench_subset, ordered
+    if len(ordered) * LEDS_PER_SEGMENT > 65535:
+        raise ValueError("LED count exceeds uint16_t indexing")
+
+    return mapping_version, is_bench_subset, topology, strip_infos, ordered, parse_nodes(data, strip_infos)
 
 
-def build_pixels(ordered: Sequence[OrderedSegment]) -> List[Tuple[int, int]]:
+def interpolate_raster(a: int, b: int, pos: int) -> int:
+    # sample_segment_pixels() in exact integer arithmetic, as core/mapping/compact_mapping.h decodes it.
+    den = 2 * LEDS_PER_SEGMENT
+    num = den * a + (2 * pos + 1) * (b - a)
+    return (2 * num + den) // (2 * den) if num >= 0 else -((-2 * num + den) // (2 * den))
+
+
+def build_segment_runs(ordered: Sequence[OrderedSegment]) -> List[int]:
+    # One word per wired segment, in global LED order (see core/mapping/compact_mapping.h).
+    runs: List[int] = []
+    for os in ordered:
+        local_base = os.segment_index_in_strip * LEDS_PER_SEGMENT
+        if os.seg > 255 or os.strip_index > 127 or local_base > 65535:
+            raise ValueError("segment_runs field overflow")
+        d = 0 if os.direction == "a_to_b" else 1
+        runs.append(os.seg | (os.strip_index << 8) | (d << 15) | (local_base << 16))
+    return runs
+
+
+def decode_segment_run_pixels(
+    topology: Sequence[Segment], run: int, origin: Tuple[int, int], wire_order: bool = False
+) -> List[Tuple[int, int]]:
+    (va, vb) = topology[(run & 0xFF) - 1]
+    a = vertex_to_raster(*va)
+    b = vertex_to_raster(*vb)
+    out: List[Tuple[int, int]] = []
+    for k in range(LEDS_PER_SEGMENT):
+        # Strip-local order runs from vertex A; index order runs from the segment's entry end.
+        pos = LEDS_PER_SEGMENT - 1 - k if (run >> 15) & 1 and not wire_order else k
+        out.append((interpolate_raster(a[0], b[0], pos) - origin[0], interpolate_raster(a[1], b[1], pos) - origin[1]))
+    return out
+
+
+def build_pixels(topology: Sequence[Segment], ordered: Sequence[OrderedSegment]) -> List[Tuple[int, int]]:
     pixels: List[Tuple[int, int]] = []
     for os in ordered:
-        (va, vb) = SEGMENTS[os.seg - 1]
+        (va, vb) = topology[os.seg - 1]
         a = vertex_to_raster(*va)
         b = vertex_to_raster(*vb)
         pts = sample_segment_pixels(a, b)
@@ -170,6 +400,27 @@ def build_pixels(ordered: Sequence[OrderedSegment]) -> List[Tuple[int, int]]:
     return pixels
 
 
+def renumber_in_wire_order(
+    global_to_strip: Sequence[int], global_to_local: Sequence[int], strips: Sequence[StripInfo]
+) -> List[int]:
+    # Wire order: global index = the LEDs on earlier strips + strip-local index, so every strip is one contiguous
+    # span of the framebuffer. Returns new_index[old_index]; per-LED tables move with their LED.
+    strip_first = [0] * len(strips)
+    for s in range(1, len(strips)):
+        strip_first[s] = strip_first[s - 1] + strips[s - 1].segment_count * LEDS_PER_SEGMENT
+    new_index = [strip_first[s] + local for (s, local) in zip(global_to_strip, global_to_local)]
+    if sorted(new_index) != list(range(len(new_index))):
+        raise AssertionError("wire-order renumbering is not a permutation")
+    return new_index
+
+
+def permute(values: Sequence, new_index: Sequence[int]) -> List:
+    out = [None] * len(values)
+    for old, new in enumerate(new_index):
+        out[new] = values[old]
+    return out
+
+
 def compute_bounds(pixels: Sequence[Tuple[int, int]]) -> Tuple[int, int, int, int]:
     xs = [p[0] for p in pixels]
     ys = [p[1] for p in pixels]
@@ -201,11 +452,76 @@ def build_global_to_segment_tables(
             global_to_dir.append(0 if os.direction == "a_to_b" else 1)
     return global_to_seg, global_to_seg_k, global_to_dir
 
+def fnv1a32(data: bytes) -> int:
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def encode_mapping_blob(
+    *,
+    mapping_version: str,
+    is_bench_subset: bool,
+    wire_order: bool,
+    width: int,
+    height: int,
+    segment_count: int,
+    vertex_count: int,
+    max_vertex_degree: int,
+    origin: Tuple[int, int],
+    tables: Sequence[Tuple[str, Sequence[int]]],
+) -> bytes:
+    # tables: (struct format char, values) in core/mapping/mapping_blob.h Table order. Each table starts 4-byte
+    # aligned so the firmware reads it in place from memory-mapped flash.
+    version = mapping_version.encode("ascii")
+    if len(version) >= BLOB_VERSION_STRING_BYTES:
+        raise ValueError(f"mapping version longer than {BLOB_VERSION_STRING_BYTES - 1} bytes")
+    led_count = len(tables[0][1])
+    run_count = led_count // LEDS_PER_SEGMENT
+    strip_count = len(tables[12][1])
+    body = bytearray()
+    offsets: List[int] = []
+    table_at = BLOB_HEADER_BYTES + 4 * len(tables)
+    for fmt, values in tables:
+        offsets.append(table_at + len(body))
+        body += struct.pack(f"<{len(values)}{fmt}", *values)
+        body += bytes(-len(body) % 4)
+    directory = struct.pack(f"<{len(offsets)}I", *offsets)
+    total = table_at + len(body)
+    shape = struct.pack(
+        "<HHHHBBBBBBhhhhH",
+        led_count,
+        width,
+        height,
+        run_count,
+        LEDS_PER_SEGMENT,
+        segment_count,
+        vertex_count,
+        max_vertex_degree,
+        strip_count,
+        (1 if is_bench_subset else 0) | (2 if wire_order else 0),
+        RASTER_SCALE[0],
+        RASTER_SCALE[1],
+        origin[0],
+        origin[1],
+        0,
+    )
+    after_checksum = shape + version.ljust(BLOB_VERSION_STRING_BYTES, b"\0") + directory + bytes(body)
+    head = b"CHMP" + struct.pack("<HHII", BLOB_VERSION, len(tables), total, fnv1a32(after_checksum))
+    blob = head + after_checksum
+    if len(blob) != total:
+        raise AssertionError("mapping blob size mismatch")
+    return blob
+
+
 def write_mapping_header(
     *,
-    out_path: Path,
+    out_path: Optional[Path],
     mapping_version: str,
     is_bench_subset: bool,
+    topology: Sequence[Segment],
+    strips: Sequence[StripInfo],
     width: int,
     height: int,
     pixel_x: Sequence[int],
@@ -215,6 +531,11 @@ def write_mapping_header(
     global_to_seg: Sequence[int],
     global_to_seg_k: Sequence[int],
     global_to_dir: Sequence[int],
+    segment_runs: Sequence[int],
+    origin: Tuple[int, int],
+    node: NodeView,
+    wire_order: bool = False,
+    blob_path: Optional[Path] = None,
 ) -> None:
     if len(pixel_x) != len(pixel_y):
         raise ValueError("pixel_x/pixel_y length mismatch")
@@ -226,9 +547,10 @@ def write_mapping_header(
         or len(global_to_dir) != len(pixel_x)
     ):
         raise ValueError("global_to_seg/global_to_seg_k/global_to_dir length mismatch")
+    if len(segment_runs) * LEDS_PER_SEGMENT != len(pixel_x):
+        raise ValueError("segment_runs length mismatch")
 
     led_count = len(pixel_x)
-    out_path.parent.mkdir(parents=True, exist_ok=True)
 
     def format_values(values: Sequence[int], *, per_line: int) -> str:
         lines: List[str] = []
@@ -250,6 +572,15 @@ def write_mapping_header(
         body = format_values(values, per_line=16)
         return f"constexpr uint16_t {name}[LED_COUNT] = {{\n{body}\n}};"
 
+    def arr_u32_hex(name: str, values: Sequence[int], *, count_name: str = "LED_COUNT") -> str:
+        lines: List[str] = []
+        for i in range(0, len(values), 8):
+            chunk = ", ".join(f"0x{int(v):08x}u" for v in values[i : i + 8])
+            suffix = "," if i + 8 < len(values) else ""
+            lines.append(f"  {chunk}{suffix}")
+        body = "\n".join(lines)
+        return f"constexpr uint32_t {name}[{count_name}] = {{\n{body}\n}};"
+
     def arr_i8(name: str, values: Sequence[int], *, count_name: str) -> str:
         body = format_values(values, per_line=24)
         return f"constexpr int8_t {name}[{count_name}] = {{\n{body}\n}};"
@@ -258,19 +589,85 @@ def write_mapping_header(
         body = format_values(values, per_line=24)
         return f"constexpr uint8_t {name}[{count_name}] = {{\n{body}\n}};"
 
+    # The compact encoding must reproduce the flat tables exactly, or it is no substitute for them.
+    for r, run in enumerate(segment_runs):
+        first = r * LEDS_PER_SEGMENT
+        decoded = decode_segment_run_pixels(topology, run, origin, wire_order)
+        for k, (x, y) in enumerate(decoded):
+            if (x, y) != (pixel_x[first + k], pixel_y[first + k]):
+                raise ValueError(f"segment_runs: LED {first + k} decodes to {(x, y)}, pixel table has "
+                                 f"{(pixel_x[first + k], pixel_y[first + k])}")
+
     # Topology tables (canonical, shared across full/bench; filtering is done by segment presence).
     # Vertex IDs are stable: unique (vx,vy) endpoints sorted lexicographically.
-    vertices = sorted({v for seg in SEGMENTS for v in seg})
+    vertices = sorted({v for seg in topology for v in seg})
     vertex_id_by_coord: Dict[Tuple[int, int], int] = {v: i for i, v in enumerate(vertices)}
     vertex_vx = [vx for (vx, _vy) in vertices]
     vertex_vy = [vy for (_vx, vy) in vertices]
 
     seg_vertex_a = [0]
     seg_vertex_b = [0]
-    for (va, vb) in SEGMENTS:
+    for (va, vb) in topology:
         seg_vertex_a.append(vertex_id_by_coord[va])
         seg_vertex_b.append(vertex_id_by_coord[vb])
 
+    degree = [0] * len(vertices)
+    for seg_id in range(1, len(topology) + 1):
+        degree[seg_vertex_a[seg_id]] += 1
+        degree[seg_vertex_b[seg_id]] += 1
+
+    # Per-LED attribute pack (core/mapping/led_attributes.h): one word per LED with segment, position from
+    # vertex A, nearest vertex, strip and wiring direction. seg_k counts from the segment's entry end (A for
+    # a_to_b, B for b_to_a), in either global order.
+    led_attrs: List[int] = []
+    for i in range(led_count):
+        seg = int(global_to_seg[i])
+        k = int(global_to_seg_k[i])
+        d = int(global_to_dir[i])
+        pos_from_a = k if d == 0 else LEDS_PER_SEGMENT - 1 - k
+        nearest = seg_vertex_a[seg] if pos_from_a < LEDS_PER_SEGMENT // 2 else seg_vertex_b[seg]
+        strip = int(global_to_strip[i])
+        if seg > 255 or nearest > 255 or strip > 127:
+            raise ValueError("led_attrs field overflow")
+        led_attrs.append(seg | (pos_from_a << 8) | (nearest << 16) | (strip << 24) | (d << 31))
+
+    if blob_path is not None:
+        if node.count != 1:
+            raise ValueError("mapping blobs describe a whole wall driven by one controller")
+        blob = encode_mapping_blob(
+            mapping_version=mapping_version,
+            is_bench_subset=is_bench_subset,
+            wire_order=wire_order,
+            width=width,
+            height=height,
+            segment_count=len(topology),
+            vertex_count=len(vertices),
+            max_vertex_degree=max(degree),
+            origin=origin,
+            tables=[
+                ("h", pixel_x),
+                ("h", pixel_y),
+                ("B", global_to_strip),
+                ("H", global_to_local),
+                ("B", global_to_seg),
+                ("B", global_to_seg_k),
+                ("B", global_to_dir),
+                ("I", led_attrs),
+                ("b", vertex_vx),
+                ("b", vertex_vy),
+                ("B", seg_vertex_a),
+                ("B", seg_vertex_b),
+                ("B", [s.segment_count for s in strips]),
+                ("B", [s.data_pin for s in strips]),
+                ("B", [s.clock_pin for s in strips]),
+                ("I", segment_runs),
+            ],
+        )
+        blob_path.parent.mkdir(parents=True, exist_ok=True)
+        blob_path.write_bytes(blob)
+    if out_path is None:
+        return
+
     header = "\n".join(
         [
             "#pragma once",
@@ -285,12 +682,33 @@ def write_mapping_header(
             "",
             f'constexpr const char* MAPPING_VERSION = "{mapping_version}";',
             f"constexpr bool IS_BENCH_SUBSET = {'true' if is_bench_subset else 'false'};",
+            "// Global LEDs numbered strip by strip in strip-local order (--wire-order), not segment entry order.",
+            f"constexpr bool WIRE_ORDER = {'true' if wire_order else 'false'};",
             f"constexpr uint16_t LED_COUNT = {led_count};",
             f"constexpr uint16_t WIDTH = {int(width)};",
             f"constexpr uint16_t HEIGHT = {int(height)};",
             "",
-            f"constexpr uint8_t SEGMENT_COUNT = {len(SEGMENTS)};",
+            f"constexpr uint8_t LEDS_PER_SEGMENT = {LEDS_PER_SEGMENT};",
+            f"constexpr uint8_t SEGMENT_COUNT = {len(topology)};",
             f"constexpr uint8_t VERTEX_COUNT = {len(vertices)};",
+            f"constexpr uint8_t MAX_VERTEX_DEGREE = {max(degree)};",
+            f"constexpr uint8_t STRIP_COUNT = {len(strips)};",
+            "",
+            "// Per physical strip, in wiring order; pin 255 = not assigned.",
+            arr_u8_counted("strip_segment_count", [s.segment_count for s in strips], count_name="STRIP_COUNT"),
+            arr_u8_counted("strip_data_pin", [s.data_pin for s in strips], count_name="STRIP_COUNT"),
+            arr_u8_counted("strip_clock_pin", [s.clock_pin for s in strips], count_name="STRIP_COUNT"),
+            "",
+            "// Controller partition (wiring \"nodes\"): this build is node NODE_INDEX of NODE_COUNT and drives the",
+            "// global LEDs [NODE_LED_FIRST, NODE_LED_FIRST + NODE_LED_COUNT). Segment roles: 0 = another node's,",
+            "// 1 = this node's, 2 = halo (another node's, sharing a vertex with one of this node's).",
+            f"constexpr uint8_t NODE_COUNT = {node.count};",
+            f"constexpr uint8_t NODE_INDEX = {node.index};",
+            f'constexpr const char* NODE_NAME = "{node.name}";',
+            f"constexpr uint16_t NODE_LED_FIRST = {node.led_first};",
+            f"constexpr uint16_t NODE_LED_COUNT = {node.led_count};",
+            arr_u8_counted("strip_node", node.strip_node, count_name="STRIP_COUNT"),
+            arr_u8_counted("seg_node_role", node.seg_role, count_name="SEGMENT_COUNT + 1"),
             "",
             arr_int16("pixel_x", pixel_x),
             arr_int16("pixel_y", pixel_y),
@@ -300,6 +718,19 @@ def write_mapping_header(
             arr_u8("global_to_seg_k", global_to_seg_k),
             arr_u8("global_to_dir", global_to_dir),
             "",
+            "// segment | pos_from_a << 8 | nearest_vertex << 16 | strip << 24 | dir << 31",
+            arr_u32_hex("led_attrs", led_attrs),
+            "",
+            "// Compact encoding (core/mapping/compact_mapping.h): global LEDs in runs of LEDS_PER_SEGMENT, one per",
+            "// wired segment. Pixels interpolate between the segment's vertices (raster = vertex * scale - origin).",
+            f"constexpr uint16_t RUN_COUNT = {len(segment_runs)};",
+            f"constexpr int16_t RASTER_SCALE_X = {RASTER_SCALE[0]};",
+            f"constexpr int16_t RASTER_SCALE_Y = {RASTER_SCALE[1]};",
+            f"constexpr int16_t RASTER_ORIGIN_X = {origin[0]};",
+            f"constexpr int16_t RASTER_ORIGIN_Y = {origin[1]};",
+            "// segment | strip << 8 | dir << 15 | strip-local index of the run's first LED << 16",
+            arr_u32_hex("segment_runs", segment_runs, count_name="RUN_COUNT"),
+            "",
             arr_i8("vertex_vx", vertex_vx, count_name="VERTEX_COUNT"),
             arr_i8("vertex_vy", vertex_vy, count_name="VERTEX_COUNT"),
             arr_u8_counted("seg_vertex_a", seg_vertex_a, count_name="SEGMENT_COUNT + 1"),
@@ -310,6 +741,7 @@ def write_mapping_header(
             "",
         ]
     )
+    out_path.parent.mkdir(parents=True, exist_ok=True)
     out_path.write_text(header)
 
 
@@ -319,12 +751,39 @@ def main() -> int:
     ap.add_argument("--out-ledmap", required=True, type=Path, help="Output ledmap.json path")
     ap.add_argument("--out-pixels", type=Path, help="Optional output pixels.json path")
     ap.add_argument("--out-header", type=Path, help="Optional output C++ header (include/generated/*.h)")
+    ap.add_argument(
+        "--out-blob",
+        type=Path,
+        help="Optional output mapping blob for the whole wall (flashed to the 'mapping' partition, loaded at boot)",
+    )
+    ap.add_argument(
+        "--wire-order",
+        action="store_true",
+        help="Number global LEDs in wire order, each strip one contiguous span (version gets +wire)",
+    )
+    ap.add_argument(
+        "--out-node-headers",
+        type=Path,
+        help="Optional output directory for per-node headers (chromance_mapping_node_<name>.h); needs 'nodes'",
+    )
     args = ap.parse_args()
 
-    mapping_version, is_bench_subset, ordered = parse_wiring(args.wiring)
-    pixels = build_pixels(ordered)
+    mapping_version, is_bench_subset, topology, strips, ordered, nodes = parse_wiring(args.wiring)
+    if args.out_node_headers is not None and not nodes:
+        raise ValueError("--out-node-headers needs a 'nodes' list in the wiring file")
+    pixels = build_pixels(topology, ordered)
     global_to_strip, global_to_local = build_global_to_strip_tables(ordered)
     global_to_seg, global_to_seg_k, global_to_dir = build_global_to_segment_tables(ordered)
+    if args.wire_order:
+        # Frames (clips, host streams) are per global index, so the renumbered layout is a different mapping.
+        mapping_version += "+wire"
+        new_index = renumber_in_wire_order(global_to_strip, global_to_local, strips)
+        pixels = permute(pixels, new_index)
+        global_to_strip = permute(global_to_strip, new_index)
+        global_to_local = permute(global_to_local, new_index)
+        global_to_seg = permute(global_to_seg, new_index)
+        global_to_seg_k = permute(global_to_seg_k, new_index)
+        global_to_dir = permute(global_to_dir, new_index)
 
     if len(pixels) != len(global_to_strip):
         raise AssertionError("pixel/global_to_* count mismatch")
@@ -358,11 +817,18 @@ def main() -> int:
         }
         args.out_pixels.write_text(json.dumps(payload, indent=2))
 
-    if args.out_header is not None:
+    def write_header(
+        out_path: Optional[Path],
+        node: NodeView,
+        header_strips: Sequence[StripInfo],
+        blob_path: Optional[Path] = None,
+    ) -> None:
         write_mapping_header(
-            out_path=args.out_header,
+            out_path=out_path,
             mapping_version=mapping_version,
             is_bench_subset=is_bench_subset,
+            topology=topology,
+            strips=header_strips,
             width=width,
             height=height,
             pixel_x=[x - min_x for (x, _y) in pixels],
@@ -372,8 +838,27 @@ def main() -> int:
             global_to_seg=global_to_seg,
             global_to_seg_k=global_to_seg_k,
             global_to_dir=global_to_dir,
+            segment_runs=build_segment_runs(ordered),
+            origin=(min_x, min_y),
+            node=node,
+            wire_order=args.wire_order,
+            blob_path=blob_path,
         )
 
+    # --out-header and --out-blob describe the whole wall driven by one controller, nodes or not.
+    if args.out_header is not None or args.out_blob is not None:
+        whole = build_node_view(topology, strips, ordered, [], 0)
+        write_header(args.out_header, whole, strips, args.out_blob)
+
+    if args.out_node_headers is not None:
+        for index, node in enumerate(nodes):
+            view = build_node_view(topology, strips, ordered, nodes, index)
+            out_path = args.out_node_headers / f"chromance_mapping_node_{node.name}.h"
+            write_header(out_path, view, node_strips(strips, view))
+            halo = sum(1 for role in view.seg_role if role == ROLE_HALO)
+            last = view.led_first + view.led_count - 1
+            print(f"node {node.name}: leds={view.led_first}..{last} halo_segments={halo}")
+
     print(f"leds={len(pixels)} width={width} height={height} holes={width*height-len(pixels)}")
     return 0
 
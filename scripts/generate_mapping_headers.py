@@ -7,10 +7,17 @@ Import("env")
 def _newer_than(target: Path, sources: list[Path]) -> bool:
     if not target.exists():
         return False
+    if wire_order != ("WIRE_ORDER = true" in target.read_text()):
+        return False  # generated with the other global numbering
     t_mtime = target.stat().st_mtime
     return all(s.exists() and s.stat().st_mtime <= t_mtime for s in sources)
 
 
+# `custom_chromance_wire_order = yes` numbers global LEDs in wire order (generate_ledmap.py --wire-order), so
+# each strip is a contiguous span of the framebuffer and the output skips the per-LED permutation.
+wire_order = env.GetProjectOption("custom_chromance_wire_order", "no").strip().lower() in ("1", "yes", "true")
+wire_order_args = ["--wire-order"] if wire_order else []
+
 project_dir = Path(env["PROJECT_DIR"])
 python_exe = env.get("PYTHONEXE", "python3")
 gen = project_dir / "scripts" / "generate_ledmap.py"
@@ -47,6 +54,9 @@ if needs_full:
             str(tmp_dir / "pixels_full.json"),
             "--out-header",
             str(out_full),
+            "--out-blob",
+            str(tmp_dir / "mapping_full.bin"),
+            *wire_order_args,
         ]
     )
 
@@ -63,6 +73,41 @@ if needs_bench:
             str(tmp_dir / "pixels_bench.json"),
             "--out-header",
             str(out_bench),
+            "--out-blob",
+            str(tmp_dir / "mapping_bench.bin"),
+            *wire_order_args,
         ]
     )
 
+
+# Other installations (more panels/strips): `custom_chromance_wiring = mapping/<file>.json` in the env selects
+# that wiring instead of the full/bench pair; core capacities follow the generated header. Walls split across
+# controllers also set `custom_chromance_node = <name>` (one of the wiring's "nodes") to build that node.
+custom_wiring = env.GetProjectOption("custom_chromance_wiring", "")
+custom_node = env.GetProjectOption("custom_chromance_node", "")
+if custom_wiring:
+    wiring_custom = project_dir / custom_wiring
+    out_custom = include_generated / "chromance_mapping_custom.h"
+    out_node = include_generated / f"chromance_mapping_node_{custom_node}.h"
+    selected = out_node if custom_node else out_custom
+    if not _newer_than(out_custom, [gen, wiring_custom]) or not _newer_than(selected, [gen, wiring_custom]):
+        include_generated.mkdir(parents=True, exist_ok=True)
+        cmd = [
+            str(python_exe),
+            str(gen),
+            "--wiring",
+            str(wiring_custom),
+            "--out-ledmap",
+            str(tmp_dir / "ledmap_custom.json"),
+            "--out-pixels",
+            str(tmp_dir / "pixels_custom.json"),
+            "--out-header",
+            str(out_custom),
+            *wire_order_args,
+        ]
+        if custom_node:
+            cmd += ["--out-node-headers", str(include_generated)]
+        subprocess.check_call(cmd)
+    if not selected.exists():
+        raise SystemExit(f"custom_chromance_node: no node '{custom_node}' in {custom_wiring}")
+    env.Append(CPPDEFINES=[("CHROMANCE_MAPPING_HEADER", env.StringifyMacro(f"generated/{selected.name}"))])
@@ -1,4 +1,5 @@
 import gzip
+import hashlib
 import json
 import os
 import subprocess
@@ -16,6 +17,7 @@ class Asset:
     gz_len: int
     content_type: str
     cache_control: str
+    etag: str
 
 
 SOFT_BUDGET_BYTES = 200 * 1024
@@ -66,10 +68,15 @@ def _content_type_for(path: str) -> str:
 
 
 def _cache_control_for(request_path: str) -> str:
-    # Fingerprinted assets: cache forever. Shell pages: no-store.
+    # Fingerprinted assets: cache forever. Shell pages: revalidate every load (cheap 304 via ETag).
     if request_path.startswith("/assets/"):
         return "public, max-age=31536000, immutable"
-    return "no-store"
+    return "no-cache"
+
+
+def _etag_for(gz_path: Path) -> str:
+    # Strong validator over the exact bytes served (the gzip body), so it changes iff the response does.
+    return '"' + hashlib.sha256(gz_path.read_bytes()).hexdigest()[:16] + '"'
 
 
 def _gzip_deterministic(src: Path, dst: Path) -> int:
@@ -147,6 +154,7 @@ def _emit_header(out_path: Path, assets: list[Asset]) -> None:
     lines.append("  const char* request_path;")
     lines.append("  const char* content_type;")
     lines.append("  const char* cache_control;")
+    lines.append("  const char* etag;  // quoted strong ETag")
     lines.append("  const uint8_t* gz_data;")
     lines.append("  size_t gz_len;")
     lines.append("};")
@@ -165,8 +173,9 @@ def _emit_header(out_path: Path, assets: list[Asset]) -> None:
     lines.append("static const WebuiAsset kWebuiAssets[] = {")
     for a in assets:
         sym = _sym_for(a.request_path)
+        etag = a.etag.replace('"', '\\"')
         lines.append(
-            f'  {{ "{a.request_path}", "{a.content_type}", "{a.cache_control}", {sym}, {a.gz_len} }},'
+            f'  {{ "{a.request_path}", "{a.content_type}", "{a.cache_control}", "{etag}", {sym}, {a.gz_len} }},'
         )
     lines.append("};")
     lines.append("")
@@ -229,6 +238,7 @@ def main() -> None:
                 gz_len=gz_len,
                 content_type=_content_type_for(request_path),
                 cache_control=_cache_control_for(request_path),
+                etag=_etag_for(gz_path),
             )
         )
 
@@ -243,6 +253,7 @@ def main() -> None:
                 "gz_bytes": a.gz_len,
                 "content_type": a.content_type,
                 "cache_control": a.cache_control,
+                "etag": a.etag,
             }
             for a in assets
         ],
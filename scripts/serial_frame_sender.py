@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+Stream framebuffer frames to the runtime firmware over USB serial.
+
+Stand-in host sender for the serial frame protocol (src/core/protocol/serial_frame.h):
+  'A' 'd' 'a' | count-1 (u16 BE) | hi ^ lo ^ 0x55 | count x RGB | CRC-16/CCITT-FALSE (u16 BE)
+
+Frames are generated from pixels.json coordinates so patterns look right on the panel. Flash an env built with
+-D CHROMANCE_SERIAL_BAUD=2000000 (e.g. `pio run -e runtime_serial -t upload`) and run:
+
+  python3 scripts/serial_frame_sender.py --port /dev/ttyUSB0 --baud 2000000 --fps 60
+
+Requires pyserial (`pip install pyserial`). Use --dry-run to measure encoding rate without a device.
+"""
+
+from __future__ import annotations
+
+import argparse
+import colorsys
+import json
+import math
+import sys
+import time
+from pathlib import Path
+from typing import List, Tuple
+
+
+def crc16_ccitt(data: bytes, crc: int = 0xFFFF) -> int:
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def encode_frame(rgb: bytes) -> bytes:
+    if len(rgb) % 3 != 0 or not rgb:
+        raise ValueError("rgb payload must be a non-empty multiple of 3 bytes")
+    n1 = len(rgb) // 3 - 1
+    hi, lo = (n1 >> 8) & 0xFF, n1 & 0xFF
+    crc = crc16_ccitt(rgb)
+    return bytes([ord("A"), ord("d"), ord("a"), hi, lo, hi ^ lo ^ 0x55]) + rgb + bytes([crc >> 8, crc & 0xFF])
+
+
+def load_coords(pixels_path: Path) -> Tuple[List[Tuple[int, int]], int, int]:
+    data = json.loads(pixels_path.read_text())
+    coords = [(int(p["x"]), int(p["y"])) for p in sorted(data["pixels"], key=lambda p: p["i"])]
+    return coords, int(data["width"]), int(data["height"])
+
+
+def render(pattern: str, coords: List[Tuple[int, int]], w: int, h: int, t: float) -> bytes:
+    out = bytearray()
+    if pattern == "rainbow":
+        for x, y in coords:
+            hue = (x / float(w) + y / float(2 * h) + t * 0.25) % 1.0
+            r, g, b = colorsys.hsv_to_rgb(hue, 1.0, 1.0)
+            out += bytes([int(r * 255), int(g * 255), int(b * 255)])
+    elif pattern == "chase":
+        head = int(t * 120) % len(coords)
+        for i in range(len(coords)):
+            d = (head - i) % len(coords)
+            v = max(0, 255 - d * 16)
+            out += bytes([v, v, v])
+    else:  # ripple
+        for x, y in coords:
+            d = math.hypot(x - w / 2.0, y - h / 2.0)
+            v = int(127.5 + 127.5 * math.sin(d * 0.15 - t * 6.0))
+            out += bytes([0, v // 2, v])
+    return bytes(out)
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--port", help="serial device, e.g. /dev/ttyUSB0 or COM5")
+    ap.add_argument("--baud", type=int, default=2000000)
+    ap.add_argument("--fps", type=float, default=60.0)
+    ap.add_argument("--pattern", choices=["rainbow", "chase", "ripple"], default="rainbow")
+    ap.add_argument("--pixels", type=Path, default=Path(__file__).resolve().parent.parent / "mapping" / "pixels.json")
+    ap.add_argument("--seconds", type=float, default=0.0, help="stop after this long (0 = run until Ctrl-C)")
+    ap.add_argument("--dry-run", action="store_true", help="encode frames without opening a port")
+    args = ap.parse_args()
+
+    coords, width, height = load_coords(args.pixels)
+    frame_bytes = len(coords) * 3 + 8
+    max_fps = args.baud / 10.0 / frame_bytes
+    print(f"leds={len(coords)} frame_bytes={frame_bytes} baud={args.baud} max_fps~{max_fps:.0f}")
+
+    port = None
+    if not args.dry_run:
+        if not args.port:
+            ap.error("--port is required unless --dry-run")
+        try:
+            import serial  # type: ignore
+        except ImportError:
+            print("pyserial is required: pip install pyserial", file=sys.stderr)
+            return 2
+        port = serial.Serial(args.port, args.baud, timeout=0)
+
+    interval = 1.0 / args.fps if args.fps > 0 else 0.0
+    start = time.monotonic()
+    next_t = start
+    sent = 0
+    last_report = start
+    try:
+        while True:
+            now = time.monotonic()
+            if args.seconds and now - start >= args.seconds:
+                break
+            frame = encode_frame(render(args.pattern, coords, width, height, now - start))
+            if port is not None:
+                port.write(frame)
+                if port.in_waiting:
+                    sys.stdout.write(port.read(port.in_waiting).decode("utf-8", "replace"))
+            sent += 1
+            if now - last_report >= 5.0:
+                print(f"sent={sent} fps={sent / (now - start):.1f}")
+                last_report = now
+            next_t += interval
+            delay = next_t - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+            else:
+                next_t = time.monotonic()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if port is not None:
+            port.close()
+    elapsed = max(1e-6, time.monotonic() - start)
+    print(f"done: sent={sent} avg_fps={sent / elapsed:.1f}")
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
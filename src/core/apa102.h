@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "types.h"
+
+namespace chromance {
+namespace core {
+
+// Order of the three colour bytes an APA102/DotStar expects after each LED's header byte, named as sent
+// (kBrg = blue, red, green; Adafruit's DOTSTAR_BRG).
+enum class ColorOrder : uint8_t { kRgb, kRbg, kGrb, kGbr, kBrg, kBgr };
+
+// Channel (0 = r, 1 = g, 2 = b) carried by colour byte slot 0..2 under order.
+constexpr uint8_t wire_channel(ColorOrder order, uint8_t slot) {
+  return order == ColorOrder::kRgb   ? slot
+         : order == ColorOrder::kRbg ? (slot == 0 ? 0 : slot == 1 ? 2 : 1)
+         : order == ColorOrder::kGrb ? (slot == 0 ? 1 : slot == 1 ? 0 : 2)
+         : order == ColorOrder::kGbr ? (slot == 0 ? 1 : slot == 1 ? 2 : 0)
+         : order == ColorOrder::kBrg ? (slot == 0 ? 2 : slot == 1 ? 0 : 1)
+                                     : static_cast<uint8_t>(2U - slot);
+}
+
+// Colour byte slot carrying channel under order (the inverse of wire_channel()).
+constexpr uint8_t wire_slot(ColorOrder order, uint8_t channel) {
+  return wire_channel(order, 0) == channel ? 0 : wire_channel(order, 1) == channel ? 1 : 2;
+}
+
+constexpr uint8_t rgb_channel(const Rgb& c, uint8_t channel) { return channel == 0 ? c.r : channel == 1 ? c.g : c.b; }
+
+// One LED exactly as it goes on the wire: 0xE0 | 5-bit global brightness, then the colour bytes in Order. A
+// frame of these, between apa102 start and end frames, is what the strip's SPI clocks out, so an output can send
+// it without touching each pixel. Colour order is resolved at compile time: set() is three byte stores.
+template <ColorOrder Order, uint8_t Header = 0xFF>
+struct alignas(4) Apa102Pixel {
+  static_assert((Header & 0xE0U) == 0xE0U, "APA102 LED frames start with three 1 bits");
+  static constexpr ColorOrder kOrder = Order;
+  static constexpr uint8_t kHeader = Header;
+
+  uint8_t bytes[4];
+
+  static constexpr Apa102Pixel from_rgb(const Rgb& c) {
+    return Apa102Pixel{{Header, rgb_channel(c, wire_channel(Order, 0)), rgb_channel(c, wire_channel(Order, 1)),
+                        rgb_channel(c, wire_channel(Order, 2))}};
+  }
+
+  void set(const Rgb& c) {
+    bytes[0] = Header;
+    bytes[1 + wire_slot(Order, 0)] = c.r;
+    bytes[1 + wire_slot(Order, 1)] = c.g;
+    bytes[1 + wire_slot(Order, 2)] = c.b;
+  }
+
+  constexpr Rgb rgb() const {
+    return Rgb{bytes[1 + wire_slot(Order, 0)], bytes[1 + wire_slot(Order, 1)], bytes[1 + wire_slot(Order, 2)]};
+  }
+};
+
+// Start frame: 32 zero bits. End frame: at least one clock edge per two LEDs to push the last colours through
+// the chain, sent as 0xFF bytes (as the Adafruit library does).
+constexpr size_t kApa102StartFrameBytes = 4;
+constexpr uint8_t kApa102EndFrameByte = 0xFF;
+constexpr size_t apa102_end_frame_bytes(size_t led_count) { return (led_count + 15U) / 16U; }
+
+// Bytes clocked out to refresh led_count LEDs, and how long that takes at clock_hz (rounded up to whole us).
+constexpr size_t apa102_frame_bytes(size_t led_count) {
+  return kApa102StartFrameBytes + 4U * led_count + apa102_end_frame_bytes(led_count);
+}
+constexpr uint32_t apa102_wire_us(size_t led_count, uint32_t clock_hz) {
+  return clock_hz == 0 ? 0
+                       : static_cast<uint32_t>((static_cast<uint64_t>(apa102_frame_bytes(led_count)) * 8000000U +
+                                                clock_hz - 1U) /
+                                               clock_hz);
+}
+
+// Writes colour c to a framebuffer pixel, whichever pixel type the framebuffer holds, so one render routine can
+// fill an Rgb frame or a wire frame.
+inline void put_pixel(Rgb& out, const Rgb& c) { out = c; }
+
+template <ColorOrder Order, uint8_t Header>
+inline void put_pixel(Apa102Pixel<Order, Header>& out, const Rgb& c) {
+  out.set(c);
+}
+
+template <typename Pixel>
+void encode_apa102(const Rgb* in, Pixel* out, size_t led_count) {
+  for (size_t i = 0; i < led_count; ++i) {
+    out[i].set(in[i]);
+  }
+}
+
+template <typename Pixel>
+void decode_apa102(const Pixel* in, Rgb* out, size_t led_count) {
+  for (size_t i = 0; i < led_count; ++i) {
+    out[i] = in[i].rgb();
+  }
+}
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "fixed_fft.h"
+
+namespace chromance {
+namespace core {
+
+constexpr uint8_t kAudioBandCount = 8;
+
+// One analysis result, published after every block. Times are in the caller's clock (the end_ms passed to
+// AudioAnalyzer::feed()). Levels are log2 of energy in Q8, so 256 is ~3 dB.
+struct AudioFeatures {
+  uint32_t time_ms = 0;             // end of the last analysed block
+  uint16_t level_q8 = 0;            // total band energy
+  uint16_t energy_q16 = 0;          // loudness 0..65535 within the adaptive dynamic range
+  uint8_t bands[kAudioBandCount] = {};  // per-band loudness 0..255, low to high
+  uint16_t onset_strength = 0;      // spectral flux of the last block (Q8 log2 units)
+  uint32_t onsets = 0;
+  uint32_t last_onset_ms = 0;
+  uint16_t bpm_x100 = 0;            // 0 = no tempo yet
+  uint32_t beat_ms = 0;             // a beat on the tracked grid; phase = (now - beat_ms) mod period
+  uint32_t blocks = 0;
+  uint32_t last_block_us = 0;       // analysis cost of the last block (0 without a clock)
+  uint32_t max_block_us = 0;
+};
+
+// Block-based audio analysis for modulation: fixed-point real FFT, band energy, spectral-flux onsets and an
+// autocorrelation tempo tracker with a phase-locked beat grid.
+//
+// feed() takes PCM16 mono in chunks of any size; every N/2 new samples one block (the last N samples, Hann
+// windowed) is analysed. Input above 32 kHz is box-decimated first so a block stays 10-16 ms and the tempo
+// envelope covers ~3-4 s at any common rate. No heap; all state is inline (~8 KB at N = 512).
+template <size_t N = 512>
+class AudioAnalyzer final {
+ public:
+  using ClockUs = uint32_t (*)();
+
+  static constexpr uint16_t kMinBpm = 60;
+  static constexpr uint16_t kMaxBpm = 200;
+  static constexpr uint16_t kDynamicRangeQ8 = 8 * 256;  // ~24 dB below the adaptive peak reads as silence
+  static constexpr uint16_t kDefaultGateQ8 = 12 * 256;  // blocks quieter than this are silence
+  static constexpr uint32_t kOnsetRefractoryMs = 100;
+  static constexpr size_t kEnvelopeLength = 256;        // onset-strength history for tempo estimation
+  static constexpr uint32_t kTempoEveryBlocks = 32;
+
+  // clock_us, when given, is used to measure the cost of each block (e.g. micros()).
+  void begin(uint32_t sample_rate, ClockUs clock_us = nullptr) {
+    fill_ = 0;
+    dec_acc_ = 0;
+    dec_count_ = 0;
+    for (uint8_t b = 0; b < kAudioBandCount; ++b) prev_band_[b] = 0;
+    peak_q8_ = 0;
+    flux_mean_ = 0;
+    env_head_ = 0;
+    env_count_ = 0;
+    blocks_since_tempo_ = 0;
+    pending_bpm_x100_ = 0;
+    last_match_ms_ = 0;
+    features_ = AudioFeatures{};
+    decimation_ = sample_rate >= 64000U ? 4U : (sample_rate >= 32000U ? 2U : 1U);
+    rate_ = sample_rate / decimation_;
+    clock_us_ = clock_us;
+    // Band edges (Hz), roughly octaves from bass to presence.
+    static const uint16_t kEdgesHz[kAudioBandCount + 1] = {40, 80, 160, 320, 640, 1280, 2560, 5120, 10240};
+    for (uint8_t b = 0; b <= kAudioBandCount; ++b) {
+      uint32_t bin = static_cast<uint32_t>(kEdgesHz[b]) * N / (rate_ > 0 ? rate_ : 1U);
+      if (bin < 1U) bin = 1U;
+      if (bin > N / 2) bin = N / 2;
+      band_edge_[b] = static_cast<uint16_t>(bin);
+    }
+    const uint32_t hop = N / 2;
+    min_lag_ = static_cast<uint16_t>((60U * rate_ + hop * kMaxBpm - 1U) / (hop * kMaxBpm));
+    max_lag_ = static_cast<uint16_t>(60U * rate_ / (hop * kMinBpm));
+    if (max_lag_ + 2U > kEnvelopeLength / 2) max_lag_ = static_cast<uint16_t>(kEnvelopeLength / 2 - 2U);
+    if (min_lag_ < 2U) min_lag_ = 2U;
+  }
+
+  void set_noise_gate_q8(uint16_t gate_q8) { gate_q8_ = gate_q8; }
+
+  // Feeds count samples; end_ms is the time of the last one. Returns the number of blocks analysed.
+  size_t feed(const int16_t* pcm, size_t count, uint32_t end_ms) {
+    if (pcm == nullptr || rate_ == 0) {
+      return 0;
+    }
+    size_t blocks = 0;
+    for (size_t i = 0; i < count; ++i) {
+      dec_acc_ += pcm[i];
+      if (++dec_count_ < decimation_) continue;
+      window_[fill_++] = static_cast<int16_t>(dec_acc_ / static_cast<int32_t>(decimation_));
+      dec_acc_ = 0;
+      dec_count_ = 0;
+      if (fill_ < N) continue;
+
+      // Time of this block's last sample, from the chunk's end time.
+      const uint32_t behind_ms = static_cast<uint32_t>((count - 1U - i) * 1000ULL / (rate_ * decimation_));
+      analyze_block(end_ms - behind_ms);
+      ++blocks;
+      // Keep the newest half as the start of the next (50% overlap).
+      for (size_t k = 0; k < N / 2; ++k) window_[k] = window_[k + N / 2];
+      fill_ = N / 2;
+    }
+    return blocks;
+  }
+
+  const AudioFeatures& features() const { return features_; }
+  uint32_t analysis_rate() const { return rate_; }
+
+ private:
+  static uint16_t log2_q8(uint64_t v) {
+    if (v == 0) return 0;
+    const int msb = 63 - __builtin_clzll(v);
+    const uint64_t mant = msb >= 8 ? (v >> (msb - 8)) : (v << (8 - msb));
+    return static_cast<uint16_t>((msb << 8) | (mant & 0xFFU));
+  }
+
+  static uint32_t scale_to(uint16_t level, uint16_t floor_q8, uint32_t full) {
+    if (level <= floor_q8) return 0;
+    const uint32_t v = static_cast<uint32_t>(level - floor_q8) * full / kDynamicRangeQ8;
+    return v > full ? full : v;
+  }
+
+  void analyze_block(uint32_t now_ms) {
+    const uint32_t start_us = clock_us_ ? clock_us_() : 0;
+
+    fft_.load_windowed(window_);
+    fft_.power_spectrum(power_);
+
+    uint64_t total = 0;
+    uint16_t band_level[kAudioBandCount];
+    for (uint8_t b = 0; b < kAudioBandCount; ++b) {
+      uint64_t e = 0;
+      for (uint16_t k = band_edge_[b]; k < band_edge_[b + 1]; ++k) e += power_[k];
+      band_level[b] = log2_q8(e);
+      total += e;
+    }
+    const uint16_t level = log2_q8(total);
+
+    // Adaptive peak: jumps up, decays ~1 log2 unit (3 dB) per second.
+    const uint32_t decay = (256U * (N / 2) + rate_ / 2) / rate_;
+    peak_q8_ = level > peak_q8_ ? level : (peak_q8_ > decay ? static_cast<uint16_t>(peak_q8_ - decay) : 0);
+    uint16_t floor_q8 = peak_q8_ > kDynamicRangeQ8 ? static_cast<uint16_t>(peak_q8_ - kDynamicRangeQ8) : 0;
+    if (floor_q8 < gate_q8_) floor_q8 = gate_q8_;
+
+    // Spectral flux over band levels clamped at the floor, so noise below it does not count.
+    uint32_t flux = 0;
+    for (uint8_t b = 0; b < kAudioBandCount; ++b) {
+      const uint16_t l = band_level[b] > floor_q8 ? band_level[b] : floor_q8;
+      if (l > prev_band_[b]) flux += l - prev_band_[b];
+      prev_band_[b] = l;
+      features_.bands[b] = static_cast<uint8_t>(scale_to(band_level[b], floor_q8, 255U));
+    }
+    if (flux > 0xFFFFU) flux = 0xFFFFU;
+
+    features_.time_ms = now_ms;
+    features_.level_q8 = level;
+    features_.energy_q16 = static_cast<uint16_t>(scale_to(level, floor_q8, 65535U));
+    features_.onset_strength = static_cast<uint16_t>(flux);
+
+    // Onset: flux well above its running mean, outside the refractory window.
+    const uint32_t threshold = 2U * flux_mean_ + 256U;
+    const bool onset = level > gate_q8_ && flux > threshold &&
+                       (features_.onsets == 0 || now_ms - features_.last_onset_ms >= kOnsetRefractoryMs);
+    flux_mean_ = (flux_mean_ * 15U + flux) / 16U;
+    if (onset) {
+      ++features_.onsets;
+      features_.last_onset_ms = now_ms;
+      track_beat(now_ms);
+    }
+
+    envelope_[env_head_] = static_cast<uint16_t>(flux);
+    env_head_ = (env_head_ + 1U) % kEnvelopeLength;
+    if (env_count_ < kEnvelopeLength) ++env_count_;
+    if (++blocks_since_tempo_ >= kTempoEveryBlocks && env_count_ >= static_cast<size_t>(max_lag_) * 2U + 2U) {
+      blocks_since_tempo_ = 0;
+      estimate_tempo();
+    }
+
+    ++features_.blocks;
+    if (clock_us_) {
+      const uint32_t us = clock_us_() - start_us;
+      features_.last_block_us = us;
+      if (us > features_.max_block_us) features_.max_block_us = us;
+    }
+  }
+
+  // Autocorrelation of the mean-removed onset envelope over the tempo lag range. Lags are scored with their
+  // neighbours (a beat period rarely falls on a whole number of blocks, so its energy is split between two
+  // lags), a lag whose half scores nearly as well is taken as the double of the real tempo, and the winner is
+  // refined by parabolic interpolation.
+  void estimate_tempo() {
+    const size_t n = env_count_;
+    const size_t first = (env_head_ + kEnvelopeLength - n) % kEnvelopeLength;
+    int32_t* e = tempo_env_;
+    int64_t* acf = tempo_acf_;
+    int64_t sum = 0;
+    for (size_t i = 0; i < n; ++i) sum += envelope_[(first + i) % kEnvelopeLength];
+    const int32_t mean = static_cast<int32_t>(sum / static_cast<int64_t>(n));
+    int64_t energy = 0;
+    for (size_t i = 0; i < n; ++i) {
+      e[i] = static_cast<int32_t>(envelope_[(first + i) % kEnvelopeLength]) - mean;
+      energy += static_cast<int64_t>(e[i]) * e[i];
+    }
+    if (energy == 0) return;
+
+    const uint16_t lo = static_cast<uint16_t>(min_lag_ - 1U);
+    const uint16_t hi = static_cast<uint16_t>(max_lag_ + 1U);
+    for (uint16_t lag = lo; lag <= hi; ++lag) {
+      int64_t a = 0;
+      for (size_t i = 0; i + lag < n; ++i) a += static_cast<int64_t>(e[i]) * e[i + lag];
+      acf[lag] = a;
+    }
+    const auto score = [acf](uint16_t lag) { return acf[lag - 1U] + 2 * acf[lag] + acf[lag + 1U]; };
+    uint16_t best = 0;
+    for (uint16_t lag = min_lag_; lag <= max_lag_; ++lag) {
+      if (best == 0 || score(lag) > score(best)) best = lag;
+    }
+    const uint16_t half = static_cast<uint16_t>((best + 1U) / 2U);
+    if (half >= min_lag_ && score(half) * 4 > score(best) * 3) {
+      best = half;
+      if (best + 1U <= max_lag_ && acf[best + 1U] > acf[best]) ++best;
+      if (best - 1U >= min_lag_ && acf[best - 1U] > acf[best]) --best;
+    }
+    // Require a clear periodicity before trusting (or replacing) the tempo.
+    if (score(best) < energy) return;
+
+    const int64_t ym = acf[best - 1U];
+    const int64_t y0 = acf[best];
+    const int64_t yp = acf[best + 1U];
+    const int64_t den = ym - 2 * y0 + yp;
+    int64_t offset_q8 = den < 0 ? ((ym - yp) * 128) / den : 0;
+    if (offset_q8 > 128) offset_q8 = 128;
+    if (offset_q8 < -128) offset_q8 = -128;
+    const int64_t lag_q8 = static_cast<int64_t>(best) * 256 + offset_q8;
+    const uint32_t bpm_x100 =
+        static_cast<uint32_t>(6000LL * rate_ * 256 / (static_cast<int64_t>(N / 2) * lag_q8));
+
+    // Small changes are smoothed; a new tempo must be seen twice before it replaces the old one.
+    const uint32_t old = features_.bpm_x100;
+    if (old != 0 && (bpm_x100 > old ? bpm_x100 - old : old - bpm_x100) * 20U < old) {
+      features_.bpm_x100 = static_cast<uint16_t>((old * 3U + bpm_x100) / 4U);
+    } else if (old == 0 ||
+               (pending_bpm_x100_ != 0 &&
+                (bpm_x100 > pending_bpm_x100_ ? bpm_x100 - pending_bpm_x100_ : pending_bpm_x100_ - bpm_x100) *
+                        20U <
+                    pending_bpm_x100_)) {
+      features_.bpm_x100 = static_cast<uint16_t>(bpm_x100);
+      pending_bpm_x100_ = 0;
+    } else {
+      pending_bpm_x100_ = bpm_x100;
+    }
+  }
+
+  // Beat grid: onsets near a predicted beat pull the grid halfway towards them; without a match for four
+  // periods the grid snaps to the next onset.
+  void track_beat(uint32_t now_ms) {
+    if (features_.bpm_x100 == 0) {
+      features_.beat_ms = now_ms;
+      last_match_ms_ = now_ms;
+      return;
+    }
+    const int32_t period = static_cast<int32_t>(6000000U / features_.bpm_x100);
+    int32_t err = static_cast<int32_t>(now_ms - features_.beat_ms) % period;
+    if (err < 0) err += period;
+    if (err > period / 2) err -= period;
+    if (err <= period / 4 && err >= -period / 4) {
+      features_.beat_ms = now_ms - static_cast<uint32_t>(err / 2);
+      last_match_ms_ = now_ms;
+    } else if (static_cast<int32_t>(now_ms - last_match_ms_) > 4 * period) {
+      features_.beat_ms = now_ms;
+      last_match_ms_ = now_ms;
+    }
+  }
+
+  RealFft<N> fft_;
+  int16_t window_[N] = {};
+  uint32_t power_[N / 2 + 1] = {};
+  size_t fill_ = 0;
+  int32_t dec_acc_ = 0;
+  uint32_t dec_count_ = 0;
+  uint32_t decimation_ = 1;
+  uint32_t rate_ = 0;
+  ClockUs clock_us_ = nullptr;
+
+  uint16_t band_edge_[kAudioBandCount + 1] = {};
+  uint16_t prev_band_[kAudioBandCount] = {};
+  uint16_t peak_q8_ = 0;
+  uint16_t gate_q8_ = kDefaultGateQ8;
+  uint32_t flux_mean_ = 0;
+
+  uint16_t envelope_[kEnvelopeLength] = {};
+  size_t env_head_ = 0;
+  size_t env_count_ = 0;
+  uint32_t blocks_since_tempo_ = 0;
+  uint16_t min_lag_ = 0;
+  uint16_t max_lag_ = 0;
+  uint32_t pending_bpm_x100_ = 0;
+  uint32_t last_match_ms_ = 0;
+  int32_t tempo_env_[kEnvelopeLength] = {};  // tempo scratch, kept off the (task) stack
+  int64_t tempo_acf_[kEnvelopeLength / 2] = {};
+
+  AudioFeatures features_{};
+};
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "../effects/modulation_provider.h"
+#include "../seqlock_snapshot.h"
+#include "audio_analyzer.h"
+
+namespace chromance {
+namespace core {
+
+// ModulationProvider over the audio analysis snapshot published by the capture task. Energy and tempo come
+// straight from the latest AudioFeatures; beat phase is extrapolated to now_ms from the tracked beat grid.
+// With no analysis newer than kStaleMs (capture stopped or stalled) nothing is provided.
+class AudioModulationProvider final : public ModulationProvider {
+ public:
+  static constexpr uint32_t kStaleMs = 500;
+
+  explicit AudioModulationProvider(const SeqLockSnapshot<AudioFeatures>* features) : features_(features) {}
+
+  void get_signals(uint32_t now_ms, Signals* out) const override {
+    if (out == nullptr) {
+      return;
+    }
+    *out = Signals{};
+    if (features_ == nullptr) {
+      return;
+    }
+    // A read that keeps colliding with the writer falls back to the previous snapshot.
+    (void)features_->read(&last_);
+    if (last_.blocks == 0 || static_cast<int32_t>(now_ms - last_.time_ms) > static_cast<int32_t>(kStaleMs)) {
+      return;
+    }
+    out->has_energy = true;
+    out->energy_01 = static_cast<float>(last_.energy_q16) / 65535.0f;
+    if (last_.bpm_x100 == 0) {
+      return;
+    }
+    out->has_bpm = true;
+    out->bpm = static_cast<float>(last_.bpm_x100) / 100.0f;
+
+    const int32_t period_ms = static_cast<int32_t>(6000000U / last_.bpm_x100);
+    int32_t since = static_cast<int32_t>(now_ms - last_.beat_ms) % period_ms;
+    if (since < 0) since += period_ms;
+    out->has_beat_phase = true;
+    out->beat_phase_01 = static_cast<float>(since) / static_cast<float>(period_ms);
+  }
+
+ private:
+  const SeqLockSnapshot<AudioFeatures>* features_ = nullptr;
+  mutable AudioFeatures last_{};
+};
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace chromance {
+namespace core {
+
+namespace fixed_fft {
+
+constexpr size_t kMaxSize = 512;
+
+// sin(2*pi*k/512) in Q15, k = 0..128 (one quarter wave; the rest follows by symmetry).
+static const int16_t kQuarterSinQ15[kMaxSize / 4 + 1] = {
+    0, 402, 804, 1206, 1608, 2009, 2411, 2811, 3212, 3612, 4011, 4410,
+    4808, 5205, 5602, 5998, 6393, 6787, 7180, 7571, 7962, 8351, 8740, 9127,
+    9512, 9896, 10279, 10660, 11039, 11417, 11793, 12167, 12540, 12910, 13279, 13646,
+    14010, 14373, 14733, 15091, 15447, 15800, 16151, 16500, 16846, 17190, 17531, 17869,
+    18205, 18538, 18868, 19195, 19520, 19841, 20160, 20475, 20788, 21097, 21403, 21706,
+    22006, 22302, 22595, 22884, 23170, 23453, 23732, 24008, 24279, 24548, 24812, 25073,
+    25330, 25583, 25833, 26078, 26320, 26557, 26791, 27020, 27246, 27467, 27684, 27897,
+    28106, 28311, 28511, 28707, 28899, 29086, 29269, 29448, 29622, 29792, 29957, 30118,
+    30274, 30425, 30572, 30715, 30853, 30986, 31114, 31238, 31357, 31471, 31581, 31686,
+    31786, 31881, 31972, 32058, 32138, 32214, 32286, 32352, 32413, 32470, 32522, 32568,
+    32610, 32647, 32679, 32706, 32729, 32746, 32758, 32766, 32767,
+};
+
+// sin(2*pi*i/512) in Q15 for any i (taken mod 512).
+inline int32_t sin_q15(size_t i) {
+  i &= kMaxSize - 1U;
+  const size_t quarter = kMaxSize / 4;
+  const size_t r = i % quarter;
+  switch (i / quarter) {
+    case 0:
+      return kQuarterSinQ15[r];
+    case 1:
+      return kQuarterSinQ15[quarter - r];
+    case 2:
+      return -kQuarterSinQ15[r];
+    default:
+      return -kQuarterSinQ15[quarter - r];
+  }
+}
+
+inline int32_t cos_q15(size_t i) { return sin_q15(i + kMaxSize / 4); }
+
+// x * w >> 15 with a 64-bit product: data words carry up to 25 significant bits.
+inline int32_t mul_q15(int32_t x, int32_t w) { return static_cast<int32_t>((static_cast<int64_t>(x) * w) >> 15); }
+
+}  // namespace fixed_fft
+
+// Fixed-point real FFT of N samples (power of two, 8..512) producing the N/2 + 1 bin power spectrum.
+//
+// The N real samples are packed as N/2 complex points (even samples real, odd samples imaginary), run through
+// an in-place radix-2 FFT and split back into the real spectrum. Twiddles are Q15 from one shared quarter-wave
+// table; data words are 32-bit without per-stage scaling, so 16-bit input cannot overflow at N = 512. The
+// Hann window is applied while loading. All storage is inline.
+template <size_t N>
+class RealFft final {
+  static_assert(N >= 8 && N <= fixed_fft::kMaxSize && (N & (N - 1U)) == 0, "N must be a power of two, 8..512");
+
+ public:
+  static constexpr size_t kBins = N / 2 + 1;
+
+  // Loads N samples with the Hann window applied.
+  void load_windowed(const int16_t* samples) {
+    constexpr size_t kStride = fixed_fft::kMaxSize / N;
+    for (size_t n = 0; n < N; ++n) {
+      // w(n) = (1 - cos(2*pi*n/N)) / 2, Q15.
+      const int32_t w = (32768 - fixed_fft::cos_q15(n * kStride)) >> 1;
+      const int32_t v = fixed_fft::mul_q15(samples[n], w);
+      if (n & 1U) {
+        im_[n / 2] = v;
+      } else {
+        re_[n / 2] = v;
+      }
+    }
+  }
+
+  // Transforms the loaded block and writes |X[k]|^2 >> (2 * kPowerShift) for k = 0..N/2, saturated to 32 bits.
+  void power_spectrum(uint32_t* out_power) {
+    transform_half();
+    constexpr size_t kM = N / 2;
+    constexpr size_t kStride = fixed_fft::kMaxSize / N;
+    for (size_t k = 0; k <= kM; ++k) {
+      const size_t a = k % kM;
+      const size_t b = (kM - k) % kM;
+      // A = Z[k], B = conj(Z[M - k]); 2X[k] = (A + B) + W^k * (-i)(A - B), W = exp(-2*pi*i/N).
+      const int32_t er = re_[a] + re_[b];
+      const int32_t ei = im_[a] - im_[b];
+      const int32_t dr = re_[a] - re_[b];
+      const int32_t di = im_[a] + im_[b];
+      const int32_t c = fixed_fft::cos_q15(k * kStride);
+      const int32_t s = fixed_fft::sin_q15(k * kStride);
+      // (c - i s) * (di - i dr)
+      const int32_t xr = er + fixed_fft::mul_q15(di, c) - fixed_fft::mul_q15(dr, s);
+      const int32_t xi = ei - fixed_fft::mul_q15(dr, c) - fixed_fft::mul_q15(di, s);
+      const int64_t pr = xr >> kPowerShift;
+      const int64_t pi = xi >> kPowerShift;
+      const uint64_t p = static_cast<uint64_t>(pr * pr + pi * pi);
+      out_power[k] = p > 0xFFFFFFFFULL ? 0xFFFFFFFFU : static_cast<uint32_t>(p);
+    }
+  }
+
+  // 2X[k] for a full-scale input reaches 2^15 * N; this keeps typical (windowed, non-sinusoidal) blocks well
+  // inside 32-bit power values while leaving quiet input a few bits of resolution.
+  static constexpr int kPowerShift = N >= 256 ? 8 : 4;
+
+ private:
+  void transform_half() {
+    constexpr size_t kM = N / 2;
+    // Bit-reversal permutation.
+    for (size_t i = 1, j = 0; i < kM; ++i) {
+      size_t bit = kM >> 1;
+      for (; j & bit; bit >>= 1) j ^= bit;
+      j |= bit;
+      if (i < j) {
+        const int32_t tr = re_[i];
+        const int32_t ti = im_[i];
+        re_[i] = re_[j];
+        im_[i] = im_[j];
+        re_[j] = tr;
+        im_[j] = ti;
+      }
+    }
+    for (size_t len = 2; len <= kM; len <<= 1) {
+      const size_t half = len / 2;
+      const size_t stride = fixed_fft::kMaxSize / len;
+      for (size_t start = 0; start < kM; start += len) {
+        for (size_t k = 0; k < half; ++k) {
+          const int32_t c = fixed_fft::cos_q15(k * stride);
+          const int32_t s = fixed_fft::sin_q15(k * stride);
+          const size_t p = start + k;
+          const size_t q = p + half;
+          // t = (c - i s) * x[q]
+          const int32_t tr = fixed_fft::mul_q15(re_[q], c) + fixed_fft::mul_q15(im_[q], s);
+          const int32_t ti = fixed_fft::mul_q15(im_[q], c) - fixed_fft::mul_q15(re_[q], s);
+          re_[q] = re_[p] - tr;
+          im_[q] = im_[p] - ti;
+          re_[p] += tr;
+          im_[p] += ti;
+        }
+      }
+    }
+  }
+
+  int32_t re_[N / 2] = {};
+  int32_t im_[N / 2] = {};
+};
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace chromance {
+namespace core {
+
+// PCM16 view of a RIFF/WAVE image in memory. Samples stay little-endian interleaved; use sample() to read
+// one channel. This is the host-side stand-in for the I2S microphone: native tests and tools load a .wav and
+// feed AudioAnalyzer exactly as the capture task does.
+struct WavPcm16 {
+  uint32_t sample_rate = 0;
+  uint16_t channels = 0;
+  const uint8_t* data = nullptr;
+  size_t frames = 0;
+
+  int16_t sample(size_t frame, uint16_t channel = 0) const {
+    const uint8_t* p = data + (frame * channels + channel) * 2U;
+    return static_cast<int16_t>(static_cast<uint16_t>(p[0] | (p[1] << 8)));
+  }
+};
+
+namespace wav_detail {
+
+inline uint32_t le32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint16_t le16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+
+inline bool tag_is(const uint8_t* p, const char* tag) {
+  return p[0] == tag[0] && p[1] == tag[1] && p[2] == tag[2] && p[3] == tag[3];
+}
+
+}  // namespace wav_detail
+
+// Parses a PCM16 WAV (format 1, any rate, 1+ channels). Unknown chunks are skipped; a truncated data chunk is
+// clipped to the bytes present. Returns false for anything else.
+inline bool parse_wav_pcm16(const uint8_t* bytes, size_t size, WavPcm16* out) {
+  using wav_detail::le16;
+  using wav_detail::le32;
+  using wav_detail::tag_is;
+  if (bytes == nullptr || out == nullptr || size < 12 || !tag_is(bytes, "RIFF") || !tag_is(bytes + 8, "WAVE")) {
+    return false;
+  }
+  WavPcm16 wav;
+  bool have_fmt = false;
+  size_t pos = 12;
+  while (pos + 8U <= size) {
+    const uint8_t* chunk = bytes + pos;
+    const uint32_t len = le32(chunk + 4);
+    const size_t body = pos + 8U;
+    if (tag_is(chunk, "fmt ")) {
+      if (len < 16 || body + 16U > size) return false;
+      const uint16_t format = le16(bytes + body);
+      wav.channels = le16(bytes + body + 2);
+      wav.sample_rate = le32(bytes + body + 4);
+      const uint16_t bits = le16(bytes + body + 14);
+      if (format != 1 || bits != 16 || wav.channels == 0 || wav.sample_rate == 0) return false;
+      have_fmt = true;
+    } else if (tag_is(chunk, "data")) {
+      if (!have_fmt) return false;
+      const size_t avail = size - body;
+      const size_t bytes_len = len < avail ? len : avail;
+      wav.data = bytes + body;
+      wav.frames = bytes_len / (2U * wav.channels);
+      *out = wav;
+      return true;
+    }
+    pos = body + len + (len & 1U);  // chunks are word aligned
+  }
+  return false;
+}
+
+}  // namespace core
+}  // namespace chromance
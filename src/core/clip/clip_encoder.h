@@ -0,0 +1,300 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../types.h"
+#include "clip_format.h"
+
+namespace chromance {
+namespace core {
+
+// Picks a clip palette from the colours a clip actually uses: every frame is binned on a 4-4-4 bit RGB grid
+// and the most used bins (each taken as the average of its pixels) become the palette. Bake-time only; the
+// histogram is ~80 KB, so host tools keep it static.
+class ClipPaletteBuilder final {
+ public:
+  static constexpr size_t kBins = 4096;
+
+  void reset() {
+    memset(count_, 0, sizeof(count_));
+    memset(sum_, 0, sizeof(sum_));
+  }
+
+  void add_frame(const Rgb* rgb, size_t led_count) {
+    for (size_t i = 0; rgb != nullptr && i < led_count; ++i) {
+      const size_t bin = bin_of(rgb[i]);
+      if (count_[bin] == 0xFFFFFFFFU) continue;
+      ++count_[bin];
+      sum_[bin][0] += rgb[i].r;
+      sum_[bin][1] += rgb[i].g;
+      sum_[bin][2] += rgb[i].b;
+    }
+  }
+
+  // Writes up to max_size (<= 256) entries, most used first, and returns the count (0 if nothing was added).
+  // Pure black is always kept exact when present so dark pixels stay fully off.
+  size_t build(Rgb* out_palette, size_t max_size) const {
+    if (out_palette == nullptr) return 0;
+    if (max_size > 256U) max_size = 256U;
+    bool taken[kBins] = {};
+    size_t n = 0;
+    while (n < max_size) {
+      size_t best = kBins;
+      for (size_t b = 0; b < kBins; ++b) {
+        if (!taken[b] && count_[b] != 0 && (best == kBins || count_[b] > count_[best])) best = b;
+      }
+      if (best == kBins) break;
+      taken[best] = true;
+      const uint64_t c = count_[best];
+      out_palette[n++] = best == 0 ? kBlack
+                                   : Rgb{static_cast<uint8_t>((sum_[best][0] + c / 2U) / c),
+                                         static_cast<uint8_t>((sum_[best][1] + c / 2U) / c),
+                                         static_cast<uint8_t>((sum_[best][2] + c / 2U) / c)};
+    }
+    return n;
+  }
+
+ private:
+  static size_t bin_of(const Rgb& c) {
+    return (static_cast<size_t>(c.r >> 4) << 8) | (static_cast<size_t>(c.g >> 4) << 4) | (c.b >> 4);
+  }
+
+  uint32_t count_[kBins];
+  uint64_t sum_[kBins][3];
+};
+
+// Nearest palette entry by squared RGB distance.
+inline uint8_t nearest_palette_index(const Rgb* palette, size_t palette_size, const Rgb& c) {
+  uint32_t best_d = 0xFFFFFFFFU;
+  uint8_t best = 0;
+  for (size_t i = 0; i < palette_size; ++i) {
+    const int32_t dr = static_cast<int32_t>(c.r) - palette[i].r;
+    const int32_t dg = static_cast<int32_t>(c.g) - palette[i].g;
+    const int32_t db = static_cast<int32_t>(c.b) - palette[i].b;
+    const uint32_t d = static_cast<uint32_t>(dr * dr + dg * dg + db * db);
+    if (d < best_d) {
+      best_d = d;
+      best = static_cast<uint8_t>(i);
+      if (d == 0) break;
+    }
+  }
+  return best;
+}
+
+// Streams frames into a clip image in a caller-owned buffer. A frame becomes a keyframe every
+// keyframe_interval frames (bounding seek cost) or whenever its delta would not be smaller; everything else is
+// stored as changed-LED runs against the previous frame. finish() appends the keyframe table and patches the
+// header. All storage is inline: MaxLeds bytes of previous frame plus the keyframe table.
+template <size_t MaxLeds, size_t MaxKeyframes>
+class ClipEncoder final {
+  static_assert(MaxLeds > 0 && MaxLeds <= clip::kMaxGap + 1U, "delta gaps are 15-bit");
+
+ public:
+  struct Stats {
+    uint32_t frames;
+    uint32_t keyframes;
+    uint32_t changed_leds;  // over all delta frames
+  };
+
+  bool begin(uint8_t* out, size_t capacity, uint16_t led_count, uint16_t fps, uint32_t mapping_hash,
+             const Rgb* palette, uint16_t palette_size, uint32_t keyframe_interval) {
+    out_ = nullptr;
+    const size_t frames_at = clip::kHeaderBytes + static_cast<size_t>(palette_size) * 3U;
+    if (out == nullptr || led_count == 0 || led_count > MaxLeds || fps == 0 || palette == nullptr ||
+        palette_size == 0 || palette_size > 256 || capacity < frames_at) {
+      return false;
+    }
+    out_ = out;
+    capacity_ = capacity;
+    led_count_ = led_count;
+    keyframe_interval_ = keyframe_interval == 0 ? 1U : keyframe_interval;
+    palette_ = palette;
+    palette_size_ = palette_size;
+    stats_ = Stats{};
+    since_key_ = 0;
+    overflow_ = false;
+
+    memset(out_, 0, clip::kHeaderBytes);
+    memcpy(out_, "CHCL", 4);
+    clip::wr16(out_ + 4, clip::kVersion);
+    clip::wr16(out_ + 6, led_count);
+    clip::wr32(out_ + 8, mapping_hash);
+    clip::wr16(out_ + 16, fps);
+    clip::wr16(out_ + 18, palette_size);
+    for (uint16_t i = 0; i < palette_size; ++i) {
+      out_[clip::kHeaderBytes + i * 3U] = palette[i].r;
+      out_[clip::kHeaderBytes + i * 3U + 1U] = palette[i].g;
+      out_[clip::kHeaderBytes + i * 3U + 2U] = palette[i].b;
+    }
+    size_ = frames_at;
+    return true;
+  }
+
+  // Quantizes an RGB frame to the palette and appends it.
+  bool add_frame(const Rgb* rgb) {
+    if (out_ == nullptr || rgb == nullptr) return false;
+    for (size_t i = 0; i < led_count_; ++i) {
+      next_[i] = nearest_palette_index(palette_, palette_size_, rgb[i]);
+    }
+    return add_indices(next_);
+  }
+
+  bool add_indices(const uint8_t* indices) {
+    if (out_ == nullptr || overflow_ || indices == nullptr) return false;
+    for (size_t i = 0; i < led_count_; ++i) {
+      if (indices[i] >= palette_size_) return false;
+    }
+
+    size_t delta_bytes = 3;
+    uint32_t changes = 0;
+    if (stats_.frames != 0) {
+      size_t last = 0;
+      for (size_t i = 0; i < led_count_; ++i) {
+        if (indices[i] == prev_[i]) continue;
+        const size_t gap = i - last;
+        delta_bytes += (gap < 0x80U ? 1U : 2U) + 1U;
+        last = i + 1U;
+        ++changes;
+      }
+    }
+    const size_t key_bytes = 1U + led_count_;
+    const bool key = stats_.frames == 0 || since_key_ + 1U >= keyframe_interval_ || delta_bytes >= key_bytes;
+    if (key && stats_.keyframes >= MaxKeyframes) return fail();
+
+    if (key) {
+      if (!reserve(key_bytes)) return fail();
+      key_frame_[stats_.keyframes] = stats_.frames;
+      key_offset_[stats_.keyframes] = static_cast<uint32_t>(size_);
+      ++stats_.keyframes;
+      since_key_ = 0;
+      out_[size_++] = clip::kFrameKey;
+      memcpy(out_ + size_, indices, led_count_);
+      size_ += led_count_;
+    } else {
+      if (!reserve(delta_bytes)) return fail();
+      ++since_key_;
+      stats_.changed_leds += changes;
+      out_[size_++] = clip::kFrameDelta;
+      clip::wr16(out_ + size_, static_cast<uint16_t>(changes));
+      size_ += 2;
+      size_t last = 0;
+      for (size_t i = 0; i < led_count_; ++i) {
+        if (indices[i] == prev_[i]) continue;
+        const size_t gap = i - last;
+        if (gap < 0x80U) {
+          out_[size_++] = static_cast<uint8_t>(gap);
+        } else {
+          out_[size_++] = static_cast<uint8_t>(0x80U | (gap >> 8));
+          out_[size_++] = static_cast<uint8_t>(gap);
+        }
+        out_[size_++] = indices[i];
+        last = i + 1U;
+      }
+    }
+    memcpy(prev_, indices, led_count_);
+    ++stats_.frames;
+    return true;
+  }
+
+  // Appends the keyframe table and completes the header. Returns the clip size, or 0 if any frame failed.
+  size_t finish() {
+    if (out_ == nullptr || overflow_ || stats_.frames == 0) return 0;
+    const size_t table = size_;
+    if (!reserve(static_cast<size_t>(stats_.keyframes) * 8U)) return 0;
+    for (uint32_t k = 0; k < stats_.keyframes; ++k) {
+      clip::wr32(out_ + size_, key_frame_[k]);
+      clip::wr32(out_ + size_ + 4U, key_offset_[k]);
+      size_ += 8U;
+    }
+    clip::wr32(out_ + 12, stats_.frames);
+    clip::wr32(out_ + 20, stats_.keyframes);
+    clip::wr32(out_ + 24, static_cast<uint32_t>(table));
+    clip::wr32(out_ + 28, static_cast<uint32_t>(size_));
+    return size_;
+  }
+
+  const Stats& stats() const { return stats_; }
+  size_t size() const { return size_; }
+
+ private:
+  bool reserve(size_t bytes) {
+    if (capacity_ - size_ < bytes) {
+      overflow_ = true;
+      return false;
+    }
+    return true;
+  }
+
+  bool fail() {
+    overflow_ = true;
+    return false;
+  }
+
+  uint8_t* out_ = nullptr;
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+  uint16_t led_count_ = 0;
+  uint32_t keyframe_interval_ = 1;
+  const Rgb* palette_ = nullptr;
+  uint16_t palette_size_ = 0;
+  Stats stats_{};
+  uint32_t since_key_ = 0;
+  bool overflow_ = false;
+  uint8_t prev_[MaxLeds] = {};
+  uint8_t next_[MaxLeds] = {};
+  uint32_t key_frame_[MaxKeyframes] = {};
+  uint32_t key_offset_[MaxKeyframes] = {};
+};
+
+// Lays clips out as a bundle (clip_format.h) in a caller-owned buffer.
+class ClipBundleWriter final {
+ public:
+  bool begin(uint8_t* out, size_t capacity, uint16_t clip_count) {
+    const size_t dir = clip::kBundleHeaderBytes + static_cast<size_t>(clip_count) * clip::kBundleEntryBytes;
+    out_ = nullptr;
+    if (out == nullptr || capacity < dir) return false;
+    out_ = out;
+    capacity_ = capacity;
+    clip_count_ = clip_count;
+    added_ = 0;
+    memset(out_, 0, dir);
+    memcpy(out_, "CHCB", 4);
+    clip::wr16(out_ + 4, clip::kVersion);
+    clip::wr16(out_ + 6, clip_count);
+    size_ = dir;
+    return true;
+  }
+
+  bool add(const char* name, const uint8_t* clip_data, size_t clip_size) {
+    if (out_ == nullptr || name == nullptr || clip_data == nullptr || added_ >= clip_count_ ||
+        strlen(name) >= clip::kNameBytes) {
+      return false;
+    }
+    const size_t at = (size_ + 3U) & ~static_cast<size_t>(3U);
+    if (at > capacity_ || capacity_ - at < clip_size) return false;
+    memset(out_ + size_, 0, at - size_);
+    memcpy(out_ + at, clip_data, clip_size);
+    uint8_t* e = out_ + clip::kBundleHeaderBytes + static_cast<size_t>(added_) * clip::kBundleEntryBytes;
+    memcpy(e, name, strlen(name));
+    clip::wr32(e + clip::kNameBytes, static_cast<uint32_t>(at));
+    clip::wr32(e + clip::kNameBytes + 4, static_cast<uint32_t>(clip_size));
+    size_ = at + clip_size;
+    ++added_;
+    return true;
+  }
+
+  // Bundle size once every declared clip has been added, else 0.
+  size_t finish() const { return (out_ != nullptr && added_ == clip_count_) ? size_ : 0; }
+
+ private:
+  uint8_t* out_ = nullptr;
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+  uint16_t clip_count_ = 0;
+  uint16_t added_ = 0;
+};
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../types.h"
+
+namespace chromance {
+namespace core {
+
+// Baked animation clips: pre-rendered effect output, palette-indexed, one keyframe every so often and per-LED
+// deltas in between. Clips are read in place (memory-mapped flash), so the layout is byte-oriented and
+// little-endian with no alignment requirements.
+//
+// Clip:
+//   0  "CHCL"
+//   4  u16 version (kVersion)
+//   6  u16 led_count
+//   8  u32 mapping_hash      clip::mapping_hash(MappingTables::mapping_version()) at bake time
+//   12 u32 frame_count
+//   16 u16 fps
+//   18 u16 palette_size      1..256
+//   20 u32 keyframe_count
+//   24 u32 keyframe_table    offset of keyframe_count x {u32 frame, u32 offset}, ascending
+//   28 u32 total_size
+//   32 palette               palette_size x {r, g, b}
+//   .. frames                key:   0x00, led_count palette indices
+//                            delta: 0x01, u16 changes, changes x {gap, index}; gap = LEDs skipped since the
+//                                   previous change, one byte below 0x80, else two (0x80 | hi7, lo8)
+//
+// Bundle (what a clip partition holds):
+//   0  "CHCB"
+//   4  u16 version
+//   6  u16 clip_count
+//   8  clip_count x {char name[24] (NUL padded), u32 offset, u32 size}
+//   .. clips, each 4-byte aligned
+namespace clip {
+
+constexpr uint16_t kVersion = 1;
+constexpr size_t kHeaderBytes = 32;
+constexpr size_t kBundleHeaderBytes = 8;
+constexpr size_t kBundleEntryBytes = 32;
+constexpr size_t kNameBytes = 24;
+constexpr uint8_t kFrameKey = 0;
+constexpr uint8_t kFrameDelta = 1;
+constexpr uint16_t kMaxGap = 0x7FFF;
+
+inline uint16_t rd16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+inline uint32_t rd32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+inline void wr16(uint8_t* p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+inline void wr32(uint8_t* p, uint32_t v) {
+  wr16(p, static_cast<uint16_t>(v));
+  wr16(p + 2, static_cast<uint16_t>(v >> 16));
+}
+
+// FNV-1a of the mapping version string: clips baked for another LED layout are rejected.
+inline uint32_t mapping_hash(const char* version) {
+  uint32_t h = 2166136261U;
+  for (const char* p = version; p != nullptr && *p; ++p) {
+    h = (h ^ static_cast<uint8_t>(*p)) * 16777619U;
+  }
+  return h;
+}
+
+}  // namespace clip
+
+// Validated view of one clip plus a forward decoder over palette indices. The decoder keeps only a byte
+// offset and a frame number; the caller owns the index buffer (led_count bytes).
+class ClipReader final {
+ public:
+  bool open(const uint8_t* data, size_t size) {
+    data_ = nullptr;
+    if (data == nullptr || size < clip::kHeaderBytes || memcmp(data, "CHCL", 4) != 0 ||
+        clip::rd16(data + 4) != clip::kVersion) {
+      return false;
+    }
+    const uint16_t leds = clip::rd16(data + 6);
+    const uint32_t frames = clip::rd32(data + 12);
+    const uint16_t fps = clip::rd16(data + 16);
+    const uint16_t palette = clip::rd16(data + 18);
+    const uint32_t keys = clip::rd32(data + 20);
+    const uint32_t table = clip::rd32(data + 24);
+    const uint32_t total = clip::rd32(data + 28);
+    const size_t frames_at = clip::kHeaderBytes + static_cast<size_t>(palette) * 3U;
+    if (leds == 0 || frames == 0 || fps == 0 || palette == 0 || palette > 256 || keys == 0 || total > size ||
+        frames_at > table || table > total || (total - table) / 8U < keys) {
+      return false;
+    }
+    // The first keyframe must be frame 0 so playback can always restart.
+    if (clip::rd32(data + table) != 0 || clip::rd32(data + table + 4) != frames_at) {
+      return false;
+    }
+    data_ = data;
+    led_count_ = leds;
+    frame_count_ = frames;
+    fps_ = fps;
+    palette_size_ = palette;
+    keyframe_count_ = keys;
+    table_ = table;
+    frames_at_ = frames_at;
+    rewind();
+    return true;
+  }
+
+  bool valid() const { return data_ != nullptr; }
+  uint16_t led_count() const { return led_count_; }
+  uint32_t frame_count() const { return frame_count_; }
+  uint16_t fps() const { return fps_; }
+  uint32_t mapping_hash() const { return data_ ? clip::rd32(data_ + 8) : 0; }
+  uint16_t palette_size() const { return palette_size_; }
+  Rgb palette(uint8_t i) const {
+    if (data_ == nullptr || i >= palette_size_) return kBlack;
+    const uint8_t* p = data_ + clip::kHeaderBytes + static_cast<size_t>(i) * 3U;
+    return Rgb{p[0], p[1], p[2]};
+  }
+  const uint8_t* palette_bytes() const { return data_ ? data_ + clip::kHeaderBytes : nullptr; }
+
+  // Index of the next frame decode_next() will produce (frame_count() when the clip has ended).
+  uint32_t next_frame() const { return next_frame_; }
+
+  void rewind() {
+    next_frame_ = 0;
+    offset_ = frames_at_;
+  }
+
+  // Applies the next frame to indices (led_count bytes). False at the end of the clip or on corrupt data.
+  bool decode_next(uint8_t* indices) {
+    if (data_ == nullptr || indices == nullptr || next_frame_ >= frame_count_ || offset_ >= table_) {
+      return false;
+    }
+    const uint8_t* p = data_ + offset_;
+    const uint8_t* end = data_ + table_;
+    const uint8_t type = *p++;
+    if (type == clip::kFrameKey) {
+      if (static_cast<size_t>(end - p) < led_count_) return false;
+      memcpy(indices, p, led_count_);
+      p += led_count_;
+    } else if (type == clip::kFrameDelta) {
+      if (end - p < 2) return false;
+      const uint16_t changes = clip::rd16(p);
+      p += 2;
+      size_t led = 0;
+      for (uint16_t c = 0; c < changes; ++c) {
+        if (end - p < 2) return false;
+        size_t gap = *p++;
+        if (gap & 0x80U) {
+          if (end - p < 2) return false;
+          gap = ((gap & 0x7FU) << 8) | *p++;
+        }
+        led += gap;
+        if (led >= led_count_) return false;
+        indices[led++] = *p++;
+      }
+    } else {
+      return false;
+    }
+    offset_ = static_cast<uint32_t>(p - data_);
+    ++next_frame_;
+    return true;
+  }
+
+  // Positions the decoder so that indices holds frame (decoding from the nearest keyframe at or before it).
+  bool seek(uint32_t frame, uint8_t* indices) {
+    if (data_ == nullptr || frame >= frame_count_) {
+      return false;
+    }
+    // indices holds frame next_frame_ - 1; anything earlier (or nothing decoded yet) needs a keyframe.
+    const bool behind = next_frame_ == 0 || frame + 1U < next_frame_;
+    if (behind || frame >= next_frame_ + kMaxForwardDecode) {
+      // Last keyframe <= frame.
+      uint32_t lo = 0;
+      uint32_t hi = keyframe_count_;
+      while (hi - lo > 1U) {
+        const uint32_t mid = (lo + hi) / 2U;
+        if (clip::rd32(data_ + table_ + mid * 8U) <= frame) {
+          lo = mid;
+        } else {
+          hi = mid;
+        }
+      }
+      const uint32_t key_frame = clip::rd32(data_ + table_ + lo * 8U);
+      if (behind || key_frame >= next_frame_) {
+        next_frame_ = key_frame;
+        offset_ = clip::rd32(data_ + table_ + lo * 8U + 4U);
+      }
+    }
+    while (next_frame_ <= frame) {
+      if (!decode_next(indices)) return false;
+    }
+    return true;
+  }
+
+ private:
+  // Beyond this many frames ahead a seek restarts from a keyframe instead of decoding every delta.
+  static constexpr uint32_t kMaxForwardDecode = 8;
+
+  const uint8_t* data_ = nullptr;
+  uint16_t led_count_ = 0;
+  uint32_t frame_count_ = 0;
+  uint16_t fps_ = 0;
+  uint16_t palette_size_ = 0;
+  uint32_t keyframe_count_ = 0;
+  uint32_t table_ = 0;
+  size_t frames_at_ = 0;
+  uint32_t next_frame_ = 0;
+  uint32_t offset_ = 0;
+};
+
+// Directory of a clip bundle.
+class ClipBundle final {
+ public:
+  bool open(const uint8_t* data, size_t size) {
+    data_ = nullptr;
+    if (data == nullptr || size < clip::kBundleHeaderBytes || memcmp(data, "CHCB", 4) != 0 ||
+        clip::rd16(data + 4) != clip::kVersion) {
+      return false;
+    }
+    const uint16_t count = clip::rd16(data + 6);
+    if (clip::kBundleHeaderBytes + static_cast<size_t>(count) * clip::kBundleEntryBytes > size) {
+      return false;
+    }
+    for (uint16_t i = 0; i < count; ++i) {
+      const uint8_t* e = data + clip::kBundleHeaderBytes + static_cast<size_t>(i) * clip::kBundleEntryBytes;
+      const uint32_t off = clip::rd32(e + clip::kNameBytes);
+      const uint32_t len = clip::rd32(e + clip::kNameBytes + 4);
+      if (off > size || len > size - off || e[clip::kNameBytes - 1] != '\0') return false;
+    }
+    data_ = data;
+    count_ = count;
+    return true;
+  }
+
+  uint16_t count() const { return count_; }
+
+  const char* name_at(uint16_t i) const {
+    return (data_ != nullptr && i < count_)
+               ? reinterpret_cast<const char*>(data_ + clip::kBundleHeaderBytes + i * clip::kBundleEntryBytes)
+               : nullptr;
+  }
+
+  bool clip_at(uint16_t i, const uint8_t** out_data, size_t* out_size) const {
+    if (data_ == nullptr || i >= count_ || out_data == nullptr || out_size == nullptr) return false;
+    const uint8_t* e = data_ + clip::kBundleHeaderBytes + static_cast<size_t>(i) * clip::kBundleEntryBytes;
+    *out_data = data_ + clip::rd32(e + clip::kNameBytes);
+    *out_size = clip::rd32(e + clip::kNameBytes + 4);
+    return true;
+  }
+
+  bool find(const char* name, const uint8_t** out_data, size_t* out_size) const {
+    for (uint16_t i = 0; name != nullptr && i < count_; ++i) {
+      if (strncmp(name_at(i), name, clip::kNameBytes) == 0) return clip_at(i, out_data, out_size);
+    }
+    return false;
+  }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  uint16_t count_ = 0;
+};
+
+}  // namespace core
+}  // namespace chromance
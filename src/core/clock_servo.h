@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace chromance {
+namespace core {
+
+// Disciplines the local microsecond clock to a remote one (the sync leader) from one-way timestamps: the remote
+// clock when a beacon was sent and the local clock when it was read. Both are 64-bit boot-relative counters
+// (esp_timer_get_time() on the ESP32), so offsets never wrap.
+//
+// Network and polling delay only ever make a sample look late, so each correction uses the least delayed sample
+// of the last kWindow (the one with the largest error). A correction slews the offset by half that error, at
+// most kMaxSlewUs, and trims a frequency term that tracks crystal drift between the two boards. Only the first
+// window (lock), or a later whole window more than kStepUs off (remote reboot), steps the clock.
+//
+// The estimate carries the minimum delay as a constant bias; set_latency_us() compensates a known one.
+class ClockServo final {
+ public:
+  static constexpr uint8_t kWindow = 8;
+  static constexpr int32_t kStepUs = 20000;
+  static constexpr int32_t kMaxSlewUs = 250;
+  static constexpr int32_t kMaxDriftPpb = 500000;  // 500 ppm, far beyond any crystal
+
+  void reset() {
+    locked_ = false;
+    base_local_us_ = 0;
+    base_offset_us_ = 0;
+    drift_ppb_ = 0;
+    window_count_ = 0;
+    window_best_us_ = 0;
+    last_error_us_ = 0;
+  }
+
+  void set_latency_us(uint32_t us) { latency_us_ = us; }
+
+  void on_sample(uint64_t remote_us, uint64_t local_us) {
+    ++samples_;
+    const int64_t measured = static_cast<int64_t>(remote_us + latency_us_ - local_us);
+    if (!locked_) {
+      // Unlocked, base_offset_us_ holds the best offset of the first window.
+      if (window_count_ == 0 || measured > base_offset_us_) {
+        base_offset_us_ = measured;
+        base_local_us_ = local_us;
+      }
+      if (++window_count_ == kWindow) {
+        step(base_offset_us_, base_local_us_);
+      }
+      return;
+    }
+    const int32_t err = saturate32(measured - offset_at(local_us));
+    if (window_count_ == 0 || err > window_best_us_) {
+      window_best_us_ = err;
+    }
+    if (++window_count_ < kWindow) {
+      return;
+    }
+    window_count_ = 0;
+    last_error_us_ = window_best_us_;
+    if (window_best_us_ > kStepUs || window_best_us_ < -kStepUs) {
+      step(offset_at(local_us) + window_best_us_, local_us);
+      return;
+    }
+    slew(window_best_us_, local_us);
+  }
+
+  // The remote clock at local time local_us (local_us itself until the first sample).
+  uint64_t remote_us(uint64_t local_us) const {
+    return locked_ ? static_cast<uint64_t>(static_cast<int64_t>(local_us) + offset_at(local_us)) : local_us;
+  }
+
+  bool locked() const { return locked_; }
+  // Filtered error (remote - estimate) at the last correction.
+  int32_t last_error_us() const { return last_error_us_; }
+  int32_t drift_ppb() const { return drift_ppb_; }
+  uint32_t samples() const { return samples_; }
+  uint32_t steps() const { return steps_; }
+  uint32_t corrections() const { return corrections_; }
+
+ private:
+  static int32_t saturate32(int64_t v) {
+    return v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : static_cast<int32_t>(v));
+  }
+
+  int64_t offset_at(uint64_t local_us) const {
+    const int64_t elapsed = static_cast<int64_t>(local_us - base_local_us_);
+    return base_offset_us_ + elapsed * drift_ppb_ / 1000000000LL;
+  }
+
+  void step(int64_t offset_us, uint64_t local_us) {
+    locked_ = true;
+    base_local_us_ = local_us;
+    base_offset_us_ = offset_us;
+    window_count_ = 0;
+    ++steps_;
+  }
+
+  void slew(int32_t err_us, uint64_t local_us) {
+    const int64_t interval_us = static_cast<int64_t>(local_us - base_local_us_);
+    base_offset_us_ = offset_at(local_us);
+    base_local_us_ = local_us;
+
+    int32_t adj = err_us / 2;
+    const bool limited = adj > kMaxSlewUs || adj < -kMaxSlewUs;
+    if (adj > kMaxSlewUs) adj = kMaxSlewUs;
+    if (adj < -kMaxSlewUs) adj = -kMaxSlewUs;
+    base_offset_us_ += adj;
+
+    // While the slew is limited the error is mostly phase, not frequency: leave the drift term alone so it does
+    // not wind up and overshoot once the phase has caught up.
+    if (!limited && interval_us > 0) {
+      int64_t drift = drift_ppb_ + static_cast<int64_t>(err_us) * 1000000000LL / interval_us / 16;
+      if (drift > kMaxDriftPpb) drift = kMaxDriftPpb;
+      if (drift < -kMaxDriftPpb) drift = -kMaxDriftPpb;
+      drift_ppb_ = static_cast<int32_t>(drift);
+    }
+    ++corrections_;
+  }
+
+  bool locked_ = false;
+  uint32_t latency_us_ = 0;
+  uint64_t base_local_us_ = 0;
+  int64_t base_offset_us_ = 0;
+  int32_t drift_ppb_ = 0;
+  uint8_t window_count_ = 0;
+  int32_t window_best_us_ = 0;
+  int32_t last_error_us_ = 0;
+  uint32_t samples_ = 0;
+  uint32_t steps_ = 0;
+  uint32_t corrections_ = 0;
+};
+
+}  // namespace core
+}  // namespace chromance
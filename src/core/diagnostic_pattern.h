@@ -48,13 +48,10 @@ class DiagnosticPattern {
     SegmentDiagnostics,
   };
 
-  explicit DiagnosticPattern(Timing timing = Timing())
-      : timing_(timing),
-        strip_sms_{DiagnosticStripStateMachine(kStripConfigs[0].segment_count, timing_.segment),
-                   DiagnosticStripStateMachine(kStripConfigs[1].segment_count, timing_.segment),
-                   DiagnosticStripStateMachine(kStripConfigs[2].segment_count, timing_.segment),
-                   DiagnosticStripStateMachine(kStripConfigs[3].segment_count, timing_.segment)} {
-    static_assert(kStripCount == 4, "update constructor if kStripCount changes");
+  explicit DiagnosticPattern(Timing timing = Timing()) : timing_(timing) {
+    for (uint8_t i = 0; i < kStripCount; ++i) {
+      strip_sms_[i] = DiagnosticStripStateMachine(strip_config(i).segment_count, timing_.segment);
+    }
     reset(0);
   }
 
@@ -120,7 +117,7 @@ class DiagnosticPattern {
     const bool all_off = phase_ == Phase::AllOffHold || phase_ == Phase::AllFlashOff;
 
     for (uint8_t strip = 0; strip < kStripCount; ++strip) {
-      const StripConfig& cfg = kStripConfigs[strip];
+      const StripConfig cfg = strip_config(strip);
 
       for (uint16_t seg = 0; seg < cfg.segment_count; ++seg) {
         if (all_on) {
@@ -35,7 +35,7 @@ class DiagnosticStripStateMachine {
     DoneFullOn,
   };
 
-  explicit DiagnosticStripStateMachine(uint16_t segment_count,
+  explicit DiagnosticStripStateMachine(uint16_t segment_count = 0,
                                        SegmentDiagnosticTiming timing = SegmentDiagnosticTiming())
       : segment_count_(segment_count), timing_(timing) {
     reset(0);
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../types.h"
+
+namespace chromance {
+namespace core {
+
+// Frame blend kernels (crossfades and layer compositing). Rgb buffers are tightly packed bytes, so the kernels work on 4 bytes at a time as one
+// 32-bit word (channel boundaries do not matter for per-byte ops) with a byte loop for the tail.
+
+// Per-byte linear interpolation of four packed bytes: a + (b - a) * t / 256, t in [0, 256].
+// Even and odd bytes are split into 0x00FF00FF lanes so each 16-bit lane holds one product without carry.
+inline uint32_t lerp_packed4(uint32_t a, uint32_t b, uint32_t t) {
+  const uint32_t s = 256U - t;
+  const uint32_t even = (((a & 0x00FF00FFU) * s + (b & 0x00FF00FFU) * t) >> 8) & 0x00FF00FFU;
+  const uint32_t odd = (((a >> 8) & 0x00FF00FFU) * s + ((b >> 8) & 0x00FF00FFU) * t) & 0xFF00FF00U;
+  return even | odd;
+}
+
+inline uint8_t lerp_u8(uint8_t a, uint8_t b, uint32_t t) {
+  return static_cast<uint8_t>((static_cast<uint32_t>(a) * (256U - t) + static_cast<uint32_t>(b) * t) >> 8);
+}
+
+// out[i] = lerp(from[i], to[i], t256). out may alias from or to. t256 = 0 gives from, 256 gives to.
+inline void blend_crossfade(const Rgb* from, const Rgb* to, Rgb* out, size_t count, uint16_t t256) {
+  if (from == nullptr || to == nullptr || out == nullptr) {
+    return;
+  }
+  const uint32_t t = t256 > 256U ? 256U : t256;
+  const uint8_t* a = reinterpret_cast<const uint8_t*>(from);
+  const uint8_t* b = reinterpret_cast<const uint8_t*>(to);
+  uint8_t* o = reinterpret_cast<uint8_t*>(out);
+  const size_t bytes = count * sizeof(Rgb);
+  size_t i = 0;
+  for (; i + 4U <= bytes; i += 4U) {
+    uint32_t wa = 0;
+    uint32_t wb = 0;
+    memcpy(&wa, a + i, 4);
+    memcpy(&wb, b + i, 4);
+    const uint32_t wo = lerp_packed4(wa, wb, t);
+    memcpy(o + i, &wo, 4);
+  }
+  for (; i < bytes; ++i) {
+    o[i] = lerp_u8(a[i], b[i], t);
+  }
+}
+
+// Layer blend modes, applied per channel. kAlpha replaces the lower layer; opacity then mixes each mode's
+// result over the lower layer (opacity 255 = full effect).
+enum class BlendMode : uint8_t { kAdd = 0, kScreen = 1, kMax = 2, kAlpha = 3, kMultiply = 4 };
+
+constexpr uint8_t kBlendModeCount = 5;
+
+inline const char* blend_mode_name(BlendMode m) {
+  switch (m) {
+    case BlendMode::kAdd:
+      return "add";
+    case BlendMode::kScreen:
+      return "screen";
+    case BlendMode::kMax:
+      return "max";
+    case BlendMode::kAlpha:
+      return "alpha";
+    case BlendMode::kMultiply:
+      return "multiply";
+    default:
+      return "?";
+  }
+}
+
+// Per-byte saturating add of four packed bytes. The low 7 bits of each byte are summed without crossing into
+// the next byte; the carry out of bit 7 is rebuilt from the operands and widened into a 0xFF saturation mask.
+inline uint32_t add_sat_packed4(uint32_t a, uint32_t b) {
+  const uint32_t low = (a & 0x7F7F7F7FU) + (b & 0x7F7F7F7FU);
+  const uint32_t sum = low ^ ((a ^ b) & 0x80808080U);
+  const uint32_t carry = ((a & b) | ((a | b) & low)) & 0x80808080U;
+  return sum | ((carry >> 7) * 0xFFU);
+}
+
+// Per-byte maximum of four packed bytes. In each 16-bit lane (x | 0x100) - y keeps bit 8 set iff x >= y.
+inline uint32_t max_packed4(uint32_t a, uint32_t b) {
+  const uint32_t ae = a & 0x00FF00FFU;
+  const uint32_t be = b & 0x00FF00FFU;
+  const uint32_t ao = (a >> 8) & 0x00FF00FFU;
+  const uint32_t bo = (b >> 8) & 0x00FF00FFU;
+  const uint32_t me = ((((ae | 0x01000100U) - be) >> 8) & 0x00010001U) * 0xFFU;
+  const uint32_t mo = ((((ao | 0x01000100U) - bo) >> 8) & 0x00010001U) * 0xFFU;
+  const uint32_t even = (ae & me) | (be & ~me & 0x00FF00FFU);
+  const uint32_t odd = (ao & mo) | (bo & ~mo & 0x00FF00FFU);
+  return even | (odd << 8);
+}
+
+// x * y / 255, rounded. Multiply and screen need the product of two varying bytes, which a 32-bit multiply
+// cannot do for more than one lane, so they stay per byte.
+inline uint8_t mul_u8(uint8_t x, uint8_t y) {
+  const uint32_t t = static_cast<uint32_t>(x) * y + 128U;
+  return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+inline uint8_t blend_u8(BlendMode mode, uint8_t d, uint8_t s) {
+  switch (mode) {
+    case BlendMode::kAdd: {
+      const uint32_t v = static_cast<uint32_t>(d) + s;
+      return static_cast<uint8_t>(v > 255U ? 255U : v);
+    }
+    case BlendMode::kScreen:
+      return static_cast<uint8_t>(255U - mul_u8(static_cast<uint8_t>(255U - d), static_cast<uint8_t>(255U - s)));
+    case BlendMode::kMax:
+      return d > s ? d : s;
+    case BlendMode::kMultiply:
+      return mul_u8(d, s);
+    case BlendMode::kAlpha:
+    default:
+      return s;
+  }
+}
+
+// Maps an 8-bit opacity onto the 0..256 lerp weight (255 -> 256, so full opacity is exact).
+inline uint32_t opacity_to_t256(uint8_t opacity) { return static_cast<uint32_t>(opacity) + (opacity >> 7); }
+
+namespace detail {
+
+template <typename WordOp>
+inline void blend_words(uint8_t* d, const uint8_t* s, size_t bytes, uint32_t t, BlendMode mode, WordOp op) {
+  size_t i = 0;
+  for (; i + 4U <= bytes; i += 4U) {
+    uint32_t wd = 0;
+    uint32_t ws = 0;
+    memcpy(&wd, d + i, 4);
+    memcpy(&ws, s + i, 4);
+    uint32_t wo = op(wd, ws);
+    if (t < 256U) wo = lerp_packed4(wd, wo, t);
+    memcpy(d + i, &wo, 4);
+  }
+  for (; i < bytes; ++i) {
+    d[i] = lerp_u8(d[i], blend_u8(mode, d[i], s[i]), t);
+  }
+}
+
+}  // namespace detail
+
+// dst[i] = lerp(dst[i], mode(dst[i], src[i]), opacity). Add, max and alpha run four bytes per step; screen and
+// multiply run per byte (see mul_u8). Opacity 0 leaves dst untouched.
+inline void blend_layer(Rgb* dst, const Rgb* src, size_t count, BlendMode mode, uint8_t opacity) {
+  if (dst == nullptr || src == nullptr || opacity == 0) {
+    return;
+  }
+  const uint32_t t = opacity_to_t256(opacity);
+  uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+  const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+  const size_t bytes = count * sizeof(Rgb);
+  switch (mode) {
+    case BlendMode::kAdd:
+      detail::blend_words(d, s, bytes, t, mode, add_sat_packed4);
+      return;
+    case BlendMode::kMax:
+      detail::blend_words(d, s, bytes, t, mode, max_packed4);
+      return;
+    case BlendMode::kAlpha:
+      blend_crossfade(dst, src, dst, count, static_cast<uint16_t>(t));
+      return;
+    case BlendMode::kScreen:
+    case BlendMode::kMultiply:
+    default:
+      for (size_t i = 0; i < bytes; ++i) {
+        const uint8_t v = blend_u8(mode, d[i], s[i]);
+        d[i] = t < 256U ? lerp_u8(d[i], v, t) : v;
+      }
+      return;
+  }
+}
+
+// Scales a frame towards black: out[i] = out[i] * level / 255, four bytes per step.
+inline void scale_frame(Rgb* out, size_t count, uint8_t level) {
+  if (out == nullptr || level == 255) {
+    return;
+  }
+  const uint32_t t = opacity_to_t256(level);
+  uint8_t* o = reinterpret_cast<uint8_t*>(out);
+  const size_t bytes = count * sizeof(Rgb);
+  size_t i = 0;
+  for (; i + 4U <= bytes; i += 4U) {
+    uint32_t w = 0;
+    memcpy(&w, o + i, 4);
+    w = lerp_packed4(0, w, t);
+    memcpy(o + i, &w, 4);
+  }
+  for (; i < bytes; ++i) {
+    o[i] = lerp_u8(0, o[i], t);
+  }
+}
+
+}  // namespace core
+}  // namespace chromance
@@ -4,14 +4,20 @@
 #include <stdint.h>
 
 #include "effect_params.h"
+#include "effect_scratch.h"
 #include "signals.h"
 
+#include "../layout.h"
 #include "../mapping/pixels_map.h"
 #include "../types.h"
 
 namespace chromance {
 namespace core {
 
+// next_change_ms() offset for frames that only change on input (events, params, brightness). Kept below 2^31
+// so wrap-safe time comparisons still order it after now.
+constexpr uint32_t kNoChangeAheadMs = 0x3FFFFFFFU;
+
 struct EffectFrame {
   uint32_t now_ms = 0;
   uint32_t dt_ms = 0;
@@ -24,10 +30,37 @@ class IEffect {
   virtual ~IEffect() = default;
   virtual const char* id() const = 0;
   virtual void reset(uint32_t now_ms) = 0;
+
+  // Optional warm-up: build caches derived only from the mapping (never runtime state) so the first render
+  // after reset() stays cheap. Must be idempotent; reset() keeps what prepare() built.
+  virtual bool needs_prepare() const { return false; }
+  virtual void prepare(size_t led_count) { (void)led_count; }
+
+  // Optional per-activation working memory (see effect_scratch.h): state that only matters while the effect
+  // runs. scratch_bytes() is fixed once the effect is set up; the adapter binds that much before reset() on
+  // activation and an empty scratch after deactivation. Effects that need scratch and have none render black.
+  virtual size_t scratch_bytes() const { return 0; }
+  virtual void bind_scratch(const EffectScratch& scratch) { (void)scratch; }
+
+  // Optional idle hint, queried right after render(now_ms): the earliest time a later render() may produce a
+  // different frame, assuming no input, param or brightness change in between. The default (now_ms) means
+  // "may change every frame"; effects that hold still return a later time so the frame is not redrawn.
+  virtual uint32_t next_change_ms(uint32_t now_ms) const { return now_ms; }
   virtual void render(const EffectFrame& frame,
                       const PixelsMap& map,
                       Rgb* out_rgb,
                       size_t led_count) = 0;
+
+  // Optional: the same frame as render(), written straight as wire pixels (StripPixel, see apa102.h) for outputs
+  // that send it as is (ILedOutput::show_wire). Returns false, having written nothing, if the effect only
+  // renders Rgb.
+  virtual bool render_wire(const EffectFrame& frame, const PixelsMap& map, StripPixel* out, size_t led_count) {
+    (void)frame;
+    (void)map;
+    (void)out;
+    (void)led_count;
+    return false;
+  }
 };
 
 }  // namespace core
@@ -4,15 +4,49 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "../frame_arena.h"
+#include "../mapping/mapping_tables.h"
 #include "../settings/effect_config_store.h"
+#include "blend.h"
 #include "effect_catalog.h"
+#include "effect_scratch.h"
 
 namespace chromance {
 namespace core {
 
-template <size_t MaxEffects>
+// Per-effect render cost, fed by the platform loop (which owns the microsecond clock) via note_*_us().
+struct EffectCostStats {
+  uint32_t prepare_us = 0;          // last prepare() (warm-up) cost
+  uint32_t first_frame_us = 0;      // render cost of the first frame after the latest activation
+  uint32_t max_first_frame_us = 0;
+  uint32_t max_frame_us = 0;        // worst steady-state frame (excludes first frames)
+  uint32_t activations = 0;
+};
+
+struct TransitionStats {
+  uint32_t started = 0;
+  uint32_t shortened = 0;      // fades cut short up front (cost estimate) or mid-fade (over-budget frame)
+  uint32_t hard_cuts = 0;      // switches that skipped the fade: even a short one would not fit the frame
+                               // budget, or both effects' scratch would not fit the arena at once
+  uint32_t max_frame_us = 0;   // worst frame while two effects were rendering
+};
+
+// MaxLeds sizes the two crossfade buffers carved from the manager's static arena at init(); ScratchBytes sizes
+// the effect scratch behind them.
+//
+// Effect scratch (see effect_scratch.h): the active effect borrows its scratch_bytes() from one end of the
+// scratch on start() and gives it back on stop(), so static DRAM holds the largest working set once instead
+// of every effect's. During a crossfade the incoming effect takes the other end; a switch between two effects
+// whose scratch does not fit at once is a hard cut.
+template <size_t MaxEffects, size_t MaxLeds = MappingTables::led_count(),
+          size_t ScratchBytes = kDefaultEffectScratchBytes>
 class EffectManager final {
  public:
+  // Fades shorter than this after budget degradation are replaced by a hard cut.
+  static constexpr uint16_t kMinTransitionMs = 80;
+  // Longest an unchanged frame is held before it is redrawn anyway (see set_max_idle_ms()).
+  static constexpr uint32_t kDefaultMaxIdleMs = 1000;
+
   void init(ISettingsStore& store, const EffectCatalog<MaxEffects>& catalog, const PixelsMap& map,
             uint32_t now_ms, EffectId fallback_active_id = EffectId{}) {
     store_ = &store;
@@ -20,8 +54,17 @@ class EffectManager final {
     map_ = &map;
     now_ms_ = now_ms;
 
+    arena_.reset();
+    fade_from_ = arena_.template alloc<Rgb>(MaxLeds);
+    fade_to_ = arena_.template alloc<Rgb>(MaxLeds);
+    scratch_ = reinterpret_cast<uint8_t*>(arena_.template alloc<uint64_t>(kScratchBytes / 8U));
+    scratch_high_ = false;
+    scratch_peak_ = 0;
+    outgoing_effect_ = nullptr;
+
     for (size_t i = 0; i < MaxEffects; ++i) {
       memset(configs_[i].bytes, 0, sizeof(configs_[i].bytes));
+      configs_[i].overlaid = false;
       configs_[i].dirty = false;
       configs_[i].last_change_ms = 0;
       configs_[i].next_write_due_ms = 0;
@@ -62,7 +105,7 @@ class EffectManager final {
         configs_[i].dirty = false;
       }
 
-      e->bind_config(configs_[i].bytes, kMaxEffectConfigSize);
+      bind_config(i);
     }
 
     // Restore active effect id if present; else default to first catalog entry.
@@ -84,44 +127,161 @@ class EffectManager final {
     (void)set_active(id, now_ms_);
   }
 
-  void set_global_params(const EffectParams& params) { global_params_ = params; }
+  void set_global_params(const EffectParams& params) {
+    if (params.brightness != global_params_.brightness || params.speed != global_params_.speed ||
+        params.intensity != global_params_.intensity || params.palette != global_params_.palette) {
+      frame_valid_ = false;
+    }
+    global_params_ = params;
+  }
+  const EffectParams& global_params() const { return global_params_; }
+
+  // Idle-aware rendering. After each render the active effect's next_change_ms() says when its frame can
+  // next differ; until then (and until an input, param, brightness or signal change) frame_due() is false and
+  // the caller may skip render and flush altogether. An unchanged frame is still redrawn every max_idle_ms;
+  // 0 disables skipping.
+  void set_max_idle_ms(uint32_t ms) { max_idle_ms_ = ms; }
+
+  bool frame_due(uint32_t now_ms) const {
+    return !frame_valid_ || outgoing_effect_ != nullptr || static_cast<int32_t>(now_ms - next_change_ms_) >= 0;
+  }
+
+  // Earliest time the next frame can differ from the last rendered one (now_ms_ when already due).
+  uint32_t next_change_ms() const { return frame_due(now_ms_) ? now_ms_ : next_change_ms_; }
+
+  // Forces the next frame to render, e.g. after something else drew over the output.
+  void invalidate_frame() { frame_valid_ = false; }
+
+  // Crossfade length for set_active() (0 = hard cut).
+  void set_transition_ms(uint16_t ms) { transition_ms_ = ms; }
+  uint16_t transition_ms() const { return transition_ms_; }
+
+  // Render time available per frame (from the target fps). 0 disables budget-based degradation.
+  void set_frame_budget_us(uint32_t us) { frame_budget_us_ = us; }
+
+  bool transitioning() const { return outgoing_effect_ != nullptr; }
+  const TransitionStats& transition_stats() const { return transition_stats_; }
+
+  static constexpr size_t scratch_capacity() { return kScratchBytes; }
+  // Most effect scratch lent at once since init() (both effects' during a crossfade).
+  size_t scratch_peak_bytes() const { return scratch_peak_; }
 
   EffectId active_id() const { return active_id_; }
   IEffectV2* active() const { return active_effect_; }
+  // Time the active effect was last started (set_active() / restart_active()). Effects seed their runtime state,
+  // including RNGs, from it, so two managers that start the same effect at the same time render the same frames.
+  uint32_t activated_ms() const { return activated_ms_; }
 
-  bool set_active(EffectId id, uint32_t now_ms) {
-    if (catalog_ == nullptr || store_ == nullptr || map_ == nullptr || !id.valid()) {
-      return false;
+  bool set_active(EffectId id, uint32_t now_ms) { return activate(id, now_ms, /*forced=*/false, 0); }
+
+  // Sync followers: switches with the fade length the leader chose (0 = cut) instead of planning one from this
+  // node's frame budget and cost stats, which differ between boards (and with each board's clock). The fade is
+  // not shortened mid-way either; set_fade_ms() follows the leader's changes.
+  bool set_active(EffectId id, uint32_t now_ms, uint16_t forced_fade_ms) {
+    return activate(id, now_ms, /*forced=*/true, forced_fade_ms);
+  }
+
+  // Length of the crossfade into the active effect (0 = cut), including any shortening since it started.
+  uint16_t fade_ms() const { return fade_ms_; }
+
+  // Retimes the crossfade into the active effect; 0 ends it with the next frame.
+  void set_fade_ms(uint16_t ms) {
+    fade_ms_ = ms;
+    if (outgoing_effect_ != nullptr) {
+      transition_len_ms_ = ms;
     }
-    IEffectV2* next = catalog_->find_by_id(id);
-    if (next == nullptr) {
+  }
+
+  // True while any catalog effect still has warm-up work to do.
+  bool prepare_pending() const {
+    if (catalog_ == nullptr) {
       return false;
     }
-
-    now_ms_ = now_ms;
-
-    // Best effort: persist the old active config on effect change to reduce loss on reboot.
-    const int old_idx = find_index(active_id_);
-    if (old_idx >= 0) {
-      try_persist_config_now(static_cast<size_t>(old_idx), now_ms_);
+    for (size_t i = 0; i < catalog_->count(); ++i) {
+      const IEffectV2* e = catalog_->effect_at(i);
+      if (e != nullptr && e->needs_prepare()) {
+        return true;
+      }
     }
+    return false;
+  }
 
-    if (active_effect_ != nullptr && active_id_.valid()) {
+  // Runs prepare() for at most one effect that needs it (round-robin) and returns its id, or an invalid id when
+  // nothing is pending. Intended for idle frame time: one call costs at most one effect's warm-up.
+  EffectId prepare_next(uint32_t now_ms) {
+    if (catalog_ == nullptr || catalog_->count() == 0) {
+      return EffectId{};
+    }
+    const size_t n = catalog_->count();
+    for (size_t k = 0; k < n; ++k) {
+      const size_t i = (prepare_cursor_ + k) % n;
+      IEffectV2* e = catalog_->effect_at(i);
+      const EffectDescriptor* d = catalog_->descriptor_at(i);
+      if (e == nullptr || d == nullptr || !e->needs_prepare()) {
+        continue;
+      }
+      prepare_cursor_ = (i + 1) % n;
+      now_ms_ = now_ms;
       EventContext ctx = make_event_context(now_ms_);
-      active_effect_->stop(ctx);
+      e->prepare(ctx);
+      return d->id;
     }
+    return EffectId{};
+  }
 
-    active_effect_ = next;
-    active_id_ = id;
-
-    // Persist active id immediately (best effort, with retry/backoff policy).
-    persist_active_id_now(now_ms_);
-
+  // Runs prepare() for one specific effect if it needs it (e.g. the next playlist entry ahead of its switch).
+  // Returns true when warm-up work was done.
+  bool prepare_effect(EffectId id, uint32_t now_ms) {
+    IEffectV2* e = catalog_ ? catalog_->find_by_id(id) : nullptr;
+    if (e == nullptr || !e->needs_prepare()) {
+      return false;
+    }
+    now_ms_ = now_ms;
     EventContext ctx = make_event_context(now_ms_);
-    active_effect_->start(ctx);
+    e->prepare(ctx);
     return true;
   }
 
+  void note_prepare_us(EffectId id, uint32_t us) {
+    const int idx = find_index(id);
+    if (idx >= 0) {
+      costs_[idx].prepare_us = us;
+    }
+  }
+
+  // Attributes one render() duration to the active effect.
+  void note_render_us(uint32_t us) {
+    const int idx = find_index(active_id_);
+    if (idx < 0) {
+      return;
+    }
+    EffectCostStats& c = costs_[idx];
+    if (outgoing_effect_ != nullptr) {
+      if (us > transition_stats_.max_frame_us) transition_stats_.max_frame_us = us;
+      // Over budget with two effects rendering: halve what is left of the fade (ends at once when nearly done).
+      // A forced fade keeps its length: whoever chose it decides.
+      if (!fade_forced_ && frame_budget_us_ > 0 && us > frame_budget_us_) {
+        const uint32_t elapsed = now_ms_ - transition_start_ms_;
+        const uint32_t left = transition_len_ms_ > elapsed ? transition_len_ms_ - elapsed : 0;
+        transition_len_ms_ = static_cast<uint16_t>(elapsed + left / 2U);
+        fade_ms_ = transition_len_ms_;
+        ++transition_stats_.shortened;
+      }
+    }
+    if (first_frame_pending_) {
+      first_frame_pending_ = false;
+      c.first_frame_us = us;
+      if (us > c.max_first_frame_us) c.max_first_frame_us = us;
+      return;
+    }
+    if (outgoing_effect_ == nullptr && us > c.max_frame_us) c.max_frame_us = us;
+  }
+
+  const EffectCostStats* cost_stats(EffectId id) const {
+    const int idx = find_index(id);
+    return idx >= 0 ? &costs_[idx] : nullptr;
+  }
+
   void restart_active(uint32_t now_ms) {
     if (active_effect_ == nullptr) {
       return;
@@ -129,6 +289,8 @@ class EffectManager final {
     now_ms_ = now_ms;
     EventContext ctx = make_event_context(now_ms_);
     active_effect_->reset_runtime(ctx);
+    activated_ms_ = now_ms_;
+    frame_valid_ = false;
   }
 
   bool enter_active_stage(StageId id, uint32_t now_ms) {
@@ -137,6 +299,7 @@ class EffectManager final {
     }
     now_ms_ = now_ms;
     EventContext ctx = make_event_context(now_ms_);
+    frame_valid_ = false;
     return active_effect_->enter_stage(id, ctx);
   }
 
@@ -152,9 +315,8 @@ class EffectManager final {
     }
     now_ms_ = now_ms;
     reset_config_bytes_to_defaults(static_cast<size_t>(idx));
-    if (e != nullptr) {
-      e->bind_config(configs_[idx].bytes, kMaxEffectConfigSize);
-    }
+    configs_[idx].overlaid = false;
+    bind_config(static_cast<size_t>(idx));
     mark_dirty(static_cast<size_t>(idx), now_ms_);
     if (id == active_id_) {
       restart_active(now_ms_);
@@ -169,16 +331,20 @@ class EffectManager final {
     now_ms_ = now_ms;
     EventContext ctx = make_event_context(now_ms_);
     active_effect_->on_event(ev, ctx);
+    frame_valid_ = false;
   }
 
   void tick(uint32_t now_ms, uint32_t dt_ms, const Signals& signals) {
     now_ms_ = now_ms;
     dt_ms_ = dt_ms;
+    if (!same_signals(signals, signals_)) {
+      frame_valid_ = false;
+    }
     signals_ = signals;
     flush_persist_due(now_ms_, /*force=*/false);
   }
 
-  void render(Rgb* out, size_t n) const {
+  void render(Rgb* out, size_t n) {
     if (out == nullptr || n == 0) {
       return;
     }
@@ -188,13 +354,36 @@ class EffectManager final {
       }
       return;
     }
-    RenderContext ctx;
-    ctx.now_ms = now_ms_;
-    ctx.dt_ms = dt_ms_;
-    ctx.map = map_;
-    ctx.global_params = global_params_;
-    ctx.signals = signals_;
+    const RenderContext ctx = make_render_context();
+
+    if (outgoing_effect_ != nullptr) {
+      const uint32_t elapsed = now_ms_ - transition_start_ms_;
+      if (static_cast<int32_t>(elapsed) < 0 || elapsed >= transition_len_ms_ || n > MaxLeds) {
+        finish_transition(now_ms_);
+      } else {
+        outgoing_effect_->render(ctx, fade_from_, n);
+        active_effect_->render(ctx, fade_to_, n);
+        const uint16_t t256 = static_cast<uint16_t>((elapsed * 256U) / transition_len_ms_);
+        blend_crossfade(fade_from_, fade_to_, out, n, t256);
+        frame_valid_ = false;  // fades change every frame
+        return;
+      }
+    }
     active_effect_->render(ctx, out, n);
+    note_rendered();
+  }
+
+  // Renders the frame straight into wire pixels if the active effect supports it (IEffectV2::render_wire) and no
+  // fade is running (fades blend Rgb). Returns false, having rendered nothing, otherwise: call render() instead.
+  bool render_wire(StripPixel* out, size_t n) {
+    if (out == nullptr || n == 0 || active_effect_ == nullptr || map_ == nullptr || outgoing_effect_ != nullptr) {
+      return false;
+    }
+    if (!active_effect_->render_wire(make_render_context(), out, n)) {
+      return false;
+    }
+    note_rendered();
+    return true;
   }
 
   bool set_param(EffectId id, ParamId pid, const ParamValue& v) {
@@ -218,14 +407,114 @@ class EffectManager final {
     if (!param_value_type_matches(*d, v.type)) {
       return false;
     }
-    if (!apply_param_value(*d, v, configs_[idx].bytes, kMaxEffectConfigSize)) {
+    ConfigState& c = configs_[idx];
+    alignas(4) uint8_t updated[kMaxEffectConfigSize];
+    memcpy(updated, c.bytes, kMaxEffectConfigSize);
+    if (!apply_param_value(*d, v, updated, kMaxEffectConfigSize)) {
       return false;
     }
+    // A hand edit also shows through a runtime overlay (see overlay_param_raw()).
+    alignas(4) uint8_t overlay[kMaxEffectConfigSize];
+    if (c.overlaid) {
+      memcpy(overlay, c.overlay, kMaxEffectConfigSize);
+      (void)apply_param_value(*d, v, overlay, kMaxEffectConfigSize);
+    }
+    const bool stored_changed = memcmp(updated, c.bytes, kMaxEffectConfigSize) != 0;
+    if (!stored_changed && (!c.overlaid || memcmp(overlay, c.overlay, kMaxEffectConfigSize) == 0)) {
+      return true;  // unchanged: no rebind, redraw or persisted write
+    }
+    memcpy(c.bytes, updated, kMaxEffectConfigSize);
+    if (c.overlaid) {
+      memcpy(c.overlay, overlay, kMaxEffectConfigSize);
+    }
 
-    if (e != nullptr) {
-      e->bind_config(configs_[idx].bytes, kMaxEffectConfigSize);
+    bind_config(static_cast<size_t>(idx));
+    if (stored_changed) {
+      mark_dirty(static_cast<size_t>(idx), now_ms_);
+    }
+    if (id == active_id_) {
+      frame_valid_ = false;
+    }
+    return true;
+  }
+
+  // Applies a raw firmware-unit value (scale already applied; colors packed 0xRRGGBB).
+  // Used by compact transports that do not carry a ParamValue type tag.
+  bool set_param_raw(EffectId id, ParamId pid, int32_t raw) {
+    ParamValue v;
+    return raw_param_value(id, pid, raw, &v) != nullptr && set_param(id, pid, v);
+  }
+
+  // Runtime overlay: applies a raw value over the effect's config for as long as a caller needs it (a playlist
+  // entry's param snapshot), without persisting it. The effect is rebound to the overlay and renders it until
+  // clear_overlay(); the stored config, and what set_param() persists, are untouched.
+  bool overlay_param_raw(EffectId id, ParamId pid, int32_t raw) {
+    ParamValue v;
+    const ParamDescriptor* d = raw_param_value(id, pid, raw, &v);
+    if (d == nullptr) {
+      return false;
+    }
+    const int idx = find_index(id);
+    ConfigState& c = configs_[idx];
+    alignas(4) uint8_t updated[kMaxEffectConfigSize];
+    memcpy(updated, c.overlaid ? c.overlay : c.bytes, kMaxEffectConfigSize);
+    if (!param_value_type_matches(*d, v.type) || !apply_param_value(*d, v, updated, kMaxEffectConfigSize)) {
+      return false;
+    }
+    if (c.overlaid && memcmp(updated, c.overlay, kMaxEffectConfigSize) == 0) {
+      return true;
+    }
+    memcpy(c.overlay, updated, kMaxEffectConfigSize);
+    c.overlaid = true;
+    bind_config(static_cast<size_t>(idx));
+    if (id == active_id_) {
+      frame_valid_ = false;
+    }
+    return true;
+  }
+
+  // Drops the effect's overlay and rebinds its stored config. Returns false when it had none.
+  bool clear_overlay(EffectId id) {
+    const int idx = find_index(id);
+    if (idx < 0 || !configs_[idx].overlaid) {
+      return false;
+    }
+    configs_[idx].overlaid = false;
+    bind_config(static_cast<size_t>(idx));
+    if (id == active_id_) {
+      frame_valid_ = false;
+    }
+    return true;
+  }
+
+  bool has_overlay(EffectId id) const {
+    const int idx = find_index(id);
+    return idx >= 0 && configs_[idx].overlaid;
+  }
+
+  // Config bytes the effect renders with (kMaxEffectConfigSize): its overlay if it has one, else the stored
+  // config. nullptr for an unknown id.
+  const uint8_t* config_bytes(EffectId id) const {
+    const int idx = find_index(id);
+    return idx >= 0 ? bound_bytes(static_cast<size_t>(idx)) : nullptr;
+  }
+
+  // Takes over config bytes produced by another node running the same firmware (multi-controller sync). The
+  // effect is rebound and redrawn like after set_param(), but nothing is persisted: the leader owns the config.
+  bool adopt_config(EffectId id, const uint8_t* bytes, size_t len) {
+    const int idx = find_index(id);
+    if (idx < 0 || bytes == nullptr || len > kMaxEffectConfigSize) {
+      return false;
+    }
+    if (!configs_[idx].overlaid && memcmp(configs_[idx].bytes, bytes, len) == 0) {
+      return true;
+    }
+    memcpy(configs_[idx].bytes, bytes, len);
+    configs_[idx].overlaid = false;
+    bind_config(static_cast<size_t>(idx));
+    if (id == active_id_) {
+      frame_valid_ = false;
     }
-    mark_dirty(static_cast<size_t>(idx), now_ms_);
     return true;
   }
 
@@ -246,12 +535,14 @@ class EffectManager final {
     if (d == nullptr || !validate_descriptor(*d)) {
       return false;
     }
-    return read_param_value(*d, configs_[idx].bytes, kMaxEffectConfigSize, out);
+    return read_param_value(*d, bound_bytes(static_cast<size_t>(idx)), kMaxEffectConfigSize, out);
   }
 
  private:
   struct ConfigState {
-    alignas(4) uint8_t bytes[kMaxEffectConfigSize];
+    alignas(4) uint8_t bytes[kMaxEffectConfigSize];    // stored (persisted) config
+    alignas(4) uint8_t overlay[kMaxEffectConfigSize];  // runtime overlay, bound instead while overlaid
+    bool overlaid = false;
     bool dirty = false;
     uint32_t last_change_ms = 0;
     uint32_t next_write_due_ms = 0;
@@ -270,11 +561,182 @@ class EffectManager final {
   Signals signals_{};
 
   uint32_t now_ms_ = 0;
+  uint32_t activated_ms_ = 0;
   uint32_t dt_ms_ = 0;
 
   EffectId active_id_{0};
   IEffectV2* active_effect_ = nullptr;
 
+  EffectCostStats costs_[MaxEffects] = {};
+  bool first_frame_pending_ = false;
+  size_t prepare_cursor_ = 0;
+
+  // Crossfade buffers and effect scratch, all in the arena (static storage with the manager). The scratch is
+  // 8-byte aligned, which can take up to 7 bytes of padding after the Rgb buffers.
+  static constexpr size_t kScratchBytes = (ScratchBytes + 7U) & ~static_cast<size_t>(7U);
+  FrameArena<2 * MaxLeds * sizeof(Rgb) + 8U + kScratchBytes> arena_;
+  Rgb* fade_from_ = nullptr;
+  Rgb* fade_to_ = nullptr;
+  uint8_t* scratch_ = nullptr;
+  bool scratch_high_ = false;  // the active effect holds the high end of the scratch
+  size_t scratch_peak_ = 0;
+  IEffectV2* outgoing_effect_ = nullptr;
+  uint32_t transition_start_ms_ = 0;
+  uint16_t transition_len_ms_ = 0;
+  uint16_t fade_ms_ = 0;  // fade into the active effect as planned / forced (see fade_ms())
+  bool fade_forced_ = false;  // set_active() with a forced fade: no budget shortening
+  uint16_t transition_ms_ = 0;
+  uint32_t frame_budget_us_ = 0;
+  TransitionStats transition_stats_{};
+
+  // Idle-aware rendering state (see frame_due()).
+  bool frame_valid_ = false;
+  uint32_t next_change_ms_ = 0;
+  uint32_t max_idle_ms_ = kDefaultMaxIdleMs;
+
+  static bool same_signals(const Signals& a, const Signals& b) {
+    return a.has_bpm == b.has_bpm && a.bpm == b.bpm && a.has_energy == b.has_energy &&
+           a.energy_01 == b.energy_01 && a.has_beat_phase == b.has_beat_phase &&
+           a.beat_phase_01 == b.beat_phase_01;
+  }
+
+  bool activate(EffectId id, uint32_t now_ms, bool forced, uint16_t forced_fade_ms) {
+    if (catalog_ == nullptr || store_ == nullptr || map_ == nullptr || !id.valid()) {
+      return false;
+    }
+    IEffectV2* next = catalog_->find_by_id(id);
+    if (next == nullptr || scratch_need(next) > kScratchBytes) {
+      return false;
+    }
+
+    now_ms_ = now_ms;
+
+    // Best effort: persist the old active config on effect change to reduce loss on reboot.
+    const int old_idx = find_index(active_id_);
+    if (old_idx >= 0) {
+      try_persist_config_now(static_cast<size_t>(old_idx), now_ms_);
+    }
+
+    // A switch during a fade drops the fade's outgoing effect; the current one becomes the new outgoing.
+    finish_transition(now_ms_);
+    IEffectV2* const prev = active_id_.valid() ? active_effect_ : nullptr;
+    uint16_t fade_ms = 0;
+    if (prev != nullptr && prev != next) {
+      fade_ms = forced ? forced_transition_ms(active_id_, id, forced_fade_ms) : plan_transition_ms(active_id_, id);
+    }
+    if (prev != nullptr && fade_ms == 0) {
+      EventContext ctx = make_event_context(now_ms_);
+      prev->stop(ctx);
+    }
+
+    active_effect_ = next;
+    active_id_ = id;
+
+    // Persist active id immediately (best effort, with retry/backoff policy).
+    persist_active_id_now(now_ms_);
+
+    EventContext ctx = make_event_context(now_ms_);
+    // Normally already done by prepare_next() in idle time; this only catches switches that beat the warm-up.
+    if (active_effect_->needs_prepare()) {
+      active_effect_->prepare(ctx);
+    }
+    // The incoming effect's scratch: the end the fading-out effect does not hold, else the low end.
+    scratch_high_ = fade_ms > 0 && !scratch_high_;
+    ctx.scratch = lease_scratch(scratch_need(active_effect_), scratch_high_);
+    const size_t lent = ctx.scratch.bytes + (fade_ms > 0 ? scratch_need(prev) : 0);
+    if (lent > scratch_peak_) scratch_peak_ = lent;
+    active_effect_->start(ctx);
+    activated_ms_ = now_ms_;
+
+    const int idx = find_index(id);
+    if (idx >= 0) {
+      ++costs_[idx].activations;
+    }
+    first_frame_pending_ = true;
+    frame_valid_ = false;
+
+    if (fade_ms > 0) {
+      // The outgoing effect keeps rendering (and is stopped) until the fade completes.
+      outgoing_effect_ = prev;
+      transition_start_ms_ = now_ms_;
+      transition_len_ms_ = fade_ms;
+      ++transition_stats_.started;
+    }
+    fade_ms_ = fade_ms;
+    fade_forced_ = forced;
+    return true;
+  }
+
+  // Fade length for a switch from -> to: the configured length, shortened in proportion when the pair's
+  // measured worst-case frames would not fit the frame budget, or 0 (hard cut) if not even kMinTransitionMs
+  // would fit. Effects without measurements yet are assumed to fit; note_render_us() corrects mid-fade.
+  uint16_t plan_transition_ms(EffectId from, EffectId to) {
+    if (transition_ms_ == 0 || fade_from_ == nullptr || fade_to_ == nullptr) {
+      return 0;
+    }
+    if (scratch_need(catalog_->find_by_id(from)) + scratch_need(catalog_->find_by_id(to)) > kScratchBytes) {
+      ++transition_stats_.hard_cuts;
+      return 0;
+    }
+    if (frame_budget_us_ == 0) {
+      return transition_ms_;
+    }
+    const int fi = find_index(from);
+    const int ti = find_index(to);
+    const uint32_t from_us = fi >= 0 ? costs_[fi].max_frame_us : 0;
+    const uint32_t to_first = ti >= 0 ? costs_[ti].max_first_frame_us : 0;
+    const uint32_t to_steady = ti >= 0 ? costs_[ti].max_frame_us : 0;
+    const uint32_t estimate_us = from_us + (to_first > to_steady ? to_first : to_steady);
+    if (estimate_us <= frame_budget_us_) {
+      return transition_ms_;
+    }
+    const uint32_t ms = static_cast<uint32_t>(transition_ms_) * frame_budget_us_ / estimate_us;
+    if (ms < kMinTransitionMs) {
+      ++transition_stats_.hard_cuts;
+      return 0;
+    }
+    ++transition_stats_.shortened;
+    return static_cast<uint16_t>(ms);
+  }
+
+  // A fade length chosen elsewhere (the sync leader's), still subject to what this manager cannot do: no fade
+  // buffers, or both effects' scratch not fitting at once. Same firmware and catalog, so the leader cut too.
+  uint16_t forced_transition_ms(EffectId from, EffectId to, uint16_t ms) {
+    if (ms == 0 || fade_from_ == nullptr || fade_to_ == nullptr) {
+      return 0;
+    }
+    if (scratch_need(catalog_->find_by_id(from)) + scratch_need(catalog_->find_by_id(to)) > kScratchBytes) {
+      ++transition_stats_.hard_cuts;
+      return 0;
+    }
+    return ms;
+  }
+
+  static size_t scratch_need(const IEffectV2* e) {
+    return e != nullptr ? scratch_block_bytes<uint8_t>(e->scratch_bytes()) : 0;
+  }
+
+  EffectScratch lease_scratch(size_t bytes, bool high) const {
+    EffectScratch s;
+    if (bytes > 0 && scratch_ != nullptr && bytes <= kScratchBytes) {
+      s.data = high ? scratch_ + (kScratchBytes - bytes) : scratch_;
+      s.bytes = bytes;
+    }
+    return s;
+  }
+
+  void finish_transition(uint32_t now_ms) {
+    if (outgoing_effect_ == nullptr) {
+      return;
+    }
+    IEffectV2* const outgoing = outgoing_effect_;
+    outgoing_effect_ = nullptr;
+    if (outgoing != active_effect_) {
+      EventContext ctx = make_event_context(now_ms);
+      outgoing->stop(ctx);
+    }
+  }
+
   bool active_dirty_ = false;
   uint32_t active_last_change_ms_ = 0;
   uint32_t active_next_write_due_ms_ = 0;
@@ -335,6 +797,26 @@ class EffectManager final {
     return ctx;
   }
 
+  RenderContext make_render_context() const {
+    RenderContext ctx;
+    ctx.now_ms = now_ms_;
+    ctx.dt_ms = dt_ms_;
+    ctx.map = map_;
+    ctx.global_params = global_params_;
+    ctx.signals = signals_;
+    return ctx;
+  }
+
+  // After the active effect rendered a whole frame (not a fade): hold it until its next change.
+  void note_rendered() {
+    uint32_t next = active_effect_->next_change_ms(now_ms_);
+    if (static_cast<int32_t>(next - (now_ms_ + max_idle_ms_)) > 0) {
+      next = now_ms_ + max_idle_ms_;
+    }
+    next_change_ms_ = next;
+    frame_valid_ = max_idle_ms_ > 0;
+  }
+
   void mark_active_dirty(uint32_t now_ms, bool immediate) {
     active_dirty_ = true;
     active_last_change_ms_ = now_ms;
@@ -449,6 +931,65 @@ class EffectManager final {
     configs_[idx].next_write_due_ms = now_ms + configs_[idx].backoff_ms;
   }
 
+  const uint8_t* bound_bytes(size_t idx) const {
+    return configs_[idx].overlaid ? configs_[idx].overlay : configs_[idx].bytes;
+  }
+
+  void bind_config(size_t idx) {
+    IEffectV2* e = catalog_ ? catalog_->effect_at(idx) : nullptr;
+    if (e != nullptr) {
+      e->bind_config(bound_bytes(idx), kMaxEffectConfigSize);
+    }
+  }
+
+  // Typed value for a raw firmware-unit value of one of the effect's params (see set_param_raw()). Returns the
+  // param's descriptor, or nullptr when the id, param or value is not valid.
+  const ParamDescriptor* raw_param_value(EffectId id, ParamId pid, int32_t raw, ParamValue* out) const {
+    const int idx = find_index(id);
+    if (idx < 0 || pid.value == 0) {
+      return nullptr;
+    }
+    IEffectV2* e = catalog_->effect_at(static_cast<size_t>(idx));
+    const EffectConfigSchema* schema = e ? e->schema() : nullptr;
+    if (schema == nullptr) {
+      return nullptr;
+    }
+    const ParamDescriptor* d = find_param(*schema, pid);
+    if (d == nullptr || !validate_descriptor(*d)) {
+      return nullptr;
+    }
+
+    ParamValue& v = *out;
+    v.type = d->type;
+    switch (d->type) {
+      case ParamType::Bool:
+        v.v.b = raw != 0;
+        break;
+      case ParamType::U8:
+      case ParamType::Enum:
+        if (raw < 0 || raw > 255 || !raw_step_ok(*d, raw)) return nullptr;
+        v.type = ParamType::U8;
+        v.v.u8 = static_cast<uint8_t>(raw);
+        break;
+      case ParamType::U16:
+        if (raw < 0 || raw > 65535 || !raw_step_ok(*d, raw)) return nullptr;
+        v.v.u16 = static_cast<uint16_t>(raw);
+        break;
+      case ParamType::I16:
+        if (raw < -32768 || raw > 32767 || !raw_step_ok(*d, raw)) return nullptr;
+        v.v.i16 = static_cast<int16_t>(raw);
+        break;
+      case ParamType::ColorRgb:
+        v.v.color_rgb.r = static_cast<uint8_t>((raw >> 16) & 0xFF);
+        v.v.color_rgb.g = static_cast<uint8_t>((raw >> 8) & 0xFF);
+        v.v.color_rgb.b = static_cast<uint8_t>((raw >> 0) & 0xFF);
+        break;
+      default:
+        return nullptr;
+    }
+    return d;
+  }
+
   static const ParamDescriptor* find_param(const EffectConfigSchema& schema, ParamId pid) {
     if (schema.params == nullptr || schema.param_count == 0 || pid.value == 0) {
       return nullptr;
@@ -498,6 +1039,12 @@ class EffectManager final {
     }
   }
 
+  static bool raw_step_ok(const ParamDescriptor& d, int32_t raw) {
+    const int32_t delta = raw - d.min;
+    if (delta < 0) return false;
+    return (delta % d.step) == 0;
+  }
+
   static bool param_value_type_matches(const ParamDescriptor& d, ParamType t) {
     // Permit Enum values to be provided as U8 (common for serial surfaces).
     if (d.type == ParamType::Enum && t == ParamType::U8) {
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../mapping/mapping_tables.h"
+
+namespace chromance {
+namespace core {
+
+// Working memory an effect borrows for one activation: EffectManager lends it on start() and takes it back on
+// stop(), so effects that never run at the same time share the same bytes. data is 8-byte aligned; an empty
+// scratch (nullptr, 0) means "none bound".
+struct EffectScratch {
+  uint8_t* data = nullptr;
+  size_t bytes = 0;
+};
+
+// Bytes a block of count Ts takes in scratch. Blocks are rounded up to 8 so the next one stays aligned.
+template <typename T>
+constexpr size_t scratch_block_bytes(size_t count) {
+  return (count * sizeof(T) + 7U) & ~static_cast<size_t>(7U);
+}
+
+// Carves blocks out of an EffectScratch front to back. An effect's scratch_bytes() is the sum of the
+// scratch_block_bytes() of the blocks it takes, in any order.
+class ScratchCarver final {
+ public:
+  explicit ScratchCarver(const EffectScratch& scratch) : scratch_(scratch) {}
+
+  // count Ts (uninitialized), or nullptr when nothing is bound or the scratch is too small.
+  template <typename T>
+  T* take(size_t count) {
+    static_assert(alignof(T) <= 8, "scratch blocks are 8-byte aligned");
+    const size_t len = scratch_block_bytes<T>(count);
+    if (scratch_.data == nullptr || len > scratch_.bytes - used_) {
+      return nullptr;
+    }
+    T* p = reinterpret_cast<T*>(scratch_.data + used_);
+    used_ += len;
+    return p;
+  }
+
+  // The next len bytes as a scratch of their own (empty when they do not fit), e.g. to lend on to a child.
+  EffectScratch take_scratch(size_t len) {
+    EffectScratch s;
+    if (len == 0 || scratch_.data == nullptr || len > scratch_.bytes - used_) {
+      return s;
+    }
+    s.data = scratch_.data + used_;
+    s.bytes = len;
+    used_ += (len + 7U) & ~static_cast<size_t>(7U);
+    return s;
+  }
+
+ private:
+  EffectScratch scratch_;
+  size_t used_ = 0;
+};
+
+// Inline scratch for effects driven without an EffectManager (tests, offline tools).
+template <size_t Bytes>
+struct ScratchBuffer {
+  alignas(8) uint8_t storage[Bytes > 0 ? Bytes : 1];
+
+  EffectScratch scratch() {
+    EffectScratch s;
+    s.data = storage;
+    s.bytes = Bytes;
+    return s;
+  }
+};
+
+// Default size of EffectManager's scratch arena: the largest built-in working set. That is BreathingEffect's
+// (a fixed ~3 KiB dot and wave pool plus a per-segment LED lookup), unless the wall has so many LEDs per
+// segment that IndexWalkEffect's two scan orders are bigger. Built-in effects static_assert that they fit.
+constexpr size_t kDefaultEffectScratchBytes =
+    3072U + 32U * (MappingTables::segment_count() + 1U) > 4U * MappingTables::led_count()
+        ? 3072U + 32U * (MappingTables::segment_count() + 1U)
+        : 4U * MappingTables::led_count();
+
+}  // namespace core
+}  // namespace chromance
@@ -3,10 +3,12 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "../layout.h"
 #include "../mapping/pixels_map.h"
 #include "../settings/effect_config_store.h"
 #include "effect_descriptor.h"
 #include "effect_params.h"
+#include "effect_scratch.h"
 #include "params.h"
 #include "signals.h"
 
@@ -33,6 +35,7 @@ struct EventContext {
   Signals signals;
   ISettingsStore* store = nullptr;  // persisted config load/save (manager-owned policy)
   ILogger* logger = nullptr;        // optional
+  EffectScratch scratch;            // start() only: scratch_bytes() of memory lent until stop()
 };
 
 // Key routing note:
@@ -58,6 +61,14 @@ struct StageDescriptor {
   const char* display_name;
 };
 
+// One layer of a composited effect, for UI introspection. Param ids refer to the compositor's own schema;
+// mode_param is invalid for the base layer.
+struct LayerDescriptor {
+  const EffectDescriptor* effect;
+  ParamId mode_param;
+  ParamId opacity_param;
+};
+
 class IEffectV2 {
  public:
   virtual ~IEffectV2() = default;
@@ -72,10 +83,20 @@ class IEffectV2 {
     (void)config_size;
   }
 
-  // Called when this effect becomes active.
+  // Optional warm-up, cold path. EffectManager runs prepare() in idle frame time ahead of activation (and
+  // before start() if it has not run yet) so the first render after a switch does not build caches.
+  // Must be idempotent and must not change visible runtime state.
+  virtual bool needs_prepare() const { return false; }
+  virtual void prepare(const EventContext& ctx) { (void)ctx; }
+
+  // Working memory the effect borrows from EffectManager while active (see effect_scratch.h). Fixed once the
+  // effect is in a catalog; EffectManager refuses to activate an effect whose scratch does not fit its arena.
+  virtual size_t scratch_bytes() const { return 0; }
+
+  // Called when this effect becomes active. ctx.scratch holds the effect's scratch until stop().
   virtual void start(const EventContext& ctx) = 0;
 
-  // Called when leaving the effect (optional).
+  // Called when leaving the effect (optional). Its scratch is lent to the next effect afterwards.
   virtual void stop(const EventContext& ctx) { (void)ctx; }
 
   // Reset runtime state (not persisted config).
@@ -100,8 +121,27 @@ class IEffectV2 {
     return false;
   }
 
+  // Optional idle hint, same contract as IEffect::next_change_ms(): queried right after render(), returns the
+  // earliest time the frame may change without input. EffectManager skips frames until then.
+  virtual uint32_t next_change_ms(uint32_t now_ms) const { return now_ms; }
+
+  // Optional layer introspection (compositors only).
+  virtual uint8_t layer_count() const { return 0; }
+  virtual const LayerDescriptor* layer_at(uint8_t i) const {
+    (void)i;
+    return nullptr;
+  }
+
   // Render always uses current runtime + config; must be allocation-free.
   virtual void render(const RenderContext& ctx, Rgb* out_rgb, size_t led_count) = 0;
+
+  // Optional wire-pixel render, same contract as IEffect::render_wire(): false (nothing written) if unsupported.
+  virtual bool render_wire(const RenderContext& ctx, StripPixel* out, size_t led_count) {
+    (void)ctx;
+    (void)out;
+    (void)led_count;
+    return false;
+  }
 };
 
 }  // namespace core
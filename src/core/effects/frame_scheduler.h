@@ -10,19 +10,82 @@ class FrameScheduler {
  public:
   explicit FrameScheduler(uint16_t target_fps = 0) : target_fps_(target_fps) {}
 
-  void set_target_fps(uint16_t target_fps) { target_fps_ = target_fps; }
+  void set_target_fps(uint16_t target_fps) {
+    const bool changed = target_fps != target_fps_;
+    target_fps_ = target_fps;
+    if (changed && phase_locked_) {
+      snap_to_grid(next_frame_ms_);
+    }
+  }
   uint16_t target_fps() const { return target_fps_; }
 
+  // Phase lock: frame boundaries fall on floor(k * 1000 / fps) of the caller's clock (k = 0, 1, ...) instead of
+  // counting from reset(), so schedulers fed the same synchronized clock (see core/protocol/node_sync.h) render
+  // on the same boundaries. The grid restarts once when the 32-bit ms clock wraps (every ~49 days).
+  void set_phase_locked(bool on) {
+    phase_locked_ = on;
+    if (on) {
+      snap_to_grid(next_frame_ms_);
+    }
+  }
+  bool phase_locked() const { return phase_locked_; }
+
   void reset(uint32_t now_ms) {
     last_render_ms_ = now_ms;
     next_frame_ms_ = now_ms;
     remainder_acc_ = 0;
     last_dt_ms_ = 0;
+    hold_active_ = false;
+    window_start_ms_ = now_ms;
+    window_work_us_ = 0;
+    window_frames_ = 0;
+    occupancy_permille_ = 0;
+    rendered_fps_ = 0;
+    if (phase_locked_) {
+      snap_to_grid(now_ms);
+    }
   }
 
+  // Idle hold: frames before until_ms are not rendered (the effect reported no visual change before then).
+  // Frame boundaries keep advancing on the usual cadence, so the first frame after the hold lands on one and
+  // dt_ms() spans the whole hold. wake() cancels the hold, e.g. on input.
+  void hold_until(uint32_t until_ms) {
+    hold_active_ = true;
+    hold_until_ms_ = until_ms;
+  }
+  void wake() { hold_active_ = false; }
+  bool holding() const { return hold_active_; }
+
+  // Frame boundaries skipped because of an idle hold (diagnostics).
+  uint32_t held_frames() const { return held_frames_; }
+
+  // Load accounting: callers report the work (render + flush) of every frame they actually draw. Each
+  // kLoadWindowMs window turns it into occupancy (work time / wall time) and a rendered frame rate.
+  static constexpr uint32_t kLoadWindowMs = 1000;
+  void note_work_us(uint32_t us) {
+    window_work_us_ += us;
+    ++window_frames_;
+  }
+  // Both describe the last completed window.
+  uint16_t occupancy_permille() const { return occupancy_permille_; }
+  uint16_t rendered_fps() const { return rendered_fps_; }
+
   // Returns true when a frame should be rendered at now_ms.
   // If true, dt_ms() reflects time since last rendered frame.
   bool should_render(uint32_t now_ms) {
+    roll_load_window(now_ms);
+    if (hold_active_ && !time_reached(now_ms, hold_until_ms_)) {
+      if (target_fps_ == 0) {
+        return false;
+      }
+      while (time_reached(now_ms, next_frame_ms_)) {
+        advance_next_frame();
+        ++held_frames_;
+      }
+      return false;
+    }
+    hold_active_ = false;
+
     if (target_fps_ == 0) {
       last_dt_ms_ = now_ms - last_render_ms_;
       last_render_ms_ = now_ms;
@@ -44,13 +107,45 @@ class FrameScheduler {
   }
 
   uint32_t dt_ms() const { return last_dt_ms_; }
-  uint32_t next_frame_ms() const { return next_frame_ms_; }
+  // When the next frame is due: the next frame boundary, or the end of an idle hold if that is later. Callers
+  // use it to size the work they slot in before the next frame.
+  uint32_t next_frame_ms() const {
+    if (hold_active_ && static_cast<int32_t>(hold_until_ms_ - next_frame_ms_) > 0) {
+      return hold_until_ms_;
+    }
+    return next_frame_ms_;
+  }
 
  private:
   static bool time_reached(uint32_t now_ms, uint32_t target_ms) {
     return static_cast<int32_t>(now_ms - target_ms) >= 0;
   }
 
+  void roll_load_window(uint32_t now_ms) {
+    const uint32_t elapsed_ms = now_ms - window_start_ms_;
+    if (elapsed_ms < kLoadWindowMs) {
+      return;
+    }
+    const uint32_t permille = window_work_us_ / elapsed_ms;  // us per ms = permille
+    occupancy_permille_ = static_cast<uint16_t>(permille > 1000U ? 1000U : permille);
+    rendered_fps_ = static_cast<uint16_t>((window_frames_ * 1000U + elapsed_ms / 2U) / elapsed_ms);
+    window_start_ms_ = now_ms;
+    window_work_us_ = 0;
+    window_frames_ = 0;
+  }
+
+  // Moves the next boundary to the first grid boundary at or after t_ms, with the rounding state
+  // advance_next_frame() would have there.
+  void snap_to_grid(uint32_t t_ms) {
+    if (target_fps_ == 0) {
+      return;
+    }
+    const uint64_t fps = target_fps_;
+    const uint64_t k = (static_cast<uint64_t>(t_ms) * fps + 999U) / 1000U;
+    next_frame_ms_ = static_cast<uint32_t>(k * 1000U / fps);
+    remainder_acc_ = static_cast<uint16_t>(k * 1000U % fps);
+  }
+
   void advance_next_frame() {
     // Interval is 1000/fps with deterministic rounding spread over frames.
     // Example: 60fps => 1000/60 = 16 remainder 40 => pattern 16/17/17/16...
@@ -69,7 +164,16 @@ class FrameScheduler {
   uint32_t last_render_ms_ = 0;
   uint32_t next_frame_ms_ = 0;
   uint16_t remainder_acc_ = 0;
+  bool phase_locked_ = false;
   uint32_t last_dt_ms_ = 0;
+  bool hold_active_ = false;
+  uint32_t hold_until_ms_ = 0;
+  uint32_t held_frames_ = 0;
+  uint32_t window_start_ms_ = 0;
+  uint32_t window_work_us_ = 0;
+  uint32_t window_frames_ = 0;
+  uint16_t occupancy_permille_ = 0;
+  uint16_t rendered_fps_ = 0;
 };
 
 }  // namespace core
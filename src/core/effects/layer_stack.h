@@ -0,0 +1,211 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../mapping/mapping_tables.h"
+#include "../settings/effect_config_store.h"
+#include "blend.h"
+#include "effect.h"
+#include "effect_descriptor.h"
+#include "effect_scratch.h"
+#include "effect_v2.h"
+#include "params.h"
+
+namespace chromance {
+namespace core {
+
+namespace layer_stack {
+
+constexpr uint8_t kMaxLayers = 3;
+
+// Persisted per-stack config. Layer 0 is the base; its mode is unused.
+struct PersistedConfig {
+  uint8_t opacity[kMaxLayers];
+  uint8_t mode[kMaxLayers];
+};
+
+static_assert(sizeof(PersistedConfig) <= kMaxEffectConfigSize, "Layer stack config too large");
+
+// Param ids: opacity of layer i is 1 + 2i, blend mode of layer i (i >= 1) is 2 + 2i.
+constexpr ParamId opacity_param(uint8_t layer) { return ParamId(static_cast<uint16_t>(1U + 2U * layer)); }
+constexpr ParamId mode_param(uint8_t layer) { return ParamId(static_cast<uint16_t>(2U + 2U * layer)); }
+
+static const char* const kOpacityNames[kMaxLayers] = {"layer1_opacity", "layer2_opacity", "layer3_opacity"};
+static const char* const kOpacityDisplayNames[kMaxLayers] = {"Layer 1 Opacity", "Layer 2 Opacity",
+                                                             "Layer 3 Opacity"};
+static const char* const kModeNames[kMaxLayers] = {nullptr, "layer2_mode", "layer3_mode"};
+static const char* const kModeDisplayNames[kMaxLayers] = {nullptr, "Layer 2 Blend", "Layer 3 Blend"};
+
+}  // namespace layer_stack
+
+// Composites up to layer_stack::kMaxLayers effects into one frame. The base layer renders straight into the
+// output (scaled by its opacity); each upper layer renders into one blend buffer and is blended on top with its
+// mode and opacity. The blend buffer and the layers' own scratch come out of the stack's per-activation
+// scratch. Modes and opacities are ordinary schema params, so they
+// persist and stream like any other effect param.
+//
+// Layers are owned elsewhere and are not registered with the catalog on their own account: they get their
+// lifecycle calls from the stack and are never bound to manager-owned config. Call add_layer() before the
+// stack is added to the catalog, so EffectManager sees the complete schema.
+template <size_t MaxLeds = MappingTables::led_count()>
+class LayerStackEffect final : public IEffectV2 {
+ public:
+  explicit LayerStackEffect(const EffectDescriptor& descriptor) : descriptor_(descriptor) {}
+
+  // Appends a layer on top of the stack; mode and opacity become the param defaults. False when full.
+  bool add_layer(IEffectV2* effect, BlendMode mode, uint8_t opacity) {
+    if (effect == nullptr || count_ >= layer_stack::kMaxLayers) {
+      return false;
+    }
+    const uint8_t i = count_;
+    layers_[i] = effect;
+    default_opacity_[i] = opacity;
+    default_mode_[i] = i == 0 ? static_cast<uint8_t>(BlendMode::kAlpha) : static_cast<uint8_t>(mode);
+    info_[i].effect = &effect->descriptor();
+    info_[i].opacity_param = layer_stack::opacity_param(i);
+    info_[i].mode_param = i == 0 ? ParamId() : layer_stack::mode_param(i);
+
+    params_[param_count_++] = {layer_stack::opacity_param(i),
+                               layer_stack::kOpacityNames[i],
+                               layer_stack::kOpacityDisplayNames[i],
+                               ParamType::U8,
+                               static_cast<uint16_t>(offsetof(layer_stack::PersistedConfig, opacity) + i),
+                               1,
+                               0,
+                               255,
+                               1,
+                               opacity,
+                               1};
+    if (i > 0) {
+      params_[param_count_++] = {layer_stack::mode_param(i),
+                                 layer_stack::kModeNames[i],
+                                 layer_stack::kModeDisplayNames[i],
+                                 ParamType::Enum,
+                                 static_cast<uint16_t>(offsetof(layer_stack::PersistedConfig, mode) + i),
+                                 1,
+                                 0,
+                                 kBlendModeCount - 1,
+                                 1,
+                                 default_mode_[i],
+                                 1};
+    }
+    schema_.params = params_;
+    schema_.param_count = param_count_;
+    ++count_;
+    return true;
+  }
+
+  const EffectDescriptor& descriptor() const override { return descriptor_; }
+  const EffectConfigSchema* schema() const override { return count_ > 0 ? &schema_ : nullptr; }
+
+  void bind_config(const void* config_bytes, size_t config_size) override {
+    cfg_ = (config_bytes != nullptr && config_size >= sizeof(layer_stack::PersistedConfig))
+               ? static_cast<const layer_stack::PersistedConfig*>(config_bytes)
+               : nullptr;
+  }
+
+  bool needs_prepare() const override {
+    for (uint8_t i = 0; i < count_; ++i) {
+      if (layers_[i]->needs_prepare()) return true;
+    }
+    return false;
+  }
+
+  void prepare(const EventContext& ctx) override {
+    for (uint8_t i = 0; i < count_; ++i) {
+      if (layers_[i]->needs_prepare()) layers_[i]->prepare(ctx);
+    }
+  }
+
+  // The blend buffer (only with upper layers), then each layer's scratch in order.
+  size_t scratch_bytes() const override {
+    size_t bytes = count_ > 1 ? scratch_block_bytes<Rgb>(MaxLeds) : 0;
+    for (uint8_t i = 0; i < count_; ++i) bytes += scratch_block_bytes<uint8_t>(layers_[i]->scratch_bytes());
+    return bytes;
+  }
+
+  void start(const EventContext& ctx) override {
+    ScratchCarver carver(ctx.scratch);
+    blend_ = count_ > 1 ? carver.take<Rgb>(MaxLeds) : nullptr;
+    EventContext layer_ctx = ctx;
+    for (uint8_t i = 0; i < count_; ++i) {
+      layer_ctx.scratch = carver.take_scratch(layers_[i]->scratch_bytes());
+      layers_[i]->start(layer_ctx);
+    }
+  }
+
+  void stop(const EventContext& ctx) override {
+    for (uint8_t i = 0; i < count_; ++i) layers_[i]->stop(ctx);
+    blend_ = nullptr;
+  }
+
+  void reset_runtime(const EventContext& ctx) override {
+    for (uint8_t i = 0; i < count_; ++i) layers_[i]->reset_runtime(ctx);
+  }
+
+  void on_event(const InputEvent& ev, const EventContext& ctx) override {
+    for (uint8_t i = 0; i < count_; ++i) layers_[i]->on_event(ev, ctx);
+  }
+
+  // The stack changes as soon as any visible layer does.
+  uint32_t next_change_ms(uint32_t now_ms) const override {
+    uint32_t next = now_ms + kNoChangeAheadMs;
+    for (uint8_t i = 0; i < count_; ++i) {
+      if (opacity_of(i) == 0) continue;
+      const uint32_t t = layers_[i]->next_change_ms(now_ms);
+      if (static_cast<int32_t>(t - next) < 0) next = t;
+    }
+    return next;
+  }
+
+  uint8_t layer_count() const override { return count_; }
+  const LayerDescriptor* layer_at(uint8_t i) const override { return i < count_ ? &info_[i] : nullptr; }
+
+  void render(const RenderContext& ctx, Rgb* out_rgb, size_t led_count) override {
+    if (out_rgb == nullptr || led_count == 0) {
+      return;
+    }
+    if (count_ == 0 || led_count > MaxLeds || (count_ > 1 && blend_ == nullptr)) {
+      for (size_t i = 0; i < led_count; ++i) {
+        out_rgb[i] = kBlack;
+      }
+      return;
+    }
+    layers_[0]->render(ctx, out_rgb, led_count);
+    scale_frame(out_rgb, led_count, opacity_of(0));
+    for (uint8_t i = 1; i < count_; ++i) {
+      const uint8_t opacity = opacity_of(i);
+      if (opacity == 0) {
+        continue;  // skipped layers do not render at all
+      }
+      layers_[i]->render(ctx, blend_, led_count);
+      blend_layer(out_rgb, blend_, led_count, mode_of(i), opacity);
+    }
+  }
+
+ private:
+  uint8_t opacity_of(uint8_t i) const { return cfg_ ? cfg_->opacity[i] : default_opacity_[i]; }
+
+  BlendMode mode_of(uint8_t i) const {
+    const uint8_t m = cfg_ ? cfg_->mode[i] : default_mode_[i];
+    return m < kBlendModeCount ? static_cast<BlendMode>(m) : BlendMode::kAlpha;
+  }
+
+  EffectDescriptor descriptor_{};
+  IEffectV2* layers_[layer_stack::kMaxLayers] = {};
+  LayerDescriptor info_[layer_stack::kMaxLayers] = {};
+  uint8_t default_opacity_[layer_stack::kMaxLayers] = {};
+  uint8_t default_mode_[layer_stack::kMaxLayers] = {};
+  uint8_t count_ = 0;
+
+  ParamDescriptor params_[2 * layer_stack::kMaxLayers - 1] = {};
+  uint8_t param_count_ = 0;
+  EffectConfigSchema schema_{nullptr, 0};
+  const layer_stack::PersistedConfig* cfg_ = nullptr;
+
+  Rgb* blend_ = nullptr;  // scratch, [MaxLeds]
+};
+
+}  // namespace core
+}  // namespace chromance
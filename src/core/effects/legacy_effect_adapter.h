@@ -18,13 +18,36 @@ class LegacyEffectAdapter final : public IEffectV2 {
   const EffectDescriptor& descriptor() const override { return descriptor_; }
   const EffectConfigSchema* schema() const override { return nullptr; }
 
+  bool needs_prepare() const override { return legacy_ != nullptr && legacy_->needs_prepare(); }
+
+  void prepare(const EventContext& ctx) override {
+    if (legacy_ == nullptr || ctx.map == nullptr) {
+      return;
+    }
+    legacy_->prepare(ctx.map->led_count());
+  }
+
+  uint32_t next_change_ms(uint32_t now_ms) const override {
+    return legacy_ != nullptr ? legacy_->next_change_ms(now_ms) : now_ms + kNoChangeAheadMs;
+  }
+
+  size_t scratch_bytes() const override { return legacy_ != nullptr ? legacy_->scratch_bytes() : 0; }
+
   void start(const EventContext& ctx) override {
     if (legacy_ == nullptr) {
       return;
     }
+    legacy_->bind_scratch(ctx.scratch);
     legacy_->reset(ctx.now_ms);
   }
 
+  void stop(const EventContext& ctx) override {
+    (void)ctx;
+    if (legacy_ != nullptr) {
+      legacy_->bind_scratch(EffectScratch{});
+    }
+  }
+
   void reset_runtime(const EventContext& ctx) override {
     if (legacy_ == nullptr) {
       return;
@@ -43,15 +66,26 @@ class LegacyEffectAdapter final : public IEffectV2 {
       return;
     }
 
+    legacy_->render(make_frame(ctx), *ctx.map, out_rgb, led_count);
+  }
+
+  bool render_wire(const RenderContext& ctx, StripPixel* out, size_t led_count) override {
+    if (out == nullptr || led_count == 0 || legacy_ == nullptr || ctx.map == nullptr) {
+      return false;
+    }
+    return legacy_->render_wire(make_frame(ctx), *ctx.map, out, led_count);
+  }
+
+ private:
+  static EffectFrame make_frame(const RenderContext& ctx) {
     EffectFrame frame;
     frame.now_ms = ctx.now_ms;
     frame.dt_ms = ctx.dt_ms;
     frame.params = ctx.global_params;
     frame.signals = ctx.signals;
-    legacy_->render(frame, *ctx.map, out_rgb, led_count);
+    return frame;
   }
 
- private:
   EffectDescriptor descriptor_{};
   IEffect* legacy_ = nullptr;  // non-owning
 };
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../protocol/param_frame.h"
+#include "effect_manager.h"
+
+namespace chromance {
+namespace core {
+
+// Last-write-wins buffer for streamed parameter updates.
+//
+// Transports push updates as they arrive (any rate); the render loop applies the pending set once per
+// frame, so a slider dragged at 60 Hz costs at most one set_param per (effect, param) per frame.
+template <size_t Capacity>
+class ParamCoalescer final {
+ public:
+  struct Stats {
+    uint32_t pushed = 0;
+    uint32_t coalesced = 0;  // superseded by a newer value before being applied
+    uint32_t dropped = 0;    // table full (distinct keys > Capacity within one frame)
+    uint32_t applied = 0;
+    uint32_t rejected = 0;   // EffectManager refused (unknown param, range, step)
+  };
+
+  bool push(EffectId effect, ParamId param, int32_t raw) {
+    if (!effect.valid() || !param.valid()) {
+      return false;
+    }
+    ++stats_.pushed;
+    for (size_t i = 0; i < count_; ++i) {
+      if (pending_[i].effect == effect && pending_[i].param.value == param.value) {
+        pending_[i].raw = raw;
+        ++stats_.coalesced;
+        return true;
+      }
+    }
+    if (count_ >= Capacity) {
+      ++stats_.dropped;
+      return false;
+    }
+    pending_[count_++] = ParamUpdate{effect, param, raw};
+    return true;
+  }
+
+  size_t pending() const { return count_; }
+  const Stats& stats() const { return stats_; }
+
+  // Applies all pending updates in arrival order of their first write, then clears the table.
+  template <size_t MaxEffects>
+  size_t apply(EffectManager<MaxEffects>& manager) {
+    size_t ok = 0;
+    for (size_t i = 0; i < count_; ++i) {
+      if (manager.set_param_raw(pending_[i].effect, pending_[i].param, pending_[i].raw)) {
+        ++ok;
+      } else {
+        ++stats_.rejected;
+      }
+    }
+    stats_.applied += static_cast<uint32_t>(ok);
+    count_ = 0;
+    return ok;
+  }
+
+  void clear() { count_ = 0; }
+
+ private:
+  ParamUpdate pending_[Capacity] = {};
+  size_t count_ = 0;
+  Stats stats_{};
+};
+
+}  // namespace core
+}  // namespace chromance
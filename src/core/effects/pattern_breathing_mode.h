@@ -6,6 +6,7 @@
 #include "../mapping/mapping_tables.h"
 #include "../types.h"
 #include "effect.h"
+#include "effect_scratch.h"
 
 namespace chromance {
 namespace core {
@@ -22,6 +23,9 @@ namespace core {
 // - `n`/`N`: select phase and stay there (no automatic phase progression).
 // - `ESC`: return to auto mode (restarts at INHALE).
 // - INHALE-only lane stepping (manual only): `s`/`S` rotates center lane offset and reinitializes INHALE.
+//
+// The dot and batch pools, wave emit positions and the segment A->B lookup are only needed while the effect
+// runs; they live in per-activation scratch (bind_scratch()). The topology cache is permanent.
 class BreathingEffect final : public IEffect {
  public:
   const char* id() const override { return "Breathing"; }
@@ -53,8 +57,9 @@ class BreathingEffect final : public IEffect {
   };
 
   void reset(uint32_t now_ms) override {
-    built_ = false;
-    built_led_count_ = 0;
+    // The topology cache depends only on the mapping and center config; keep it (see prepare()) and just
+    // re-init the phase on the next render.
+    phase_init_pending_ = true;
     manual_enabled_ = false;
     manual_phase_ = Phase::Inhale;
 
@@ -97,8 +102,48 @@ class BreathingEffect final : public IEffect {
 
   // Runtime-tweakable config (optional). Any change forces a rebuild on next render.
   void set_config(const Config& cfg) {
+    if (cfg.has_configured_center != cfg_.has_configured_center ||
+        cfg.configured_center_vertex_id != cfg_.configured_center_vertex_id) {
+      built_ = false;
+    }
     cfg_ = cfg;
-    built_ = false;
+    phase_init_pending_ = true;
+  }
+
+  bool needs_prepare() const override { return !built_; }
+
+  size_t scratch_bytes() const override { return kScratchBytes; }
+
+  void bind_scratch(const EffectScratch& scratch) override {
+    ScratchCarver carver(scratch);
+    dots_ = carver.take<Dot>(kMaxDots);
+    inhale_batches_ = carver.take<InhaleBatch>(kMaxInhaleBatches);
+    exhale_emit_pos_q16_ = carver.take<uint32_t>(kMaxWaves);
+    seg_ab_to_global_ = carver.take<SegLookupRow>(kMaxSegments + 1U);
+    if (seg_ab_to_global_ == nullptr) {
+      dots_ = nullptr;  // too small: run as unbound
+      inhale_batches_ = nullptr;
+      exhale_emit_pos_q16_ = nullptr;
+    }
+    if (dots_ != nullptr) {
+      for (uint8_t i = 0; i < kMaxDots; ++i) dots_[i] = Dot{};
+      for (uint8_t i = 0; i < kMaxInhaleBatches; ++i) inhale_batches_[i] = InhaleBatch{};
+      for (uint8_t i = 0; i < kMaxWaves; ++i) exhale_emit_pos_q16_[i] = 0;
+    }
+    seg_lookup_led_count_ = 0;
+    phase_init_pending_ = true;
+  }
+
+  // Builds the topology cache (adjacency, center lanes, distance layers) ahead of the first render.
+  void prepare(size_t led_count) override {
+    const uint16_t n = static_cast<uint16_t>(
+        led_count > MappingTables::led_count() ? MappingTables::led_count() : led_count);
+    if (!built_ || built_led_count_ != n) {
+      build_topology_cache(n);
+      built_ = true;
+      built_led_count_ = n;
+      phase_init_pending_ = true;
+    }
   }
 
   // INHALE-only, manual-only: rotate center lane offset and reinit inhale.
@@ -110,15 +155,15 @@ class BreathingEffect final : public IEffect {
   uint8_t center_vertex_id() const { return center_vertex_id_; }
   uint8_t lane_count() const { return center_lane_count_; }
   uint8_t center_lane_rr_offset() const { return center_lane_rr_offset_; }
-  uint8_t dot_count() const { return inhale_dot_count_; }
-  uint8_t dot_start_vertex(uint8_t i) const { return (i < inhale_dot_count_) ? dots_[i].start_v : 0; }
-  uint8_t dot_goal_vertex(uint8_t i) const { return (i < inhale_dot_count_) ? dots_[i].goal_v : 0; }
-  uint8_t dot_step_count(uint8_t i) const { return (i < inhale_dot_count_) ? dots_[i].step_count : 0; }
+  uint8_t dot_count() const { return dots_ != nullptr ? inhale_dot_count_ : 0; }
+  uint8_t dot_start_vertex(uint8_t i) const { return (i < dot_count()) ? dots_[i].start_v : 0; }
+  uint8_t dot_goal_vertex(uint8_t i) const { return (i < dot_count()) ? dots_[i].goal_v : 0; }
+  uint8_t dot_step_count(uint8_t i) const { return (i < dot_count()) ? dots_[i].step_count : 0; }
   uint8_t dot_step_seg(uint8_t i, uint8_t step) const {
-    return (i < inhale_dot_count_ && step < dots_[i].step_count) ? dots_[i].step_seg[step] : 0;
+    return (i < dot_count() && step < dots_[i].step_count) ? dots_[i].step_seg[step] : 0;
   }
   uint8_t dot_step_dir(uint8_t i, uint8_t step) const {
-    return (i < inhale_dot_count_ && step < dots_[i].step_count) ? dots_[i].step_dir[step] : 0;
+    return (i < dot_count() && step < dots_[i].step_count) ? dots_[i].step_dir[step] : 0;
   }
 
   void render(const EffectFrame& frame,
@@ -127,14 +172,17 @@ class BreathingEffect final : public IEffect {
               size_t led_count) override {
     if (out_rgb == nullptr || led_count == 0) return;
     for (size_t i = 0; i < led_count; ++i) out_rgb[i] = kBlack;
+    if (dots_ == nullptr) return;  // no scratch bound
 
     const uint16_t n = static_cast<uint16_t>(
         led_count > MappingTables::led_count() ? MappingTables::led_count() : led_count);
-    if (!built_ || built_led_count_ != n) {
-      build_topology_cache(n);
+    prepare(n);  // no-op once warmed up
+    if (seg_lookup_led_count_ != n) {
+      build_seg_lookup(n);
+    }
+    if (phase_init_pending_) {
       init_phase(frame.now_ms, /*auto_transition_into_inhale=*/false);
-      built_ = true;
-      built_led_count_ = n;
+      phase_init_pending_ = false;
     }
 
     if (manual_enabled_) {
@@ -155,9 +203,18 @@ class BreathingEffect final : public IEffect {
   }
 
  private:
-  static constexpr uint8_t kMaxVertices = 32;
-  static constexpr uint8_t kMaxSegments = 40;
+  static constexpr uint8_t kMaxVertices = MappingTables::vertex_count();
+  static constexpr uint8_t kMaxSegments = MappingTables::segment_count();
   static constexpr uint8_t kMaxDegree = 6;
+  static_assert(MappingTables::max_vertex_degree() <= kMaxDegree, "raise kMaxDegree for this topology");
+
+  // Visited set for path search; sized by vertex count (a single uint32_t mask only covers 32 vertices).
+  struct VertexSet {
+    uint32_t words[(kMaxVertices + 31U) / 32U];
+    bool test(uint8_t v) const { return ((words[v >> 5] >> (v & 31U)) & 1U) != 0; }
+    void set(uint8_t v) { words[v >> 5] |= (1u << (v & 31U)); }
+    void reset(uint8_t v) { words[v >> 5] &= ~(1u << (v & 31U)); }
+  };
   static constexpr uint8_t kLedsPerSegment = 14;
   static constexpr uint8_t kMaxDots = 36;          // pool of active inhale dots (supports overlap)
   static constexpr uint8_t kMaxDotsPerBatch = 12;  // per "contraction experience"
@@ -226,6 +283,7 @@ class BreathingEffect final : public IEffect {
   }
 
   void lane_step(int8_t dir, uint32_t now_ms) {
+    if (dots_ == nullptr) return;
     if (!manual_enabled_) return;
     if (phase_ != Phase::Inhale) return;
     if (center_lane_count_ == 0) return;
@@ -241,24 +299,32 @@ class BreathingEffect final : public IEffect {
     init_inhale(now_ms, /*advance_rr_offset=*/false, /*regenerate_paths=*/true);
   }
 
-  void build_topology_cache(uint16_t led_count) {
-    // Segment presence + canonical A->B lookup (physical coordinate).
-    for (uint8_t s = 0; s <= kMaxSegments; ++s) seg_present_[s] = false;
-    for (uint8_t s = 0; s <= kMaxSegments; ++s) {
+  // Canonical A->B lookup (physical coordinate), in scratch.
+  void build_seg_lookup(uint16_t led_count) {
+    for (uint16_t s = 0; s <= kMaxSegments; ++s) {
       for (uint8_t k = 0; k < kLedsPerSegment; ++k) seg_ab_to_global_[s][k] = 0xFFFF;
     }
-
     const uint8_t* seg = MappingTables::global_to_seg();
     const uint16_t* local = MappingTables::global_to_local();
     const uint8_t* dir = MappingTables::global_to_dir();
     for (uint16_t i = 0; i < led_count; ++i) {
       const uint8_t seg_id = seg[i];
       if (seg_id < 1 || seg_id > kMaxSegments) continue;
-      seg_present_[seg_id] = true;
       const uint8_t local_in_seg = static_cast<uint8_t>(local[i] % kLedsPerSegment);
       const uint8_t ab_k = (dir[i] == 0) ? local_in_seg : static_cast<uint8_t>((kLedsPerSegment - 1U) - local_in_seg);
       seg_ab_to_global_[seg_id][ab_k] = i;
     }
+    seg_lookup_led_count_ = led_count;
+  }
+
+  void build_topology_cache(uint16_t led_count) {
+    // Segment presence.
+    for (uint16_t s = 0; s <= kMaxSegments; ++s) seg_present_[s] = false;
+    const uint8_t* seg = MappingTables::global_to_seg();
+    for (uint16_t i = 0; i < led_count; ++i) {
+      const uint8_t seg_id = seg[i];
+      if (seg_id >= 1 && seg_id <= kMaxSegments) seg_present_[seg_id] = true;
+    }
 
     // Build adjacency on present segments.
     const uint8_t vcount = MappingTables::vertex_count();
@@ -267,7 +333,8 @@ class BreathingEffect final : public IEffect {
     const uint8_t* sva = MappingTables::seg_vertex_a();
     const uint8_t* svb = MappingTables::seg_vertex_b();
     const uint8_t scount = MappingTables::segment_count();
-    for (uint8_t seg_id = 1; seg_id <= scount && seg_id <= kMaxSegments; ++seg_id) {
+    for (uint16_t s = 1; s <= scount && s <= kMaxSegments; ++s) {
+      const uint8_t seg_id = static_cast<uint8_t>(s);
       if (!seg_present_[seg_id]) continue;
       const uint8_t va = sva[seg_id];
       const uint8_t vb = svb[seg_id];
@@ -387,6 +454,10 @@ class BreathingEffect final : public IEffect {
   }
 
   void init_phase(uint32_t now_ms, bool auto_transition_into_inhale) {
+    if (dots_ == nullptr) {
+      phase_init_pending_ = true;  // runs once scratch is bound
+      return;
+    }
     phase_complete_ = false;
     switch (phase_) {
       case Phase::Inhale:
@@ -429,6 +500,13 @@ class BreathingEffect final : public IEffect {
     bool active = false;
   };
 
+  typedef uint16_t SegLookupRow[kLedsPerSegment];
+
+  static constexpr size_t kScratchBytes =
+      scratch_block_bytes<Dot>(kMaxDots) + scratch_block_bytes<InhaleBatch>(kMaxInhaleBatches) +
+      scratch_block_bytes<uint32_t>(kMaxWaves) + scratch_block_bytes<SegLookupRow>(kMaxSegments + 1U);
+  static_assert(kScratchBytes <= kDefaultEffectScratchBytes, "raise kDefaultEffectScratchBytes");
+
   InhaleBatch* find_inhale_batch(uint8_t id) {
     for (uint8_t i = 0; i < kMaxInhaleBatches; ++i) {
       if (inhale_batches_[i].active && inhale_batches_[i].id == id) return &inhale_batches_[i];
@@ -637,7 +715,7 @@ class BreathingEffect final : public IEffect {
     }
   }
 
-  bool plateau_safe(uint8_t v, uint8_t goal, uint32_t visited_mask) const {
+  bool plateau_safe(uint8_t v, uint8_t goal, const VertexSet& visited) const {
     if (v == goal) return true;
     const uint8_t dv = dist_to_center_[v];
     if (dv == 0xFF) return false;
@@ -645,7 +723,7 @@ class BreathingEffect final : public IEffect {
     for (uint8_t i = 0; i < deg; ++i) {
       const uint8_t u = vertex_nbr_[v][i];
       if (u >= kMaxVertices) continue;
-      if ((visited_mask & (1u << u)) != 0) continue;
+      if (visited.test(u)) continue;
       const uint8_t du = dist_to_center_[u];
       if (du != 0xFF && du < dv) return true;
     }
@@ -677,10 +755,10 @@ class BreathingEffect final : public IEffect {
     uint8_t cand_count[kMaxVertexPathLen + 1] = {};
     uint8_t cand_pos[kMaxVertexPathLen + 1] = {};
 
-    uint32_t visited = 0;
+    VertexSet visited = {};
     uint8_t depth = 0;
     vpath[0] = start_v;
-    visited |= (1u << start_v);
+    visited.set(start_v);
     cand_count[0] = 0xFF;
 
     while (true) {
@@ -702,7 +780,7 @@ class BreathingEffect final : public IEffect {
           const uint8_t u = vertex_nbr_[v][i];
           const uint8_t seg_id = vertex_nbr_seg_[v][i];
           if (u >= kMaxVertices) continue;
-          if ((visited & (1u << u)) != 0) continue;
+          if (visited.test(u)) continue;
           const uint8_t du = dist_to_center_[u];
           if (du == 0xFF) continue;
           if (du > dv) continue;  // no backtracking
@@ -742,7 +820,7 @@ class BreathingEffect final : public IEffect {
       if (cand_pos[depth] >= cand_count[depth]) {
         // Backtrack.
         if (depth == 0) return false;
-        visited &= ~(1u << vpath[depth]);
+        visited.reset(vpath[depth]);
         cand_count[depth] = 0;
         cand_pos[depth] = 0;
         --depth;
@@ -756,7 +834,7 @@ class BreathingEffect final : public IEffect {
       // Take edge v->u.
       segpath[depth] = s;
       vpath[depth + 1] = u;
-      visited |= (1u << u);
+      visited.set(u);
       ++depth;
       cand_count[depth] = 0xFF;
     }
@@ -1075,6 +1153,7 @@ class BreathingEffect final : public IEffect {
   // Core state.
   bool built_ = false;
   uint16_t built_led_count_ = 0;
+  bool phase_init_pending_ = true;
 
   Config cfg_{};
 
@@ -1092,7 +1171,6 @@ class BreathingEffect final : public IEffect {
 
   // Topology cache (active subgraph).
   bool seg_present_[kMaxSegments + 1] = {};
-  uint16_t seg_ab_to_global_[kMaxSegments + 1][kLedsPerSegment] = {};
 
   uint8_t vertex_deg_[kMaxVertices] = {};
   uint8_t vertex_nbr_[kMaxVertices][kMaxDegree] = {};
@@ -1113,9 +1191,14 @@ class BreathingEffect final : public IEffect {
   uint8_t outermost_vertices_[kMaxVertices] = {};
   uint8_t outermost_count_ = 0;
 
+  // Scratch (bind_scratch()); nullptr while unbound.
+  Dot* dots_ = nullptr;                       // [kMaxDots]
+  InhaleBatch* inhale_batches_ = nullptr;     // [kMaxInhaleBatches]
+  uint32_t* exhale_emit_pos_q16_ = nullptr;   // [kMaxWaves]
+  SegLookupRow* seg_ab_to_global_ = nullptr;  // [kMaxSegments + 1]
+  uint16_t seg_lookup_led_count_ = 0;
+
   // INHALE state.
-  Dot dots_[kMaxDots] = {};
-  InhaleBatch inhale_batches_[kMaxInhaleBatches] = {};
   uint8_t inhale_dot_count_ = 0;  // dots per batch
   bool inhale_all_done_ = false;
   uint8_t inhale_cycles_target_ = 1;  // batches per inhale phase
@@ -1126,7 +1209,6 @@ class BreathingEffect final : public IEffect {
   // EXHALE state.
   uint32_t exhale_global_q16_ = 0;
   uint32_t exhale_since_last_emit_q16_ = 0;
-  uint32_t exhale_emit_pos_q16_[kMaxWaves] = {};
   uint8_t exhale_emitted_ = 0;
   uint8_t exhale_arrived_ = 0;
 
@@ -72,14 +72,33 @@ class BreathingEffectV2 final : public IEffectV2 {
     apply_config_to_legacy();
   }
 
+  bool needs_prepare() const override { return legacy_ != nullptr && legacy_->needs_prepare(); }
+
+  void prepare(const EventContext& ctx) override {
+    if (legacy_ == nullptr || ctx.map == nullptr) {
+      return;
+    }
+    legacy_->prepare(ctx.map->led_count());
+  }
+
+  size_t scratch_bytes() const override { return legacy_ != nullptr ? legacy_->scratch_bytes() : 0; }
+
   void start(const EventContext& ctx) override {
     if (legacy_ == nullptr) {
       return;
     }
+    legacy_->bind_scratch(ctx.scratch);
     legacy_->reset(ctx.now_ms);
     apply_config_to_legacy();
   }
 
+  void stop(const EventContext& ctx) override {
+    (void)ctx;
+    if (legacy_ != nullptr) {
+      legacy_->bind_scratch(EffectScratch{});
+    }
+  }
+
   void reset_runtime(const EventContext& ctx) override {
     if (legacy_ == nullptr) {
       return;
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../clip/clip_format.h"
+#include "blend.h"
+#include "effect.h"
+
+namespace chromance {
+namespace core {
+
+// Plays a baked clip (clip/clip_format.h) in place, looping at the clip's own frame rate. The clip bytes are
+// only read, never copied, so they can sit in memory-mapped flash; per frame the player decodes one delta
+// (typically a few dozen bytes) and does one palette lookup per LED. The palette is copied to RAM and
+// re-scaled only when brightness changes. A frame that falls behind (slow loop, switch back to this mode)
+// seeks from the nearest keyframe instead of replaying every delta.
+template <size_t MaxLeds>
+class ClipPlayerEffect final : public IEffect {
+ public:
+  const char* id() const override { return "Clip_Player"; }
+
+  // Accepts a clip baked for this LED layout (led count and clip::mapping_hash() must match). Without a
+  // valid clip the effect renders black.
+  bool set_clip(const uint8_t* data, size_t size, size_t led_count, uint32_t mapping_hash) {
+    ClipReader r;
+    if (!r.open(data, size) || r.led_count() != led_count || led_count > MaxLeds ||
+        r.mapping_hash() != mapping_hash) {
+      reader_ = ClipReader();
+      return false;
+    }
+    reader_ = r;
+    for (uint16_t i = 0; i < reader_.palette_size(); ++i) {
+      palette_[i] = reader_.palette(static_cast<uint8_t>(i));
+    }
+    scaled_brightness_valid_ = false;
+    decoded_valid_ = false;
+    return true;
+  }
+
+  bool has_clip() const { return reader_.valid(); }
+  const ClipReader& reader() const { return reader_; }
+
+  void reset(uint32_t now_ms) override {
+    start_ms_ = now_ms;
+    decoded_valid_ = false;
+  }
+
+  uint32_t next_change_ms(uint32_t now_ms) const override {
+    if (!reader_.valid() || reader_.frame_count() < 2U) {
+      return now_ms + kNoChangeAheadMs;
+    }
+    // First millisecond of the next clip frame.
+    const uint64_t next = absolute_frame(now_ms) + 1U;
+    const uint64_t at = (next * 1000U + reader_.fps() - 1U) / reader_.fps();
+    return start_ms_ + static_cast<uint32_t>(at);
+  }
+
+  void render(const EffectFrame& frame, const PixelsMap& /*map*/, Rgb* out_rgb, size_t led_count) override {
+    if (out_rgb == nullptr || led_count == 0) {
+      return;
+    }
+    if (!reader_.valid() || led_count != reader_.led_count()) {
+      for (size_t i = 0; i < led_count; ++i) out_rgb[i] = kBlack;
+      return;
+    }
+
+    const uint32_t target = static_cast<uint32_t>(absolute_frame(frame.now_ms) % reader_.frame_count());
+    if (!decoded_valid_ || target != shown_frame_) {
+      const bool ok = (decoded_valid_ && target == reader_.next_frame()) ? reader_.decode_next(indices_)
+                                                                          : reader_.seek(target, indices_);
+      if (!ok) {
+        // Corrupt data past validation: hold black rather than show a half-applied frame.
+        decoded_valid_ = false;
+        reader_.rewind();
+        for (size_t i = 0; i < led_count; ++i) out_rgb[i] = kBlack;
+        return;
+      }
+      shown_frame_ = target;
+      decoded_valid_ = true;
+    }
+
+    if (!scaled_brightness_valid_ || scaled_brightness_ != frame.params.brightness) {
+      for (uint16_t i = 0; i < reader_.palette_size(); ++i) scaled_[i] = palette_[i];
+      scale_frame(scaled_, reader_.palette_size(), frame.params.brightness);
+      scaled_brightness_ = frame.params.brightness;
+      scaled_brightness_valid_ = true;
+    }
+    for (size_t i = 0; i < led_count; ++i) {
+      out_rgb[i] = scaled_[indices_[i]];
+    }
+  }
+
+ private:
+  uint64_t absolute_frame(uint32_t now_ms) const {
+    return static_cast<uint64_t>(now_ms - start_ms_) * reader_.fps() / 1000U;
+  }
+
+  ClipReader reader_;
+  uint32_t start_ms_ = 0;
+  uint32_t shown_frame_ = 0;
+  bool decoded_valid_ = false;
+  uint8_t scaled_brightness_ = 0;
+  bool scaled_brightness_valid_ = false;
+  uint8_t indices_[MaxLeds] = {};
+  Rgb palette_[256] = {};
+  Rgb scaled_[256] = {};
+};
+
+}  // namespace core
+}  // namespace chromance
@@ -14,11 +14,24 @@ class CoordColorEffect final : public IEffect {
 
   void reset(uint32_t /*now_ms*/) override {}
 
+  uint32_t next_change_ms(uint32_t now_ms) const override { return now_ms + kNoChangeAheadMs; }
+
   void render(const EffectFrame& frame,
               const PixelsMap& map,
               Rgb* out_rgb,
               size_t led_count) override {
-    if (out_rgb == nullptr || led_count == 0) {
+    paint(frame, map, out_rgb, led_count);
+  }
+
+  bool render_wire(const EffectFrame& frame, const PixelsMap& map, StripPixel* out, size_t led_count) override {
+    paint(frame, map, out, led_count);
+    return true;
+  }
+
+ private:
+  template <typename Pixel>
+  static void paint(const EffectFrame& frame, const PixelsMap& map, Pixel* out, size_t led_count) {
+    if (out == nullptr || led_count == 0) {
       return;
     }
 
@@ -30,11 +43,10 @@ class CoordColorEffect final : public IEffect {
       const PixelCoord c = map.coord(i);
       const uint8_t r = scale_0_255(normalize_0_255(c.x, w), brightness);
       const uint8_t g = scale_0_255(normalize_0_255(c.y, h), brightness);
-      out_rgb[i] = Rgb{r, g, 0};
+      put_pixel(out[i], Rgb{r, g, 0});
     }
   }
 
- private:
   static uint8_t scale_0_255(uint8_t v, uint16_t brightness) {
     return static_cast<uint8_t>((static_cast<uint16_t>(v) * brightness) / 255U);
   }
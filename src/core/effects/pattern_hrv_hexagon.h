@@ -5,6 +5,7 @@
 
 #include "../types.h"
 #include "../mapping/mapping_tables.h"
+#include "../mapping/segment_mask.h"
 #include "effect.h"
 
 namespace chromance {
@@ -49,16 +50,26 @@ class HrvHexagonEffect final : public IEffect {
     if (alpha16 == 0 || current_seg_count_ == 0) return;
 
     const uint16_t scale16 = scale16_from_alpha_and_brightness(alpha16, frame.params.brightness);
+    // The hold keeps one dither pattern so the frame is truly static (see next_change_ms()).
+    const uint32_t dither_ms = in_hold(elapsed) ? cycle_start_ms_ : frame.now_ms;
 
+    const uint32_t* attrs = MappingTables::led_attrs();
     for (uint16_t i = 0; i < led_count; ++i) {
-      const uint8_t seg = MappingTables::global_to_seg()[i];
-      if (seg == 0 || seg > 40) continue;
-      if (segment_in_current(seg)) {
-        out_rgb[i] = scale_dither(current_color_, scale16, frame.now_ms, i);
+      if (current_mask_.contains(LedAttr{attrs[i]})) {
+        out_rgb[i] = scale_dither(current_color_, scale16, dither_ms, i);
       }
     }
   }
 
+  // Fades change every frame; the hold phase is static until it ends.
+  uint32_t next_change_ms(uint32_t now_ms) const override {
+    uint32_t elapsed = now_ms - cycle_start_ms_;
+    if (manual_enabled_) {
+      elapsed = kCycleMs ? (elapsed % kCycleMs) : elapsed;
+    }
+    return in_hold(elapsed) ? now_ms + (kFadeInMs + kHoldMs - elapsed) : now_ms;
+  }
+
   uint8_t current_hex_index() const { return current_hex_; }
   Rgb current_color() const { return current_color_; }
   uint8_t current_segment_count() const { return current_seg_count_; }
@@ -134,6 +145,10 @@ class HrvHexagonEffect final : public IEffect {
     return static_cast<uint16_t>(y);
   }
 
+  static bool in_hold(uint32_t elapsed_ms) {
+    return elapsed_ms >= kFadeInMs && elapsed_ms < kFadeInMs + kHoldMs;
+  }
+
   static uint16_t phase_alpha16(uint32_t elapsed_ms) {
     if (elapsed_ms < kFadeInMs) {
       const uint16_t t = static_cast<uint16_t>((elapsed_ms * 65535U) / kFadeInMs);
@@ -187,21 +202,20 @@ class HrvHexagonEffect final : public IEffect {
     };
   }
 
-  void build_segment_presence() {
-    for (uint8_t s = 0; s <= 40; ++s) seg_present_[s] = false;
-    const uint16_t n = MappingTables::led_count();
-    const uint8_t* segs = MappingTables::global_to_seg();
-    for (uint16_t i = 0; i < n; ++i) {
-      const uint8_t seg = segs[i];
-      if (seg <= 40) seg_present_[seg] = true;
-    }
-  }
+  void build_segment_presence() { seg_present_ = present_segments(); }
 
-  bool segment_in_current(uint8_t seg_id) const {
-    for (uint8_t i = 0; i < current_seg_count_; ++i) {
-      if (current_segs_[i] == seg_id) return true;
+  // Caches the current hex's segments that exist in this mapping, as a list (for logging) and as a mask
+  // (for render).
+  void select_current_segments() {
+    current_seg_count_ = 0;
+    current_mask_.clear();
+    for (uint8_t i = 0; i < kHexSegCount; ++i) {
+      const uint8_t seg = kHexSegs[current_hex_][i];
+      if (seg_present_.test(seg)) {
+        current_segs_[current_seg_count_++] = seg;
+        current_mask_.set(seg);
+      }
     }
-    return false;
   }
 
   uint8_t build_candidates(uint8_t* out, uint8_t out_cap) const {
@@ -210,7 +224,7 @@ class HrvHexagonEffect final : public IEffect {
       bool present = false;
       for (uint8_t i = 0; i < kHexSegCount; ++i) {
         const uint8_t seg = kHexSegs[h][i];
-        if (seg_present_[seg]) {
+        if (seg_present_.test(seg)) {
           present = true;
           break;
         }
@@ -245,12 +259,7 @@ class HrvHexagonEffect final : public IEffect {
     manual_enabled_ = true;
     cycle_start_ms_ = now_ms;
     current_hex_ = candidates[next_pos];
-    // Cache segments for this hex and pick a new color.
-    current_seg_count_ = 0;
-    for (uint8_t i = 0; i < kHexSegCount; ++i) {
-      const uint8_t seg = kHexSegs[current_hex_][i];
-      if (seg_present_[seg]) current_segs_[current_seg_count_++] = seg;
-    }
+    select_current_segments();
     current_color_ = hue_to_rgb(static_cast<uint8_t>(next_u32() & 0xFF));
   }
 
@@ -278,13 +287,7 @@ class HrvHexagonEffect final : public IEffect {
       current_hex_ = candidates[pick_pos % candidate_count];
     }
 
-    // Cache active segment ids for this hex (skip segments not present in current mapping).
-    current_seg_count_ = 0;
-    for (uint8_t i = 0; i < kHexSegCount; ++i) {
-      const uint8_t seg = kHexSegs[current_hex_][i];
-      if (seg_present_[seg]) current_segs_[current_seg_count_++] = seg;
-    }
-
+    select_current_segments();
     current_color_ = hue_to_rgb(static_cast<uint8_t>(next_u32() & 0xFF));
   }
 
@@ -314,11 +317,12 @@ class HrvHexagonEffect final : public IEffect {
   uint32_t cycle_start_ms_ = 0;
   uint32_t rng_ = 0x12345678u;
 
-  bool seg_present_[41] = {};
+  SegmentMask seg_present_;
   bool manual_enabled_ = false;
   uint8_t current_hex_ = 0;
   uint8_t current_segs_[9] = {};
   uint8_t current_seg_count_ = 0;
+  SegmentMask current_mask_;
   Rgb current_color_{255, 0, 0};
 };
 
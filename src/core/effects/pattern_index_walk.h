@@ -5,10 +5,13 @@
 
 #include "../mapping/mapping_tables.h"
 #include "effect.h"
+#include "effect_scratch.h"
 
 namespace chromance {
 namespace core {
 
+// Lights one LED at a time in index or topology order. The topology scan orders live in per-activation scratch
+// (bind_scratch()); unbound, the topology modes walk in index order.
 class IndexWalkEffect final : public IEffect {
  public:
   enum class ScanMode : uint8_t {
@@ -25,9 +28,7 @@ class IndexWalkEffect final : public IEffect {
   void reset(uint32_t now_ms) override {
     start_ms_ = now_ms;
     scan_mode_ = ScanMode::kIndex;
-    built_ = false;
-    built_led_count_ = 0;
-    topo_len_ = 0;
+    // Topology scan orders depend only on the mapping; keep them across resets.
     active_index_ = 0;
     active_seg_ = 0;
 
@@ -126,6 +127,21 @@ class IndexWalkEffect final : public IEffect {
     step_vertex(-1);
   }
 
+  size_t scratch_bytes() const override { return kScratchBytes; }
+
+  // Builds the scan orders right away, so the first frame after activation does not.
+  void bind_scratch(const EffectScratch& scratch) override {
+    ScratchCarver carver(scratch);
+    topo_seq_ltr_ = carver.take<uint16_t>(MappingTables::led_count());
+    topo_seq_rtl_ = carver.take<uint16_t>(MappingTables::led_count());
+    if (topo_seq_rtl_ == nullptr) {
+      topo_seq_ltr_ = nullptr;
+    }
+    topo_len_ = 0;
+    built_ = false;
+    ensure_topo_sequences(MappingTables::led_count());
+  }
+
   void render(const EffectFrame& frame,
               const PixelsMap& /*map*/,
               Rgb* out_rgb,
@@ -141,11 +157,7 @@ class IndexWalkEffect final : public IEffect {
       out_rgb[i] = kBlack;
     }
 
-    if (!built_ || built_led_count_ != n) {
-      build_topo_sequences(n);
-      built_ = true;
-      built_led_count_ = n;
-    }
+    ensure_topo_sequences(n);  // no-op once built
 
     if (scan_mode_ == ScanMode::kVertexToward) {
       render_vertex_toward(frame, out_rgb, n);
@@ -185,9 +197,20 @@ class IndexWalkEffect final : public IEffect {
 
  private:
   static constexpr uint8_t kMaxLedsPerSegment = 14;
-  static constexpr uint16_t kMaxVertices = 32;
-  static constexpr uint8_t kMaxSegments = 40;
-  static constexpr uint8_t kMaxVertexDegree = 6;  // safe upper bound for this topology
+  static constexpr uint16_t kMaxVertices = MappingTables::vertex_count();
+  static constexpr uint8_t kMaxSegments = MappingTables::segment_count();
+  static constexpr uint8_t kMaxVertexDegree = 6;
+  static_assert(MappingTables::max_vertex_degree() <= kMaxVertexDegree, "raise kMaxVertexDegree for this topology");
+  static constexpr size_t kScratchBytes = 2U * scratch_block_bytes<uint16_t>(MappingTables::led_count());
+  static_assert(kScratchBytes <= kDefaultEffectScratchBytes, "raise kDefaultEffectScratchBytes");
+
+  void ensure_topo_sequences(uint16_t n) {
+    if (topo_seq_ltr_ != nullptr && (!built_ || built_led_count_ != n)) {
+      build_topo_sequences(n);
+      built_ = true;
+      built_led_count_ = n;
+    }
+  }
 
   static bool is_vertical(const uint16_t* idxs, uint8_t count) {
     if (idxs == nullptr || count == 0) return false;
@@ -264,11 +287,7 @@ class IndexWalkEffect final : public IEffect {
     const uint16_t n = built_ ? built_led_count_ : MappingTables::led_count();
     if (n == 0) return;
 
-    if (!built_ || built_led_count_ != n) {
-      build_topo_sequences(n);
-      built_ = true;
-      built_led_count_ = n;
-    }
+    ensure_topo_sequences(n);
 
     const bool was_manual = manual_hold_;
     manual_hold_ = true;
@@ -330,7 +349,7 @@ class IndexWalkEffect final : public IEffect {
     topo_len_ = 0;
 
     const uint8_t* segs = MappingTables::global_to_seg();
-    for (uint8_t seg_id = 1; seg_id <= 40; ++seg_id) {
+    for (uint16_t seg_id = 1; seg_id <= kMaxSegments; ++seg_id) {
       uint16_t idxs[kMaxLedsPerSegment];
       uint8_t count = 0;
 
@@ -372,8 +391,8 @@ class IndexWalkEffect final : public IEffect {
   bool built_ = false;
   uint16_t built_led_count_ = 0;
   uint16_t topo_len_ = 0;
-  uint16_t topo_seq_ltr_[MappingTables::led_count()] = {};
-  uint16_t topo_seq_rtl_[MappingTables::led_count()] = {};
+  uint16_t* topo_seq_ltr_ = nullptr;  // scratch, [led_count()]
+  uint16_t* topo_seq_rtl_ = nullptr;
 
   uint16_t active_index_ = 0;
   uint8_t active_seg_ = 0;
@@ -400,7 +419,7 @@ class IndexWalkEffect final : public IEffect {
 
   void build_vertex_adjacency(uint16_t led_count) {
     // Presence by segId (bench/full safe).
-    for (uint8_t s = 0; s <= kMaxSegments; ++s) seg_present_[s] = false;
+    for (uint16_t s = 0; s <= kMaxSegments; ++s) seg_present_[s] = false;
     const uint8_t* segs = MappingTables::global_to_seg();
     for (uint16_t i = 0; i < led_count; ++i) {
       const uint8_t seg = segs[i];
@@ -408,12 +427,12 @@ class IndexWalkEffect final : public IEffect {
     }
 
     const uint8_t vcount = MappingTables::vertex_count();
-    for (uint8_t v = 0; v < kMaxVertices; ++v) vertex_incident_count_[v] = 0;
+    for (uint16_t v = 0; v < kMaxVertices; ++v) vertex_incident_count_[v] = 0;
 
     const uint8_t* sva = MappingTables::seg_vertex_a();
     const uint8_t* svb = MappingTables::seg_vertex_b();
     const uint8_t scount = MappingTables::segment_count();
-    for (uint8_t seg_id = 1; seg_id <= scount && seg_id <= kMaxSegments; ++seg_id) {
+    for (uint16_t seg_id = 1; seg_id <= scount && seg_id <= kMaxSegments; ++seg_id) {
       if (!seg_present_[seg_id]) continue;
       const uint8_t va = sva[seg_id];
       const uint8_t vb = svb[seg_id];
@@ -421,14 +440,14 @@ class IndexWalkEffect final : public IEffect {
       if (va < kMaxVertices) {
         const uint8_t c = vertex_incident_count_[va];
         if (c < kMaxVertexDegree) {
-          vertex_incident_[va][c] = seg_id;
+          vertex_incident_[va][c] = static_cast<uint8_t>(seg_id);
           vertex_incident_count_[va] = static_cast<uint8_t>(c + 1U);
         }
       }
       if (vb < kMaxVertices) {
         const uint8_t c = vertex_incident_count_[vb];
         if (c < kMaxVertexDegree) {
-          vertex_incident_[vb][c] = seg_id;
+          vertex_incident_[vb][c] = static_cast<uint8_t>(seg_id);
           vertex_incident_count_[vb] = static_cast<uint8_t>(c + 1U);
         }
       }
@@ -26,7 +26,18 @@ class RainbowPulseEffect final : public IEffect {
               const PixelsMap& /*map*/,
               Rgb* out_rgb,
               size_t led_count) override {
-    if (out_rgb == nullptr || led_count == 0) {
+    paint(frame, out_rgb, led_count);
+  }
+
+  bool render_wire(const EffectFrame& frame, const PixelsMap& /*map*/, StripPixel* out, size_t led_count) override {
+    paint(frame, out, led_count);
+    return true;
+  }
+
+ private:
+  template <typename Pixel>
+  void paint(const EffectFrame& frame, Pixel* out, size_t led_count) const {
+    if (out == nullptr || led_count == 0) {
       return;
     }
 
@@ -48,11 +59,10 @@ class RainbowPulseEffect final : public IEffect {
                     static_cast<uint8_t>((static_cast<uint16_t>(base.b) * v) / 255U)};
 
     for (size_t i = 0; i < led_count; ++i) {
-      out_rgb[i] = color;
+      put_pixel(out[i], color);
     }
   }
 
- private:
   uint8_t compute_alpha(uint32_t t) const {
     if (fade_in_ms_ == 0 && fade_out_ms_ == 0) {
       return 255;
@@ -16,7 +16,7 @@ namespace core {
 // Behavior:
 // - Each strip has a fixed color:
 //   - strip0: red, strip1: blue, strip2: green, strip3: cyan
-// - Shows segment number k (1..12) on every strip simultaneously.
+// - Shows segment number k (1..kMaxStripSegments) on every strip simultaneously.
 //   - For strips with fewer than k segments, that strip remains black.
 // - Auto-advances k forever; serial 'n'/'N' advances k immediately.
 //
@@ -34,12 +34,12 @@ class StripSegmentStepperEffect final : public IEffect {
   }
 
   void next(uint32_t now_ms) {
-    segment_number_ = static_cast<uint8_t>((segment_number_ % 12U) + 1U);
+    segment_number_ = static_cast<uint8_t>((segment_number_ % kMaxStripSegments) + 1U);
     last_step_ms_ = now_ms;
   }
 
   void prev(uint32_t now_ms) {
-    segment_number_ = segment_number_ <= 1 ? 12 : static_cast<uint8_t>(segment_number_ - 1U);
+    segment_number_ = segment_number_ <= 1 ? kMaxStripSegments : static_cast<uint8_t>(segment_number_ - 1U);
     last_step_ms_ = now_ms;
   }
 
@@ -48,8 +48,14 @@ class StripSegmentStepperEffect final : public IEffect {
     last_step_ms_ = now_ms;
   }
 
+  // Holds each segment for step_ms; static while auto-advance is off.
+  uint32_t next_change_ms(uint32_t now_ms) const override {
+    if (!auto_advance_enabled_ || step_ms_ == 0) return now_ms + kNoChangeAheadMs;
+    return last_step_ms_ + step_ms_;
+  }
+
   bool auto_advance_enabled() const { return auto_advance_enabled_; }
-  uint8_t segment_number() const { return segment_number_; }  // 1..12
+  uint8_t segment_number() const { return segment_number_; }  // 1..kMaxStripSegments
 
   void render(const EffectFrame& frame,
               const PixelsMap& /*map*/,
@@ -61,7 +67,7 @@ class StripSegmentStepperEffect final : public IEffect {
     auto_advance(frame.now_ms);
 
     const uint8_t v = frame.params.brightness;
-    const Rgb colors[4] = {
+    const Rgb colors[4] = {  // repeats every 4 strips
         scale(Rgb{255, 0, 0}, v),    // strip0 red
         scale(Rgb{0, 0, 255}, v),    // strip1 blue
         scale(Rgb{0, 255, 0}, v),    // strip2 green
@@ -76,11 +82,10 @@ class StripSegmentStepperEffect final : public IEffect {
 
     for (uint16_t i = 0; i < led_count; ++i) {
       const uint8_t strip = strips[i];
-      if (strip >= 4) continue;
       const uint16_t local = locals[i];
       const uint16_t seg_in_strip = static_cast<uint16_t>(local / kLedsPerSeg);
       if (seg_in_strip == seg0) {
-        out_rgb[i] = colors[strip];
+        out_rgb[i] = colors[strip & 3U];
       }
     }
   }
@@ -96,7 +101,7 @@ class StripSegmentStepperEffect final : public IEffect {
     if (!auto_advance_enabled_ || step_ms_ == 0) return;
     while (static_cast<int32_t>(now_ms - last_step_ms_) >= static_cast<int32_t>(step_ms_)) {
       last_step_ms_ += step_ms_;
-      segment_number_ = static_cast<uint8_t>((segment_number_ % 12U) + 1U);
+      segment_number_ = static_cast<uint8_t>((segment_number_ % kMaxStripSegments) + 1U);
     }
   }
 
@@ -3,31 +3,56 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "../mapping/pixels_map.h"
 #include "effect.h"
+#include "effect_scratch.h"
 
 namespace chromance {
 namespace core {
 
+// Lights one LED at a time in raster (y, x) order. Uses the caller's scan order when given one; otherwise it
+// sorts its own into per-activation scratch on bind_scratch().
 class XyScanEffect final : public IEffect {
  public:
+  explicit XyScanEffect(uint16_t hold_ms = 25) : owns_order_(true), hold_ms_(hold_ms) {}
   XyScanEffect(const uint16_t* scan_order, size_t scan_len, uint16_t hold_ms = 25)
       : scan_order_(scan_order), scan_len_(scan_len), hold_ms_(hold_ms) {}
 
   const char* id() const override { return "XY_Scan_Test"; }
 
+  size_t scratch_bytes() const override {
+    return owns_order_ ? scratch_block_bytes<uint16_t>(MappingTables::led_count()) : 0;
+  }
+
+  void bind_scratch(const EffectScratch& scratch) override {
+    if (!owns_order_) {
+      return;
+    }
+    ScratchCarver carver(scratch);
+    uint16_t* order = carver.take<uint16_t>(MappingTables::led_count());
+    if (order != nullptr) {
+      PixelsMap().build_scan_order(order, MappingTables::led_count());
+    }
+    scan_order_ = order;
+    scan_len_ = order != nullptr ? MappingTables::led_count() : 0;
+  }
+
   void reset(uint32_t now_ms) override { start_ms_ = now_ms; }
 
   void render(const EffectFrame& frame,
               const PixelsMap& /*map*/,
               Rgb* out_rgb,
               size_t led_count) override {
-    if (out_rgb == nullptr || led_count == 0 || scan_order_ == nullptr || scan_len_ < led_count) {
+    if (out_rgb == nullptr || led_count == 0) {
       return;
     }
 
     for (size_t i = 0; i < led_count; ++i) {
       out_rgb[i] = kBlack;
     }
+    if (scan_order_ == nullptr || scan_len_ < led_count) {
+      return;
+    }
 
     const uint32_t elapsed = frame.now_ms - start_ms_;
     const uint32_t step = hold_ms_ ? (elapsed / hold_ms_) : elapsed;
@@ -40,6 +65,7 @@ class XyScanEffect final : public IEffect {
  private:
   const uint16_t* scan_order_ = nullptr;
   size_t scan_len_ = 0;
+  bool owns_order_ = false;  // scan_order_ points into scratch
   uint32_t start_ms_ = 0;
   uint16_t hold_ms_ = 25;
 };
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../settings/effect_config_store.h"
+#include "effect_id.h"
+#include "params.h"
+
+namespace chromance {
+namespace core {
+
+constexpr uint8_t kMaxPlaylistEntries = 8;
+constexpr uint8_t kMaxPlaylistParams = 4;
+
+// Per-entry transition that keeps EffectManager's configured crossfade.
+constexpr uint16_t kPlaylistDefaultTransition = 0xFFFF;
+
+// One param of an entry's snapshot, in raw firmware units (EffectManager::overlay_param_raw()).
+struct PlaylistParam {
+  uint16_t id;
+  uint16_t _reserved0;
+  int32_t raw;
+};
+
+struct PlaylistEntry {
+  uint16_t effect_id;
+  uint16_t duration_s;     // 0 = stay on this entry until next() / stop()
+  uint16_t transition_ms;  // crossfade into this entry, or kPlaylistDefaultTransition
+  uint8_t param_count;
+  uint8_t _reserved0;
+  PlaylistParam params[kMaxPlaylistParams];
+};
+
+// Persisted as one fixed-size blob (kPlaylistStoreKey); the layout is versioned so a firmware with a different
+// shape ignores it instead of misreading it.
+struct PlaylistConfig {
+  uint8_t version;
+  uint8_t count;
+  uint8_t flags;  // kPlaylistFlag*
+  uint8_t _reserved0;
+  PlaylistEntry entries[kMaxPlaylistEntries];
+};
+
+constexpr uint8_t kPlaylistConfigVersion = 1;
+constexpr uint8_t kPlaylistFlagRunning = 0x01;  // resume the show after a reboot
+constexpr const char* kPlaylistStoreKey = "plst";
+
+// Timed effect sequence on top of EffectManager. Each entry activates its effect with its param snapshot and
+// crossfade length, holds it for duration_s and moves on, looping at the end. Entries whose effect cannot be
+// activated (not in the catalog) are skipped.
+//
+// To keep boundaries hitch-free the next entry's effect is warmed ahead of time: prewarm() (called from the
+// same idle-time slot as EffectManager::prepare_next()) runs its prepare() once the boundary is kPrewarmLeadMs
+// away.
+//
+// Param snapshots are runtime overlays over the effect's stored config (EffectManager::overlay_param_raw()),
+// never persisted: the show does not touch flash or the user's own values, and two entries of the same effect
+// with different snapshots each start from the stored config. tick() releases an entry's overlay once its
+// effect has faded out, or once the show has stopped.
+//
+// The playlist and its running state persist through ISettingsStore with the same debounce / retry policy as
+// effect configs (call persist() every loop). Manager is any type with EffectManager's set_active(),
+// overlay_param_raw() / clear_overlay(), transitioning(), transition_ms() / set_transition_ms() and
+// prepare_effect().
+class PlaylistScheduler final {
+ public:
+  static constexpr uint32_t kPrewarmLeadMs = 2000;
+  static constexpr uint32_t kDebounceMs = 500;
+  static constexpr uint32_t kMaxBackoffMs = 4000;
+
+  PlaylistScheduler() { clear(); }
+
+  static bool valid(const PlaylistConfig& c) {
+    if (c.version != kPlaylistConfigVersion || c.count > kMaxPlaylistEntries) {
+      return false;
+    }
+    for (uint8_t i = 0; i < c.count; ++i) {
+      const PlaylistEntry& e = c.entries[i];
+      if (e.effect_id == 0 || e.param_count > kMaxPlaylistParams) {
+        return false;
+      }
+      for (uint8_t p = 0; p < e.param_count; ++p) {
+        if (e.params[p].id == 0) return false;
+      }
+    }
+    return true;
+  }
+
+  // Loads the persisted playlist. Returns true when it was marked running (the caller then calls start()).
+  bool load(const ISettingsStore& store) {
+    PlaylistConfig c;
+    if (!store.read_blob(kPlaylistStoreKey, &c, sizeof(c)) || !valid(c)) {
+      return false;
+    }
+    config_ = c;
+    running_ = false;
+    return (config_.flags & kPlaylistFlagRunning) != 0 && config_.count > 0;
+  }
+
+  // Replaces the entries (stops the show). False and unchanged if c is invalid.
+  bool set_config(const PlaylistConfig& c, uint32_t now_ms) {
+    if (!valid(c)) {
+      return false;
+    }
+    config_ = c;
+    config_.flags = 0;
+    running_ = false;
+    mark_dirty(now_ms);
+    return true;
+  }
+
+  const PlaylistConfig& config() const { return config_; }
+  bool running() const { return running_; }
+  uint8_t index() const { return index_; }
+
+  // Time left on the current entry (0 when stopped; 0xFFFFFFFF for an entry without duration).
+  uint32_t remaining_ms(uint32_t now_ms) const {
+    if (!running_) return 0;
+    if (!timed_) return 0xFFFFFFFFU;
+    return reached(now_ms, entry_end_ms_) ? 0 : entry_end_ms_ - now_ms;
+  }
+
+  template <class Manager>
+  bool start(uint32_t now_ms, Manager& manager, uint8_t index = 0) {
+    if (config_.count == 0) {
+      return false;
+    }
+    if (!enter_first_playable(now_ms, manager, static_cast<uint8_t>(index % config_.count))) {
+      stop(now_ms);
+      return false;
+    }
+    if ((config_.flags & kPlaylistFlagRunning) == 0) {
+      config_.flags |= kPlaylistFlagRunning;
+      mark_dirty(now_ms);
+    }
+    return true;
+  }
+
+  // Manual override (effect picked by hand, playlist edited): the show stops and stays stopped after reboot.
+  void stop(uint32_t now_ms) {
+    running_ = false;
+    if (config_.flags & kPlaylistFlagRunning) {
+      config_.flags = static_cast<uint8_t>(config_.flags & ~kPlaylistFlagRunning);
+      mark_dirty(now_ms);
+    }
+  }
+
+  template <class Manager>
+  bool next(uint32_t now_ms, Manager& manager) {
+    if (!running_) {
+      return false;
+    }
+    if (!enter_first_playable(now_ms, manager, static_cast<uint8_t>((index_ + 1U) % config_.count))) {
+      stop(now_ms);
+      return false;
+    }
+    return true;
+  }
+
+  // Advances at entry boundaries and releases overlays no longer shown. Call every loop iteration, before
+  // rendering.
+  template <class Manager>
+  void tick(uint32_t now_ms, Manager& manager) {
+    release_overlays(manager);
+    if (running_ && timed_ && reached(now_ms, entry_end_ms_)) {
+      // Late by a loop iteration or two: the next entry still starts at the nominal boundary so a long show
+      // does not drift.
+      const uint32_t boundary = entry_end_ms_;
+      if (next(now_ms, manager) && timed_ && static_cast<int32_t>(now_ms - boundary) < 1000) {
+        entry_end_ms_ = boundary + static_cast<uint32_t>(config_.entries[index_].duration_s) * 1000U;
+      }
+    }
+  }
+
+  // Warms the next entry's effect when its boundary is near. Returns true when it ran a prepare().
+  template <class Manager>
+  bool prewarm(uint32_t now_ms, Manager& manager) {
+    if (!running_ || !timed_ || prewarmed_ || config_.count < 2 ||
+        !reached(now_ms + kPrewarmLeadMs, entry_end_ms_)) {
+      return false;
+    }
+    prewarmed_ = true;
+    const PlaylistEntry& e = config_.entries[(index_ + 1U) % config_.count];
+    return manager.prepare_effect(EffectId{e.effect_id}, now_ms);
+  }
+
+  // Writes the playlist when it changed (debounced, retried with backoff on failure).
+  void persist(uint32_t now_ms, ISettingsStore& store, bool force = false) {
+    if (!dirty_ || (!force && !reached(now_ms, next_write_due_ms_))) {
+      return;
+    }
+    if (store.write_blob(kPlaylistStoreKey, &config_, sizeof(config_))) {
+      dirty_ = false;
+      backoff_ms_ = 0;
+      return;
+    }
+    const uint32_t next = backoff_ms_ == 0 ? kDebounceMs : backoff_ms_ * 2U;
+    backoff_ms_ = next > kMaxBackoffMs ? kMaxBackoffMs : next;
+    next_write_due_ms_ = now_ms + backoff_ms_;
+  }
+
+  bool dirty() const { return dirty_; }
+
+ private:
+  static bool reached(uint32_t now_ms, uint32_t target_ms) { return static_cast<int32_t>(now_ms - target_ms) >= 0; }
+
+  void clear() {
+    memset(&config_, 0, sizeof(config_));
+    config_.version = kPlaylistConfigVersion;
+  }
+
+  void mark_dirty(uint32_t now_ms) {
+    dirty_ = true;
+    backoff_ms_ = 0;
+    next_write_due_ms_ = now_ms + kDebounceMs;
+  }
+
+  template <class Manager>
+  bool enter_first_playable(uint32_t now_ms, Manager& manager, uint8_t from) {
+    for (uint8_t k = 0; k < config_.count; ++k) {
+      const uint8_t i = static_cast<uint8_t>((from + k) % config_.count);
+      if (enter(now_ms, manager, i)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Clears the overlay of an effect that has faded out, and the current entry's once the show stopped. Both
+  // wait for a running fade so the outgoing effect does not change look halfway through it.
+  template <class Manager>
+  void release_overlays(Manager& manager) {
+    if (manager.transitioning()) {
+      return;
+    }
+    if (released_id_ != 0) {
+      (void)manager.clear_overlay(EffectId{released_id_});
+      released_id_ = 0;
+    }
+    if (!running_ && overlay_id_ != 0) {
+      (void)manager.clear_overlay(EffectId{overlay_id_});
+      overlay_id_ = 0;
+    }
+  }
+
+  template <class Manager>
+  bool enter(uint32_t now_ms, Manager& manager, uint8_t i) {
+    const PlaylistEntry& e = config_.entries[i];
+    const EffectId id{e.effect_id};
+    // Overlay first so the effect starts (and its first frame renders) with the snapshot already bound. It
+    // starts over from the stored config, not from a previous entry's snapshot of the same effect.
+    (void)manager.clear_overlay(id);
+    if (released_id_ == e.effect_id) {
+      released_id_ = 0;
+    }
+    for (uint8_t p = 0; p < e.param_count; ++p) {
+      (void)manager.overlay_param_raw(id, ParamId(e.params[p].id), e.params[p].raw);
+    }
+    const uint16_t saved_transition = manager.transition_ms();
+    if (e.transition_ms != kPlaylistDefaultTransition) {
+      manager.set_transition_ms(e.transition_ms);
+    }
+    const bool ok = manager.set_active(id, now_ms);
+    manager.set_transition_ms(saved_transition);
+    if (!ok) {
+      (void)manager.clear_overlay(id);
+      return false;
+    }
+    if (overlay_id_ != 0 && overlay_id_ != e.effect_id) {
+      // A switch during a fade drops the effect that was fading out, so its overlay can go now.
+      if (released_id_ != 0) {
+        (void)manager.clear_overlay(EffectId{released_id_});
+      }
+      released_id_ = overlay_id_;  // fading out: released by tick() once the fade is over
+    }
+    overlay_id_ = e.param_count > 0 ? e.effect_id : 0;
+    running_ = true;
+    index_ = i;
+    timed_ = e.duration_s > 0;
+    entry_end_ms_ = now_ms + static_cast<uint32_t>(e.duration_s) * 1000U;
+    prewarmed_ = false;
+    return true;
+  }
+
+  PlaylistConfig config_;
+  bool running_ = false;
+  uint8_t index_ = 0;
+  bool timed_ = false;
+  uint32_t entry_end_ms_ = 0;
+  bool prewarmed_ = false;
+  uint16_t overlay_id_ = 0;   // effect carrying the current entry's snapshot (0 = none)
+  uint16_t released_id_ = 0;  // previous entry's effect, overlay released once its fade is over
+
+  bool dirty_ = false;
+  uint32_t next_write_due_ms_ = 0;
+  uint32_t backoff_ms_ = 0;
+};
+
+}  // namespace core
+}  // namespace chromance
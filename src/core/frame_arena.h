@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace chromance {
+namespace core {
+
+// Fixed-capacity bump allocator over inline storage. Owners embed one in a statically allocated object, carve
+// buffers out of it at init time and reset() it as a whole; nothing is ever freed individually and nothing
+// touches the heap.
+template <size_t Bytes>
+class FrameArena final {
+ public:
+  // Returns count Ts aligned for T, or nullptr when the arena is exhausted. Memory is not initialized.
+  template <typename T>
+  T* alloc(size_t count) {
+    const size_t align = alignof(T);
+    const size_t start = (used_ + (align - 1U)) & ~(align - 1U);
+    if (count > (Bytes - (start < Bytes ? start : Bytes)) / sizeof(T)) {
+      return nullptr;
+    }
+    used_ = start + count * sizeof(T);
+    return reinterpret_cast<T*>(storage_ + start);
+  }
+
+  void reset() { used_ = 0; }
+
+  size_t used() const { return used_; }
+  static constexpr size_t capacity() { return Bytes; }
+
+ private:
+  alignas(8) uint8_t storage_[Bytes] = {};
+  size_t used_ = 0;
+};
+
+}  // namespace core
+}  // namespace chromance
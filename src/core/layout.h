@@ -2,25 +2,40 @@
 
 #include <stdint.h>
 
+#include "apa102.h"
+#include "mapping/mapping_tables.h"
 #include "types.h"
 
 namespace chromance {
 namespace core {
 
-constexpr uint8_t kStripCount = 4;
-constexpr uint16_t kTotalSegments = 40;
+// Strip, segment and LED counts come from the generated mapping header (mapping/wiring*.json), so larger
+// installations only need a new wiring file.
+constexpr uint8_t kStripCount = MappingTables::strip_count();
 constexpr uint8_t kLedsPerSegment = 14;
+constexpr uint16_t kTotalLeds = MappingTables::led_count();
+constexpr uint16_t kTotalSegments = kTotalLeds / kLedsPerSegment;  // wired segments (a subset on bench builds)
 constexpr uint8_t kDiagnosticBrightness = 64;
+constexpr uint8_t kUnassignedPin = 0xFF;
+
+static_assert(kLedsPerSegment == MappingTables::leds_per_segment(), "mapping header uses a different segment length");
+static_assert(kStripCount > 0, "wiring must define at least one strip");
+
+// The strips' DotStars take colour bytes blue, red, green. Wire frames (IEffect::render_wire, ILedOutput::
+// show_wire) hold this pixel type, at full global brightness: effects scale colours themselves.
+constexpr ColorOrder kStripColorOrder = ColorOrder::kBrg;
+using StripPixel = Apa102Pixel<kStripColorOrder>;
+static_assert(sizeof(StripPixel) == 4 && alignof(StripPixel) == 4, "wire frames are arrays of 32-bit LED frames");
 
 struct StripConfig {
   uint8_t segment_count;
   bool reversed;
-  uint8_t data_pin;
+  uint8_t data_pin;   // kUnassignedPin if the wiring file gives no pins
   uint8_t clock_pin;
   Rgb diagnostic_color;
 };
 
-// Diagnostic colors (per strip index). Physical strip labels are 1-based:
+// Diagnostic colors (per strip index, repeating every 4 strips). Physical strip labels are 1-based:
 // - strip index 0 = "Strip 1"
 // - strip index 1 = "Strip 2"
 // - strip index 2 = "Strip 3"
@@ -30,46 +45,43 @@ constexpr Rgb kDiagnosticColorGreen{0, 255, 0};
 constexpr Rgb kDiagnosticColorBlue{0, 0, 255};
 constexpr Rgb kDiagnosticColorMagenta{255, 0, 255};
 
-constexpr Rgb kStrip0DiagnosticColor = kDiagnosticColorRed;          // Red
-constexpr Rgb kStrip1DiagnosticColor = kDiagnosticColorGreen;        // Green
-constexpr Rgb kStrip2DiagnosticColor = kDiagnosticColorBlue;         // Blue
-constexpr Rgb kStrip3DiagnosticColor = kDiagnosticColorMagenta;      // Magenta
+constexpr Rgb diagnostic_color(uint8_t strip_index) {
+  return (strip_index & 3U) == 0   ? kDiagnosticColorRed
+         : (strip_index & 3U) == 1 ? kDiagnosticColorGreen
+         : (strip_index & 3U) == 2 ? kDiagnosticColorBlue
+                                   : kDiagnosticColorMagenta;
+}
 
-constexpr uint8_t kStrip0Segments = 11;
-constexpr uint8_t kStrip1Segments = 12;
-constexpr uint8_t kStrip2Segments = 6;
-constexpr uint8_t kStrip3Segments = 11;
+// Strip 1..4 of the canonical panel are wired DATA/CLOCK on GPIO23/22, 17/16, 33/27 and 14/32
+// (see mapping/wiring.json). Read from the active mapping tables, so a mapping blob can rewire strips and pins.
+// strip_index must be < kStripCount.
+inline StripConfig strip_config(uint8_t strip_index) {
+  return StripConfig{MappingTables::strip_segment_count()[strip_index], false,
+                     MappingTables::strip_data_pin()[strip_index], MappingTables::strip_clock_pin()[strip_index],
+                     diagnostic_color(strip_index)};
+}
 
-constexpr uint16_t kStrip0Leds = static_cast<uint16_t>(kStrip0Segments) * kLedsPerSegment;
-constexpr uint16_t kStrip1Leds = static_cast<uint16_t>(kStrip1Segments) * kLedsPerSegment;
-constexpr uint16_t kStrip2Leds = static_cast<uint16_t>(kStrip2Segments) * kLedsPerSegment;
-constexpr uint16_t kStrip3Leds = static_cast<uint16_t>(kStrip3Segments) * kLedsPerSegment;
-constexpr uint16_t kTotalLeds = static_cast<uint16_t>(kTotalSegments) * kLedsPerSegment;
+// Compile-time strip totals, from the build's own tables (a mapping blob may move segments between strips but
+// not past kMaxStripSegments on any one; see MappingBlob::compatible()).
+constexpr uint16_t wired_segment_count(uint8_t first_strip = 0) {
+  return first_strip >= kStripCount
+             ? 0
+             : static_cast<uint16_t>(MappingTables::compiled().strip_segment_count[first_strip] +
+                                     wired_segment_count(static_cast<uint8_t>(first_strip + 1U)));
+}
 
-static_assert(kStrip0Segments > 0, "strip 0 must have >0 segments");
-static_assert(kStrip1Segments > 0, "strip 1 must have >0 segments");
-static_assert(kStrip2Segments > 0, "strip 2 must have >0 segments");
-static_assert(kStrip3Segments > 0, "strip 3 must have >0 segments");
-static_assert(kStrip0Segments + kStrip1Segments + kStrip2Segments + kStrip3Segments ==
-                  kTotalSegments,
-              "segment counts must sum to kTotalSegments");
-static_assert(kStrip0Leds == 154, "strip 0 LED count mismatch");
-static_assert(kStrip1Leds == 168, "strip 1 LED count mismatch");
-static_assert(kStrip2Leds == 84, "strip 2 LED count mismatch");
-static_assert(kStrip3Leds == 154, "strip 3 LED count mismatch");
-static_assert(kTotalLeds == 560, "total LED count mismatch");
+constexpr uint8_t longest_strip_segment_count(uint8_t first_strip = 0) {
+  return first_strip >= kStripCount ? 0
+         : MappingTables::compiled().strip_segment_count[first_strip] >
+                 longest_strip_segment_count(static_cast<uint8_t>(first_strip + 1U))
+             ? MappingTables::compiled().strip_segment_count[first_strip]
+             : longest_strip_segment_count(static_cast<uint8_t>(first_strip + 1U));
+}
 
-constexpr StripConfig kStripConfigs[kStripCount] = {
-    // Pin assignment (DATA, CLOCK):
-    // Strip 1: GPIO23, GPIO22
-    // Strip 2: GPIO17, GPIO16
-    // Strip 3: GPIO33, GPIO27
-    // Strip 4: GPIO14, GPIO32
-    {kStrip0Segments, false, 23, 22, kStrip0DiagnosticColor},
-    {kStrip1Segments, false, 17, 16, kStrip1DiagnosticColor},
-    {kStrip2Segments, false, 33, 27, kStrip2DiagnosticColor},
-    {kStrip3Segments, false, 14, 32, kStrip3DiagnosticColor},
-};
+constexpr uint8_t kMaxStripSegments = longest_strip_segment_count();
+
+static_assert(wired_segment_count() == kTotalSegments, "strip segment counts must sum to the mapped segments");
+static_assert(kTotalSegments * kLedsPerSegment == kTotalLeds, "LED count must be whole segments");
 
 }  // namespace core
 }  // namespace chromance
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "mapping_tables.h"
+#include "pixels_map.h"
+
+namespace chromance {
+namespace core {
+
+// One wired segment's worth of global LEDs, unpacked from the generator's per-run word
+// (MappingTables::segment_runs()):
+//   bits  0..7   segment id (1-based)
+//   bits  8..14  strip index
+//   bit  15      wiring direction, as global_to_dir() (0 = a_to_b, 1 = b_to_a)
+//   bits 16..31  strip-local index of the run's first LED (its segment's first LED on the strip)
+struct SegmentRun {
+  uint32_t bits;
+
+  constexpr uint8_t segment() const { return static_cast<uint8_t>(bits); }
+  constexpr uint8_t strip() const { return static_cast<uint8_t>((bits >> 8) & 0x7FU); }
+  constexpr uint8_t dir() const { return static_cast<uint8_t>((bits >> 15) & 0x1U); }
+  constexpr uint16_t local_base() const { return static_cast<uint16_t>(bits >> 16); }
+};
+
+// The flat per-LED tables (pixel_x/_y, global_to_strip/_local/_seg/_seg_k/_dir: 10 bytes per LED), decoded on
+// the fly from 4 bytes per segment. Global LED i is position i % kLedsPerSegment of run i / kLedsPerSegment, and
+// within a run everything is affine in that position (counted from the segment's entry end, or from vertex A in
+// wire-order layouts): coordinates interpolate between the segment's vertices
+// with the generator's own rounding. Every accessor returns exactly what the flat table holds; the generator
+// refuses to write a header where the two would differ.
+//
+// A lookup costs a few multiplies instead of one load, against 4 bytes per segment instead of 10 per LED in cache
+// (tools/mapping_bench). The flat tables stay in flash as the compiled fallback for a mapping blob.
+class CompactMapping final {
+ public:
+  static constexpr uint8_t kLedsPerSegment = MappingTables::leds_per_segment();
+
+  static SegmentRun run(uint16_t run_index) { return SegmentRun{MappingTables::segment_runs()[run_index]}; }
+  static SegmentRun run_of(uint16_t led_index) { return run(static_cast<uint16_t>(led_index / kLedsPerSegment)); }
+
+  static uint8_t segment(uint16_t led_index) { return run_of(led_index).segment(); }
+  static uint8_t seg_k(uint16_t led_index) {
+    const uint8_t k = static_cast<uint8_t>(led_index % kLedsPerSegment);
+    return MappingTables::wire_order() && run_of(led_index).dir() ? static_cast<uint8_t>(kLedsPerSegment - 1U - k)
+                                                                  : k;
+  }
+  static uint8_t dir(uint16_t led_index) { return run_of(led_index).dir(); }
+  static uint8_t strip(uint16_t led_index) { return run_of(led_index).strip(); }
+
+  static uint16_t local(uint16_t led_index) {
+    const SegmentRun r = run_of(led_index);
+    return static_cast<uint16_t>(r.local_base() + pos_from_a(r, run_pos(led_index)));
+  }
+
+  static PixelCoord coord(uint16_t led_index) { return run_coord(run_of(led_index), run_pos(led_index)); }
+
+  // Position k (counted from the run's first global LED) of run r.
+  static PixelCoord run_coord(SegmentRun r, uint8_t k) {
+    const uint8_t a = MappingTables::seg_vertex_a()[r.segment()];
+    const uint8_t b = MappingTables::seg_vertex_b()[r.segment()];
+    return coord_between(a, b, pos_from_a(r, k));
+  }
+
+  // All kLedsPerSegment coordinates of one run, in global LED order; looks the segment's vertices up once.
+  static void run_coords(uint16_t run_index, PixelCoord* out) {
+    const SegmentRun r = run(run_index);
+    const uint8_t a = MappingTables::seg_vertex_a()[r.segment()];
+    const uint8_t b = MappingTables::seg_vertex_b()[r.segment()];
+    for (uint8_t k = 0; k < kLedsPerSegment; ++k) {
+      out[k] = coord_between(a, b, pos_from_a(r, k));
+    }
+  }
+
+ private:
+  static uint8_t run_pos(uint16_t led_index) { return static_cast<uint8_t>(led_index % kLedsPerSegment); }
+
+  // Position along the segment counted from vertex A, as LedAttr::pos_from_a(). Strip-local order always runs
+  // from A, so in wire-order layouts that is the position in the run.
+  static uint8_t pos_from_a(SegmentRun r, uint8_t k) {
+    return r.dir() && !MappingTables::wire_order() ? static_cast<uint8_t>(kLedsPerSegment - 1U - k) : k;
+  }
+
+  static PixelCoord coord_between(uint8_t vertex_a, uint8_t vertex_b, uint8_t pos) {
+    return PixelCoord{axis(MappingTables::vertex_vx()[vertex_a], MappingTables::vertex_vx()[vertex_b],
+                           MappingTables::raster_scale_x(), MappingTables::raster_origin_x(), pos),
+                      axis(MappingTables::vertex_vy()[vertex_a], MappingTables::vertex_vy()[vertex_b],
+                           MappingTables::raster_scale_y(), MappingTables::raster_origin_y(), pos)};
+  }
+
+  // Raster coordinate of sample pos between vertex coordinates a and b: a + (pos + 0.5) / kLedsPerSegment of the
+  // way to b, rounded half away from zero, as the generator's sample_segment_pixels().
+  static int16_t axis(int8_t a, int8_t b, int16_t scale, int16_t origin, uint8_t pos) {
+    const int32_t den = 2 * kLedsPerSegment;
+    const int32_t ra = static_cast<int32_t>(a) * scale;
+    const int32_t num = den * ra + (2 * static_cast<int32_t>(pos) + 1) * (static_cast<int32_t>(b) * scale - ra);
+    const int32_t v = num >= 0 ? (2 * num + den) / (2 * den) : -((-2 * num + den) / (2 * den));
+    return static_cast<int16_t>(v - origin);
+  }
+};
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "mapping_tables.h"
+
+namespace chromance {
+namespace core {
+
+// One LED's topology, unpacked from the generator's per-LED word (MappingTables::led_attrs(), constexpr so it
+// stays in flash). A single 32-bit load per LED replaces indexing global_to_seg / _seg_k / _dir / _strip
+// separately, and adds the two things effects otherwise derive themselves:
+//   bits  0..7   segment id (1-based)
+//   bits  8..15  position along the segment counted from vertex A (0..kLedsPerSegment-1), whatever the wiring
+//   bits 16..23  nearest vertex id (the segment end the LED sits closer to)
+//   bits 24..30  strip index
+//   bit  31      wiring direction, as global_to_dir() (0 = a_to_b, 1 = b_to_a)
+struct LedAttr {
+  uint32_t bits;
+
+  constexpr uint8_t segment() const { return static_cast<uint8_t>(bits); }
+  constexpr uint8_t pos_from_a() const { return static_cast<uint8_t>(bits >> 8); }
+  constexpr uint8_t nearest_vertex() const { return static_cast<uint8_t>(bits >> 16); }
+  constexpr uint8_t strip() const { return static_cast<uint8_t>((bits >> 24) & 0x7FU); }
+  constexpr uint8_t dir() const { return static_cast<uint8_t>(bits >> 31); }
+};
+
+inline LedAttr led_attr(uint16_t led_index) { return LedAttr{MappingTables::led_attrs()[led_index]}; }
+
+}  // namespace core
+}  // namespace chromance
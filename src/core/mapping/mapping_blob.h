@@ -0,0 +1,320 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../layout.h"
+#include "mapping_tables.h"
+
+namespace chromance {
+namespace core {
+
+// Mapping blob: a generated mapping's tables as one flash image (generate_ledmap.py --out-blob), loaded at boot
+// from the "mapping" partition so rewiring a wall is a partition write instead of a rebuild and OTA. The
+// firmware reads the tables in place (memory-mapped flash, no copy), so they are stored in the CPU's own
+// little-endian layout, each 4-byte aligned.
+//
+//   0  "CHMP"
+//   4  u16 version (kVersion)
+//   6  u16 table_count (kTableCount)
+//   8  u32 total_size
+//   12 u32 checksum          FNV-1a of bytes [16, total_size)
+//   16 u16 led_count
+//   18 u16 width
+//   20 u16 height
+//   22 u16 run_count
+//   24 u8  leds_per_segment
+//   25 u8  segment_count
+//   26 u8  vertex_count
+//   27 u8  max_vertex_degree
+//   28 u8  strip_count
+//   29 u8  flags             bit 0: bench subset, bit 1: wire order
+//   30 i16 raster_scale_x, raster_scale_y, raster_origin_x, raster_origin_y
+//   38 u16 reserved (0)
+//   40 char mapping_version[32], NUL terminated
+//   72 table_count x u32 offset, in MappingBlob::Table order
+//   .. tables: element type as in MappingTableSet, count from the shape above
+namespace mapping_blob {
+
+constexpr uint16_t kVersion = 1;
+constexpr size_t kHeaderBytes = 72;
+constexpr size_t kVersionBytes = 32;
+constexpr uint8_t kFlagBenchSubset = 0x01;
+constexpr uint8_t kFlagWireOrder = 0x02;
+
+inline uint16_t rd16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+inline uint32_t rd32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+inline void wr16(uint8_t* p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+inline void wr32(uint8_t* p, uint32_t v) {
+  wr16(p, static_cast<uint16_t>(v));
+  wr16(p + 2, static_cast<uint16_t>(v >> 16));
+}
+
+inline uint32_t fnv1a(const uint8_t* p, size_t len) {
+  uint32_t h = 2166136261U;
+  for (size_t i = 0; i < len; ++i) {
+    h = (h ^ p[i]) * 16777619U;
+  }
+  return h;
+}
+
+}  // namespace mapping_blob
+
+// Validated view of a mapping blob. open() checks the format, the checksum and that every index in the tables
+// stays inside the blob's own counts; compatible() checks the shape against this build, which is what
+// MappingTables::install() needs, since counts size buffers throughout core.
+class MappingBlob final {
+ public:
+  enum class Table : uint8_t {
+    kPixelX,
+    kPixelY,
+    kGlobalToStrip,
+    kGlobalToLocal,
+    kGlobalToSeg,
+    kGlobalToSegK,
+    kGlobalToDir,
+    kLedAttrs,
+    kVertexVx,
+    kVertexVy,
+    kSegVertexA,
+    kSegVertexB,
+    kStripSegmentCount,
+    kStripDataPin,
+    kStripClockPin,
+    kSegmentRuns,
+    kCount
+  };
+  static constexpr uint16_t kTableCount = static_cast<uint16_t>(Table::kCount);
+
+  // Bytes of table t (unpadded) for a mapping of the given counts.
+  static constexpr size_t table_bytes(Table t, uint16_t leds, uint8_t segments, uint8_t vertices, uint8_t strips,
+                                      uint16_t runs) {
+    return t <= Table::kPixelY || t == Table::kGlobalToLocal ? 2U * leds
+           : t == Table::kLedAttrs                         ? 4U * leds
+           : t <= Table::kGlobalToDir                      ? leds
+           : t <= Table::kVertexVy                         ? vertices
+           : t <= Table::kSegVertexB                       ? segments + 1U
+           : t <= Table::kStripClockPin                    ? strips
+                                                           : 4U * runs;
+  }
+
+  // Size of the blob for this build's shape (what encode() writes).
+  static constexpr size_t build_bytes(uint8_t first = 0) {
+    return first == kTableCount
+               ? mapping_blob::kHeaderBytes + 4U * kTableCount
+               : round4(table_bytes(static_cast<Table>(first), MappingTables::led_count(),
+                                    MappingTables::segment_count(), MappingTables::vertex_count(),
+                                    MappingTables::strip_count(), MappingTables::run_count())) +
+                     build_bytes(static_cast<uint8_t>(first + 1U));
+  }
+
+  bool open(const uint8_t* data, size_t size) {
+    data_ = nullptr;
+    const uint16_t probe = 1;
+    if (data == nullptr || size < mapping_blob::kHeaderBytes + 4U * kTableCount || memcmp(data, "CHMP", 4) != 0 ||
+        mapping_blob::rd16(data + 4) != mapping_blob::kVersion || mapping_blob::rd16(data + 6) != kTableCount ||
+        (reinterpret_cast<uintptr_t>(data) & 3U) != 0 || *reinterpret_cast<const uint8_t*>(&probe) != 1) {
+      return false;  // tables are read in place: 4-byte aligned and little-endian
+    }
+    const uint32_t total = mapping_blob::rd32(data + 8);
+    if (total > size || total < mapping_blob::kHeaderBytes + 4U * kTableCount ||
+        mapping_blob::fnv1a(data + 16, total - 16U) != mapping_blob::rd32(data + 12)) {
+      return false;
+    }
+    const uint16_t leds = mapping_blob::rd16(data + 16);
+    const uint16_t runs = mapping_blob::rd16(data + 22);
+    const uint8_t per_segment = data[24];
+    const uint8_t segments = data[25];
+    const uint8_t vertices = data[26];
+    const uint8_t strips = data[28];
+    if (per_segment == 0 || leds == 0 || runs * per_segment != leds || segments == 0 || segments == 0xFF ||
+        vertices == 0 || vertices == 0xFF || strips == 0 || strips > 127 ||
+        memchr(data + 40, 0, mapping_blob::kVersionBytes) == nullptr) {
+      return false;
+    }
+    for (uint8_t t = 0; t < kTableCount; ++t) {
+      const uint32_t at = mapping_blob::rd32(data + mapping_blob::kHeaderBytes + 4U * t);
+      if ((at & 3U) != 0 || at < mapping_blob::kHeaderBytes + 4U * kTableCount || at > total ||
+          total - at < table_bytes(static_cast<Table>(t), leds, segments, vertices, strips, runs)) {
+        return false;
+      }
+    }
+    data_ = data;
+    if (!indices_in_range()) {
+      data_ = nullptr;
+      return false;
+    }
+    return true;
+  }
+
+  bool valid() const { return data_ != nullptr; }
+  size_t size() const { return data_ ? mapping_blob::rd32(data_ + 8) : 0; }
+  uint16_t led_count() const { return data_ ? mapping_blob::rd16(data_ + 16) : 0; }
+  uint16_t width() const { return data_ ? mapping_blob::rd16(data_ + 18) : 0; }
+  uint16_t height() const { return data_ ? mapping_blob::rd16(data_ + 20) : 0; }
+  uint16_t run_count() const { return data_ ? mapping_blob::rd16(data_ + 22) : 0; }
+  uint8_t leds_per_segment() const { return data_ ? data_[24] : 0; }
+  uint8_t segment_count() const { return data_ ? data_[25] : 0; }
+  uint8_t vertex_count() const { return data_ ? data_[26] : 0; }
+  uint8_t max_vertex_degree() const { return data_ ? data_[27] : 0; }
+  uint8_t strip_count() const { return data_ ? data_[28] : 0; }
+  bool is_bench_subset() const { return data_ && (data_[29] & mapping_blob::kFlagBenchSubset) != 0; }
+  bool wire_order() const { return data_ && (data_[29] & mapping_blob::kFlagWireOrder) != 0; }
+  const char* mapping_version() const { return data_ ? reinterpret_cast<const char*>(data_ + 40) : ""; }
+
+  // Same shape as this build: every count, the raster projection, the global numbering (wire order or not), and
+  // no strip longer than the build's longest (strip buffers and the segment stepper are sized from it). Node
+  // builds keep their compiled partition.
+  bool compatible() const {
+    if (data_ == nullptr || MappingTables::node_count() != 1 || led_count() != MappingTables::led_count() ||
+        width() != MappingTables::width() || height() != MappingTables::height() ||
+        run_count() != MappingTables::run_count() || leds_per_segment() != MappingTables::leds_per_segment() ||
+        segment_count() != MappingTables::segment_count() || vertex_count() != MappingTables::vertex_count() ||
+        max_vertex_degree() != MappingTables::max_vertex_degree() || strip_count() != MappingTables::strip_count() ||
+        wire_order() != MappingTables::wire_order() ||
+        static_cast<int16_t>(mapping_blob::rd16(data_ + 30)) != MappingTables::raster_scale_x() ||
+        static_cast<int16_t>(mapping_blob::rd16(data_ + 32)) != MappingTables::raster_scale_y() ||
+        static_cast<int16_t>(mapping_blob::rd16(data_ + 34)) != MappingTables::raster_origin_x() ||
+        static_cast<int16_t>(mapping_blob::rd16(data_ + 36)) != MappingTables::raster_origin_y()) {
+      return false;
+    }
+    const uint8_t* per_strip = table<uint8_t>(Table::kStripSegmentCount);
+    for (uint8_t s = 0; s < strip_count(); ++s) {
+      if (per_strip[s] > kMaxStripSegments) return false;
+    }
+    return true;
+  }
+
+  // The blob's tables, pointing into the blob (which must stay mapped while they are installed).
+  MappingTableSet tables() const {
+    return MappingTableSet{mapping_version(),
+                           is_bench_subset(),
+                           table<int16_t>(Table::kPixelX),
+                           table<int16_t>(Table::kPixelY),
+                           table<uint8_t>(Table::kGlobalToStrip),
+                           table<uint16_t>(Table::kGlobalToLocal),
+                           table<uint8_t>(Table::kGlobalToSeg),
+                           table<uint8_t>(Table::kGlobalToSegK),
+                           table<uint8_t>(Table::kGlobalToDir),
+                           table<uint32_t>(Table::kLedAttrs),
+                           table<int8_t>(Table::kVertexVx),
+                           table<int8_t>(Table::kVertexVy),
+                           table<uint8_t>(Table::kSegVertexA),
+                           table<uint8_t>(Table::kSegVertexB),
+                           table<uint8_t>(Table::kStripSegmentCount),
+                           table<uint8_t>(Table::kStripDataPin),
+                           table<uint8_t>(Table::kStripClockPin),
+                           table<uint32_t>(Table::kSegmentRuns)};
+  }
+
+  // Writes this build's shape with tables t into out (build_bytes(), 4-byte aligned). Returns the size, or 0 if
+  // out is too small. The generator writes device blobs; this serves host tools and tests.
+  static size_t encode(const MappingTableSet& t, uint8_t* out, size_t capacity) {
+    const size_t total = build_bytes();
+    if (out == nullptr || capacity < total || t.mapping_version == nullptr ||
+        strlen(t.mapping_version) >= mapping_blob::kVersionBytes) {
+      return 0;
+    }
+    memset(out, 0, total);
+    memcpy(out, "CHMP", 4);
+    mapping_blob::wr16(out + 4, mapping_blob::kVersion);
+    mapping_blob::wr16(out + 6, kTableCount);
+    mapping_blob::wr32(out + 8, static_cast<uint32_t>(total));
+    mapping_blob::wr16(out + 16, MappingTables::led_count());
+    mapping_blob::wr16(out + 18, MappingTables::width());
+    mapping_blob::wr16(out + 20, MappingTables::height());
+    mapping_blob::wr16(out + 22, MappingTables::run_count());
+    out[24] = MappingTables::leds_per_segment();
+    out[25] = MappingTables::segment_count();
+    out[26] = MappingTables::vertex_count();
+    out[27] = MappingTables::max_vertex_degree();
+    out[28] = MappingTables::strip_count();
+    out[29] = static_cast<uint8_t>((t.is_bench_subset ? mapping_blob::kFlagBenchSubset : 0) |
+                                   (MappingTables::wire_order() ? mapping_blob::kFlagWireOrder : 0));
+    mapping_blob::wr16(out + 30, static_cast<uint16_t>(MappingTables::raster_scale_x()));
+    mapping_blob::wr16(out + 32, static_cast<uint16_t>(MappingTables::raster_scale_y()));
+    mapping_blob::wr16(out + 34, static_cast<uint16_t>(MappingTables::raster_origin_x()));
+    mapping_blob::wr16(out + 36, static_cast<uint16_t>(MappingTables::raster_origin_y()));
+    memcpy(out + 40, t.mapping_version, strlen(t.mapping_version));
+
+    const void* sources[kTableCount] = {t.pixel_x,      t.pixel_y,          t.global_to_strip, t.global_to_local,
+                                        t.global_to_seg, t.global_to_seg_k, t.global_to_dir,   t.led_attrs,
+                                        t.vertex_vx,    t.vertex_vy,        t.seg_vertex_a,    t.seg_vertex_b,
+                                        t.strip_segment_count, t.strip_data_pin, t.strip_clock_pin,
+                                        t.segment_runs};
+    size_t at = mapping_blob::kHeaderBytes + 4U * kTableCount;
+    for (uint8_t i = 0; i < kTableCount; ++i) {
+      const size_t len =
+          table_bytes(static_cast<Table>(i), MappingTables::led_count(), MappingTables::segment_count(),
+                      MappingTables::vertex_count(), MappingTables::strip_count(), MappingTables::run_count());
+      mapping_blob::wr32(out + mapping_blob::kHeaderBytes + 4U * i, static_cast<uint32_t>(at));
+      memcpy(out + at, sources[i], len);  // host byte order, which open() requires to be little-endian
+      at += round4(len);
+    }
+    mapping_blob::wr32(out + 12, mapping_blob::fnv1a(out + 16, total - 16U));
+    return total;
+  }
+
+ private:
+  static constexpr size_t round4(size_t n) { return (n + 3U) & ~static_cast<size_t>(3U); }
+
+  template <typename T>
+  const T* table(Table t) const {
+    return reinterpret_cast<const T*>(
+        data_ + mapping_blob::rd32(data_ + mapping_blob::kHeaderBytes + 4U * static_cast<uint8_t>(t)));
+  }
+
+  // Everything effects and outputs use as an index stays inside the blob's own counts.
+  bool indices_in_range() const {
+    const uint8_t per_segment = leds_per_segment();
+    const uint8_t* per_strip = table<uint8_t>(Table::kStripSegmentCount);
+    uint32_t wired = 0;
+    for (uint8_t s = 0; s < strip_count(); ++s) wired += per_strip[s];
+    if (wired != run_count()) return false;
+
+    const int16_t* px = table<int16_t>(Table::kPixelX);
+    const int16_t* py = table<int16_t>(Table::kPixelY);
+    const uint8_t* g2s = table<uint8_t>(Table::kGlobalToStrip);
+    const uint16_t* g2l = table<uint16_t>(Table::kGlobalToLocal);
+    const uint8_t* seg = table<uint8_t>(Table::kGlobalToSeg);
+    const uint8_t* k = table<uint8_t>(Table::kGlobalToSegK);
+    const uint8_t* dir = table<uint8_t>(Table::kGlobalToDir);
+    const uint32_t* attrs = table<uint32_t>(Table::kLedAttrs);
+    for (uint16_t i = 0; i < led_count(); ++i) {
+      if (px[i] < 0 || px[i] >= width() || py[i] < 0 || py[i] >= height() || g2s[i] >= strip_count() ||
+          g2l[i] >= per_strip[g2s[i]] * per_segment || seg[i] == 0 || seg[i] > segment_count() ||
+          k[i] >= per_segment || dir[i] > 1 || (attrs[i] & 0xFFU) != seg[i] ||
+          ((attrs[i] >> 16) & 0xFFU) >= vertex_count() || ((attrs[i] >> 24) & 0x7FU) != g2s[i]) {
+        return false;
+      }
+      // Wire order: outputs send each strip straight from its span, so strips must be consecutive and full.
+      if (wire_order() && i > 0 && (g2s[i] < g2s[i - 1] || g2l[i] != (g2s[i] == g2s[i - 1] ? g2l[i - 1] + 1U : 0U))) {
+        return false;
+      }
+    }
+    if (wire_order() && g2l[0] != 0) return false;
+    const uint8_t* va = table<uint8_t>(Table::kSegVertexA);
+    const uint8_t* vb = table<uint8_t>(Table::kSegVertexB);
+    for (uint16_t s = 1; s <= segment_count(); ++s) {
+      if (va[s] >= vertex_count() || vb[s] >= vertex_count()) return false;
+    }
+    const uint32_t* runs = table<uint32_t>(Table::kSegmentRuns);
+    for (uint16_t r = 0; r < run_count(); ++r) {
+      const uint8_t run_seg = static_cast<uint8_t>(runs[r]);
+      if (run_seg == 0 || run_seg > segment_count() || ((runs[r] >> 8) & 0x7FU) >= strip_count()) return false;
+    }
+    return true;
+  }
+
+  const uint8_t* data_ = nullptr;
+};
+
+}  // namespace core
+}  // namespace chromance
@@ -2,7 +2,9 @@
 
 #include <stdint.h>
 
-#if defined(CHROMANCE_BENCH_MODE) && CHROMANCE_BENCH_MODE
+#if defined(CHROMANCE_MAPPING_HEADER)
+#include CHROMANCE_MAPPING_HEADER  // e.g. -DCHROMANCE_MAPPING_HEADER='"generated/chromance_mapping_4panel.h"'
+#elif defined(CHROMANCE_BENCH_MODE) && CHROMANCE_BENCH_MODE
 #include "generated/chromance_mapping_bench.h"
 #else
 #include "generated/chromance_mapping_full.h"
@@ -11,28 +13,118 @@
 namespace chromance {
 namespace core {
 
-struct MappingTables {
-  static constexpr const char* mapping_version() { return mapping::MAPPING_VERSION; }
-  static constexpr bool is_bench_subset() { return mapping::IS_BENCH_SUBSET; }
+// Every table a mapping layout consists of. The build's own (MappingTables::compiled()) are the generated
+// header's constexpr arrays; a mapping blob (mapping_blob.h) supplies the same set read in place from flash.
+struct MappingTableSet {
+  const char* mapping_version;
+  bool is_bench_subset;
+  const int16_t* pixel_x;
+  const int16_t* pixel_y;
+  const uint8_t* global_to_strip;
+  const uint16_t* global_to_local;
+  const uint8_t* global_to_seg;
+  const uint8_t* global_to_seg_k;
+  const uint8_t* global_to_dir;
+  const uint32_t* led_attrs;
+  const int8_t* vertex_vx;
+  const int8_t* vertex_vy;
+  const uint8_t* seg_vertex_a;
+  const uint8_t* seg_vertex_b;
+  const uint8_t* strip_segment_count;
+  const uint8_t* strip_data_pin;
+  const uint8_t* strip_clock_pin;
+  const uint32_t* segment_runs;
+};
+
+template <typename = void>
+struct ActiveMappingTables {
+  // Constant-initialized from the compiled tables, so reading it needs no guard and works during static init.
+  static MappingTableSet set;
+};
 
+// Counts and the controller partition are compile-time constants: they size buffers across core. The tables
+// themselves are read through the active set, which is the compiled header's unless install() swapped in a
+// layout of the same shape at boot (platform/mapping_store.h). Callers hoist the pointer out of their loops, so
+// the indirection costs one load per loop, not per LED (tools/mapping_bench).
+struct MappingTables {
   static constexpr uint16_t led_count() { return mapping::LED_COUNT; }
   static constexpr uint16_t width() { return mapping::WIDTH; }
   static constexpr uint16_t height() { return mapping::HEIGHT; }
+  static constexpr uint8_t leds_per_segment() { return mapping::LEDS_PER_SEGMENT; }
   static constexpr uint8_t segment_count() { return mapping::SEGMENT_COUNT; }
   static constexpr uint8_t vertex_count() { return mapping::VERTEX_COUNT; }
+  static constexpr uint8_t max_vertex_degree() { return mapping::MAX_VERTEX_DEGREE; }
+  static constexpr uint8_t strip_count() { return mapping::STRIP_COUNT; }
+
+  // Wire-order layouts (generate_ledmap.py --wire-order) number global LEDs strip by strip in strip-local order,
+  // so each strip is one contiguous span of the framebuffer (strip_first_led()) and outputs need no permutation.
+  static constexpr bool wire_order() { return mapping::WIRE_ORDER; }
+
+  static constexpr MappingTableSet compiled() {
+    return MappingTableSet{mapping::MAPPING_VERSION,     mapping::IS_BENCH_SUBSET, mapping::pixel_x,
+                           mapping::pixel_y,             mapping::global_to_strip, mapping::global_to_local,
+                           mapping::global_to_seg,       mapping::global_to_seg_k, mapping::global_to_dir,
+                           mapping::led_attrs,           mapping::vertex_vx,       mapping::vertex_vy,
+                           mapping::seg_vertex_a,        mapping::seg_vertex_b,    mapping::strip_segment_count,
+                           mapping::strip_data_pin,      mapping::strip_clock_pin, mapping::segment_runs};
+  }
 
-  static constexpr const int16_t* pixel_x() { return mapping::pixel_x; }
-  static constexpr const int16_t* pixel_y() { return mapping::pixel_y; }
-  static constexpr const uint8_t* global_to_strip() { return mapping::global_to_strip; }
-  static constexpr const uint16_t* global_to_local() { return mapping::global_to_local; }
-  static constexpr const uint8_t* global_to_seg() { return mapping::global_to_seg; }
-  static constexpr const uint8_t* global_to_seg_k() { return mapping::global_to_seg_k; }
-  static constexpr const uint8_t* global_to_dir() { return mapping::global_to_dir; }  // 0=a_to_b, 1=b_to_a
-  static constexpr const int8_t* vertex_vx() { return mapping::vertex_vx; }
-  static constexpr const int8_t* vertex_vy() { return mapping::vertex_vy; }
-  static constexpr const uint8_t* seg_vertex_a() { return mapping::seg_vertex_a; }
-  static constexpr const uint8_t* seg_vertex_b() { return mapping::seg_vertex_b; }
+  // Replaces the active tables. Call before anything reads the mapping (outputs, effects, caches built from
+  // it); the set must describe this build's shape (MappingBlob::compatible() checks).
+  static void install(const MappingTableSet& tables) { ActiveMappingTables<>::set = tables; }
+  static void install_compiled() { ActiveMappingTables<>::set = compiled(); }
+  static bool using_compiled() { return ActiveMappingTables<>::set.pixel_x == mapping::pixel_x; }
+
+  static const char* mapping_version() { return ActiveMappingTables<>::set.mapping_version; }
+  static bool is_bench_subset() { return ActiveMappingTables<>::set.is_bench_subset; }
+
+  static const int16_t* pixel_x() { return ActiveMappingTables<>::set.pixel_x; }
+  static const int16_t* pixel_y() { return ActiveMappingTables<>::set.pixel_y; }
+  static const uint8_t* global_to_strip() { return ActiveMappingTables<>::set.global_to_strip; }
+  static const uint16_t* global_to_local() { return ActiveMappingTables<>::set.global_to_local; }
+  static const uint8_t* global_to_seg() { return ActiveMappingTables<>::set.global_to_seg; }
+  static const uint8_t* global_to_seg_k() { return ActiveMappingTables<>::set.global_to_seg_k; }
+  static const uint8_t* global_to_dir() { return ActiveMappingTables<>::set.global_to_dir; }  // 0=a_to_b, 1=b_to_a
+  static const uint32_t* led_attrs() { return ActiveMappingTables<>::set.led_attrs; }  // see led_attributes.h
+  static const int8_t* vertex_vx() { return ActiveMappingTables<>::set.vertex_vx; }
+  static const int8_t* vertex_vy() { return ActiveMappingTables<>::set.vertex_vy; }
+  static const uint8_t* seg_vertex_a() { return ActiveMappingTables<>::set.seg_vertex_a; }
+  static const uint8_t* seg_vertex_b() { return ActiveMappingTables<>::set.seg_vertex_b; }
+  static const uint8_t* strip_segment_count() { return ActiveMappingTables<>::set.strip_segment_count; }
+  static const uint8_t* strip_data_pin() { return ActiveMappingTables<>::set.strip_data_pin; }  // 255 = none
+  static const uint8_t* strip_clock_pin() { return ActiveMappingTables<>::set.strip_clock_pin; }
+
+  // Compact encoding (see compact_mapping.h): one word per wired segment instead of the flat per-LED tables.
+  static constexpr uint16_t run_count() { return mapping::RUN_COUNT; }
+  static const uint32_t* segment_runs() { return ActiveMappingTables<>::set.segment_runs; }
+  static constexpr int16_t raster_scale_x() { return mapping::RASTER_SCALE_X; }
+  static constexpr int16_t raster_scale_y() { return mapping::RASTER_SCALE_Y; }
+  static constexpr int16_t raster_origin_x() { return mapping::RASTER_ORIGIN_X; }
+  static constexpr int16_t raster_origin_y() { return mapping::RASTER_ORIGIN_Y; }
+
+  // Controller partition (see node_partition.h); a single-controller header is node 0 of 1 and owns everything.
+  static constexpr uint8_t node_count() { return mapping::NODE_COUNT; }
+  static constexpr uint8_t node_index() { return mapping::NODE_INDEX; }
+  static constexpr const char* node_name() { return mapping::NODE_NAME; }
+  static constexpr uint16_t node_led_first() { return mapping::NODE_LED_FIRST; }
+  static constexpr uint16_t node_led_count() { return mapping::NODE_LED_COUNT; }
+  static constexpr const uint8_t* strip_node() { return mapping::strip_node; }
+  static constexpr const uint8_t* seg_node_role() { return mapping::seg_node_role; }
 };
 
+template <typename T>
+MappingTableSet ActiveMappingTables<T>::set = MappingTables::compiled();
+
+// Segment and vertex ids are uint8_t, with 0 as "no segment" and 0xFF as "no vertex" in effect caches.
+static_assert(MappingTables::segment_count() >= 1 && MappingTables::segment_count() < 255,
+              "segment ids must fit uint8_t");
+static_assert(MappingTables::vertex_count() >= 1 && MappingTables::vertex_count() < 255,
+              "vertex ids must fit uint8_t with 0xFF reserved");
+static_assert(MappingTables::run_count() * MappingTables::leds_per_segment() == MappingTables::led_count(),
+              "global LEDs come in whole segment runs");
+static_assert(MappingTables::node_index() < MappingTables::node_count(), "node index out of range");
+static_assert(MappingTables::node_led_first() + MappingTables::node_led_count() <= MappingTables::led_count(),
+              "node LED range must lie inside the mapping");
+
 }  // namespace core
 }  // namespace chromance
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "mapping_tables.h"
+#include "segment_mask.h"
+
+namespace chromance {
+namespace core {
+
+// Controller partition of a wall split across several boards (wiring "nodes", built per node with
+// generate_ledmap.py --out-node-headers). Every node keeps the full global tables, so effects render the same
+// global frame everywhere and need no pixel traffic between nodes; the partition only says which part this
+// build drives. Halo segments belong to another node but touch one of ours: whatever an effect spreads across
+// the node boundary passes through them.
+enum class NodeRole : uint8_t {
+  kRemote = 0,  // another node's segment (or not wired at all)
+  kLocal = 1,
+  kHalo = 2,
+};
+
+inline NodeRole segment_node_role(uint8_t seg) {
+  return seg >= 1 && seg <= MappingTables::segment_count()
+             ? static_cast<NodeRole>(MappingTables::seg_node_role()[seg])
+             : NodeRole::kRemote;
+}
+
+constexpr bool is_multi_node() { return MappingTables::node_count() > 1; }
+
+// True for the global LED indices this node's strips drive.
+inline bool node_drives_led(uint16_t i) {
+  return static_cast<uint16_t>(i - MappingTables::node_led_first()) < MappingTables::node_led_count();
+}
+
+inline SegmentMask node_segments(NodeRole role) {
+  SegmentMask m;
+  for (uint16_t seg = 1; seg <= MappingTables::segment_count(); ++seg) {
+    if (segment_node_role(static_cast<uint8_t>(seg)) == role) m.set(static_cast<uint8_t>(seg));
+  }
+  return m;
+}
+
+// The segments this node's output depends on directly: its own plus the halo.
+inline SegmentMask node_view_segments() {
+  SegmentMask m = node_segments(NodeRole::kLocal);
+  m |= node_segments(NodeRole::kHalo);
+  return m;
+}
+
+}  // namespace core
+}  // namespace chromance
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 
+#include "led_attributes.h"
 #include "mapping_tables.h"
 
 namespace chromance {
@@ -21,10 +22,13 @@ class PixelsMap {
   constexpr uint16_t width() const { return MappingTables::width(); }
   constexpr uint16_t height() const { return MappingTables::height(); }
 
-  constexpr PixelCoord coord(uint16_t led_index) const {
+  PixelCoord coord(uint16_t led_index) const {
     return PixelCoord{MappingTables::pixel_x()[led_index], MappingTables::pixel_y()[led_index]};
   }
 
+  // Topology of one LED (segment, position, nearest vertex, strip, direction) from the flash attribute pack.
+  LedAttr attr(uint16_t led_index) const { return led_attr(led_index); }
+
   constexpr PixelCoord center() const {
     // Center in raster coordinates (0..width-1, 0..height-1).
     return PixelCoord{static_cast<int16_t>((width() - 1) / 2),
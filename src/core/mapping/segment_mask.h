@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "led_attributes.h"
+#include "mapping_tables.h"
+
+namespace chromance {
+namespace core {
+
+// Bitset over segment ids 1..SegmentCount (bit 0 unused, ids are 1-based). Segment-subset effects build a mask
+// once when their selection changes and then pick LEDs with one bit test per LED (contains(LedAttr)) instead
+// of searching a segment list.
+template <size_t SegmentCount>
+class BasicSegmentMask {
+ public:
+  static constexpr size_t kWords = (SegmentCount + 1U + 31U) / 32U;
+
+  void clear() {
+    for (size_t w = 0; w < kWords; ++w) words_[w] = 0;
+  }
+
+  // Out-of-range ids are ignored (set) or never contained (test).
+  void set(uint8_t seg) {
+    if (seg >= 1 && seg <= SegmentCount) words_[seg >> 5] |= 1U << (seg & 31U);
+  }
+  void reset(uint8_t seg) {
+    if (seg >= 1 && seg <= SegmentCount) words_[seg >> 5] &= ~(1U << (seg & 31U));
+  }
+  bool test(uint8_t seg) const {
+    return seg >= 1 && seg <= SegmentCount && (words_[seg >> 5] & (1U << (seg & 31U))) != 0;
+  }
+  bool contains(LedAttr a) const { return test(a.segment()); }
+
+  void set_all(const uint8_t* segs, size_t n) {
+    for (size_t i = 0; segs != nullptr && i < n; ++i) set(segs[i]);
+  }
+
+  bool any() const {
+    for (size_t w = 0; w < kWords; ++w) {
+      if (words_[w] != 0) return true;
+    }
+    return false;
+  }
+
+  uint8_t count() const {
+    uint8_t n = 0;
+    for (size_t w = 0; w < kWords; ++w) {
+      for (uint32_t v = words_[w]; v != 0; v &= v - 1U) ++n;
+    }
+    return n;
+  }
+
+  BasicSegmentMask& operator&=(const BasicSegmentMask& o) {
+    for (size_t w = 0; w < kWords; ++w) words_[w] &= o.words_[w];
+    return *this;
+  }
+  BasicSegmentMask& operator|=(const BasicSegmentMask& o) {
+    for (size_t w = 0; w < kWords; ++w) words_[w] |= o.words_[w];
+    return *this;
+  }
+  bool operator==(const BasicSegmentMask& o) const {
+    for (size_t w = 0; w < kWords; ++w) {
+      if (words_[w] != o.words_[w]) return false;
+    }
+    return true;
+  }
+  bool operator!=(const BasicSegmentMask& o) const { return !(*this == o); }
+
+ private:
+  uint32_t words_[kWords] = {};
+};
+
+using SegmentMask = BasicSegmentMask<MappingTables::segment_count()>;
+
+// Segments the compiled mapping actually wires (the bench subset has only some of them).
+inline SegmentMask present_segments() {
+  SegmentMask m;
+  for (uint16_t i = 0; i < MappingTables::led_count(); ++i) m.set(led_attr(i).segment());
+  return m;
+}
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace chromance {
+namespace core {
+
+// What the platform should run at. cpu_mhz is one of PowerGovernor::cpu_mhz_for(step).
+struct PowerDecision {
+  uint16_t cpu_mhz;
+  bool modem_sleep;
+};
+
+// Per-loop inputs. Occupancy is measured at the current CPU clock.
+struct PowerInputs {
+  uint16_t occupancy_permille = 0;  // render + flush time / wall time (FrameScheduler::occupancy_permille())
+  uint16_t rendered_fps = 0;        // frames actually rendered per second (idle holds excluded)
+  uint8_t brightness = 255;         // global brightness; 0 = panel dark
+  bool link_busy = false;           // web UI / control channel / streamed input in use
+  bool ota_active = false;
+};
+
+struct PowerStepStats {
+  uint32_t time_ms;
+  uint32_t max_frame_us;  // render + flush, measured at this clock
+  uint32_t late_frames;   // frames whose work exceeded the frame period
+};
+
+struct PowerStats {
+  PowerStepStats steps[3];
+  uint32_t modem_sleep_ms;
+  uint32_t cpu_changes;
+  uint32_t sleep_changes;
+};
+
+// CPU clock and WiFi modem-sleep policy, driven by measured frame load.
+//
+// - OTA or any link activity (web requests, control channel clients, streamed frames): full speed, radio
+//   always on, applied immediately.
+// - Dark panel (brightness 0): lowest clock with modem sleep.
+// - Otherwise the clock steps down one notch after the occupancy projected at the lower clock has stayed
+//   under kStepDownPermille for kStepDownDwellMs, and steps up as soon as occupancy exceeds kStepUpPermille.
+//   Each change is followed by a settle period so the next decision uses a window measured at the new clock.
+// - Modem sleep is also enabled while the effect renders at most kSlowFps frames per second.
+//
+// Time and frame-cost accounting per clock step feeds the /api/perf power report; estimated_ma() turns it
+// into an average supply current from typical ESP32 datasheet figures (an estimate, not a measurement).
+class PowerGovernor final {
+ public:
+  static constexpr uint8_t kStepCount = 3;
+
+  static constexpr uint16_t kStepDownPermille = 500;
+  static constexpr uint16_t kStepUpPermille = 750;
+  static constexpr uint32_t kStepDownDwellMs = 3000;
+  static constexpr uint32_t kSettleMs = 1500;
+  static constexpr uint16_t kSlowFps = 10;
+
+  // Typical supply current (mA): radio with modem sleep off/on (CPU share: cpu_ma_for()).
+  static constexpr uint16_t kRadioAwakeMa = 100;
+  static constexpr uint16_t kRadioModemSleepMa = 20;
+
+  // Clock steps, lowest first. 80 MHz is the lowest clock that keeps WiFi running.
+  static uint16_t cpu_mhz_for(uint8_t step) { return step == 0 ? 80 : (step == 1 ? 160 : 240); }
+  static uint16_t cpu_ma_for(uint8_t step) { return step == 0 ? 30 : (step == 1 ? 42 : 60); }
+
+  void begin(uint32_t now_ms) {
+    step_ = kStepCount - 1;
+    modem_sleep_ = false;
+    last_update_ms_ = now_ms;
+    settle_until_ms_ = now_ms + kSettleMs;
+    below_since_valid_ = false;
+    stats_ = PowerStats{};
+  }
+
+  void set_enabled(bool enabled) { enabled_ = enabled; }
+  bool enabled() const { return enabled_; }
+
+  PowerDecision update(uint32_t now_ms, const PowerInputs& in) {
+    account(now_ms);
+    last_inputs_ = in;
+
+    uint8_t step = step_;
+    bool sleep = modem_sleep_;
+    if (!enabled_ || in.ota_active || in.link_busy) {
+      step = kStepCount - 1;
+      sleep = false;
+      below_since_valid_ = false;
+    } else if (in.brightness == 0) {
+      step = 0;
+      sleep = true;
+      below_since_valid_ = false;
+    } else {
+      sleep = in.rendered_fps <= kSlowFps;
+      if (reached(now_ms, settle_until_ms_)) {
+        step = load_step(now_ms, in.occupancy_permille);
+      }
+    }
+
+    if (step != step_) {
+      step_ = step;
+      ++stats_.cpu_changes;
+      settle_until_ms_ = now_ms + kSettleMs;
+      below_since_valid_ = false;
+    }
+    if (sleep != modem_sleep_) {
+      modem_sleep_ = sleep;
+      ++stats_.sleep_changes;
+    }
+    return decision();
+  }
+
+  // Records one rendered frame's work (render + flush) against the current clock step.
+  void note_frame_us(uint32_t us, uint32_t frame_period_us) {
+    PowerStepStats& s = stats_.steps[step_];
+    if (us > s.max_frame_us) s.max_frame_us = us;
+    if (frame_period_us > 0 && us > frame_period_us) ++s.late_frames;
+  }
+
+  PowerDecision decision() const { return PowerDecision{cpu_mhz_for(step_), modem_sleep_}; }
+  const PowerStats& stats() const { return stats_; }
+  const PowerInputs& last_inputs() const { return last_inputs_; }
+
+  // Time-weighted average supply current estimate since begin().
+  uint32_t estimated_ma() const {
+    uint64_t weighted = 0;
+    uint64_t total_ms = 0;
+    for (uint8_t i = 0; i < kStepCount; ++i) {
+      weighted += static_cast<uint64_t>(stats_.steps[i].time_ms) * cpu_ma_for(i);
+      total_ms += stats_.steps[i].time_ms;
+    }
+    if (total_ms == 0) {
+      return static_cast<uint32_t>(cpu_ma_for(kStepCount - 1)) + kRadioAwakeMa;
+    }
+    const uint64_t sleep_ms = stats_.modem_sleep_ms < total_ms ? stats_.modem_sleep_ms : total_ms;
+    weighted += sleep_ms * kRadioModemSleepMa + (total_ms - sleep_ms) * kRadioAwakeMa;
+    return static_cast<uint32_t>(weighted / total_ms);
+  }
+
+ private:
+  static bool reached(uint32_t now_ms, uint32_t target_ms) { return static_cast<int32_t>(now_ms - target_ms) >= 0; }
+
+  uint8_t load_step(uint32_t now_ms, uint16_t occupancy) {
+    if (occupancy > kStepUpPermille && step_ + 1U < kStepCount) {
+      below_since_valid_ = false;
+      return static_cast<uint8_t>(step_ + 1U);
+    }
+    if (step_ == 0) {
+      return step_;
+    }
+    // Same work at the lower clock takes proportionally longer.
+    const uint32_t projected =
+        static_cast<uint32_t>(occupancy) * cpu_mhz_for(step_) / cpu_mhz_for(static_cast<uint8_t>(step_ - 1U));
+    if (projected >= kStepDownPermille) {
+      below_since_valid_ = false;
+      return step_;
+    }
+    if (!below_since_valid_) {
+      below_since_valid_ = true;
+      below_since_ms_ = now_ms;
+      return step_;
+    }
+    return reached(now_ms, below_since_ms_ + kStepDownDwellMs) ? static_cast<uint8_t>(step_ - 1U) : step_;
+  }
+
+  void account(uint32_t now_ms) {
+    const uint32_t dt = now_ms - last_update_ms_;
+    last_update_ms_ = now_ms;
+    if (static_cast<int32_t>(dt) <= 0) {
+      return;
+    }
+    stats_.steps[step_].time_ms += dt;
+    if (modem_sleep_) stats_.modem_sleep_ms += dt;
+  }
+
+  bool enabled_ = true;
+  uint8_t step_ = kStepCount - 1;
+  bool modem_sleep_ = false;
+  uint32_t last_update_ms_ = 0;
+  uint32_t settle_until_ms_ = 0;
+  bool below_since_valid_ = false;
+  uint32_t below_since_ms_ = 0;
+  PowerStats stats_{};
+  PowerInputs last_inputs_{};
+};
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace chromance {
+namespace core {
+
+// Resumable send of one in-memory response body (embedded web assets).
+//
+// The web server keeps one of these per connection and calls pump() from each render-gated handle() with a
+// byte budget, so a large bundle to a slow client is spread over many loop iterations instead of blocking one
+// of them. A connection that makes no progress for stall_ms is reported as stalled and closed by the caller.
+class AssetSendState final {
+ public:
+  enum class Result : uint8_t { kPending, kDone, kStalled, kError };
+
+  void start(const uint8_t* data, size_t len, uint32_t now_ms) {
+    data_ = data;
+    len_ = len;
+    sent_ = 0;
+    last_progress_ms_ = now_ms;
+  }
+
+  // write(ptr, n) must not block: it returns bytes accepted (0 = would block) or a negative value on error.
+  template <typename WriteFn>
+  Result pump(WriteFn&& write, size_t byte_budget, size_t chunk_bytes, uint32_t now_ms, uint32_t stall_ms) {
+    if (data_ == nullptr || sent_ >= len_) {
+      return Result::kDone;
+    }
+    size_t budget = byte_budget;
+    while (budget > 0 && sent_ < len_) {
+      size_t n = len_ - sent_;
+      if (n > chunk_bytes) n = chunk_bytes;
+      if (n > budget) n = budget;
+      const int32_t wrote = write(data_ + sent_, n);
+      if (wrote < 0) {
+        return Result::kError;
+      }
+      if (wrote == 0) {
+        break;
+      }
+      sent_ += static_cast<size_t>(wrote);
+      budget -= static_cast<size_t>(wrote) < budget ? static_cast<size_t>(wrote) : budget;
+      last_progress_ms_ = now_ms;
+    }
+    if (sent_ >= len_) {
+      return Result::kDone;
+    }
+    if (static_cast<int32_t>(now_ms - last_progress_ms_) >= static_cast<int32_t>(stall_ms)) {
+      return Result::kStalled;
+    }
+    return Result::kPending;
+  }
+
+  size_t sent() const { return sent_; }
+  size_t remaining() const { return len_ - sent_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t len_ = 0;
+  size_t sent_ = 0;
+  uint32_t last_progress_ms_ = 0;
+};
+
+// True if an If-None-Match header value matches etag (a quoted strong ETag). Accepts "*", comma-separated
+// lists and weak comparison of W/ prefixed entries, per RFC 9110 13.1.2.
+inline bool etag_matches(const char* if_none_match, const char* etag) {
+  if (if_none_match == nullptr || etag == nullptr || etag[0] == '\0') {
+    return false;
+  }
+  const size_t etag_len = strlen(etag);
+  const char* p = if_none_match;
+  while (*p != '\0') {
+    while (*p == ' ' || *p == '\t' || *p == ',') ++p;
+    if (*p == '\0') break;
+    if (*p == '*') return true;
+    if (p[0] == 'W' && p[1] == '/') p += 2;
+    const char* end = p;
+    while (*end != '\0' && *end != ',') ++end;
+    const char* tail = end;
+    while (tail > p && (tail[-1] == ' ' || tail[-1] == '\t')) --tail;
+    if (static_cast<size_t>(tail - p) == etag_len && strncmp(p, etag, etag_len) == 0) {
+      return true;
+    }
+    p = end;
+  }
+  return false;
+}
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../types.h"
+
+namespace chromance {
+namespace core {
+
+// Delta/RLE framebuffer encoding for the live preview stream.
+//
+// Message layout:
+//   [0]     kPreviewFrameMessage
+//   [1]     flags (bit0 = keyframe)
+//   [2..3]  sequence (u16, little-endian)
+//   [4..5]  led count (u16, little-endian)
+//   [6..]   ops
+//
+// Each op byte is (code << 6) | (count - 1), count in 1..64:
+//   kOpSkip    pixels unchanged from the previous frame (keyframes: previous frame is all black)
+//   kOpRun     one RGB triple follows, repeated count times
+//   kOpLiteral count RGB triples follow
+//
+// Breathing/TwoDots frames are mostly black or unchanged, so a typical delta is a few dozen bytes.
+static constexpr uint8_t kPreviewSubscribeMessage = 0x02;  // client -> device: {0x02, fps}; fps 0 stops
+static constexpr uint8_t kPreviewFrameMessage = 0x10;
+static constexpr uint8_t kPreviewFlagKeyframe = 0x01;
+static constexpr size_t kPreviewHeaderBytes = 6;
+
+enum : uint8_t { kOpSkip = 0, kOpRun = 1, kOpLiteral = 2 };
+static constexpr size_t kMaxOpCount = 64;
+
+// Upper bound on an encoded message for n pixels (literal-only worst case plus op bytes).
+constexpr size_t preview_max_encoded_size(size_t n) { return kPreviewHeaderBytes + n * 3 + (n + 1) / 2 + 1; }
+
+inline bool rgb_equal(const Rgb& a, const Rgb& b) { return a.r == b.r && a.g == b.g && a.b == b.b; }
+
+template <size_t MaxLeds>
+class FrameDeltaEncoder final {
+ public:
+  // Next encode() emits a keyframe (e.g. new subscriber or resync).
+  void force_keyframe() { need_keyframe_ = true; }
+
+  // Returns the encoded size, or 0 if out_size is too small (state is left unchanged in that case).
+  size_t encode(const Rgb* frame, size_t n, uint8_t* out, size_t out_size) {
+    if (frame == nullptr || out == nullptr || n == 0 || n > MaxLeds || n > 0xFFFF) {
+      return 0;
+    }
+    if (out_size < kPreviewHeaderBytes) {
+      return 0;
+    }
+    if (n != count_) {
+      need_keyframe_ = true;
+    }
+    const bool key = need_keyframe_;
+    if (key) {
+      memset(prev_, 0, sizeof(prev_[0]) * n);
+    }
+
+    size_t pos = kPreviewHeaderBytes;
+    size_t i = 0;
+    while (i < n) {
+      const size_t skip = count_while_unchanged(frame, i, n);
+      if (skip > 0) {
+        if (pos + 1 > out_size) return 0;
+        out[pos++] = op_byte(kOpSkip, skip);
+        i += skip;
+        continue;
+      }
+      const size_t run = count_run(frame, i, n);
+      if (run >= 3) {
+        if (pos + 4 > out_size) return 0;
+        out[pos++] = op_byte(kOpRun, run);
+        pos = put_rgb(out, pos, frame[i]);
+        i += run;
+        continue;
+      }
+      // Literal: extend until a skip of >=2 or a run of >=3 becomes worthwhile.
+      size_t lit = 1;
+      while (i + lit < n && lit < kMaxOpCount) {
+        if (count_while_unchanged(frame, i + lit, n) >= 2 || count_run(frame, i + lit, n) >= 3) break;
+        ++lit;
+      }
+      if (pos + 1 + lit * 3 > out_size) return 0;
+      out[pos++] = op_byte(kOpLiteral, lit);
+      for (size_t k = 0; k < lit; ++k) {
+        pos = put_rgb(out, pos, frame[i + k]);
+      }
+      i += lit;
+    }
+
+    out[0] = kPreviewFrameMessage;
+    out[1] = key ? kPreviewFlagKeyframe : 0;
+    out[2] = static_cast<uint8_t>(seq_ & 0xFF);
+    out[3] = static_cast<uint8_t>(seq_ >> 8);
+    out[4] = static_cast<uint8_t>(n & 0xFF);
+    out[5] = static_cast<uint8_t>(n >> 8);
+
+    memcpy(prev_, frame, sizeof(prev_[0]) * n);
+    count_ = n;
+    need_keyframe_ = false;
+    ++seq_;
+    return pos;
+  }
+
+ private:
+  static uint8_t op_byte(uint8_t code, size_t count) {
+    return static_cast<uint8_t>((code << 6) | static_cast<uint8_t>(count - 1));
+  }
+
+  static size_t put_rgb(uint8_t* out, size_t pos, const Rgb& c) {
+    out[pos++] = c.r;
+    out[pos++] = c.g;
+    out[pos++] = c.b;
+    return pos;
+  }
+
+  size_t count_while_unchanged(const Rgb* frame, size_t i, size_t n) const {
+    size_t k = 0;
+    while (i + k < n && k < kMaxOpCount && rgb_equal(frame[i + k], prev_[i + k])) ++k;
+    return k;
+  }
+
+  static size_t count_run(const Rgb* frame, size_t i, size_t n) {
+    size_t k = 1;
+    while (i + k < n && k < kMaxOpCount && rgb_equal(frame[i + k], frame[i])) ++k;
+    return k;
+  }
+
+  Rgb prev_[MaxLeds] = {};
+  size_t count_ = 0;
+  uint16_t seq_ = 0;
+  bool need_keyframe_ = true;
+};
+
+// Applies an encoded message to frame[0..n). Returns false if malformed or if a delta arrives for a frame
+// of a different size. The web UI mirrors this in JavaScript.
+inline bool decode_preview_frame(const uint8_t* data, size_t len, Rgb* frame, size_t n) {
+  if (data == nullptr || frame == nullptr || len < kPreviewHeaderBytes || data[0] != kPreviewFrameMessage) {
+    return false;
+  }
+  const size_t count = static_cast<size_t>(data[4] | (data[5] << 8));
+  if (count != n) {
+    return false;
+  }
+  if ((data[1] & kPreviewFlagKeyframe) != 0) {
+    memset(frame, 0, sizeof(frame[0]) * n);
+  }
+
+  size_t pos = kPreviewHeaderBytes;
+  size_t i = 0;
+  while (pos < len) {
+    const uint8_t op = data[pos++];
+    const uint8_t code = static_cast<uint8_t>(op >> 6);
+    const size_t cnt = static_cast<size_t>(op & 0x3F) + 1;
+    if (i + cnt > n) return false;
+    if (code == kOpSkip) {
+      i += cnt;
+    } else if (code == kOpRun) {
+      if (pos + 3 > len) return false;
+      const Rgb c{data[pos], data[pos + 1], data[pos + 2]};
+      pos += 3;
+      for (size_t k = 0; k < cnt; ++k) frame[i++] = c;
+    } else if (code == kOpLiteral) {
+      if (pos + cnt * 3 > len) return false;
+      for (size_t k = 0; k < cnt; ++k, pos += 3) frame[i++] = Rgb{data[pos], data[pos + 1], data[pos + 2]};
+    } else {
+      return false;
+    }
+  }
+  return i == n;
+}
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../clock_servo.h"
+#include "../effects/effect_id.h"
+#include "../effects/effect_params.h"
+#include "../settings/effect_config_store.h"
+
+namespace chromance {
+namespace core {
+
+// Multi-controller sync: several boards drive parts of one wall from the same global mapping.
+//
+// The leader broadcasts a beacon every kBeaconIntervalUs, and at once when its effect state changes. A beacon
+// carries the leader's clock and everything a node needs to render the same frame as the leader: active effect
+// id, the time that effect was started (effects seed their RNGs from it), the crossfade into it, global params,
+// the target frame rate and the effect's config bytes. The fade length is the leader's: a node's own choice
+// depends on its frame budget and measured render costs, which differ between boards. Followers discipline a ClockServo with the beacons, run their effects and a
+// phase-locked FrameScheduler on the leader's clock, and adopt the effect state (apply_sync_state()). Every
+// node renders the full global frame; the LED output only flushes the strips its wiring file assigns pins to.
+//
+// Clocks are 64-bit boot-relative microseconds; the millisecond clock effects run on is the low 32 bits of
+// us / 1000 (exactly millis() on the ESP32).
+//
+// Wire format (little endian), one UDP datagram:
+//    0  'C' 'S' 'Y' 'N'
+//    4  u8  version (kSyncVersion)
+//    5  u8  group: nodes only follow beacons of their own group
+//    6  u16 sequence
+//    8  u64 leader clock, us
+//   16  u16 effect id
+//   18  u32 effect start, leader ms
+//   22  u8  brightness, speed, intensity, palette
+//   26  u16 target fps
+//   28  u16 crossfade into the effect, ms (0 = cut)
+//   30  u8  config length (<= kMaxEffectConfigSize), then the config bytes
+static constexpr uint16_t kNodeSyncPort = 4210;
+static constexpr uint8_t kSyncVersion = 2;
+
+struct SyncState {
+  uint16_t effect_id = 0;
+  uint32_t effect_start_ms = 0;
+  EffectParams params;
+  uint16_t target_fps = 0;
+  uint16_t fade_ms = 0;
+  uint8_t config_len = 0;
+  uint8_t config[kMaxEffectConfigSize] = {};
+};
+
+inline bool same_sync_state(const SyncState& a, const SyncState& b) {
+  return a.effect_id == b.effect_id && a.effect_start_ms == b.effect_start_ms &&
+         a.params.brightness == b.params.brightness && a.params.speed == b.params.speed &&
+         a.params.intensity == b.params.intensity && a.params.palette == b.params.palette &&
+         a.target_fps == b.target_fps && a.fade_ms == b.fade_ms && a.config_len == b.config_len &&
+         memcmp(a.config, b.config, a.config_len) == 0;
+}
+
+struct SyncBeacon {
+  uint8_t group = 0;
+  uint16_t sequence = 0;
+  uint64_t leader_us = 0;
+  SyncState state;
+};
+
+static constexpr size_t kSyncHeaderBytes = 31;
+static constexpr size_t kSyncMaxBeaconBytes = kSyncHeaderBytes + kMaxEffectConfigSize;
+
+// Writes a beacon into out; returns its length (0 when cap is too small).
+inline size_t encode_sync_beacon(const SyncBeacon& b, uint8_t* out, size_t cap) {
+  const size_t len = kSyncHeaderBytes + b.state.config_len;
+  if (out == nullptr || b.state.config_len > kMaxEffectConfigSize || cap < len) {
+    return 0;
+  }
+  out[0] = 'C';
+  out[1] = 'S';
+  out[2] = 'Y';
+  out[3] = 'N';
+  out[4] = kSyncVersion;
+  out[5] = b.group;
+  out[6] = static_cast<uint8_t>(b.sequence);
+  out[7] = static_cast<uint8_t>(b.sequence >> 8);
+  for (uint8_t i = 0; i < 8; ++i) {
+    out[8 + i] = static_cast<uint8_t>(b.leader_us >> (8U * i));
+  }
+  out[16] = static_cast<uint8_t>(b.state.effect_id);
+  out[17] = static_cast<uint8_t>(b.state.effect_id >> 8);
+  for (uint8_t i = 0; i < 4; ++i) {
+    out[18 + i] = static_cast<uint8_t>(b.state.effect_start_ms >> (8U * i));
+  }
+  out[22] = b.state.params.brightness;
+  out[23] = b.state.params.speed;
+  out[24] = b.state.params.intensity;
+  out[25] = b.state.params.palette;
+  out[26] = static_cast<uint8_t>(b.state.target_fps);
+  out[27] = static_cast<uint8_t>(b.state.target_fps >> 8);
+  out[28] = static_cast<uint8_t>(b.state.fade_ms);
+  out[29] = static_cast<uint8_t>(b.state.fade_ms >> 8);
+  out[30] = b.state.config_len;
+  memcpy(out + kSyncHeaderBytes, b.state.config, b.state.config_len);
+  return len;
+}
+
+inline bool parse_sync_beacon(const uint8_t* data, size_t len, SyncBeacon* out) {
+  if (data == nullptr || out == nullptr || len < kSyncHeaderBytes || data[0] != 'C' || data[1] != 'S' ||
+      data[2] != 'Y' || data[3] != 'N' || data[4] != kSyncVersion) {
+    return false;
+  }
+  const uint8_t config_len = data[30];
+  if (config_len > kMaxEffectConfigSize || len != kSyncHeaderBytes + config_len) {
+    return false;
+  }
+  out->group = data[5];
+  out->sequence = static_cast<uint16_t>(data[6] | (data[7] << 8));
+  out->leader_us = 0;
+  for (uint8_t i = 0; i < 8; ++i) {
+    out->leader_us |= static_cast<uint64_t>(data[8 + i]) << (8U * i);
+  }
+  out->state.effect_id = static_cast<uint16_t>(data[16] | (data[17] << 8));
+  out->state.effect_start_ms = 0;
+  for (uint8_t i = 0; i < 4; ++i) {
+    out->state.effect_start_ms |= static_cast<uint32_t>(data[18 + i]) << (8U * i);
+  }
+  out->state.params.brightness = data[22];
+  out->state.params.speed = data[23];
+  out->state.params.intensity = data[24];
+  out->state.params.palette = data[25];
+  out->state.target_fps = static_cast<uint16_t>(data[26] | (data[27] << 8));
+  out->state.fade_ms = static_cast<uint16_t>(data[28] | (data[29] << 8));
+  out->state.config_len = config_len;
+  memcpy(out->state.config, data + kSyncHeaderBytes, config_len);
+  return true;
+}
+
+// Leader side: snapshot of the manager's effect state for the next beacon.
+template <class Manager>
+void capture_sync_state(const Manager& manager, uint16_t target_fps, SyncState* out) {
+  out->effect_id = manager.active_id().value;
+  out->effect_start_ms = manager.activated_ms();
+  out->params = manager.global_params();
+  out->target_fps = target_fps;
+  out->fade_ms = manager.fade_ms();
+  const uint8_t* config = manager.config_bytes(manager.active_id());
+  out->config_len = config != nullptr ? static_cast<uint8_t>(kMaxEffectConfigSize) : 0;
+  if (config != nullptr) {
+    memcpy(out->config, config, kMaxEffectConfigSize);
+  }
+}
+
+// Follower side: makes the manager match the leader's effect state. The effect is (re)started at the leader's
+// start time with the leader's fade length, so its runtime state and crossfade line up with the leader's.
+// Returns true when anything changed.
+template <class Manager>
+bool apply_sync_state(const SyncState& s, Manager& manager) {
+  const EffectId id{s.effect_id};
+  bool changed = false;
+  const uint8_t* config = manager.config_bytes(id);
+  if (config != nullptr && s.config_len > 0 && memcmp(config, s.config, s.config_len) != 0) {
+    changed = manager.adopt_config(id, s.config, s.config_len) || changed;
+  }
+  if (manager.active_id().value != s.effect_id) {
+    if (!manager.set_active(id, s.effect_start_ms, s.fade_ms)) {
+      return changed;  // not in this node's catalog
+    }
+    changed = true;
+  } else if (manager.activated_ms() != s.effect_start_ms) {
+    manager.restart_active(s.effect_start_ms);
+    changed = true;
+  } else if (manager.fade_ms() != s.fade_ms) {
+    manager.set_fade_ms(s.fade_ms);  // the leader shortened its fade mid-way (over its frame budget)
+    changed = true;
+  }
+  const EffectParams& p = manager.global_params();
+  if (p.brightness != s.params.brightness || p.speed != s.params.speed || p.intensity != s.params.intensity ||
+      p.palette != s.params.palette) {
+    manager.set_global_params(s.params);
+    changed = true;
+  }
+  return changed;
+}
+
+class SyncLeader final {
+ public:
+  static constexpr uint32_t kBeaconIntervalUs = 50000;
+
+  explicit SyncLeader(uint8_t group = 0) : group_(group) {}
+
+  // Writes the next beacon into out when one is due (interval elapsed or state changed); returns its length,
+  // or 0 when nothing is due.
+  size_t poll(const SyncState& state, uint64_t now_us, uint8_t* out, size_t cap) {
+    const bool changed = !sent_any_ || !same_sync_state(state, last_state_);
+    if (!changed && now_us - last_sent_us_ < kBeaconIntervalUs) {
+      return 0;
+    }
+    SyncBeacon b;
+    b.group = group_;
+    b.sequence = sequence_;
+    b.leader_us = now_us;
+    b.state = state;
+    const size_t len = encode_sync_beacon(b, out, cap);
+    if (len == 0) {
+      return 0;
+    }
+    ++sequence_;
+    ++beacons_;
+    sent_any_ = true;
+    last_sent_us_ = now_us;
+    last_state_ = state;
+    return len;
+  }
+
+  uint32_t beacons() const { return beacons_; }
+
+ private:
+  uint8_t group_ = 0;
+  uint16_t sequence_ = 0;
+  bool sent_any_ = false;
+  uint64_t last_sent_us_ = 0;
+  uint32_t beacons_ = 0;
+  SyncState last_state_;
+};
+
+struct SyncFollowerStats {
+  uint32_t beacons = 0;    // accepted
+  uint32_t malformed = 0;
+  uint32_t ignored = 0;    // other group, or older than the last accepted one
+  uint32_t lost = 0;       // missing according to sequence numbers
+  uint32_t timeouts = 0;   // following -> not following transitions
+};
+
+class SyncFollower final {
+ public:
+  // Without a beacon for this long the follower stops adopting state and accepts any sequence number again (a
+  // rebooted leader). The clock keeps running on the last servo estimate.
+  static constexpr uint32_t kTimeoutUs = 3000000;
+
+  explicit SyncFollower(uint8_t group = 0) : group_(group) {}
+
+  ClockServo& servo() { return servo_; }
+  const ClockServo& servo() const { return servo_; }
+
+  // Feeds one received datagram read at local_us. Returns true when it was an accepted beacon.
+  bool on_packet(const uint8_t* data, size_t len, uint64_t local_us) {
+    SyncBeacon b;
+    if (!parse_sync_beacon(data, len, &b)) {
+      ++stats_.malformed;
+      return false;
+    }
+    const bool following_now = following(local_us);
+    if (!following_now && has_state_) {
+      ++stats_.timeouts;
+    }
+    if (b.group != group_ ||
+        (following_now && static_cast<int16_t>(b.sequence - last_sequence_) <= 0)) {
+      ++stats_.ignored;
+      return false;
+    }
+    if (following_now) {
+      stats_.lost += static_cast<uint16_t>(b.sequence - last_sequence_ - 1U);
+    }
+    last_sequence_ = b.sequence;
+    last_beacon_local_us_ = local_us;
+    has_state_ = true;
+    state_ = b.state;
+    ++stats_.beacons;
+    servo_.on_sample(b.leader_us, local_us);
+    return true;
+  }
+
+  bool locked() const { return servo_.locked(); }
+  bool following(uint64_t local_us) const {
+    return has_state_ && local_us - last_beacon_local_us_ < kTimeoutUs;
+  }
+  // Latest leader state (valid once a beacon was accepted).
+  bool has_state() const { return has_state_; }
+  const SyncState& state() const { return state_; }
+
+  uint64_t now_us(uint64_t local_us) const { return servo_.remote_us(local_us); }
+
+  // The leader's millisecond clock. It never runs backwards between servo steps: slewing can pull the estimate
+  // back by a fraction of a ms, which would otherwise show up as a negative frame dt.
+  uint32_t now_ms(uint64_t local_us) {
+    uint32_t ms = static_cast<uint32_t>(now_us(local_us) / 1000U);
+    if (ms_valid_ && ms_steps_ == servo_.steps() && static_cast<int32_t>(ms - last_ms_) < 0) {
+      ms = last_ms_;
+    }
+    ms_valid_ = true;
+    ms_steps_ = servo_.steps();
+    last_ms_ = ms;
+    return ms;
+  }
+
+  // True once after each servo step (first lock, leader reboot): the ms clock jumped, so schedulers must be
+  // reset onto it.
+  bool take_clock_step() {
+    if (servo_.steps() == seen_steps_) {
+      return false;
+    }
+    seen_steps_ = servo_.steps();
+    return true;
+  }
+
+  const SyncFollowerStats& stats() const { return stats_; }
+
+ private:
+  uint8_t group_ = 0;
+  ClockServo servo_;
+  SyncState state_;
+  bool has_state_ = false;
+  uint16_t last_sequence_ = 0;
+  uint64_t last_beacon_local_us_ = 0;
+  SyncFollowerStats stats_;
+  bool ms_valid_ = false;
+  uint32_t ms_steps_ = 0;
+  uint32_t last_ms_ = 0;
+  uint32_t seen_steps_ = 0;
+};
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../effects/effect_id.h"
+#include "../effects/params.h"
+
+namespace chromance {
+namespace core {
+
+// Compact binary parameter-update frame carried by the persistent control channel.
+//
+// Layout (little-endian):
+//   [0]      message type (kParamFrameSet)
+//   [1..2]   effect id (u16)
+//   [3]      record count N
+//   [4..]    N records of { param id (u16), raw value (i32) }
+//
+// Raw values are firmware units (already multiplied by ParamDescriptor::scale; colors packed 0xRRGGBB).
+static constexpr uint8_t kParamFrameSet = 0x01;
+static constexpr size_t kParamFrameHeaderBytes = 4;
+static constexpr size_t kParamFrameRecordBytes = 6;
+
+struct ParamUpdate {
+  EffectId effect;
+  ParamId param;
+  int32_t raw;
+};
+
+inline uint16_t param_frame_read_u16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (static_cast<uint16_t>(p[1]) << 8));
+}
+
+inline int32_t param_frame_read_i32(const uint8_t* p) {
+  const uint32_t u = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                     (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+  return static_cast<int32_t>(u);
+}
+
+// Decodes a frame into out[0..out_cap). Returns the number of updates written, or -1 if malformed.
+// Records with a zero effect/param id are skipped rather than failing the whole frame.
+inline int decode_param_frame(const uint8_t* data, size_t len, ParamUpdate* out, size_t out_cap) {
+  if (data == nullptr || len < kParamFrameHeaderBytes || data[0] != kParamFrameSet) {
+    return -1;
+  }
+  const uint16_t effect = param_frame_read_u16(data + 1);
+  const size_t count = data[3];
+  if (len != kParamFrameHeaderBytes + count * kParamFrameRecordBytes) {
+    return -1;
+  }
+  if (effect == 0) {
+    return 0;
+  }
+
+  int written = 0;
+  const uint8_t* p = data + kParamFrameHeaderBytes;
+  for (size_t i = 0; i < count; ++i, p += kParamFrameRecordBytes) {
+    const uint16_t pid = param_frame_read_u16(p);
+    if (pid == 0 || out == nullptr || static_cast<size_t>(written) >= out_cap) {
+      continue;
+    }
+    out[written].effect = EffectId{effect};
+    out[written].param = ParamId{pid};
+    out[written].raw = param_frame_read_i32(p + 2);
+    ++written;
+  }
+  return written;
+}
+
+// Encodes a single-effect frame. Returns bytes written, or 0 if out is too small.
+inline size_t encode_param_frame(EffectId effect, const ParamUpdate* updates, uint8_t count, uint8_t* out,
+                                 size_t out_size) {
+  const size_t need = kParamFrameHeaderBytes + static_cast<size_t>(count) * kParamFrameRecordBytes;
+  if (out == nullptr || out_size < need || (count > 0 && updates == nullptr)) {
+    return 0;
+  }
+  out[0] = kParamFrameSet;
+  out[1] = static_cast<uint8_t>(effect.value & 0xFF);
+  out[2] = static_cast<uint8_t>(effect.value >> 8);
+  out[3] = count;
+  uint8_t* p = out + kParamFrameHeaderBytes;
+  for (uint8_t i = 0; i < count; ++i, p += kParamFrameRecordBytes) {
+    const uint32_t raw = static_cast<uint32_t>(updates[i].raw);
+    p[0] = static_cast<uint8_t>(updates[i].param.value & 0xFF);
+    p[1] = static_cast<uint8_t>(updates[i].param.value >> 8);
+    p[2] = static_cast<uint8_t>(raw & 0xFF);
+    p[3] = static_cast<uint8_t>((raw >> 8) & 0xFF);
+    p[4] = static_cast<uint8_t>((raw >> 16) & 0xFF);
+    p[5] = static_cast<uint8_t>((raw >> 24) & 0xFF);
+  }
+  return need;
+}
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace chromance {
+namespace core {
+
+// Paces the live preview stream for one subscriber.
+//
+// The client picks a target rate; the controller multiplies the interval (x2 per event, up to
+// kMaxBackoff) whenever a frame slot comes due while the previous frame is still draining, and steps back
+// toward the requested rate after kRecoverAfter consecutive frames drained cleanly. Frames are skipped,
+// never queued, so a slow socket costs the renderer nothing.
+class PreviewRateController final {
+ public:
+  static constexpr uint8_t kMaxFps = 30;
+  static constexpr uint8_t kMaxBackoff = 16;
+  static constexpr uint8_t kRecoverAfter = 8;
+
+  void set_target_fps(uint8_t fps, uint32_t now_ms) {
+    fps_ = fps > kMaxFps ? kMaxFps : fps;
+    backoff_ = 1;
+    clean_ = 0;
+    next_ms_ = now_ms;
+  }
+
+  bool enabled() const { return fps_ != 0; }
+  uint8_t target_fps() const { return fps_; }
+  uint8_t backoff() const { return backoff_; }
+  uint32_t skipped() const { return skipped_; }
+
+  uint32_t interval_ms() const {
+    if (fps_ == 0) return 0;
+    return (1000U / fps_) * backoff_;
+  }
+
+  // True when a frame should be encoded and queued at now_ms. link_busy reports that the previous frame has
+  // not fully left the socket yet.
+  bool due(uint32_t now_ms, bool link_busy) {
+    if (fps_ == 0 || static_cast<int32_t>(now_ms - next_ms_) < 0) {
+      return false;
+    }
+    if (link_busy) {
+      ++skipped_;
+      clean_ = 0;
+      backoff_ = static_cast<uint8_t>(backoff_ >= kMaxBackoff / 2 ? kMaxBackoff : backoff_ * 2);
+      next_ms_ = now_ms + interval_ms();
+      return false;
+    }
+    return true;
+  }
+
+  void on_frame_queued(uint32_t now_ms) { next_ms_ = now_ms + interval_ms(); }
+
+  void on_frame_drained() {
+    if (backoff_ <= 1) {
+      return;
+    }
+    if (++clean_ >= kRecoverAfter) {
+      clean_ = 0;
+      backoff_ = static_cast<uint8_t>(backoff_ / 2);
+    }
+  }
+
+ private:
+  uint8_t fps_ = 0;
+  uint8_t backoff_ = 1;
+  uint8_t clean_ = 0;
+  uint32_t next_ms_ = 0;
+  uint32_t skipped_ = 0;
+};
+
+}  // namespace core
+}  // namespace chromance
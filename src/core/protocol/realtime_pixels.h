@@ -0,0 +1,392 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../types.h"
+
+namespace chromance {
+namespace core {
+
+// Realtime pixel input (DDP, E1.31/sACN, Art-Net) for driving the panel from a show controller.
+//
+// Packets are parsed in place and their channel data is copied straight into the render framebuffer; there is
+// no intermediate frame. Two channel layouts are supported:
+//   kGlobalIndex  channel c -> LED c/3 (global index order of the generated mapping)
+//   kRaster       channel c -> cell c/3 of the width x height raster (ledmap.json order); empty cells are
+//                 ignored
+// Universe protocols pack 170 pixels (510 channels) per universe, starting at the configured start universe.
+//
+// A frame is complete on DDP PUSH, on E1.31 universe sync / ArtSync when the sender uses them, or otherwise
+// when the last universe of the layout arrives. With no valid data for timeout_ms the receiver goes inactive
+// and the caller falls back to the active effect.
+static constexpr uint16_t kDdpPort = 4048;
+static constexpr uint16_t kE131Port = 5568;
+static constexpr uint16_t kArtNetPort = 6454;
+
+enum class RealtimeProtocol : uint8_t { kDdp, kE131, kArtNet };
+enum class RealtimeLayout : uint8_t { kGlobalIndex = 0, kRaster = 1 };
+
+struct RealtimeFramebuffer {
+  Rgb* pixels = nullptr;
+  uint16_t count = 0;
+
+  // Raster layout only.
+  uint16_t width = 0;
+  uint16_t height = 0;
+  const int16_t* x = nullptr;
+  const int16_t* y = nullptr;
+  const uint16_t* raster_order = nullptr;  // LED indices sorted by (y, x); see PixelsMap::build_scan_order()
+};
+
+struct RealtimeConfig {
+  RealtimeLayout layout = RealtimeLayout::kGlobalIndex;
+  uint16_t e131_start_universe = 1;
+  uint16_t artnet_start_universe = 0;
+  uint16_t timeout_ms = 2500;
+};
+
+struct RealtimeStats {
+  uint32_t packets = 0;    // well-formed packets addressed to us
+  uint32_t frames = 0;     // completed frames
+  uint32_t malformed = 0;
+  uint32_t ignored = 0;    // well-formed but not for us (other universe, query, preview data, stale sequence)
+  uint32_t lost = 0;       // packets missing according to sequence numbers
+  uint32_t timeouts = 0;   // active -> inactive transitions
+  uint16_t last_assembly_ms = 0;  // first packet of a frame -> frame complete
+  uint16_t max_assembly_ms = 0;
+  uint16_t last_display_ms = 0;   // frame complete -> shown (reported by the caller)
+  uint16_t max_display_ms = 0;
+};
+
+static_assert(sizeof(Rgb) == 3, "realtime input writes channel data directly into Rgb framebuffers");
+
+class RealtimeReceiver final {
+ public:
+  static constexpr uint16_t kChannelsPerUniverse = 510;
+  static constexpr uint16_t kMaxUniverses = 128;
+  static constexpr uint16_t kSyncHoldMs = 4000;  // Art-Net: fall back to unsynced output after 4s without ArtSync
+
+  static constexpr size_t kDdpHeaderBytes = 10;
+  static constexpr size_t kDdpTimecodeBytes = 4;
+  static constexpr size_t kE131DataOffset = 126;
+  static constexpr size_t kE131SyncBytes = 49;
+  static constexpr size_t kArtNetDmxOffset = 18;
+
+  void begin(const RealtimeFramebuffer& fb, const RealtimeConfig& cfg) {
+    fb_ = fb;
+    cfg_ = cfg;
+    channels_ = 0;
+    if (fb_.pixels != nullptr) {
+      const uint32_t cells =
+          cfg_.layout == RealtimeLayout::kRaster ? static_cast<uint32_t>(fb_.width) * fb_.height : fb_.count;
+      channels_ = cells * 3U;
+    }
+    const bool raster_ready = fb_.x != nullptr && fb_.y != nullptr && fb_.raster_order != nullptr;
+    if (cfg_.layout == RealtimeLayout::kRaster && !raster_ready) {
+      channels_ = 0;
+    }
+    uint32_t universes = (channels_ + kChannelsPerUniverse - 1U) / kChannelsPerUniverse;
+    if (universes > kMaxUniverses) universes = kMaxUniverses;
+    universe_count_ = static_cast<uint16_t>(universes);
+    reset();
+  }
+
+  void reset() {
+    stats_ = RealtimeStats{};
+    active_ = false;
+    assembling_ = false;
+    frame_ready_ = false;
+    ddp_seq_ = 0;
+    e131_sync_universe_ = 0;
+    artsync_seen_ = false;
+    memset(last_seq_, 0, sizeof(last_seq_));
+    memset(seq_seen_, 0, sizeof(seq_seen_));
+    memset(last_proto_, 0, sizeof(last_proto_));
+  }
+
+  // Returns true if the packet wrote pixels or completed a frame.
+  bool on_packet(RealtimeProtocol proto, const uint8_t* data, size_t len, uint32_t now_ms) {
+    if (data == nullptr || channels_ == 0) {
+      return false;
+    }
+    switch (proto) {
+      case RealtimeProtocol::kDdp:
+        return on_ddp(data, len, now_ms);
+      case RealtimeProtocol::kE131:
+        return on_e131(data, len, now_ms);
+      case RealtimeProtocol::kArtNet:
+        return on_artnet(data, len, now_ms);
+    }
+    return false;
+  }
+
+  // True while a sender has produced data within timeout_ms; expiry is counted once.
+  bool active(uint32_t now_ms) {
+    if (active_ && static_cast<int32_t>(now_ms - last_packet_ms_) >= static_cast<int32_t>(cfg_.timeout_ms)) {
+      active_ = false;
+      assembling_ = false;
+      frame_ready_ = false;
+      ++stats_.timeouts;
+    }
+    return active_;
+  }
+
+  // Returns true once per completed frame; the framebuffer then holds the frame to show.
+  bool take_frame() {
+    if (!frame_ready_) return false;
+    frame_ready_ = false;
+    return true;
+  }
+
+  void on_frame_shown(uint32_t now_ms) {
+    const uint16_t ms = clamp_ms(now_ms - ready_ms_);
+    stats_.last_display_ms = ms;
+    if (ms > stats_.max_display_ms) stats_.max_display_ms = ms;
+  }
+
+  const RealtimeStats& stats() const { return stats_; }
+  uint32_t channel_count() const { return channels_; }
+  uint16_t universe_count() const { return universe_count_; }
+
+ private:
+  static uint16_t read_be16(const uint8_t* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+  static uint32_t read_be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+  }
+  static uint16_t clamp_ms(uint32_t ms) { return ms > 0xFFFFU ? 0xFFFFU : static_cast<uint16_t>(ms); }
+
+  bool malformed() {
+    ++stats_.malformed;
+    return false;
+  }
+  bool ignored() {
+    ++stats_.ignored;
+    return false;
+  }
+
+  bool on_ddp(const uint8_t* p, size_t len, uint32_t now_ms) {
+    if (len < kDdpHeaderBytes) return malformed();
+    const uint8_t flags = p[0];
+    if ((flags >> 6) != 1) return malformed();  // protocol version 1
+    if ((flags & 0x0E) != 0) return ignored();  // query, reply or storage: not pixel data
+    const uint8_t type = p[2];
+    if (type != 0 && (type & 0x3F) != 0x0B) return ignored();  // only RGB, 8 bits per channel
+    const uint8_t dest = p[3];
+    if (dest != 0 && dest != 1) return ignored();  // default output only
+
+    const size_t header = kDdpHeaderBytes + ((flags & 0x10) != 0 ? kDdpTimecodeBytes : 0);
+    const uint32_t offset = read_be32(p + 4);
+    const uint16_t n = read_be16(p + 8);
+    if (len < header + n) return malformed();
+
+    // 4-bit sequence, 1..15; 0 means the sender does not number packets.
+    const uint8_t seq = static_cast<uint8_t>(p[1] & 0x0F);
+    if (seq != 0 && ddp_seq_ != 0) {
+      const uint8_t step = static_cast<uint8_t>((seq + 15 - ddp_seq_) % 15);
+      if (step > 1) stats_.lost += static_cast<uint32_t>(step - 1U);
+    }
+    ddp_seq_ = seq;
+
+    on_data(now_ms);
+    write_channels(offset, p + header, n);
+    const bool reaches_end = offset < channels_ && n >= channels_ - offset;
+    if ((flags & 0x01) != 0 || reaches_end) {
+      complete_frame(now_ms);
+    }
+    return true;
+  }
+
+  bool on_e131(const uint8_t* p, size_t len, uint32_t now_ms) {
+    static constexpr uint8_t kAcnId[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+    if (len < kE131SyncBytes || read_be16(p) != 0x0010 || memcmp(p + 4, kAcnId, sizeof(kAcnId)) != 0) {
+      return malformed();
+    }
+    const uint32_t root_vector = read_be32(p + 18);
+    const uint32_t framing_vector = read_be32(p + 40);
+
+    if (root_vector == 0x00000008 && framing_vector == 0x00000001) {
+      // Universe synchronization.
+      const uint16_t sync = read_be16(p + 45);
+      if (sync == 0 || sync != e131_sync_universe_) return ignored();
+      ++stats_.packets;
+      if (!assembling_) return false;
+      complete_frame(now_ms);
+      return true;
+    }
+    if (root_vector != 0x00000004 || framing_vector != 0x00000002) return ignored();
+    if (len < kE131DataOffset) return malformed();
+    if (p[117] != 0x02 || p[118] != 0xA1) return malformed();
+
+    const uint8_t options = p[112];
+    if ((options & 0x80) != 0) return ignored();  // preview data: not for output
+    if ((options & 0x40) != 0) {
+      // Stream terminated: hand the panel back to the active effect immediately.
+      if (active_) {
+        active_ = false;
+        assembling_ = false;
+        frame_ready_ = false;
+        ++stats_.timeouts;
+      }
+      return ignored();
+    }
+
+    const uint16_t count = read_be16(p + 123);  // start code + channels
+    if (count == 0 || len < kE131DataOffset - 1 + count) return malformed();
+    if (p[125] != 0) return ignored();  // non-zero start codes are not dimmer data
+
+    const uint16_t universe = read_be16(p + 113);
+    const uint16_t sync = read_be16(p + 109);
+    return on_universe(RealtimeProtocol::kE131, universe, cfg_.e131_start_universe, p[111], true, p + 126,
+                       static_cast<size_t>(count - 1U), sync != 0, sync, now_ms);
+  }
+
+  bool on_artnet(const uint8_t* p, size_t len, uint32_t now_ms) {
+    static constexpr uint8_t kArtId[8] = {'A', 'r', 't', '-', 'N', 'e', 't', 0};
+    if (len < 12 || memcmp(p, kArtId, sizeof(kArtId)) != 0) return malformed();
+    const uint16_t opcode = static_cast<uint16_t>(p[8] | (p[9] << 8));
+
+    if (opcode == 0x5200) {  // OpSync
+      artsync_seen_ = true;
+      artsync_ms_ = now_ms;
+      ++stats_.packets;
+      if (!assembling_) return false;
+      complete_frame(now_ms);
+      return true;
+    }
+    if (opcode != 0x5000) return ignored();  // only OpDmx carries pixels
+    if (len < kArtNetDmxOffset) return malformed();
+
+    const uint16_t n = read_be16(p + 16);
+    if (n < 2 || n > 512 || len < kArtNetDmxOffset + n) return malformed();
+
+    const bool synced =
+        artsync_seen_ && static_cast<int32_t>(now_ms - artsync_ms_) < static_cast<int32_t>(kSyncHoldMs);
+    const uint16_t universe = static_cast<uint16_t>(((p[15] & 0x7F) << 8) | p[14]);
+    // Sequence 0 disables sequencing.
+    return on_universe(RealtimeProtocol::kArtNet, universe, cfg_.artnet_start_universe, p[12], p[12] != 0,
+                       p + kArtNetDmxOffset, n, synced, 0, now_ms);
+  }
+
+  bool on_universe(RealtimeProtocol proto,
+                   uint16_t universe,
+                   uint16_t start,
+                   uint8_t seq,
+                   bool seq_valid,
+                   const uint8_t* dmx,
+                   size_t n,
+                   bool hold_for_sync,
+                   uint16_t sync_universe,
+                   uint32_t now_ms) {
+    if (universe < start || universe - start >= universe_count_) return ignored();
+    const uint16_t idx = static_cast<uint16_t>(universe - start);
+
+    if (seq_valid) {
+      if (seq_seen_[idx] && last_proto_[idx] == static_cast<uint8_t>(proto)) {
+        // E1.31 6.7.2: discard packets within 20 behind the last accepted one (late/duplicate).
+        const int8_t d = static_cast<int8_t>(seq - last_seq_[idx]);
+        if (d <= 0 && d > -20) return ignored();
+        if (d > 1) stats_.lost += static_cast<uint32_t>(d - 1);
+      }
+      seq_seen_[idx] = 1;
+      last_seq_[idx] = seq;
+      last_proto_[idx] = static_cast<uint8_t>(proto);
+    }
+
+    if (proto == RealtimeProtocol::kE131) {
+      e131_sync_universe_ = sync_universe;
+    }
+
+    on_data(now_ms);
+    if (n > kChannelsPerUniverse) n = kChannelsPerUniverse;
+    write_channels(static_cast<uint32_t>(idx) * kChannelsPerUniverse, dmx, n);
+    if (!hold_for_sync && idx + 1U == universe_count_) {
+      complete_frame(now_ms);
+    }
+    return true;
+  }
+
+  void on_data(uint32_t now_ms) {
+    ++stats_.packets;
+    last_packet_ms_ = now_ms;
+    active_ = true;
+    if (!assembling_) {
+      assembling_ = true;
+      frame_start_ms_ = now_ms;
+    }
+  }
+
+  void complete_frame(uint32_t now_ms) {
+    const uint16_t ms = clamp_ms(now_ms - frame_start_ms_);
+    stats_.last_assembly_ms = ms;
+    if (ms > stats_.max_assembly_ms) stats_.max_assembly_ms = ms;
+    ++stats_.frames;
+    assembling_ = false;
+    frame_ready_ = true;
+    ready_ms_ = now_ms;
+  }
+
+  void write_channels(uint32_t offset, const uint8_t* src, size_t n) {
+    if (offset >= channels_ || n == 0) return;
+    if (n > channels_ - offset) n = channels_ - offset;
+
+    uint8_t* dst = reinterpret_cast<uint8_t*>(fb_.pixels);
+    if (cfg_.layout == RealtimeLayout::kGlobalIndex) {
+      memcpy(dst + offset, src, n);
+      return;
+    }
+
+    // Raster: walk LEDs in raster order from the first cell overlapping [offset, offset + n).
+    const uint32_t end = offset + static_cast<uint32_t>(n);
+    const uint32_t first_cell = offset / 3U;
+    size_t lo = 0;
+    size_t hi = fb_.count;
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (cell_of(fb_.raster_order[mid]) < first_cell) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    for (size_t k = lo; k < fb_.count; ++k) {
+      const uint16_t led = fb_.raster_order[k];
+      const uint32_t base = cell_of(led) * 3U;
+      if (base >= end) break;
+      for (uint32_t c = 0; c < 3; ++c) {
+        const uint32_t ch = base + c;
+        if (ch >= offset && ch < end) dst[led * 3U + c] = src[ch - offset];
+      }
+    }
+  }
+
+  uint32_t cell_of(uint16_t led) const {
+    return static_cast<uint32_t>(fb_.y[led]) * fb_.width + static_cast<uint32_t>(fb_.x[led]);
+  }
+
+  RealtimeFramebuffer fb_;
+  RealtimeConfig cfg_;
+  RealtimeStats stats_;
+  uint32_t channels_ = 0;
+  uint16_t universe_count_ = 0;
+
+  bool active_ = false;
+  bool assembling_ = false;
+  bool frame_ready_ = false;
+  uint32_t last_packet_ms_ = 0;
+  uint32_t frame_start_ms_ = 0;
+  uint32_t ready_ms_ = 0;
+
+  uint8_t ddp_seq_ = 0;
+  uint16_t e131_sync_universe_ = 0;
+  bool artsync_seen_ = false;
+  uint32_t artsync_ms_ = 0;
+  uint8_t last_seq_[kMaxUniverses] = {};
+  uint8_t last_proto_[kMaxUniverses] = {};
+  uint8_t seq_seen_[kMaxUniverses] = {};
+};
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../types.h"
+
+namespace chromance {
+namespace core {
+
+// Framed binary framebuffer stream over the USB serial port (Adalight-style header plus CRC).
+//
+// Frame layout:
+//   [0..2]  'A' 'd' 'a'
+//   [3..4]  led count - 1 (u16, big-endian)
+//   [5]     header checksum: byte3 ^ byte4 ^ 0x55
+//   [6..]   led count x RGB
+//   [+0..1] CRC-16/CCITT-FALSE over the RGB payload (big-endian)
+//
+// Bytes outside a frame are passed through to the single-character command handler, so the existing serial
+// console keeps working on the same port.
+static constexpr uint8_t kSerialFrameMagic[3] = {'A', 'd', 'a'};
+static constexpr size_t kSerialFrameHeaderBytes = 6;
+static constexpr size_t kSerialFrameCrcBytes = 2;
+
+inline uint16_t crc16_ccitt_update(uint16_t crc, const uint8_t* data, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    crc = static_cast<uint16_t>(crc ^ (static_cast<uint16_t>(data[i]) << 8));
+    for (uint8_t b = 0; b < 8; ++b) {
+      crc = (crc & 0x8000U) != 0 ? static_cast<uint16_t>((crc << 1) ^ 0x1021U) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+struct SerialFrameStats {
+  uint32_t frames = 0;         // frames with a valid CRC
+  uint32_t crc_errors = 0;
+  uint32_t header_errors = 0;  // bad header checksum or led count
+  uint32_t overruns = 0;       // a ready frame was replaced before the render loop took it
+  uint32_t aborted = 0;        // partial frames dropped after an inter-byte gap
+  uint32_t passthrough = 0;    // command bytes handed back to the caller
+};
+
+// Double-buffered receiver. The payload of the frame in flight is copied straight into one buffer; when its CRC
+// checks out the buffers swap and the render loop picks the new frame up at its next tick via take_frame().
+template <size_t MaxLeds>
+class SerialFrameReceiver final {
+ public:
+  static constexpr uint32_t kInterByteTimeoutMs = 100;
+
+  explicit SerialFrameReceiver(uint16_t led_count = static_cast<uint16_t>(MaxLeds))
+      : led_count_(led_count > MaxLeds ? static_cast<uint16_t>(MaxLeds) : led_count) {}
+
+  // Consumes len bytes. Bytes that are not part of a frame are copied to passthrough (up to passthrough_cap;
+  // excess is dropped) and their count is returned.
+  size_t feed(const uint8_t* data, size_t len, uint8_t* passthrough, size_t passthrough_cap, uint32_t now_ms) {
+    size_t out = 0;
+    if (data == nullptr || len == 0) {
+      return 0;
+    }
+    const bool stalled =
+        static_cast<int32_t>(now_ms - last_byte_ms_) >= static_cast<int32_t>(kInterByteTimeoutMs);
+    if (state_ != State::kMagic && stalled) {
+      ++stats_.aborted;
+      state_ = State::kMagic;
+      pos_ = 0;
+    }
+    last_byte_ms_ = now_ms;
+
+    size_t i = 0;
+    while (i < len) {
+      switch (state_) {
+        case State::kMagic: {
+          const uint8_t b = data[i++];
+          if (b == kSerialFrameMagic[pos_]) {
+            header_[pos_++] = b;
+            if (pos_ == sizeof(kSerialFrameMagic)) state_ = State::kHeader;
+            break;
+          }
+          // Not a frame after all: release whatever prefix was held, then retry this byte as a new start.
+          for (size_t k = 0; k < pos_; ++k) out = emit(header_[k], passthrough, passthrough_cap, out);
+          pos_ = 0;
+          if (b == kSerialFrameMagic[0]) {
+            header_[pos_++] = b;
+          } else {
+            out = emit(b, passthrough, passthrough_cap, out);
+          }
+          break;
+        }
+        case State::kHeader: {
+          header_[pos_++] = data[i++];
+          if (pos_ < kSerialFrameHeaderBytes) break;
+          const uint8_t hi = header_[3];
+          const uint8_t lo = header_[4];
+          const uint16_t count = static_cast<uint16_t>(((hi << 8) | lo) + 1U);
+          if (header_[5] != static_cast<uint8_t>(hi ^ lo ^ 0x55U) || count != led_count_) {
+            ++stats_.header_errors;
+            state_ = State::kMagic;
+            pos_ = 0;
+            break;
+          }
+          state_ = State::kPayload;
+          pos_ = 0;
+          break;
+        }
+        case State::kPayload: {
+          const size_t want = static_cast<size_t>(led_count_) * 3U - pos_;
+          const size_t take = (len - i) < want ? (len - i) : want;
+          memcpy(reinterpret_cast<uint8_t*>(buffers_[fill_]) + pos_, data + i, take);
+          pos_ += take;
+          i += take;
+          if (pos_ == static_cast<size_t>(led_count_) * 3U) {
+            state_ = State::kCrc;
+            pos_ = 0;
+          }
+          break;
+        }
+        case State::kCrc: {
+          crc_[pos_++] = data[i++];
+          if (pos_ < kSerialFrameCrcBytes) break;
+          const uint16_t expected = static_cast<uint16_t>((crc_[0] << 8) | crc_[1]);
+          const uint16_t actual =
+              crc16_ccitt_update(0xFFFF, reinterpret_cast<const uint8_t*>(buffers_[fill_]), led_count_ * 3U);
+          if (expected == actual) {
+            publish();
+          } else {
+            ++stats_.crc_errors;
+          }
+          state_ = State::kMagic;
+          pos_ = 0;
+          break;
+        }
+      }
+    }
+    return out;
+  }
+
+  // Returns the newest complete frame (led_count() pixels) once, or nullptr. The pointer stays valid until the
+  // next feed() that completes another frame.
+  const Rgb* take_frame() {
+    if (!ready_) return nullptr;
+    ready_ = false;
+    return buffers_[fill_ ^ 1U];
+  }
+
+  bool frame_ready() const { return ready_; }
+  bool receiving() const { return state_ != State::kMagic; }
+  uint16_t led_count() const { return led_count_; }
+  uint32_t last_frame_ms() const { return last_frame_ms_; }
+  const SerialFrameStats& stats() const { return stats_; }
+
+ private:
+  enum class State : uint8_t { kMagic, kHeader, kPayload, kCrc };
+
+  size_t emit(uint8_t b, uint8_t* passthrough, size_t cap, size_t out) {
+    ++stats_.passthrough;
+    if (passthrough != nullptr && out < cap) passthrough[out++] = b;
+    return out;
+  }
+
+  void publish() {
+    if (ready_) ++stats_.overruns;
+    ++stats_.frames;
+    ready_ = true;
+    last_frame_ms_ = last_byte_ms_;
+    fill_ ^= 1U;
+  }
+
+  uint16_t led_count_;
+  Rgb buffers_[2][MaxLeds] = {};
+  uint8_t fill_ = 0;
+  bool ready_ = false;
+
+  State state_ = State::kMagic;
+  size_t pos_ = 0;
+  uint8_t header_[kSerialFrameHeaderBytes] = {};
+  uint8_t crc_[kSerialFrameCrcBytes] = {};
+  uint32_t last_byte_ms_ = 0;
+  uint32_t last_frame_ms_ = 0;
+  SerialFrameStats stats_;
+};
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace chromance {
+namespace core {
+
+// Minimal RFC 6455 framing for the device-side end of a WebSocket.
+//
+// Scope is intentionally narrow: single-frame (FIN) messages only, client frames must be masked,
+// payloads are bounded by MaxPayload. Anything else is a protocol error and the caller closes.
+enum class WsOpcode : uint8_t {
+  kContinuation = 0x0,
+  kText = 0x1,
+  kBinary = 0x2,
+  kClose = 0x8,
+  kPing = 0x9,
+  kPong = 0xA,
+};
+
+// Writes an unmasked server->client frame header. out must hold at least 10 bytes.
+inline size_t ws_write_header(WsOpcode opcode, size_t payload_len, uint8_t* out) {
+  out[0] = static_cast<uint8_t>(0x80 | static_cast<uint8_t>(opcode));
+  if (payload_len < 126) {
+    out[1] = static_cast<uint8_t>(payload_len);
+    return 2;
+  }
+  if (payload_len <= 0xFFFF) {
+    out[1] = 126;
+    out[2] = static_cast<uint8_t>((payload_len >> 8) & 0xFF);
+    out[3] = static_cast<uint8_t>(payload_len & 0xFF);
+    return 4;
+  }
+  out[1] = 127;
+  const uint64_t n = static_cast<uint64_t>(payload_len);
+  for (int i = 0; i < 8; ++i) {
+    out[2 + i] = static_cast<uint8_t>((n >> (56 - 8 * i)) & 0xFF);
+  }
+  return 10;
+}
+
+template <size_t MaxPayload>
+class WsFrameReader final {
+ public:
+  enum class Result : uint8_t { kNeedMore, kFrame, kError };
+
+  void reset() {
+    header_len_ = 0;
+    header_need_ = 2;
+    payload_len_ = 0;
+    payload_got_ = 0;
+    in_payload_ = false;
+  }
+
+  // Consumes bytes until one complete frame is available (kFrame), input is exhausted (kNeedMore), or the
+  // stream violates the supported subset (kError). *consumed reports how many bytes were taken.
+  Result feed(const uint8_t* data, size_t len, size_t* consumed) {
+    size_t used = 0;
+    while (used < len) {
+      if (!in_payload_) {
+        header_[header_len_++] = data[used++];
+        if (header_len_ == 2) {
+          const bool fin = (header_[0] & 0x80) != 0;
+          const bool masked = (header_[1] & 0x80) != 0;
+          if (!fin || !masked || (header_[0] & 0x70) != 0) {
+            return finish(Result::kError, used, consumed);
+          }
+          const uint8_t len7 = static_cast<uint8_t>(header_[1] & 0x7F);
+          header_need_ = static_cast<uint8_t>(2 + (len7 == 126 ? 2 : (len7 == 127 ? 8 : 0)) + 4);
+        }
+        if (header_len_ < header_need_) {
+          continue;
+        }
+        if (!parse_header()) {
+          return finish(Result::kError, used, consumed);
+        }
+        in_payload_ = true;
+        payload_got_ = 0;
+        if (payload_len_ == 0) {
+          return complete(used, consumed);
+        }
+        continue;
+      }
+
+      const size_t want = payload_len_ - payload_got_;
+      const size_t avail = len - used;
+      const size_t take = avail < want ? avail : want;
+      for (size_t i = 0; i < take; ++i) {
+        payload_[payload_got_ + i] = static_cast<uint8_t>(data[used + i] ^ mask_[(payload_got_ + i) & 3]);
+      }
+      payload_got_ += take;
+      used += take;
+      if (payload_got_ == payload_len_) {
+        return complete(used, consumed);
+      }
+    }
+    return finish(Result::kNeedMore, used, consumed);
+  }
+
+  WsOpcode opcode() const { return opcode_; }
+  const uint8_t* payload() const { return payload_; }
+  size_t payload_len() const { return payload_len_; }
+
+ private:
+  bool parse_header() {
+    opcode_ = static_cast<WsOpcode>(header_[0] & 0x0F);
+    const uint8_t len7 = static_cast<uint8_t>(header_[1] & 0x7F);
+    size_t pos = 2;
+    uint64_t n = len7;
+    if (len7 == 126) {
+      n = (static_cast<uint64_t>(header_[2]) << 8) | header_[3];
+      pos = 4;
+    } else if (len7 == 127) {
+      n = 0;
+      for (int i = 0; i < 8; ++i) {
+        n = (n << 8) | header_[2 + i];
+      }
+      pos = 10;
+    }
+    memcpy(mask_, header_ + pos, 4);
+
+    switch (opcode_) {
+      case WsOpcode::kText:
+      case WsOpcode::kBinary:
+        break;
+      case WsOpcode::kClose:
+      case WsOpcode::kPing:
+      case WsOpcode::kPong:
+        if (n > 125) return false;  // control frames are capped by the RFC
+        break;
+      default:
+        return false;  // continuation frames (fragmentation) are not supported
+    }
+    if (n > MaxPayload) {
+      return false;
+    }
+    payload_len_ = static_cast<size_t>(n);
+    return true;
+  }
+
+  Result complete(size_t used, size_t* consumed) {
+    header_len_ = 0;
+    header_need_ = 2;
+    in_payload_ = false;
+    return finish(Result::kFrame, used, consumed);
+  }
+
+  static Result finish(Result r, size_t used, size_t* consumed) {
+    if (consumed != nullptr) {
+      *consumed = used;
+    }
+    return r;
+  }
+
+  uint8_t header_[14] = {};
+  uint8_t header_len_ = 0;
+  uint8_t header_need_ = 2;
+  uint8_t mask_[4] = {};
+  WsOpcode opcode_ = WsOpcode::kBinary;
+  bool in_payload_ = false;
+  size_t payload_len_ = 0;
+  size_t payload_got_ = 0;
+  uint8_t payload_[MaxPayload] = {};
+};
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+
+namespace chromance {
+namespace core {
+
+// Lock-free latest-value cell for one writer and any number of readers on other tasks or cores (sequence
+// lock). The writer never blocks; a reader that overlaps a write retries, and gives up after
+// kMaxReadAttempts so it cannot spin behind a writer on the same core. T must be trivially copyable; it is
+// stored as 32-bit atomic words so no access is a data race.
+template <typename T>
+class SeqLockSnapshot final {
+ public:
+  static constexpr uint8_t kMaxReadAttempts = 4;
+
+  void write(const T& value) {
+    uint32_t words[kWords] = {};
+    memcpy(words, &value, sizeof(T));
+    const uint32_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1U, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; ++i) words_[i].store(words[i], std::memory_order_relaxed);
+    seq_.store(seq + 2U, std::memory_order_release);
+  }
+
+  // False when nothing was written yet or every attempt overlapped a write; *out is unchanged then.
+  bool read(T* out) const {
+    if (out == nullptr) {
+      return false;
+    }
+    for (uint8_t attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+      const uint32_t before = seq_.load(std::memory_order_acquire);
+      if (before == 0) return false;
+      if (before & 1U) continue;
+      uint32_t words[kWords];
+      for (size_t i = 0; i < kWords; ++i) words[i] = words_[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == before) {
+        memcpy(out, words, sizeof(T));
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Completed writes so far.
+  uint32_t version() const { return seq_.load(std::memory_order_acquire) / 2U; }
+
+ private:
+  static constexpr size_t kWords = (sizeof(T) + 3U) / 4U;
+
+  std::atomic<uint32_t> seq_{0};
+  std::atomic<uint32_t> words_[kWords] = {};
+};
+
+}  // namespace core
+}  // namespace chromance
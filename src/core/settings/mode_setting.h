@@ -9,8 +9,12 @@ namespace core {
 
 class ModeSetting {
  public:
-  void begin(IKeyValueStore& store, const char* key, uint8_t default_mode) {
-    const uint8_t fallback = sanitize(default_mode);
+  static constexpr uint8_t kDefaultMaxMode = 9;
+
+  // max_mode bounds the persisted mode; pass the effect catalog capacity when installations add effects.
+  void begin(IKeyValueStore& store, const char* key, uint8_t default_mode, uint8_t max_mode = kDefaultMaxMode) {
+    max_mode_ = max_mode < 1 ? 1 : max_mode;
+    const uint8_t fallback = sanitize(default_mode, max_mode_);
     uint8_t raw = fallback;
     if (key != nullptr) {
       uint8_t v = 0;
@@ -19,7 +23,7 @@ class ModeSetting {
       }
     }
 
-    mode_ = sanitize(raw);
+    mode_ = sanitize(raw, max_mode_);
     if (key != nullptr) {
       (void)store.write_u8(key, mode_);
     }
@@ -28,22 +32,25 @@ class ModeSetting {
   uint8_t mode() const { return mode_; }
 
   void set_mode(IKeyValueStore& store, const char* key, uint8_t mode) {
-    mode_ = sanitize(mode);
+    mode_ = sanitize(mode, max_mode_);
     if (key != nullptr) {
       (void)store.write_u8(key, mode_);
     }
   }
 
-  static uint8_t sanitize(uint8_t mode) {
+  uint8_t max_mode() const { return max_mode_; }
+
+  static uint8_t sanitize(uint8_t mode, uint8_t max_mode = kDefaultMaxMode) {
     // Runtime patterns are bound to numeric modes for persistence.
     // Keep this range check conservative to avoid bricking the control path.
     if (mode < 1) return 1;
-    if (mode > 7) return 1;
+    if (mode > max_mode) return 1;
     return mode;
   }
 
  private:
   uint8_t mode_ = 1;
+  uint8_t max_mode_ = kDefaultMaxMode;
 };
 
 }  // namespace core
@@ -0,0 +1,345 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../effects/effect_params.h"
+#include "../effects/effect_v2.h"
+#include "../effects/modulation_provider.h"
+#include "../settings/effect_config_store.h"
+#include "../types.h"
+
+namespace chromance {
+namespace core {
+
+// RAM-backed ISettingsStore with the same contract as the NVS store (whole blobs, exact-size reads). Counts
+// writes so a run can report persistence churn.
+template <size_t MaxKeys, size_t MaxBlobBytes = 512>
+class MemorySettingsStore final : public ISettingsStore {
+ public:
+  static constexpr size_t kMaxKeyBytes = 16;  // NVS key limit (15 chars)
+
+  bool read_blob(const char* key, void* out, size_t out_size) const override {
+    const Slot* s = find(key);
+    if (s == nullptr || out == nullptr || s->size != out_size) {
+      return false;
+    }
+    memcpy(out, s->data, out_size);
+    return true;
+  }
+
+  bool write_blob(const char* key, const void* data, size_t size) override {
+    if (key == nullptr || data == nullptr || size == 0 || size > MaxBlobBytes || strlen(key) >= kMaxKeyBytes) {
+      return false;
+    }
+    Slot* s = const_cast<Slot*>(find(key));
+    if (s == nullptr) {
+      if (used_ >= MaxKeys) {
+        return false;
+      }
+      s = &slots_[used_++];
+      strcpy(s->key, key);
+    }
+    memcpy(s->data, data, size);
+    s->size = size;
+    ++writes_;
+    return true;
+  }
+
+  size_t key_count() const { return used_; }
+  uint32_t writes() const { return writes_; }
+
+ private:
+  struct Slot {
+    char key[kMaxKeyBytes];
+    uint8_t data[MaxBlobBytes];
+    size_t size;
+  };
+
+  const Slot* find(const char* key) const {
+    for (size_t i = 0; key != nullptr && i < used_; ++i) {
+      if (strcmp(slots_[i].key, key) == 0) return &slots_[i];
+    }
+    return nullptr;
+  }
+
+  Slot slots_[MaxKeys] = {};
+  size_t used_ = 0;
+  uint32_t writes_ = 0;
+};
+
+// FNV-1a over the framebuffer bytes (r, g, b per LED): the golden-frame fingerprint.
+inline uint32_t frame_hash(const Rgb* rgb, size_t n) {
+  uint32_t h = 2166136261U;
+  for (size_t i = 0; rgb != nullptr && i < n; ++i) {
+    h = (h ^ rgb[i].r) * 16777619U;
+    h = (h ^ rgb[i].g) * 16777619U;
+    h = (h ^ rgb[i].b) * 16777619U;
+  }
+  return h;
+}
+
+// One scripted input, applied by HeadlessRunner at the first frame whose time is >= at_ms.
+struct ScriptEvent {
+  enum class Type : uint8_t { kKey, kActivate, kParam, kBrightness, kRestart };
+
+  uint32_t at_ms = 0;
+  Type type = Type::kKey;
+  Key key = Key::N;
+  uint16_t effect_id = 0;
+  uint16_t param_id = 0;
+  int32_t value = 0;
+};
+
+enum class ScriptLine : uint8_t { kEvent, kBlank, kError };
+
+namespace script_detail {
+
+inline const char* skip_space(const char* p) {
+  while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') ++p;
+  return p;
+}
+
+// Copies the next whitespace-delimited token; false if missing or longer than out_size - 1.
+inline bool next_token(const char** p, char* out, size_t out_size) {
+  const char* s = skip_space(*p);
+  size_t n = 0;
+  while (s[n] != '\0' && s[n] != ' ' && s[n] != '\t' && s[n] != '\r' && s[n] != '\n' && s[n] != '#') ++n;
+  if (n == 0 || n >= out_size) return false;
+  memcpy(out, s, n);
+  out[n] = '\0';
+  *p = s + n;
+  return true;
+}
+
+inline bool parse_i32(const char** p, int32_t* out) {
+  char tok[16];
+  if (!next_token(p, tok, sizeof(tok))) return false;
+  const char* s = tok;
+  const bool neg = *s == '-';
+  if (neg || *s == '+') ++s;
+  if (*s == '\0') return false;
+  int64_t v = 0;
+  for (; *s != '\0'; ++s) {
+    if (*s < '0' || *s > '9') return false;
+    v = v * 10 + (*s - '0');
+    if (v > 0x80000000LL) return false;
+  }
+  v = neg ? -v : v;
+  if (v > 0x7FFFFFFFLL) return false;
+  *out = static_cast<int32_t>(v);
+  return true;
+}
+
+inline bool parse_u32(const char** p, uint32_t max, uint32_t* out) {
+  char tok[16];
+  if (!next_token(p, tok, sizeof(tok))) return false;
+  uint64_t v = 0;
+  for (const char* s = tok; *s != '\0'; ++s) {
+    if (*s < '0' || *s > '9') return false;
+    v = v * 10U + static_cast<uint32_t>(*s - '0');
+    if (v > max) return false;
+  }
+  *out = static_cast<uint32_t>(v);
+  return true;
+}
+
+// Serial command characters of the runtime (main_runtime.cpp handle_command) for effect-scoped keys.
+inline bool parse_key(const char* tok, Key* out) {
+  static const struct {
+    const char* name;
+    Key key;
+  } kKeys[] = {{"1", Key::Digit1}, {"2", Key::Digit2}, {"n", Key::N},   {"N", Key::ShiftN}, {"s", Key::S},
+               {"S", Key::ShiftS}, {"esc", Key::Esc},  {"+", Key::Plus}, {"-", Key::Minus}};
+  for (size_t i = 0; i < sizeof(kKeys) / sizeof(kKeys[0]); ++i) {
+    if (strcmp(tok, kKeys[i].name) == 0) {
+      *out = kKeys[i].key;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace script_detail
+
+// Parses one script line:
+//   <at_ms> key <1|2|n|N|s|S|esc|+|->
+//   <at_ms> activate <effect_id>
+//   <at_ms> restart
+//   <at_ms> param <effect_id> <param_id> <raw>
+//   <at_ms> brightness <0..255>
+// '#' starts a comment; blank and comment-only lines return kBlank. Param values are raw firmware units
+// (EffectManager::set_param_raw()).
+inline ScriptLine parse_script_line(const char* line, ScriptEvent* out) {
+  using namespace script_detail;
+  if (line == nullptr || out == nullptr) return ScriptLine::kError;
+  const char* p = skip_space(line);
+  if (*p == '\0' || *p == '#') return ScriptLine::kBlank;
+
+  ScriptEvent ev;
+  char verb[12];
+  uint32_t u = 0;
+  if (!parse_u32(&p, 0xFFFFFFFFU, &ev.at_ms) || !next_token(&p, verb, sizeof(verb))) return ScriptLine::kError;
+  if (strcmp(verb, "key") == 0) {
+    char tok[4];
+    ev.type = ScriptEvent::Type::kKey;
+    if (!next_token(&p, tok, sizeof(tok)) || !parse_key(tok, &ev.key)) return ScriptLine::kError;
+  } else if (strcmp(verb, "activate") == 0) {
+    ev.type = ScriptEvent::Type::kActivate;
+    if (!parse_u32(&p, 0xFFFF, &u) || u == 0) return ScriptLine::kError;
+    ev.effect_id = static_cast<uint16_t>(u);
+  } else if (strcmp(verb, "restart") == 0) {
+    ev.type = ScriptEvent::Type::kRestart;
+  } else if (strcmp(verb, "param") == 0) {
+    ev.type = ScriptEvent::Type::kParam;
+    if (!parse_u32(&p, 0xFFFF, &u) || u == 0) return ScriptLine::kError;
+    ev.effect_id = static_cast<uint16_t>(u);
+    if (!parse_u32(&p, 0xFFFF, &u) || u == 0) return ScriptLine::kError;
+    ev.param_id = static_cast<uint16_t>(u);
+    if (!parse_i32(&p, &ev.value)) return ScriptLine::kError;
+  } else if (strcmp(verb, "brightness") == 0) {
+    ev.type = ScriptEvent::Type::kBrightness;
+    if (!parse_u32(&p, 255, &u)) return ScriptLine::kError;
+    ev.value = static_cast<int32_t>(u);
+  } else {
+    return ScriptLine::kError;
+  }
+  p = skip_space(p);
+  if (*p != '\0' && *p != '#') return ScriptLine::kError;  // trailing garbage
+  *out = ev;
+  return ScriptLine::kEvent;
+}
+
+struct HeadlessFrame {
+  uint32_t index = 0;
+  uint32_t now_ms = 0;
+  uint32_t hash = 0;
+  uint16_t effect_id = 0;
+  bool rendered = false;   // false: EffectManager held the previous frame (nothing changed)
+  uint32_t render_us = 0;  // 0 without a timer
+};
+
+struct HeadlessStats {
+  uint32_t frames = 0;
+  uint32_t rendered = 0;
+  uint32_t held = 0;
+  uint32_t events = 0;
+  uint32_t rejected_events = 0;  // unknown effect / param, or a value the schema refuses
+  uint64_t render_us_total = 0;
+  uint32_t render_us_max = 0;
+};
+
+// Drives EffectManager the way the runtime loop does (events, tick, frame_due(), render) on a fake clock that
+// advances exactly one frame period per step(), so a run is reproducible bit for bit: frame f is at
+// start_ms + f * 1000 / fps, scripted events land on the first frame at or after their time, and signals come
+// from an optional ModulationProvider (default: none).
+//
+// Render timing is only measured (set_timer()), never fed back into the manager: the crossfade budget logic
+// reacts to measured cost and would make output depend on host speed. Manager is any type with
+// EffectManager's on_event(), set_active(), restart_active(), set_param_raw(), set_global_params(), tick(),
+// frame_due(), render() and active_id().
+template <class Manager>
+class HeadlessRunner final {
+ public:
+  HeadlessRunner(Manager& manager, uint16_t fps, uint32_t start_ms = 0)
+      : manager_(manager), fps_(fps == 0 ? 1 : fps), start_ms_(start_ms), now_ms_(start_ms) {}
+
+  // Events must be sorted by at_ms (the array is not copied).
+  void set_script(const ScriptEvent* events, size_t count) {
+    events_ = events;
+    event_count_ = events == nullptr ? 0 : count;
+    next_event_ = 0;
+  }
+
+  void set_global_params(const EffectParams& params) {
+    params_ = params;
+    manager_.set_global_params(params_);
+  }
+
+  void set_modulation(const ModulationProvider* modulation) { modulation_ = modulation; }
+
+  // Optional monotonic microsecond clock for render timing.
+  void set_timer(uint32_t (*now_us)()) { now_us_ = now_us; }
+
+  // Advances one frame and leaves it in out (the same framebuffer every call: a held frame is not rewritten).
+  HeadlessFrame step(Rgb* out, size_t n) {
+    HeadlessFrame f;
+    f.index = stats_.frames;
+    const uint32_t prev_ms = now_ms_;
+    now_ms_ = start_ms_ + static_cast<uint32_t>(static_cast<uint64_t>(stats_.frames) * 1000U / fps_);
+    f.now_ms = now_ms_;
+
+    while (next_event_ < event_count_ && static_cast<int32_t>(now_ms_ - events_[next_event_].at_ms) >= 0) {
+      apply(events_[next_event_++]);
+    }
+
+    Signals signals;
+    if (modulation_ != nullptr) {
+      modulation_->get_signals(now_ms_, &signals);
+    }
+    manager_.tick(now_ms_, stats_.frames == 0 ? 0 : now_ms_ - prev_ms, signals);
+    if (manager_.frame_due(now_ms_)) {
+      const uint32_t t0 = now_us_ != nullptr ? now_us_() : 0;
+      manager_.render(out, n);
+      f.render_us = now_us_ != nullptr ? now_us_() - t0 : 0;
+      f.rendered = true;
+      ++stats_.rendered;
+      stats_.render_us_total += f.render_us;
+      if (f.render_us > stats_.render_us_max) stats_.render_us_max = f.render_us;
+    } else {
+      ++stats_.held;
+    }
+    f.hash = frame_hash(out, n);
+    f.effect_id = manager_.active_id().value;
+    ++stats_.frames;
+    return f;
+  }
+
+  uint32_t now_ms() const { return now_ms_; }
+  const HeadlessStats& stats() const { return stats_; }
+
+ private:
+  void apply(const ScriptEvent& ev) {
+    ++stats_.events;
+    bool ok = true;
+    switch (ev.type) {
+      case ScriptEvent::Type::kKey: {
+        InputEvent in;
+        in.key = ev.key;
+        in.now_ms = now_ms_;
+        manager_.on_event(in, now_ms_);
+        break;
+      }
+      case ScriptEvent::Type::kActivate:
+        ok = manager_.set_active(EffectId{ev.effect_id}, now_ms_);
+        break;
+      case ScriptEvent::Type::kRestart:
+        manager_.restart_active(now_ms_);
+        break;
+      case ScriptEvent::Type::kParam:
+        ok = manager_.set_param_raw(EffectId{ev.effect_id}, ParamId(ev.param_id), ev.value);
+        break;
+      case ScriptEvent::Type::kBrightness:
+        params_.brightness = static_cast<uint8_t>(ev.value);
+        manager_.set_global_params(params_);
+        break;
+    }
+    if (!ok) ++stats_.rejected_events;
+  }
+
+  Manager& manager_;
+  uint16_t fps_;
+  uint32_t start_ms_;
+  uint32_t now_ms_;
+  EffectParams params_;
+  const ModulationProvider* modulation_ = nullptr;
+  uint32_t (*now_us_)() = nullptr;
+  const ScriptEvent* events_ = nullptr;
+  size_t event_count_ = 0;
+  size_t next_event_ = 0;
+  HeadlessStats stats_;
+};
+
+}  // namespace core
+}  // namespace chromance
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "apa102.h"
+#include "layout.h"
+
+namespace chromance {
+namespace core {
+
+// The ESP32's two general-purpose SPI hosts, HSPI (SPI2) and VSPI (SPI3). Each clocks out one strip at a time
+// with DMA; the two run in parallel.
+enum class SpiBus : uint8_t { kHspi = 0, kVspi = 1, kNone = 0xFF };
+constexpr uint8_t kSpiBusCount = 2;
+
+// Devices a host can hold without CS lines. Strips on the same host and clock share one device (the output
+// routes the host's clock to each strip's pin in turn), so this bounds the distinct clocks per host, not strips.
+constexpr uint8_t kSpiClocksPerBus = 3;
+
+constexpr uint32_t kSpiDefaultClockHz = 8000000;
+constexpr uint32_t kSpiMinClockHz = 1000000;
+// SPI output routed through the GPIO matrix is specified up to 26.7 MHz; on a host's own IO_MUX pins, 40 MHz.
+constexpr uint32_t kSpiMatrixMaxClockHz = 26000000;
+constexpr uint32_t kSpiIomuxMaxClockHz = 40000000;
+
+// Strips one SpiBusPlan holds: every strip of the build, and at least 8 so plans are testable under any header.
+constexpr uint8_t kMaxSpiStrips = kStripCount > 8 ? kStripCount : 8;
+
+struct SpiNativePins {
+  uint8_t data_pin;
+  uint8_t clock_pin;
+};
+
+// IO_MUX MOSI/SCLK pins per host: HSPI GPIO13/14, VSPI GPIO23/18. A strip rewired onto one of these pairs gets
+// that host to itself, bypassing the GPIO matrix (the pins would clock every strip sharing the host).
+constexpr SpiNativePins kSpiNativePins[kSpiBusCount] = {{13, 14}, {23, 18}};
+
+struct SpiStripRequest {
+  uint16_t led_count = 0;  // 0 = not driven
+  uint8_t data_pin = kUnassignedPin;
+  uint8_t clock_pin = kUnassignedPin;
+  uint32_t clock_hz = kSpiDefaultClockHz;
+};
+
+struct SpiStripPlan {
+  SpiBus bus = SpiBus::kNone;
+  uint8_t clock_slot = 0;    // index into SpiBusPlan::bus_clock_hz[bus]
+  bool native_pins = false;  // on its host's IO_MUX pins, alone on that host
+  uint32_t clock_hz = 0;     // requested clock clamped to what the routing allows
+  uint32_t wire_us = 0;      // one refresh at clock_hz
+};
+
+struct SpiBusPlan {
+  SpiStripPlan strips[kMaxSpiStrips];
+  uint8_t strip_count = 0;
+  uint32_t bus_clock_hz[kSpiBusCount][kSpiClocksPerBus] = {};
+  uint8_t bus_clock_count[kSpiBusCount] = {};
+  bool bus_exclusive[kSpiBusCount] = {};
+  uint32_t bus_us[kSpiBusCount] = {};  // strips sharing a host go out one after another
+  uint8_t unplaced = 0;                // strips with LEDs and pins that no host could take
+
+  // The hosts run in parallel: a frame is out once the busier one is done.
+  uint32_t flush_us() const { return bus_us[0] > bus_us[1] ? bus_us[0] : bus_us[1]; }
+};
+
+constexpr uint32_t clamp_spi_clock_hz(uint32_t hz, bool native_pins) {
+  return hz < kSpiMinClockHz ? kSpiMinClockHz
+         : hz > (native_pins ? kSpiIomuxMaxClockHz : kSpiMatrixMaxClockHz)
+             ? (native_pins ? kSpiIomuxMaxClockHz : kSpiMatrixMaxClockHz)
+             : hz;
+}
+
+// Assigns strips to hosts. Strips on a host's IO_MUX pins take that host alone; the others are placed longest
+// refresh first onto the host that finishes earliest and can still take their clock. The ESP32 driver adjusts
+// each clock to the nearest divider of 80 MHz, which wire_us does not model.
+inline SpiBusPlan plan_spi_buses(const SpiStripRequest* strips, uint8_t strip_count) {
+  SpiBusPlan plan;
+  plan.strip_count = strip_count < kMaxSpiStrips ? strip_count : kMaxSpiStrips;
+  if (strips == nullptr) {
+    plan.strip_count = 0;
+    return plan;
+  }
+  for (uint8_t s = plan.strip_count; s < strip_count; ++s) {
+    if (strips[s].led_count != 0 && strips[s].data_pin != kUnassignedPin && strips[s].clock_pin != kUnassignedPin) {
+      ++plan.unplaced;
+    }
+  }
+
+  bool pending[kMaxSpiStrips] = {};
+  for (uint8_t s = 0; s < plan.strip_count; ++s) {
+    const SpiStripRequest& r = strips[s];
+    if (r.led_count == 0 || r.data_pin == kUnassignedPin || r.clock_pin == kUnassignedPin) {
+      continue;
+    }
+    pending[s] = true;
+    for (uint8_t b = 0; b < kSpiBusCount; ++b) {
+      if (plan.bus_exclusive[b] || r.data_pin != kSpiNativePins[b].data_pin ||
+          r.clock_pin != kSpiNativePins[b].clock_pin) {
+        continue;
+      }
+      SpiStripPlan& p = plan.strips[s];
+      p.bus = static_cast<SpiBus>(b);
+      p.native_pins = true;
+      p.clock_hz = clamp_spi_clock_hz(r.clock_hz, true);
+      p.wire_us = apa102_wire_us(r.led_count, p.clock_hz);
+      plan.bus_exclusive[b] = true;
+      plan.bus_clock_hz[b][0] = p.clock_hz;
+      plan.bus_clock_count[b] = 1;
+      plan.bus_us[b] = p.wire_us;
+      pending[s] = false;
+    }
+  }
+
+  for (;;) {
+    // Longest refresh first (lowest index on ties), as in list scheduling.
+    uint8_t next = kMaxSpiStrips;
+    uint32_t next_us = 0;
+    for (uint8_t s = 0; s < plan.strip_count; ++s) {
+      if (!pending[s]) continue;
+      const uint32_t us = apa102_wire_us(strips[s].led_count, clamp_spi_clock_hz(strips[s].clock_hz, false));
+      if (next == kMaxSpiStrips || us > next_us) {
+        next = s;
+        next_us = us;
+      }
+    }
+    if (next == kMaxSpiStrips) {
+      break;
+    }
+    pending[next] = false;
+
+    const uint32_t hz = clamp_spi_clock_hz(strips[next].clock_hz, false);
+    uint8_t best = kSpiBusCount;
+    uint8_t best_slot = 0;
+    for (uint8_t b = 0; b < kSpiBusCount; ++b) {
+      if (plan.bus_exclusive[b]) continue;
+      uint8_t slot = 0;
+      while (slot < plan.bus_clock_count[b] && plan.bus_clock_hz[b][slot] != hz) ++slot;
+      if (slot == kSpiClocksPerBus) continue;  // no device left for another clock
+      if (best == kSpiBusCount || plan.bus_us[b] < plan.bus_us[best]) {
+        best = b;
+        best_slot = slot;
+      }
+    }
+    if (best == kSpiBusCount) {
+      ++plan.unplaced;
+      continue;
+    }
+    SpiStripPlan& p = plan.strips[next];
+    p.bus = static_cast<SpiBus>(best);
+    p.clock_slot = best_slot;
+    p.clock_hz = hz;
+    p.wire_us = next_us;
+    if (best_slot == plan.bus_clock_count[best]) {
+      plan.bus_clock_hz[best][best_slot] = hz;
+      ++plan.bus_clock_count[best];
+    }
+    plan.bus_us[best] += next_us;
+  }
+  return plan;
+}
+
+}  // namespace core
+}  // namespace chromance
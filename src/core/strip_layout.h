@@ -11,6 +11,16 @@ constexpr uint16_t strip_led_count(const StripConfig& strip) {
   return static_cast<uint16_t>(strip.segment_count) * kLedsPerSegment;
 }
 
+// First global LED of a strip in wire-order layouts (MappingTables::wire_order()), where strip s owns the
+// framebuffer span [strip_first_led(s), strip_first_led(s) + strip_led_count(strip_config(s))).
+inline uint16_t strip_first_led(uint8_t strip_index) {
+  uint16_t first = 0;
+  for (uint8_t s = 0; s < strip_index; ++s) {
+    first = static_cast<uint16_t>(first + strip_led_count(strip_config(s)));
+  }
+  return first;
+}
+
 constexpr uint16_t segment_start_led(const StripConfig& strip, uint16_t segment_index) {
   return strip.reversed
              ? static_cast<uint16_t>(strip.segment_count - 1 - segment_index) * kLedsPerSegment
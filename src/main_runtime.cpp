@@ -1,13 +1,17 @@
 #include <Arduino.h>
 #include <WiFi.h>
+#include <esp_timer.h>
 
+#include "core/audio/audio_modulation_provider.h"
 #include "core/brightness.h"
 #include "core/brightness_config.h"
 #include "core/effects/effect_catalog.h"
 #include "core/effects/effect_manager.h"
+#include "core/effects/layer_stack.h"
 #include "core/effects/legacy_effect_adapter.h"
 #include "core/effects/pattern_breathing_mode.h"
 #include "core/effects/pattern_breathing_mode_v2.h"
+#include "core/effects/pattern_clip_player.h"
 #include "core/effects/pattern_coord_color.h"
 #include "core/effects/pattern_hrv_hexagon.h"
 #include "core/effects/pattern_index_walk.h"
@@ -17,10 +21,29 @@
 #include "core/effects/pattern_xy_scan.h"
 #include "core/effects/frame_scheduler.h"
 #include "core/effects/modulation_provider.h"
+#include "core/effects/param_coalescer.h"
+#include "core/effects/playlist.h"
 #include "core/mapping/mapping_tables.h"
+#include "core/mapping/node_partition.h"
 #include "core/mapping/pixels_map.h"
+#include "core/power_governor.h"
+#include "core/protocol/node_sync.h"
+#include "core/protocol/realtime_pixels.h"
+#include "core/protocol/serial_frame.h"
+#include "platform/audio/i2s_audio_input.h"
+#include "platform/clip_store.h"
+#include "platform/mapping_store.h"
+#if defined(CHROMANCE_LED_SPI) && CHROMANCE_LED_SPI
+#include "platform/led/spi_output.h"
+#else
 #include "platform/led/dotstar_output.h"
+#endif
+#include "platform/memory_stats.h"
+#include "platform/net/control_channel.h"
+#include "platform/net/node_sync_udp.h"
+#include "platform/net/realtime_udp.h"
 #include "platform/ota.h"
+#include "platform/power.h"
 #include "platform/effect_config_store_preferences.h"
 #include "platform/settings.h"
 #include "platform/webui_server.h"
@@ -29,35 +52,161 @@ namespace {
 
 constexpr char kFirmwareVersion[] = "runtime-0.1.0";
 
+#if defined(CHROMANCE_SERIAL_BAUD)
+constexpr unsigned long kSerialBaud = CHROMANCE_SERIAL_BAUD;
+#else
+constexpr unsigned long kSerialBaud = 115200;
+#endif
+// Room for a couple of full frames (560 * 3 + 8 bytes each) between loop iterations.
+constexpr size_t kSerialRxBufferBytes = 4096;
+// Host-streamed frames own the panel until none has arrived for this long.
+constexpr uint32_t kSerialStreamHoldMs = 2500;
+// Effect warm-up (EffectManager::prepare_next) only runs when at least this much time is left before the next
+// frame is due.
+constexpr uint32_t kPrepareHeadroomMs = 8;
+// Crossfade length for effect switches (EffectManager shortens it when the pair would miss the frame budget).
+#if defined(CHROMANCE_TRANSITION_MS)
+constexpr uint16_t kTransitionMs = CHROMANCE_TRANSITION_MS;
+#else
+constexpr uint16_t kTransitionMs = 400;
+#endif
+// Longest an unchanged effect frame is held without redrawing it (0 = render every frame).
+#if defined(CHROMANCE_MAX_IDLE_MS)
+constexpr uint32_t kMaxIdleMs = CHROMANCE_MAX_IDLE_MS;
+#else
+constexpr uint32_t kMaxIdleMs = 1000;
+#endif
+// Load-driven CPU clock / modem sleep (0 = fixed 240 MHz, radio always on).
+#if defined(CHROMANCE_POWER_GOVERNOR)
+constexpr bool kPowerGovernorEnabled = CHROMANCE_POWER_GOVERNOR;
+#else
+constexpr bool kPowerGovernorEnabled = true;
+#endif
+// I2S microphone for audio modulation (energy / BPM / beat phase). Off unless a mic is wired and configured.
+#if defined(CHROMANCE_AUDIO_I2S) && CHROMANCE_AUDIO_I2S
+constexpr bool kAudioEnabled = true;
+#else
+constexpr bool kAudioEnabled = false;
+#endif
+#if defined(CHROMANCE_I2S_BCK_PIN) && defined(CHROMANCE_I2S_WS_PIN) && defined(CHROMANCE_I2S_DATA_PIN)
+constexpr int kI2sBckPin = CHROMANCE_I2S_BCK_PIN;
+constexpr int kI2sWsPin = CHROMANCE_I2S_WS_PIN;
+constexpr int kI2sDataPin = CHROMANCE_I2S_DATA_PIN;
+#else
+constexpr int kI2sBckPin = -1;
+constexpr int kI2sWsPin = -1;
+constexpr int kI2sDataPin = -1;
+#endif
+// LED output: DotStar library (bit-banged GPIO) unless CHROMANCE_LED_SPI selects the hardware SPI hosts with DMA
+// (platform/led/spi_output.h). Its clock applies to every strip; per-strip overrides are in kHz (0 = the
+// default), e.g. -D 'CHROMANCE_SPI_STRIP_CLOCK_KHZ={12000,12000,4000,8000}' for a strip on a long cable.
+#if defined(CHROMANCE_LED_SPI) && CHROMANCE_LED_SPI
+#if defined(CHROMANCE_SPI_CLOCK_HZ)
+constexpr uint32_t kSpiClockHz = CHROMANCE_SPI_CLOCK_HZ;
+#else
+constexpr uint32_t kSpiClockHz = chromance::core::kSpiDefaultClockHz;
+#endif
+#if defined(CHROMANCE_SPI_STRIP_CLOCK_KHZ)
+constexpr uint32_t kSpiStripClockKhz[] = CHROMANCE_SPI_STRIP_CLOCK_KHZ;
+#else
+constexpr uint32_t kSpiStripClockKhz[] = {0};
+#endif
+#endif
+// Wire frames: effects that support it render APA102 wire pixels the output sends as is (core/apa102.h). Only
+// useful with an output that accepts them (ILedOutput::accepts_wire_frames); costs 4 bytes of DRAM per LED.
+// Defaults to on with the SPI output.
+#if !defined(CHROMANCE_WIRE_FRAMES) && defined(CHROMANCE_LED_SPI) && CHROMANCE_LED_SPI
+#define CHROMANCE_WIRE_FRAMES 1
+#endif
+#if defined(CHROMANCE_WIRE_FRAMES) && CHROMANCE_WIRE_FRAMES
+constexpr bool kWireFramesEnabled = true;
+#else
+constexpr bool kWireFramesEnabled = false;
+#endif
+// Multi-controller sync (core/protocol/node_sync.h): 0 = standalone, 1 = leader, 2 = follower. Nodes only follow
+// a leader of the same group.
+#if defined(CHROMANCE_SYNC_ROLE)
+constexpr uint8_t kSyncRole = CHROMANCE_SYNC_ROLE;
+#else
+constexpr uint8_t kSyncRole = 0;
+#endif
+#if defined(CHROMANCE_SYNC_GROUP)
+constexpr uint8_t kSyncGroup = CHROMANCE_SYNC_GROUP;
+#else
+constexpr uint8_t kSyncGroup = 0;
+#endif
+constexpr uint8_t kSyncLeader = 1;
+constexpr uint8_t kSyncFollower = 2;
+
+#if defined(CHROMANCE_LED_SPI) && CHROMANCE_LED_SPI
+chromance::platform::SpiOutput led_out;
+#else
 chromance::platform::DotstarOutput led_out;
+#endif
 chromance::platform::OtaManager ota;
 chromance::platform::RuntimeSettings settings;
 chromance::platform::PreferencesSettingsStore effect_store;
+chromance::platform::PowerController power;
+chromance::core::PowerGovernor power_governor;
 
 chromance::core::PixelsMap pixels_map;
 
 constexpr size_t kLedCount = chromance::core::MappingTables::led_count();
 chromance::core::Rgb rgb[kLedCount];
-uint16_t scan_order[kLedCount];
+#if defined(CHROMANCE_WIRE_FRAMES) && CHROMANCE_WIRE_FRAMES
+chromance::core::StripPixel wire_frame[kLedCount];
+#else
+chromance::core::StripPixel* const wire_frame = nullptr;
+#endif
+#if defined(CHROMANCE_REALTIME_RASTER) && CHROMANCE_REALTIME_RASTER
+uint16_t raster_order[kLedCount];  // realtime raster layout only; XY scan sorts its own into effect scratch
+#endif
 
 chromance::core::EffectParams params;
 
 chromance::core::IndexWalkEffect index_walk{25};
-chromance::core::XyScanEffect xy_scan{scan_order, kLedCount, 25};
+chromance::core::XyScanEffect xy_scan{25};
 chromance::core::StripSegmentStepperEffect strip_segment_stepper{1000};
 chromance::core::CoordColorEffect coord_color;
 chromance::core::RainbowPulseEffect rainbow_pulse{700, 2000, 700};
 chromance::core::TwoDotsEffect two_dots{25};
 chromance::core::HrvHexagonEffect hrv_hexagon;
 chromance::core::BreathingEffect breathing;
+chromance::core::ClipPlayerEffect<kLedCount> clip_player;
+// Separate instances for the layer stack so its layers keep their own runtime state.
+chromance::core::RainbowPulseEffect layer_rainbow{700, 2000, 700};
+chromance::core::TwoDotsEffect layer_comets{25};
 
 constexpr size_t kMaxEffects = 32;
+constexpr uint8_t kMaxMode = static_cast<uint8_t>(kMaxEffects);  // modes are effect ids
 chromance::core::EffectCatalog<kMaxEffects> effect_catalog;
 chromance::core::EffectManager<kMaxEffects> effect_manager;
+// Unattended shows: timed effect sequence, persisted with the effect configs (web UI: /playlist).
+chromance::core::PlaylistScheduler playlist;
 
 chromance::platform::WebuiServer webui{kFirmwareVersion, &settings, &params, &effect_manager, &effect_catalog};
 static bool webui_started = false;
 
+// Streamed param updates (WebSocket control channel), applied once per rendered frame.
+chromance::platform::ControlParamCoalescer param_updates;
+chromance::platform::ControlChannel control_channel{&param_updates};
+
+// Realtime pixel input (DDP / E1.31 / Art-Net). While a sender is active it owns the framebuffer and effect
+// rendering is skipped; after the timeout the active effect resumes.
+chromance::core::RealtimeReceiver realtime;
+chromance::platform::RealtimeUdpInput realtime_udp{&realtime};
+bool realtime_was_active = false;
+
+// Framebuffer frames streamed from a host over USB serial (see scripts/serial_frame_sender.py).
+chromance::core::SerialFrameReceiver<kLedCount> serial_frames;
+
+// Multi-controller sync. A follower runs effects and the frame scheduler on the leader's clock and mirrors its
+// effect state; the LED output drives only the strips this node's wiring file assigns pins to.
+chromance::core::SyncLeader sync_leader{kSyncGroup};
+chromance::core::SyncFollower sync_follower{kSyncGroup};
+chromance::platform::NodeSyncUdp node_sync{kSyncRole == kSyncLeader ? &sync_leader : nullptr,
+                                           kSyncRole == kSyncFollower ? &sync_follower : nullptr};
+
 constexpr chromance::core::EffectDescriptor kMode1Desc{chromance::core::EffectId{1}, "index_walk",
                                                        "Index_Walk_Test", nullptr};
 constexpr chromance::core::EffectDescriptor kMode2Desc{chromance::core::EffectId{2},
@@ -73,6 +222,14 @@ constexpr chromance::core::EffectDescriptor kMode6Desc{chromance::core::EffectId
                                                        "HRV hexagon", nullptr};
 constexpr chromance::core::EffectDescriptor kMode7Desc{chromance::core::EffectId{7}, "breathing",
                                                        "Breathing", nullptr};
+constexpr chromance::core::EffectDescriptor kMode8Desc{chromance::core::EffectId{8}, "layers",
+                                                       "Layers: Rainbow + Comets", nullptr};
+constexpr chromance::core::EffectDescriptor kMode9Desc{chromance::core::EffectId{9}, "clip", "Baked clip",
+                                                       nullptr};
+constexpr chromance::core::EffectDescriptor kLayerRainbowDesc{chromance::core::EffectId{0}, "rainbow_pulse",
+                                                              "Rainbow_Pulse", nullptr};
+constexpr chromance::core::EffectDescriptor kLayerCometsDesc{chromance::core::EffectId{0}, "seven_comets",
+                                                             "Seven_Comets", nullptr};
 
 chromance::core::LegacyEffectAdapter mode1_adapter{kMode1Desc, &index_walk};
 chromance::core::LegacyEffectAdapter mode2_adapter{kMode2Desc, &strip_segment_stepper};
@@ -81,11 +238,25 @@ chromance::core::LegacyEffectAdapter mode4_adapter{kMode4Desc, &rainbow_pulse};
 chromance::core::LegacyEffectAdapter mode5_adapter{kMode5Desc, &two_dots};
 chromance::core::LegacyEffectAdapter mode6_adapter{kMode6Desc, &hrv_hexagon};
 chromance::core::BreathingEffectV2 mode7_effect{kMode7Desc, &breathing};
+chromance::core::LegacyEffectAdapter layer_rainbow_adapter{kLayerRainbowDesc, &layer_rainbow};
+chromance::core::LegacyEffectAdapter layer_comets_adapter{kLayerCometsDesc, &layer_comets};
+chromance::core::LayerStackEffect<kLedCount> mode8_effect{kMode8Desc};
+chromance::core::LegacyEffectAdapter mode9_adapter{kMode9Desc, &clip_player};
+
+// Rewired layouts flashed as a mapping blob replace the compiled tables before anything reads them.
+chromance::platform::MappingStore mapping_store;
+
+// Baked clips (tools/clip_baker) played from memory-mapped flash; mode 9 only exists when a bundle is found.
+chromance::platform::ClipStore clip_store;
+uint16_t clip_index = 0;
 
 uint8_t current_mode = 1;
 
 chromance::core::FrameScheduler scheduler{50};  // 20ms default
-chromance::core::NullModulationProvider modulation;
+chromance::core::NullModulationProvider null_modulation;
+chromance::platform::I2sAudioInput audio_in;
+chromance::core::AudioModulationProvider audio_modulation{audio_in.features()};
+const chromance::core::ModulationProvider* modulation = &null_modulation;
 
 uint32_t last_render_ms = 0;
 uint32_t last_stats_ms = 0;
@@ -98,6 +269,39 @@ uint8_t last_indexwalk_scan_mode = 0xFF;
 uint8_t last_indexwalk_seg = 0xFF;
 uint8_t last_indexwalk_vertex = 0xFF;
 
+// The clock effects, the playlist and the frame scheduler run on: millis(), or the leader's once a follower
+// has locked onto it.
+uint32_t clock_ms() {
+  if (kSyncRole == kSyncFollower && sync_follower.locked()) {
+    return sync_follower.now_ms(static_cast<uint64_t>(esp_timer_get_time()));
+  }
+  return millis();
+}
+
+// scheduler.next_frame_ms() on the local millis() clock, for code that budgets against millis().
+uint32_t next_frame_local_ms() { return millis() + (scheduler.next_frame_ms() - clock_ms()); }
+
+bool following_leader() {
+  return kSyncRole == kSyncFollower && sync_follower.following(static_cast<uint64_t>(esp_timer_get_time()));
+}
+
+bool serial_streaming_at(uint32_t now_ms) {
+  return serial_frames.stats().frames > 0 &&
+         static_cast<int32_t>(now_ms - serial_frames.last_frame_ms()) < static_cast<int32_t>(kSerialStreamHoldMs);
+}
+
+void update_power(uint32_t now_ms) {
+  chromance::core::PowerInputs in;
+  in.occupancy_permille = scheduler.occupancy_permille();
+  in.rendered_fps = scheduler.rendered_fps();
+  in.brightness = params.brightness;
+  in.link_busy = (webui_started && (webui.busy(now_ms) || control_channel.client_count() > 0)) ||
+                 realtime.active(now_ms) || serial_streaming_at(now_ms) ||
+                 kSyncRole != 0;  // modem sleep would hold broadcast beacons back by up to a DTIM period
+  in.ota_active = ota.is_updating();
+  power.apply(power_governor.update(now_ms, in));
+}
+
 void print_brightness() {
   const uint8_t soft = settings.brightness_percent();
   const uint8_t ceiling = chromance::core::kHardwareBrightnessCeilingPercent;
@@ -112,6 +316,81 @@ void print_brightness() {
   Serial.println("%) (+/- moves 10% of ceiling, persisted)");
 }
 
+#if defined(CHROMANCE_LED_SPI) && CHROMANCE_LED_SPI
+void set_spi_clocks(uint32_t all_hz) {
+  constexpr size_t kOverrides = sizeof(kSpiStripClockKhz) / sizeof(kSpiStripClockKhz[0]);
+  for (uint8_t s = 0; s < chromance::core::kStripCount; ++s) {
+    const uint32_t khz = (all_hz == 0 && s < kOverrides) ? kSpiStripClockKhz[s] : 0;
+    led_out.set_strip_clock_hz(s, khz != 0 ? khz * 1000U : (all_hz != 0 ? all_hz : kSpiClockHz));
+  }
+}
+#endif
+
+void print_led_output() {
+#if defined(CHROMANCE_LED_SPI) && CHROMANCE_LED_SPI
+  const chromance::core::SpiBusPlan& plan = led_out.plan();
+  Serial.print("LED output: SPI DMA, flush ~");
+  Serial.print(static_cast<unsigned>(plan.flush_us()));
+  Serial.println(" us on the wire");
+  for (uint8_t s = 0; s < plan.strip_count; ++s) {
+    const chromance::core::SpiStripPlan& p = plan.strips[s];
+    if (p.bus == chromance::core::SpiBus::kNone) continue;
+    Serial.print("  strip ");
+    Serial.print(static_cast<unsigned>(s) + 1U);
+    Serial.print(p.bus == chromance::core::SpiBus::kHspi ? ": HSPI " : ": VSPI ");
+    Serial.print(static_cast<unsigned>(p.clock_hz / 1000U));
+    Serial.print(" kHz");
+    Serial.print(p.native_pins ? " (IO_MUX pins) " : " ");
+    Serial.print(static_cast<unsigned>(p.wire_us));
+    Serial.println(" us");
+  }
+  if (led_out.undriven_strips() != 0) {
+    Serial.print("LED output: ");
+    Serial.print(static_cast<unsigned>(led_out.undriven_strips()));
+    Serial.println(" strip(s) not driven (more than 3 distinct clocks per SPI host, or driver setup failed)");
+  }
+#else
+  Serial.println("LED output: DotStar library (bit-banged GPIO)");
+#endif
+}
+
+// Times led_out.show() of the current frame: at 4, 8 and 12 MHz on every strip for the SPI output (plus the
+// wire-frame path), once for the bit-banged DotStar output. Compare the two by running it on both builds.
+void run_flush_bench() {
+  constexpr uint16_t kFrames = 50;
+  uint32_t t0 = micros();
+#if defined(CHROMANCE_LED_SPI) && CHROMANCE_LED_SPI
+  const uint32_t clocks_hz[] = {4000000, 8000000, 12000000};
+  if (kWireFramesEnabled) {
+    chromance::core::encode_apa102(rgb, wire_frame, kLedCount);
+  }
+  for (const uint32_t hz : clocks_hz) {
+    set_spi_clocks(hz);
+    t0 = micros();
+    for (uint16_t i = 0; i < kFrames; ++i) led_out.show(rgb, kLedCount, nullptr);
+    const uint32_t show_us = (micros() - t0) / kFrames;
+    t0 = micros();
+    for (uint16_t i = 0; kWireFramesEnabled && i < kFrames; ++i) led_out.show_wire(wire_frame, kLedCount, nullptr);
+    const uint32_t wire_us = (micros() - t0) / kFrames;
+    Serial.print("flush bench: SPI ");
+    Serial.print(static_cast<unsigned>(hz / 1000000U));
+    Serial.print(" MHz show=");
+    Serial.print(static_cast<unsigned>(show_us));
+    Serial.print("us show_wire=");
+    Serial.print(static_cast<unsigned>(wire_us));
+    Serial.print("us wire_time=");
+    Serial.print(static_cast<unsigned>(led_out.plan().flush_us()));
+    Serial.println("us");
+  }
+  set_spi_clocks(0);
+#else
+  for (uint16_t i = 0; i < kFrames; ++i) led_out.show(rgb, kLedCount, nullptr);
+  Serial.print("flush bench: DotStar bit-bang show=");
+  Serial.print(static_cast<unsigned>((micros() - t0) / kFrames));
+  Serial.println("us");
+#endif
+}
+
 void set_brightness_percent(uint8_t percent) {
   settings.set_brightness_percent(percent);
   params.brightness = chromance::core::soft_percent_to_u8_255(
@@ -131,15 +410,108 @@ void reset_mode_print_state() {
   last_banner_ms = 0;
 }
 
+// Points the clip player at bundle entry index. Clips baked for another layout are refused by the player.
+bool load_clip(uint16_t index) {
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+  if (!clip_store.bundle().clip_at(index, &data, &size) ||
+      !clip_player.set_clip(data, size, kLedCount,
+                            chromance::core::clip::mapping_hash(chromance::core::MappingTables::mapping_version()))) {
+    return false;
+  }
+  clip_index = index;
+  Serial.print("Clip ");
+  Serial.print(static_cast<unsigned>(index));
+  Serial.print(": ");
+  Serial.print(clip_store.bundle().name_at(index));
+  Serial.print(" (");
+  Serial.print(static_cast<unsigned long>(clip_player.reader().frame_count()));
+  Serial.print(" frames @ ");
+  Serial.print(static_cast<unsigned>(clip_player.reader().fps()));
+  Serial.println(" fps)");
+  return true;
+}
+
+// Keeps mode-dependent runtime state (frame rate, serial banners) in step with effects switched by the
+// playlist. Not persisted: the playlist resumes on boot instead.
+void sync_mode_with_active_effect() {
+  const uint8_t active =
+      chromance::core::ModeSetting::sanitize(static_cast<uint8_t>(effect_manager.active_id().value), kMaxMode);
+  if (active == current_mode) {
+    return;
+  }
+  current_mode = active;
+  reset_mode_print_state();
+  Serial.print("Playlist ");
+  Serial.print(static_cast<unsigned>(playlist.index()));
+  Serial.print(": mode ");
+  Serial.print(static_cast<unsigned>(current_mode));
+  Serial.print(": ");
+  const chromance::core::IEffectV2* e = effect_manager.active();
+  Serial.println(e ? e->descriptor().display_name : "?");
+}
+
+// Sends (leader) or drains and applies (follower) sync beacons. Runs first in loop() so a servo step never lands
+// between reading the clock and using it.
+void update_node_sync() {
+  if (kSyncRole == 0 || WiFi.status() != WL_CONNECTED) return;
+  node_sync.begin();
+  if (kSyncRole == kSyncLeader) {
+    chromance::core::SyncState state;
+    chromance::core::capture_sync_state(effect_manager, scheduler.target_fps(), &state);
+    node_sync.send(state);
+    return;
+  }
+  node_sync.poll();
+  if (!sync_follower.locked()) return;
+  if (sync_follower.take_clock_step()) {
+    scheduler.reset(clock_ms());  // the clock jumped onto the leader's
+    effect_manager.invalidate_frame();
+    Serial.println("Sync: locked to leader clock");
+  }
+  if (following_leader() && chromance::core::apply_sync_state(sync_follower.state(), effect_manager)) {
+    params = effect_manager.global_params();
+    sync_mode_with_active_effect();
+  }
+}
+
+void print_sync_stats() {
+  if (kSyncRole == kSyncLeader) {
+    Serial.print("sync leader beacons=");
+    Serial.print(sync_leader.beacons());
+    Serial.print(" send_errors=");
+    Serial.println(node_sync.send_errors());
+    return;
+  }
+  const chromance::core::SyncFollowerStats& ss = sync_follower.stats();
+  Serial.print("sync follower locked=");
+  Serial.print(sync_follower.locked() ? 1 : 0);
+  Serial.print(" following=");
+  Serial.print(following_leader() ? 1 : 0);
+  Serial.print(" err_us=");
+  Serial.print(sync_follower.servo().last_error_us());
+  Serial.print(" drift_ppb=");
+  Serial.print(sync_follower.servo().drift_ppb());
+  Serial.print(" steps=");
+  Serial.print(sync_follower.servo().steps());
+  Serial.print(" beacons=");
+  Serial.print(ss.beacons);
+  Serial.print(" lost=");
+  Serial.print(ss.lost);
+  Serial.print(" timeouts=");
+  Serial.println(ss.timeouts);
+}
+
 void select_mode(uint8_t mode) {
-  const uint8_t safe_mode = chromance::core::ModeSetting::sanitize(mode);
+  playlist.stop(millis());  // picking an effect by hand ends the show
+  const uint8_t safe_mode = chromance::core::ModeSetting::sanitize(mode, kMaxMode);
   settings.set_mode(safe_mode);
   const uint32_t now_ms = millis();
   if (!effect_manager.set_active(chromance::core::EffectId{safe_mode}, now_ms)) {
     (void)effect_manager.set_active(chromance::core::EffectId{1}, now_ms);
   }
   current_mode =
-      chromance::core::ModeSetting::sanitize(static_cast<uint8_t>(effect_manager.active_id().value));
+      chromance::core::ModeSetting::sanitize(static_cast<uint8_t>(effect_manager.active_id().value), kMaxMode);
   settings.set_mode(current_mode);
   reset_mode_print_state();
   Serial.print("Mode ");
@@ -185,7 +557,7 @@ void print_strip_segment_stepper_state() {
   Serial.print("Strip segment stepper: k=");
   Serial.print(static_cast<unsigned>(k));
 
-  for (uint8_t strip = 0; strip < 4; ++strip) {
+  for (uint8_t strip = 0; strip < chromance::core::kStripCount; ++strip) {
     const uint16_t i = find_first_led_for_strip_segment(strip, static_cast<uint8_t>(k - 1U));
     Serial.print(" strip");
     Serial.print(static_cast<unsigned>(strip));
@@ -231,27 +603,252 @@ void print_index_walk_vertex_state() {
   Serial.println("]");
 }
 
+void handle_command(int c, uint32_t now_ms) {
+  // Some commands drive legacy effects directly rather than through EffectManager; redraw after any of them.
+  effect_manager.invalidate_frame();
+  if (c == '1') select_mode(1);
+  if (c == '2') select_mode(2);
+  if (c == '3') select_mode(3);
+  if (c == '4') select_mode(4);
+  if (c == '5') select_mode(5);
+  if (c == '6') select_mode(6);
+  if (c == '7') select_mode(7);
+  if (c == '8') select_mode(8);
+  if (c == '9') select_mode(9);
+  if (c == 'p') {
+    if (playlist.running()) {
+      playlist.stop(now_ms);
+      Serial.println("Playlist: stopped");
+    } else if (playlist.start(now_ms, effect_manager)) {
+      sync_mode_with_active_effect();
+    } else {
+      Serial.println("Playlist: empty (edit it at /playlist)");
+    }
+  }
+  if (c == 'n') {
+    if (current_mode == 1) {
+      if (index_walk.in_vertex_mode()) {
+        index_walk.vertex_next(now_ms);
+        last_indexwalk_vertex = 0xFF;
+        last_banner_ms = 0;
+        print_index_walk_vertex_state();
+      } else {
+        index_walk.cycle_scan_mode(now_ms);
+        last_banner_led = 0xFFFF;
+        last_indexwalk_scan_mode = 0xFF;
+        last_indexwalk_seg = 0xFF;
+        last_indexwalk_vertex = 0xFF;
+        last_banner_ms = 0;
+        print_index_walk_scan_mode();
+        if (index_walk.in_vertex_mode()) {
+          print_index_walk_vertex_state();
+        }
+      }
+    } else if (current_mode == 2) {
+      strip_segment_stepper.next(now_ms);
+      strip_segment_stepper.set_auto_advance_enabled(false, now_ms);
+      mode2_hold = true;
+      last_strip_segment_k = 0xFF;
+      print_strip_segment_stepper_state();
+    } else if (current_mode == 6) {
+      hrv_hexagon.next(now_ms);
+      last_hrv_hex = 0xFF;
+    } else if (current_mode == 9) {
+      const uint16_t count = clip_store.bundle().count();
+      for (uint16_t k = 1; k <= count; ++k) {
+        if (load_clip(static_cast<uint16_t>((clip_index + k) % count))) break;
+      }
+      clip_player.reset(now_ms);
+    } else if (current_mode == 7) {
+      chromance::core::InputEvent ev;
+      ev.key = chromance::core::Key::N;
+      ev.now_ms = now_ms;
+      effect_manager.on_event(ev, now_ms);
+    }
+  }
+  if (c == 'N') {
+    if (current_mode == 1) {
+      if (index_walk.in_vertex_mode()) {
+        index_walk.vertex_prev(now_ms);
+        last_indexwalk_vertex = 0xFF;
+        last_banner_ms = 0;
+        print_index_walk_vertex_state();
+      }
+    } else if (current_mode == 2) {
+      strip_segment_stepper.prev(now_ms);
+      strip_segment_stepper.set_auto_advance_enabled(false, now_ms);
+      mode2_hold = true;
+      last_strip_segment_k = 0xFF;
+      print_strip_segment_stepper_state();
+    } else if (current_mode == 6) {
+      hrv_hexagon.prev(now_ms);
+      last_hrv_hex = 0xFF;
+    } else if (current_mode == 7) {
+      chromance::core::InputEvent ev;
+      ev.key = chromance::core::Key::ShiftN;
+      ev.now_ms = now_ms;
+      effect_manager.on_event(ev, now_ms);
+    }
+  }
+  if (c == 's') {
+    if (current_mode == 7) {
+      chromance::core::InputEvent ev;
+      ev.key = chromance::core::Key::S;
+      ev.now_ms = now_ms;
+      effect_manager.on_event(ev, now_ms);
+    } else if (current_mode == 1) {
+      if (index_walk.in_vertex_mode()) {
+        // Pause vertex selection (manual), but keep looping the fill animation.
+        index_walk.clear_manual_hold(now_ms);
+        index_walk.vertex_next(now_ms);
+        last_indexwalk_vertex = 0xFF;
+        last_banner_ms = (now_ms >= 250) ? (now_ms - 250) : 0;
+        print_index_walk_vertex_state();
+      } else {
+        index_walk.step_hold_next(now_ms);
+        last_banner_led = 0xFFFF;
+        last_indexwalk_scan_mode = 0xFF;
+        last_indexwalk_seg = 0xFF;
+        last_indexwalk_vertex = 0xFF;
+        last_banner_ms = (now_ms >= 250) ? (now_ms - 250) : 0;
+      }
+    }
+  }
+  if (c == 'S') {
+    if (current_mode == 7) {
+      chromance::core::InputEvent ev;
+      ev.key = chromance::core::Key::ShiftS;
+      ev.now_ms = now_ms;
+      effect_manager.on_event(ev, now_ms);
+    } else if (current_mode == 1) {
+      if (index_walk.in_vertex_mode()) {
+        index_walk.clear_manual_hold(now_ms);
+        index_walk.vertex_prev(now_ms);
+        last_indexwalk_vertex = 0xFF;
+        last_banner_ms = (now_ms >= 250) ? (now_ms - 250) : 0;
+        print_index_walk_vertex_state();
+      } else {
+        index_walk.step_hold_prev(now_ms);
+        last_banner_led = 0xFFFF;
+        last_indexwalk_scan_mode = 0xFF;
+        last_indexwalk_seg = 0xFF;
+        last_indexwalk_vertex = 0xFF;
+        last_banner_ms = (now_ms >= 250) ? (now_ms - 250) : 0;
+      }
+    }
+  }
+  if (c == 27) {  // ESC
+    if (current_mode == 1) {
+      index_walk.set_auto(now_ms);
+      last_banner_led = 0xFFFF;
+      last_indexwalk_scan_mode = 0xFF;
+      last_indexwalk_seg = 0xFF;
+      last_indexwalk_vertex = 0xFF;
+      last_banner_ms = 0;
+      print_index_walk_scan_mode();
+    } else if (current_mode == 2) {
+      strip_segment_stepper.set_auto_advance_enabled(true, now_ms);
+      mode2_hold = false;
+    } else if (current_mode == 7) {
+      chromance::core::InputEvent ev;
+      ev.key = chromance::core::Key::Esc;
+      ev.now_ms = now_ms;
+      effect_manager.on_event(ev, now_ms);
+    } else if (current_mode == 6) {
+      hrv_hexagon.set_auto(now_ms);
+      last_hrv_hex = 0xFF;
+    }
+  }
+  if (c == 'f') run_flush_bench();
+  if (c == '+') {
+    set_brightness_percent(
+        chromance::core::brightness_step_up_10(settings.brightness_percent()));
+  }
+  if (c == '-') {
+    set_brightness_percent(
+        chromance::core::brightness_step_down_10(settings.brightness_percent()));
+  }
+}
+
 }  // namespace
 
 void setup() {
-  Serial.begin(115200);
+  Serial.setRxBufferSize(kSerialRxBufferBytes);
+  Serial.begin(kSerialBaud);
   Serial.println();
   Serial.print("Chromance Control boot: ");
   Serial.println(kFirmwareVersion);
+  mapping_store.begin();
   Serial.print("Mapping version: ");
-  Serial.println(chromance::core::MappingTables::mapping_version());
+  Serial.print(chromance::core::MappingTables::mapping_version());
+  Serial.print(" (");
+  Serial.print(chromance::core::MappingTables::using_compiled() ? "compiled, " : "from partition ");
+  Serial.print(mapping_store.status() == chromance::platform::MappingStore::Status::kLoaded
+                   ? mapping_store.partition_label()
+                   : mapping_store.status_name());
+  Serial.println(")");
   Serial.print("Bench subset: ");
   Serial.println(chromance::core::MappingTables::is_bench_subset() ? "true" : "false");
   Serial.print("LED_COUNT: ");
   Serial.println(static_cast<unsigned>(chromance::core::MappingTables::led_count()));
+  if (chromance::core::is_multi_node()) {
+    Serial.print("Node: ");
+    Serial.print(chromance::core::MappingTables::node_name());
+    Serial.print(" (");
+    Serial.print(static_cast<unsigned>(chromance::core::MappingTables::node_index()) + 1U);
+    Serial.print("/");
+    Serial.print(static_cast<unsigned>(chromance::core::MappingTables::node_count()));
+    Serial.print(") LEDs ");
+    Serial.print(static_cast<unsigned>(chromance::core::MappingTables::node_led_first()));
+    Serial.print("+");
+    Serial.print(static_cast<unsigned>(chromance::core::MappingTables::node_led_count()));
+    Serial.print(" halo segments ");
+    Serial.println(static_cast<unsigned>(chromance::core::node_segments(chromance::core::NodeRole::kHalo).count()));
+    if (kSyncRole == 0) {
+      Serial.println("Node build without CHROMANCE_SYNC_ROLE: effects will drift from the other nodes");
+    }
+  }
 
-  pixels_map.build_scan_order(scan_order, kLedCount);
+  chromance::core::RealtimeFramebuffer realtime_fb;
+  realtime_fb.pixels = rgb;
+  realtime_fb.count = kLedCount;
+  realtime_fb.width = chromance::core::MappingTables::width();
+  realtime_fb.height = chromance::core::MappingTables::height();
+  realtime_fb.x = chromance::core::MappingTables::pixel_x();
+  realtime_fb.y = chromance::core::MappingTables::pixel_y();
+  chromance::core::RealtimeConfig realtime_cfg;
+#if defined(CHROMANCE_REALTIME_RASTER) && CHROMANCE_REALTIME_RASTER
+  pixels_map.build_scan_order(raster_order, kLedCount);
+  realtime_fb.raster_order = raster_order;
+  realtime_cfg.layout = chromance::core::RealtimeLayout::kRaster;  // ledmap.json raster order
+#endif
+  realtime.begin(realtime_fb, realtime_cfg);
 
+#if defined(CHROMANCE_LED_SPI) && CHROMANCE_LED_SPI
+  set_spi_clocks(0);
+#endif
   led_out.begin();
+  print_led_output();
   ota.begin(kFirmwareVersion);
+  scheduler.set_phase_locked(kSyncRole != 0);  // leader and followers render on the same frame boundaries
   scheduler.reset(millis());
+  power.begin();
+  power_governor.set_enabled(kPowerGovernorEnabled);
+  power_governor.begin(millis());
+  webui.set_power_governor(&power_governor);
+
+  if (kAudioEnabled) {
+    chromance::platform::I2sAudioConfig audio_cfg;
+    audio_cfg.bck_pin = kI2sBckPin;
+    audio_cfg.ws_pin = kI2sWsPin;
+    audio_cfg.data_pin = kI2sDataPin;
+    if (audio_in.begin(audio_cfg)) {
+      modulation = &audio_modulation;
+      webui.set_audio_features(audio_in.features());
+    }
+  }
 
-  settings.begin();
+  settings.begin(kMaxMode);
   effect_store.begin();
 
   params = chromance::core::EffectParams{};
@@ -266,16 +863,40 @@ void setup() {
   (void)effect_catalog.add(mode5_adapter.descriptor(), &mode5_adapter);
   (void)effect_catalog.add(mode6_adapter.descriptor(), &mode6_adapter);
   (void)effect_catalog.add(mode7_effect.descriptor(), &mode7_effect);
+  // Layers are wired before the stack is cataloged so EffectManager sees its full schema.
+  (void)mode8_effect.add_layer(&layer_rainbow_adapter, chromance::core::BlendMode::kAlpha, 160);
+  (void)mode8_effect.add_layer(&layer_comets_adapter, chromance::core::BlendMode::kScreen, 255);
+  (void)effect_catalog.add(mode8_effect.descriptor(), &mode8_effect);
+  if (clip_store.begin()) {
+    Serial.print("Clip bundle: ");
+    Serial.print(static_cast<unsigned>(clip_store.bundle().count()));
+    Serial.print(" clip(s) in partition ");
+    Serial.println(clip_store.partition_label());
+    for (uint16_t i = 0; i < clip_store.bundle().count(); ++i) {
+      if (load_clip(i)) {
+        (void)effect_catalog.add(mode9_adapter.descriptor(), &mode9_adapter);
+        break;
+      }
+    }
+  }
 
   Serial.println(
-      "Commands: 1=Index_Walk_Test 2=Strip_Segment_Stepper 3=Coord_Color_Test 4=Rainbow_Pulse 5=Seven_Comets 6=HRV_hexagon 7=Breathing n=next(mode1/2/6/7) N=prev(mode2/6/7) s/S=step(mode1) lane(mode7 manual inhale) esc=auto(mode1/2/6/7) +=brightness_up -=brightness_down");
+      "Commands: 1=Index_Walk_Test 2=Strip_Segment_Stepper 3=Coord_Color_Test 4=Rainbow_Pulse 5=Seven_Comets 6=HRV_hexagon 7=Breathing 8=Layers 9=Baked_Clip n=next(mode1/2/6/7/9) p=playlist_start/stop N=prev(mode2/6/7) s/S=step(mode1) lane(mode7 manual inhale) esc=auto(mode1/2/6/7) +=brightness_up -=brightness_down f=flush_bench");
   Serial.print("Restored mode: ");
   Serial.println(static_cast<unsigned>(settings.mode()));
   print_brightness();
 
-  const uint8_t safe_mode = chromance::core::ModeSetting::sanitize(settings.mode());
+  const uint8_t safe_mode = chromance::core::ModeSetting::sanitize(settings.mode(), kMaxMode);
   effect_manager.init(effect_store, effect_catalog, pixels_map, millis(), chromance::core::EffectId{safe_mode});
-  current_mode = chromance::core::ModeSetting::sanitize(static_cast<uint8_t>(effect_manager.active_id().value));
+  effect_manager.set_transition_ms(kTransitionMs);
+  effect_manager.set_max_idle_ms(kMaxIdleMs);
+  if (playlist.load(effect_store)) {
+    (void)playlist.start(millis(), effect_manager);
+    Serial.println("Playlist: resumed");
+  }
+  webui.set_playlist(&playlist);
+  current_mode =
+      chromance::core::ModeSetting::sanitize(static_cast<uint8_t>(effect_manager.active_id().value), kMaxMode);
   settings.set_mode(current_mode);
   reset_mode_print_state();
   Serial.print("Restored effect: ");
@@ -291,187 +912,198 @@ void setup() {
 
 void loop() {
   ota.handle();
+  update_node_sync();
   const uint32_t now_ms = millis();
+  const uint32_t frame_now_ms = clock_ms();  // effects and scheduler (== now_ms unless following a leader)
 
-  while (Serial.available() > 0) {
-    const int c = Serial.read();
-    if (c == '1') select_mode(1);
-    if (c == '2') select_mode(2);
-    if (c == '3') select_mode(3);
-    if (c == '4') select_mode(4);
-    if (c == '5') select_mode(5);
-    if (c == '6') select_mode(6);
-    if (c == '7') select_mode(7);
-    if (c == 'n') {
-      if (current_mode == 1) {
-        if (index_walk.in_vertex_mode()) {
-          index_walk.vertex_next(now_ms);
-          last_indexwalk_vertex = 0xFF;
-          last_banner_ms = 0;
-          print_index_walk_vertex_state();
-        } else {
-          index_walk.cycle_scan_mode(now_ms);
-          last_banner_led = 0xFFFF;
-          last_indexwalk_scan_mode = 0xFF;
-          last_indexwalk_seg = 0xFF;
-          last_indexwalk_vertex = 0xFF;
-          last_banner_ms = 0;
-          print_index_walk_scan_mode();
-          if (index_walk.in_vertex_mode()) {
-            print_index_walk_vertex_state();
-          }
-        }
-      } else if (current_mode == 2) {
-        strip_segment_stepper.next(now_ms);
-        strip_segment_stepper.set_auto_advance_enabled(false, now_ms);
-        mode2_hold = true;
-        last_strip_segment_k = 0xFF;
-        print_strip_segment_stepper_state();
-      } else if (current_mode == 6) {
-        hrv_hexagon.next(now_ms);
-        last_hrv_hex = 0xFF;
-      } else if (current_mode == 7) {
-        chromance::core::InputEvent ev;
-        ev.key = chromance::core::Key::N;
-        ev.now_ms = now_ms;
-        effect_manager.on_event(ev, now_ms);
-      }
-    }
-    if (c == 'N') {
-      if (current_mode == 1) {
-        if (index_walk.in_vertex_mode()) {
-          index_walk.vertex_prev(now_ms);
-          last_indexwalk_vertex = 0xFF;
-          last_banner_ms = 0;
-          print_index_walk_vertex_state();
-        }
-      } else if (current_mode == 2) {
-        strip_segment_stepper.prev(now_ms);
-        strip_segment_stepper.set_auto_advance_enabled(false, now_ms);
-        mode2_hold = true;
-        last_strip_segment_k = 0xFF;
-        print_strip_segment_stepper_state();
-      } else if (current_mode == 6) {
-        hrv_hexagon.prev(now_ms);
-        last_hrv_hex = 0xFF;
-      } else if (current_mode == 7) {
-        chromance::core::InputEvent ev;
-        ev.key = chromance::core::Key::ShiftN;
-        ev.now_ms = now_ms;
-        effect_manager.on_event(ev, now_ms);
-      }
-    }
-    if (c == 's') {
-      if (current_mode == 7) {
-        chromance::core::InputEvent ev;
-        ev.key = chromance::core::Key::S;
-        ev.now_ms = now_ms;
-        effect_manager.on_event(ev, now_ms);
-      } else if (current_mode == 1) {
-        if (index_walk.in_vertex_mode()) {
-          // Pause vertex selection (manual), but keep looping the fill animation.
-          index_walk.clear_manual_hold(now_ms);
-          index_walk.vertex_next(now_ms);
-          last_indexwalk_vertex = 0xFF;
-          last_banner_ms = (now_ms >= 250) ? (now_ms - 250) : 0;
-          print_index_walk_vertex_state();
-        } else {
-          index_walk.step_hold_next(now_ms);
-          last_banner_led = 0xFFFF;
-          last_indexwalk_scan_mode = 0xFF;
-          last_indexwalk_seg = 0xFF;
-          last_indexwalk_vertex = 0xFF;
-          last_banner_ms = (now_ms >= 250) ? (now_ms - 250) : 0;
-        }
-      }
-    }
-    if (c == 'S') {
-      if (current_mode == 7) {
-        chromance::core::InputEvent ev;
-        ev.key = chromance::core::Key::ShiftS;
-        ev.now_ms = now_ms;
-        effect_manager.on_event(ev, now_ms);
-      } else if (current_mode == 1) {
-        if (index_walk.in_vertex_mode()) {
-          index_walk.clear_manual_hold(now_ms);
-          index_walk.vertex_prev(now_ms);
-          last_indexwalk_vertex = 0xFF;
-          last_banner_ms = (now_ms >= 250) ? (now_ms - 250) : 0;
-          print_index_walk_vertex_state();
-        } else {
-          index_walk.step_hold_prev(now_ms);
-          last_banner_led = 0xFFFF;
-          last_indexwalk_scan_mode = 0xFF;
-          last_indexwalk_seg = 0xFF;
-          last_indexwalk_vertex = 0xFF;
-          last_banner_ms = (now_ms >= 250) ? (now_ms - 250) : 0;
-        }
-      }
-    }
-    if (c == 27) {  // ESC
-      if (current_mode == 1) {
-        index_walk.set_auto(now_ms);
-        last_banner_led = 0xFFFF;
-        last_indexwalk_scan_mode = 0xFF;
-        last_indexwalk_seg = 0xFF;
-        last_indexwalk_vertex = 0xFF;
-        last_banner_ms = 0;
-        print_index_walk_scan_mode();
-      } else if (current_mode == 2) {
-        strip_segment_stepper.set_auto_advance_enabled(true, now_ms);
-        mode2_hold = false;
-      } else if (current_mode == 7) {
-        chromance::core::InputEvent ev;
-        ev.key = chromance::core::Key::Esc;
-        ev.now_ms = now_ms;
-        effect_manager.on_event(ev, now_ms);
-      } else if (current_mode == 6) {
-        hrv_hexagon.set_auto(now_ms);
-        last_hrv_hex = 0xFF;
-      }
-    }
-    if (c == '+') {
-      set_brightness_percent(
-          chromance::core::brightness_step_up_10(settings.brightness_percent()));
-    }
-    if (c == '-') {
-      set_brightness_percent(
-          chromance::core::brightness_step_down_10(settings.brightness_percent()));
+  // Serial carries both framebuffer frames and single-character commands; frame bytes are consumed by the
+  // receiver and everything else is handed back as commands.
+  uint8_t serial_chunk[256];
+  uint8_t serial_cmds[sizeof(serial_chunk)];
+  int serial_avail = 0;
+  while ((serial_avail = Serial.available()) > 0) {
+    const size_t want = static_cast<size_t>(serial_avail) < sizeof(serial_chunk) ? static_cast<size_t>(serial_avail)
+                                                                                  : sizeof(serial_chunk);
+    const int got = Serial.read(serial_chunk, want);
+    if (got <= 0) break;
+    const size_t ncmd =
+        serial_frames.feed(serial_chunk, static_cast<size_t>(got), serial_cmds, sizeof(serial_cmds), now_ms);
+    for (size_t i = 0; i < ncmd; ++i) {
+      handle_command(serial_cmds[i], now_ms);
     }
   }
 
+  if (!following_leader()) {
+    playlist.tick(frame_now_ms, effect_manager);  // a follower shows whatever the leader's playlist picks
+    sync_mode_with_active_effect();
+  }
+  playlist.persist(now_ms, effect_store);
+
   uint32_t frame_ms = ota.is_updating() ? 100 : 20;
   if (current_mode == 6) {
     frame_ms = 16;  // smoother fades for mode 6
   }
-  if (current_mode == 7) {
+  if (current_mode == 7 || current_mode == 8 || current_mode == 9) {
     frame_ms = 16;
   }
-  scheduler.set_target_fps(frame_ms ? static_cast<uint16_t>(1000U / frame_ms) : 0);
+  uint16_t target_fps = frame_ms ? static_cast<uint16_t>(1000U / frame_ms) : 0;
+  if (following_leader()) {
+    target_fps = sync_follower.state().target_fps;
+  }
+  scheduler.set_target_fps(target_fps);
+  effect_manager.set_frame_budget_us(frame_ms * 750U);  // leave a quarter of the frame for the LED flush
 
   if (WiFi.status() == WL_CONNECTED) {
     if (!webui_started) {
       webui.begin();
+      control_channel.begin();
+      realtime_udp.begin();
       webui_started = true;
     }
-    webui.handle(now_ms, scheduler.next_frame_ms());
+    webui.handle(now_ms, next_frame_local_ms());
+    control_channel.handle(millis(), next_frame_local_ms());
+    realtime_udp.poll(millis());
     if (webui.take_pending_restart()) {
       ESP.restart();
       return;
     }
   }
+  update_power(millis());
 
-  if (!scheduler.should_render(now_ms)) return;
+  // Warm effect caches one effect at a time in idle frame time, so switching (web UI or serial) never pays for
+  // them in the first frame.
+  if (effect_manager.prepare_pending() &&
+      static_cast<int32_t>(scheduler.next_frame_ms() - clock_ms()) >= static_cast<int32_t>(kPrepareHeadroomMs)) {
+    const uint32_t prepare_start_us = micros();
+    const chromance::core::EffectId prepared = effect_manager.prepare_next(clock_ms());
+    effect_manager.note_prepare_us(prepared, micros() - prepare_start_us);
+  } else if (static_cast<int32_t>(scheduler.next_frame_ms() - clock_ms()) >=
+             static_cast<int32_t>(kPrepareHeadroomMs)) {
+    // Same slot for the next playlist entry, whose caches may have been invalidated since the boot warm-up.
+    const uint32_t prepare_start_us = micros();
+    if (playlist.prewarm(clock_ms(), effect_manager)) {
+      const chromance::core::PlaylistEntry& next =
+          playlist.config().entries[(playlist.index() + 1U) % playlist.config().count];
+      effect_manager.note_prepare_us(chromance::core::EffectId{next.effect_id}, micros() - prepare_start_us);
+    }
+  }
+
+  if (realtime.active(millis())) {
+    if (!realtime_was_active) {
+      realtime_was_active = true;
+      Serial.println("Realtime input: active");
+    }
+    // Frames are paced by the sender (sync/PUSH), not the scheduler. Keep the scheduler ticking anyway so the
+    // web UI gate and the effect's dt stay meaningful.
+    scheduler.wake();
+    effect_manager.invalidate_frame();  // redraw the effect once realtime input stops
+    (void)scheduler.should_render(frame_now_ms);
+    if (realtime.take_frame()) {
+      chromance::platform::PerfStats stats{0, 0};
+      led_out.set_brightness(params.brightness);
+      led_out.show(rgb, kLedCount, &stats);
+      realtime.on_frame_shown(millis());
+      control_channel.offer_preview(rgb, kLedCount, now_ms);
+    }
+    if (static_cast<int32_t>(now_ms - last_stats_ms) >= 1000) {
+      last_stats_ms = now_ms;
+      const chromance::core::RealtimeStats& rs = realtime.stats();
+      Serial.print("realtime packets=");
+      Serial.print(rs.packets);
+      Serial.print(" frames=");
+      Serial.print(rs.frames);
+      Serial.print(" lost=");
+      Serial.print(rs.lost);
+      Serial.print(" malformed=");
+      Serial.print(rs.malformed);
+      Serial.print(" assembly_ms=");
+      Serial.print(rs.last_assembly_ms);
+      Serial.print("/");
+      Serial.print(rs.max_assembly_ms);
+      Serial.print(" display_ms=");
+      Serial.print(rs.last_display_ms);
+      Serial.print("/");
+      Serial.println(rs.max_display_ms);
+    }
+    return;
+  }
+  if (realtime_was_active) {
+    realtime_was_active = false;
+    Serial.println("Realtime input: timed out, resuming effect");
+  }
+
+  // An idle hold (set after the last effect frame) ends early for anything that can change the next frame:
+  // input, params, brightness, pending coalesced params or a streamed host frame.
+  if (effect_manager.frame_due(frame_now_ms) || param_updates.pending() > 0 || serial_frames.frame_ready()) {
+    scheduler.wake();
+  }
+  if (!scheduler.should_render(frame_now_ms)) return;
   last_render_ms = now_ms;
 
+  // A host frame received since the last tick is swapped in instead of rendering the effect.
+  const chromance::core::Rgb* host_frame = serial_frames.take_frame();
+  if (serial_streaming_at(now_ms)) {
+    effect_manager.invalidate_frame();
+    if (host_frame != nullptr) {
+      chromance::platform::PerfStats stats{0, 0};
+      led_out.set_brightness(params.brightness);
+      led_out.show(host_frame, kLedCount, &stats);
+      control_channel.offer_preview(host_frame, kLedCount, now_ms);
+    }
+    if (static_cast<int32_t>(now_ms - last_stats_ms) >= 1000) {
+      last_stats_ms = now_ms;
+      const chromance::core::SerialFrameStats& ss = serial_frames.stats();
+      Serial.print("serial frames=");
+      Serial.print(ss.frames);
+      Serial.print(" crc_errors=");
+      Serial.print(ss.crc_errors);
+      Serial.print(" header_errors=");
+      Serial.print(ss.header_errors);
+      Serial.print(" overruns=");
+      Serial.print(ss.overruns);
+      Serial.print(" aborted=");
+      Serial.println(ss.aborted);
+    }
+    return;
+  }
+
   chromance::platform::PerfStats stats{0, 0};
   chromance::core::Signals signals;
-  modulation.get_signals(now_ms, &signals);
-  effect_manager.tick(now_ms, scheduler.dt_ms(), signals);
-  effect_manager.render(rgb, kLedCount);
+  modulation->get_signals(now_ms, &signals);
+  (void)param_updates.apply(effect_manager);
+  effect_manager.tick(frame_now_ms, scheduler.dt_ms(), signals);
+  if (!effect_manager.frame_due(frame_now_ms)) {
+    // Identical to what the LEDs already show: skip render and flush until the effect's next change.
+    scheduler.hold_until(effect_manager.next_change_ms());
+    return;
+  }
+  const uint32_t render_start_us = micros();
+  // Wire path: the effect writes wire pixels and the output sends them unconverted. Fades, layers and effects
+  // without render_wire fall back to the Rgb frame.
+  const bool wire = kWireFramesEnabled && led_out.accepts_wire_frames() &&
+                    effect_manager.render_wire(wire_frame, kLedCount);
+  if (!wire) {
+    effect_manager.render(rgb, kLedCount);
+  }
+  effect_manager.note_render_us(micros() - render_start_us);
+  led_out.set_brightness(255);  // effects apply brightness themselves
   const uint32_t frame_start_ms = millis();
-  led_out.show(rgb, kLedCount, &stats);
+  if (wire) {
+    led_out.show_wire(wire_frame, kLedCount, &stats);
+  } else {
+    led_out.show(rgb, kLedCount, &stats);
+  }
   stats.frame_ms = millis() - frame_start_ms;
+  const uint32_t frame_work_us = micros() - render_start_us;
+  scheduler.note_work_us(frame_work_us);
+  power_governor.note_frame_us(frame_work_us, frame_ms * 1000U);
+  if (wire && control_channel.client_count() > 0) {
+    chromance::core::decode_apa102(wire_frame, rgb, kLedCount);  // previews stay Rgb
+  }
+  control_channel.offer_preview(rgb, kLedCount, now_ms);
+  if (!effect_manager.frame_due(frame_now_ms)) {
+    scheduler.hold_until(effect_manager.next_change_ms());
+  }
 
   if (current_mode == 2) {
     const uint8_t k = strip_segment_stepper.segment_number();
@@ -560,6 +1192,21 @@ void loop() {
     Serial.print("flush_ms=");
     Serial.print(stats.flush_ms);
     Serial.print(" frame_ms=");
-    Serial.println(stats.frame_ms);
+    Serial.print(stats.frame_ms);
+    chromance::platform::MemoryStats mem;
+    chromance::platform::read_heap_stats(&mem);
+    Serial.print(" heap_free=");
+    Serial.print(mem.free_heap);
+    Serial.print(" heap_min=");
+    Serial.print(mem.min_free_heap);
+    Serial.print(" heap_largest=");
+    Serial.print(mem.largest_free_block);
+    Serial.print(" fx_scratch=");
+    Serial.print(static_cast<unsigned>(effect_manager.scratch_peak_bytes()));
+    Serial.print("/");
+    Serial.println(static_cast<unsigned>(effect_manager.scratch_capacity()));
+    if (kSyncRole != 0) {
+      print_sync_stats();
+    }
   }
 }
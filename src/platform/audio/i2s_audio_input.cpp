@@ -0,0 +1,95 @@
+#include "i2s_audio_input.h"
+
+#include <driver/i2s.h>
+#include <esp_idf_version.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace chromance {
+namespace platform {
+
+namespace {
+
+constexpr i2s_port_t kPort = I2S_NUM_0;
+constexpr uint32_t kTaskStackBytes = 4096;
+constexpr UBaseType_t kTaskPriority = 1;  // WiFi/lwIP run above this on core 0
+constexpr BaseType_t kTaskCore = 0;       // Arduino loop() (rendering) runs on core 1
+
+uint32_t clock_us() { return static_cast<uint32_t>(micros()); }
+
+}  // namespace
+
+bool I2sAudioInput::begin(const I2sAudioConfig& config) {
+  config_ = config;
+  if (config.bck_pin < 0 || config.ws_pin < 0 || config.data_pin < 0) {
+    Serial.println("Audio: I2S pins not configured; audio modulation disabled.");
+    return false;
+  }
+
+  i2s_config_t i2s = {};
+  i2s.mode = static_cast<i2s_mode_t>(I2S_MODE_MASTER | I2S_MODE_RX);
+  i2s.sample_rate = config.sample_rate;
+  i2s.bits_per_sample = I2S_BITS_PER_SAMPLE_32BIT;
+  i2s.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+  i2s.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+  i2s.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1;
+  i2s.dma_buf_count = 4;
+  i2s.dma_buf_len = static_cast<int>(kChunkFrames);
+  i2s.use_apll = false;
+  if (i2s_driver_install(kPort, &i2s, 0, nullptr) != ESP_OK) {
+    Serial.println("Audio: i2s_driver_install failed; audio modulation disabled.");
+    return false;
+  }
+
+  i2s_pin_config_t pins = {};
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 4, 0)
+  pins.mck_io_num = I2S_PIN_NO_CHANGE;
+#endif
+  pins.bck_io_num = config.bck_pin;
+  pins.ws_io_num = config.ws_pin;
+  pins.data_out_num = I2S_PIN_NO_CHANGE;
+  pins.data_in_num = config.data_pin;
+  if (i2s_set_pin(kPort, &pins) != ESP_OK) {
+    i2s_driver_uninstall(kPort);
+    Serial.println("Audio: i2s_set_pin failed; audio modulation disabled.");
+    return false;
+  }
+
+  analyzer_.begin(config.sample_rate, clock_us);
+  if (xTaskCreatePinnedToCore(task_entry, "audio", kTaskStackBytes, this, kTaskPriority, nullptr, kTaskCore) !=
+      pdPASS) {
+    i2s_driver_uninstall(kPort);
+    Serial.println("Audio: task create failed; audio modulation disabled.");
+    return false;
+  }
+  Serial.print("Audio: I2S capture at ");
+  Serial.print(static_cast<unsigned>(config.sample_rate));
+  Serial.println(" Hz");
+  return true;
+}
+
+void I2sAudioInput::task_entry(void* arg) { static_cast<I2sAudioInput*>(arg)->run(); }
+
+void I2sAudioInput::run() {
+  for (;;) {
+    size_t bytes_read = 0;
+    if (i2s_read(kPort, raw_, sizeof(raw_), &bytes_read, portMAX_DELAY) != ESP_OK || bytes_read == 0) {
+      read_errors_ = read_errors_ + 1U;
+      vTaskDelay(1);
+      continue;
+    }
+    const size_t frames = bytes_read / sizeof(raw_[0]);
+    for (size_t i = 0; i < frames; ++i) {
+      int32_t v = raw_[i] >> config_.sample_shift;
+      if (v > 32767) v = 32767;
+      if (v < -32768) v = -32768;
+      pcm_[i] = static_cast<int16_t>(v);
+    }
+    if (analyzer_.feed(pcm_, frames, millis()) > 0) {
+      snapshot_.write(analyzer_.features());
+    }
+  }
+}
+
+}  // namespace platform
+}  // namespace chromance
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <stdint.h>
+
+#include "core/audio/audio_analyzer.h"
+#include "core/seqlock_snapshot.h"
+
+namespace chromance {
+namespace platform {
+
+struct I2sAudioConfig {
+  int bck_pin = -1;
+  int ws_pin = -1;
+  int data_pin = -1;
+  uint32_t sample_rate = 16000;
+  // I2S MEMS mics (INMP441, SPH0645, ICS-43434) deliver 24-bit samples left-justified in 32-bit slots; this
+  // right shift maps them onto PCM16 with some gain. Results are saturated.
+  uint8_t sample_shift = 14;
+};
+
+// I2S microphone capture on its own FreeRTOS task (core 0, below WiFi priority). The task blocks on DMA
+// reads, feeds core::AudioAnalyzer and publishes every result through a lock-free snapshot; the render loop
+// reads it via core::AudioModulationProvider and never waits on the task.
+class I2sAudioInput {
+ public:
+  static constexpr size_t kFftSize = 512;
+  static constexpr size_t kChunkFrames = 256;  // one DMA buffer per read
+
+  // Installs the I2S driver and starts the task. False (and no task) when pins are missing or install fails.
+  bool begin(const I2sAudioConfig& config);
+
+  const chromance::core::SeqLockSnapshot<chromance::core::AudioFeatures>* features() const { return &snapshot_; }
+  uint32_t read_errors() const { return read_errors_; }
+
+ private:
+  static void task_entry(void* arg);
+  void run();
+
+  I2sAudioConfig config_{};
+  chromance::core::AudioAnalyzer<kFftSize> analyzer_;
+  chromance::core::SeqLockSnapshot<chromance::core::AudioFeatures> snapshot_;
+  int32_t raw_[kChunkFrames] = {};
+  int16_t pcm_[kChunkFrames] = {};
+  volatile uint32_t read_errors_ = 0;
+};
+
+}  // namespace platform
+}  // namespace chromance
@@ -0,0 +1,40 @@
+#include "clip_store.h"
+
+#include <esp_partition.h>
+#include <esp_spi_flash.h>
+
+namespace chromance {
+namespace platform {
+
+bool ClipStore::begin() {
+  if (mapped_) {
+    return bundle_.count() > 0;
+  }
+  const esp_partition_t* part =
+      esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, kPartitionLabel);
+  if (part == nullptr) {
+    part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, nullptr);
+  }
+  if (part == nullptr) {
+    return false;
+  }
+
+  const void* ptr = nullptr;
+  spi_flash_mmap_handle_t handle = 0;
+  if (esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &ptr, &handle) != ESP_OK) {
+    return false;
+  }
+  if (!bundle_.open(static_cast<const uint8_t*>(ptr), part->size)) {
+    // Erased flash or a SPIFFS image: release the mapping (MMU pages are a shared resource).
+    spi_flash_munmap(handle);
+    return false;
+  }
+  mmap_handle_ = handle;
+  mapped_ = true;
+  label_ = part->label;
+  size_ = part->size;
+  return bundle_.count() > 0;
+}
+
+}  // namespace platform
+}  // namespace chromance
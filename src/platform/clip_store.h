@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/clip/clip_format.h"
+
+namespace chromance {
+namespace platform {
+
+// Memory-maps the clip bundle partition (read-only, through the flash cache) so ClipPlayerEffect reads clips
+// in place: no copy into RAM and no filesystem on the render path.
+//
+// Looks for a data partition labelled "clips" first and otherwise reuses the SPIFFS data partition of the
+// stock partition table as a raw region. Clips are flashed there with esptool (see tools/clip_baker); a SPIFFS
+// filesystem image cannot be used because its files are not stored contiguously.
+class ClipStore {
+ public:
+  static constexpr const char* kPartitionLabel = "clips";
+
+  // Maps the partition and parses the bundle directory. False if no partition or no valid bundle.
+  bool begin();
+
+  const chromance::core::ClipBundle& bundle() const { return bundle_; }
+  const char* partition_label() const { return label_; }
+  size_t partition_size() const { return size_; }
+
+ private:
+  chromance::core::ClipBundle bundle_;
+  const char* label_ = nullptr;
+  size_t size_ = 0;
+  uint32_t mmap_handle_ = 0;
+  bool mapped_ = false;
+};
+
+}  // namespace platform
+}  // namespace chromance
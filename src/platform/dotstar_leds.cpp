@@ -10,6 +10,7 @@ namespace platform {
 namespace {
 
 constexpr uint8_t kDotstarColorOrder = DOTSTAR_BRG;
+static_assert(core::kStripColorOrder == core::ColorOrder::kBrg, "diagnostic strips must use the wire colour order");
 
 Adafruit_DotStar* make_strip(const core::StripConfig& cfg) {
   return new Adafruit_DotStar(core::strip_led_count(cfg),
@@ -22,8 +23,12 @@ Adafruit_DotStar* make_strip(const core::StripConfig& cfg) {
 
 void DotstarLeds::begin() {
   for (uint8_t i = 0; i < core::kStripCount; ++i) {
+    const core::StripConfig cfg = core::strip_config(i);
+    if (cfg.data_pin == core::kUnassignedPin || cfg.clock_pin == core::kUnassignedPin) {
+      continue;
+    }
     if (strips_[i] == nullptr) {
-      strips_[i] = make_strip(core::kStripConfigs[i]);
+      strips_[i] = make_strip(cfg);
     }
     if (strips_[i] == nullptr) {
       continue;
@@ -40,7 +45,7 @@ void DotstarLeds::clear_all() {
     if (strips_[strip] == nullptr) {
       continue;
     }
-    for (uint16_t i = 0; i < core::strip_led_count(core::kStripConfigs[strip]); ++i) {
+    for (uint16_t i = 0; i < core::strip_led_count(core::strip_config(strip)); ++i) {
       strips_[strip]->setPixelColor(i, 0, 0, 0);
     }
   }
@@ -66,7 +71,7 @@ void DotstarLeds::set_segment_all(uint8_t strip_index,
     return;
   }
 
-  const core::StripConfig& cfg = core::kStripConfigs[strip_index];
+  const core::StripConfig cfg = core::strip_config(strip_index);
   if (!core::is_valid_segment_index(cfg, segment_index)) {
     return;
   }
@@ -93,7 +98,7 @@ void DotstarLeds::set_segment_single_led(uint8_t strip_index,
     return;
   }
 
-  const core::StripConfig& cfg = core::kStripConfigs[strip_index];
+  const core::StripConfig cfg = core::strip_config(strip_index);
   if (!core::is_valid_segment_index(cfg, segment_index)) {
     return;
   }
@@ -28,7 +28,7 @@ class DotstarLeds : public core::IDiagnosticRenderer {
                               core::Rgb color) override;
 
  private:
-  Adafruit_DotStar* strips_[core::kStripCount] = {nullptr, nullptr, nullptr, nullptr};
+  Adafruit_DotStar* strips_[core::kStripCount] = {};
 };
 
 }  // namespace platform
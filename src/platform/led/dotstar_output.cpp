@@ -3,14 +3,23 @@
 #include <Arduino.h>
 
 #include "core/mapping/mapping_tables.h"
+#include "core/strip_layout.h"
 
 namespace chromance {
 namespace platform {
 
 namespace {
 
-constexpr uint8_t kDotstarColorOrder = DOTSTAR_BRG;
-constexpr uint8_t kDotstarBrightness = 255;
+constexpr uint8_t dotstar_color_order(core::ColorOrder order) {
+  return order == core::ColorOrder::kRgb   ? DOTSTAR_RGB
+         : order == core::ColorOrder::kRbg ? DOTSTAR_RBG
+         : order == core::ColorOrder::kGrb ? DOTSTAR_GRB
+         : order == core::ColorOrder::kGbr ? DOTSTAR_GBR
+         : order == core::ColorOrder::kBrg ? DOTSTAR_BRG
+                                           : DOTSTAR_BGR;
+}
+
+constexpr uint8_t kDotstarColorOrder = dotstar_color_order(core::kStripColorOrder);
 
 Adafruit_DotStar* make_strip(uint16_t led_count, const core::StripConfig& cfg) {
   return new Adafruit_DotStar(led_count,
@@ -42,17 +51,21 @@ void DotstarOutput::begin() {
   }
 
   for (uint8_t i = 0; i < core::kStripCount; ++i) {
+    const core::StripConfig cfg = core::strip_config(i);
+    if (cfg.data_pin == core::kUnassignedPin || cfg.clock_pin == core::kUnassignedPin) {
+      strip_used_len_[i] = 0;  // no pins in the wiring file: not driven
+    }
     if (strip_used_len_[i] == 0) {
       continue;
     }
     if (strips_[i] == nullptr) {
-      strips_[i] = make_strip(strip_used_len_[i], core::kStripConfigs[i]);
+      strips_[i] = make_strip(strip_used_len_[i], cfg);
     }
     if (strips_[i] == nullptr) {
       continue;
     }
     strips_[i]->begin();
-    strips_[i]->setBrightness(kDotstarBrightness);
+    strips_[i]->setBrightness(brightness_);
     for (uint16_t p = 0; p < strip_used_len_[i]; ++p) {
       strips_[i]->setPixelColor(p, 0, 0, 0);
     }
@@ -60,6 +73,18 @@ void DotstarOutput::begin() {
   }
 }
 
+void DotstarOutput::set_brightness(uint8_t brightness) {
+  if (brightness == brightness_) {
+    return;
+  }
+  brightness_ = brightness;
+  for (uint8_t i = 0; i < core::kStripCount; ++i) {
+    if (strips_[i] != nullptr) {
+      strips_[i]->setBrightness(brightness_);
+    }
+  }
+}
+
 void DotstarOutput::show(const chromance::core::Rgb* rgb, size_t len, PerfStats* stats) {
   if (rgb == nullptr) {
     return;
@@ -69,6 +94,18 @@ void DotstarOutput::show(const chromance::core::Rgb* rgb, size_t len, PerfStats*
     return;
   }
 
+  if (core::MappingTables::wire_order()) {
+    // Every strip is one contiguous span of the frame: hand the spans over as they are, no per-LED lookups.
+    const chromance::core::Rgb* spans[core::kStripCount];
+    size_t lens[core::kStripCount];
+    for (uint8_t strip = 0; strip < core::kStripCount; ++strip) {
+      spans[strip] = rgb + core::strip_first_led(strip);
+      lens[strip] = core::strip_led_count(core::strip_config(strip));
+    }
+    show_strips(spans, lens, core::kStripCount, stats);
+    return;
+  }
+
   const uint8_t* g2s = core::MappingTables::global_to_strip();
   const uint16_t* g2l = core::MappingTables::global_to_local();
 
@@ -22,9 +22,14 @@ class DotstarOutput final : public ILedOutput {
                    size_t strip_count,
                    PerfStats* stats) override;
 
+  // Output-stage scale (0..255) for frames that did not come through an effect (which applies brightness
+  // itself), e.g. realtime network input. 255 leaves pixels unchanged.
+  void set_brightness(uint8_t brightness);
+
  private:
-  Adafruit_DotStar* strips_[core::kStripCount] = {nullptr, nullptr, nullptr, nullptr};
-  uint16_t strip_used_len_[core::kStripCount] = {0, 0, 0, 0};
+  Adafruit_DotStar* strips_[core::kStripCount] = {};
+  uint16_t strip_used_len_[core::kStripCount] = {};
+  uint8_t brightness_ = 255;
 };
 
 }  // namespace platform
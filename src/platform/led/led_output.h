@@ -3,6 +3,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "core/layout.h"
 #include "core/types.h"
 
 namespace chromance {
@@ -24,6 +25,11 @@ class ILedOutput {
                            const size_t* /*len_by_strip*/,
                            size_t /*strip_count*/,
                            PerfStats* /*stats*/) {}
+
+  // Optional: a frame already in wire format (core::StripPixel, global LED order), sent without per-pixel
+  // conversion. Only called when accepts_wire_frames() is true.
+  virtual bool accepts_wire_frames() const { return false; }
+  virtual void show_wire(const chromance::core::StripPixel* /*frame*/, size_t /*len*/, PerfStats* /*stats*/) {}
 };
 
 }  // namespace platform
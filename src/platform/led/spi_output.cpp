@@ -0,0 +1,376 @@
+#include "spi_output.h"
+
+#include <Arduino.h>
+
+#include <driver/gpio.h>
+#include <esp_heap_caps.h>
+#include <esp_rom_gpio.h>
+#include <soc/gpio_sig_map.h>
+#include <soc/spi_periph.h>
+
+#include "core/apa102.h"
+#include "core/mapping/mapping_tables.h"
+#include "core/strip_layout.h"
+
+namespace chromance {
+namespace platform {
+
+namespace {
+
+constexpr spi_host_device_t kHosts[core::kSpiBusCount] = {HSPI_HOST, VSPI_HOST};
+
+// Strip pin each host's clock is routed to right now (kUnassignedPin: none). Read and written by route_clock()
+// in the driver's ISR, so kept in internal RAM.
+DRAM_ATTR volatile uint8_t g_routed_clock_pin[core::kSpiBusCount] = {core::kUnassignedPin, core::kUnassignedPin};
+
+void park_pin_low(uint8_t pin) {
+  esp_rom_gpio_pad_select_gpio(pin);
+  gpio_set_direction(static_cast<gpio_num_t>(pin), GPIO_MODE_OUTPUT);
+  gpio_set_level(static_cast<gpio_num_t>(pin), 0);
+  esp_rom_gpio_connect_out_signal(pin, SIG_GPIO_OUT_IDX, false, false);
+}
+
+uint8_t scale(uint8_t c, uint8_t brightness) {
+  return static_cast<uint8_t>((static_cast<uint16_t>(c) * (static_cast<uint16_t>(brightness) + 1U)) >> 8);
+}
+
+}  // namespace
+
+void IRAM_ATTR SpiOutput::route_clock(spi_transaction_t* trans) {
+  const ClockRoute* route = static_cast<const ClockRoute*>(trans->user);
+  const uint8_t previous = g_routed_clock_pin[route->bus];
+  if (previous == route->clock_pin) {
+    return;
+  }
+  // SPI mode 0 idles the clock low between transfers, and parked pins are driven low: no stray edge.
+  if (previous != core::kUnassignedPin) {
+    esp_rom_gpio_connect_out_signal(previous, SIG_GPIO_OUT_IDX, false, false);
+  }
+  esp_rom_gpio_connect_out_signal(route->clock_pin, route->clock_signal, false, false);
+  g_routed_clock_pin[route->bus] = route->clock_pin;
+}
+
+void SpiOutput::begin() {
+  for (uint8_t i = 0; i < core::kStripCount; ++i) {
+    strip_used_len_[i] = 0;
+    if (clock_hz_[i] == 0) {
+      clock_hz_[i] = core::kSpiDefaultClockHz;
+    }
+  }
+
+  const uint16_t expected = core::MappingTables::led_count();
+  const uint8_t* g2s = core::MappingTables::global_to_strip();
+  const uint16_t* g2l = core::MappingTables::global_to_local();
+  for (uint16_t i = 0; i < expected; ++i) {
+    const uint8_t strip = g2s[i];
+    if (strip >= core::kStripCount) {
+      continue;
+    }
+    const uint16_t needed = static_cast<uint16_t>(g2l[i] + 1);
+    if (needed > strip_used_len_[strip]) {
+      strip_used_len_[strip] = needed;
+    }
+  }
+
+  uint16_t longest = 0;
+  for (uint8_t i = 0; i < core::kStripCount; ++i) {
+    const core::StripConfig cfg = core::strip_config(i);
+    if (cfg.data_pin == core::kUnassignedPin || cfg.clock_pin == core::kUnassignedPin) {
+      strip_used_len_[i] = 0;  // no pins in the wiring file: not driven
+    }
+    if (strip_used_len_[i] == 0) {
+      continue;
+    }
+    if (buffers_[i] == nullptr) {
+      buffers_[i] = static_cast<core::StripPixel*>(
+          heap_caps_malloc(strip_used_len_[i] * sizeof(core::StripPixel), MALLOC_CAP_DMA));
+    }
+    if (buffers_[i] == nullptr) {
+      Serial.println("LED SPI: out of DMA memory; strip not driven.");
+      strip_used_len_[i] = 0;
+      continue;
+    }
+    for (uint16_t p = 0; p < strip_used_len_[i]; ++p) {
+      buffers_[i][p].set(core::kBlack);
+    }
+    if (strip_used_len_[i] > longest) {
+      longest = strip_used_len_[i];
+    }
+  }
+
+  end_frame_len_ = core::apa102_end_frame_bytes(longest);
+  if (end_frame_ == nullptr && end_frame_len_ != 0) {
+    end_frame_ = static_cast<uint8_t*>(heap_caps_malloc((end_frame_len_ + 3U) & ~size_t{3}, MALLOC_CAP_DMA));
+    if (end_frame_ == nullptr) {
+      end_frame_len_ = 0;
+    }
+  }
+  for (size_t i = 0; i < end_frame_len_; ++i) {
+    end_frame_[i] = core::kApa102EndFrameByte;
+  }
+
+  for (uint8_t b = 0; b < core::kSpiBusCount; ++b) {
+    g_routed_clock_pin[b] = core::kUnassignedPin;
+  }
+  started_ = true;
+  configure();
+  send(buffers_, nullptr);
+}
+
+void SpiOutput::set_strip_clock_hz(uint8_t strip, uint32_t hz) {
+  if (strip >= core::kStripCount || clock_hz_[strip] == hz) {
+    return;
+  }
+  clock_hz_[strip] = hz;
+  if (started_) {
+    configure();
+  }
+}
+
+uint8_t SpiOutput::undriven_strips() const {
+  uint8_t n = 0;
+  for (uint8_t s = 0; s < core::kStripCount; ++s) {
+    if (strip_used_len_[s] != 0 && strip_device_[s] == nullptr) {
+      ++n;
+    }
+  }
+  return n;
+}
+
+void SpiOutput::release_devices() {
+  for (uint8_t b = 0; b < core::kSpiBusCount; ++b) {
+    for (uint8_t k = 0; k < core::kSpiClocksPerBus; ++k) {
+      if (devices_[b][k] != nullptr) {
+        spi_bus_remove_device(devices_[b][k]);
+        devices_[b][k] = nullptr;
+      }
+    }
+  }
+  for (uint8_t s = 0; s < core::kStripCount; ++s) {
+    strip_device_[s] = nullptr;
+  }
+}
+
+void SpiOutput::configure() {
+  release_devices();
+
+  core::SpiStripRequest requests[core::kStripCount];
+  for (uint8_t s = 0; s < core::kStripCount; ++s) {
+    const core::StripConfig cfg = core::strip_config(s);
+    requests[s].led_count = strip_used_len_[s];
+    requests[s].data_pin = cfg.data_pin;
+    requests[s].clock_pin = cfg.clock_pin;
+    requests[s].clock_hz = clock_hz_[s];
+  }
+  plan_ = core::plan_spi_buses(requests, core::kStripCount);
+
+  for (uint8_t b = 0; b < core::kSpiBusCount; ++b) {
+    if (bus_ready_[b] || plan_.bus_clock_count[b] == 0) {
+      continue;
+    }
+    spi_bus_config_t bus{};
+    bus.mosi_io_num = -1;  // routed per strip below
+    bus.miso_io_num = -1;
+    bus.sclk_io_num = -1;
+    bus.quadwp_io_num = -1;
+    bus.quadhd_io_num = -1;
+    // Sized for every strip, not just this plan's: set_strip_clock_hz() may move strips between hosts.
+    bus.max_transfer_sz = static_cast<int>(core::kTotalLeds * sizeof(core::StripPixel));
+    bus.flags = SPICOMMON_BUSFLAG_MASTER;
+    if (plan_.bus_exclusive[b]) {
+      bus.mosi_io_num = core::kSpiNativePins[b].data_pin;
+      bus.sclk_io_num = core::kSpiNativePins[b].clock_pin;
+      bus.flags |= SPICOMMON_BUSFLAG_IOMUX_PINS;
+    }
+    bus_ready_[b] = spi_bus_initialize(kHosts[b], &bus, SPI_DMA_CH_AUTO) == ESP_OK;
+    if (!bus_ready_[b]) {
+      Serial.println("LED SPI: spi_bus_initialize failed; its strips are not driven.");
+    }
+  }
+
+  uint8_t strips_on_device[core::kSpiBusCount][core::kSpiClocksPerBus] = {};
+  for (uint8_t s = 0; s < plan_.strip_count; ++s) {
+    const core::SpiStripPlan& p = plan_.strips[s];
+    if (p.bus != core::SpiBus::kNone) {
+      ++strips_on_device[static_cast<uint8_t>(p.bus)][p.clock_slot];
+    }
+  }
+  for (uint8_t b = 0; b < core::kSpiBusCount; ++b) {
+    if (!bus_ready_[b]) {
+      continue;
+    }
+    for (uint8_t k = 0; k < plan_.bus_clock_count[b]; ++k) {
+      spi_device_interface_config_t dev{};
+      dev.mode = 0;
+      dev.clock_speed_hz = static_cast<int>(plan_.bus_clock_hz[b][k]);
+      dev.spics_io_num = -1;
+      dev.queue_size = 3 * strips_on_device[b][k];  // start, pixels, end per strip: queuing never blocks
+      dev.pre_cb = plan_.bus_exclusive[b] ? nullptr : &SpiOutput::route_clock;
+      if (spi_bus_add_device(kHosts[b], &dev, &devices_[b][k]) != ESP_OK) {
+        devices_[b][k] = nullptr;
+        Serial.println("LED SPI: spi_bus_add_device failed; its strips are not driven.");
+      }
+    }
+  }
+
+  // Pins: every matrix-routed strip's data pin carries its host's MOSI; clock pins stay parked low until
+  // route_clock() hands them the host's clock.
+  // A re-plan may move strips between hosts, so every matrix-routed pin is parked first.
+  for (uint8_t b = 0; b < core::kSpiBusCount; ++b) {
+    g_routed_clock_pin[b] = core::kUnassignedPin;
+  }
+  for (uint8_t s = 0; s < plan_.strip_count; ++s) {
+    if (strip_used_len_[s] != 0 && !plan_.strips[s].native_pins) {
+      const core::StripConfig cfg = core::strip_config(s);
+      park_pin_low(cfg.clock_pin);
+      park_pin_low(cfg.data_pin);
+    }
+  }
+  for (uint8_t s = 0; s < plan_.strip_count; ++s) {
+    const core::SpiStripPlan& p = plan_.strips[s];
+    if (p.bus == core::SpiBus::kNone) {
+      continue;
+    }
+    const uint8_t b = static_cast<uint8_t>(p.bus);
+    strip_device_[s] = devices_[b][p.clock_slot];
+    if (p.native_pins || strip_device_[s] == nullptr) {
+      continue;
+    }
+    const core::StripConfig cfg = core::strip_config(s);
+    esp_rom_gpio_connect_out_signal(cfg.data_pin, spi_periph_signal[kHosts[b]].spid_out, false, false);
+    routes_[s].clock_signal = spi_periph_signal[kHosts[b]].spiclk_out;
+    routes_[s].clock_pin = cfg.clock_pin;
+    routes_[s].bus = b;
+  }
+}
+
+void SpiOutput::encode_strip(uint8_t strip, const chromance::core::Rgb* rgb, size_t len) {
+  core::StripPixel* out = buffers_[strip];
+  for (uint16_t p = 0; p < strip_used_len_[strip]; ++p) {
+    if (rgb != nullptr && p < len) {
+      const chromance::core::Rgb c = rgb[p];
+      out[p].set(brightness_ == 255 ? c
+                                    : chromance::core::Rgb{scale(c.r, brightness_), scale(c.g, brightness_),
+                                                           scale(c.b, brightness_)});
+    } else {
+      out[p].set(core::kBlack);
+    }
+  }
+}
+
+void SpiOutput::send(const chromance::core::StripPixel* const* body_by_strip, PerfStats* stats) {
+  const uint32_t start_ms = millis();
+  // Queue start frame, pixels and end frame of every strip up front: both hosts then run through their
+  // strips by DMA, in parallel, while this task sleeps in get_trans_result.
+  uint8_t queued[core::kStripCount] = {};
+  for (uint8_t s = 0; s < core::kStripCount; ++s) {
+    if (strip_used_len_[s] == 0 || strip_device_[s] == nullptr || body_by_strip[s] == nullptr) {
+      continue;
+    }
+    spi_transaction_t* t = trans_[s];
+    for (uint8_t k = 0; k < 3; ++k) {
+      t[k] = spi_transaction_t{};
+      t[k].user = &routes_[s];
+    }
+    t[0].flags = SPI_TRANS_USE_TXDATA;  // start frame: 32 zero bits
+    t[0].length = core::kApa102StartFrameBytes * 8U;
+    t[1].tx_buffer = body_by_strip[s];
+    t[1].length = strip_used_len_[s] * sizeof(core::StripPixel) * 8U;
+    t[2].tx_buffer = end_frame_;
+    t[2].length = core::apa102_end_frame_bytes(strip_used_len_[s]) * 8U;
+    const uint8_t n = t[2].length != 0 && end_frame_ != nullptr ? 3 : 2;
+    for (uint8_t k = 0; k < n; ++k) {
+      if (spi_device_queue_trans(strip_device_[s], &t[k], portMAX_DELAY) != ESP_OK) {
+        break;
+      }
+      ++queued[s];
+    }
+  }
+  for (uint8_t s = 0; s < core::kStripCount; ++s) {
+    for (uint8_t k = 0; k < queued[s]; ++k) {
+      spi_transaction_t* done = nullptr;
+      spi_device_get_trans_result(strip_device_[s], &done, portMAX_DELAY);
+    }
+  }
+
+  if (stats != nullptr) {
+    stats->flush_ms = millis() - start_ms;
+  }
+}
+
+void SpiOutput::show(const chromance::core::Rgb* rgb, size_t len, PerfStats* stats) {
+  if (rgb == nullptr || len != core::MappingTables::led_count()) {
+    return;
+  }
+
+  if (core::MappingTables::wire_order()) {
+    for (uint8_t strip = 0; strip < core::kStripCount; ++strip) {
+      if (buffers_[strip] != nullptr) {
+        encode_strip(strip, rgb + core::strip_first_led(strip), core::strip_led_count(core::strip_config(strip)));
+      }
+    }
+  } else {
+    const uint8_t* g2s = core::MappingTables::global_to_strip();
+    const uint16_t* g2l = core::MappingTables::global_to_local();
+    for (uint16_t i = 0; i < len; ++i) {
+      const uint8_t strip = g2s[i];
+      const uint16_t local = g2l[i];
+      if (strip >= core::kStripCount || local >= strip_used_len_[strip] || buffers_[strip] == nullptr) {
+        continue;
+      }
+      const chromance::core::Rgb c = rgb[i];
+      buffers_[strip][local].set(brightness_ == 255 ? c
+                                                    : chromance::core::Rgb{scale(c.r, brightness_),
+                                                                           scale(c.g, brightness_),
+                                                                           scale(c.b, brightness_)});
+    }
+  }
+  send(buffers_, stats);
+}
+
+void SpiOutput::show_strips(const chromance::core::Rgb* const* rgb_by_strip,
+                            const size_t* len_by_strip,
+                            size_t strip_count,
+                            PerfStats* stats) {
+  if (rgb_by_strip == nullptr || len_by_strip == nullptr) {
+    return;
+  }
+  const size_t n = strip_count < core::kStripCount ? strip_count : core::kStripCount;
+  for (uint8_t strip = 0; strip < n; ++strip) {
+    if (buffers_[strip] != nullptr) {
+      encode_strip(strip, rgb_by_strip[strip], len_by_strip[strip]);
+    }
+  }
+  send(buffers_, stats);
+}
+
+void SpiOutput::show_wire(const chromance::core::StripPixel* frame, size_t len, PerfStats* stats) {
+  if (frame == nullptr || len != core::MappingTables::led_count()) {
+    return;
+  }
+
+  if (core::MappingTables::wire_order()) {
+    // Each strip's pixels are one span of the frame, already in wire format: DMA straight from it.
+    const chromance::core::StripPixel* spans[core::kStripCount];
+    for (uint8_t strip = 0; strip < core::kStripCount; ++strip) {
+      spans[strip] = frame + core::strip_first_led(strip);
+    }
+    send(spans, stats);
+    return;
+  }
+
+  // Index order: gather 4-byte wire pixels into the strip buffers, no colour conversion.
+  const uint8_t* g2s = core::MappingTables::global_to_strip();
+  const uint16_t* g2l = core::MappingTables::global_to_local();
+  for (uint16_t i = 0; i < len; ++i) {
+    const uint8_t strip = g2s[i];
+    const uint16_t local = g2l[i];
+    if (strip < core::kStripCount && local < strip_used_len_[strip] && buffers_[strip] != nullptr) {
+      buffers_[strip][local] = frame[i];
+    }
+  }
+  send(buffers_, stats);
+}
+
+}  // namespace platform
+}  // namespace chromance
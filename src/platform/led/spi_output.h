@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <driver/spi_master.h>
+
+#include "core/layout.h"
+#include "core/spi_bus_plan.h"
+#include "led_output.h"
+
+namespace chromance {
+namespace platform {
+
+// DotStar output on the ESP32's hardware SPI hosts (HSPI/VSPI) with DMA, instead of the DotStar library's
+// bit-banged GPIO. core::plan_spi_buses() spreads the strips over the two hosts, which run in parallel; strips
+// sharing a host go out one after another. Their data pins all carry the host's MOSI through the GPIO matrix,
+// and the host's clock is routed to the pin of the strip being sent just before each transfer, so the others
+// see no clock edges and ignore the data. A strip rewired onto a host's IO_MUX pins gets that host alone.
+//
+// Each strip has its own clock (set_strip_clock_hz); strips on one host with the same clock share a driver
+// device. Pixels are staged as wire pixels (core::StripPixel) in DMA-capable buffers. Wire frames from
+// render_wire go out as they are: in wire-order builds each strip's span of the frame is the DMA source.
+class SpiOutput final : public ILedOutput {
+ public:
+  SpiOutput() = default;
+  ~SpiOutput() override = default;
+
+  void begin() override;
+  void show(const chromance::core::Rgb* rgb, size_t len, PerfStats* stats) override;
+  void show_strips(const chromance::core::Rgb* const* rgb_by_strip,
+                   const size_t* len_by_strip,
+                   size_t strip_count,
+                   PerfStats* stats) override;
+
+  // frame must be in DMA-capable memory (internal RAM, as static arrays are) and stay untouched until this
+  // returns. Sent as is: set_brightness() does not apply.
+  bool accepts_wire_frames() const override { return true; }
+  void show_wire(const chromance::core::StripPixel* frame, size_t len, PerfStats* stats) override;
+
+  // Output-stage scale (0..255) for Rgb frames that did not come through an effect, as DotstarOutput.
+  void set_brightness(uint8_t brightness) { brightness_ = brightness; }
+
+  // Requested SPI clock for one strip (clamped by the plan). Before begin() this only records it; afterwards
+  // the strips are re-planned and the driver devices rebuilt.
+  void set_strip_clock_hz(uint8_t strip, uint32_t hz);
+  uint32_t strip_clock_hz(uint8_t strip) const { return strip < core::kStripCount ? clock_hz_[strip] : 0; }
+
+  const core::SpiBusPlan& plan() const { return plan_; }
+  // Strips with LEDs and pins left undriven: no host could take them, or the driver refused the bus/device.
+  uint8_t undriven_strips() const;
+
+ private:
+  // What the pre-transfer callback needs to route a host's clock to one strip.
+  struct ClockRoute {
+    uint16_t clock_signal;  // the host's SPICLK output in the GPIO matrix
+    uint8_t clock_pin;
+    uint8_t bus;
+  };
+
+  static void route_clock(spi_transaction_t* trans);  // driver pre-transfer callback (ISR)
+
+  void configure();
+  void release_devices();
+  void send(const chromance::core::StripPixel* const* body_by_strip, PerfStats* stats);
+  void encode_strip(uint8_t strip, const chromance::core::Rgb* rgb, size_t len);
+
+  core::SpiBusPlan plan_{};
+  uint32_t clock_hz_[core::kStripCount] = {};
+  uint16_t strip_used_len_[core::kStripCount] = {};
+  core::StripPixel* buffers_[core::kStripCount] = {};  // DMA-capable staging, strip_used_len_ pixels
+  uint8_t* end_frame_ = nullptr;                        // DMA-capable 0xFF bytes for the longest strip
+  size_t end_frame_len_ = 0;
+  spi_device_handle_t devices_[core::kSpiBusCount][core::kSpiClocksPerBus] = {};
+  spi_device_handle_t strip_device_[core::kStripCount] = {};
+  ClockRoute routes_[core::kStripCount] = {};
+  spi_transaction_t trans_[core::kStripCount][3] = {};
+  bool bus_ready_[core::kSpiBusCount] = {};
+  bool started_ = false;
+  uint8_t brightness_ = 255;
+};
+
+}  // namespace platform
+}  // namespace chromance
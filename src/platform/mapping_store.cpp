@@ -0,0 +1,58 @@
+#include "mapping_store.h"
+
+#include <esp_partition.h>
+#include <esp_spi_flash.h>
+
+namespace chromance {
+namespace platform {
+
+bool MappingStore::begin() {
+  if (mapped_) {
+    return status_ == Status::kLoaded;
+  }
+  const esp_partition_t* part =
+      esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, kPartitionLabel);
+  if (part == nullptr) {
+    status_ = Status::kCompiled;
+    return false;
+  }
+  label_ = part->label;
+
+  const void* ptr = nullptr;
+  spi_flash_mmap_handle_t handle = 0;
+  if (esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &ptr, &handle) != ESP_OK) {
+    status_ = Status::kNoBlob;
+    return false;
+  }
+  if (!blob_.open(static_cast<const uint8_t*>(ptr), part->size)) {
+    status_ = Status::kNoBlob;
+  } else if (!blob_.compatible()) {
+    status_ = Status::kIncompatible;
+  } else {
+    // The installed tables point into the mapping, so it stays for the life of the firmware.
+    chromance::core::MappingTables::install(blob_.tables());
+    mmap_handle_ = handle;
+    mapped_ = true;
+    status_ = Status::kLoaded;
+    return true;
+  }
+  spi_flash_munmap(handle);  // MMU pages are a shared resource
+  return false;
+}
+
+const char* MappingStore::status_name() const {
+  switch (status_) {
+    case Status::kNoBlob:
+      return "no blob";
+    case Status::kIncompatible:
+      return "blob shape differs from build";
+    case Status::kLoaded:
+      return "blob";
+    case Status::kCompiled:
+    default:
+      return "no partition";
+  }
+}
+
+}  // namespace platform
+}  // namespace chromance
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/mapping/mapping_blob.h"
+
+namespace chromance {
+namespace platform {
+
+// Memory-maps the mapping blob partition and, if it holds a valid blob of this build's shape, installs its
+// tables as the active mapping (MappingTables::install). Otherwise the compiled tables stay active, so a
+// device with no blob, an erased partition or a blob for another layout boots exactly as before.
+//
+// Looks only for a data partition labelled "mapping" (partitions_mapping.csv); the blob is flashed there with
+// esptool (see mapping/README_wiring.md). Call begin() first in setup(), before anything reads the mapping.
+class MappingStore {
+ public:
+  static constexpr const char* kPartitionLabel = "mapping";
+
+  enum class Status : uint8_t {
+    kCompiled,      // no "mapping" partition
+    kNoBlob,        // partition present, no valid blob in it (erased, corrupt)
+    kIncompatible,  // valid blob whose shape differs from this build
+    kLoaded,
+  };
+
+  // Maps the partition and installs the blob. True if the blob's tables are now active.
+  bool begin();
+
+  Status status() const { return status_; }
+  const char* status_name() const;
+  const chromance::core::MappingBlob& blob() const { return blob_; }
+  const char* partition_label() const { return label_; }
+
+ private:
+  chromance::core::MappingBlob blob_;
+  Status status_ = Status::kCompiled;
+  const char* label_ = nullptr;
+  uint32_t mmap_handle_ = 0;
+  bool mapped_ = false;
+};
+
+}  // namespace platform
+}  // namespace chromance
@@ -0,0 +1,43 @@
+#include "memory_stats.h"
+
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace chromance {
+namespace platform {
+
+namespace {
+
+constexpr uint32_t kHeapCaps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+
+// Arduino loop, audio capture (I2sAudioInput), lwIP, WiFi driver, default event loop, esp_timer callbacks.
+constexpr const char* kTrackedTasks[] = {"loopTask", "audio", "tiT", "wifi", "sys_evt", "esp_timer"};
+static_assert(sizeof(kTrackedTasks) / sizeof(kTrackedTasks[0]) <= MemoryStats::kMaxTasks,
+              "MemoryStats::tasks too small");
+
+}  // namespace
+
+void read_heap_stats(MemoryStats* out) {
+  out->free_heap = static_cast<uint32_t>(heap_caps_get_free_size(kHeapCaps));
+  out->min_free_heap = static_cast<uint32_t>(heap_caps_get_minimum_free_size(kHeapCaps));
+  out->largest_free_block = static_cast<uint32_t>(heap_caps_get_largest_free_block(kHeapCaps));
+}
+
+void read_memory_stats(MemoryStats* out) {
+  read_heap_stats(out);
+  out->task_count = 0;
+  for (const char* name : kTrackedTasks) {
+    TaskHandle_t task = xTaskGetHandle(name);
+    if (task == nullptr) {
+      continue;  // not running in this build (no audio, WiFi not started yet)
+    }
+    TaskStackStats& t = out->tasks[out->task_count++];
+    t.name = name;
+    // ESP-IDF counts stack depth in bytes.
+    t.stack_free_min = static_cast<uint32_t>(uxTaskGetStackHighWaterMark(task));
+  }
+}
+
+}  // namespace platform
+}  // namespace chromance
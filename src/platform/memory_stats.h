@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace chromance {
+namespace platform {
+
+// Runtime DRAM picture for /api/perf and the serial stats line; the static side is the post-build report from
+// scripts/check_dram_budget.py.
+//
+// Heap figures cover internal 8-bit capable RAM (where every malloc/new/String lands). min_free_heap is the
+// lowest free heap since boot, as tracked by the allocator. Stack figures are FreeRTOS high-water marks: the
+// fewest bytes a task's stack ever had left.
+struct TaskStackStats {
+  const char* name = nullptr;
+  uint32_t stack_free_min = 0;  // bytes
+};
+
+struct MemoryStats {
+  static constexpr uint8_t kMaxTasks = 8;
+
+  uint32_t free_heap = 0;
+  uint32_t min_free_heap = 0;
+  uint32_t largest_free_block = 0;
+  uint8_t task_count = 0;
+  TaskStackStats tasks[kMaxTasks];
+};
+
+// Heap figures only: cheap enough for every stats line.
+void read_heap_stats(MemoryStats* out);
+
+// Heap figures plus the stack high-water marks of the runtime's tasks that exist (Arduino loop, audio capture,
+// lwIP, WiFi, event loop, esp_timer). Looking tasks up by name walks the task lists; call it on request only.
+void read_memory_stats(MemoryStats* out);
+
+}  // namespace platform
+}  // namespace chromance
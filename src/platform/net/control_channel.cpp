@@ -0,0 +1,308 @@
+#include "control_channel.h"
+
+#include <lwip/sockets.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/sha1.h>
+#include <mbedtls/version.h>
+#include <string.h>
+#include <strings.h>
+
+#include "core/protocol/param_frame.h"
+
+namespace chromance {
+namespace platform {
+
+namespace {
+
+// Frame decoding is a few microseconds; only skip work when the next frame is imminent.
+static constexpr uint32_t kGateHeadroomMs = 2;
+
+constexpr char kWsGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+bool find_header_value(const char* request, const char* name, char* out, size_t out_size) {
+  const size_t name_len = strlen(name);
+  for (const char* p = strstr(request, "\r\n"); p != nullptr; p = strstr(p + 2, "\r\n")) {
+    const char* line = p + 2;
+    if (strncasecmp(line, name, name_len) != 0 || line[name_len] != ':') {
+      continue;
+    }
+    const char* v = line + name_len + 1;
+    while (*v == ' ' || *v == '\t') ++v;
+    size_t n = 0;
+    while (v[n] != '\0' && v[n] != '\r' && v[n] != '\n') ++n;
+    while (n > 0 && (v[n - 1] == ' ' || v[n - 1] == '\t')) --n;
+    if (n == 0 || n >= out_size) {
+      return false;
+    }
+    memcpy(out, v, n);
+    out[n] = '\0';
+    return true;
+  }
+  return false;
+}
+
+bool compute_accept_key(const char* client_key, char* out, size_t out_size) {
+  char joined[96] = {};
+  const int n = snprintf(joined, sizeof(joined), "%s%s", client_key, kWsGuid);
+  if (n <= 0 || static_cast<size_t>(n) >= sizeof(joined)) {
+    return false;
+  }
+  uint8_t digest[20] = {};
+#if MBEDTLS_VERSION_MAJOR >= 3
+  if (mbedtls_sha1(reinterpret_cast<const unsigned char*>(joined), static_cast<size_t>(n), digest) != 0) {
+    return false;
+  }
+#else
+  if (mbedtls_sha1_ret(reinterpret_cast<const unsigned char*>(joined), static_cast<size_t>(n), digest) != 0) {
+    return false;
+  }
+#endif
+  size_t olen = 0;
+  return mbedtls_base64_encode(reinterpret_cast<unsigned char*>(out), out_size, &olen, digest, sizeof(digest)) ==
+         0;
+}
+
+}  // namespace
+
+void ControlChannel::begin() {
+  if (started_) return;
+  server_.begin();
+  server_.setNoDelay(true);
+  started_ = true;
+}
+
+uint8_t ControlChannel::client_count() const {
+  uint8_t n = 0;
+  for (size_t i = 0; i < kMaxClients; ++i) {
+    if (slots_[i].state == SlotState::kOpen) ++n;
+  }
+  return n;
+}
+
+void ControlChannel::handle(uint32_t now_ms, uint32_t next_render_deadline_ms) {
+  if (!started_) return;
+  if (next_render_deadline_ms <= now_ms || (next_render_deadline_ms - now_ms) < kGateHeadroomMs) {
+    return;
+  }
+
+  accept_new(now_ms);
+  for (size_t i = 0; i < kMaxClients; ++i) {
+    Slot& s = slots_[i];
+    if (s.state == SlotState::kHandshake) {
+      service_handshake(s, now_ms);
+    } else if (s.state == SlotState::kOpen) {
+      service_open(s);
+      if (s.state == SlotState::kOpen) pump_preview(s);
+    }
+  }
+}
+
+void ControlChannel::offer_preview(const chromance::core::Rgb* frame, size_t n, uint32_t now_ms) {
+  if (!started_ || frame == nullptr || n == 0 || n > kPreviewLeds) return;
+
+  for (size_t i = 0; i < kMaxClients; ++i) {
+    Slot& s = slots_[i];
+    if (s.state != SlotState::kOpen) continue;
+    const bool busy = s.out_sent < s.out_len;
+    if (!s.preview_rate.due(now_ms, busy)) continue;
+
+    uint8_t* body = s.out + kWsHeaderReserve;
+    const size_t len = s.preview_encoder.encode(frame, n, body, sizeof(s.out) - kWsHeaderReserve);
+    if (len == 0) continue;
+
+    // Place the WebSocket header immediately before the payload so the frame is one contiguous send.
+    uint8_t hdr[kWsHeaderReserve] = {};
+    const size_t hdr_len = chromance::core::ws_write_header(chromance::core::WsOpcode::kBinary, len, hdr);
+    const size_t start = kWsHeaderReserve - hdr_len;
+    memcpy(s.out + start, hdr, hdr_len);
+    s.out_sent = start;
+    s.out_len = kWsHeaderReserve + len;
+    s.preview_rate.on_frame_queued(now_ms);
+    pump_preview(s);
+  }
+}
+
+void ControlChannel::pump_preview(Slot& s) {
+  if (s.out_sent >= s.out_len) return;
+  const int fd = s.client.fd();
+  if (fd < 0) {
+    close_slot(s);
+    return;
+  }
+  const ssize_t wrote = send(fd, s.out + s.out_sent, s.out_len - s.out_sent, MSG_DONTWAIT);
+  if (wrote < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+    close_slot(s);
+    return;
+  }
+  s.out_sent += static_cast<size_t>(wrote);
+  preview_bytes_sent_ += static_cast<uint32_t>(wrote);
+  if (s.out_sent >= s.out_len) {
+    ++preview_frames_sent_;
+    s.preview_rate.on_frame_drained();
+  }
+}
+
+void ControlChannel::accept_new(uint32_t now_ms) {
+  WiFiClient incoming = server_.available();
+  if (!incoming) return;
+
+  for (size_t i = 0; i < kMaxClients; ++i) {
+    Slot& s = slots_[i];
+    if (s.state != SlotState::kFree) continue;
+    s.client = incoming;
+    s.client.setNoDelay(true);
+    s.state = SlotState::kHandshake;
+    s.since_ms = now_ms;
+    s.request_len = 0;
+    s.request[0] = '\0';
+    s.reader.reset();
+    s.preview_rate.set_target_fps(0, now_ms);
+    s.out_len = 0;
+    s.out_sent = 0;
+    return;
+  }
+
+  // All slots busy: refuse rather than evicting an active editor.
+  incoming.print("HTTP/1.1 503 Service Unavailable\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+  incoming.stop();
+}
+
+void ControlChannel::service_handshake(Slot& s, uint32_t now_ms) {
+  while (s.client.available() > 0 && s.request_len < kMaxRequestBytes) {
+    const int c = s.client.read();
+    if (c < 0) break;
+    s.request[s.request_len++] = static_cast<char>(c);
+    s.request[s.request_len] = '\0';
+    if (s.request_len >= 4 && memcmp(s.request + s.request_len - 4, "\r\n\r\n", 4) == 0) {
+      break;
+    }
+  }
+
+  const bool complete = s.request_len >= 4 && strstr(s.request, "\r\n\r\n") != nullptr;
+  if (!complete) {
+    const bool timed_out =
+        static_cast<int32_t>(now_ms - s.since_ms) >= static_cast<int32_t>(kHandshakeTimeoutMs);
+    if (s.request_len >= kMaxRequestBytes || timed_out || !s.client.connected()) {
+      close_slot(s);
+    }
+    return;
+  }
+
+  char key[32] = {};
+  char accept[32] = {};
+  const bool path_ok = strncmp(s.request, "GET /ws ", 8) == 0 || strncmp(s.request, "GET /ws?", 8) == 0;
+  if (!path_ok || !find_header_value(s.request, "Sec-WebSocket-Key", key, sizeof(key)) ||
+      !compute_accept_key(key, accept, sizeof(accept))) {
+    s.client.print("HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+    close_slot(s);
+    return;
+  }
+
+  s.client.printf(
+      "HTTP/1.1 101 Switching Protocols\r\n"
+      "Upgrade: websocket\r\n"
+      "Connection: Upgrade\r\n"
+      "Sec-WebSocket-Accept: %s\r\n"
+      "\r\n",
+      accept);
+  s.state = SlotState::kOpen;
+  s.reader.reset();
+}
+
+void ControlChannel::service_open(Slot& s) {
+  uint8_t buf[128];
+  size_t budget = kReadBudgetBytes;
+  while (budget > 0) {
+    const int avail = s.client.available();
+    if (avail <= 0) break;
+    size_t want = static_cast<size_t>(avail);
+    if (want > sizeof(buf)) want = sizeof(buf);
+    if (want > budget) want = budget;
+    const int got = s.client.read(buf, want);
+    if (got <= 0) break;
+    budget -= static_cast<size_t>(got);
+
+    size_t off = 0;
+    while (off < static_cast<size_t>(got)) {
+      size_t used = 0;
+      const auto r = s.reader.feed(buf + off, static_cast<size_t>(got) - off, &used);
+      off += used;
+      if (r == chromance::core::WsFrameReader<kMaxMessageBytes>::Result::kError) {
+        ++frames_rejected_;
+        close_slot(s);
+        return;
+      }
+      if (r == chromance::core::WsFrameReader<kMaxMessageBytes>::Result::kFrame) {
+        on_message(s);
+        if (s.state != SlotState::kOpen) return;
+      }
+    }
+  }
+
+  if (!s.client.connected()) {
+    close_slot(s);
+  }
+}
+
+void ControlChannel::on_message(Slot& s) {
+  using chromance::core::WsOpcode;
+  switch (s.reader.opcode()) {
+    case WsOpcode::kBinary: {
+      ++frames_received_;
+      if (s.reader.payload_len() == 2 && s.reader.payload()[0] == chromance::core::kPreviewSubscribeMessage) {
+        s.preview_rate.set_target_fps(s.reader.payload()[1], millis());
+        s.preview_encoder.force_keyframe();
+        return;
+      }
+      chromance::core::ParamUpdate updates[kMaxMessageBytes / chromance::core::kParamFrameRecordBytes];
+      const int n = chromance::core::decode_param_frame(s.reader.payload(), s.reader.payload_len(), updates,
+                                                        sizeof(updates) / sizeof(updates[0]));
+      if (n < 0) {
+        ++frames_rejected_;
+        return;
+      }
+      if (params_ == nullptr) return;
+      for (int i = 0; i < n; ++i) {
+        (void)params_->push(updates[i].effect, updates[i].param, updates[i].raw);
+      }
+      return;
+    }
+    case WsOpcode::kPing:
+      send_frame(s, WsOpcode::kPong, s.reader.payload(), s.reader.payload_len());
+      return;
+    case WsOpcode::kClose:
+      send_frame(s, WsOpcode::kClose, nullptr, 0);
+      close_slot(s);
+      return;
+    default:
+      // Text frames are reserved for future commands; pongs need no reply.
+      return;
+  }
+}
+
+void ControlChannel::send_frame(Slot& s, chromance::core::WsOpcode op, const uint8_t* payload, size_t len) {
+  if (s.out_sent < s.out_len) {
+    // A preview frame is mid-flight; interleaving would corrupt the stream. Control replies are best-effort.
+    return;
+  }
+  uint8_t hdr[10] = {};
+  const size_t hdr_len = chromance::core::ws_write_header(op, len, hdr);
+  (void)s.client.write(hdr, hdr_len);
+  if (payload != nullptr && len > 0) {
+    (void)s.client.write(payload, len);
+  }
+}
+
+void ControlChannel::close_slot(Slot& s) {
+  s.client.stop();
+  s.state = SlotState::kFree;
+  s.request_len = 0;
+  s.reader.reset();
+  s.preview_rate.set_target_fps(0, 0);
+  s.out_len = 0;
+  s.out_sent = 0;
+}
+
+}  // namespace platform
+}  // namespace chromance
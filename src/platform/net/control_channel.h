@@ -0,0 +1,100 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#include <stdint.h>
+
+#include "core/effects/param_coalescer.h"
+#include "core/mapping/mapping_tables.h"
+#include "core/protocol/frame_delta.h"
+#include "core/protocol/preview_rate.h"
+#include "core/protocol/ws_frame.h"
+#include "core/types.h"
+
+namespace chromance {
+namespace platform {
+
+static constexpr uint16_t kControlChannelPort = 81;
+static constexpr size_t kControlParamSlots = 16;
+
+using ControlParamCoalescer = chromance::core::ParamCoalescer<kControlParamSlots>;
+
+// Persistent WebSocket control channel (ws://<host>:81/ws).
+//
+// The Arduino WebServer on port 80 is request/response only, so streamed slider updates would each pay
+// connection setup, a JSON parse and the HTTP rate limiter. This channel keeps one socket open per UI
+// client and accepts compact binary param frames (core/protocol/param_frame.h) which are pushed into a
+// last-write-wins coalescer; the render loop applies them once per frame.
+//
+// The same socket carries the live preview stream: a client subscribes with {0x02, fps} and receives
+// delta/RLE encoded framebuffers (core/protocol/frame_delta.h). Sends are non-blocking; a frame that has
+// not drained by the next slot makes the rate controller back off instead of queueing.
+class ControlChannel {
+ public:
+  explicit ControlChannel(ControlParamCoalescer* params) : params_(params) {}
+
+  void begin();
+
+  // Called from the main loop under the same render-loop gate as WebuiServer::handle().
+  void handle(uint32_t now_ms, uint32_t next_render_deadline_ms);
+
+  // Called right after a frame is flushed. Encodes for subscribers whose slot is due; never blocks.
+  void offer_preview(const chromance::core::Rgb* frame, size_t n, uint32_t now_ms);
+
+  uint8_t client_count() const;
+  uint32_t frames_received() const { return frames_received_; }
+  uint32_t frames_rejected() const { return frames_rejected_; }
+  uint32_t preview_frames_sent() const { return preview_frames_sent_; }
+  uint32_t preview_bytes_sent() const { return preview_bytes_sent_; }
+
+ private:
+  enum class SlotState : uint8_t { kFree, kHandshake, kOpen };
+
+  static constexpr size_t kMaxClients = 2;
+  static constexpr size_t kMaxRequestBytes = 512;
+  static constexpr size_t kMaxMessageBytes = 256;
+  static constexpr uint32_t kHandshakeTimeoutMs = 2000;
+  static constexpr size_t kReadBudgetBytes = 1024;  // per slot per handle() call
+
+  static constexpr size_t kPreviewLeds = chromance::core::MappingTables::led_count();
+  static constexpr size_t kWsHeaderReserve = 10;
+  static constexpr size_t kPreviewOutBytes =
+      kWsHeaderReserve + chromance::core::preview_max_encoded_size(kPreviewLeds);
+
+  struct Slot {
+    WiFiClient client;
+    SlotState state = SlotState::kFree;
+    uint32_t since_ms = 0;
+    char request[kMaxRequestBytes + 1] = {};
+    size_t request_len = 0;
+    chromance::core::WsFrameReader<kMaxMessageBytes> reader;
+
+    chromance::core::PreviewRateController preview_rate;
+    chromance::core::FrameDeltaEncoder<kPreviewLeds> preview_encoder;
+    uint8_t out[kPreviewOutBytes] = {};
+    size_t out_len = 0;   // end of queued bytes
+    size_t out_sent = 0;  // next byte to send; == out_len when idle
+  };
+
+  void accept_new(uint32_t now_ms);
+  void service_handshake(Slot& s, uint32_t now_ms);
+  void service_open(Slot& s);
+  void on_message(Slot& s);
+  void send_frame(Slot& s, chromance::core::WsOpcode op, const uint8_t* payload, size_t len);
+  void pump_preview(Slot& s);
+  void close_slot(Slot& s);
+
+  WiFiServer server_{kControlChannelPort};
+  ControlParamCoalescer* params_ = nullptr;
+  Slot slots_[kMaxClients];
+  bool started_ = false;
+
+  uint32_t frames_received_ = 0;
+  uint32_t frames_rejected_ = 0;
+  uint32_t preview_frames_sent_ = 0;
+  uint32_t preview_bytes_sent_ = 0;
+};
+
+}  // namespace platform
+}  // namespace chromance
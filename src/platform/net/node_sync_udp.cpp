@@ -0,0 +1,47 @@
+#include "node_sync_udp.h"
+
+#include <esp_timer.h>
+
+namespace chromance {
+namespace platform {
+
+void NodeSyncUdp::begin() {
+  if (started_ || (leader_ == nullptr && follower_ == nullptr)) return;
+  udp_.begin(chromance::core::kNodeSyncPort);
+  started_ = true;
+}
+
+void NodeSyncUdp::send(const chromance::core::SyncState& state) {
+  if (!started_ || leader_ == nullptr) return;
+  const uint64_t now_us = static_cast<uint64_t>(esp_timer_get_time());
+  const size_t len = leader_->poll(state, now_us, packet_, sizeof(packet_));
+  if (len == 0) return;
+  if (!udp_.beginPacket(WiFi.broadcastIP(), chromance::core::kNodeSyncPort)) {
+    ++send_errors_;
+    return;
+  }
+  udp_.write(packet_, len);
+  if (!udp_.endPacket()) {
+    ++send_errors_;
+  }
+}
+
+void NodeSyncUdp::poll() {
+  if (!started_ || follower_ == nullptr) return;
+  for (uint8_t i = 0; i < kMaxPacketsPerPoll; ++i) {
+    const int size = udp_.parsePacket();
+    if (size <= 0) return;
+    if (static_cast<size_t>(size) > sizeof(packet_)) {
+      udp_.flush();
+      continue;
+    }
+    const int got = udp_.read(packet_, static_cast<size_t>(size));
+    if (got > 0) {
+      // Stamp at read time: the servo treats everything up to here as network delay.
+      (void)follower_->on_packet(packet_, static_cast<size_t>(got), static_cast<uint64_t>(esp_timer_get_time()));
+    }
+  }
+}
+
+}  // namespace platform
+}  // namespace chromance
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+#include <stdint.h>
+
+#include "core/protocol/node_sync.h"
+
+namespace chromance {
+namespace platform {
+
+// UDP transport for multi-controller sync (core/protocol/node_sync.h) on kNodeSyncPort.
+//
+// A leader broadcasts beacons to its subnet; a follower drains them every loop iteration and timestamps each one
+// with esp_timer_get_time() as it is read. Exactly one of leader / follower is set.
+class NodeSyncUdp {
+ public:
+  NodeSyncUdp(chromance::core::SyncLeader* leader, chromance::core::SyncFollower* follower)
+      : leader_(leader), follower_(follower) {}
+
+  void begin();
+
+  // Leader: broadcasts a beacon for state when one is due.
+  void send(const chromance::core::SyncState& state);
+
+  // Follower: hands up to kMaxPacketsPerPoll received beacons to the follower.
+  void poll();
+
+  uint32_t send_errors() const { return send_errors_; }
+
+ private:
+  static constexpr uint8_t kMaxPacketsPerPoll = 4;
+
+  chromance::core::SyncLeader* leader_ = nullptr;
+  chromance::core::SyncFollower* follower_ = nullptr;
+  WiFiUDP udp_;
+  uint8_t packet_[chromance::core::kSyncMaxBeaconBytes] = {};
+  bool started_ = false;
+  uint32_t send_errors_ = 0;
+};
+
+}  // namespace platform
+}  // namespace chromance
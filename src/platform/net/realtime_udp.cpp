@@ -0,0 +1,41 @@
+#include "realtime_udp.h"
+
+namespace chromance {
+namespace platform {
+
+void RealtimeUdpInput::begin() {
+  if (started_) return;
+  ddp_.begin(chromance::core::kDdpPort);
+  e131_.begin(chromance::core::kE131Port);
+  artnet_.begin(chromance::core::kArtNetPort);
+  started_ = true;
+}
+
+void RealtimeUdpInput::poll(uint32_t now_ms) {
+  if (!started_ || receiver_ == nullptr) return;
+  for (uint8_t i = 0; i < kMaxPacketsPerPoll; ++i) {
+    bool any = false;
+    any |= poll_one(ddp_, chromance::core::RealtimeProtocol::kDdp, now_ms);
+    any |= poll_one(e131_, chromance::core::RealtimeProtocol::kE131, now_ms);
+    any |= poll_one(artnet_, chromance::core::RealtimeProtocol::kArtNet, now_ms);
+    if (!any) return;
+  }
+}
+
+bool RealtimeUdpInput::poll_one(WiFiUDP& udp, chromance::core::RealtimeProtocol proto, uint32_t now_ms) {
+  const int size = udp.parsePacket();
+  if (size <= 0) return false;
+  if (static_cast<size_t>(size) > sizeof(packet_)) {
+    ++oversized_;
+    udp.flush();
+    return true;
+  }
+  const int got = udp.read(packet_, static_cast<size_t>(size));
+  if (got > 0) {
+    (void)receiver_->on_packet(proto, packet_, static_cast<size_t>(got), now_ms);
+  }
+  return true;
+}
+
+}  // namespace platform
+}  // namespace chromance
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+#include <stdint.h>
+
+#include "core/protocol/realtime_pixels.h"
+
+namespace chromance {
+namespace platform {
+
+// UDP listeners for realtime pixel input (DDP :4048, E1.31 :5568, Art-Net :6454).
+//
+// Datagrams are read into one packet buffer and handed to core::RealtimeReceiver, which writes channel data
+// straight into the render framebuffer. E1.31 is unicast only (no multicast group joins).
+class RealtimeUdpInput {
+ public:
+  explicit RealtimeUdpInput(chromance::core::RealtimeReceiver* receiver) : receiver_(receiver) {}
+
+  void begin();
+
+  // Drains up to kMaxPacketsPerPoll datagrams. Called every loop iteration (not only on render frames) so the
+  // lwIP receive queue does not overflow while a sender streams universes back to back.
+  void poll(uint32_t now_ms);
+
+  uint32_t oversized() const { return oversized_; }
+
+ private:
+  static constexpr size_t kMaxPacketBytes = 1472;  // Ethernet MTU minus IP/UDP headers
+  static constexpr uint8_t kMaxPacketsPerPoll = 16;
+
+  bool poll_one(WiFiUDP& udp, chromance::core::RealtimeProtocol proto, uint32_t now_ms);
+
+  chromance::core::RealtimeReceiver* receiver_ = nullptr;
+  WiFiUDP ddp_;
+  WiFiUDP e131_;
+  WiFiUDP artnet_;
+  uint8_t packet_[kMaxPacketBytes] = {};
+  bool started_ = false;
+  uint32_t oversized_ = 0;
+};
+
+}  // namespace platform
+}  // namespace chromance
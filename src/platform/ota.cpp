@@ -29,7 +29,7 @@ bool OtaManager::begin(const char* firmware_version) {
   }
 
   WiFi.mode(WIFI_STA);
-  WiFi.setSleep(false);
+  WiFi.setSleep(false);  // boot state; the runtime's power governor enables modem sleep when idle
   WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
 
   wifi_state_ = WifiState::Connecting;
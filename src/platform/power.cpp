@@ -0,0 +1,32 @@
+#include "power.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+namespace chromance {
+namespace platform {
+
+void PowerController::begin() {
+  cpu_mhz_ = static_cast<uint16_t>(getCpuFrequencyMhz());
+  sleep_applied_ = false;
+}
+
+void PowerController::apply(const chromance::core::PowerDecision& decision) {
+  if (decision.cpu_mhz != cpu_mhz_ && setCpuFrequencyMhz(decision.cpu_mhz)) {
+    cpu_mhz_ = decision.cpu_mhz;
+  }
+
+  // Modem sleep only matters while associated; re-apply it after every reconnect.
+  if (WiFi.status() != WL_CONNECTED) {
+    sleep_applied_ = false;
+    return;
+  }
+  if (!sleep_applied_ || decision.modem_sleep != modem_sleep_) {
+    WiFi.setSleep(decision.modem_sleep);
+    modem_sleep_ = decision.modem_sleep;
+    sleep_applied_ = true;
+  }
+}
+
+}  // namespace platform
+}  // namespace chromance
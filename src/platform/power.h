@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "core/power_governor.h"
+
+namespace chromance {
+namespace platform {
+
+// Applies PowerGovernor decisions: CPU clock via setCpuFrequencyMhz() and WiFi modem sleep via
+// WiFi.setSleep(). Both are only touched when the decision changes. 80/160/240 MHz all keep the APB bus at
+// 80 MHz, so SPI (LED output), UART and timers are unaffected by clock steps.
+class PowerController {
+ public:
+  void begin();
+  void apply(const chromance::core::PowerDecision& decision);
+
+  uint16_t cpu_mhz() const { return cpu_mhz_; }
+
+ private:
+  uint16_t cpu_mhz_ = 0;
+  bool sleep_applied_ = false;  // modem sleep state is only meaningful while associated
+  bool modem_sleep_ = false;
+};
+
+}  // namespace platform
+}  // namespace chromance
@@ -41,11 +41,11 @@ Preferences prefs;
 
 }  // namespace
 
-void RuntimeSettings::begin() {
+void RuntimeSettings::begin(uint8_t max_mode) {
   prefs.begin(kNamespace, false);
   PreferencesStore store(&prefs);
   brightness_.begin(store, kBrightnessKey, 100);
-  mode_.begin(store, kModeKey, 1);
+  mode_.begin(store, kModeKey, 1, max_mode);
 }
 
 void RuntimeSettings::set_brightness_percent(uint8_t percent) {
@@ -10,13 +10,14 @@ namespace platform {
 
 class RuntimeSettings {
  public:
-  void begin();
+  void begin(uint8_t max_mode = chromance::core::ModeSetting::kDefaultMaxMode);
 
   uint8_t brightness_percent() const { return brightness_.percent(); }
   void set_brightness_percent(uint8_t percent);
 
   uint8_t mode() const { return mode_.mode(); }
   void set_mode(uint8_t mode);
+  uint8_t max_mode() const { return mode_.max_mode(); }
 
  private:
   chromance::core::BrightnessSetting brightness_;
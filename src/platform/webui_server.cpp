@@ -2,13 +2,18 @@
 
 #include <ArduinoJson.h>
 #include <WiFi.h>
+#include <errno.h>
 #include <esp_system.h>
+#include <lwip/sockets.h>
 #include <math.h>
 
 #include "core/brightness.h"
 #include "core/brightness_config.h"
+#include "core/effects/blend.h"
 #include "core/mapping/mapping_tables.h"
+#include "core/protocol/asset_send.h"
 #include "generated/webui_assets.h"
+#include "platform/memory_stats.h"
 
 namespace chromance {
 namespace platform {
@@ -16,10 +21,19 @@ namespace platform {
 namespace {
 
 static constexpr uint32_t kRenderGateHeadroomMs = 7;
-static constexpr uint32_t kStaticSendCpuBudgetMs = 5;
+// Static asset bodies are pumped from handle() with a shared per-iteration byte budget; a connection that
+// accepts nothing for kStaticSendStallMs is dropped.
+static constexpr size_t kStaticSendBytesPerPump = 8192;
+static constexpr size_t kStaticSendChunkBytes = 1460;
+static constexpr uint32_t kStaticSendStallMs = 3000;
+// A browser polls every few seconds while a page is open; treat the server as busy for that long after the
+// last request so the power governor does not step down between polls.
+static constexpr uint32_t kBusyHoldMs = 5000;
 
 static constexpr size_t kMaxHttpBodyBytes = 1024;
 static constexpr size_t kMaxJsonBytes = 8192;
+// A full playlist (8 entries x 4 params) in the API's JSON shape.
+static constexpr size_t kMaxPlaylistBodyBytes = 2048;
 
 static constexpr uint32_t kRateWindowMs = 1000;
 static constexpr uint8_t kMaxBrightnessPerSec = 4;
@@ -270,6 +284,8 @@ void WebuiServer::begin() {
   prefs_.begin("chromance", false);
   init_confirm_token();
   validate_aliases_and_log();
+  static const char* kCollectHeaders[] = {"If-None-Match"};
+  server_.collectHeaders(kCollectHeaders, 1);
   server_.onNotFound([this]() { dispatch(); });
   server_.begin();
 }
@@ -283,6 +299,7 @@ void WebuiServer::handle(uint32_t now_ms, uint32_t next_render_deadline_ms) {
   if (!render_gate_allows(now_ms, next_render_deadline_ms)) {
     return;
   }
+  pump_asset_sends(now_ms);
   server_.handleClient();
 }
 
@@ -292,7 +309,16 @@ bool WebuiServer::take_pending_restart() {
   return v;
 }
 
+bool WebuiServer::busy(uint32_t now_ms) const {
+  for (size_t i = 0; i < kMaxAssetSends; ++i) {
+    if (asset_sends_[i].active) return true;
+  }
+  return request_seen_ && static_cast<int32_t>(now_ms - last_request_ms_) < static_cast<int32_t>(kBusyHoldMs);
+}
+
 void WebuiServer::dispatch() {
+  request_seen_ = true;
+  last_request_ms_ = millis();
   if (handle_api_routes()) return;
   if (handle_page_routes()) return;
   if (handle_static_asset_routes()) return;
@@ -309,6 +335,7 @@ bool WebuiServer::handle_page_routes() {
   }
   if (uri == "/") return send_embedded_asset("/index.html", nullptr);
   if (uri == "/settings" || uri == "/settings/") return send_embedded_asset("/settings/index.html", nullptr);
+  if (uri == "/playlist" || uri == "/playlist/") return send_embedded_asset("/playlist/index.html", nullptr);
   if (uri == "/settings/persistence" || uri == "/settings/persistence/")
     return send_embedded_asset("/settings/persistence/index.html", nullptr);
 
@@ -385,6 +412,29 @@ bool WebuiServer::handle_api_routes() {
     return true;
   }
 
+  if (server_.method() == HTTP_GET && uri == "/api/playlist") {
+    api_get_playlist();
+    return true;
+  }
+  if (server_.method() == HTTP_POST && uri == "/api/playlist") {
+    api_post_playlist();
+    return true;
+  }
+  if (server_.method() == HTTP_POST && uri.startsWith("/api/playlist/")) {
+    api_post_playlist_control(uri.substring(String("/api/playlist/").length()));
+    return true;
+  }
+
+  if (server_.method() == HTTP_GET && uri == "/api/mapping/pixels") {
+    api_get_mapping_pixels();
+    return true;
+  }
+
+  if (server_.method() == HTTP_GET && uri == "/api/perf") {
+    api_get_perf();
+    return true;
+  }
+
   if (server_.method() == HTTP_GET && uri == "/api/settings/persistence/summary") {
     api_get_persistence_summary();
     return true;
@@ -410,50 +460,92 @@ bool WebuiServer::send_embedded_asset(const char* request_path, const char* cont
   }
 
   WiFiClient client = server_.client();
+  if (chromance::core::etag_matches(server_.header("If-None-Match").c_str(), asset->etag)) {
+    client.printf(
+        "HTTP/1.1 304 Not Modified\r\n"
+        "ETag: %s\r\n"
+        "Cache-Control: %s\r\n"
+        "Connection: close\r\n"
+        "\r\n",
+        asset->etag, asset->cache_control);
+    client.stop();
+    return true;
+  }
+
+  AssetSend* slot = nullptr;
+  for (size_t i = 0; i < kMaxAssetSends; ++i) {
+    if (!asset_sends_[i].active) {
+      slot = &asset_sends_[i];
+      break;
+    }
+  }
+  if (slot == nullptr) {
+    // Every send slot is busy with a slow client; the browser retries instead of queueing behind it.
+    client.print(
+        "HTTP/1.1 503 Service Unavailable\r\n"
+        "Retry-After: 1\r\n"
+        "Content-Length: 0\r\n"
+        "Connection: close\r\n"
+        "\r\n");
+    client.stop();
+    return true;
+  }
+
   const char* ct = content_type_override ? content_type_override : asset->content_type;
   client.printf(
       "HTTP/1.1 200 OK\r\n"
       "Content-Type: %s\r\n"
       "Content-Encoding: gzip\r\n"
       "Cache-Control: %s\r\n"
+      "ETag: %s\r\n"
       "Content-Length: %u\r\n"
       "Connection: close\r\n"
       "\r\n",
-      ct, asset->cache_control, static_cast<unsigned>(asset->gz_len));
-
-  const uint8_t* p = asset->gz_data;
-  size_t remaining = asset->gz_len;
-  uint32_t last_progress_ms = millis();
+      ct, asset->cache_control, asset->etag, static_cast<unsigned>(asset->gz_len));
 
-  if (asset->gz_len <= 1024) {
-    (void)client.write(p, remaining);
-    client.stop();
-    return true;
-  }
-
-  while (remaining > 0) {
-    const uint32_t now = millis();
-    if ((now - last_progress_ms) > kStaticSendCpuBudgetMs) {
-      // Fail fast if we cannot make progress (e.g., socket backpressure) within the budget window.
-      client.stop();
-      return true;
-    }
+  // The body goes out from pump_asset_sends() over the next loop iterations; holding a WiFiClient copy keeps
+  // the socket open after WebServer lets go of its own.
+  const uint32_t now_ms = millis();
+  slot->client = client;
+  slot->state.start(asset->gz_data, asset->gz_len, now_ms);
+  slot->active = true;
+  pump_asset_send(*slot, kStaticSendBytesPerPump, now_ms);
+  return true;
+}
 
-    const size_t chunk = remaining > 512 ? 512 : remaining;
-    const size_t wrote = client.write(p, chunk);
-    if (wrote == 0) {
-      delay(0);
-      continue;
-    }
+size_t WebuiServer::pump_asset_send(AssetSend& s, size_t byte_budget, uint32_t now_ms) {
+  const int fd = s.client.fd();
+  if (fd < 0) {
+    s.client.stop();
+    s.active = false;
+    return 0;
+  }
+  const size_t before = s.state.sent();
+  auto write = [fd](const uint8_t* p, size_t n) -> int32_t {
+    const ssize_t wrote = send(fd, p, n, MSG_DONTWAIT);
+    if (wrote < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    return static_cast<int32_t>(wrote);
+  };
+  const chromance::core::AssetSendState::Result r =
+      s.state.pump(write, byte_budget, kStaticSendChunkBytes, now_ms, kStaticSendStallMs);
+  const size_t wrote = s.state.sent() - before;
+  if (r != chromance::core::AssetSendState::Result::kPending) {
+    s.client.stop();
+    s.active = false;
+  }
+  return wrote;
+}
 
-    p += wrote;
-    remaining -= wrote;
-    last_progress_ms = now;
-    delay(0);
+void WebuiServer::pump_asset_sends(uint32_t now_ms) {
+  // Round-robin start so one fast client cannot take the whole budget every iteration.
+  size_t budget = kStaticSendBytesPerPump;
+  for (size_t k = 0; k < kMaxAssetSends && budget > 0; ++k) {
+    AssetSend& s = asset_sends_[(asset_send_cursor_ + k) % kMaxAssetSends];
+    if (!s.active) continue;
+    const size_t wrote = pump_asset_send(s, budget, now_ms);
+    budget -= wrote < budget ? wrote : budget;
   }
-
-  client.stop();
-  return true;
+  asset_send_cursor_ = static_cast<uint8_t>((asset_send_cursor_ + 1U) % kMaxAssetSends);
 }
 
 String WebuiServer::canonical_slug_for_id(chromance::core::EffectId id) const {
@@ -705,6 +797,138 @@ void WebuiServer::api_get_effects() {
   out.end_chunked();
 }
 
+void WebuiServer::api_get_perf() {
+  if (catalog_ == nullptr || manager_ == nullptr) {
+    send_json_error(500, "internal", "Missing catalog");
+    return;
+  }
+
+  // Sampled once so the measuring pass and the sending pass emit the same numbers.
+  MemoryStats mem;
+  read_memory_stats(&mem);
+
+  const auto emit = [&](ChunkedJsonWriter& w) {
+    w.write("{\"ok\":true,\"data\":{\"effects\":[");
+    bool first = true;
+    for (size_t i = 0; i < catalog_->count(); ++i) {
+      const auto* d = catalog_->descriptor_at(i);
+      const chromance::core::EffectCostStats* c = d ? manager_->cost_stats(d->id) : nullptr;
+      if (c == nullptr) continue;
+      if (!first) w.write(",");
+      first = false;
+
+      const String canonical = canonical_slug_for_id(d->id);
+      w.write("{\"id\":");
+      w.write_u32(d->id.value);
+      w.write(",\"canonicalSlug\":\"");
+      w.write_escaped(canonical.c_str());
+      w.write("\",\"prepareUs\":");
+      w.write_u32(c->prepare_us);
+      w.write(",\"firstFrameUs\":");
+      w.write_u32(c->first_frame_us);
+      w.write(",\"maxFirstFrameUs\":");
+      w.write_u32(c->max_first_frame_us);
+      w.write(",\"maxFrameUs\":");
+      w.write_u32(c->max_frame_us);
+      w.write(",\"activations\":");
+      w.write_u32(c->activations);
+      w.write("}");
+    }
+    w.write("],\"preparePending\":");
+    w.write(manager_->prepare_pending() ? "true" : "false");
+    if (power_governor_ != nullptr) {
+      const chromance::core::PowerDecision pd = power_governor_->decision();
+      const chromance::core::PowerStats& ps = power_governor_->stats();
+      w.write(",\"power\":{\"enabled\":");
+      w.write(power_governor_->enabled() ? "true" : "false");
+      w.write(",\"cpuMhz\":");
+      w.write_u32(pd.cpu_mhz);
+      w.write(",\"modemSleep\":");
+      w.write(pd.modem_sleep ? "true" : "false");
+      w.write(",\"occupancyPermille\":");
+      w.write_u32(power_governor_->last_inputs().occupancy_permille);
+      w.write(",\"renderedFps\":");
+      w.write_u32(power_governor_->last_inputs().rendered_fps);
+      w.write(",\"estimatedMa\":");
+      w.write_u32(power_governor_->estimated_ma());
+      w.write(",\"modemSleepMs\":");
+      w.write_u32(ps.modem_sleep_ms);
+      w.write(",\"cpuChanges\":");
+      w.write_u32(ps.cpu_changes);
+      w.write(",\"steps\":[");
+      for (uint8_t i = 0; i < chromance::core::PowerGovernor::kStepCount; ++i) {
+        if (i) w.write(",");
+        w.write("{\"cpuMhz\":");
+        w.write_u32(chromance::core::PowerGovernor::cpu_mhz_for(i));
+        w.write(",\"timeMs\":");
+        w.write_u32(ps.steps[i].time_ms);
+        w.write(",\"maxFrameUs\":");
+        w.write_u32(ps.steps[i].max_frame_us);
+        w.write(",\"lateFrames\":");
+        w.write_u32(ps.steps[i].late_frames);
+        w.write("}");
+      }
+      w.write("]}");
+    }
+    w.write(",\"memory\":{\"freeHeap\":");
+    w.write_u32(mem.free_heap);
+    w.write(",\"minFreeHeap\":");
+    w.write_u32(mem.min_free_heap);
+    w.write(",\"largestFreeBlock\":");
+    w.write_u32(mem.largest_free_block);
+    w.write(",\"effectScratch\":");
+    w.write_u32(static_cast<uint32_t>(manager_->scratch_capacity()));
+    w.write(",\"effectScratchPeak\":");
+    w.write_u32(static_cast<uint32_t>(manager_->scratch_peak_bytes()));
+    w.write(",\"tasks\":[");
+    for (uint8_t i = 0; i < mem.task_count; ++i) {
+      if (i) w.write(",");
+      w.write("{\"name\":\"");
+      w.write_escaped(mem.tasks[i].name);
+      w.write("\",\"stackFreeMin\":");
+      w.write_u32(mem.tasks[i].stack_free_min);
+      w.write("}");
+    }
+    w.write("]}");
+    chromance::core::AudioFeatures af;
+    if (audio_features_ != nullptr && audio_features_->read(&af)) {
+      w.write(",\"audio\":{\"blocks\":");
+      w.write_u32(af.blocks);
+      w.write(",\"lastBlockUs\":");
+      w.write_u32(af.last_block_us);
+      w.write(",\"maxBlockUs\":");
+      w.write_u32(af.max_block_us);
+      w.write(",\"levelQ8\":");
+      w.write_u32(af.level_q8);
+      w.write(",\"energy\":");
+      w.write_f64_4(static_cast<double>(af.energy_q16) / 65535.0);
+      w.write(",\"onsets\":");
+      w.write_u32(af.onsets);
+      w.write(",\"bpm\":");
+      w.write_f64_4(static_cast<double>(af.bpm_x100) / 100.0);
+      w.write(",\"bands\":[");
+      for (uint8_t i = 0; i < chromance::core::kAudioBandCount; ++i) {
+        if (i) w.write(",");
+        w.write_u32(af.bands[i]);
+      }
+      w.write("]}");
+    }
+    w.write("}}");
+  };
+
+  ChunkedJsonWriter measure(nullptr, false);
+  emit(measure);
+  if (measure.bytes() > kMaxJsonBytes) {
+    send_json_error(500, "response_too_large", "Response too large");
+    return;
+  }
+
+  begin_chunked_json_response(server_, 200);
+  ChunkedJsonWriter out(&server_, true);
+  emit(out);
+  out.end_chunked();
+}
+
 void WebuiServer::api_get_effect_detail(const String& slug) {
   if (catalog_ == nullptr || manager_ == nullptr) {
     send_json_error(500, "internal", "Missing catalog");
@@ -870,6 +1094,37 @@ void WebuiServer::api_get_effect_detail(const String& slug) {
       w.write("}");
     }
 
+    if (e->layer_count() > 0) {
+      w.write(",\"layers\":{\"blendModes\":[");
+      for (uint8_t m = 0; m < chromance::core::kBlendModeCount; ++m) {
+        if (m) w.write(",");
+        w.write("\"");
+        w.write_escaped(chromance::core::blend_mode_name(static_cast<chromance::core::BlendMode>(m)));
+        w.write("\"");
+      }
+      w.write("],\"items\":[");
+      const uint8_t n = e->layer_count();
+      bool first_layer = true;
+      for (uint8_t i = 0; i < n; ++i) {
+        const auto* l = e->layer_at(i);
+        if (l == nullptr || l->effect == nullptr) continue;
+        if (!first_layer) w.write(",");
+        first_layer = false;
+        w.write("{\"slug\":\"");
+        w.write_escaped(l->effect->slug ? l->effect->slug : "");
+        w.write("\",\"displayName\":\"");
+        w.write_escaped(l->effect->display_name ? l->effect->display_name : "");
+        w.write("\",\"opacityParam\":");
+        w.write_u32(l->opacity_param.value);
+        if (l->mode_param.valid()) {
+          w.write(",\"modeParam\":");
+          w.write_u32(l->mode_param.value);
+        }
+        w.write("}");
+      }
+      w.write("]}");
+    }
+
     w.write("}}");
   };
 
@@ -905,6 +1160,9 @@ void WebuiServer::api_post_activate(const String& slug) {
     send_json_error(409, "busy", "Failed to activate effect");
     return;
   }
+  if (playlist_ != nullptr) {
+    playlist_->stop(now_ms);  // picking an effect by hand ends the show
+  }
 
   runtime_settings_->set_mode(static_cast<uint8_t>(id.value));
 
@@ -1240,6 +1498,229 @@ void WebuiServer::api_post_reset() {
   pending_restart_ = true;
 }
 
+void WebuiServer::api_get_mapping_pixels() {
+  using chromance::core::MappingTables;
+
+  // Same data as mapping/pixels.json, as parallel x/y arrays, for the live preview canvas.
+  const auto emit = [&](ChunkedJsonWriter& w) {
+    w.write("{\"ok\":true,\"data\":{\"mappingVersion\":\"");
+    w.write_escaped(MappingTables::mapping_version());
+    w.write("\",\"width\":");
+    w.write_u32(MappingTables::width());
+    w.write(",\"height\":");
+    w.write_u32(MappingTables::height());
+    w.write(",\"ledCount\":");
+    w.write_u32(MappingTables::led_count());
+    w.write(",\"x\":[");
+    for (uint16_t i = 0; i < MappingTables::led_count(); ++i) {
+      if (i) w.write(",");
+      w.write_i32(MappingTables::pixel_x()[i]);
+    }
+    w.write("],\"y\":[");
+    for (uint16_t i = 0; i < MappingTables::led_count(); ++i) {
+      if (i) w.write(",");
+      w.write_i32(MappingTables::pixel_y()[i]);
+    }
+    w.write("]}}");
+  };
+
+  ChunkedJsonWriter measure(nullptr, false);
+  emit(measure);
+  if (measure.bytes() > kMaxJsonBytes) {
+    send_json_error(500, "response_too_large", "Response too large");
+    return;
+  }
+
+  begin_chunked_json_response(server_, 200);
+  ChunkedJsonWriter out(&server_, true);
+  emit(out);
+  out.end_chunked();
+}
+
+void WebuiServer::api_get_playlist() {
+  if (playlist_ == nullptr) {
+    send_json_error(404, "not_found", "Playlist not available");
+    return;
+  }
+  const uint32_t now_ms = millis();
+  const chromance::core::PlaylistConfig& c = playlist_->config();
+
+  const auto emit = [&](ChunkedJsonWriter& w) {
+    w.write("{\"ok\":true,\"data\":{\"running\":");
+    w.write(playlist_->running() ? "true" : "false");
+    w.write(",\"index\":");
+    w.write_u32(playlist_->index());
+    if (playlist_->running() && playlist_->remaining_ms(now_ms) != 0xFFFFFFFFU) {
+      w.write(",\"remainingMs\":");
+      w.write_u32(playlist_->remaining_ms(now_ms));
+    }
+    w.write(",\"maxEntries\":");
+    w.write_u32(chromance::core::kMaxPlaylistEntries);
+    w.write(",\"maxParams\":");
+    w.write_u32(chromance::core::kMaxPlaylistParams);
+    w.write(",\"entries\":[");
+    for (uint8_t i = 0; i < c.count; ++i) {
+      const chromance::core::PlaylistEntry& e = c.entries[i];
+      if (i) w.write(",");
+      w.write("{\"effectId\":");
+      w.write_u32(e.effect_id);
+      w.write(",\"canonicalSlug\":\"");
+      w.write_escaped(canonical_slug_for_id(chromance::core::EffectId{e.effect_id}).c_str());
+      w.write("\",\"durationS\":");
+      w.write_u32(e.duration_s);
+      if (e.transition_ms != chromance::core::kPlaylistDefaultTransition) {
+        w.write(",\"transitionMs\":");
+        w.write_u32(e.transition_ms);
+      }
+      w.write(",\"params\":[");
+      for (uint8_t p = 0; p < e.param_count; ++p) {
+        if (p) w.write(",");
+        w.write("{\"id\":");
+        w.write_u32(e.params[p].id);
+        w.write(",\"raw\":");
+        w.write_i32(e.params[p].raw);
+        w.write("}");
+      }
+      w.write("]}");
+    }
+    w.write("]}}");
+  };
+
+  ChunkedJsonWriter measure(nullptr, false);
+  emit(measure);
+  if (measure.bytes() > kMaxJsonBytes) {
+    send_json_error(500, "response_too_large", "Response too large");
+    return;
+  }
+  begin_chunked_json_response(server_, 200);
+  ChunkedJsonWriter out(&server_, true);
+  emit(out);
+  out.end_chunked();
+}
+
+void WebuiServer::api_post_playlist() {
+  if (playlist_ == nullptr || catalog_ == nullptr) {
+    send_json_error(404, "not_found", "Playlist not available");
+    return;
+  }
+  const String body = server_.arg("plain");
+  if (body.length() == 0 || body.length() > kMaxPlaylistBodyBytes) {
+    send_json_error(400, "bad_request", "Invalid body");
+    return;
+  }
+  StaticJsonDocument<3072> doc;
+  if (deserializeJson(doc, body)) {
+    send_json_error(400, "bad_request", "Invalid JSON");
+    return;
+  }
+  JsonArray items = doc["entries"].as<JsonArray>();
+  if (items.isNull() || items.size() > chromance::core::kMaxPlaylistEntries) {
+    send_json_error(400, "bad_request", "Invalid entries");
+    return;
+  }
+
+  chromance::core::PlaylistConfig c;
+  memset(&c, 0, sizeof(c));
+  c.version = chromance::core::kPlaylistConfigVersion;
+  for (JsonVariant v : items) {
+    JsonObject o = v.as<JsonObject>();
+    if (o.isNull() || !o["effectId"].is<uint32_t>() || !o["durationS"].is<uint32_t>()) {
+      send_json_error(400, "bad_request", "Entry needs effectId and durationS");
+      return;
+    }
+    const uint32_t effect_id = o["effectId"].as<uint32_t>();
+    const uint32_t duration_s = o["durationS"].as<uint32_t>();
+    if (effect_id == 0 || effect_id > 0xFFFF || catalog_->find_by_id(chromance::core::EffectId{
+                                                    static_cast<uint16_t>(effect_id)}) == nullptr) {
+      send_json_error(400, "bad_request", "Unknown effect");
+      return;
+    }
+    if (duration_s > 0xFFFF) {
+      send_json_error(400, "bad_request", "Invalid duration");
+      return;
+    }
+    chromance::core::PlaylistEntry& e = c.entries[c.count++];
+    e.effect_id = static_cast<uint16_t>(effect_id);
+    e.duration_s = static_cast<uint16_t>(duration_s);
+    e.transition_ms = chromance::core::kPlaylistDefaultTransition;
+    if (!o["transitionMs"].isNull()) {
+      if (!o["transitionMs"].is<uint32_t>() || o["transitionMs"].as<uint32_t>() >= 0xFFFF) {
+        send_json_error(400, "bad_request", "Invalid transition");
+        return;
+      }
+      e.transition_ms = static_cast<uint16_t>(o["transitionMs"].as<uint32_t>());
+    }
+    JsonArray params = o["params"].as<JsonArray>();
+    if (!params.isNull()) {
+      if (params.size() > chromance::core::kMaxPlaylistParams) {
+        send_json_error(400, "bad_request", "Too many params");
+        return;
+      }
+      for (JsonVariant pv : params) {
+        JsonObject po = pv.as<JsonObject>();
+        if (po.isNull() || !po["id"].is<uint32_t>() || !po["raw"].is<int32_t>() || po["id"].as<uint32_t>() == 0 ||
+            po["id"].as<uint32_t>() > 0xFFFF) {
+          send_json_error(400, "bad_request", "Invalid param");
+          return;
+        }
+        chromance::core::PlaylistParam& p = e.params[e.param_count++];
+        p.id = static_cast<uint16_t>(po["id"].as<uint32_t>());
+        p.raw = po["raw"].as<int32_t>();
+      }
+    }
+  }
+
+  if (!playlist_->set_config(c, millis())) {
+    send_json_error(400, "bad_request", "Invalid playlist");
+    return;
+  }
+  String resp;
+  resp.reserve(64);
+  resp += "{\"ok\":true,\"data\":{\"count\":";
+  resp += String(static_cast<unsigned>(c.count));
+  resp += ",\"running\":false}}";
+  send_json_ok_bounded(resp);
+}
+
+void WebuiServer::api_post_playlist_control(const String& action) {
+  if (playlist_ == nullptr || manager_ == nullptr) {
+    send_json_error(404, "not_found", "Playlist not available");
+    return;
+  }
+  const uint32_t now_ms = millis();
+  if (action == "start") {
+    uint32_t index = 0;
+    const String body = server_.arg("plain");
+    if (body.length() > 0 && body.length() <= kMaxHttpBodyBytes) {
+      StaticJsonDocument<128> doc;
+      if (!deserializeJson(doc, body)) (void)json_get_u32(doc, "index", &index);
+    }
+    if (!playlist_->start(now_ms, *manager_, static_cast<uint8_t>(index))) {
+      send_json_error(409, "busy", "Playlist empty or no playable entry");
+      return;
+    }
+  } else if (action == "stop") {
+    playlist_->stop(now_ms);
+  } else if (action == "next") {
+    if (!playlist_->next(now_ms, *manager_)) {
+      send_json_error(409, "busy", "Playlist not running");
+      return;
+    }
+  } else {
+    send_json_error(404, "not_found", "Unknown API route");
+    return;
+  }
+
+  String resp;
+  resp.reserve(64);
+  resp += "{\"ok\":true,\"data\":{\"running\":";
+  resp += playlist_->running() ? "true" : "false";
+  resp += ",\"index\":";
+  resp += String(static_cast<unsigned>(playlist_->index()));
+  resp += "}}";
+  send_json_ok_bounded(resp);
+}
+
 void WebuiServer::api_get_persistence_summary() {
   if (catalog_ == nullptr || runtime_settings_ == nullptr || manager_ == nullptr) {
     send_json_error(500, "internal", "Missing state");
@@ -1355,6 +1836,7 @@ void WebuiServer::api_delete_persistence_all() {
   (void)prefs_.remove("aeid");
   (void)prefs_.remove("bright_pct");
   (void)prefs_.remove("mode");
+  (void)prefs_.remove(chromance::core::kPlaylistStoreKey);
 
   // Remove per-effect keys derived from catalog ids (lowercase), plus legacy uppercase variants.
   for (size_t i = 0; i < catalog_->count(); ++i) {
@@ -4,11 +4,17 @@
 #include <WebServer.h>
 
 #include <Preferences.h>
+#include <WiFi.h>
 #include <stdint.h>
 
+#include "core/audio/audio_analyzer.h"
 #include "core/effects/effect_catalog.h"
 #include "core/effects/effect_manager.h"
 #include "core/effects/effect_params.h"
+#include "core/effects/playlist.h"
+#include "core/power_governor.h"
+#include "core/protocol/asset_send.h"
+#include "core/seqlock_snapshot.h"
 #include "platform/settings.h"
 
 namespace chromance {
@@ -30,6 +36,20 @@ class WebuiServer {
   // When true, the main loop MUST reboot the device after the current iteration.
   bool take_pending_restart();
 
+  // True while a static asset is still being sent or a request arrived within the last kBusyHoldMs.
+  bool busy(uint32_t now_ms) const;
+
+  // Optional: adds the power governor's state to /api/perf.
+  void set_power_governor(const chromance::core::PowerGovernor* governor) { power_governor_ = governor; }
+
+  // Optional: enables the /api/playlist routes. Manual activation through the API stops a running playlist.
+  void set_playlist(chromance::core::PlaylistScheduler* playlist) { playlist_ = playlist; }
+
+  // Optional: adds the audio analysis state and per-block cost to /api/perf.
+  void set_audio_features(const chromance::core::SeqLockSnapshot<chromance::core::AudioFeatures>* features) {
+    audio_features_ = features;
+  }
+
  private:
   void dispatch();
 
@@ -39,7 +59,14 @@ class WebuiServer {
   bool handle_api_routes();
 
   // Static assets
+  struct AssetSend {
+    WiFiClient client;
+    chromance::core::AssetSendState state;
+    bool active = false;
+  };
   bool send_embedded_asset(const char* request_path, const char* content_type_override);
+  size_t pump_asset_send(AssetSend& s, size_t byte_budget, uint32_t now_ms);
+  void pump_asset_sends(uint32_t now_ms);
 
   // API endpoints
   void api_get_effects();
@@ -53,6 +80,13 @@ class WebuiServer {
   void api_post_brightness();
   void api_post_reset();
 
+  void api_get_mapping_pixels();
+  void api_get_perf();
+
+  void api_get_playlist();
+  void api_post_playlist();
+  void api_post_playlist_control(const String& action);
+
   void api_get_persistence_summary();
   void api_get_persistence_effect(const String& slug);
   void api_delete_persistence_all();
@@ -95,6 +129,17 @@ class WebuiServer {
 
   bool pending_restart_ = false;
 
+  chromance::core::PlaylistScheduler* playlist_ = nullptr;
+  const chromance::core::PowerGovernor* power_governor_ = nullptr;
+  const chromance::core::SeqLockSnapshot<chromance::core::AudioFeatures>* audio_features_ = nullptr;
+  bool request_seen_ = false;
+  uint32_t last_request_ms_ = 0;
+
+  // In-flight static asset responses (one per connection), resumed from handle().
+  static constexpr size_t kMaxAssetSends = 3;
+  AssetSend asset_sends_[kMaxAssetSends];
+  uint8_t asset_send_cursor_ = 0;
+
   static constexpr size_t kMaxCollidedAliases = 8;
   const char* collided_aliases_[kMaxCollidedAliases] = {};
   uint8_t collided_alias_count_ = 0;
@@ -0,0 +1,66 @@
+import unittest
+
+# `objdump -h -t -w -C` of a linked ESP32 firmware, trimmed.
+OBJDUMP = """
+firmware.elf:     file format elf32-xtensa-le
+
+Sections:
+Idx Name          Size      VMA       LMA       File off  Algn  Flags
+  0 .rtc.text     00000000  400c0000  400c0000  000d1000  2**0  CONTENTS
+  3 .dram0.data   00003a10  3ffbdb60  3ffbdb60  00001b60  2**4  CONTENTS, ALLOC, LOAD, DATA
+  4 .noinit       00000010  3ffc1570  3ffc1570  00000000  2**2  ALLOC
+  5 .dram0.bss    00009b48  3ffc1580  3ffc1580  00000000  2**3  ALLOC
+  7 .flash.rodata 0001a2c4  3f400020  3f400020  00010020  2**4  CONTENTS, ALLOC, LOAD, DATA
+
+SYMBOL TABLE:
+3ffc1a20 l     O .dram0.bss\t000023b8 (anonymous namespace)::control_channel
+3ffbe000 l     O .dram0.data\t00001a58 (anonymous namespace)::effect_manager
+3ffc4000 l     O .dram0.bss\t00000690 (anonymous namespace)::rgb
+3ffc5000 g     O .dram0.bss\t00004800 s_wifi_static_pool
+3ffc6000 l     O .dram0.bss\t00000000 empty_marker
+3f401000 l     O .flash.rodata\t00008000 chromance::mapping::pixel_x
+400d1000 g     F .flash.text\t00000120 setup()
+"""
+
+
+class TestDramReport(unittest.TestCase):
+    def test_parses_dram_sections_and_objects_largest_first(self):
+        from scripts.dram_report import parse_objdump
+
+        report = parse_objdump(OBJDUMP)
+        self.assertEqual(report.sections, {".dram0.data": 0x3A10, ".noinit": 0x10, ".dram0.bss": 0x9B48})
+        self.assertEqual(report.total, 0x3A10 + 0x10 + 0x9B48)
+        self.assertEqual(
+            [o.name for o in report.objects],
+            [
+                "s_wifi_static_pool",
+                "(anonymous namespace)::control_channel",
+                "(anonymous namespace)::effect_manager",
+                "(anonymous namespace)::rgb",
+            ],
+        )
+        self.assertEqual(report.objects[2].section, ".dram0.data")
+
+    def test_budgets_fail_on_total_and_on_our_objects_only(self):
+        from scripts.dram_report import check_budgets, parse_objdump
+
+        report = parse_objdump(OBJDUMP)
+        self.assertEqual(check_budgets(report, total_budget=64 * 1024, symbol_budget=16 * 1024), [])
+
+        errors = check_budgets(report, total_budget=32 * 1024, symbol_budget=4 * 1024, symbol_budgets={})
+        self.assertEqual(len(errors), 3)
+        self.assertIn("static DRAM", errors[0])
+        self.assertIn("control_channel", errors[1])  # 9144 B
+        self.assertIn("effect_manager", errors[2])  # 6744 B; the framework pool is not ours
+
+        named = check_budgets(
+            report,
+            total_budget=64 * 1024,
+            symbol_budget=16 * 1024,
+            symbol_budgets={"(anonymous namespace)::rgb": 1024},
+        )
+        self.assertEqual(named, ["(anonymous namespace)::rgb (.dram0.bss) is 1680 B, budget 1024 B"])
+
+
+if __name__ == "__main__":
+    unittest.main()
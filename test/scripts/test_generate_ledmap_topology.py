@@ -34,6 +34,208 @@ class TestGenerateLedmapTopology(unittest.TestCase):
         self.assertEqual(vid[(2, 7)], 9)
         self.assertEqual(vid[(3, 8)], 14)
 
+    def test_panels_extend_topology_and_share_coincident_vertices(self):
+        from scripts.generate_ledmap import SEGMENTS, build_topology
+
+        self.assertEqual(build_topology([(0, 0)]), SEGMENTS)
+
+        topology = build_topology([(0, 0), (6, 2)])
+        self.assertEqual(len(topology), 2 * len(SEGMENTS))
+        self.assertEqual(topology[40], ((6, 3), (6, 5)))  # panel 1, seg 1
+        vertices = {v for seg in topology for v in seg}
+        self.assertEqual(len(vertices), 2 * 25 - 1)  # (6,3) is shared
+
+        with self.assertRaises(ValueError):
+            build_topology([(0, 0), (6, 0)])  # panel 1 seg 1 lands on panel 0 seg 40
+
+    def test_nodes_partition_strips_into_led_ranges_with_halo(self):
+        from pathlib import Path
+
+        from scripts.generate_ledmap import (
+            ROLE_HALO,
+            ROLE_LOCAL,
+            ROLE_REMOTE,
+            UNASSIGNED_PIN,
+            build_node_view,
+            node_strips,
+            parse_wiring,
+        )
+
+        wiring = Path(__file__).resolve().parents[2] / "mapping" / "wiring_4panel_example.json"
+        _version, _bench, topology, strips, ordered, nodes = parse_wiring(wiring)
+        self.assertEqual([n.name for n in nodes], ["top", "bottom"])
+
+        views = [build_node_view(topology, strips, ordered, nodes, i) for i in range(len(nodes))]
+        self.assertEqual((views[0].led_first, views[0].led_count), (0, 1120))
+        self.assertEqual((views[1].led_first, views[1].led_count), (1120, 1120))
+        for seg in range(1, len(topology) + 1):
+            roles = sorted(v.seg_role[seg] for v in views)
+            self.assertEqual(roles.count(ROLE_LOCAL), 1)  # every segment has exactly one owner
+
+        top = views[0]
+        local_vertices = {v for seg in range(1, len(topology) + 1) if top.seg_role[seg] == ROLE_LOCAL
+                          for v in topology[seg - 1]}
+        for seg in range(1, len(topology) + 1):
+            touches = any(v in local_vertices for v in topology[seg - 1])
+            if top.seg_role[seg] != ROLE_LOCAL:
+                self.assertEqual(top.seg_role[seg], ROLE_HALO if touches else ROLE_REMOTE)
+        self.assertGreater(top.seg_role.count(ROLE_HALO), 0)
+
+        pinned = node_strips(strips, views[1])
+        self.assertEqual([s.data_pin for s in pinned[:4]], [UNASSIGNED_PIN] * 4)
+        self.assertEqual([s.data_pin for s in pinned[4:]], [s.data_pin for s in strips[4:]])
+
+        whole = build_node_view(topology, strips, ordered, [], 0)
+        self.assertEqual((whole.count, whole.led_first, whole.led_count), (1, 0, 2240))
+        self.assertNotIn(ROLE_HALO, whole.seg_role)
+
+    def test_segment_runs_decode_to_the_flat_tables(self):
+        from pathlib import Path
+
+        from scripts.generate_ledmap import (
+            LEDS_PER_SEGMENT,
+            build_global_to_strip_tables,
+            build_pixels,
+            build_segment_runs,
+            compute_bounds,
+            decode_segment_run_pixels,
+            interpolate_raster,
+            parse_wiring,
+        )
+
+        # Integer interpolation rounds ties away from zero on both sides of the origin.
+        self.assertEqual(interpolate_raster(0, 1, 6), 0)  # 6.5 / 14
+        self.assertEqual(interpolate_raster(0, 14, 6), 7)  # 6.5
+        self.assertEqual(interpolate_raster(0, -14, 6), -7)  # -6.5
+
+        mapping_dir = Path(__file__).resolve().parents[2] / "mapping"
+        for name in ("wiring.json", "wiring_bench.json", "wiring_4panel_example.json"):
+            _version, _bench, topology, _strips, ordered, _nodes = parse_wiring(mapping_dir / name)
+            pixels = build_pixels(topology, ordered)
+            min_x, min_y, _max_x, _max_y = compute_bounds(pixels)
+            _g2s, g2l = build_global_to_strip_tables(ordered)
+            runs = build_segment_runs(ordered)
+            self.assertEqual(len(runs) * LEDS_PER_SEGMENT, len(pixels))
+            for r, run in enumerate(runs):
+                first = r * LEDS_PER_SEGMENT
+                expected = [(x - min_x, y - min_y) for (x, y) in pixels[first : first + LEDS_PER_SEGMENT]]
+                self.assertEqual(decode_segment_run_pixels(topology, run, (min_x, min_y)), expected, name)
+                dir_b_to_a = (run >> 15) & 1
+                local = (run >> 16) + (LEDS_PER_SEGMENT - 1 if dir_b_to_a else 0)
+                self.assertEqual(g2l[first], local, name)
+
+    def test_mapping_blob_header_directory_and_checksum(self):
+        import json
+        import struct
+        import subprocess
+        import sys
+        import tempfile
+        from pathlib import Path
+
+        from scripts.generate_ledmap import BLOB_HEADER_BYTES, BLOB_VERSION, fnv1a32
+
+        repo = Path(__file__).resolve().parents[2]
+        with tempfile.TemporaryDirectory() as tmp:
+            out = Path(tmp)
+            subprocess.run(
+                [
+                    sys.executable,
+                    str(repo / "scripts" / "generate_ledmap.py"),
+                    "--wiring",
+                    str(repo / "mapping" / "wiring_bench.json"),
+                    "--out-ledmap",
+                    str(out / "ledmap.json"),
+                    "--out-blob",
+                    str(out / "mapping.bin"),
+                ],
+                check=True,
+                capture_output=True,
+            )
+            blob = (out / "mapping.bin").read_bytes()
+            ledmap = json.loads((out / "ledmap.json").read_text())
+
+        magic, version, table_count, total, checksum = struct.unpack_from("<4sHHII", blob, 0)
+        self.assertEqual((magic, version, total), (b"CHMP", BLOB_VERSION, len(blob)))
+        self.assertEqual(checksum, fnv1a32(blob[16:]))
+        led_count, width, height, run_count = struct.unpack_from("<HHHH", blob, 16)
+        self.assertEqual((width, height), (ledmap["width"], ledmap["height"]))
+        self.assertEqual(led_count, sum(1 for i in ledmap["map"] if i >= 0))
+        self.assertEqual(run_count * blob[24], led_count)
+        self.assertEqual(blob[29] & 1, 1)  # bench subset
+
+        offsets = struct.unpack_from(f"<{table_count}I", blob, BLOB_HEADER_BYTES)
+        self.assertEqual(offsets[0], BLOB_HEADER_BYTES + 4 * table_count)
+        self.assertEqual(list(offsets), sorted(offsets))
+        self.assertTrue(all(at % 4 == 0 and at < total for at in offsets))
+
+        # pixel_x/pixel_y (tables 0 and 1) place every LED where ledmap.json does.
+        xs = struct.unpack_from(f"<{led_count}h", blob, offsets[0])
+        ys = struct.unpack_from(f"<{led_count}h", blob, offsets[1])
+        for i in range(led_count):
+            self.assertEqual(ledmap["map"][xs[i] + ys[i] * width], i)
+
+    def test_wire_order_renumbers_leds_strip_by_strip(self):
+        from pathlib import Path
+
+        from scripts.generate_ledmap import (
+            LEDS_PER_SEGMENT,
+            build_global_to_segment_tables,
+            build_global_to_strip_tables,
+            build_pixels,
+            build_segment_runs,
+            compute_bounds,
+            decode_segment_run_pixels,
+            parse_wiring,
+            permute,
+            renumber_in_wire_order,
+        )
+
+        mapping_dir = Path(__file__).resolve().parents[2] / "mapping"
+        for name in ("wiring.json", "wiring_4panel_example.json"):
+            _version, _bench, topology, strips, ordered, _nodes = parse_wiring(mapping_dir / name)
+            pixels = build_pixels(topology, ordered)
+            g2s, g2l = build_global_to_strip_tables(ordered)
+            seg, _seg_k, _dir = build_global_to_segment_tables(ordered)
+            new_index = renumber_in_wire_order(g2s, g2l, strips)
+            wire_pixels = permute(pixels, new_index)
+            wire_g2s = permute(g2s, new_index)
+            wire_g2l = permute(g2l, new_index)
+            wire_seg = permute(seg, new_index)
+
+            # Strips follow each other and each counts up from local 0; every LED keeps its place and segment.
+            first = 0
+            for i in range(len(pixels)):
+                if i > 0 and wire_g2s[i] != wire_g2s[i - 1]:
+                    first = i
+                self.assertEqual(wire_g2l[i], i - first, name)
+            self.assertEqual(sorted(zip(wire_pixels, wire_seg)), sorted(zip(pixels, seg)))
+
+            # The compact runs are unchanged and decode the renumbered pixels in wire order.
+            min_x, min_y, _max_x, _max_y = compute_bounds(pixels)
+            for r, run in enumerate(build_segment_runs(ordered)):
+                run_pixels = wire_pixels[r * LEDS_PER_SEGMENT : (r + 1) * LEDS_PER_SEGMENT]
+                expected = [(x - min_x, y - min_y) for (x, y) in run_pixels]
+                self.assertEqual(decode_segment_run_pixels(topology, run, (min_x, min_y), True), expected, name)
+
+    def test_nodes_must_cover_consecutive_strips_once(self):
+        from scripts.generate_ledmap import StripInfo, parse_nodes
+
+        strips = [StripInfo(segment_count=1, data_pin=1, clock_pin=2, name=f"s{i}") for i in range(3)]
+        ok = parse_nodes({"nodes": [{"name": "a", "strips": ["s0"]}, {"name": "b", "strips": ["s1", "s2"]}]}, strips)
+        self.assertEqual([(n.first_strip, n.strip_count) for n in ok], [(0, 1), (1, 2)])
+        self.assertEqual(parse_nodes({}, strips), [])
+
+        bad = [
+            [{"name": "a", "strips": ["s0", "s2"]}, {"name": "b", "strips": ["s1"]}],  # not consecutive
+            [{"name": "a", "strips": ["s0", "s1"]}],  # s2 unassigned
+            [{"name": "a", "strips": ["s0"]}, {"name": "a", "strips": ["s1", "s2"]}],  # duplicate name
+            [{"name": "a", "strips": ["s0", "s1", "s9"]}],  # unknown strip
+            [{"name": "Top", "strips": ["s0", "s1", "s2"]}],  # not an identifier
+        ]
+        for nodes in bad:
+            with self.assertRaises(ValueError):
+                parse_nodes({"nodes": nodes}, strips)
+
 
 if __name__ == "__main__":
     unittest.main()
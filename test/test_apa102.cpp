@@ -0,0 +1,155 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unity.h>
+
+#include "core/apa102.h"
+#include "core/effects/effect_manager.h"
+#include "core/effects/legacy_effect_adapter.h"
+#include "core/effects/pattern_coord_color.h"
+#include "core/effects/pattern_rainbow_pulse.h"
+#include "core/layout.h"
+#include "test_fakes.h"
+
+using chromance::core::Apa102Pixel;
+using chromance::core::ColorOrder;
+using chromance::core::CoordColorEffect;
+using chromance::core::EffectCatalog;
+using chromance::core::EffectConfigSchema;
+using chromance::core::EffectDescriptor;
+using chromance::core::EffectId;
+using chromance::core::EffectManager;
+using chromance::core::EffectParams;
+using chromance::core::EventContext;
+using chromance::core::IEffectV2;
+using chromance::core::LegacyEffectAdapter;
+using chromance::core::PixelsMap;
+using chromance::core::RainbowPulseEffect;
+using chromance::core::RenderContext;
+using chromance::core::Rgb;
+using chromance::core::Signals;
+using chromance::core::StripPixel;
+using chromance::testing::NullSettingsStore;
+
+namespace {
+
+class RgbOnlyEffect final : public IEffectV2 {
+ public:
+  explicit RgbOnlyEffect(EffectDescriptor d) : d_(d) {}
+
+  const EffectDescriptor& descriptor() const override { return d_; }
+  const EffectConfigSchema* schema() const override { return nullptr; }
+  void start(const EventContext&) override {}
+  void stop(const EventContext&) override {}
+  void reset_runtime(const EventContext&) override {}
+  void render(const RenderContext&, Rgb* out, size_t n) override {
+    for (size_t i = 0; i < n; ++i) out[i] = Rgb{1, 2, 3};
+  }
+
+ private:
+  EffectDescriptor d_{};
+};
+
+template <ColorOrder Order>
+void assert_wire_bytes(uint8_t first, uint8_t second, uint8_t third) {
+  const Rgb c{0x11, 0x22, 0x33};
+  Apa102Pixel<Order> p;
+  p.set(c);
+  TEST_ASSERT_EQUAL_HEX8(0xFF, p.bytes[0]);
+  TEST_ASSERT_EQUAL_HEX8(first, p.bytes[1]);
+  TEST_ASSERT_EQUAL_HEX8(second, p.bytes[2]);
+  TEST_ASSERT_EQUAL_HEX8(third, p.bytes[3]);
+  const Apa102Pixel<Order> q = Apa102Pixel<Order>::from_rgb(c);
+  TEST_ASSERT_EQUAL_MEMORY(p.bytes, q.bytes, 4);
+  const Rgb back = p.rgb();
+  TEST_ASSERT_EQUAL_UINT8(c.r, back.r);
+  TEST_ASSERT_EQUAL_UINT8(c.g, back.g);
+  TEST_ASSERT_EQUAL_UINT8(c.b, back.b);
+}
+
+}  // namespace
+
+void test_apa102_pixels_hold_colour_bytes_in_wire_order() {
+  assert_wire_bytes<ColorOrder::kRgb>(0x11, 0x22, 0x33);
+  assert_wire_bytes<ColorOrder::kRbg>(0x11, 0x33, 0x22);
+  assert_wire_bytes<ColorOrder::kGrb>(0x22, 0x11, 0x33);
+  assert_wire_bytes<ColorOrder::kGbr>(0x22, 0x33, 0x11);
+  assert_wire_bytes<ColorOrder::kBrg>(0x33, 0x11, 0x22);
+  assert_wire_bytes<ColorOrder::kBgr>(0x33, 0x22, 0x11);
+
+  // The strips' pixel type sends what Adafruit's DOTSTAR_BRG does: B, R, G after a full-brightness header.
+  StripPixel p;
+  p.set(Rgb{10, 20, 30});
+  const uint8_t expected[4] = {0xFF, 30, 10, 20};
+  TEST_ASSERT_EQUAL_MEMORY(expected, p.bytes, 4);
+  const Apa102Pixel<ColorOrder::kBrg, 0xE7> dim = Apa102Pixel<ColorOrder::kBrg, 0xE7>::from_rgb(Rgb{10, 20, 30});
+  TEST_ASSERT_EQUAL_HEX8(0xE7, dim.bytes[0]);
+
+  Rgb in[5];
+  for (uint8_t i = 0; i < 5; ++i) in[i] = Rgb{i, static_cast<uint8_t>(i * 40U), static_cast<uint8_t>(255U - i)};
+  StripPixel wire[5];
+  Rgb out[5];
+  chromance::core::encode_apa102(in, wire, 5);
+  chromance::core::decode_apa102(wire, out, 5);
+  TEST_ASSERT_EQUAL_MEMORY(in, out, sizeof(in));
+
+  TEST_ASSERT_EQUAL_UINT32(0, chromance::core::apa102_end_frame_bytes(0));
+  TEST_ASSERT_EQUAL_UINT32(1, chromance::core::apa102_end_frame_bytes(1));
+  TEST_ASSERT_EQUAL_UINT32(1, chromance::core::apa102_end_frame_bytes(16));
+  TEST_ASSERT_EQUAL_UINT32(2, chromance::core::apa102_end_frame_bytes(17));
+}
+
+void test_effect_manager_renders_wire_frames_only_for_opt_in_effects() {
+  constexpr size_t kLeds = chromance::core::MappingTables::led_count();
+  NullSettingsStore store;
+  PixelsMap map;
+  CoordColorEffect coord;
+  RainbowPulseEffect rainbow{700, 2000, 700};
+  LegacyEffectAdapter coord_v2(EffectDescriptor{EffectId{1}, "coord", "Coord", nullptr}, &coord);
+  LegacyEffectAdapter rainbow_v2(EffectDescriptor{EffectId{2}, "rainbow", "Rainbow", nullptr}, &rainbow);
+  RgbOnlyEffect rgb_only(EffectDescriptor{EffectId{3}, "rgb", "Rgb", nullptr});
+  EffectCatalog<4> catalog;
+  TEST_ASSERT_TRUE(catalog.add(coord_v2.descriptor(), &coord_v2));
+  TEST_ASSERT_TRUE(catalog.add(rainbow_v2.descriptor(), &rainbow_v2));
+  TEST_ASSERT_TRUE(catalog.add(rgb_only.descriptor(), &rgb_only));
+
+  static EffectManager<4> mgr;
+  mgr.init(store, catalog, map, 0);
+  EffectParams p;
+  p.brightness = 200;
+  mgr.set_global_params(p);
+  static Rgb rgb[kLeds];
+  static StripPixel wire[kLeds];
+  static Rgb decoded[kLeds];
+
+  // Opt-in effects write the same frame either way, so the output sees identical colours.
+  const EffectId wire_ids[] = {EffectId{1}, EffectId{2}};
+  for (const EffectId id : wire_ids) {
+    TEST_ASSERT_TRUE(mgr.set_active(id, 1000));
+    mgr.tick(1900, 16, Signals{});
+    mgr.render(rgb, kLeds);
+    TEST_ASSERT_TRUE(mgr.render_wire(wire, kLeds));
+    chromance::core::decode_apa102(wire, decoded, kLeds);
+    TEST_ASSERT_EQUAL_MEMORY(rgb, decoded, sizeof(rgb));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, wire[kLeds - 1].bytes[0]);
+    // A wire render counts as the frame: Coord_Color holds still, Rainbow_Pulse animates.
+    TEST_ASSERT_EQUAL(id.value == 2, mgr.frame_due(1900));
+  }
+
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{3}, 2000));
+  mgr.tick(2000, 16, Signals{});
+  TEST_ASSERT_FALSE(mgr.render_wire(wire, kLeds));
+  TEST_ASSERT_TRUE(mgr.frame_due(2000));
+
+  // Crossfades blend Rgb: the wire path steps aside until the fade ends.
+  mgr.set_transition_ms(400);
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{1}, 3000));
+  TEST_ASSERT_TRUE(mgr.transitioning());
+  mgr.tick(3100, 16, Signals{});
+  TEST_ASSERT_FALSE(mgr.render_wire(wire, kLeds));
+  mgr.tick(3400, 16, Signals{});
+  mgr.render(rgb, kLeds);
+  TEST_ASSERT_FALSE(mgr.transitioning());
+  TEST_ASSERT_TRUE(mgr.render_wire(wire, kLeds));
+  TEST_ASSERT_FALSE(mgr.render_wire(nullptr, kLeds));
+}
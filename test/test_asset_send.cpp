@@ -0,0 +1,90 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include "core/protocol/asset_send.h"
+
+using chromance::core::AssetSendState;
+using chromance::core::etag_matches;
+
+namespace {
+
+// Socket stand-in: accepts at most `window` bytes per pump, like a full TCP send buffer on a slow client.
+struct FakeSocket {
+  uint8_t out[4096] = {};
+  size_t len = 0;
+  size_t window = 0;
+  size_t accepted_this_pump = 0;
+  bool fail = false;
+
+  int32_t write(const uint8_t* data, size_t n) {
+    if (fail) return -1;
+    size_t room = window - accepted_this_pump;
+    if (n > room) n = room;
+    memcpy(out + len, data, n);
+    len += n;
+    accepted_this_pump += n;
+    return static_cast<int32_t>(n);
+  }
+};
+
+}  // namespace
+
+void test_asset_send_resumes_across_pumps_within_budget() {
+  static uint8_t body[3000];
+  for (size_t i = 0; i < sizeof(body); ++i) body[i] = static_cast<uint8_t>(i * 7U);
+
+  FakeSocket sock;
+  sock.window = 700;
+  AssetSendState send;
+  send.start(body, sizeof(body), 0);
+  auto write = [&sock](const uint8_t* p, size_t n) { return sock.write(p, n); };
+
+  // Budget caps each pump even when the socket could take more.
+  sock.window = 4096;
+  TEST_ASSERT_EQUAL(AssetSendState::Result::kPending, send.pump(write, 1024, 512, 1, 3000));
+  TEST_ASSERT_EQUAL_UINT32(1024, send.sent());
+
+  // A slow client accepts less than the budget; the rest waits for later pumps.
+  uint32_t now = 2;
+  AssetSendState::Result r = AssetSendState::Result::kPending;
+  while (r == AssetSendState::Result::kPending) {
+    sock.window = 700;
+    sock.accepted_this_pump = 0;
+    r = send.pump(write, 1024, 512, now++, 3000);
+    TEST_ASSERT_TRUE(sock.accepted_this_pump <= 700);
+  }
+  TEST_ASSERT_EQUAL(AssetSendState::Result::kDone, r);
+  TEST_ASSERT_EQUAL_UINT32(sizeof(body), sock.len);
+  TEST_ASSERT_EQUAL_MEMORY(body, sock.out, sizeof(body));
+  TEST_ASSERT_EQUAL_UINT32(0, send.remaining());
+}
+
+void test_asset_send_reports_stall_and_error() {
+  static const uint8_t body[100] = {};
+  FakeSocket sock;
+  auto write = [&sock](const uint8_t* p, size_t n) { return sock.write(p, n); };
+
+  AssetSendState send;
+  send.start(body, sizeof(body), 0xFFFFFF00u);  // stall timeout must survive millis() wrap
+  sock.window = 0;
+  TEST_ASSERT_EQUAL(AssetSendState::Result::kPending, send.pump(write, 512, 512, 0xFFFFFF00u + 2999u, 3000));
+  TEST_ASSERT_EQUAL(AssetSendState::Result::kStalled, send.pump(write, 512, 512, 0xFFFFFF00u + 3000u, 3000));
+
+  send.start(body, sizeof(body), 0);
+  sock.fail = true;
+  TEST_ASSERT_EQUAL(AssetSendState::Result::kError, send.pump(write, 512, 512, 1, 3000));
+}
+
+void test_asset_send_etag_matching() {
+  const char* etag = "\"0123abcd\"";
+  TEST_ASSERT_TRUE(etag_matches("\"0123abcd\"", etag));
+  TEST_ASSERT_TRUE(etag_matches("\"ffff\", W/\"0123abcd\" ", etag));
+  TEST_ASSERT_TRUE(etag_matches("*", etag));
+  TEST_ASSERT_FALSE(etag_matches("\"0123abcde\"", etag));
+  TEST_ASSERT_FALSE(etag_matches("0123abcd", etag));
+  TEST_ASSERT_FALSE(etag_matches("", etag));
+  TEST_ASSERT_FALSE(etag_matches(nullptr, etag));
+}
@@ -0,0 +1,226 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include <unity.h>
+
+#include "core/audio/audio_analyzer.h"
+#include "core/audio/audio_modulation_provider.h"
+#include "core/audio/fixed_fft.h"
+#include "core/audio/wav_reader.h"
+#include "core/seqlock_snapshot.h"
+
+using chromance::core::AudioAnalyzer;
+using chromance::core::AudioFeatures;
+using chromance::core::AudioModulationProvider;
+using chromance::core::RealFft;
+using chromance::core::SeqLockSnapshot;
+using chromance::core::Signals;
+using chromance::core::WavPcm16;
+
+namespace {
+
+void put_le16(std::vector<uint8_t>& b, uint16_t v) {
+  b.push_back(static_cast<uint8_t>(v & 0xFFU));
+  b.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void put_le32(std::vector<uint8_t>& b, uint32_t v) {
+  put_le16(b, static_cast<uint16_t>(v & 0xFFFFU));
+  put_le16(b, static_cast<uint16_t>(v >> 16));
+}
+
+void put_tag(std::vector<uint8_t>& b, const char* tag) { b.insert(b.end(), tag, tag + 4); }
+
+// Mono PCM16 WAV image with an extra chunk before "data", as some recorders write.
+std::vector<uint8_t> make_wav(const std::vector<int16_t>& pcm, uint32_t rate) {
+  std::vector<uint8_t> b;
+  put_tag(b, "RIFF");
+  put_le32(b, static_cast<uint32_t>(4 + 24 + 10 + 8 + pcm.size() * 2));
+  put_tag(b, "WAVE");
+  put_tag(b, "fmt ");
+  put_le32(b, 16);
+  put_le16(b, 1);
+  put_le16(b, 1);
+  put_le32(b, rate);
+  put_le32(b, rate * 2);
+  put_le16(b, 2);
+  put_le16(b, 16);
+  put_tag(b, "LIST");
+  put_le32(b, 1);
+  b.push_back(0);
+  b.push_back(0);  // pad byte
+  put_tag(b, "data");
+  put_le32(b, static_cast<uint32_t>(pcm.size() * 2));
+  for (int16_t s : pcm) put_le16(b, static_cast<uint16_t>(s));
+  return b;
+}
+
+uint32_t lcg_state = 12345;
+int32_t noise(int32_t amplitude) {
+  lcg_state = lcg_state * 1664525U + 1013904223U;
+  return static_cast<int32_t>((lcg_state >> 16) % (2U * amplitude + 1U)) - amplitude;
+}
+
+// Decaying noise bursts ("kicks") at bpm over a quiet noise floor.
+std::vector<int16_t> click_track(uint32_t rate, uint32_t bpm, uint32_t seconds, int32_t floor_amplitude) {
+  std::vector<int16_t> pcm(static_cast<size_t>(rate) * seconds);
+  const size_t period = static_cast<size_t>(rate) * 60U / bpm;
+  const size_t burst = rate / 40U;  // 25 ms
+  for (size_t i = 0; i < pcm.size(); ++i) {
+    int32_t v = noise(floor_amplitude);
+    const size_t in_beat = i % period;
+    if (in_beat < burst) {
+      v += noise(12000) * static_cast<int32_t>(burst - in_beat) / static_cast<int32_t>(burst);
+    }
+    pcm[i] = static_cast<int16_t>(v);
+  }
+  return pcm;
+}
+
+// Streams a WAV through the analyzer in I2S-sized chunks, stamping each chunk with its sample-clock time.
+void feed_wav(AudioAnalyzer<512>& a, const WavPcm16& wav, size_t chunk_frames) {
+  std::vector<int16_t> chunk(chunk_frames);
+  for (size_t f = 0; f < wav.frames; f += chunk_frames) {
+    const size_t n = wav.frames - f < chunk_frames ? wav.frames - f : chunk_frames;
+    for (size_t i = 0; i < n; ++i) chunk[i] = wav.sample(f + i);
+    const uint32_t end_ms = static_cast<uint32_t>((f + n - 1U) * 1000ULL / wav.sample_rate);
+    a.feed(chunk.data(), n, end_ms);
+  }
+}
+
+uint32_t fake_us = 0;
+uint32_t fake_clock_us() { return fake_us += 7; }
+
+}  // namespace
+
+void test_fixed_fft_power_spectrum_peaks_at_tone_bin() {
+  constexpr size_t kN = 256;
+  int16_t samples[kN];
+  // Tone exactly on bin 20: sin(2*pi*20*n/256) = table index 40n.
+  for (size_t n = 0; n < kN; ++n) {
+    samples[n] = static_cast<int16_t>(chromance::core::fixed_fft::sin_q15(n * 40U) / 2);
+  }
+  static RealFft<kN> fft;
+  uint32_t power[RealFft<kN>::kBins];
+  fft.load_windowed(samples);
+  fft.power_spectrum(power);
+
+  size_t peak = 0;
+  for (size_t k = 1; k < RealFft<kN>::kBins; ++k) {
+    if (power[k] > power[peak]) peak = k;
+  }
+  TEST_ASSERT_EQUAL_UINT32(20, peak);
+  // Hann leaks into the direct neighbours only (each a quarter of the peak amplitude).
+  TEST_ASSERT_UINT32_WITHIN(power[20] / 8U, power[20] / 4U, power[19]);
+  TEST_ASSERT_UINT32_WITHIN(power[20] / 8U, power[20] / 4U, power[21]);
+  TEST_ASSERT_TRUE(power[30] < power[20] / 10000U);
+  TEST_ASSERT_TRUE(power[0] < power[20] / 10000U);
+}
+
+void test_audio_analyzer_tracks_click_track_tempo_from_wav() {
+  // 150 BPM at 44.1 kHz puts the beat period between two whole blocks, the classic half-tempo trap.
+  const uint32_t cases[][2] = {{16000, 120}, {44100, 150}};
+  for (const auto& c : cases) {
+    const uint32_t rate = c[0];
+    const uint32_t bpm = c[1];
+    const std::vector<uint8_t> image = make_wav(click_track(rate, bpm, 10, 200), rate);
+    WavPcm16 wav;
+    TEST_ASSERT_TRUE(chromance::core::parse_wav_pcm16(image.data(), image.size(), &wav));
+    TEST_ASSERT_EQUAL_UINT32(rate, wav.sample_rate);
+    TEST_ASSERT_EQUAL_UINT32(rate * 10U, wav.frames);
+
+    static AudioAnalyzer<512> a;
+    a.begin(wav.sample_rate, fake_clock_us);
+    feed_wav(a, wav, 256);
+
+    const AudioFeatures& f = a.features();
+    TEST_ASSERT_UINT32_WITHIN(200, bpm * 100U, f.bpm_x100);  // +- 2 BPM
+    TEST_ASSERT_UINT32_WITHIN(2, bpm / 6U, f.onsets);        // one per click
+    // The beat grid lines up with the clicks (within one block of detection latency).
+    const uint32_t period_ms = 60000U / bpm;
+    const uint32_t since_click_ms = f.beat_ms % period_ms;
+    TEST_ASSERT_TRUE(since_click_ms < 40U || since_click_ms > period_ms - 20U);
+    TEST_ASSERT_TRUE(f.blocks > 500U);
+    TEST_ASSERT_EQUAL_UINT32(7, f.last_block_us);  // one fake-clock tick per block
+    TEST_ASSERT_EQUAL_UINT32(7, f.max_block_us);
+  }
+}
+
+void test_audio_analyzer_reports_energy_and_ignores_silence() {
+  static AudioAnalyzer<512> a;
+  a.begin(16000);
+  std::vector<int16_t> quiet(16000, 0);
+  a.feed(quiet.data(), quiet.size(), 1000);
+  TEST_ASSERT_EQUAL_UINT16(0, a.features().energy_q16);
+  TEST_ASSERT_EQUAL_UINT32(0, a.features().onsets);
+  TEST_ASSERT_EQUAL_UINT16(0, a.features().bpm_x100);
+  TEST_ASSERT_EQUAL_UINT32(0, a.features().last_block_us);  // no clock, no cost
+
+  // A steady loud tone: full energy once the adaptive peak has settled, mostly in the band holding 1 kHz.
+  std::vector<int16_t> tone(16000);
+  for (size_t n = 0; n < tone.size(); ++n) {
+    // 1 kHz at 16 kHz = 32 table steps per sample.
+    tone[n] = static_cast<int16_t>(chromance::core::fixed_fft::sin_q15(n * 32U) / 4);
+  }
+  a.feed(tone.data(), tone.size(), 2000);
+  const AudioFeatures& f = a.features();
+  TEST_ASSERT_TRUE(f.energy_q16 > 60000U);
+  TEST_ASSERT_EQUAL_UINT8(255, f.bands[4]);  // 640..1280 Hz
+  TEST_ASSERT_TRUE(f.bands[1] < 128U);
+  TEST_ASSERT_EQUAL_UINT32(2000, f.time_ms);
+}
+
+void test_wav_reader_rejects_unsupported_formats() {
+  std::vector<int16_t> pcm(8, 100);
+  std::vector<uint8_t> image = make_wav(pcm, 8000);
+  WavPcm16 wav;
+  TEST_ASSERT_TRUE(chromance::core::parse_wav_pcm16(image.data(), image.size(), &wav));
+  TEST_ASSERT_EQUAL_INT16(100, wav.sample(7));
+  // Truncated data is clipped rather than read past the end.
+  TEST_ASSERT_TRUE(chromance::core::parse_wav_pcm16(image.data(), image.size() - 3, &wav));
+  TEST_ASSERT_EQUAL_UINT32(6, wav.frames);
+
+  image[20] = 3;  // IEEE float
+  TEST_ASSERT_FALSE(chromance::core::parse_wav_pcm16(image.data(), image.size(), &wav));
+  image[20] = 1;
+  image[8] = 'X';
+  TEST_ASSERT_FALSE(chromance::core::parse_wav_pcm16(image.data(), image.size(), &wav));
+  TEST_ASSERT_FALSE(chromance::core::parse_wav_pcm16(image.data(), 10, &wav));
+}
+
+void test_audio_modulation_provider_reads_snapshot_and_extrapolates_phase() {
+  SeqLockSnapshot<AudioFeatures> snapshot;
+  AudioModulationProvider provider(&snapshot);
+  Signals s;
+  provider.get_signals(100, &s);
+  TEST_ASSERT_FALSE(s.has_energy);  // nothing published yet
+
+  AudioFeatures f;
+  f.blocks = 10;
+  f.time_ms = 1000;
+  f.energy_q16 = 32768;
+  snapshot.write(f);
+  TEST_ASSERT_EQUAL_UINT32(1, snapshot.version());
+  provider.get_signals(1010, &s);
+  TEST_ASSERT_TRUE(s.has_energy);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.5f, s.energy_01);
+  TEST_ASSERT_FALSE(s.has_bpm);
+  TEST_ASSERT_FALSE(s.has_beat_phase);
+
+  f.bpm_x100 = 12000;  // 500 ms period
+  f.beat_ms = 900;
+  snapshot.write(f);
+  provider.get_signals(1025, &s);
+  TEST_ASSERT_TRUE(s.has_bpm);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 120.0f, s.bpm);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.25f, s.beat_phase_01);
+  provider.get_signals(1400, &s);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, s.beat_phase_01);
+
+  // Stale analysis (capture stopped): nothing provided.
+  provider.get_signals(1000 + AudioModulationProvider::kStaleMs + 1U, &s);
+  TEST_ASSERT_FALSE(s.has_energy);
+  TEST_ASSERT_FALSE(s.has_bpm);
+}
@@ -14,6 +14,8 @@ using chromance::core::EventContext;
 using chromance::core::InputEvent;
 using chromance::core::Key;
 using chromance::core::PixelsMap;
+using chromance::core::ScratchBuffer;
+using chromance::core::kDefaultEffectScratchBytes;
 using chromance::core::StageId;
 
 void test_breathing_effect_v2_stage_and_event_routing() {
@@ -28,10 +30,13 @@ void test_breathing_effect_v2_stage_and_event_routing() {
   v2.bind_config(bytes, sizeof(bytes));
 
   PixelsMap map;
+  static ScratchBuffer<kDefaultEffectScratchBytes> scratch;
   EventContext ctx;
   ctx.now_ms = 100;
   ctx.map = &map;
+  ctx.scratch = scratch.scratch();
 
+  TEST_ASSERT_EQUAL_UINT32(legacy.scratch_bytes(), v2.scratch_bytes());
   v2.start(ctx);
   TEST_ASSERT_FALSE(legacy.manual_enabled());
   TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(BreathingEffect::Phase::Inhale),
@@ -68,3 +73,59 @@ void test_breathing_effect_v2_stage_and_event_routing() {
   TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(BreathingEffect::Phase::Inhale),
                           static_cast<uint8_t>(legacy.phase()));
 }
+
+void test_breathing_effect_v2_prepare_survives_start_and_matches_cold_render() {
+  alignas(4) uint8_t bytes[chromance::core::kMaxEffectConfigSize] = {};
+  bytes[0] = 12;  // configured_center_vertex_id
+  bytes[1] = 1;   // has_configured_center
+  bytes[2] = 5;   // num_dots
+
+  PixelsMap map;
+  EventContext ctx;
+  ctx.now_ms = 100;
+  ctx.map = &map;
+  const EffectDescriptor d{EffectId(7), "breathing", "Breathing", nullptr};
+
+  // Cold path: cache built inside the first render.
+  static BreathingEffect cold_legacy;
+  BreathingEffectV2 cold(d, &cold_legacy);
+  cold.bind_config(bytes, sizeof(bytes));
+  cold.start(ctx);
+  TEST_ASSERT_TRUE(cold.needs_prepare());
+
+  // Warm path: prepared ahead of time; start() (reset + config) must keep the cache.
+  static BreathingEffect warm_legacy;
+  BreathingEffectV2 warm(d, &warm_legacy);
+  warm.bind_config(bytes, sizeof(bytes));
+  warm.prepare(ctx);
+  TEST_ASSERT_FALSE(warm.needs_prepare());
+  ctx.now_ms = 500;
+  static ScratchBuffer<kDefaultEffectScratchBytes> warm_scratch;
+  static ScratchBuffer<kDefaultEffectScratchBytes> cold_scratch;
+  ctx.scratch = warm_scratch.scratch();
+  warm.start(ctx);
+  TEST_ASSERT_FALSE(warm.needs_prepare());
+  ctx.scratch = cold_scratch.scratch();
+  cold.start(ctx);
+
+  chromance::core::RenderContext rctx;
+  rctx.map = &map;
+  static chromance::core::Rgb a[chromance::core::MappingTables::led_count()];
+  static chromance::core::Rgb b[chromance::core::MappingTables::led_count()];
+  for (uint32_t t = 500; t < 900; t += 16) {
+    rctx.now_ms = t;
+    rctx.dt_ms = 16;
+    cold.render(rctx, a, map.led_count());
+    warm.render(rctx, b, map.led_count());
+    TEST_ASSERT_EQUAL_MEMORY(a, b, sizeof(a));
+  }
+  TEST_ASSERT_FALSE(cold.needs_prepare());
+
+  // Only center changes invalidate the topology cache.
+  bytes[2] = 6;
+  warm.bind_config(bytes, sizeof(bytes));
+  TEST_ASSERT_FALSE(warm.needs_prepare());
+  bytes[0] = 11;
+  warm.bind_config(bytes, sizeof(bytes));
+  TEST_ASSERT_TRUE(warm.needs_prepare());
+}
@@ -0,0 +1,227 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include <unity.h>
+
+#include "core/clip/clip_encoder.h"
+#include "core/clip/clip_format.h"
+#include "core/effects/pattern_clip_player.h"
+
+using chromance::core::ClipBundle;
+using chromance::core::ClipBundleWriter;
+using chromance::core::ClipEncoder;
+using chromance::core::ClipPaletteBuilder;
+using chromance::core::ClipPlayerEffect;
+using chromance::core::ClipReader;
+using chromance::core::EffectFrame;
+using chromance::core::PixelsMap;
+using chromance::core::Rgb;
+
+namespace {
+
+constexpr uint16_t kLeds = 200;
+constexpr uint16_t kFps = 50;
+constexpr uint32_t kHash = 0x12345678U;
+
+// A comet running along the strip over a black background, with a slowly cycling tint: mostly small deltas,
+// plus a full change every 40 frames to exercise the keyframe-when-cheaper rule.
+void make_frame(uint32_t f, uint8_t* indices) {
+  const uint8_t tint = static_cast<uint8_t>(1U + (f / 40U) % 3U);
+  for (uint16_t i = 0; i < kLeds; ++i) indices[i] = (f % 40U == 39U) ? tint : 0;
+  for (uint16_t k = 0; k < 5; ++k) indices[(f * 3U + k) % kLeds] = static_cast<uint8_t>(4U + k);
+}
+
+const Rgb kPalette[] = {{0, 0, 0},     {40, 0, 0},    {0, 40, 0},     {0, 0, 40}, {255, 255, 255},
+                        {200, 200, 0}, {150, 100, 0}, {100, 50, 0}, {50, 20, 0}};
+
+size_t encode_clip(std::vector<uint8_t>& out, uint32_t frames, uint32_t keyframe_interval) {
+  static ClipEncoder<kLeds, 64> enc;
+  out.assign(64 * 1024, 0);
+  TEST_ASSERT_TRUE(enc.begin(out.data(), out.size(), kLeds, kFps, kHash, kPalette, 9, keyframe_interval));
+  uint8_t idx[kLeds];
+  for (uint32_t f = 0; f < frames; ++f) {
+    make_frame(f, idx);
+    TEST_ASSERT_TRUE(enc.add_indices(idx));
+  }
+  const size_t size = enc.finish();
+  out.resize(size);
+  return size;
+}
+
+}  // namespace
+
+void test_clip_encoder_round_trips_keyframes_and_deltas() {
+  std::vector<uint8_t> clip;
+  const size_t size = encode_clip(clip, 200, 50);
+  TEST_ASSERT_TRUE(size > 0);
+  // Deltas of ~10 changed LEDs instead of 200-byte frames.
+  TEST_ASSERT_TRUE(size < 200U * 40U);
+
+  ClipReader r;
+  TEST_ASSERT_TRUE(r.open(clip.data(), clip.size()));
+  TEST_ASSERT_EQUAL_UINT16(kLeds, r.led_count());
+  TEST_ASSERT_EQUAL_UINT32(200, r.frame_count());
+  TEST_ASSERT_EQUAL_UINT16(kFps, r.fps());
+  TEST_ASSERT_EQUAL_UINT32(kHash, r.mapping_hash());
+  TEST_ASSERT_EQUAL_UINT16(9, r.palette_size());
+  TEST_ASSERT_EQUAL_UINT8(200, r.palette(5).r);
+
+  uint8_t got[kLeds];
+  uint8_t want[kLeds];
+  for (uint32_t f = 0; f < 200; ++f) {
+    TEST_ASSERT_TRUE(r.decode_next(got));
+    make_frame(f, want);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(want, got, kLeds);
+  }
+  TEST_ASSERT_FALSE(r.decode_next(got));  // end of clip
+}
+
+void test_clip_reader_seeks_through_keyframe_table() {
+  std::vector<uint8_t> clip;
+  encode_clip(clip, 200, 50);
+  ClipReader r;
+  TEST_ASSERT_TRUE(r.open(clip.data(), clip.size()));
+
+  uint8_t got[kLeds];
+  uint8_t want[kLeds];
+  const uint32_t targets[] = {137, 3, 4, 199, 0, 120, 121, 60};
+  for (uint32_t t : targets) {
+    TEST_ASSERT_TRUE(r.seek(t, got));
+    TEST_ASSERT_EQUAL_UINT32(t + 1U, r.next_frame());
+    make_frame(t, want);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(want, got, kLeds);
+  }
+  TEST_ASSERT_FALSE(r.seek(200, got));
+}
+
+void test_clip_reader_rejects_corrupt_clips() {
+  std::vector<uint8_t> clip;
+  encode_clip(clip, 20, 8);
+  ClipReader r;
+  TEST_ASSERT_FALSE(r.open(clip.data(), clip.size() - 1));  // truncated
+  TEST_ASSERT_FALSE(r.open(clip.data(), 10));
+
+  std::vector<uint8_t> bad = clip;
+  bad[0] = 'X';
+  TEST_ASSERT_FALSE(r.open(bad.data(), bad.size()));
+  bad = clip;
+  bad[4] = 2;  // version
+  TEST_ASSERT_FALSE(r.open(bad.data(), bad.size()));
+  bad = clip;
+  bad[18] = 0;  // palette size 0
+  bad[19] = 0;
+  TEST_ASSERT_FALSE(r.open(bad.data(), bad.size()));
+
+  // A delta pointing past the last LED fails the decode instead of writing out of bounds.
+  bad = clip;
+  const size_t frame1 = chromance::core::clip::kHeaderBytes + 9U * 3U + 1U + kLeds;
+  TEST_ASSERT_EQUAL_UINT8(chromance::core::clip::kFrameDelta, bad[frame1]);
+  bad[frame1 + 3] = 0xFF;  // gap 0x7Fxx
+  TEST_ASSERT_TRUE(r.open(bad.data(), bad.size()));
+  uint8_t got[kLeds];
+  TEST_ASSERT_TRUE(r.decode_next(got));
+  TEST_ASSERT_FALSE(r.decode_next(got));
+}
+
+void test_clip_encoder_quantizes_to_palette_and_reports_overflow() {
+  static ClipPaletteBuilder builder;
+  builder.reset();
+  Rgb frame[kLeds];
+  for (uint16_t i = 0; i < kLeds; ++i) {
+    frame[i] = i < 150 ? Rgb{0, 0, 0} : (i < 190 ? Rgb{250, 10, 10} : Rgb{10, 10, 250});
+  }
+  builder.add_frame(frame, kLeds);
+  Rgb palette[4];
+  TEST_ASSERT_EQUAL_UINT32(3, builder.build(palette, 4));
+  TEST_ASSERT_TRUE(palette[0] == (Rgb{0, 0, 0}));  // most used first
+  TEST_ASSERT_TRUE(palette[1] == (Rgb{250, 10, 10}));
+
+  static ClipEncoder<kLeds, 4> enc;
+  std::vector<uint8_t> out(4096);
+  TEST_ASSERT_TRUE(enc.begin(out.data(), out.size(), kLeds, 25, kHash, palette, 3, 100));
+  frame[10] = Rgb{240, 20, 0};  // snaps to the red entry
+  TEST_ASSERT_TRUE(enc.add_frame(frame));
+  const size_t size = enc.finish();
+  ClipReader r;
+  TEST_ASSERT_TRUE(r.open(out.data(), size));
+  uint8_t idx[kLeds];
+  TEST_ASSERT_TRUE(r.decode_next(idx));
+  TEST_ASSERT_EQUAL_UINT8(1, idx[10]);
+  TEST_ASSERT_EQUAL_UINT8(2, idx[195]);
+
+  // Too small a buffer: the encoder refuses frames and finish() reports failure.
+  TEST_ASSERT_TRUE(enc.begin(out.data(), 300, kLeds, 25, kHash, palette, 3, 1));
+  TEST_ASSERT_TRUE(enc.add_frame(frame));
+  TEST_ASSERT_FALSE(enc.add_frame(frame));
+  TEST_ASSERT_EQUAL_UINT32(0, enc.finish());
+}
+
+void test_clip_bundle_finds_clips_by_name() {
+  std::vector<uint8_t> a;
+  std::vector<uint8_t> b;
+  encode_clip(a, 10, 5);
+  encode_clip(b, 30, 5);
+  std::vector<uint8_t> bundle(a.size() + b.size() + 256);
+  ClipBundleWriter w;
+  TEST_ASSERT_TRUE(w.begin(bundle.data(), bundle.size(), 2));
+  TEST_ASSERT_TRUE(w.add("short", a.data(), a.size()));
+  TEST_ASSERT_FALSE(w.add("a-name-that-is-far-too-long", b.data(), b.size()));
+  TEST_ASSERT_EQUAL_UINT32(0, w.finish());
+  TEST_ASSERT_TRUE(w.add("long", b.data(), b.size()));
+  const size_t size = w.finish();
+  TEST_ASSERT_TRUE(size > 0);
+
+  ClipBundle dir;
+  TEST_ASSERT_TRUE(dir.open(bundle.data(), size));
+  TEST_ASSERT_EQUAL_UINT16(2, dir.count());
+  TEST_ASSERT_EQUAL_STRING("long", dir.name_at(1));
+  const uint8_t* data = nullptr;
+  size_t len = 0;
+  TEST_ASSERT_TRUE(dir.find("long", &data, &len));
+  TEST_ASSERT_EQUAL_UINT32(0, (data - bundle.data()) % 4U);
+  ClipReader r;
+  TEST_ASSERT_TRUE(r.open(data, len));
+  TEST_ASSERT_EQUAL_UINT32(30, r.frame_count());
+  TEST_ASSERT_FALSE(dir.find("missing", &data, &len));
+
+  // Erased flash (0xFF) is not a bundle.
+  std::vector<uint8_t> erased(1024, 0xFF);
+  TEST_ASSERT_FALSE(dir.open(erased.data(), erased.size()));
+}
+
+void test_clip_player_follows_clip_clock_and_brightness() {
+  std::vector<uint8_t> clip;
+  encode_clip(clip, 200, 50);
+
+  static ClipPlayerEffect<kLeds> player;
+  TEST_ASSERT_FALSE(player.set_clip(clip.data(), clip.size(), kLeds, kHash + 1U));  // other layout
+  TEST_ASSERT_FALSE(player.set_clip(clip.data(), clip.size(), kLeds - 1U, kHash));
+  TEST_ASSERT_TRUE(player.set_clip(clip.data(), clip.size(), kLeds, kHash));
+
+  PixelsMap map;
+  Rgb out[kLeds];
+  uint8_t want[kLeds];
+  EffectFrame frame;
+  player.reset(1000);
+
+  // 50 fps: frame n is shown from 1000 + 20n ms; 4020 ms = frame 151.
+  const uint32_t times[] = {1000, 1019, 1020, 1045, 4020, 1000 + 20U * 200U + 20U};
+  const uint32_t frames[] = {0, 0, 1, 2, 151, 1};
+  for (size_t k = 0; k < sizeof(times) / sizeof(times[0]); ++k) {
+    frame.now_ms = times[k];
+    player.render(frame, map, out, kLeds);
+    make_frame(frames[k], want);
+    for (uint16_t i = 0; i < kLeds; ++i) {
+      TEST_ASSERT_TRUE(out[i] == kPalette[want[i]]);
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(1000 + 20U * 202U, player.next_change_ms(1000 + 20U * 201U + 5U));
+
+  frame.params.brightness = 0;
+  player.render(frame, map, out, kLeds);
+  for (uint16_t i = 0; i < kLeds; ++i) {
+    TEST_ASSERT_TRUE(out[i] == chromance::core::kBlack);
+  }
+}
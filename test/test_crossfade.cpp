@@ -0,0 +1,217 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include "core/effects/blend.h"
+#include "core/effects/effect_manager.h"
+#include "core/frame_arena.h"
+#include "test_fakes.h"
+
+using chromance::core::EffectCatalog;
+using chromance::core::EffectDescriptor;
+using chromance::core::EffectId;
+using chromance::core::EffectManager;
+using chromance::core::FrameArena;
+using chromance::core::PixelsMap;
+using chromance::core::RenderContext;
+using chromance::core::Rgb;
+using chromance::core::Signals;
+using chromance::testing::NullSettingsStore;
+using chromance::testing::SolidEffect;
+
+namespace {
+
+constexpr size_t kLeds = 7;  // odd byte count exercises the kernel tail
+
+}  // namespace
+
+void test_crossfade_packed_kernel_matches_scalar_reference() {
+  Rgb a[kLeds];
+  Rgb b[kLeds];
+  Rgb out[kLeds];
+  for (size_t i = 0; i < kLeds; ++i) {
+    a[i] = Rgb{static_cast<uint8_t>(i * 37U), static_cast<uint8_t>(255U - i * 11U), 0};
+    b[i] = Rgb{255, static_cast<uint8_t>(i * 29U), static_cast<uint8_t>(i * 53U)};
+  }
+  const uint16_t ts[] = {0, 1, 64, 128, 200, 255, 256};
+  for (uint16_t t : ts) {
+    chromance::core::blend_crossfade(a, b, out, kLeds, t);
+    for (size_t i = 0; i < kLeds; ++i) {
+      TEST_ASSERT_EQUAL_UINT8(chromance::core::lerp_u8(a[i].r, b[i].r, t), out[i].r);
+      TEST_ASSERT_EQUAL_UINT8(chromance::core::lerp_u8(a[i].g, b[i].g, t), out[i].g);
+      TEST_ASSERT_EQUAL_UINT8(chromance::core::lerp_u8(a[i].b, b[i].b, t), out[i].b);
+    }
+  }
+  chromance::core::blend_crossfade(a, b, out, kLeds, 0);
+  TEST_ASSERT_EQUAL_MEMORY(a, out, sizeof(a));
+  chromance::core::blend_crossfade(a, b, out, kLeds, 256);
+  TEST_ASSERT_EQUAL_MEMORY(b, out, sizeof(b));
+
+  FrameArena<16> arena;
+  TEST_ASSERT_NOT_NULL(arena.alloc<uint8_t>(3));
+  uint32_t* w = arena.alloc<uint32_t>(3);
+  TEST_ASSERT_NOT_NULL(w);
+  TEST_ASSERT_EQUAL_UINT32(0, reinterpret_cast<uintptr_t>(w) % alignof(uint32_t));
+  TEST_ASSERT_NULL(arena.alloc<uint8_t>(1));
+  arena.reset();
+  TEST_ASSERT_NOT_NULL(arena.alloc<uint8_t>(16));
+}
+
+void test_crossfade_manager_fades_then_stops_outgoing() {
+  NullSettingsStore store;
+  PixelsMap map;
+  SolidEffect red(EffectDescriptor{EffectId{1}, "red", "Red", nullptr}, Rgb{200, 0, 0});
+  SolidEffect blue(EffectDescriptor{EffectId{2}, "blue", "Blue", nullptr}, Rgb{0, 0, 200});
+  EffectCatalog<4> catalog;
+  TEST_ASSERT_TRUE(catalog.add(red.descriptor(), &red));
+  TEST_ASSERT_TRUE(catalog.add(blue.descriptor(), &blue));
+
+  static EffectManager<4, kLeds> mgr;
+  mgr.init(store, catalog, map, 0);
+  mgr.set_transition_ms(400);
+  Rgb out[kLeds] = {};
+
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{2}, 1000));
+  TEST_ASSERT_TRUE(mgr.transitioning());
+  TEST_ASSERT_EQUAL_UINT32(0, red.stop_calls);
+
+  mgr.tick(1100, 16, Signals{});
+  mgr.render(out, kLeds);
+  TEST_ASSERT_EQUAL_UINT8(150, out[0].r);  // 200 * (1 - 64/256)
+  TEST_ASSERT_EQUAL_UINT8(50, out[kLeds - 1].b);
+
+  mgr.tick(1300, 16, Signals{});
+  mgr.render(out, kLeds);
+  TEST_ASSERT_EQUAL_UINT8(50, out[0].r);
+  TEST_ASSERT_EQUAL_UINT8(150, out[0].b);
+
+  mgr.tick(1400, 16, Signals{});
+  const uint32_t red_renders = red.render_calls;
+  mgr.render(out, kLeds);
+  TEST_ASSERT_FALSE(mgr.transitioning());
+  TEST_ASSERT_EQUAL_UINT32(red_renders, red.render_calls);
+  TEST_ASSERT_EQUAL_UINT32(1, red.stop_calls);
+  TEST_ASSERT_EQUAL_UINT8(0, out[0].r);
+  TEST_ASSERT_EQUAL_UINT8(200, out[0].b);
+  TEST_ASSERT_EQUAL_UINT32(1, mgr.transition_stats().started);
+}
+
+void test_crossfade_degrades_to_shorter_fade_or_cut_under_budget() {
+  NullSettingsStore store;
+  PixelsMap map;
+  SolidEffect a(EffectDescriptor{EffectId{1}, "a", "A", nullptr}, Rgb{100, 0, 0});
+  SolidEffect b(EffectDescriptor{EffectId{2}, "b", "B", nullptr}, Rgb{0, 100, 0});
+  EffectCatalog<4> catalog;
+  TEST_ASSERT_TRUE(catalog.add(a.descriptor(), &a));
+  TEST_ASSERT_TRUE(catalog.add(b.descriptor(), &b));
+
+  static EffectManager<4, kLeds> mgr;
+  mgr.init(store, catalog, map, 0);
+  mgr.set_transition_ms(400);
+  mgr.set_frame_budget_us(10000);
+
+  // Measured costs: a = 8 ms, b = 8 ms. Together 16 ms > 10 ms: the fade is scaled to 400 * 10/16 = 250 ms.
+  mgr.note_render_us(8000);
+  mgr.note_render_us(8000);
+  Rgb out[kLeds] = {};
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{2}, 1000));  // b not measured yet: full fade
+  mgr.tick(1400, 16, Signals{});
+  mgr.render(out, kLeds);
+  TEST_ASSERT_FALSE(mgr.transitioning());
+  mgr.note_render_us(8000);
+  mgr.note_render_us(8000);
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{1}, 2000));
+  TEST_ASSERT_TRUE(mgr.transitioning());
+  TEST_ASSERT_EQUAL_UINT32(1, mgr.transition_stats().shortened);
+
+  mgr.tick(2249, 16, Signals{});
+  mgr.render(out, kLeds);
+  TEST_ASSERT_TRUE(mgr.transitioning());
+  mgr.tick(2250, 16, Signals{});
+  mgr.render(out, kLeds);
+  TEST_ASSERT_FALSE(mgr.transitioning());
+
+  // An over-budget frame mid-fade halves the remaining time.
+  mgr.set_frame_budget_us(0);
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{2}, 3000));
+  mgr.set_frame_budget_us(10000);
+  mgr.tick(3100, 16, Signals{});
+  mgr.render(out, kLeds);
+  mgr.note_render_us(15000);  // fade now ends at 100 + 300/2 = 250 ms
+  mgr.tick(3249, 16, Signals{});
+  mgr.render(out, kLeds);
+  TEST_ASSERT_TRUE(mgr.transitioning());
+  mgr.tick(3250, 16, Signals{});
+  mgr.render(out, kLeds);
+  TEST_ASSERT_FALSE(mgr.transitioning());
+
+  // Far over budget: not even kMinTransitionMs fits, so the switch is a hard cut.
+  mgr.set_frame_budget_us(1000);
+  const uint32_t stops = b.stop_calls;
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{1}, 4000));
+  TEST_ASSERT_FALSE(mgr.transitioning());
+  TEST_ASSERT_EQUAL_UINT32(stops + 1, b.stop_calls);
+  TEST_ASSERT_EQUAL_UINT32(1, mgr.transition_stats().hard_cuts);
+}
+
+void test_crossfade_manager_lends_effect_scratch_from_both_ends() {
+  NullSettingsStore store;
+  PixelsMap map;
+  SolidEffect a(EffectDescriptor{EffectId{1}, "a", "A", nullptr}, Rgb{100, 0, 0});
+  SolidEffect b(EffectDescriptor{EffectId{2}, "b", "B", nullptr}, Rgb{0, 100, 0});
+  SolidEffect c(EffectDescriptor{EffectId{3}, "c", "C", nullptr}, Rgb{0, 0, 100});
+  SolidEffect d(EffectDescriptor{EffectId{4}, "d", "D", nullptr}, Rgb{1, 1, 1});
+  a.scratch_need = 40;
+  b.scratch_need = 20;  // rounded up to 24
+  c.scratch_need = 48;
+  d.scratch_need = 72;  // larger than the whole arena
+  EffectCatalog<4> catalog;
+  TEST_ASSERT_TRUE(catalog.add(a.descriptor(), &a));
+  TEST_ASSERT_TRUE(catalog.add(b.descriptor(), &b));
+  TEST_ASSERT_TRUE(catalog.add(c.descriptor(), &c));
+  TEST_ASSERT_TRUE(catalog.add(d.descriptor(), &d));
+
+  static EffectManager<4, kLeds, 64> mgr;
+  TEST_ASSERT_EQUAL_UINT32(64, mgr.scratch_capacity());
+  mgr.init(store, catalog, map, 0);
+  mgr.set_transition_ms(400);
+  Rgb out[kLeds] = {};
+
+  // Alone, an effect gets the low end.
+  uint8_t* const base = a.scratch.data;
+  TEST_ASSERT_NOT_NULL(base);
+  TEST_ASSERT_EQUAL_UINT32(0, reinterpret_cast<uintptr_t>(base) % 8U);
+  TEST_ASSERT_EQUAL_UINT32(40, a.scratch.bytes);
+
+  // Crossfading in, b takes the high end while a still renders from the low end.
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{2}, 1000));
+  TEST_ASSERT_TRUE(mgr.transitioning());
+  TEST_ASSERT_TRUE(b.scratch.data == base + 40);
+  TEST_ASSERT_EQUAL_UINT32(24, b.scratch.bytes);
+  TEST_ASSERT_EQUAL_UINT32(64, mgr.scratch_peak_bytes());
+  mgr.tick(1400, 16, Signals{});
+  mgr.render(out, kLeds);
+  TEST_ASSERT_FALSE(mgr.transitioning());
+
+  // ...and the next incoming effect the end b does not hold.
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{1}, 2000));
+  TEST_ASSERT_TRUE(mgr.transitioning());
+  TEST_ASSERT_TRUE(a.scratch.data == base);
+  mgr.tick(2400, 16, Signals{});
+  mgr.render(out, kLeds);
+
+  // a and c do not fit at once: hard cut, and c reuses the bytes a just gave back.
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{3}, 3000));
+  TEST_ASSERT_FALSE(mgr.transitioning());
+  TEST_ASSERT_EQUAL_UINT32(1, mgr.transition_stats().hard_cuts);
+  TEST_ASSERT_EQUAL_UINT32(2, a.stop_calls);
+  TEST_ASSERT_TRUE(c.scratch.data == base);
+
+  // An effect that can never fit is refused; the active one keeps running.
+  TEST_ASSERT_FALSE(mgr.set_active(EffectId{4}, 4000));
+  TEST_ASSERT_EQUAL_UINT16(3, mgr.active_id().value);
+  TEST_ASSERT_EQUAL_UINT32(0, d.start_calls);
+  TEST_ASSERT_EQUAL_UINT32(64, mgr.scratch_peak_bytes());
+}
@@ -64,9 +64,20 @@ class DummyEffect final : public IEffectV2 {
     config_ = static_cast<const DummyConfig*>(config_bytes);
   }
 
+  bool needs_prepare() const override { return needs_prep; }
+
+  uint32_t next_change_ms(uint32_t now_ms) const override { return now_ms + static_hold_ms; }
+
+  void prepare(const EventContext& ctx) override {
+    (void)ctx;
+    prepare_calls++;
+    needs_prep = false;
+  }
+
   void start(const EventContext& ctx) override {
     start_calls++;
     last_start_ms = ctx.now_ms;
+    if (prepare_calls > 0 && !needs_prep) prepared_before_start = true;
   }
 
   void stop(const EventContext& ctx) override {
@@ -102,6 +113,10 @@ class DummyEffect final : public IEffectV2 {
   const DummyConfig* config() const { return config_; }
   size_t config_size() const { return config_size_; }
 
+  bool needs_prep = false;
+  uint32_t static_hold_ms = 0;
+  bool prepared_before_start = false;
+  uint32_t prepare_calls = 0;
   uint32_t bind_calls = 0;
   uint32_t start_calls = 0;
   uint32_t stop_calls = 0;
@@ -353,3 +368,158 @@ void test_effect_manager_v2_set_active_calls_stop_start_and_events_render_flow()
   TEST_ASSERT_EQUAL_UINT8(7, e2.last_render_brightness);
   TEST_ASSERT_TRUE(e2.last_render_has_bpm);
 }
+
+void test_effect_manager_v2_prepares_in_idle_time_before_activation() {
+  FakeSettingsStore store;
+  PixelsMap map;
+
+  static const ParamDescriptor kParams[] = {
+      {ParamId{kPidDotCount}, "dot_count", "Dot Count", ParamType::U8,
+       static_cast<uint16_t>(offsetof(DummyConfig, dot_count)), 1, 0, 20, 1, 9, 1},
+  };
+
+  DummyEffect e1(EffectDescriptor{EffectId{1}, "e1", "E1", nullptr}, kParams, 1);
+  DummyEffect e2(EffectDescriptor{EffectId{2}, "e2", "E2", nullptr}, kParams, 1);
+  DummyEffect e3(EffectDescriptor{EffectId{3}, "e3", "E3", nullptr}, kParams, 1);
+  e2.needs_prep = true;
+  e3.needs_prep = true;
+
+  EffectCatalog<4> catalog;
+  TEST_ASSERT_TRUE(catalog.add(e1.descriptor(), &e1));
+  TEST_ASSERT_TRUE(catalog.add(e2.descriptor(), &e2));
+  TEST_ASSERT_TRUE(catalog.add(e3.descriptor(), &e3));
+
+  EffectManager<4> mgr;
+  mgr.init(store, catalog, map, 100);
+  TEST_ASSERT_TRUE(mgr.prepare_pending());
+
+  // One effect per call.
+  TEST_ASSERT_EQUAL_UINT16(2, mgr.prepare_next(110).value);
+  TEST_ASSERT_EQUAL_UINT32(1, e2.prepare_calls);
+  TEST_ASSERT_EQUAL_UINT32(0, e3.prepare_calls);
+  TEST_ASSERT_EQUAL_UINT32(0, e2.start_calls);
+
+  // Activating an effect that is already warm does not prepare again.
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{2}, 120));
+  TEST_ASSERT_EQUAL_UINT32(1, e2.prepare_calls);
+
+  // A switch that beats the warm-up prepares before start().
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{3}, 130));
+  TEST_ASSERT_EQUAL_UINT32(1, e3.prepare_calls);
+  TEST_ASSERT_TRUE(e3.prepared_before_start);
+
+  TEST_ASSERT_FALSE(mgr.prepare_pending());
+  TEST_ASSERT_FALSE(mgr.prepare_next(140).valid());
+}
+
+void test_effect_manager_v2_records_first_frame_and_steady_cost() {
+  FakeSettingsStore store;
+  PixelsMap map;
+
+  DummyEffect e1(EffectDescriptor{EffectId{1}, "e1", "E1", nullptr}, nullptr, 0);
+  DummyEffect e2(EffectDescriptor{EffectId{2}, "e2", "E2", nullptr}, nullptr, 0);
+
+  EffectCatalog<4> catalog;
+  TEST_ASSERT_TRUE(catalog.add(e1.descriptor(), &e1));
+  TEST_ASSERT_TRUE(catalog.add(e2.descriptor(), &e2));
+
+  EffectManager<4> mgr;
+  mgr.init(store, catalog, map, 100);
+  mgr.note_render_us(900);  // first frame of e1
+  mgr.note_render_us(200);
+  mgr.note_render_us(300);
+
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{2}, 200));
+  mgr.note_prepare_us(EffectId{2}, 1500);
+  mgr.note_render_us(400);
+  mgr.note_render_us(100);
+
+  const chromance::core::EffectCostStats* c1 = mgr.cost_stats(EffectId{1});
+  TEST_ASSERT_NOT_NULL(c1);
+  TEST_ASSERT_EQUAL_UINT32(900, c1->first_frame_us);
+  TEST_ASSERT_EQUAL_UINT32(300, c1->max_frame_us);
+  TEST_ASSERT_EQUAL_UINT32(1, c1->activations);
+
+  const chromance::core::EffectCostStats* c2 = mgr.cost_stats(EffectId{2});
+  TEST_ASSERT_NOT_NULL(c2);
+  TEST_ASSERT_EQUAL_UINT32(1500, c2->prepare_us);
+  TEST_ASSERT_EQUAL_UINT32(400, c2->first_frame_us);
+  TEST_ASSERT_EQUAL_UINT32(100, c2->max_frame_us);
+  TEST_ASSERT_NULL(mgr.cost_stats(EffectId{9}));
+}
+
+void test_effect_manager_v2_skips_frames_until_next_change() {
+  FakeSettingsStore store;
+  PixelsMap map;
+
+  static const ParamDescriptor kParams[] = {
+      {ParamId{kPidDotCount}, "dot_count", "Dot Count", ParamType::U8,
+       static_cast<uint16_t>(offsetof(DummyConfig, dot_count)), 1, 0, 20, 1, 9, 1},
+  };
+  DummyEffect e1(EffectDescriptor{EffectId{1}, "e1", "E1", nullptr}, kParams, 1);
+  DummyEffect e2(EffectDescriptor{EffectId{2}, "e2", "E2", nullptr}, nullptr, 0);
+  e1.static_hold_ms = 500;
+
+  EffectCatalog<4> catalog;
+  TEST_ASSERT_TRUE(catalog.add(e1.descriptor(), &e1));
+  TEST_ASSERT_TRUE(catalog.add(e2.descriptor(), &e2));
+
+  EffectManager<4> mgr;
+  mgr.init(store, catalog, map, 0);
+  Rgb out[4] = {};
+
+  TEST_ASSERT_TRUE(mgr.frame_due(0));
+  mgr.render(out, 4);
+  TEST_ASSERT_FALSE(mgr.frame_due(499));
+  TEST_ASSERT_EQUAL_UINT32(500, mgr.next_change_ms());
+  TEST_ASSERT_TRUE(mgr.frame_due(500));
+
+  // Inputs that can change the frame make it due at once.
+  mgr.tick(100, 16, Signals{});
+  mgr.render(out, 4);
+  TEST_ASSERT_FALSE(mgr.frame_due(101));
+  EffectParams p;
+  p.brightness = 10;
+  mgr.set_global_params(p);
+  TEST_ASSERT_TRUE(mgr.frame_due(101));
+  mgr.render(out, 4);
+  mgr.set_global_params(p);  // unchanged
+  TEST_ASSERT_FALSE(mgr.frame_due(101));
+
+  ParamValue v;
+  v.type = ParamType::U8;
+  v.v.u8 = 3;
+  TEST_ASSERT_TRUE(mgr.set_param(EffectId{1}, ParamId{kPidDotCount}, v));
+  TEST_ASSERT_TRUE(mgr.frame_due(101));
+  mgr.render(out, 4);
+
+  InputEvent ev{Key::N, 102};
+  mgr.on_event(ev, 102);
+  TEST_ASSERT_TRUE(mgr.frame_due(102));
+  mgr.render(out, 4);
+
+  Signals sig;
+  sig.has_bpm = true;
+  sig.bpm = 120.0f;
+  mgr.tick(103, 1, sig);
+  TEST_ASSERT_TRUE(mgr.frame_due(103));
+  mgr.render(out, 4);
+  mgr.tick(104, 1, sig);
+  TEST_ASSERT_FALSE(mgr.frame_due(104));
+
+  mgr.invalidate_frame();
+  TEST_ASSERT_TRUE(mgr.frame_due(104));
+
+  // Holds are capped at max_idle_ms; 0 renders every frame. Effects without a hint are always due.
+  mgr.set_max_idle_ms(200);
+  mgr.render(out, 4);
+  TEST_ASSERT_EQUAL_UINT32(304, mgr.next_change_ms());
+  mgr.set_max_idle_ms(0);
+  mgr.render(out, 4);
+  TEST_ASSERT_TRUE(mgr.frame_due(104));
+  mgr.set_max_idle_ms(1000);
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{2}, 200));
+  mgr.tick(200, 1, sig);
+  mgr.render(out, 4);
+  TEST_ASSERT_TRUE(mgr.frame_due(200));
+}
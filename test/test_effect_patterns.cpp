@@ -4,6 +4,7 @@
 
 #include <stdio.h>
 
+#include "core/effects/effect_scratch.h"
 #include "core/effects/pattern_coord_color.h"
 #include "core/effects/pattern_breathing_mode.h"
 #include "core/effects/pattern_hrv_hexagon.h"
@@ -51,6 +52,12 @@ Rgb render_single(const chromance::core::IEffect& effect,
   return out[idx];
 }
 
+// Effects driven standalone get the scratch EffectManager would lend them.
+chromance::core::EffectScratch test_scratch() {
+  static chromance::core::ScratchBuffer<chromance::core::kDefaultEffectScratchBytes> buf;
+  return buf.scratch();
+}
+
 }  // namespace
 
 void test_index_walk_effect_lights_one_pixel_and_wraps() {
@@ -127,6 +134,7 @@ void test_index_walk_effect_topology_scan_orders_leds_within_segments_by_axis()
   std::vector<Rgb> out(led_count);
 
   IndexWalkEffect e(1);
+  e.bind_scratch(test_scratch());
   e.reset(0);
   e.cycle_scan_mode(0);  // Index -> LTR/UTD topology scan
 
@@ -430,6 +438,35 @@ void test_xy_scan_effect_uses_scan_order() {
   TEST_ASSERT_EQUAL_UINT8(200, out[2].r);
 }
 
+void test_xy_scan_effect_sorts_its_own_order_into_scratch() {
+  XyScanEffect e(10);
+  PixelsMap map;
+  const size_t n = map.led_count();
+  std::vector<Rgb> out(n, Rgb{1, 1, 1});
+  EffectFrame frame;
+  frame.params.brightness = 200;
+
+  // Unbound: nothing to scan with, so the frame is black.
+  TEST_ASSERT_EQUAL_UINT32(chromance::core::scratch_block_bytes<uint16_t>(n), e.scratch_bytes());
+  e.reset(0);
+  e.render(frame, map, out.data(), n);
+  for (size_t i = 0; i < n; ++i) TEST_ASSERT_EQUAL_UINT8(0, out[i].r);
+
+  std::vector<uint16_t> expected(n);
+  map.build_scan_order(expected.data(), n);
+  e.bind_scratch(test_scratch());
+  e.reset(0);
+  for (uint32_t step = 0; step < 3; ++step) {
+    frame.now_ms = step * 10U;
+    e.render(frame, map, out.data(), n);
+    TEST_ASSERT_EQUAL_UINT8(200, out[expected[step]].r);
+  }
+
+  // An external order needs no scratch.
+  const uint16_t order[1] = {0};
+  TEST_ASSERT_EQUAL_UINT32(0, XyScanEffect(order, 1, 10).scratch_bytes());
+}
+
 void test_coord_color_effect_matches_expected_formula_and_scales_brightness() {
   CoordColorEffect e;
   PixelsMap map;
@@ -624,36 +661,25 @@ void test_strip_segment_stepper_lights_one_segment_per_strip_and_blanks_short_st
   e.reset(0);
   TEST_ASSERT_EQUAL_UINT8(1, e.segment_number());
 
-  frame.now_ms = 0;
-  e.render(frame, map, out.data(), out.size());
-
-  uint16_t lit_per_strip[4] = {0, 0, 0, 0};
+  // Every strip lights segment k while it has one, and stays black past its end (on the full panel strip2
+  // has only 6 segments and only strip1 reaches k=12).
   const uint8_t* strips = chromance::core::MappingTables::global_to_strip();
-  for (size_t i = 0; i < out.size(); ++i) {
-    if (!(out[i].r || out[i].g || out[i].b)) continue;
-    const uint8_t s = strips[i];
-    if (s < 4) lit_per_strip[s]++;
-  }
-  TEST_ASSERT_EQUAL_UINT16(14, lit_per_strip[0]);
-  TEST_ASSERT_EQUAL_UINT16(14, lit_per_strip[1]);
-  TEST_ASSERT_EQUAL_UINT16(14, lit_per_strip[2]);
-  TEST_ASSERT_EQUAL_UINT16(14, lit_per_strip[3]);
-
-  // Advance to k=12; strip2 has only 6 segments in the full mapping, so it should go black.
-  for (uint8_t i = 0; i < 11; ++i) e.next(0);
-  TEST_ASSERT_EQUAL_UINT8(12, e.segment_number());
-  e.render(frame, map, out.data(), out.size());
+  for (uint8_t k = 1; k <= chromance::core::kMaxStripSegments; ++k) {
+    TEST_ASSERT_EQUAL_UINT8(k, e.segment_number());
+    e.render(frame, map, out.data(), out.size());
 
-  for (uint8_t i = 0; i < 4; ++i) lit_per_strip[i] = 0;
-  for (size_t i = 0; i < out.size(); ++i) {
-    if (!(out[i].r || out[i].g || out[i].b)) continue;
-    const uint8_t s = strips[i];
-    if (s < 4) lit_per_strip[s]++;
+    uint16_t lit_per_strip[chromance::core::kStripCount] = {};
+    for (size_t i = 0; i < out.size(); ++i) {
+      if (!(out[i].r || out[i].g || out[i].b)) continue;
+      lit_per_strip[strips[i]]++;
+    }
+    for (uint8_t s = 0; s < chromance::core::kStripCount; ++s) {
+      const uint16_t expected = k <= chromance::core::strip_config(s).segment_count ? 14 : 0;
+      TEST_ASSERT_EQUAL_UINT16(expected, lit_per_strip[s]);
+    }
+    e.next(0);
   }
-  TEST_ASSERT_EQUAL_UINT16(0, lit_per_strip[2]);
-  TEST_ASSERT_EQUAL_UINT16(0, lit_per_strip[0]);   // strip0 has 11 segments
-  TEST_ASSERT_EQUAL_UINT16(14, lit_per_strip[1]);  // strip1 has 12 segments
-  TEST_ASSERT_EQUAL_UINT16(0, lit_per_strip[3]);   // strip3 has 11 segments
+  TEST_ASSERT_EQUAL_UINT8(1, e.segment_number());
 }
 
 void test_strip_segment_stepper_auto_advance_can_be_disabled() {
@@ -681,6 +707,7 @@ void test_strip_segment_stepper_auto_advance_can_be_disabled() {
 
 void test_breathing_effect_has_expected_phases() {
   BreathingEffect e;
+  e.bind_scratch(test_scratch());
   PixelsMap map;
   std::vector<Rgb> out(map.led_count());
   EffectFrame frame;
@@ -743,6 +770,7 @@ void test_breathing_effect_has_expected_phases() {
 
 void test_breathing_effect_manual_phase_selection() {
   BreathingEffect e;
+  e.bind_scratch(test_scratch());
   PixelsMap map;
   std::vector<Rgb> out(map.led_count());
   EffectFrame frame;
@@ -790,7 +818,7 @@ static void bfs_dist(uint8_t start,
                      uint8_t scount,
                      uint8_t* out) {
   for (uint8_t i = 0; i < vcount; ++i) out[i] = 0xFF;
-  uint8_t q[32];
+  uint8_t q[chromance::core::MappingTables::vertex_count()];
   uint8_t qh = 0, qt = 0;
   out[start] = 0;
   q[qt++] = start;
@@ -814,6 +842,7 @@ static void bfs_dist(uint8_t start,
 
 void test_breathing_inhale_paths_are_monotone_and_segment_simple() {
   BreathingEffect e;
+  e.bind_scratch(test_scratch());
   PixelsMap map;
   std::vector<Rgb> out(map.led_count());
   EffectFrame frame;
@@ -831,14 +860,14 @@ void test_breathing_inhale_paths_are_monotone_and_segment_simple() {
   const uint8_t* svb = chromance::core::MappingTables::seg_vertex_b();
 
   // Determine present segments in this mapping build.
-  bool present[41] = {};
+  bool present[chromance::core::MappingTables::segment_count() + 1] = {};
   const uint8_t* gseg = chromance::core::MappingTables::global_to_seg();
   for (uint16_t i = 0; i < chromance::core::MappingTables::led_count(); ++i) {
     const uint8_t s = gseg[i];
     if (s >= 1 && s <= scount) present[s] = true;
   }
 
-  uint8_t dist[32] = {};
+  uint8_t dist[chromance::core::MappingTables::vertex_count()] = {};
   bfs_dist(center, sva, svb, present, vcount, scount, dist);
 
   // Starts are distinct.
@@ -858,7 +887,7 @@ void test_breathing_inhale_paths_are_monotone_and_segment_simple() {
     const uint8_t steps = e.dot_step_count(i);
     TEST_ASSERT_TRUE(steps >= 1);
 
-    bool used_seg[41] = {};
+    bool used_seg[chromance::core::MappingTables::segment_count() + 1] = {};
     uint8_t cur = e.dot_start_vertex(i);
     uint8_t prev_d = dist[cur];
     TEST_ASSERT_TRUE(prev_d != 0xFF);
@@ -888,6 +917,7 @@ void test_breathing_inhale_paths_are_monotone_and_segment_simple() {
 
 void test_breathing_lane_step_only_affects_manual_inhale() {
   BreathingEffect e;
+  e.bind_scratch(test_scratch());
   PixelsMap map;
   std::vector<Rgb> out(map.led_count());
   EffectFrame frame;
@@ -927,14 +957,15 @@ void test_strip_segment_stepper_prev_wraps() {
   EffectFrame frame;
   frame.params.brightness = 255;
 
+  const uint8_t longest = chromance::core::kMaxStripSegments;  // 12 on the full panel
   e.reset(0);
   TEST_ASSERT_EQUAL_UINT8(1, e.segment_number());
   e.prev(0);
-  TEST_ASSERT_EQUAL_UINT8(12, e.segment_number());
+  TEST_ASSERT_EQUAL_UINT8(longest, e.segment_number());
   e.prev(0);
-  TEST_ASSERT_EQUAL_UINT8(11, e.segment_number());
+  TEST_ASSERT_EQUAL_UINT8(longest - 1, e.segment_number());
   e.next(0);
-  TEST_ASSERT_EQUAL_UINT8(12, e.segment_number());
+  TEST_ASSERT_EQUAL_UINT8(longest, e.segment_number());
   e.next(0);
   TEST_ASSERT_EQUAL_UINT8(1, e.segment_number());
 
@@ -971,3 +1002,33 @@ void test_hrv_hexagon_manual_next_prev_and_auto_reset() {
   e.render(frame, map, out.data(), out.size());
   TEST_ASSERT_NOT_EQUAL_UINT8(ha, e.current_hex_index());
 }
+
+void test_static_effects_report_next_change() {
+  PixelsMap map;
+  std::vector<Rgb> out(map.led_count());
+  std::vector<Rgb> again(map.led_count());
+  EffectFrame frame;
+  frame.params.brightness = 200;
+
+  // Stepper: next change at the next step; none while auto-advance is off.
+  StripSegmentStepperEffect stepper(1000);
+  stepper.reset(0);
+  frame.now_ms = 1500;
+  stepper.render(frame, map, out.data(), out.size());
+  TEST_ASSERT_EQUAL_UINT32(2000, stepper.next_change_ms(1500));
+  stepper.set_auto_advance_enabled(false, 1500);
+  TEST_ASSERT_TRUE(stepper.next_change_ms(1500) - 1500 >= 0x10000000u);
+
+  // HRV hexagon: fading frames change every frame; the hold is static (dither included) until it ends.
+  HrvHexagonEffect hrv;
+  hrv.reset(0);
+  frame.now_ms = 2000;
+  hrv.render(frame, map, out.data(), out.size());
+  TEST_ASSERT_EQUAL_UINT32(2000, hrv.next_change_ms(2000));
+  frame.now_ms = 4500;
+  hrv.render(frame, map, out.data(), out.size());
+  TEST_ASSERT_EQUAL_UINT32(6000, hrv.next_change_ms(4500));
+  frame.now_ms = 5900;
+  hrv.render(frame, map, again.data(), again.size());
+  TEST_ASSERT_EQUAL_MEMORY(out.data(), again.data(), out.size() * sizeof(Rgb));
+}
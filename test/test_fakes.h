@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/effects/effect_v2.h"
+#include "core/settings/effect_config_store.h"
+#include "core/types.h"
+
+namespace chromance {
+namespace testing {
+
+// Settings store for tests that need one but check nothing persisted: reads find nothing, writes succeed.
+class NullSettingsStore final : public core::ISettingsStore {
+ public:
+  bool read_blob(const char*, void*, size_t) const override { return false; }
+  bool write_blob(const char*, const void*, size_t) override { return true; }
+};
+
+// Fills every pixel with one colour and counts lifecycle calls. Set scratch_need before activation to request
+// scratch; start() keeps what the manager lent.
+class SolidEffect final : public core::IEffectV2 {
+ public:
+  SolidEffect(core::EffectDescriptor d, core::Rgb c) : d_(d), c_(c) {}
+
+  const core::EffectDescriptor& descriptor() const override { return d_; }
+  const core::EffectConfigSchema* schema() const override { return nullptr; }
+  size_t scratch_bytes() const override { return scratch_need; }
+  void start(const core::EventContext& ctx) override {
+    ++start_calls;
+    scratch = ctx.scratch;
+  }
+  void stop(const core::EventContext&) override { ++stop_calls; }
+  void reset_runtime(const core::EventContext&) override {}
+  void render(const core::RenderContext&, core::Rgb* out, size_t n) override {
+    ++render_calls;
+    for (size_t i = 0; i < n; ++i) out[i] = c_;
+  }
+
+  uint32_t start_calls = 0;
+  uint32_t stop_calls = 0;
+  uint32_t render_calls = 0;
+  size_t scratch_need = 0;
+  core::EffectScratch scratch;
+
+ private:
+  core::EffectDescriptor d_{};
+  core::Rgb c_{};
+};
+
+}  // namespace testing
+}  // namespace chromance
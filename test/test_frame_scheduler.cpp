@@ -60,3 +60,95 @@ void test_frame_scheduler_60fps_deterministic_rounding() {
   TEST_ASSERT_EQUAL_UINT32(16, s.dt_ms());
 }
 
+
+void test_frame_scheduler_idle_hold_skips_frames_until_deadline_or_wake() {
+  FrameScheduler s(50);  // 20ms
+  s.reset(0);
+  TEST_ASSERT_TRUE(s.should_render(0));
+
+  // Held until 70: boundaries at 20/40/60 are skipped, the first one at/after 70 renders with the full dt.
+  s.hold_until(70);
+  TEST_ASSERT_EQUAL_UINT32(70, s.next_frame_ms());
+  TEST_ASSERT_FALSE(s.should_render(20));
+  TEST_ASSERT_FALSE(s.should_render(40));
+  TEST_ASSERT_FALSE(s.should_render(69));
+  TEST_ASSERT_EQUAL_UINT32(3, s.held_frames());
+  TEST_ASSERT_FALSE(s.should_render(75));  // between boundaries
+  TEST_ASSERT_TRUE(s.should_render(80));
+  TEST_ASSERT_EQUAL_UINT32(80, s.dt_ms());
+  TEST_ASSERT_FALSE(s.holding());
+
+  // wake() ends a hold early; the next boundary renders.
+  s.hold_until(1000);
+  TEST_ASSERT_FALSE(s.should_render(100));
+  s.wake();
+  TEST_ASSERT_EQUAL_UINT32(120, s.next_frame_ms());
+  TEST_ASSERT_TRUE(s.should_render(120));
+
+  // Uncapped: a hold still gates rendering.
+  FrameScheduler u(0);
+  u.reset(0xFFFFFFF0u);
+  u.hold_until(0xFFFFFFF0u + 30u);  // across the millis() wrap
+  TEST_ASSERT_FALSE(u.should_render(0xFFFFFFF0u + 29u));
+  TEST_ASSERT_TRUE(u.should_render(0xFFFFFFF0u + 30u));
+}
+
+void test_frame_scheduler_reports_occupancy_and_rendered_fps() {
+  FrameScheduler s(50);
+  s.reset(0);
+  TEST_ASSERT_EQUAL_UINT16(0, s.occupancy_permille());
+
+  // 50 frames of 6 ms work over one second: 30% busy.
+  for (uint32_t t = 0; t < 1000; t += 20) {
+    TEST_ASSERT_TRUE(s.should_render(t));
+    s.note_work_us(6000);
+  }
+  TEST_ASSERT_EQUAL_UINT16(0, s.rendered_fps());  // window not closed yet
+  (void)s.should_render(1000);
+  TEST_ASSERT_EQUAL_UINT16(300, s.occupancy_permille());
+  TEST_ASSERT_EQUAL_UINT16(50, s.rendered_fps());
+
+  // Held frames do no work and do not count.
+  s.hold_until(3000);
+  for (uint32_t t = 1000; t <= 2000; t += 20) {
+    (void)s.should_render(t);
+  }
+  TEST_ASSERT_EQUAL_UINT16(0, s.occupancy_permille());
+  TEST_ASSERT_EQUAL_UINT16(0, s.rendered_fps());
+}
+
+void test_frame_scheduler_phase_lock_puts_boundaries_on_shared_grid() {
+  // Two nodes started at different times on the same clock render on the same 60 fps boundaries.
+  FrameScheduler a(60);
+  FrameScheduler b(60);
+  a.set_phase_locked(true);
+  b.set_phase_locked(true);
+  a.reset(1000);
+  for (uint32_t t = 1000; t < 1234; ++t) {
+    (void)a.should_render(t);
+  }
+  b.reset(1234);
+  uint32_t common = 0;
+  for (uint32_t t = 1234; t < 3000; ++t) {
+    const bool ra = a.should_render(t);
+    const bool rb = b.should_render(t);
+    TEST_ASSERT_EQUAL(ra, rb);
+    if (ra) {
+      TEST_ASSERT_EQUAL_UINT32(t, (((t * 60U) + 999U) / 1000U) * 1000U / 60U);  // t = floor(k * 1000 / 60)
+      ++common;
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(105, common);  // k = 75 .. 179
+
+  // A frame rate change snaps to the new grid from the next boundary on.
+  a.set_target_fps(50);
+  TEST_ASSERT_EQUAL_UINT32(3000, a.next_frame_ms());
+  TEST_ASSERT_TRUE(a.should_render(3000));
+  TEST_ASSERT_FALSE(a.should_render(3019));
+  TEST_ASSERT_TRUE(a.should_render(3020));
+
+  // Unlocked schedulers keep counting from reset().
+  FrameScheduler c(60);
+  c.reset(1234);
+  TEST_ASSERT_TRUE(c.should_render(1234));
+}
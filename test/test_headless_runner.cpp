@@ -0,0 +1,180 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include <unity.h>
+
+#include "core/effects/effect_catalog.h"
+#include "core/effects/effect_manager.h"
+#include "core/effects/legacy_effect_adapter.h"
+#include "core/effects/pattern_breathing_mode.h"
+#include "core/effects/pattern_breathing_mode_v2.h"
+#include "core/effects/pattern_coord_color.h"
+#include "core/effects/pattern_rainbow_pulse.h"
+#include "core/mapping/mapping_tables.h"
+#include "core/mapping/pixels_map.h"
+#include "core/sim/headless_runner.h"
+
+using chromance::core::EffectDescriptor;
+using chromance::core::EffectId;
+using chromance::core::HeadlessFrame;
+using chromance::core::HeadlessRunner;
+using chromance::core::Key;
+using chromance::core::MemorySettingsStore;
+using chromance::core::Rgb;
+using chromance::core::ScriptEvent;
+using chromance::core::ScriptLine;
+using chromance::core::parse_script_line;
+
+namespace {
+
+constexpr size_t kLeds = chromance::core::MappingTables::led_count();
+
+constexpr EffectDescriptor kCoordDesc{EffectId{3}, "coord_color", "Coord_Color_Test", nullptr};
+constexpr EffectDescriptor kRainbowDesc{EffectId{4}, "rainbow_pulse", "Rainbow_Pulse", nullptr};
+constexpr EffectDescriptor kBreathingDesc{EffectId{7}, "breathing", "Breathing", nullptr};
+
+// The runtime's effect wiring for three effects: static, animated, and one with a param schema.
+struct Rig {
+  chromance::core::PixelsMap map;
+  chromance::core::CoordColorEffect coord;
+  chromance::core::RainbowPulseEffect rainbow{700, 2000, 700};
+  chromance::core::BreathingEffect breathing;
+  chromance::core::LegacyEffectAdapter coord_adapter{kCoordDesc, &coord};
+  chromance::core::LegacyEffectAdapter rainbow_adapter{kRainbowDesc, &rainbow};
+  chromance::core::BreathingEffectV2 breathing_effect{kBreathingDesc, &breathing};
+  chromance::core::EffectCatalog<4> catalog;
+  chromance::core::EffectManager<4> manager;
+  MemorySettingsStore<8> store;
+  Rgb rgb[kLeds];
+
+  explicit Rig(uint16_t first_effect) {
+    (void)catalog.add(coord_adapter.descriptor(), &coord_adapter);
+    (void)catalog.add(rainbow_adapter.descriptor(), &rainbow_adapter);
+    (void)catalog.add(breathing_effect.descriptor(), &breathing_effect);
+    manager.init(store, catalog, map, 0, EffectId{first_effect});
+    manager.set_transition_ms(400);
+  }
+};
+
+std::vector<HeadlessFrame> run(const ScriptEvent* script, size_t count, uint32_t frames, uint16_t first_effect) {
+  std::unique_ptr<Rig> rig(new Rig(first_effect));
+  HeadlessRunner<chromance::core::EffectManager<4>> runner(rig->manager, 50);
+  runner.set_script(script, count);
+  std::vector<HeadlessFrame> out;
+  for (uint32_t f = 0; f < frames; ++f) {
+    out.push_back(runner.step(rig->rgb, kLeds));
+  }
+  return out;
+}
+
+ScriptEvent event(const char* line) {
+  ScriptEvent ev;
+  TEST_ASSERT_EQUAL(static_cast<int>(ScriptLine::kEvent), static_cast<int>(parse_script_line(line, &ev)));
+  return ev;
+}
+
+}  // namespace
+
+void test_headless_script_parser_accepts_runtime_inputs() {
+  ScriptEvent ev;
+  TEST_ASSERT_EQUAL(static_cast<int>(ScriptLine::kBlank), static_cast<int>(parse_script_line("   # intro", &ev)));
+  TEST_ASSERT_EQUAL(static_cast<int>(ScriptLine::kBlank), static_cast<int>(parse_script_line("", &ev)));
+
+  TEST_ASSERT_EQUAL(static_cast<int>(ScriptLine::kEvent), static_cast<int>(parse_script_line("1500 key N", &ev)));
+  TEST_ASSERT_EQUAL_UINT32(1500, ev.at_ms);
+  TEST_ASSERT_TRUE(ev.type == ScriptEvent::Type::kKey);
+  TEST_ASSERT_TRUE(ev.key == Key::ShiftN);
+  TEST_ASSERT_EQUAL(static_cast<int>(ScriptLine::kEvent), static_cast<int>(parse_script_line("0 key esc", &ev)));
+  TEST_ASSERT_TRUE(ev.key == Key::Esc);
+
+  TEST_ASSERT_EQUAL(static_cast<int>(ScriptLine::kEvent),
+                    static_cast<int>(parse_script_line("\t20 param 7 3 -12  # dots", &ev)));
+  TEST_ASSERT_TRUE(ev.type == ScriptEvent::Type::kParam);
+  TEST_ASSERT_EQUAL_UINT16(7, ev.effect_id);
+  TEST_ASSERT_EQUAL_UINT16(3, ev.param_id);
+  TEST_ASSERT_EQUAL_INT32(-12, ev.value);
+
+  TEST_ASSERT_EQUAL_INT32(40, event("5 brightness 40").value);
+  TEST_ASSERT_TRUE(event("9 activate 4").type == ScriptEvent::Type::kActivate);
+  TEST_ASSERT_TRUE(event("9 restart").type == ScriptEvent::Type::kRestart);
+
+  const char* bad[] = {"key N", "10 key x", "10 activate 0", "10 brightness 256", "10 param 7 3",
+                       "10 jump 4", "10 activate 4 extra", "-5 restart", "10 param 7 3 99999999999"};
+  for (const char* line : bad) {
+    TEST_ASSERT_EQUAL(static_cast<int>(ScriptLine::kError), static_cast<int>(parse_script_line(line, &ev)));
+  }
+}
+
+void test_memory_settings_store_keeps_exact_size_blobs() {
+  MemorySettingsStore<2, 8> store;
+  const uint8_t a[4] = {1, 2, 3, 4};
+  uint8_t out[4] = {};
+  TEST_ASSERT_FALSE(store.read_blob("aeid", out, sizeof(out)));
+  TEST_ASSERT_TRUE(store.write_blob("aeid", a, sizeof(a)));
+  TEST_ASSERT_FALSE(store.read_blob("aeid", out, 2));  // size mismatch, like NVS
+  TEST_ASSERT_TRUE(store.read_blob("aeid", out, sizeof(out)));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(a, out, 4);
+
+  uint8_t big[9] = {};
+  TEST_ASSERT_FALSE(store.write_blob("e0004", big, sizeof(big)));
+  TEST_ASSERT_FALSE(store.write_blob("a-key-that-is-too-long", a, sizeof(a)));
+  TEST_ASSERT_TRUE(store.write_blob("e0004", a, 2));
+  TEST_ASSERT_FALSE(store.write_blob("e0005", a, 2));  // full
+  TEST_ASSERT_EQUAL_UINT32(2, store.key_count());
+  TEST_ASSERT_EQUAL_UINT32(2, store.writes());
+}
+
+void test_headless_runner_replays_script_deterministically() {
+  const ScriptEvent script[] = {event("500 activate 7"), event("510 activate 99"), event("1500 param 7 3 20"),
+                                 event("2000 brightness 32")};
+
+  const std::vector<HeadlessFrame> a = run(script, 4, 150, 4);
+  const std::vector<HeadlessFrame> b = run(script, 4, 150, 4);
+  TEST_ASSERT_EQUAL_UINT32(150, a.size());
+  for (size_t f = 0; f < a.size(); ++f) {
+    TEST_ASSERT_EQUAL_UINT32(f * 20U, a[f].now_ms);
+    TEST_ASSERT_EQUAL_HEX32(a[f].hash, b[f].hash);
+    TEST_ASSERT_EQUAL_UINT16(a[f].effect_id, b[f].effect_id);
+  }
+  TEST_ASSERT_EQUAL_UINT16(4, a[24].effect_id);
+  TEST_ASSERT_EQUAL_UINT16(7, a[25].effect_id);  // first frame at or after 500 ms
+  TEST_ASSERT_EQUAL_UINT16(7, a[26].effect_id);  // unknown effect 99 rejected
+  TEST_ASSERT_TRUE(a[99].hash != a[100].hash);   // brightness drop at 2000 ms
+
+  // Dropping the trailing events changes nothing before their time, and the param event does change output.
+  const std::vector<HeadlessFrame> c = run(script, 3, 100, 4);
+  const std::vector<HeadlessFrame> d = run(script, 2, 100, 4);
+  bool param_changed_output = false;
+  for (size_t f = 0; f < 100; ++f) {
+    TEST_ASSERT_EQUAL_HEX32(a[f].hash, c[f].hash);
+    if (f < 75) TEST_ASSERT_EQUAL_HEX32(a[f].hash, d[f].hash);
+    param_changed_output = param_changed_output || a[f].hash != d[f].hash;
+  }
+  TEST_ASSERT_TRUE(param_changed_output);
+}
+
+void test_headless_runner_counts_held_frames_and_events() {
+  std::unique_ptr<Rig> rig(new Rig(3));
+  rig->manager.set_max_idle_ms(1000);
+  HeadlessRunner<chromance::core::EffectManager<4>> runner(rig->manager, 50, 10000);
+  const ScriptEvent script[] = {event("10500 key n"), event("10600 activate 42")};
+  runner.set_script(script, 2);
+
+  uint32_t first_hash = 0;
+  for (uint32_t f = 0; f < 100; ++f) {
+    const HeadlessFrame fr = runner.step(rig->rgb, kLeds);
+    if (f == 0) first_hash = fr.hash;
+    TEST_ASSERT_EQUAL_HEX32(first_hash, fr.hash);  // static pattern
+  }
+  const chromance::core::HeadlessStats& s = runner.stats();
+  TEST_ASSERT_EQUAL_UINT32(100, s.frames);
+  TEST_ASSERT_EQUAL_UINT32(s.frames, s.rendered + s.held);
+  // Frame 0, the key event, and the max-idle redraws at 1 s intervals.
+  TEST_ASSERT_TRUE(s.rendered >= 3 && s.rendered <= 5);
+  TEST_ASSERT_EQUAL_UINT32(2, s.events);
+  TEST_ASSERT_EQUAL_UINT32(1, s.rejected_events);
+  TEST_ASSERT_EQUAL_UINT32(11980, runner.now_ms());
+}
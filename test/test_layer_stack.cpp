@@ -0,0 +1,178 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include "core/effects/blend.h"
+#include "core/effects/effect_manager.h"
+#include "core/effects/layer_stack.h"
+#include "test_fakes.h"
+
+using chromance::core::BlendMode;
+using chromance::core::EffectCatalog;
+using chromance::core::EffectDescriptor;
+using chromance::core::EffectId;
+using chromance::core::EffectManager;
+using chromance::core::EventContext;
+using chromance::core::LayerStackEffect;
+using chromance::core::PixelsMap;
+using chromance::core::RenderContext;
+using chromance::core::Rgb;
+using chromance::testing::NullSettingsStore;
+using chromance::testing::SolidEffect;
+
+namespace {
+
+constexpr size_t kLeds = 7;  // odd count reaches the blend and scale kernels' scalar tails
+
+uint8_t reference(BlendMode mode, uint8_t d, uint8_t s, uint8_t opacity) {
+  int v = s;
+  switch (mode) {
+    case BlendMode::kAdd:
+      v = d + s > 255 ? 255 : d + s;
+      break;
+    case BlendMode::kScreen:
+      v = 255 - static_cast<int>((255 - d) * (255 - s) / 255.0 + 0.5);
+      break;
+    case BlendMode::kMax:
+      v = d > s ? d : s;
+      break;
+    case BlendMode::kMultiply:
+      v = static_cast<int>(d * s / 255.0 + 0.5);
+      break;
+    case BlendMode::kAlpha:
+      break;
+  }
+  return chromance::core::lerp_u8(d, static_cast<uint8_t>(v), chromance::core::opacity_to_t256(opacity));
+}
+
+}  // namespace
+
+void test_layer_blend_kernels_match_scalar_reference() {
+  const uint8_t samples[] = {0, 1, 2, 63, 64, 127, 128, 129, 200, 254, 255};
+  constexpr size_t kN = sizeof(samples) * sizeof(samples) / 3;
+  Rgb dst[kN + 1];
+  Rgb src[kN + 1];
+  const BlendMode modes[] = {BlendMode::kAdd, BlendMode::kScreen, BlendMode::kMax, BlendMode::kAlpha,
+                             BlendMode::kMultiply};
+  const uint8_t opacities[] = {255, 128, 1};
+
+  for (BlendMode mode : modes) {
+    for (uint8_t opacity : opacities) {
+      uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+      uint8_t* s = reinterpret_cast<uint8_t*>(src);
+      size_t k = 0;
+      for (uint8_t x : samples) {
+        for (uint8_t y : samples) {
+          d[k] = x;
+          s[k] = y;
+          ++k;
+        }
+      }
+      uint8_t before[sizeof(dst)];
+      memcpy(before, dst, sizeof(dst));
+      chromance::core::blend_layer(dst, src, kN, mode, opacity);
+      for (size_t i = 0; i < kN * 3; ++i) {
+        TEST_ASSERT_EQUAL_UINT8(reference(mode, before[i], s[i], opacity), d[i]);
+      }
+    }
+  }
+
+  // Opacity 0 is a no-op; scale_frame(255) is identity and scale_frame(0) is black.
+  Rgb px[kLeds];
+  for (size_t i = 0; i < kLeds; ++i) px[i] = Rgb{static_cast<uint8_t>(i * 30U), 255, 7};
+  Rgb copy[kLeds];
+  memcpy(copy, px, sizeof(px));
+  chromance::core::blend_layer(px, src, kLeds, BlendMode::kAdd, 0);
+  TEST_ASSERT_EQUAL_MEMORY(copy, px, sizeof(px));
+  chromance::core::scale_frame(px, kLeds, 255);
+  TEST_ASSERT_EQUAL_MEMORY(copy, px, sizeof(px));
+  chromance::core::scale_frame(px, kLeds, 128);
+  TEST_ASSERT_EQUAL_UINT8(128, px[0].g);
+  chromance::core::scale_frame(px, kLeds, 0);
+  TEST_ASSERT_EQUAL_UINT8(0, px[kLeds - 1].g);
+}
+
+void test_layer_stack_composites_layers_in_order() {
+  PixelsMap map;
+  SolidEffect base(EffectDescriptor{EffectId{10}, "base", "Base", nullptr}, Rgb{100, 0, 40});
+  SolidEffect mid(EffectDescriptor{EffectId{11}, "mid", "Mid", nullptr}, Rgb{200, 50, 10});
+  SolidEffect top(EffectDescriptor{EffectId{12}, "top", "Top", nullptr}, Rgb{0, 0, 255});
+
+  LayerStackEffect<kLeds> stack(EffectDescriptor{EffectId{1}, "stack", "Stack", nullptr});
+  TEST_ASSERT_NULL(stack.schema());
+  TEST_ASSERT_TRUE(stack.add_layer(&base, BlendMode::kAlpha, 255));
+  TEST_ASSERT_TRUE(stack.add_layer(&mid, BlendMode::kAdd, 255));
+  TEST_ASSERT_TRUE(stack.add_layer(&top, BlendMode::kMax, 255));
+  TEST_ASSERT_FALSE(stack.add_layer(&top, BlendMode::kMax, 255));
+
+  TEST_ASSERT_EQUAL_UINT8(3, stack.layer_count());
+  TEST_ASSERT_EQUAL_UINT8(5, stack.schema()->param_count);
+  TEST_ASSERT_FALSE(stack.layer_at(0)->mode_param.valid());
+  TEST_ASSERT_EQUAL_UINT16(4, stack.layer_at(1)->mode_param.value);
+  TEST_ASSERT_EQUAL_UINT16(5, stack.layer_at(2)->opacity_param.value);
+  TEST_ASSERT_EQUAL_STRING("mid", stack.layer_at(1)->effect->slug);
+  TEST_ASSERT_NULL(stack.layer_at(3));
+
+  // Scratch: the blend buffer (7 Rgb, rounded to 24 bytes), then each layer's share in order.
+  mid.scratch_need = 5;
+  top.scratch_need = 16;
+  TEST_ASSERT_EQUAL_UINT32(24 + 8 + 16, stack.scratch_bytes());
+  static chromance::core::ScratchBuffer<48> buf;
+  EventContext ectx;
+  ectx.map = &map;
+  ectx.scratch = buf.scratch();
+  stack.start(ectx);
+  TEST_ASSERT_EQUAL_UINT32(1, top.start_calls);
+  TEST_ASSERT_EQUAL_UINT32(0, base.scratch.bytes);
+  TEST_ASSERT_TRUE(mid.scratch.data == buf.storage + 24);
+  TEST_ASSERT_EQUAL_UINT32(5, mid.scratch.bytes);
+  TEST_ASSERT_TRUE(top.scratch.data == buf.storage + 32);
+  TEST_ASSERT_EQUAL_UINT32(16, top.scratch.bytes);
+
+  RenderContext rctx;
+  rctx.map = &map;
+  Rgb out[kLeds] = {};
+  stack.render(rctx, out, kLeds);
+  // base, then + mid (saturating), then max with top.
+  TEST_ASSERT_EQUAL_UINT8(255, out[0].r);
+  TEST_ASSERT_EQUAL_UINT8(50, out[3].g);
+  TEST_ASSERT_EQUAL_UINT8(255, out[kLeds - 1].b);
+}
+
+void test_layer_stack_params_drive_modes_and_skip_hidden_layers() {
+  NullSettingsStore store;
+  PixelsMap map;
+  SolidEffect base(EffectDescriptor{EffectId{10}, "base", "Base", nullptr}, Rgb{200, 100, 0});
+  SolidEffect top(EffectDescriptor{EffectId{11}, "top", "Top", nullptr}, Rgb{128, 255, 0});
+
+  LayerStackEffect<kLeds> stack(EffectDescriptor{EffectId{1}, "stack", "Stack", nullptr});
+  TEST_ASSERT_TRUE(stack.add_layer(&base, BlendMode::kAlpha, 255));
+  TEST_ASSERT_TRUE(stack.add_layer(&top, BlendMode::kMultiply, 255));
+  EffectCatalog<4> catalog;
+  TEST_ASSERT_TRUE(catalog.add(stack.descriptor(), &stack));
+
+  static EffectManager<4, kLeds> mgr;
+  mgr.init(store, catalog, map, 0);
+  TEST_ASSERT_TRUE(mgr.set_active(EffectId{1}, 0));
+  Rgb out[kLeds] = {};
+
+  mgr.render(out, kLeds);
+  TEST_ASSERT_EQUAL_UINT8(100, out[0].r);  // 200 * 128 / 255
+  TEST_ASSERT_EQUAL_UINT8(100, out[0].g);
+
+  TEST_ASSERT_TRUE(mgr.set_param_raw(EffectId{1}, chromance::core::layer_stack::mode_param(1),
+                                     static_cast<int32_t>(BlendMode::kAlpha)));
+  mgr.render(out, kLeds);
+  TEST_ASSERT_EQUAL_UINT8(128, out[0].r);
+  TEST_ASSERT_FALSE(mgr.set_param_raw(EffectId{1}, chromance::core::layer_stack::mode_param(1), 5));
+
+  // Hidden top layer: not rendered at all; dimmed base.
+  TEST_ASSERT_TRUE(mgr.set_param_raw(EffectId{1}, chromance::core::layer_stack::opacity_param(1), 0));
+  TEST_ASSERT_TRUE(mgr.set_param_raw(EffectId{1}, chromance::core::layer_stack::opacity_param(0), 128));
+  const uint32_t top_renders = top.render_calls;
+  mgr.render(out, kLeds);
+  TEST_ASSERT_EQUAL_UINT32(top_renders, top.render_calls);
+  TEST_ASSERT_EQUAL_UINT8(100, out[kLeds - 1].r);
+}
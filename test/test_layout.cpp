@@ -2,31 +2,50 @@
 
 #include "core/layout.h"
 
+using chromance::core::MappingTables;
+using chromance::core::StripConfig;
 using chromance::core::kDiagnosticBrightness;
 using chromance::core::kLedsPerSegment;
-using chromance::core::kStripConfigs;
+using chromance::core::kMaxStripSegments;
 using chromance::core::kStripCount;
+using chromance::core::kTotalLeds;
 using chromance::core::kTotalSegments;
-using chromance::core::kStrip0Segments;
-using chromance::core::kStrip1Segments;
-using chromance::core::kStrip2Segments;
-using chromance::core::kStrip3Segments;
+using chromance::core::strip_config;
 
 void test_layout_constants() {
-  TEST_ASSERT_EQUAL_UINT8(4, kStripCount);
-  TEST_ASSERT_EQUAL_UINT16(40, kTotalSegments);
   TEST_ASSERT_EQUAL_UINT8(14, kLedsPerSegment);
   TEST_ASSERT_EQUAL_UINT8(64, kDiagnosticBrightness);
+  TEST_ASSERT_EQUAL_UINT8(MappingTables::strip_count(), kStripCount);
+  TEST_ASSERT_EQUAL_UINT16(MappingTables::led_count(), kTotalLeds);
+
+  uint16_t sum = 0;
+  uint8_t longest = 0;
+  for (uint8_t i = 0; i < kStripCount; ++i) {
+    const StripConfig cfg = strip_config(i);
+    TEST_ASSERT_TRUE(cfg.segment_count > 0);
+    TEST_ASSERT_EQUAL_UINT8(MappingTables::strip_segment_count()[i], cfg.segment_count);
+    sum = static_cast<uint16_t>(sum + cfg.segment_count);
+    if (cfg.segment_count > longest) longest = cfg.segment_count;
+  }
+  TEST_ASSERT_EQUAL_UINT16(kTotalSegments, sum);
+  TEST_ASSERT_EQUAL_UINT8(longest, kMaxStripSegments);
 
-  TEST_ASSERT_EQUAL_UINT8(11, kStrip0Segments);
-  TEST_ASSERT_EQUAL_UINT8(12, kStrip1Segments);
-  TEST_ASSERT_EQUAL_UINT8(6, kStrip2Segments);
-  TEST_ASSERT_EQUAL_UINT8(11, kStrip3Segments);
+  if (MappingTables::is_bench_subset() || MappingTables::segment_count() != 40) return;
 
-  TEST_ASSERT_EQUAL_UINT8(kStrip0Segments, kStripConfigs[0].segment_count);
-  TEST_ASSERT_EQUAL_UINT8(kStrip1Segments, kStripConfigs[1].segment_count);
-  TEST_ASSERT_EQUAL_UINT8(kStrip2Segments, kStripConfigs[2].segment_count);
-  TEST_ASSERT_EQUAL_UINT8(kStrip3Segments, kStripConfigs[3].segment_count);
+  // Canonical single-panel wiring (mapping/wiring.json).
+  TEST_ASSERT_EQUAL_UINT8(4, kStripCount);
+  TEST_ASSERT_EQUAL_UINT16(40, kTotalSegments);
+  TEST_ASSERT_EQUAL_UINT8(11, strip_config(0).segment_count);
+  TEST_ASSERT_EQUAL_UINT8(12, strip_config(1).segment_count);
+  TEST_ASSERT_EQUAL_UINT8(6, strip_config(2).segment_count);
+  TEST_ASSERT_EQUAL_UINT8(11, strip_config(3).segment_count);
 
-  TEST_ASSERT_EQUAL_UINT16(40, kStrip0Segments + kStrip1Segments + kStrip2Segments + kStrip3Segments);
+  const uint8_t data_pins[4] = {23, 17, 33, 14};
+  const uint8_t clock_pins[4] = {22, 16, 27, 32};
+  for (uint8_t i = 0; i < 4; ++i) {
+    TEST_ASSERT_EQUAL_UINT8(data_pins[i], strip_config(i).data_pin);
+    TEST_ASSERT_EQUAL_UINT8(clock_pins[i], strip_config(i).clock_pin);
+  }
+  TEST_ASSERT_EQUAL_UINT8(255, strip_config(3).diagnostic_color.r);  // magenta
+  TEST_ASSERT_EQUAL_UINT8(255, strip_config(3).diagnostic_color.b);
 }
@@ -45,6 +45,7 @@ void test_index_walk_effect_step_hold_freezes_until_next_step();
 void test_index_walk_vertex_mode_step_hold_freezes_fill_progress();
 void test_index_walk_vertex_manual_selection_loops_fill_animation();
 void test_xy_scan_effect_uses_scan_order();
+void test_xy_scan_effect_sorts_its_own_order_into_scratch();
 void test_coord_color_effect_matches_expected_formula_and_scales_brightness();
 void test_rainbow_pulse_fades_and_holds();
 void test_two_dots_lights_two_pixels_and_changes_colors_on_sequence();
@@ -69,6 +70,94 @@ void test_effect_manager_v2_init_persists_active_id_and_binds_configs();
 void test_effect_manager_v2_set_get_param_and_persistence_debounce();
 void test_effect_manager_v2_set_active_calls_stop_start_and_events_render_flow();
 
+void test_param_frame_round_trip_and_rejects_malformed();
+void test_ws_frame_reader_unmasks_split_frames_and_rejects_unmasked();
+void test_param_coalescer_last_write_wins_applies_once_per_frame();
+
+void test_frame_delta_round_trips_and_compresses_sparse_frames();
+void test_preview_rate_backs_off_under_backpressure_and_recovers();
+
+void test_realtime_ddp_writes_global_index_and_times_out();
+void test_realtime_e131_raster_layout_with_universe_sync();
+void test_realtime_artnet_without_and_with_artsync();
+void test_realtime_ddp_over_udp_loopback();
+
+void test_serial_frame_crc16_matches_reference_vector();
+void test_serial_frame_receiver_swaps_frames_and_passes_commands_through();
+void test_serial_frame_receiver_rejects_bad_frames_and_resyncs();
+
+void test_asset_send_resumes_across_pumps_within_budget();
+void test_asset_send_reports_stall_and_error();
+void test_asset_send_etag_matching();
+
+void test_breathing_effect_v2_prepare_survives_start_and_matches_cold_render();
+void test_effect_manager_v2_prepares_in_idle_time_before_activation();
+void test_effect_manager_v2_records_first_frame_and_steady_cost();
+
+void test_crossfade_packed_kernel_matches_scalar_reference();
+void test_crossfade_manager_fades_then_stops_outgoing();
+void test_crossfade_degrades_to_shorter_fade_or_cut_under_budget();
+void test_crossfade_manager_lends_effect_scratch_from_both_ends();
+
+void test_layer_blend_kernels_match_scalar_reference();
+void test_layer_stack_composites_layers_in_order();
+void test_layer_stack_params_drive_modes_and_skip_hidden_layers();
+
+void test_frame_scheduler_idle_hold_skips_frames_until_deadline_or_wake();
+void test_effect_manager_v2_skips_frames_until_next_change();
+void test_static_effects_report_next_change();
+
+void test_frame_scheduler_reports_occupancy_and_rendered_fps();
+void test_power_governor_steps_down_after_dwell_and_up_on_load();
+void test_power_governor_sleeps_when_dark_or_slow_and_wakes_for_links();
+void test_power_governor_accounts_time_and_frame_cost_per_step();
+
+void test_fixed_fft_power_spectrum_peaks_at_tone_bin();
+void test_audio_analyzer_tracks_click_track_tempo_from_wav();
+void test_audio_analyzer_reports_energy_and_ignores_silence();
+void test_wav_reader_rejects_unsupported_formats();
+void test_audio_modulation_provider_reads_snapshot_and_extrapolates_phase();
+
+void test_clip_encoder_round_trips_keyframes_and_deltas();
+void test_clip_reader_seeks_through_keyframe_table();
+void test_clip_reader_rejects_corrupt_clips();
+void test_clip_encoder_quantizes_to_palette_and_reports_overflow();
+void test_clip_bundle_finds_clips_by_name();
+void test_clip_player_follows_clip_clock_and_brightness();
+
+void test_playlist_sequences_entries_with_transitions_and_params();
+void test_playlist_prewarms_next_effect_once_before_boundary();
+void test_playlist_skips_missing_effects_and_holds_untimed_entries();
+void test_playlist_persists_entries_and_running_state();
+void test_playlist_drives_effect_manager_without_persisting_snapshots();
+void test_playlist_alternating_snapshots_of_one_effect_never_write_its_config();
+
+void test_headless_script_parser_accepts_runtime_inputs();
+void test_memory_settings_store_keeps_exact_size_blobs();
+void test_headless_runner_replays_script_deterministically();
+void test_headless_runner_counts_held_frames_and_events();
+
+void test_led_attrs_pack_matches_topology_tables();
+void test_compact_mapping_decodes_the_flat_tables();
+void test_mapping_blob_round_trips_and_installs();
+void test_strip_spans_cover_the_frame_once();
+void test_apa102_pixels_hold_colour_bytes_in_wire_order();
+void test_effect_manager_renders_wire_frames_only_for_opt_in_effects();
+void test_apa102_wire_time_follows_frame_bytes_and_clock();
+void test_spi_bus_plan_balances_strips_across_hosts();
+void test_spi_bus_plan_gives_rewired_strips_their_host_and_caps_clocks_per_host();
+void test_segment_mask_selects_leds_by_bit_test();
+
+void test_mode_setting_max_mode_follows_catalog_capacity();
+
+void test_node_sync_beacon_round_trips_and_rejects_malformed();
+void test_node_sync_followers_phase_lock_within_1ms_over_udp_loopback();
+void test_node_sync_follower_renders_leader_frames();
+void test_node_sync_follower_crossfades_with_leader_despite_local_frame_costs();
+void test_frame_scheduler_phase_lock_puts_boundaries_on_shared_grid();
+
+void test_node_partition_matches_strip_ownership();
+
 int main(int argc, char** argv) {
   (void)argc;
   (void)argv;
@@ -120,6 +209,7 @@ int main(int argc, char** argv) {
   RUN_TEST(test_index_walk_vertex_mode_step_hold_freezes_fill_progress);
   RUN_TEST(test_index_walk_vertex_manual_selection_loops_fill_animation);
   RUN_TEST(test_xy_scan_effect_uses_scan_order);
+  RUN_TEST(test_xy_scan_effect_sorts_its_own_order_into_scratch);
   RUN_TEST(test_coord_color_effect_matches_expected_formula_and_scales_brightness);
   RUN_TEST(test_rainbow_pulse_fades_and_holds);
   RUN_TEST(test_two_dots_lights_two_pixels_and_changes_colors_on_sequence);
@@ -145,5 +235,93 @@ int main(int argc, char** argv) {
   RUN_TEST(test_effect_manager_v2_set_get_param_and_persistence_debounce);
   RUN_TEST(test_effect_manager_v2_set_active_calls_stop_start_and_events_render_flow);
 
+  RUN_TEST(test_param_frame_round_trip_and_rejects_malformed);
+  RUN_TEST(test_ws_frame_reader_unmasks_split_frames_and_rejects_unmasked);
+  RUN_TEST(test_param_coalescer_last_write_wins_applies_once_per_frame);
+
+  RUN_TEST(test_frame_delta_round_trips_and_compresses_sparse_frames);
+  RUN_TEST(test_preview_rate_backs_off_under_backpressure_and_recovers);
+
+  RUN_TEST(test_realtime_ddp_writes_global_index_and_times_out);
+  RUN_TEST(test_realtime_e131_raster_layout_with_universe_sync);
+  RUN_TEST(test_realtime_artnet_without_and_with_artsync);
+  RUN_TEST(test_realtime_ddp_over_udp_loopback);
+
+  RUN_TEST(test_serial_frame_crc16_matches_reference_vector);
+  RUN_TEST(test_serial_frame_receiver_swaps_frames_and_passes_commands_through);
+  RUN_TEST(test_serial_frame_receiver_rejects_bad_frames_and_resyncs);
+
+  RUN_TEST(test_asset_send_resumes_across_pumps_within_budget);
+  RUN_TEST(test_asset_send_reports_stall_and_error);
+  RUN_TEST(test_asset_send_etag_matching);
+
+  RUN_TEST(test_breathing_effect_v2_prepare_survives_start_and_matches_cold_render);
+  RUN_TEST(test_effect_manager_v2_prepares_in_idle_time_before_activation);
+  RUN_TEST(test_effect_manager_v2_records_first_frame_and_steady_cost);
+
+  RUN_TEST(test_crossfade_packed_kernel_matches_scalar_reference);
+  RUN_TEST(test_crossfade_manager_fades_then_stops_outgoing);
+  RUN_TEST(test_crossfade_degrades_to_shorter_fade_or_cut_under_budget);
+  RUN_TEST(test_crossfade_manager_lends_effect_scratch_from_both_ends);
+
+  RUN_TEST(test_layer_blend_kernels_match_scalar_reference);
+  RUN_TEST(test_layer_stack_composites_layers_in_order);
+  RUN_TEST(test_layer_stack_params_drive_modes_and_skip_hidden_layers);
+
+  RUN_TEST(test_frame_scheduler_idle_hold_skips_frames_until_deadline_or_wake);
+  RUN_TEST(test_effect_manager_v2_skips_frames_until_next_change);
+  RUN_TEST(test_static_effects_report_next_change);
+
+  RUN_TEST(test_frame_scheduler_reports_occupancy_and_rendered_fps);
+  RUN_TEST(test_power_governor_steps_down_after_dwell_and_up_on_load);
+  RUN_TEST(test_power_governor_sleeps_when_dark_or_slow_and_wakes_for_links);
+  RUN_TEST(test_power_governor_accounts_time_and_frame_cost_per_step);
+
+  RUN_TEST(test_fixed_fft_power_spectrum_peaks_at_tone_bin);
+  RUN_TEST(test_audio_analyzer_tracks_click_track_tempo_from_wav);
+  RUN_TEST(test_audio_analyzer_reports_energy_and_ignores_silence);
+  RUN_TEST(test_wav_reader_rejects_unsupported_formats);
+  RUN_TEST(test_audio_modulation_provider_reads_snapshot_and_extrapolates_phase);
+
+  RUN_TEST(test_clip_encoder_round_trips_keyframes_and_deltas);
+  RUN_TEST(test_clip_reader_seeks_through_keyframe_table);
+  RUN_TEST(test_clip_reader_rejects_corrupt_clips);
+  RUN_TEST(test_clip_encoder_quantizes_to_palette_and_reports_overflow);
+  RUN_TEST(test_clip_bundle_finds_clips_by_name);
+  RUN_TEST(test_clip_player_follows_clip_clock_and_brightness);
+
+  RUN_TEST(test_playlist_sequences_entries_with_transitions_and_params);
+  RUN_TEST(test_playlist_prewarms_next_effect_once_before_boundary);
+  RUN_TEST(test_playlist_skips_missing_effects_and_holds_untimed_entries);
+  RUN_TEST(test_playlist_persists_entries_and_running_state);
+  RUN_TEST(test_playlist_drives_effect_manager_without_persisting_snapshots);
+  RUN_TEST(test_playlist_alternating_snapshots_of_one_effect_never_write_its_config);
+
+  RUN_TEST(test_headless_script_parser_accepts_runtime_inputs);
+  RUN_TEST(test_memory_settings_store_keeps_exact_size_blobs);
+  RUN_TEST(test_headless_runner_replays_script_deterministically);
+  RUN_TEST(test_headless_runner_counts_held_frames_and_events);
+
+  RUN_TEST(test_led_attrs_pack_matches_topology_tables);
+  RUN_TEST(test_compact_mapping_decodes_the_flat_tables);
+  RUN_TEST(test_mapping_blob_round_trips_and_installs);
+  RUN_TEST(test_strip_spans_cover_the_frame_once);
+  RUN_TEST(test_apa102_pixels_hold_colour_bytes_in_wire_order);
+  RUN_TEST(test_effect_manager_renders_wire_frames_only_for_opt_in_effects);
+  RUN_TEST(test_apa102_wire_time_follows_frame_bytes_and_clock);
+  RUN_TEST(test_spi_bus_plan_balances_strips_across_hosts);
+  RUN_TEST(test_spi_bus_plan_gives_rewired_strips_their_host_and_caps_clocks_per_host);
+  RUN_TEST(test_segment_mask_selects_leds_by_bit_test);
+
+  RUN_TEST(test_mode_setting_max_mode_follows_catalog_capacity);
+
+  RUN_TEST(test_node_sync_beacon_round_trips_and_rejects_malformed);
+  RUN_TEST(test_node_sync_followers_phase_lock_within_1ms_over_udp_loopback);
+  RUN_TEST(test_node_sync_follower_renders_leader_frames);
+  RUN_TEST(test_node_sync_follower_crossfades_with_leader_despite_local_frame_costs);
+  RUN_TEST(test_frame_scheduler_phase_lock_puts_boundaries_on_shared_grid);
+
+  RUN_TEST(test_node_partition_matches_strip_ownership);
+
   return UNITY_END();
 }
@@ -1,10 +1,20 @@
 #include <unity.h>
 
 #include "core/layout.h"
+#include "core/mapping/compact_mapping.h"
+#include "core/mapping/mapping_blob.h"
 #include "core/mapping/mapping_tables.h"
+#include "core/mapping/node_partition.h"
+#include "core/mapping/pixels_map.h"
+#include "core/mapping/segment_mask.h"
 #include "core/strip_layout.h"
 
+using chromance::core::CompactMapping;
+using chromance::core::LedAttr;
 using chromance::core::MappingTables;
+using chromance::core::NodeRole;
+using chromance::core::PixelCoord;
+using chromance::core::SegmentMask;
 
 void test_mapping_tables_dimensions_and_counts() {
   const uint16_t w = MappingTables::width();
@@ -16,9 +26,8 @@ void test_mapping_tables_dimensions_and_counts() {
   TEST_ASSERT_TRUE(n > 0);
 
   const bool bench = MappingTables::is_bench_subset();
-  const uint16_t expected = bench
-                                ? chromance::core::kStrip0Segments * chromance::core::kLedsPerSegment
-                                : chromance::core::kTotalSegments * chromance::core::kLedsPerSegment;
+  const uint16_t expected = bench ? chromance::core::strip_config(0).segment_count * chromance::core::kLedsPerSegment
+                                  : MappingTables::segment_count() * chromance::core::kLedsPerSegment;
   TEST_ASSERT_EQUAL_UINT16(expected, n);
 }
 
@@ -37,11 +46,11 @@ void test_mapping_tables_global_indices_are_consistent() {
     TEST_ASSERT_TRUE(strip < chromance::core::kStripCount);
 
     const uint16_t local = g2l[i];
-    TEST_ASSERT_TRUE(local < chromance::core::strip_led_count(chromance::core::kStripConfigs[strip]));
+    TEST_ASSERT_TRUE(local < chromance::core::strip_led_count(chromance::core::strip_config(strip)));
 
     const uint8_t seg = g2seg[i];
     TEST_ASSERT_TRUE(seg >= 1);
-    TEST_ASSERT_TRUE(seg <= chromance::core::kTotalSegments);
+    TEST_ASSERT_TRUE(seg <= MappingTables::segment_count());
 
     const uint8_t k = g2k[i];
     TEST_ASSERT_TRUE(k < chromance::core::kLedsPerSegment);
@@ -56,3 +65,208 @@ void test_mapping_tables_global_indices_are_consistent() {
   }
 }
 
+
+void test_led_attrs_pack_matches_topology_tables() {
+  const uint16_t n = MappingTables::led_count();
+  const chromance::core::PixelsMap map;
+  const uint8_t k_last = chromance::core::kLedsPerSegment - 1U;
+  for (uint16_t i = 0; i < n; ++i) {
+    const LedAttr a = map.attr(i);
+    TEST_ASSERT_EQUAL_UINT8(MappingTables::global_to_seg()[i], a.segment());
+    TEST_ASSERT_EQUAL_UINT8(MappingTables::global_to_strip()[i], a.strip());
+    TEST_ASSERT_EQUAL_UINT8(MappingTables::global_to_dir()[i], a.dir());
+    const uint8_t k = MappingTables::global_to_seg_k()[i];
+    TEST_ASSERT_EQUAL_UINT8(a.dir() == 0 ? k : k_last - k, a.pos_from_a());
+
+    // Nearest vertex: the segment end on the LED's side of the midpoint, also in raster space.
+    const uint8_t va = MappingTables::seg_vertex_a()[a.segment()];
+    const uint8_t vb = MappingTables::seg_vertex_b()[a.segment()];
+    TEST_ASSERT_EQUAL_UINT8(a.pos_from_a() < chromance::core::kLedsPerSegment / 2U ? va : vb, a.nearest_vertex());
+  }
+  // Position 0 sits next to vertex A, whichever way the segment is wired.
+  for (uint16_t i = 0; i < n; ++i) {
+    const LedAttr a = map.attr(i);
+    if (a.pos_from_a() != 0) continue;
+    const uint8_t va = MappingTables::seg_vertex_a()[a.segment()];
+    const uint8_t vb = MappingTables::seg_vertex_b()[a.segment()];
+    uint16_t far = i;
+    for (uint16_t j = 0; j < n; ++j) {
+      if (map.attr(j).segment() == a.segment() && map.attr(j).pos_from_a() == k_last) far = j;
+    }
+    // Vertex coords are on a lattice; compare which end each LED is closer to along the segment's long axis.
+    const int32_t ax = MappingTables::vertex_vx()[va];
+    const int32_t bx = MappingTables::vertex_vx()[vb];
+    const int32_t ay = MappingTables::vertex_vy()[va];
+    const int32_t by = MappingTables::vertex_vy()[vb];
+    const int32_t dx = MappingTables::pixel_x()[far] - MappingTables::pixel_x()[i];
+    const int32_t dy = MappingTables::pixel_y()[far] - MappingTables::pixel_y()[i];
+    TEST_ASSERT_TRUE(dx * (bx - ax) + dy * (by - ay) != 0);
+  }
+}
+
+void test_compact_mapping_decodes_the_flat_tables() {
+  const uint16_t n = MappingTables::led_count();
+  for (uint16_t i = 0; i < n; ++i) {
+    TEST_ASSERT_EQUAL_INT16(MappingTables::pixel_x()[i], CompactMapping::coord(i).x);
+    TEST_ASSERT_EQUAL_INT16(MappingTables::pixel_y()[i], CompactMapping::coord(i).y);
+    TEST_ASSERT_EQUAL_UINT8(MappingTables::global_to_strip()[i], CompactMapping::strip(i));
+    TEST_ASSERT_EQUAL_UINT16(MappingTables::global_to_local()[i], CompactMapping::local(i));
+    TEST_ASSERT_EQUAL_UINT8(MappingTables::global_to_seg()[i], CompactMapping::segment(i));
+    TEST_ASSERT_EQUAL_UINT8(MappingTables::global_to_seg_k()[i], CompactMapping::seg_k(i));
+    TEST_ASSERT_EQUAL_UINT8(MappingTables::global_to_dir()[i], CompactMapping::dir(i));
+  }
+
+  PixelCoord run[chromance::core::kLedsPerSegment];
+  for (uint16_t r = 0; r < MappingTables::run_count(); ++r) {
+    CompactMapping::run_coords(r, run);
+    for (uint8_t k = 0; k < chromance::core::kLedsPerSegment; ++k) {
+      const uint16_t i = static_cast<uint16_t>(r * chromance::core::kLedsPerSegment + k);
+      TEST_ASSERT_EQUAL_INT16(MappingTables::pixel_x()[i], run[k].x);
+      TEST_ASSERT_EQUAL_INT16(MappingTables::pixel_y()[i], run[k].y);
+    }
+  }
+}
+
+namespace {
+
+void reseal_blob(uint8_t* blob) {
+  const uint32_t total = chromance::core::mapping_blob::rd32(blob + 8);
+  chromance::core::mapping_blob::wr32(blob + 12, chromance::core::mapping_blob::fnv1a(blob + 16, total - 16U));
+}
+
+}  // namespace
+
+void test_mapping_blob_round_trips_and_installs() {
+  using chromance::core::MappingBlob;
+  using chromance::core::MappingTableSet;
+  static uint32_t words[(MappingBlob::build_bytes() + 3U) / 4U];
+  uint8_t* blob = reinterpret_cast<uint8_t*>(words);
+  const size_t size = MappingBlob::encode(MappingTables::compiled(), blob, sizeof(words));
+  TEST_ASSERT_EQUAL_UINT32(MappingBlob::build_bytes(), size);
+  TEST_ASSERT_EQUAL_UINT32(0, MappingBlob::encode(MappingTables::compiled(), blob, size - 1U));
+  MappingBlob::encode(MappingTables::compiled(), blob, sizeof(words));
+
+  MappingBlob view;
+  TEST_ASSERT_TRUE(view.open(blob, size));
+  TEST_ASSERT_EQUAL(MappingTables::node_count() == 1, view.compatible());  // node builds keep their partition
+  TEST_ASSERT_EQUAL_STRING(MappingTables::mapping_version(), view.mapping_version());
+  TEST_ASSERT_EQUAL(MappingTables::is_bench_subset(), view.is_bench_subset());
+
+  const MappingTableSet compiled = MappingTables::compiled();
+  MappingTables::install(view.tables());
+  TEST_ASSERT_FALSE(MappingTables::using_compiled());
+  TEST_ASSERT_TRUE(reinterpret_cast<const uint8_t*>(MappingTables::pixel_x()) > blob);
+  TEST_ASSERT_TRUE(reinterpret_cast<const uint8_t*>(MappingTables::segment_runs()) < blob + size);
+  for (uint16_t i = 0; i < MappingTables::led_count(); ++i) {
+    TEST_ASSERT_EQUAL_INT16(compiled.pixel_x[i], MappingTables::pixel_x()[i]);
+    TEST_ASSERT_EQUAL_INT16(compiled.pixel_y[i], MappingTables::pixel_y()[i]);
+    TEST_ASSERT_EQUAL_UINT16(compiled.global_to_local[i], MappingTables::global_to_local()[i]);
+    TEST_ASSERT_EQUAL_UINT32(compiled.led_attrs[i], MappingTables::led_attrs()[i]);
+  }
+  for (uint8_t s = 0; s < MappingTables::strip_count(); ++s) {
+    TEST_ASSERT_EQUAL_UINT8(compiled.strip_data_pin[s], chromance::core::strip_config(s).data_pin);
+  }
+  MappingTables::install_compiled();
+  TEST_ASSERT_TRUE(MappingTables::using_compiled());
+
+  uint8_t* strips = blob + (reinterpret_cast<const uint8_t*>(view.tables().global_to_strip) - blob);
+  // Damage is caught by the checksum; a resealed blob still has its indices range-checked.
+  blob[size - 1U] ^= 0x01;
+  TEST_ASSERT_FALSE(view.open(blob, size));
+  blob[size - 1U] ^= 0x01;
+  TEST_ASSERT_FALSE(view.open(blob, size - 4U));
+  const uint8_t strip0 = strips[0];
+  strips[0] = MappingTables::strip_count();
+  reseal_blob(blob);
+  TEST_ASSERT_FALSE(view.open(blob, size));
+  strips[0] = strip0;
+
+  // Well-formed but shaped for another build: readable, not installable.
+  blob[30] ^= 0x01;  // raster_scale_x
+  reseal_blob(blob);
+  TEST_ASSERT_TRUE(view.open(blob, size));
+  TEST_ASSERT_FALSE(view.compatible());
+}
+
+void test_strip_spans_cover_the_frame_once() {
+  // strip_first_led() + strip-local index is a permutation of the global LEDs; wire-order layouts are numbered by
+  // it, so there every strip is the contiguous span the output sends as is.
+  static bool seen[MappingTables::led_count()];
+  for (uint16_t i = 0; i < MappingTables::led_count(); ++i) seen[i] = false;
+  for (uint16_t i = 0; i < MappingTables::led_count(); ++i) {
+    const uint8_t strip = MappingTables::global_to_strip()[i];
+    const uint16_t wire = static_cast<uint16_t>(chromance::core::strip_first_led(strip) +
+                                                MappingTables::global_to_local()[i]);
+    TEST_ASSERT_TRUE(wire < MappingTables::led_count());
+    TEST_ASSERT_FALSE(seen[wire]);
+    seen[wire] = true;
+    if (MappingTables::wire_order()) {
+      TEST_ASSERT_EQUAL_UINT16(i, wire);
+    }
+  }
+}
+
+void test_segment_mask_selects_leds_by_bit_test() {
+  SegmentMask m;
+  TEST_ASSERT_FALSE(m.any());
+  const uint8_t segs[] = {1, 12, 33, 40, 0, 200};
+  m.set_all(segs, sizeof(segs));
+  TEST_ASSERT_EQUAL_UINT8(4, m.count());
+  TEST_ASSERT_TRUE(m.test(33));
+  TEST_ASSERT_FALSE(m.test(0));
+  TEST_ASSERT_FALSE(m.test(200));
+  m.reset(12);
+  TEST_ASSERT_FALSE(m.test(12));
+
+  const SegmentMask present = chromance::core::present_segments();
+  SegmentMask both = m;
+  both &= present;
+  TEST_ASSERT_TRUE(both.count() <= m.count());
+
+  uint16_t selected = 0;
+  for (uint16_t i = 0; i < MappingTables::led_count(); ++i) {
+    const bool want = MappingTables::global_to_seg()[i] == 1 || MappingTables::global_to_seg()[i] == 33 ||
+                      MappingTables::global_to_seg()[i] == 40;
+    TEST_ASSERT_EQUAL(want, m.contains(chromance::core::led_attr(i)));
+    selected += want ? 1 : 0;
+  }
+  TEST_ASSERT_EQUAL_UINT16(both.count() * chromance::core::kLedsPerSegment, selected);
+}
+
+void test_node_partition_matches_strip_ownership() {
+  const uint8_t node = MappingTables::node_index();
+  const SegmentMask local = chromance::core::node_segments(NodeRole::kLocal);
+  const SegmentMask halo = chromance::core::node_segments(NodeRole::kHalo);
+
+  uint16_t driven = 0;
+  for (uint16_t i = 0; i < MappingTables::led_count(); ++i) {
+    const uint8_t strip = MappingTables::global_to_strip()[i];
+    const bool ours = MappingTables::strip_node()[strip] == node;
+    TEST_ASSERT_EQUAL(ours, chromance::core::node_drives_led(i));
+    TEST_ASSERT_EQUAL(ours, local.contains(chromance::core::led_attr(i)));
+    if (!ours) TEST_ASSERT_EQUAL_UINT8(chromance::core::kUnassignedPin, MappingTables::strip_data_pin()[strip]);
+    driven += ours ? 1 : 0;
+  }
+  TEST_ASSERT_EQUAL_UINT16(MappingTables::node_led_count(), driven);
+
+  // Halo segments touch one of ours; a single-controller build owns everything it wires and has no halo.
+  for (uint16_t seg = 1; seg <= MappingTables::segment_count(); ++seg) {
+    if (!halo.test(static_cast<uint8_t>(seg))) continue;
+    bool touches = false;
+    for (uint16_t other = 1; other <= MappingTables::segment_count(); ++other) {
+      if (!local.test(static_cast<uint8_t>(other))) continue;
+      const uint8_t a = MappingTables::seg_vertex_a()[seg];
+      const uint8_t b = MappingTables::seg_vertex_b()[seg];
+      touches = touches || a == MappingTables::seg_vertex_a()[other] || a == MappingTables::seg_vertex_b()[other] ||
+                b == MappingTables::seg_vertex_a()[other] || b == MappingTables::seg_vertex_b()[other];
+    }
+    TEST_ASSERT_TRUE(touches);
+  }
+  if (!chromance::core::is_multi_node()) {
+    TEST_ASSERT_FALSE(halo.any());
+    TEST_ASSERT_TRUE(local == chromance::core::present_segments());
+    TEST_ASSERT_EQUAL_UINT16(0, MappingTables::node_led_first());
+  } else {
+    TEST_ASSERT_TRUE(halo.any());
+  }
+}
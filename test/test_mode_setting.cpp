@@ -39,18 +39,20 @@ void test_mode_setting_sanitizes_values() {
   TEST_ASSERT_EQUAL_UINT8(5, ModeSetting::sanitize(5));
   TEST_ASSERT_EQUAL_UINT8(6, ModeSetting::sanitize(6));
   TEST_ASSERT_EQUAL_UINT8(7, ModeSetting::sanitize(7));
-  TEST_ASSERT_EQUAL_UINT8(1, ModeSetting::sanitize(8));
+  TEST_ASSERT_EQUAL_UINT8(8, ModeSetting::sanitize(8));
+  TEST_ASSERT_EQUAL_UINT8(9, ModeSetting::sanitize(9));
+  TEST_ASSERT_EQUAL_UINT8(1, ModeSetting::sanitize(10));
   TEST_ASSERT_EQUAL_UINT8(1, ModeSetting::sanitize(255));
 }
 
 void test_mode_setting_begin_reads_and_writes_back_sanitized() {
   FakeStore store;
   store.has_key = true;
-  store.stored = 9;
+  store.stored = 10;
 
   ModeSetting s;
   s.begin(store, "mode", 3);
-  TEST_ASSERT_EQUAL_UINT8(1, s.mode());  // 9 -> sanitized to 1
+  TEST_ASSERT_EQUAL_UINT8(1, s.mode());  // 10 -> sanitized to 1
   TEST_ASSERT_EQUAL_UINT8(1, store.stored);
   TEST_ASSERT_EQUAL_UINT32(1, store.reads);
   TEST_ASSERT_EQUAL_UINT32(1, store.writes);
@@ -77,3 +79,19 @@ void test_mode_setting_set_mode_persists_sanitized() {
   TEST_ASSERT_EQUAL_UINT8(1, s.mode());
   TEST_ASSERT_EQUAL_UINT8(1, store.stored);
 }
+
+void test_mode_setting_max_mode_follows_catalog_capacity() {
+  TEST_ASSERT_EQUAL_UINT8(24, ModeSetting::sanitize(24, 32));
+  TEST_ASSERT_EQUAL_UINT8(1, ModeSetting::sanitize(33, 32));
+
+  FakeStore store;
+  store.has_key = true;
+  store.stored = 20;
+  ModeSetting s;
+  s.begin(store, "mode", 1, 32);
+  TEST_ASSERT_EQUAL_UINT8(20, s.mode());
+  s.set_mode(store, "mode", 32);
+  TEST_ASSERT_EQUAL_UINT8(32, store.stored);
+  s.set_mode(store, "mode", 40);
+  TEST_ASSERT_EQUAL_UINT8(1, s.mode());
+}
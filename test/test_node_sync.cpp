@@ -0,0 +1,390 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <vector>
+
+#include <unity.h>
+
+#include "core/effects/effect_catalog.h"
+#include "core/effects/effect_manager.h"
+#include "core/effects/frame_scheduler.h"
+#include "core/effects/legacy_effect_adapter.h"
+#include "core/effects/pattern_breathing_mode.h"
+#include "core/effects/pattern_breathing_mode_v2.h"
+#include "core/effects/pattern_rainbow_pulse.h"
+#include "core/mapping/mapping_tables.h"
+#include "core/mapping/pixels_map.h"
+#include "core/protocol/node_sync.h"
+#include "core/sim/headless_runner.h"
+
+using chromance::core::ClockServo;
+using chromance::core::EffectDescriptor;
+using chromance::core::EffectId;
+using chromance::core::FrameScheduler;
+using chromance::core::MemorySettingsStore;
+using chromance::core::Rgb;
+using chromance::core::SyncBeacon;
+using chromance::core::SyncFollower;
+using chromance::core::SyncLeader;
+using chromance::core::SyncState;
+using chromance::core::kSyncMaxBeaconBytes;
+
+namespace {
+
+constexpr size_t kLeds = chromance::core::MappingTables::led_count();
+
+constexpr EffectDescriptor kRainbowDesc{EffectId{4}, "rainbow_pulse", "Rainbow_Pulse", nullptr};
+constexpr EffectDescriptor kBreathingDesc{EffectId{7}, "breathing", "Breathing", nullptr};
+
+// One node's effect wiring, as in the runtime.
+struct Node {
+  chromance::core::PixelsMap map;
+  chromance::core::RainbowPulseEffect rainbow{700, 2000, 700};
+  chromance::core::BreathingEffect breathing;
+  chromance::core::LegacyEffectAdapter rainbow_adapter{kRainbowDesc, &rainbow};
+  chromance::core::BreathingEffectV2 breathing_effect{kBreathingDesc, &breathing};
+  chromance::core::EffectCatalog<4> catalog;
+  chromance::core::EffectManager<4> manager;
+  MemorySettingsStore<8> store;
+  Rgb rgb[kLeds];
+
+  explicit Node(uint32_t boot_ms) {
+    (void)catalog.add(rainbow_adapter.descriptor(), &rainbow_adapter);
+    (void)catalog.add(breathing_effect.descriptor(), &breathing_effect);
+    manager.init(store, catalog, map, boot_ms, EffectId{4});
+    manager.set_transition_ms(400);
+  }
+
+  void render(uint32_t now_ms) {
+    manager.tick(now_ms, 20, chromance::core::Signals{});
+    manager.render(rgb, kLeds);
+  }
+};
+
+// A board's free-running clock: its own boot offset and crystal error.
+struct SimClock {
+  int64_t offset_us;
+  int32_t ppm;
+  uint64_t at(uint64_t true_us) const {
+    return static_cast<uint64_t>(offset_us + static_cast<int64_t>(true_us) +
+                                 static_cast<int64_t>(true_us) * ppm / 1000000);
+  }
+};
+
+int open_loopback(sockaddr_in* addr) {
+  const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  memset(addr, 0, sizeof(*addr));
+  addr->sin_family = AF_INET;
+  addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr->sin_port = 0;
+  socklen_t alen = sizeof(*addr);
+  if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(addr), sizeof(*addr)) != 0 ||
+      getsockname(fd, reinterpret_cast<sockaddr*>(addr), &alen) != 0) {
+    return -1;
+  }
+  return fd;
+}
+
+// The runtime loop's sync step: the leader's state goes out as a beacon over loopback UDP, and the follower
+// adopts whatever it received.
+void sync_over_loopback(Node& lead, SyncLeader& leader, int leader_fd, const sockaddr_in& follower_addr,
+                        int follower_fd, SyncFollower& follower, Node& follow, uint64_t now_us) {
+  SyncState st;
+  chromance::core::capture_sync_state(lead.manager, 50, &st);
+  uint8_t pkt[kSyncMaxBeaconBytes];
+  const size_t len = leader.poll(st, now_us, pkt, sizeof(pkt));
+  if (len > 0) {
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(len),
+                          static_cast<int>(sendto(leader_fd, pkt, len, 0,
+                                                  reinterpret_cast<const sockaddr*>(&follower_addr),
+                                                  sizeof(follower_addr))));
+  }
+  uint8_t buf[1500];
+  ssize_t got;
+  while ((got = recv(follower_fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+    (void)follower.on_packet(buf, static_cast<size_t>(got), now_us);
+  }
+  if (follower.has_state()) {
+    (void)chromance::core::apply_sync_state(follower.state(), follow.manager);
+  }
+}
+
+SyncState sample_state() {
+  SyncState s;
+  s.effect_id = 7;
+  s.effect_start_ms = 0xA1B2C3D4u;
+  s.params.brightness = 200;
+  s.params.speed = 9;
+  s.target_fps = 62;
+  s.fade_ms = 0x0190;
+  s.config_len = 5;
+  for (uint8_t i = 0; i < s.config_len; ++i) s.config[i] = static_cast<uint8_t>(0xF0 + i);
+  return s;
+}
+
+}  // namespace
+
+void test_node_sync_beacon_round_trips_and_rejects_malformed() {
+  SyncBeacon b;
+  b.group = 3;
+  b.sequence = 0xBEEF;
+  b.leader_us = 0x0102030405060708ULL;
+  b.state = sample_state();
+  uint8_t pkt[kSyncMaxBeaconBytes];
+  const size_t len = chromance::core::encode_sync_beacon(b, pkt, sizeof(pkt));
+  TEST_ASSERT_EQUAL_UINT32(chromance::core::kSyncHeaderBytes + 5, len);
+  TEST_ASSERT_EQUAL_UINT32(0, chromance::core::encode_sync_beacon(b, pkt, len - 1));
+
+  SyncBeacon out;
+  TEST_ASSERT_TRUE(chromance::core::parse_sync_beacon(pkt, len, &out));
+  TEST_ASSERT_EQUAL_UINT8(3, out.group);
+  TEST_ASSERT_EQUAL_UINT16(0xBEEF, out.sequence);
+  TEST_ASSERT_TRUE(out.leader_us == b.leader_us);
+  TEST_ASSERT_TRUE(chromance::core::same_sync_state(b.state, out.state));
+
+  TEST_ASSERT_FALSE(chromance::core::parse_sync_beacon(pkt, len - 1, &out));
+  TEST_ASSERT_FALSE(chromance::core::parse_sync_beacon(pkt, len + 1, &out));
+  pkt[4] = chromance::core::kSyncVersion + 1;  // future version
+  TEST_ASSERT_FALSE(chromance::core::parse_sync_beacon(pkt, len, &out));
+
+  // Followers take their group's beacons in sequence order only; gaps count as lost.
+  SyncFollower f(3);
+  b.sequence = 10;
+  (void)chromance::core::encode_sync_beacon(b, pkt, sizeof(pkt));
+  TEST_ASSERT_TRUE(f.on_packet(pkt, len, 1000));
+  TEST_ASSERT_FALSE(f.on_packet(pkt, len, 2000));  // duplicate
+  b.sequence = 13;
+  (void)chromance::core::encode_sync_beacon(b, pkt, sizeof(pkt));
+  TEST_ASSERT_TRUE(f.on_packet(pkt, len, 3000));
+  b.group = 4;
+  b.sequence = 14;
+  (void)chromance::core::encode_sync_beacon(b, pkt, sizeof(pkt));
+  TEST_ASSERT_FALSE(f.on_packet(pkt, len, 4000));
+  TEST_ASSERT_FALSE(f.on_packet(pkt, 3, 4000));
+  // A rebooted leader starts its sequence over; it is followed again once the old one timed out.
+  b.group = 3;
+  b.sequence = 0;
+  (void)chromance::core::encode_sync_beacon(b, pkt, sizeof(pkt));
+  TEST_ASSERT_FALSE(f.on_packet(pkt, len, 5000));
+  TEST_ASSERT_TRUE(f.on_packet(pkt, len, 3000 + SyncFollower::kTimeoutUs));
+  const chromance::core::SyncFollowerStats& s = f.stats();
+  TEST_ASSERT_EQUAL_UINT32(3, s.beacons);
+  TEST_ASSERT_EQUAL_UINT32(2, s.lost);
+  TEST_ASSERT_EQUAL_UINT32(3, s.ignored);
+  TEST_ASSERT_EQUAL_UINT32(1, s.malformed);
+  TEST_ASSERT_EQUAL_UINT32(1, s.timeouts);
+
+  // Leaders beacon on state changes at once and otherwise every kBeaconIntervalUs.
+  SyncLeader leader(3);
+  SyncState st = sample_state();
+  TEST_ASSERT_TRUE(leader.poll(st, 0, pkt, sizeof(pkt)) > 0);
+  TEST_ASSERT_EQUAL_UINT32(0, leader.poll(st, SyncLeader::kBeaconIntervalUs - 1, pkt, sizeof(pkt)));
+  st.params.brightness = 1;
+  TEST_ASSERT_TRUE(leader.poll(st, SyncLeader::kBeaconIntervalUs - 1, pkt, sizeof(pkt)) > 0);
+  TEST_ASSERT_TRUE(leader.poll(st, 2 * SyncLeader::kBeaconIntervalUs, pkt, sizeof(pkt)) > 0);
+  TEST_ASSERT_EQUAL_UINT32(3, leader.beacons());
+}
+
+// Three boards with unrelated boot times and +-40 ppm crystals. Beacons travel over real loopback sockets;
+// followers read them at jittered loop times, the way the firmware polls between frames.
+void test_node_sync_followers_phase_lock_within_1ms_over_udp_loopback() {
+  sockaddr_in leader_addr;
+  sockaddr_in follower_addr[2];
+  const int leader_fd = open_loopback(&leader_addr);
+  const int follower_fd[2] = {open_loopback(&follower_addr[0]), open_loopback(&follower_addr[1])};
+  TEST_ASSERT_TRUE(leader_fd >= 0 && follower_fd[0] >= 0 && follower_fd[1] >= 0);
+
+  const SimClock leader_clock{3600000000LL, 0};
+  const SimClock follower_clock[2] = {{123456789LL, 40}, {7LL, -35}};
+  SyncLeader leader;
+  SyncFollower follower[2];
+  const SyncState state = sample_state();
+
+  FrameScheduler leader_sched(60);
+  FrameScheduler follower_sched[2] = {FrameScheduler(60), FrameScheduler(60)};
+  leader_sched.set_phase_locked(true);
+  leader_sched.reset(static_cast<uint32_t>(leader_clock.at(0) / 1000U));
+  for (FrameScheduler& s : follower_sched) s.set_phase_locked(true);
+
+  // Leader ms clock -> true time of the leader's render on that boundary.
+  std::vector<uint64_t> leader_render_us(40000, 0);
+  const uint32_t leader_base_ms = static_cast<uint32_t>(leader_clock.at(0) / 1000U);
+
+  uint64_t next_poll_us[2] = {0, 0};
+  uint32_t rng = 12345;
+  int32_t worst_clock_us = 0;
+  int32_t worst_render_us = 0;
+  uint32_t compared_frames = 0;
+  constexpr uint64_t kSettleUs = 4000000;
+  constexpr uint64_t kRunUs = 20000000;
+
+  for (uint64_t t = 0; t < kRunUs; t += 100) {
+    const uint64_t leader_us = leader_clock.at(t);
+    uint8_t pkt[kSyncMaxBeaconBytes];
+    const size_t len = leader.poll(state, leader_us, pkt, sizeof(pkt));
+    for (uint8_t n = 0; n < 2 && len > 0; ++n) {
+      TEST_ASSERT_EQUAL_INT(static_cast<int>(len),
+                            static_cast<int>(sendto(leader_fd, pkt, len, 0,
+                                                    reinterpret_cast<const sockaddr*>(&follower_addr[n]),
+                                                    sizeof(follower_addr[n]))));
+    }
+
+    const uint32_t leader_ms = static_cast<uint32_t>(leader_us / 1000U);
+    if (leader_sched.should_render(leader_ms)) {
+      const uint32_t k = leader_ms - leader_base_ms;
+      if (k < leader_render_us.size()) leader_render_us[k] = t;
+    }
+
+    for (uint8_t n = 0; n < 2; ++n) {
+      const uint64_t local_us = follower_clock[n].at(t);
+      if (t >= next_poll_us[n]) {
+        rng = rng * 1664525u + 1013904223u;
+        next_poll_us[n] = t + 200 + (rng >> 8) % 3000;  // 0.2 .. 3.2 ms between loop iterations
+        uint8_t buf[1500];
+        ssize_t got;
+        while ((got = recv(follower_fd[n], buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+          (void)follower[n].on_packet(buf, static_cast<size_t>(got), local_us);
+        }
+      }
+      if (!follower[n].locked()) continue;
+      const uint32_t now_ms = follower[n].now_ms(local_us);
+      if (follower[n].take_clock_step()) follower_sched[n].reset(now_ms);
+      if (t < kSettleUs) continue;
+
+      const int32_t clock_err = static_cast<int32_t>(follower[n].now_us(local_us) - leader_us);
+      if (clock_err > worst_clock_us) worst_clock_us = clock_err;
+      if (-clock_err > worst_clock_us) worst_clock_us = -clock_err;
+      if (follower_sched[n].should_render(now_ms)) {
+        const uint32_t k = now_ms - leader_base_ms;
+        if (k < leader_render_us.size() && leader_render_us[k] != 0) {
+          const int32_t d = static_cast<int32_t>(t - leader_render_us[k]);
+          if (d > worst_render_us) worst_render_us = d;
+          if (-d > worst_render_us) worst_render_us = -d;
+          ++compared_frames;
+        }
+      }
+    }
+  }
+  close(leader_fd);
+  close(follower_fd[0]);
+  close(follower_fd[1]);
+
+  TEST_ASSERT_TRUE(follower[0].locked() && follower[1].locked());
+  TEST_ASSERT_EQUAL_UINT32(1, follower[0].servo().steps());
+  TEST_ASSERT_EQUAL_UINT32(1, follower[1].servo().steps());
+  TEST_ASSERT_TRUE(chromance::core::same_sync_state(state, follower[0].state()));
+  // Drift terms head for the crystals' ppm (leader-relative, opposite sign); over a 20 s run loop jitter still
+  // dominates them, the check is that the integrator does not wind up.
+  TEST_ASSERT_INT32_WITHIN(60000, -40000, follower[0].servo().drift_ppb());
+  TEST_ASSERT_INT32_WITHIN(60000, 35000, follower[1].servo().drift_ppb());
+  TEST_ASSERT_TRUE(compared_frames > 1500);
+  TEST_ASSERT_TRUE(worst_clock_us <= 1000);
+  TEST_ASSERT_TRUE(worst_render_us <= 1000);
+}
+
+void test_node_sync_follower_renders_leader_frames() {
+  std::unique_ptr<Node> lead(new Node(50000));
+  std::unique_ptr<Node> follow(new Node(1200));
+  lead->manager.set_transition_ms(0);
+  follow->manager.set_transition_ms(0);
+
+  TEST_ASSERT_TRUE(lead->manager.set_active(EffectId{7}, 60000));
+  TEST_ASSERT_TRUE(lead->manager.set_param_raw(EffectId{7}, chromance::core::ParamId(3), 5));
+  chromance::core::EffectParams p;
+  p.brightness = 90;
+  lead->manager.set_global_params(p);
+
+  SyncState st;
+  chromance::core::capture_sync_state(lead->manager, 50, &st);
+  TEST_ASSERT_EQUAL_UINT16(7, st.effect_id);
+  TEST_ASSERT_EQUAL_UINT32(60000, st.effect_start_ms);
+  TEST_ASSERT_TRUE(chromance::core::apply_sync_state(st, follow->manager));
+  TEST_ASSERT_FALSE(chromance::core::apply_sync_state(st, follow->manager));  // idempotent
+  TEST_ASSERT_EQUAL_UINT16(7, follow->manager.active_id().value);
+  TEST_ASSERT_EQUAL_UINT8(90, follow->manager.global_params().brightness);
+
+  // Breathing picks lanes from an RNG seeded at start: the followers' picks match because the start matches.
+  for (uint32_t now = 60000; now < 70000; now += 20) {
+    lead->render(now);
+    follow->render(now);
+    TEST_ASSERT_EQUAL_MEMORY(lead->rgb, follow->rgb, sizeof(lead->rgb));
+  }
+
+  // A restart on the leader moves the seed; the follower restarts with it.
+  lead->manager.restart_active(70001);
+  chromance::core::capture_sync_state(lead->manager, 50, &st);
+  TEST_ASSERT_TRUE(chromance::core::apply_sync_state(st, follow->manager));
+  TEST_ASSERT_EQUAL_UINT32(70001, follow->manager.activated_ms());
+  bool differs_from_old_seed = false;
+  std::unique_ptr<Node> stale(new Node(1200));
+  stale->manager.set_transition_ms(0);
+  (void)stale->manager.set_active(EffectId{7}, 60000);
+  (void)stale->manager.set_param_raw(EffectId{7}, chromance::core::ParamId(3), 5);
+  stale->manager.set_global_params(p);
+  for (uint32_t now = 70020; now < 80000; now += 20) {
+    lead->render(now);
+    follow->render(now);
+    stale->render(now);
+    TEST_ASSERT_EQUAL_MEMORY(lead->rgb, follow->rgb, sizeof(lead->rgb));
+    differs_from_old_seed = differs_from_old_seed || memcmp(lead->rgb, stale->rgb, sizeof(lead->rgb)) != 0;
+  }
+  TEST_ASSERT_TRUE(differs_from_old_seed);
+}
+
+// Same frame budget on both boards, but the follower is idle-clocked (PowerGovernor) and measures three times
+// the leader's render cost. Left to its own plan it would shorten (or cut) the fades the leader runs in full.
+void test_node_sync_follower_crossfades_with_leader_despite_local_frame_costs() {
+  sockaddr_in leader_addr;
+  sockaddr_in follower_addr;
+  const int leader_fd = open_loopback(&leader_addr);
+  const int follower_fd = open_loopback(&follower_addr);
+  TEST_ASSERT_TRUE(leader_fd >= 0 && follower_fd >= 0);
+
+  std::unique_ptr<Node> lead(new Node(50000));
+  std::unique_ptr<Node> follow(new Node(1200));
+  lead->manager.set_frame_budget_us(16000);
+  follow->manager.set_frame_budget_us(16000);
+  SyncLeader leader;
+  SyncFollower follower;
+
+  bool faded = false;
+  for (uint32_t now = 60000; now < 66000; now += 20) {
+    if (now == 62000) {
+      TEST_ASSERT_TRUE(lead->manager.set_active(EffectId{7}, now));
+    }
+    if (now == 64000) {
+      TEST_ASSERT_TRUE(lead->manager.set_active(EffectId{4}, now));
+    }
+    sync_over_loopback(*lead, leader, leader_fd, follower_addr, follower_fd, follower, *follow, now * 1000ULL);
+    lead->render(now);
+    follow->render(now);
+    faded = faded || lead->manager.transitioning();
+    TEST_ASSERT_EQUAL(lead->manager.transitioning(), follow->manager.transitioning());
+    TEST_ASSERT_EQUAL_MEMORY(lead->rgb, follow->rgb, sizeof(lead->rgb));
+    if (now == 62000) {
+      TEST_ASSERT_EQUAL_UINT16(400, follow->manager.fade_ms());  // the leader's full fade
+    }
+    // The second fade runs over the leader's budget for a few frames, and the leader shortens it mid-way.
+    const bool leader_over = now >= 64000 && now < 64060;
+    lead->manager.note_render_us(leader_over ? 20000 : 6000);
+    follow->manager.note_render_us(18000);
+  }
+  close(leader_fd);
+  close(follower_fd);
+
+  TEST_ASSERT_TRUE(faded);
+  TEST_ASSERT_EQUAL_UINT16(4, follow->manager.active_id().value);
+  TEST_ASSERT_EQUAL_UINT32(2, follow->manager.transition_stats().started);
+  TEST_ASSERT_TRUE(lead->manager.transition_stats().shortened > 0);
+  TEST_ASSERT_TRUE(lead->manager.fade_ms() < 400);
+  TEST_ASSERT_EQUAL_UINT16(lead->manager.fade_ms(), follow->manager.fade_ms());
+  TEST_ASSERT_EQUAL_UINT32(0, follow->manager.transition_stats().shortened);
+  TEST_ASSERT_EQUAL_UINT32(0, follow->manager.transition_stats().hard_cuts);
+}
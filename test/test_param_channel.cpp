@@ -0,0 +1,188 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include "core/effects/param_coalescer.h"
+#include "core/protocol/param_frame.h"
+#include "core/protocol/ws_frame.h"
+#include "test_fakes.h"
+
+using chromance::core::EffectCatalog;
+using chromance::core::EffectConfigSchema;
+using chromance::core::EffectDescriptor;
+using chromance::core::EffectId;
+using chromance::core::EffectManager;
+using chromance::core::IEffectV2;
+using chromance::core::ParamCoalescer;
+using chromance::core::ParamDescriptor;
+using chromance::core::ParamId;
+using chromance::core::ParamType;
+using chromance::core::ParamUpdate;
+using chromance::core::ParamValue;
+using chromance::core::PixelsMap;
+using chromance::core::RenderContext;
+using chromance::core::Rgb;
+using chromance::core::WsFrameReader;
+using chromance::core::WsOpcode;
+using chromance::testing::NullSettingsStore;
+
+namespace {
+
+struct ChannelConfig {
+  uint8_t level;
+  uint16_t speed_x100;
+};
+
+const ParamDescriptor kChannelParams[] = {
+    {ParamId{1}, "level", "Level", ParamType::U8, static_cast<uint16_t>(offsetof(ChannelConfig, level)), 1, 0,
+     100, 5, 50, 1},
+    {ParamId{2}, "speed", "Speed", ParamType::U16, static_cast<uint16_t>(offsetof(ChannelConfig, speed_x100)), 2,
+     0, 400, 1, 100, 100},
+};
+
+class ChannelEffect final : public IEffectV2 {
+ public:
+  ChannelEffect() : d_{EffectId{3}, "chan", "Chan", nullptr}, schema_{kChannelParams, 2} {}
+
+  const EffectDescriptor& descriptor() const override { return d_; }
+  const EffectConfigSchema* schema() const override { return &schema_; }
+  void bind_config(const void* bytes, size_t) override {
+    config_ = static_cast<const ChannelConfig*>(bytes);
+    ++bind_calls;
+  }
+  void start(const chromance::core::EventContext&) override {}
+  void reset_runtime(const chromance::core::EventContext&) override {}
+  void render(const RenderContext&, Rgb* out, size_t n) override {
+    for (size_t i = 0; i < n; ++i) out[i] = Rgb{0, 0, 0};
+  }
+
+  const ChannelConfig* config_ = nullptr;
+  uint32_t bind_calls = 0;
+
+ private:
+  EffectDescriptor d_;
+  EffectConfigSchema schema_;
+};
+
+// Builds a masked client->server frame the way a browser would.
+size_t make_client_frame(WsOpcode op, const uint8_t* payload, size_t n, uint8_t* out) {
+  const uint8_t mask[4] = {0x11, 0x22, 0x33, 0x44};
+  size_t pos = 0;
+  out[pos++] = static_cast<uint8_t>(0x80 | static_cast<uint8_t>(op));
+  if (n < 126) {
+    out[pos++] = static_cast<uint8_t>(0x80 | n);
+  } else {
+    out[pos++] = 0x80 | 126;
+    out[pos++] = static_cast<uint8_t>(n >> 8);
+    out[pos++] = static_cast<uint8_t>(n & 0xFF);
+  }
+  memcpy(out + pos, mask, 4);
+  pos += 4;
+  for (size_t i = 0; i < n; ++i) {
+    out[pos++] = static_cast<uint8_t>(payload[i] ^ mask[i & 3]);
+  }
+  return pos;
+}
+
+}  // namespace
+
+void test_param_frame_round_trip_and_rejects_malformed() {
+  const ParamUpdate in[2] = {
+      {EffectId{7}, ParamId{1}, 42},
+      {EffectId{7}, ParamId{300}, -5},
+  };
+  uint8_t buf[32] = {};
+  const size_t n = chromance::core::encode_param_frame(EffectId{7}, in, 2, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_UINT32(16, n);
+
+  ParamUpdate out[4] = {};
+  TEST_ASSERT_EQUAL_INT(2, chromance::core::decode_param_frame(buf, n, out, 4));
+  TEST_ASSERT_EQUAL_UINT16(7, out[0].effect.value);
+  TEST_ASSERT_EQUAL_UINT16(1, out[0].param.value);
+  TEST_ASSERT_EQUAL_INT32(42, out[0].raw);
+  TEST_ASSERT_EQUAL_UINT16(300, out[1].param.value);
+  TEST_ASSERT_EQUAL_INT32(-5, out[1].raw);
+
+  // Truncated frame and wrong message type are rejected.
+  TEST_ASSERT_EQUAL_INT(-1, chromance::core::decode_param_frame(buf, n - 1, out, 4));
+  buf[0] = 0x7F;
+  TEST_ASSERT_EQUAL_INT(-1, chromance::core::decode_param_frame(buf, n, out, 4));
+}
+
+void test_ws_frame_reader_unmasks_split_frames_and_rejects_unmasked() {
+  WsFrameReader<64> r;
+  r.reset();
+
+  const uint8_t payload[5] = {1, 2, 3, 4, 5};
+  uint8_t wire[32] = {};
+  const size_t len = make_client_frame(WsOpcode::kBinary, payload, sizeof(payload), wire);
+
+  // Deliver in two pieces; the first ends mid-mask.
+  size_t used = 0;
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(WsFrameReader<64>::Result::kNeedMore),
+                          static_cast<uint8_t>(r.feed(wire, 4, &used)));
+  TEST_ASSERT_EQUAL_UINT32(4, used);
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(WsFrameReader<64>::Result::kFrame),
+                          static_cast<uint8_t>(r.feed(wire + 4, len - 4, &used)));
+  TEST_ASSERT_EQUAL_UINT32(len - 4, used);
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(WsOpcode::kBinary), static_cast<uint8_t>(r.opcode()));
+  TEST_ASSERT_EQUAL_UINT32(5, r.payload_len());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, r.payload(), 5);
+
+  // Server-style (unmasked) frames from a client are a protocol error.
+  uint8_t bad[8] = {};
+  const size_t hdr = chromance::core::ws_write_header(WsOpcode::kBinary, 3, bad);
+  TEST_ASSERT_EQUAL_UINT32(2, hdr);
+  r.reset();
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(WsFrameReader<64>::Result::kError),
+                          static_cast<uint8_t>(r.feed(bad, hdr + 3, &used)));
+
+  // Oversized payloads are refused before any payload bytes are buffered.
+  uint8_t big[200] = {};
+  uint8_t big_wire[220] = {};
+  const size_t big_len = make_client_frame(WsOpcode::kBinary, big, sizeof(big), big_wire);
+  r.reset();
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(WsFrameReader<64>::Result::kError),
+                          static_cast<uint8_t>(r.feed(big_wire, big_len, &used)));
+}
+
+void test_param_coalescer_last_write_wins_applies_once_per_frame() {
+  NullSettingsStore store;
+  PixelsMap map;
+  ChannelEffect e;
+  EffectCatalog<2> catalog;
+  TEST_ASSERT_TRUE(catalog.add(e.descriptor(), &e));
+  EffectManager<2> mgr;
+  mgr.init(store, catalog, map, 0);
+  const uint32_t binds_after_init = e.bind_calls;
+
+  ParamCoalescer<4> c;
+  // A slider drag: many writes to the same param within one frame.
+  for (int32_t v = 0; v <= 60; v += 5) {
+    TEST_ASSERT_TRUE(c.push(EffectId{3}, ParamId{1}, v));
+  }
+  TEST_ASSERT_TRUE(c.push(EffectId{3}, ParamId{2}, 250));  // 2.50x in raw (scale 100) units
+  TEST_ASSERT_EQUAL_UINT32(2, c.pending());
+  TEST_ASSERT_EQUAL_UINT32(12, c.stats().coalesced);
+
+  TEST_ASSERT_EQUAL_UINT32(2, c.apply(mgr));
+  TEST_ASSERT_EQUAL_UINT32(0, c.pending());
+  TEST_ASSERT_EQUAL_UINT8(60, e.config_->level);
+  TEST_ASSERT_EQUAL_UINT16(250, e.config_->speed_x100);
+  TEST_ASSERT_EQUAL_UINT32(binds_after_init + 2, e.bind_calls);
+
+  // Off-step and out-of-range raw values are rejected by the manager, not applied.
+  TEST_ASSERT_TRUE(c.push(EffectId{3}, ParamId{1}, 61));
+  TEST_ASSERT_TRUE(c.push(EffectId{3}, ParamId{2}, 401));
+  TEST_ASSERT_EQUAL_UINT32(0, c.apply(mgr));
+  TEST_ASSERT_EQUAL_UINT32(2, c.stats().rejected);
+  TEST_ASSERT_EQUAL_UINT8(60, e.config_->level);
+
+  // Distinct keys beyond capacity are dropped (and counted) instead of evicting pending writes.
+  ParamCoalescer<1> tiny;
+  TEST_ASSERT_TRUE(tiny.push(EffectId{3}, ParamId{1}, 10));
+  TEST_ASSERT_FALSE(tiny.push(EffectId{3}, ParamId{2}, 10));
+  TEST_ASSERT_EQUAL_UINT32(1, tiny.stats().dropped);
+}
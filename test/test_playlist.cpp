@@ -0,0 +1,410 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include "core/effects/effect_manager.h"
+#include "core/effects/playlist.h"
+
+using chromance::core::EffectCatalog;
+using chromance::core::EffectConfigSchema;
+using chromance::core::EffectDescriptor;
+using chromance::core::EffectId;
+using chromance::core::EffectManager;
+using chromance::core::EventContext;
+using chromance::core::IEffectV2;
+using chromance::core::ISettingsStore;
+using chromance::core::ParamDescriptor;
+using chromance::core::ParamId;
+using chromance::core::ParamType;
+using chromance::core::PixelsMap;
+using chromance::core::PlaylistConfig;
+using chromance::core::PlaylistScheduler;
+using chromance::core::RenderContext;
+using chromance::core::Rgb;
+
+namespace {
+
+// Records what the scheduler asks of the effect manager.
+struct FakeManager {
+  uint16_t active = 0;
+  uint16_t transition = 500;
+  uint16_t last_transition_used = 0;
+  uint32_t activations = 0;
+  uint16_t missing = 0;  // effect id that "is not in the catalog"
+  uint16_t prepared = 0;
+  uint32_t prepares = 0;
+  uint16_t param_effect = 0;
+  uint16_t param_id = 0;
+  int32_t param_raw = 0;
+  uint16_t overlaid = 0;  // effect currently holding an overlay (one at a time is enough here)
+  uint32_t overlay_clears = 0;
+  bool fading = false;
+
+  bool set_active(EffectId id, uint32_t /*now_ms*/) {
+    if (id.value == missing) return false;
+    active = id.value;
+    last_transition_used = transition;
+    ++activations;
+    return true;
+  }
+  bool overlay_param_raw(EffectId id, ParamId pid, int32_t raw) {
+    param_effect = id.value;
+    param_id = pid.value;
+    param_raw = raw;
+    overlaid = id.value;
+    return true;
+  }
+  bool clear_overlay(EffectId id) {
+    if (overlaid != id.value) return false;
+    overlaid = 0;
+    ++overlay_clears;
+    return true;
+  }
+  bool transitioning() const { return fading; }
+  uint16_t transition_ms() const { return transition; }
+  void set_transition_ms(uint16_t ms) { transition = ms; }
+  bool prepare_effect(EffectId id, uint32_t /*now_ms*/) {
+    prepared = id.value;
+    ++prepares;
+    return true;
+  }
+};
+
+class MemoryStore final : public ISettingsStore {
+ public:
+  bool read_blob(const char* key, void* out, size_t out_size) const override {
+    if (strcmp(key, chromance::core::kPlaylistStoreKey) != 0 || size_ != out_size) return false;
+    memcpy(out, bytes_, out_size);
+    return true;
+  }
+  bool write_blob(const char* key, const void* data, size_t size) override {
+    ++writes;
+    if (fail || strcmp(key, chromance::core::kPlaylistStoreKey) != 0 || size > sizeof(bytes_)) return false;
+    memcpy(bytes_, data, size);
+    size_ = size;
+    return true;
+  }
+
+  bool fail = false;
+  uint32_t writes = 0;
+
+ private:
+  uint8_t bytes_[512] = {};
+  size_t size_ = 0;
+};
+
+PlaylistConfig three_entries() {
+  PlaylistConfig c;
+  memset(&c, 0, sizeof(c));
+  c.version = chromance::core::kPlaylistConfigVersion;
+  c.count = 3;
+  c.entries[0].effect_id = 4;
+  c.entries[0].duration_s = 10;
+  c.entries[0].transition_ms = chromance::core::kPlaylistDefaultTransition;
+  c.entries[1].effect_id = 7;
+  c.entries[1].duration_s = 20;
+  c.entries[1].transition_ms = 1500;
+  c.entries[1].param_count = 1;
+  c.entries[1].params[0].id = 3;
+  c.entries[1].params[0].raw = 12;
+  c.entries[2].effect_id = 6;
+  c.entries[2].duration_s = 5;
+  c.entries[2].transition_ms = 0;
+  return c;
+}
+
+}  // namespace
+
+void test_playlist_sequences_entries_with_transitions_and_params() {
+  FakeManager m;
+  PlaylistScheduler p;
+  TEST_ASSERT_TRUE(p.set_config(three_entries(), 0));
+  TEST_ASSERT_TRUE(p.start(1000, m));
+  TEST_ASSERT_EQUAL_UINT16(4, m.active);
+  TEST_ASSERT_EQUAL_UINT16(500, m.last_transition_used);  // manager default kept
+  TEST_ASSERT_EQUAL_UINT32(10000, p.remaining_ms(1000));
+
+  p.tick(10999, m);
+  TEST_ASSERT_EQUAL_UINT16(4, m.active);
+  // Boundary serviced 30 ms late: the next entry still ends on the nominal grid.
+  p.tick(11030, m);
+  TEST_ASSERT_EQUAL_UINT16(7, m.active);
+  TEST_ASSERT_EQUAL_UINT8(1, p.index());
+  TEST_ASSERT_EQUAL_UINT16(1500, m.last_transition_used);
+  TEST_ASSERT_EQUAL_UINT16(500, m.transition);  // restored after the switch
+  TEST_ASSERT_EQUAL_UINT16(7, m.param_effect);
+  TEST_ASSERT_EQUAL_UINT16(3, m.param_id);
+  TEST_ASSERT_EQUAL_INT32(12, m.param_raw);
+  TEST_ASSERT_EQUAL_UINT16(7, m.overlaid);
+  TEST_ASSERT_EQUAL_UINT32(20000 - 30, p.remaining_ms(11030));
+
+  // The snapshot outlives its entry only while the outgoing effect is still fading.
+  m.fading = true;
+  p.tick(31000, m);
+  TEST_ASSERT_EQUAL_UINT16(6, m.active);
+  TEST_ASSERT_EQUAL_UINT16(7, m.overlaid);
+  m.fading = false;
+  p.tick(31016, m);
+  TEST_ASSERT_EQUAL_UINT16(0, m.overlaid);
+  TEST_ASSERT_EQUAL_UINT16(0, m.last_transition_used);  // hard cut
+  p.tick(36000, m);
+  TEST_ASSERT_EQUAL_UINT16(4, m.active);  // loops
+  TEST_ASSERT_EQUAL_UINT32(4, m.activations);
+}
+
+void test_playlist_prewarms_next_effect_once_before_boundary() {
+  FakeManager m;
+  PlaylistScheduler p;
+  TEST_ASSERT_TRUE(p.set_config(three_entries(), 0));
+  TEST_ASSERT_TRUE(p.start(0, m));
+  TEST_ASSERT_FALSE(p.prewarm(7999, m));  // boundary at 10 s, lead 2 s
+  TEST_ASSERT_EQUAL_UINT32(0, m.prepares);
+  TEST_ASSERT_TRUE(p.prewarm(8000, m));
+  TEST_ASSERT_EQUAL_UINT16(7, m.prepared);
+  TEST_ASSERT_FALSE(p.prewarm(8500, m));
+  TEST_ASSERT_EQUAL_UINT32(1, m.prepares);
+
+  p.tick(10000, m);
+  TEST_ASSERT_TRUE(p.prewarm(28000, m));
+  TEST_ASSERT_EQUAL_UINT16(6, m.prepared);
+}
+
+void test_playlist_skips_missing_effects_and_holds_untimed_entries() {
+  FakeManager m;
+  m.missing = 7;
+  PlaylistConfig c = three_entries();
+  c.entries[2].duration_s = 0;
+  PlaylistScheduler p;
+  TEST_ASSERT_TRUE(p.set_config(c, 0));
+  TEST_ASSERT_TRUE(p.start(0, m));
+  p.tick(10000, m);
+  TEST_ASSERT_EQUAL_UINT16(6, m.active);  // entry 1 skipped
+  TEST_ASSERT_EQUAL_UINT8(2, p.index());
+  TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFU, p.remaining_ms(10000));
+  p.tick(1000000, m);
+  TEST_ASSERT_EQUAL_UINT16(6, m.active);  // held
+  TEST_ASSERT_TRUE(p.next(1000000, m));
+  TEST_ASSERT_EQUAL_UINT16(4, m.active);
+
+  // Nothing playable: the show stops.
+  m.missing = 4;
+  PlaylistConfig only;
+  memset(&only, 0, sizeof(only));
+  only.version = chromance::core::kPlaylistConfigVersion;
+  only.count = 1;
+  only.entries[0].effect_id = 4;
+  TEST_ASSERT_TRUE(p.set_config(only, 0));
+  TEST_ASSERT_FALSE(p.start(0, m));
+  TEST_ASSERT_FALSE(p.running());
+
+  // Invalid configs are rejected without touching the current one.
+  PlaylistConfig bad = three_entries();
+  bad.entries[1].effect_id = 0;
+  TEST_ASSERT_FALSE(p.set_config(bad, 0));
+  bad = three_entries();
+  bad.count = chromance::core::kMaxPlaylistEntries + 1;
+  TEST_ASSERT_FALSE(p.set_config(bad, 0));
+  TEST_ASSERT_EQUAL_UINT8(1, p.config().count);
+}
+
+void test_playlist_persists_entries_and_running_state() {
+  FakeManager m;
+  MemoryStore store;
+  PlaylistScheduler p;
+  TEST_ASSERT_TRUE(p.set_config(three_entries(), 1000));
+  TEST_ASSERT_TRUE(p.start(1000, m));
+  p.persist(1200, store);
+  TEST_ASSERT_EQUAL_UINT32(0, store.writes);  // debounced
+  store.fail = true;
+  p.persist(1500, store);
+  TEST_ASSERT_EQUAL_UINT32(1, store.writes);
+  TEST_ASSERT_TRUE(p.dirty());
+  store.fail = false;
+  p.persist(1600, store);
+  TEST_ASSERT_EQUAL_UINT32(1, store.writes);  // backing off
+  p.persist(2000, store);
+  TEST_ASSERT_EQUAL_UINT32(2, store.writes);
+  TEST_ASSERT_FALSE(p.dirty());
+
+  // Entry switches alone do not rewrite the playlist.
+  p.tick(11000, m);
+  p.persist(20000, store);
+  TEST_ASSERT_EQUAL_UINT32(2, store.writes);
+
+  PlaylistScheduler restored;
+  TEST_ASSERT_TRUE(restored.load(store));  // was running: resume
+  TEST_ASSERT_EQUAL_UINT8(3, restored.config().count);
+  TEST_ASSERT_EQUAL_INT32(12, restored.config().entries[1].params[0].raw);
+
+  restored.stop(30000);
+  restored.persist(30000, store, /*force=*/true);
+  PlaylistScheduler again;
+  TEST_ASSERT_FALSE(again.load(store));  // stopped by hand: stays stopped
+  TEST_ASSERT_EQUAL_UINT8(3, again.config().count);
+}
+
+namespace {
+
+struct SpeedConfig {
+  uint8_t speed;
+};
+
+const ParamDescriptor kSpeedParams[] = {
+    {ParamId(1), "speed", "Speed", ParamType::U8, 0, 1, 0, 255, 1, 10, 1},
+};
+
+class PreparedEffect final : public IEffectV2 {
+ public:
+  explicit PreparedEffect(EffectDescriptor d) : d_(d), schema_{kSpeedParams, 1} {}
+  const EffectDescriptor& descriptor() const override { return d_; }
+  const EffectConfigSchema* schema() const override { return &schema_; }
+  void bind_config(const void* bytes, size_t /*size*/) override {
+    cfg = static_cast<const SpeedConfig*>(bytes);
+    ++binds;
+  }
+  bool needs_prepare() const override { return !prepared; }
+  void prepare(const EventContext& /*ctx*/) override { prepared = true; }
+  void start(const EventContext& /*ctx*/) override { speed_at_start = cfg ? cfg->speed : 0; }
+  void reset_runtime(const EventContext& /*ctx*/) override {}
+  void render(const RenderContext& /*ctx*/, Rgb* out, size_t n) override {
+    for (size_t i = 0; i < n; ++i) out[i] = Rgb{0, 0, 0};
+  }
+
+  const SpeedConfig* cfg = nullptr;
+  bool prepared = false;
+  uint32_t binds = 0;
+  uint8_t speed_at_start = 0;
+
+ private:
+  EffectDescriptor d_;
+  EffectConfigSchema schema_;
+};
+
+class CountingStore final : public ISettingsStore {
+ public:
+  bool read_blob(const char*, void*, size_t) const override { return false; }
+  bool write_blob(const char* key, const void*, size_t) override {
+    if (key[0] == 'e') ++config_writes;
+    return true;
+  }
+  uint32_t config_writes = 0;
+};
+
+}  // namespace
+
+void test_playlist_drives_effect_manager_without_persisting_snapshots() {
+  static const EffectDescriptor kA{EffectId{1}, "a", "A", nullptr};
+  static const EffectDescriptor kB{EffectId{2}, "b", "B", nullptr};
+  static PreparedEffect a(kA);
+  static PreparedEffect b(kB);
+  static EffectCatalog<4> catalog;
+  static EffectManager<4, 8> manager;
+  TEST_ASSERT_TRUE(catalog.add(kA, &a));
+  TEST_ASSERT_TRUE(catalog.add(kB, &b));
+  CountingStore store;
+  PixelsMap map;
+  manager.init(store, catalog, map, 0, EffectId{1});
+  manager.tick(1000, 16, chromance::core::Signals{});  // first-boot defaults written once
+  const uint32_t writes = store.config_writes;
+
+  PlaylistConfig c;
+  memset(&c, 0, sizeof(c));
+  c.version = chromance::core::kPlaylistConfigVersion;
+  c.count = 2;
+  c.entries[0].effect_id = 1;
+  c.entries[0].duration_s = 4;
+  c.entries[0].transition_ms = chromance::core::kPlaylistDefaultTransition;
+  c.entries[1].effect_id = 2;
+  c.entries[1].duration_s = 4;
+  c.entries[1].transition_ms = chromance::core::kPlaylistDefaultTransition;
+  c.entries[1].param_count = 1;
+  c.entries[1].params[0].id = 1;
+  c.entries[1].params[0].raw = 42;
+
+  PlaylistScheduler p;
+  TEST_ASSERT_TRUE(p.set_config(c, 0));
+  TEST_ASSERT_TRUE(p.start(0, manager));
+  TEST_ASSERT_FALSE(b.prepared);
+  TEST_ASSERT_TRUE(p.prewarm(2000, manager));
+  TEST_ASSERT_TRUE(b.prepared);  // warmed before its boundary, not inside set_active()
+
+  p.tick(4000, manager);
+  TEST_ASSERT_EQUAL_UINT16(2, manager.active_id().value);
+  TEST_ASSERT_EQUAL_UINT8(42, b.speed_at_start);
+  TEST_ASSERT_TRUE(manager.has_overlay(EffectId{2}));
+  manager.tick(10000, 16, chromance::core::Signals{});
+  TEST_ASSERT_EQUAL_UINT32(writes, store.config_writes);
+
+  // Leaving the entry puts the stored config back.
+  p.tick(8000, manager);
+  TEST_ASSERT_EQUAL_UINT16(1, manager.active_id().value);
+  p.tick(8016, manager);
+  TEST_ASSERT_FALSE(manager.has_overlay(EffectId{2}));
+  TEST_ASSERT_EQUAL_UINT8(10, b.cfg->speed);
+
+  // So does stopping the show in the middle of an entry.
+  p.tick(12000, manager);
+  TEST_ASSERT_EQUAL_UINT8(42, b.cfg->speed);
+  p.stop(12500);
+  p.tick(12516, manager);
+  TEST_ASSERT_EQUAL_UINT8(10, b.cfg->speed);
+  manager.tick(20000, 16, chromance::core::Signals{});
+  TEST_ASSERT_EQUAL_UINT32(writes, store.config_writes);
+}
+
+void test_playlist_alternating_snapshots_of_one_effect_never_write_its_config() {
+  static const EffectDescriptor kA{EffectId{1}, "a", "A", nullptr};
+  static PreparedEffect a(kA);
+  static EffectCatalog<4> catalog;
+  static EffectManager<4, 8> manager;
+  TEST_ASSERT_TRUE(catalog.add(kA, &a));
+  CountingStore store;
+  PixelsMap map;
+  manager.init(store, catalog, map, 0, EffectId{1});
+  manager.tick(1000, 16, chromance::core::Signals{});
+  const uint32_t writes = store.config_writes;
+
+  // Breathing fast, then Breathing slow: same effect, different snapshots.
+  PlaylistConfig c;
+  memset(&c, 0, sizeof(c));
+  c.version = chromance::core::kPlaylistConfigVersion;
+  c.count = 2;
+  for (uint8_t i = 0; i < 2; ++i) {
+    c.entries[i].effect_id = 1;
+    c.entries[i].duration_s = 2;
+    c.entries[i].transition_ms = chromance::core::kPlaylistDefaultTransition;
+    c.entries[i].param_count = 1;
+    c.entries[i].params[0].id = 1;
+  }
+  c.entries[0].params[0].raw = 200;
+  c.entries[1].params[0].raw = 20;
+
+  PlaylistScheduler p;
+  TEST_ASSERT_TRUE(p.set_config(c, 0));
+  TEST_ASSERT_TRUE(p.start(2000, manager));
+  uint32_t now = 2000;
+  for (uint8_t lap = 0; lap < 5; ++lap) {
+    TEST_ASSERT_EQUAL_UINT8(200, a.cfg->speed);
+    now += 2000;
+    p.tick(now, manager);
+    TEST_ASSERT_EQUAL_UINT8(20, a.cfg->speed);
+    TEST_ASSERT_EQUAL_UINT8(20, a.speed_at_start);
+    manager.tick(now + 1000, 16, chromance::core::Signals{});  // well past the persist debounce
+    now += 2000;
+    p.tick(now, manager);
+    manager.tick(now + 1000, 16, chromance::core::Signals{});
+  }
+  TEST_ASSERT_EQUAL_UINT32(writes, store.config_writes);
+
+  // A hand edit during the show is persisted and shows at once; the show's own value is not.
+  TEST_ASSERT_TRUE(manager.set_param_raw(EffectId{1}, ParamId(1), 77));
+  TEST_ASSERT_EQUAL_UINT8(77, a.cfg->speed);
+  manager.tick(now + 2000, 16, chromance::core::Signals{});
+  TEST_ASSERT_EQUAL_UINT32(writes + 1, store.config_writes);
+  p.stop(now + 2000);
+  p.tick(now + 2016, manager);
+  TEST_ASSERT_FALSE(manager.has_overlay(EffectId{1}));
+  TEST_ASSERT_EQUAL_UINT8(77, a.cfg->speed);
+}
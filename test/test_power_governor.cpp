@@ -0,0 +1,110 @@
+#include <unity.h>
+
+#include "core/power_governor.h"
+
+using chromance::core::PowerDecision;
+using chromance::core::PowerGovernor;
+using chromance::core::PowerInputs;
+
+namespace {
+
+PowerInputs busy_frame_load(uint16_t occupancy) {
+  PowerInputs in;
+  in.occupancy_permille = occupancy;
+  in.rendered_fps = 60;
+  return in;
+}
+
+}  // namespace
+
+void test_power_governor_steps_down_after_dwell_and_up_on_load() {
+  PowerGovernor g;
+  g.begin(0);
+  TEST_ASSERT_EQUAL_UINT16(240, g.decision().cpu_mhz);
+
+  // Light load, but still settling after boot.
+  TEST_ASSERT_EQUAL_UINT16(240, g.update(1000, busy_frame_load(100)).cpu_mhz);
+  // 100 permille at 240 MHz projects to 150 at 160 MHz: below the step-down threshold, dwell starts.
+  TEST_ASSERT_EQUAL_UINT16(240, g.update(1500, busy_frame_load(100)).cpu_mhz);
+  TEST_ASSERT_EQUAL_UINT16(240, g.update(4000, busy_frame_load(100)).cpu_mhz);
+  TEST_ASSERT_EQUAL_UINT16(160, g.update(4500, busy_frame_load(100)).cpu_mhz);
+  TEST_ASSERT_FALSE(g.decision().modem_sleep);
+
+  // A load spike during the settle period is ignored; afterwards it steps straight back up.
+  TEST_ASSERT_EQUAL_UINT16(160, g.update(5000, busy_frame_load(900)).cpu_mhz);
+  TEST_ASSERT_EQUAL_UINT16(240, g.update(6000, busy_frame_load(900)).cpu_mhz);
+  TEST_ASSERT_EQUAL_UINT32(2, g.stats().cpu_changes);
+
+  // Moderate load whose projection at the lower clock crosses the threshold stays put.
+  for (uint32_t t = 8000; t <= 20000; t += 500) {
+    TEST_ASSERT_EQUAL_UINT16(240, g.update(t, busy_frame_load(400)).cpu_mhz);
+  }
+
+  // A dwell interrupted by one heavier window starts over.
+  g.update(21000, busy_frame_load(100));
+  g.update(23000, busy_frame_load(400));
+  TEST_ASSERT_EQUAL_UINT16(240, g.update(24500, busy_frame_load(100)).cpu_mhz);
+  TEST_ASSERT_EQUAL_UINT16(160, g.update(27500, busy_frame_load(100)).cpu_mhz);
+}
+
+void test_power_governor_sleeps_when_dark_or_slow_and_wakes_for_links() {
+  PowerGovernor g;
+  g.begin(0);
+
+  PowerInputs dark = busy_frame_load(50);
+  dark.brightness = 0;
+  PowerDecision d = g.update(100, dark);
+  TEST_ASSERT_EQUAL_UINT16(80, d.cpu_mhz);
+  TEST_ASSERT_TRUE(d.modem_sleep);
+
+  // Web/OTA activity overrides everything, immediately.
+  PowerInputs link = dark;
+  link.link_busy = true;
+  d = g.update(200, link);
+  TEST_ASSERT_EQUAL_UINT16(240, d.cpu_mhz);
+  TEST_ASSERT_FALSE(d.modem_sleep);
+  PowerInputs ota = dark;
+  ota.ota_active = true;
+  TEST_ASSERT_EQUAL_UINT16(240, g.update(300, ota).cpu_mhz);
+
+  // Slow animation: modem sleep, clock still chosen by load.
+  PowerInputs slow = busy_frame_load(50);
+  slow.rendered_fps = 1;
+  d = g.update(400, slow);
+  TEST_ASSERT_TRUE(d.modem_sleep);
+  TEST_ASSERT_EQUAL_UINT16(240, d.cpu_mhz);
+  TEST_ASSERT_FALSE(g.update(500, busy_frame_load(50)).modem_sleep);
+
+  g.set_enabled(false);
+  d = g.update(600, dark);
+  TEST_ASSERT_EQUAL_UINT16(240, d.cpu_mhz);
+  TEST_ASSERT_FALSE(d.modem_sleep);
+}
+
+void test_power_governor_accounts_time_and_frame_cost_per_step() {
+  PowerGovernor g;
+  g.begin(0);
+  TEST_ASSERT_EQUAL_UINT32(PowerGovernor::cpu_ma_for(2) + PowerGovernor::kRadioAwakeMa, g.estimated_ma());
+
+  g.note_frame_us(4000, 16000);
+  g.note_frame_us(17000, 16000);
+  PowerInputs dark;
+  dark.brightness = 0;
+  g.update(1000, dark);  // 1 s at 240 MHz, radio awake
+  g.note_frame_us(9000, 16000);
+  g.update(4000, dark);  // 3 s at 80 MHz, modem sleep
+
+  const auto& st = g.stats();
+  TEST_ASSERT_EQUAL_UINT32(1000, st.steps[2].time_ms);
+  TEST_ASSERT_EQUAL_UINT32(3000, st.steps[0].time_ms);
+  TEST_ASSERT_EQUAL_UINT32(3000, st.modem_sleep_ms);
+  TEST_ASSERT_EQUAL_UINT32(17000, st.steps[2].max_frame_us);
+  TEST_ASSERT_EQUAL_UINT32(1, st.steps[2].late_frames);
+  TEST_ASSERT_EQUAL_UINT32(9000, st.steps[0].max_frame_us);
+  TEST_ASSERT_EQUAL_UINT32(1, st.sleep_changes);
+
+  const uint32_t expected = (1000U * (PowerGovernor::cpu_ma_for(2) + PowerGovernor::kRadioAwakeMa) +
+                             3000U * (PowerGovernor::cpu_ma_for(0) + PowerGovernor::kRadioModemSleepMa)) /
+                            4000U;
+  TEST_ASSERT_EQUAL_UINT32(expected, g.estimated_ma());
+}
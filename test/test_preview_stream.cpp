@@ -0,0 +1,118 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unity.h>
+
+#include "core/protocol/frame_delta.h"
+#include "core/protocol/preview_rate.h"
+
+using chromance::core::FrameDeltaEncoder;
+using chromance::core::PreviewRateController;
+using chromance::core::Rgb;
+
+namespace {
+
+constexpr size_t kN = 200;
+
+bool frames_equal(const Rgb* a, const Rgb* b, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    if (!chromance::core::rgb_equal(a[i], b[i])) return false;
+  }
+  return true;
+}
+
+uint32_t lcg(uint32_t* s) {
+  *s = *s * 1664525u + 1013904223u;
+  return *s >> 8;
+}
+
+}  // namespace
+
+void test_frame_delta_round_trips_and_compresses_sparse_frames() {
+  static FrameDeltaEncoder<kN> enc;
+  static Rgb frame[kN];
+  static Rgb mirror[kN];
+  static uint8_t buf[chromance::core::preview_max_encoded_size(kN)];
+
+  // Mostly black keyframe with two dots: tiny.
+  frame[10] = Rgb{255, 0, 0};
+  frame[150] = Rgb{0, 0, 255};
+  size_t len = enc.encode(frame, kN, buf, sizeof(buf));
+  TEST_ASSERT_TRUE(len > 0);
+  TEST_ASSERT_TRUE(len < 32);
+  TEST_ASSERT_EQUAL_UINT8(chromance::core::kPreviewFlagKeyframe, buf[1]);
+  TEST_ASSERT_TRUE(chromance::core::decode_preview_frame(buf, len, mirror, kN));
+  TEST_ASSERT_TRUE(frames_equal(frame, mirror, kN));
+
+  // Dots move by one pixel: delta touches only four pixels.
+  frame[10] = Rgb{0, 0, 0};
+  frame[11] = Rgb{255, 0, 0};
+  frame[150] = Rgb{0, 0, 0};
+  frame[151] = Rgb{0, 0, 255};
+  len = enc.encode(frame, kN, buf, sizeof(buf));
+  TEST_ASSERT_TRUE(len < 32);
+  TEST_ASSERT_EQUAL_UINT8(0, buf[1]);
+  TEST_ASSERT_EQUAL_UINT8(1, buf[2]);  // sequence advanced
+  TEST_ASSERT_TRUE(chromance::core::decode_preview_frame(buf, len, mirror, kN));
+  TEST_ASSERT_TRUE(frames_equal(frame, mirror, kN));
+
+  // Unchanged frame: skips only.
+  len = enc.encode(frame, kN, buf, sizeof(buf));
+  TEST_ASSERT_TRUE(len <= chromance::core::kPreviewHeaderBytes + 4);
+  TEST_ASSERT_TRUE(chromance::core::decode_preview_frame(buf, len, mirror, kN));
+  TEST_ASSERT_TRUE(frames_equal(frame, mirror, kN));
+
+  // Noise frames stay within the advertised bound and still round-trip.
+  uint32_t seed = 1234;
+  for (int f = 0; f < 20; ++f) {
+    for (size_t i = 0; i < kN; ++i) {
+      const uint32_t r = lcg(&seed);
+      if ((r & 3) == 0) continue;  // leave some pixels unchanged
+      frame[i] = Rgb{static_cast<uint8_t>(r), static_cast<uint8_t>(r >> 8), static_cast<uint8_t>((r >> 4) & 1)};
+    }
+    len = enc.encode(frame, kN, buf, sizeof(buf));
+    TEST_ASSERT_TRUE(len > 0);
+    TEST_ASSERT_TRUE(len <= sizeof(buf));
+    TEST_ASSERT_TRUE(chromance::core::decode_preview_frame(buf, len, mirror, kN));
+    TEST_ASSERT_TRUE(frames_equal(frame, mirror, kN));
+  }
+
+  // A too-small buffer fails without advancing state; the next delta still decodes against the mirror.
+  frame[0] = Rgb{1, 2, 3};
+  TEST_ASSERT_EQUAL_UINT32(0, enc.encode(frame, kN, buf, 8));
+  len = enc.encode(frame, kN, buf, sizeof(buf));
+  TEST_ASSERT_TRUE(chromance::core::decode_preview_frame(buf, len, mirror, kN));
+  TEST_ASSERT_TRUE(frames_equal(frame, mirror, kN));
+}
+
+void test_preview_rate_backs_off_under_backpressure_and_recovers() {
+  PreviewRateController rc;
+  TEST_ASSERT_FALSE(rc.due(0, false));  // disabled until a client subscribes
+
+  rc.set_target_fps(20, 0);  // 50ms
+  TEST_ASSERT_TRUE(rc.due(0, false));
+  rc.on_frame_queued(0);
+  TEST_ASSERT_FALSE(rc.due(49, false));
+  TEST_ASSERT_TRUE(rc.due(50, false));
+
+  // Slot comes due while the previous frame is still draining: skip and double the interval.
+  TEST_ASSERT_FALSE(rc.due(50, true));
+  TEST_ASSERT_EQUAL_UINT8(2, rc.backoff());
+  TEST_ASSERT_EQUAL_UINT32(100, rc.interval_ms());
+  TEST_ASSERT_FALSE(rc.due(149, false));
+  TEST_ASSERT_FALSE(rc.due(150, true));
+  TEST_ASSERT_EQUAL_UINT8(4, rc.backoff());
+  TEST_ASSERT_EQUAL_UINT32(2, rc.skipped());
+
+  for (int i = 0; i < 40; ++i) {
+    (void)rc.due(150 + 1000 * static_cast<uint32_t>(i), true);
+  }
+  TEST_ASSERT_EQUAL_UINT8(PreviewRateController::kMaxBackoff, rc.backoff());
+
+  // Clean drains step the rate back up.
+  for (int i = 0; i < PreviewRateController::kRecoverAfter; ++i) rc.on_frame_drained();
+  TEST_ASSERT_EQUAL_UINT8(PreviewRateController::kMaxBackoff / 2, rc.backoff());
+
+  rc.set_target_fps(0, 0);
+  TEST_ASSERT_FALSE(rc.enabled());
+}
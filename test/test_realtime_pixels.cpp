@@ -0,0 +1,312 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <unity.h>
+
+#include "core/protocol/realtime_pixels.h"
+
+using chromance::core::RealtimeConfig;
+using chromance::core::RealtimeFramebuffer;
+using chromance::core::RealtimeLayout;
+using chromance::core::RealtimeProtocol;
+using chromance::core::RealtimeReceiver;
+using chromance::core::Rgb;
+
+namespace {
+
+size_t make_ddp(uint8_t* out, uint8_t seq, bool push, uint32_t offset, const uint8_t* data, uint16_t n) {
+  out[0] = static_cast<uint8_t>(0x40 | (push ? 0x01 : 0x00));
+  out[1] = seq;
+  out[2] = 0x0B;  // RGB, 8 bit
+  out[3] = 0x01;
+  out[4] = static_cast<uint8_t>(offset >> 24);
+  out[5] = static_cast<uint8_t>(offset >> 16);
+  out[6] = static_cast<uint8_t>(offset >> 8);
+  out[7] = static_cast<uint8_t>(offset);
+  out[8] = static_cast<uint8_t>(n >> 8);
+  out[9] = static_cast<uint8_t>(n);
+  memcpy(out + 10, data, n);
+  return 10U + n;
+}
+
+size_t make_e131(uint8_t* out, uint16_t universe, uint8_t seq, uint16_t sync, const uint8_t* data, uint16_t n) {
+  memset(out, 0, 126);
+  out[1] = 0x10;
+  memcpy(out + 4, "ASC-E1.17\0\0\0", 12);
+  out[21] = 0x04;
+  out[43] = 0x02;
+  out[108] = 100;
+  out[109] = static_cast<uint8_t>(sync >> 8);
+  out[110] = static_cast<uint8_t>(sync);
+  out[111] = seq;
+  out[113] = static_cast<uint8_t>(universe >> 8);
+  out[114] = static_cast<uint8_t>(universe);
+  out[117] = 0x02;
+  out[118] = 0xA1;
+  out[122] = 0x01;
+  out[123] = static_cast<uint8_t>((n + 1) >> 8);
+  out[124] = static_cast<uint8_t>(n + 1);
+  memcpy(out + 126, data, n);
+  return 126U + n;
+}
+
+size_t make_e131_sync(uint8_t* out, uint16_t sync) {
+  memset(out, 0, 49);
+  out[1] = 0x10;
+  memcpy(out + 4, "ASC-E1.17\0\0\0", 12);
+  out[21] = 0x08;
+  out[43] = 0x01;
+  out[45] = static_cast<uint8_t>(sync >> 8);
+  out[46] = static_cast<uint8_t>(sync);
+  return 49;
+}
+
+size_t make_artnet(uint8_t* out, uint16_t opcode, uint16_t universe, uint8_t seq, const uint8_t* data, uint16_t n) {
+  memset(out, 0, 18);
+  memcpy(out, "Art-Net\0", 8);
+  out[8] = static_cast<uint8_t>(opcode);
+  out[9] = static_cast<uint8_t>(opcode >> 8);
+  out[11] = 14;
+  if (opcode != 0x5000) return 14;
+  out[12] = seq;
+  out[14] = static_cast<uint8_t>(universe);
+  out[15] = static_cast<uint8_t>(universe >> 8);
+  out[16] = static_cast<uint8_t>(n >> 8);
+  out[17] = static_cast<uint8_t>(n);
+  memcpy(out + 18, data, n);
+  return 18U + n;
+}
+
+}  // namespace
+
+void test_realtime_ddp_writes_global_index_and_times_out() {
+  static Rgb fb[200];
+  RealtimeFramebuffer f;
+  f.pixels = fb;
+  f.count = 200;
+  RealtimeConfig cfg;
+  cfg.timeout_ms = 1000;
+  RealtimeReceiver rx;
+  rx.begin(f, cfg);
+  TEST_ASSERT_EQUAL_UINT32(600, rx.channel_count());
+  TEST_ASSERT_FALSE(rx.active(0));
+
+  uint8_t payload[300];
+  for (size_t i = 0; i < sizeof(payload); ++i) payload[i] = static_cast<uint8_t>(i);
+  uint8_t pkt[400];
+
+  // First half, no push: written but not yet a frame.
+  size_t len = make_ddp(pkt, 1, false, 0, payload, 300);
+  TEST_ASSERT_TRUE(rx.on_packet(RealtimeProtocol::kDdp, pkt, len, 100));
+  TEST_ASSERT_TRUE(rx.active(100));
+  TEST_ASSERT_FALSE(rx.take_frame());
+  TEST_ASSERT_EQUAL_UINT8(3, fb[1].r);
+  TEST_ASSERT_EQUAL_UINT8(5, fb[1].b);
+
+  // Second half with push, one sequence number skipped.
+  len = make_ddp(pkt, 3, true, 300, payload, 300);
+  TEST_ASSERT_TRUE(rx.on_packet(RealtimeProtocol::kDdp, pkt, len, 104));
+  TEST_ASSERT_TRUE(rx.take_frame());
+  TEST_ASSERT_FALSE(rx.take_frame());
+  TEST_ASSERT_EQUAL_UINT8(0, fb[100].r);
+  TEST_ASSERT_EQUAL_UINT8(1, fb[100].g);
+  TEST_ASSERT_EQUAL_UINT32(1, rx.stats().frames);
+  TEST_ASSERT_EQUAL_UINT32(1, rx.stats().lost);
+  TEST_ASSERT_EQUAL_UINT16(4, rx.stats().last_assembly_ms);
+  rx.on_frame_shown(110);
+  TEST_ASSERT_EQUAL_UINT16(6, rx.stats().last_display_ms);
+
+  // Sequence wraps 15 -> 1 without counting loss.
+  len = make_ddp(pkt, 15, true, 0, payload, 3);
+  (void)rx.on_packet(RealtimeProtocol::kDdp, pkt, len, 120);
+  len = make_ddp(pkt, 1, true, 0, payload, 3);
+  (void)rx.on_packet(RealtimeProtocol::kDdp, pkt, len, 121);
+  TEST_ASSERT_EQUAL_UINT32(12, rx.stats().lost);  // 4..14 were skipped above
+
+  // Truncated and non-pixel packets are counted, not applied.
+  const uint32_t frames = rx.stats().frames;
+  TEST_ASSERT_FALSE(rx.on_packet(RealtimeProtocol::kDdp, pkt, 9, 122));
+  pkt[9] = 200;  // length beyond the datagram
+  TEST_ASSERT_FALSE(rx.on_packet(RealtimeProtocol::kDdp, pkt, len, 122));
+  TEST_ASSERT_EQUAL_UINT32(2, rx.stats().malformed);
+  len = make_ddp(pkt, 0, true, 0, payload, 3);
+  pkt[0] |= 0x02;  // query
+  TEST_ASSERT_FALSE(rx.on_packet(RealtimeProtocol::kDdp, pkt, len, 122));
+  TEST_ASSERT_EQUAL_UINT32(1, rx.stats().ignored);
+  TEST_ASSERT_EQUAL_UINT32(frames, rx.stats().frames);
+
+  // Silence past the timeout hands control back to the effect.
+  TEST_ASSERT_TRUE(rx.active(1120));
+  TEST_ASSERT_FALSE(rx.active(1121));
+  TEST_ASSERT_EQUAL_UINT32(1, rx.stats().timeouts);
+  TEST_ASSERT_FALSE(rx.active(5000));
+  TEST_ASSERT_EQUAL_UINT32(1, rx.stats().timeouts);
+}
+
+void test_realtime_e131_raster_layout_with_universe_sync() {
+  // 3 LEDs on a 200x2 raster: 1200 channels span three universes.
+  static Rgb fb[3];
+  static const int16_t xs[3] = {5, 180, 0};
+  static const int16_t ys[3] = {0, 0, 1};
+  static const uint16_t order[3] = {0, 1, 2};  // (y, x) ascending
+  RealtimeFramebuffer f;
+  f.pixels = fb;
+  f.count = 3;
+  f.width = 200;
+  f.height = 2;
+  f.x = xs;
+  f.y = ys;
+  f.raster_order = order;
+  RealtimeConfig cfg;
+  cfg.layout = RealtimeLayout::kRaster;
+  RealtimeReceiver rx;
+  rx.begin(f, cfg);
+  TEST_ASSERT_EQUAL_UINT16(3, rx.universe_count());
+
+  static uint8_t dmx[510];
+  static uint8_t pkt[700];
+  memset(dmx, 0, sizeof(dmx));
+  // Cell 5 -> channels 15..17 in universe 1.
+  dmx[15] = 10;
+  dmx[16] = 20;
+  dmx[17] = 30;
+  // Cell 169 -> channels 507..509: not an LED, must not land anywhere.
+  dmx[507] = 99;
+  size_t len = make_e131(pkt, 1, 1, 7, dmx, 510);
+  TEST_ASSERT_TRUE(rx.on_packet(RealtimeProtocol::kE131, pkt, len, 0));
+  TEST_ASSERT_EQUAL_UINT8(10, fb[0].r);
+  TEST_ASSERT_EQUAL_UINT8(30, fb[0].b);
+  TEST_ASSERT_EQUAL_UINT8(0, fb[1].r);
+
+  // Cell 180 = channels 540..542 = universe 2 offsets 30..32. Cell 200 (LED 2) = universe 2 offsets 90..92.
+  memset(dmx, 0, sizeof(dmx));
+  dmx[30] = 1;
+  dmx[31] = 2;
+  dmx[32] = 3;
+  dmx[90] = 4;
+  len = make_e131(pkt, 2, 1, 7, dmx, 510);
+  TEST_ASSERT_TRUE(rx.on_packet(RealtimeProtocol::kE131, pkt, len, 2));
+  len = make_e131(pkt, 3, 1, 7, dmx, 180);
+  TEST_ASSERT_TRUE(rx.on_packet(RealtimeProtocol::kE131, pkt, len, 3));
+  TEST_ASSERT_EQUAL_UINT8(1, fb[1].r);
+  TEST_ASSERT_EQUAL_UINT8(3, fb[1].b);
+  TEST_ASSERT_EQUAL_UINT8(4, fb[2].r);
+
+  // Sender asked for sync (address 7): the last universe alone does not complete the frame.
+  TEST_ASSERT_FALSE(rx.take_frame());
+  len = make_e131_sync(pkt, 8);
+  TEST_ASSERT_FALSE(rx.on_packet(RealtimeProtocol::kE131, pkt, len, 4));
+  TEST_ASSERT_FALSE(rx.take_frame());
+  len = make_e131_sync(pkt, 7);
+  TEST_ASSERT_TRUE(rx.on_packet(RealtimeProtocol::kE131, pkt, len, 5));
+  TEST_ASSERT_TRUE(rx.take_frame());
+  TEST_ASSERT_EQUAL_UINT16(5, rx.stats().last_assembly_ms);
+
+  // Other universes and late duplicates are ignored; a gap counts as loss.
+  len = make_e131(pkt, 9, 2, 0, dmx, 3);
+  TEST_ASSERT_FALSE(rx.on_packet(RealtimeProtocol::kE131, pkt, len, 6));
+  len = make_e131(pkt, 1, 1, 0, dmx, 3);
+  TEST_ASSERT_FALSE(rx.on_packet(RealtimeProtocol::kE131, pkt, len, 6));
+  TEST_ASSERT_EQUAL_UINT32(0, rx.stats().lost);
+  len = make_e131(pkt, 1, 4, 0, dmx, 3);
+  TEST_ASSERT_TRUE(rx.on_packet(RealtimeProtocol::kE131, pkt, len, 6));
+  TEST_ASSERT_EQUAL_UINT32(2, rx.stats().lost);
+  TEST_ASSERT_EQUAL_UINT32(3, rx.stats().ignored);  // wrong sync address, foreign universe, duplicate
+
+  // Stream-terminated option ends realtime immediately.
+  len = make_e131(pkt, 1, 5, 0, dmx, 3);
+  pkt[112] = 0x40;
+  (void)rx.on_packet(RealtimeProtocol::kE131, pkt, len, 7);
+  TEST_ASSERT_FALSE(rx.active(7));
+}
+
+void test_realtime_artnet_without_and_with_artsync() {
+  static Rgb fb[10];
+  RealtimeFramebuffer f;
+  f.pixels = fb;
+  f.count = 10;
+  RealtimeReceiver rx;
+  rx.begin(f, RealtimeConfig{});
+  TEST_ASSERT_EQUAL_UINT16(1, rx.universe_count());
+
+  uint8_t dmx[30];
+  for (size_t i = 0; i < sizeof(dmx); ++i) dmx[i] = static_cast<uint8_t>(100 + i);
+  uint8_t pkt[64];
+
+  // Without ArtSync the only universe completes the frame.
+  size_t len = make_artnet(pkt, 0x5000, 0, 0, dmx, 30);
+  TEST_ASSERT_TRUE(rx.on_packet(RealtimeProtocol::kArtNet, pkt, len, 10));
+  TEST_ASSERT_TRUE(rx.take_frame());
+  TEST_ASSERT_EQUAL_UINT8(129, fb[9].b);
+
+  // Once ArtSync is seen, output waits for it.
+  len = make_artnet(pkt, 0x5200, 0, 0, nullptr, 0);
+  (void)rx.on_packet(RealtimeProtocol::kArtNet, pkt, len, 20);
+  len = make_artnet(pkt, 0x5000, 0, 0, dmx, 30);
+  TEST_ASSERT_TRUE(rx.on_packet(RealtimeProtocol::kArtNet, pkt, len, 30));
+  TEST_ASSERT_FALSE(rx.take_frame());
+  len = make_artnet(pkt, 0x5200, 0, 0, nullptr, 0);
+  TEST_ASSERT_TRUE(rx.on_packet(RealtimeProtocol::kArtNet, pkt, len, 33));
+  TEST_ASSERT_TRUE(rx.take_frame());
+
+  // ArtSync going quiet for 4s reverts to unsynced output.
+  len = make_artnet(pkt, 0x5000, 0, 0, dmx, 30);
+  TEST_ASSERT_TRUE(rx.on_packet(RealtimeProtocol::kArtNet, pkt, len, 4100));
+  TEST_ASSERT_TRUE(rx.take_frame());
+
+  // Other opcodes (e.g. OpPoll) are ignored; truncated packets are malformed.
+  len = make_artnet(pkt, 0x2000, 0, 0, nullptr, 0);
+  TEST_ASSERT_FALSE(rx.on_packet(RealtimeProtocol::kArtNet, pkt, len, 4101));
+  len = make_artnet(pkt, 0x5000, 0, 0, dmx, 30);
+  TEST_ASSERT_FALSE(rx.on_packet(RealtimeProtocol::kArtNet, pkt, 20, 4101));
+  TEST_ASSERT_EQUAL_UINT32(1, rx.stats().ignored);
+  TEST_ASSERT_EQUAL_UINT32(1, rx.stats().malformed);
+}
+
+void test_realtime_ddp_over_udp_loopback() {
+  const int rx_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  const int tx_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  TEST_ASSERT_TRUE(rx_fd >= 0 && tx_fd >= 0);
+
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;  // ephemeral; the firmware binds kDdpPort
+  TEST_ASSERT_EQUAL_INT(0, bind(rx_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+  socklen_t alen = sizeof(addr);
+  TEST_ASSERT_EQUAL_INT(0, getsockname(rx_fd, reinterpret_cast<sockaddr*>(&addr), &alen));
+  timeval tv{1, 0};
+  (void)setsockopt(rx_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  static Rgb fb[4];
+  RealtimeFramebuffer f;
+  f.pixels = fb;
+  f.count = 4;
+  RealtimeReceiver rx;
+  rx.begin(f, RealtimeConfig{});
+
+  const uint8_t rgb[12] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+  uint8_t pkt[32];
+  const size_t len = make_ddp(pkt, 1, true, 0, rgb, sizeof(rgb));
+  TEST_ASSERT_EQUAL_INT(static_cast<int>(len),
+                        static_cast<int>(sendto(tx_fd, pkt, len, 0, reinterpret_cast<sockaddr*>(&addr), alen)));
+
+  uint8_t buf[1500];
+  const ssize_t got = recv(rx_fd, buf, sizeof(buf), 0);
+  close(tx_fd);
+  close(rx_fd);
+  TEST_ASSERT_EQUAL_INT(static_cast<int>(len), static_cast<int>(got));
+
+  TEST_ASSERT_TRUE(rx.on_packet(RealtimeProtocol::kDdp, buf, static_cast<size_t>(got), 1));
+  TEST_ASSERT_TRUE(rx.take_frame());
+  TEST_ASSERT_EQUAL_UINT8(1, fb[0].r);
+  TEST_ASSERT_EQUAL_UINT8(12, fb[3].b);
+}
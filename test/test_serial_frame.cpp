@@ -0,0 +1,103 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include "core/protocol/serial_frame.h"
+
+using chromance::core::Rgb;
+using chromance::core::SerialFrameReceiver;
+
+namespace {
+
+constexpr uint16_t kLeds = 20;
+
+size_t make_frame(uint8_t* out, uint16_t leds, uint8_t seed) {
+  const uint16_t n1 = static_cast<uint16_t>(leds - 1U);
+  out[0] = 'A';
+  out[1] = 'd';
+  out[2] = 'a';
+  out[3] = static_cast<uint8_t>(n1 >> 8);
+  out[4] = static_cast<uint8_t>(n1);
+  out[5] = static_cast<uint8_t>(out[3] ^ out[4] ^ 0x55);
+  for (size_t i = 0; i < leds * 3U; ++i) out[6 + i] = static_cast<uint8_t>(seed + i);
+  const uint16_t crc = chromance::core::crc16_ccitt_update(0xFFFF, out + 6, leds * 3U);
+  out[6 + leds * 3U] = static_cast<uint8_t>(crc >> 8);
+  out[7 + leds * 3U] = static_cast<uint8_t>(crc);
+  return 8U + leds * 3U;
+}
+
+}  // namespace
+
+void test_serial_frame_crc16_matches_reference_vector() {
+  const uint8_t msg[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, chromance::core::crc16_ccitt_update(0xFFFF, msg, sizeof(msg)));
+}
+
+void test_serial_frame_receiver_swaps_frames_and_passes_commands_through() {
+  static SerialFrameReceiver<kLeds> rx;
+  uint8_t frame[8 + kLeds * 3];
+  uint8_t cmds[16];
+
+  // Command bytes around a frame, fed one byte at a time.
+  uint8_t stream[4 + sizeof(frame)];
+  stream[0] = '6';
+  stream[1] = 'A';  // looks like a start, but is not
+  stream[2] = '+';
+  const size_t flen = make_frame(stream + 3, kLeds, 1);
+  stream[3 + flen] = 'n';
+  size_t ncmd = 0;
+  for (size_t i = 0; i < sizeof(stream); ++i) {
+    ncmd += rx.feed(stream + i, 1, cmds + ncmd, sizeof(cmds) - ncmd, 0);
+  }
+  TEST_ASSERT_EQUAL_UINT32(4, ncmd);
+  TEST_ASSERT_EQUAL_MEMORY("6A+n", cmds, 4);
+
+  const Rgb* f = rx.take_frame();
+  TEST_ASSERT_NOT_NULL(f);
+  TEST_ASSERT_EQUAL_UINT8(1, f[0].r);
+  TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(1 + 59), f[19].b);
+  TEST_ASSERT_NULL(rx.take_frame());
+
+  // Two frames in one bulk read before the render tick: the newer wins, the older counts as an overrun.
+  uint8_t two[2 * sizeof(frame)];
+  size_t len = make_frame(two, kLeds, 10);
+  len += make_frame(two + len, kLeds, 20);
+  TEST_ASSERT_EQUAL_UINT32(0, rx.feed(two, len, cmds, sizeof(cmds), 5));
+  f = rx.take_frame();
+  TEST_ASSERT_NOT_NULL(f);
+  TEST_ASSERT_EQUAL_UINT8(20, f[0].r);
+  TEST_ASSERT_EQUAL_UINT32(3, rx.stats().frames);
+  TEST_ASSERT_EQUAL_UINT32(1, rx.stats().overruns);
+}
+
+void test_serial_frame_receiver_rejects_bad_frames_and_resyncs() {
+  static SerialFrameReceiver<kLeds> rx;
+  uint8_t frame[8 + kLeds * 3];
+  uint8_t cmds[16];
+
+  // Corrupted payload byte: CRC fails, nothing published.
+  size_t len = make_frame(frame, kLeds, 3);
+  frame[20] ^= 0x01;
+  (void)rx.feed(frame, len, cmds, sizeof(cmds), 0);
+  TEST_ASSERT_NULL(rx.take_frame());
+  TEST_ASSERT_EQUAL_UINT32(1, rx.stats().crc_errors);
+
+  // Wrong LED count for this panel: header rejected.
+  (void)make_frame(frame, kLeds - 1, 3);
+  (void)rx.feed(frame, 6, cmds, sizeof(cmds), 0);
+  TEST_ASSERT_EQUAL_UINT32(1, rx.stats().header_errors);
+  TEST_ASSERT_FALSE(rx.receiving());
+
+  // A truncated frame is abandoned after the inter-byte gap; the next frame is received normally.
+  len = make_frame(frame, kLeds, 4);
+  (void)rx.feed(frame, len / 2, cmds, sizeof(cmds), 10);
+  TEST_ASSERT_TRUE(rx.receiving());
+  len = make_frame(frame, kLeds, 5);
+  (void)rx.feed(frame, len, cmds, sizeof(cmds), 10 + SerialFrameReceiver<kLeds>::kInterByteTimeoutMs);
+  TEST_ASSERT_EQUAL_UINT32(1, rx.stats().aborted);
+  const Rgb* f = rx.take_frame();
+  TEST_ASSERT_NOT_NULL(f);
+  TEST_ASSERT_EQUAL_UINT8(5, f[0].r);
+}
@@ -0,0 +1,95 @@
+#include <stdint.h>
+
+#include <unity.h>
+
+#include "core/spi_bus_plan.h"
+
+using chromance::core::SpiBus;
+using chromance::core::SpiBusPlan;
+using chromance::core::SpiStripRequest;
+using chromance::core::apa102_wire_us;
+using chromance::core::kUnassignedPin;
+using chromance::core::plan_spi_buses;
+
+namespace {
+
+SpiStripRequest strip(uint16_t leds, uint8_t data_pin, uint8_t clock_pin, uint32_t clock_hz) {
+  SpiStripRequest r;
+  r.led_count = leds;
+  r.data_pin = data_pin;
+  r.clock_pin = clock_pin;
+  r.clock_hz = clock_hz;
+  return r;
+}
+
+}  // namespace
+
+void test_apa102_wire_time_follows_frame_bytes_and_clock() {
+  // 154 LEDs: 4 start + 616 pixel + 10 end bytes = 5040 bits.
+  TEST_ASSERT_EQUAL_UINT32(630, chromance::core::apa102_frame_bytes(154));
+  TEST_ASSERT_EQUAL_UINT32(1260, apa102_wire_us(154, 4000000));
+  TEST_ASSERT_EQUAL_UINT32(630, apa102_wire_us(154, 8000000));
+  TEST_ASSERT_EQUAL_UINT32(420, apa102_wire_us(154, 12000000));
+  TEST_ASSERT_EQUAL_UINT32(1, apa102_wire_us(0, 80000000));  // rounded up
+  TEST_ASSERT_EQUAL_UINT32(0, apa102_wire_us(154, 0));
+}
+
+void test_spi_bus_plan_balances_strips_across_hosts() {
+  // The canonical panel's pins: none is a host's IO_MUX pair, so all four go through the GPIO matrix.
+  SpiStripRequest req[5] = {strip(154, 23, 22, 8000000), strip(140, 17, 16, 8000000), strip(126, 33, 27, 8000000),
+                            strip(140, 14, 32, 8000000), strip(0, kUnassignedPin, kUnassignedPin, 8000000)};
+  SpiBusPlan plan = plan_spi_buses(req, 5);
+  TEST_ASSERT_EQUAL_UINT8(0, plan.unplaced);
+  TEST_ASSERT_TRUE(plan.strips[4].bus == SpiBus::kNone);
+  // Longest first: 154 -> HSPI, 140 -> VSPI, 140 -> VSPI (VSPI still earlier), 126 -> HSPI.
+  TEST_ASSERT_TRUE(plan.strips[0].bus == SpiBus::kHspi);
+  TEST_ASSERT_TRUE(plan.strips[1].bus == SpiBus::kVspi);
+  TEST_ASSERT_TRUE(plan.strips[3].bus == SpiBus::kVspi);
+  TEST_ASSERT_TRUE(plan.strips[2].bus == SpiBus::kHspi);
+  TEST_ASSERT_EQUAL_UINT8(1, plan.bus_clock_count[0]);  // one shared device per host
+  TEST_ASSERT_EQUAL_UINT32(apa102_wire_us(154, 8000000) + apa102_wire_us(126, 8000000), plan.bus_us[0]);
+  TEST_ASSERT_EQUAL_UINT32(2 * apa102_wire_us(140, 8000000), plan.flush_us());
+
+  // A slow strip weighs more: at 4 MHz strip 2 is placed first and its host gets a second clock (device).
+  req[2].clock_hz = 4000000;
+  plan = plan_spi_buses(req, 4);
+  TEST_ASSERT_TRUE(plan.strips[2].bus == SpiBus::kHspi);
+  TEST_ASSERT_TRUE(plan.strips[0].bus == SpiBus::kVspi);
+  TEST_ASSERT_TRUE(plan.strips[1].bus == SpiBus::kVspi);
+  TEST_ASSERT_TRUE(plan.strips[3].bus == SpiBus::kHspi);
+  TEST_ASSERT_EQUAL_UINT32(4000000, plan.strips[2].clock_hz);
+  TEST_ASSERT_EQUAL_UINT8(2, plan.bus_clock_count[0]);
+  TEST_ASSERT_EQUAL_UINT32(apa102_wire_us(126, 4000000) + apa102_wire_us(140, 8000000), plan.flush_us());
+  // Clocks are clamped to what the GPIO matrix can carry.
+  req[0].clock_hz = 40000000;
+  req[1].clock_hz = 100000;
+  plan = plan_spi_buses(req, 4);
+  TEST_ASSERT_EQUAL_UINT32(chromance::core::kSpiMatrixMaxClockHz, plan.strips[0].clock_hz);
+  TEST_ASSERT_EQUAL_UINT32(chromance::core::kSpiMinClockHz, plan.strips[1].clock_hz);
+}
+
+void test_spi_bus_plan_gives_rewired_strips_their_host_and_caps_clocks_per_host() {
+  // Strip 0 rewired onto VSPI's IO_MUX pins: VSPI is its own, at up to 40 MHz; the rest share HSPI.
+  SpiStripRequest req[7] = {strip(154, 23, 18, 40000000), strip(140, 17, 16, 8000000), strip(126, 33, 27, 8000000),
+                            strip(140, 4, 32, 8000000)};
+  SpiBusPlan plan = plan_spi_buses(req, 4);
+  TEST_ASSERT_TRUE(plan.strips[0].bus == SpiBus::kVspi);
+  TEST_ASSERT_TRUE(plan.strips[0].native_pins);
+  TEST_ASSERT_EQUAL_UINT32(40000000, plan.strips[0].clock_hz);
+  TEST_ASSERT_TRUE(plan.bus_exclusive[1]);
+  for (uint8_t s = 1; s < 4; ++s) {
+    TEST_ASSERT_TRUE(plan.strips[s].bus == SpiBus::kHspi);
+    TEST_ASSERT_FALSE(plan.strips[s].native_pins);
+  }
+  TEST_ASSERT_EQUAL_UINT32(plan.bus_us[0], plan.flush_us());
+
+  // Without IO_MUX strips, each host holds three clocks: a seventh distinct clock has nowhere to go.
+  for (uint8_t s = 0; s < 7; ++s) {
+    req[s] = strip(14, static_cast<uint8_t>(s + 1), static_cast<uint8_t>(s + 20), 2000000U + s * 1000000U);
+  }
+  plan = plan_spi_buses(req, 7);
+  TEST_ASSERT_EQUAL_UINT8(1, plan.unplaced);
+  TEST_ASSERT_EQUAL_UINT8(3, plan.bus_clock_count[0]);
+  TEST_ASSERT_EQUAL_UINT8(3, plan.bus_clock_count[1]);
+  TEST_ASSERT_TRUE(plan.strips[6].bus == SpiBus::kNone);  // fastest, so placed last
+}
@@ -0,0 +1,87 @@
+// Host-side stand-in for the I2S microphone: streams a PCM16 WAV through core::AudioAnalyzer in DMA-sized
+// chunks, exactly as the capture task does, and prints tempo, onsets and per-block analysis cost.
+//
+// Build and run from the repo root:
+//   g++ -std=gnu++11 -O2 -Isrc tools/audio_probe/audio_probe.cpp -o /tmp/audio_probe
+//   /tmp/audio_probe song.wav [channel]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <vector>
+
+#include "core/audio/audio_analyzer.h"
+#include "core/audio/wav_reader.h"
+
+namespace {
+
+constexpr size_t kChunkFrames = 256;  // matches platform::I2sAudioInput::kChunkFrames
+
+uint32_t host_clock_us() {
+  return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s file.wav [channel]\n", argv[0]);
+    return 2;
+  }
+  FILE* f = fopen(argv[1], "rb");
+  if (f == nullptr) {
+    perror(argv[1]);
+    return 1;
+  }
+  std::vector<uint8_t> bytes;
+  uint8_t buf[65536];
+  size_t n = 0;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+  fclose(f);
+
+  chromance::core::WavPcm16 wav;
+  if (!chromance::core::parse_wav_pcm16(bytes.data(), bytes.size(), &wav)) {
+    fprintf(stderr, "%s: not a PCM16 WAV\n", argv[1]);
+    return 1;
+  }
+  const uint16_t channel = argc > 2 ? static_cast<uint16_t>(atoi(argv[2])) : 0;
+  if (channel >= wav.channels) {
+    fprintf(stderr, "channel %u out of range (%u channels)\n", channel, wav.channels);
+    return 1;
+  }
+  printf("%s: %u Hz, %u ch, %.2f s\n", argv[1], static_cast<unsigned>(wav.sample_rate), wav.channels,
+         static_cast<double>(wav.frames) / wav.sample_rate);
+
+  static chromance::core::AudioAnalyzer<512> analyzer;
+  analyzer.begin(wav.sample_rate, host_clock_us);
+  int16_t chunk[kChunkFrames];
+  uint64_t total_us = 0;
+  uint32_t last_onsets = 0;
+  uint32_t next_report_ms = 1000;
+  for (size_t frame = 0; frame < wav.frames; frame += kChunkFrames) {
+    const size_t count = wav.frames - frame < kChunkFrames ? wav.frames - frame : kChunkFrames;
+    for (size_t i = 0; i < count; ++i) chunk[i] = wav.sample(frame + i, channel);
+    const uint32_t end_ms = static_cast<uint32_t>((frame + count - 1U) * 1000ULL / wav.sample_rate);
+    if (analyzer.feed(chunk, count, end_ms) > 0) total_us += analyzer.features().last_block_us;
+
+    const chromance::core::AudioFeatures& a = analyzer.features();
+    if (static_cast<int32_t>(end_ms - next_report_ms) >= 0) {
+      next_report_ms += 1000;
+      printf("t=%6.1fs energy=%.2f bpm=%6.2f onsets=+%u bands=[", end_ms / 1000.0, a.energy_q16 / 65535.0,
+             a.bpm_x100 / 100.0, a.onsets - last_onsets);
+      for (uint8_t b = 0; b < chromance::core::kAudioBandCount; ++b) printf(b ? ",%3u" : "%3u", a.bands[b]);
+      printf("]\n");
+      last_onsets = a.onsets;
+    }
+  }
+  const chromance::core::AudioFeatures& a = analyzer.features();
+  printf("blocks=%u (every %.1f ms) onsets=%u bpm=%.2f\n", a.blocks,
+         512.0 / 2.0 * 1000.0 / analyzer.analysis_rate(), a.onsets, a.bpm_x100 / 100.0);
+  printf("block cost (host): avg=%.1f us max=%u us\n", a.blocks ? static_cast<double>(total_us) / a.blocks : 0.0,
+         a.max_block_us);
+  return 0;
+}
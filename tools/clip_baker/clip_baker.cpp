@@ -0,0 +1,188 @@
+// Bakes built-in effects into a clip bundle for ClipPlayerEffect (mode 9): each effect is rendered on the host
+// at a fixed frame rate with the firmware's own core code, reduced to a palette, delta-encoded and written as
+// one bundle image to flash into the clip partition.
+//
+// Build and run from the repo root (needs include/generated/ from any PlatformIO build):
+//   g++ -std=gnu++11 -O2 -Isrc -Iinclude tools/clip_baker/clip_baker.cpp src/core/effects/*.cpp -o /tmp/clip_baker
+//   /tmp/clip_baker [--fps 50] [--seconds 20] [--keyframe 50] [--seed 0] [--partition-bytes 131072]
+//                   clips.bin hrv_hexagon seven_comets ...
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "core/clip/clip_encoder.h"
+#include "core/clip/clip_format.h"
+#include "core/effects/pattern_breathing_mode.h"
+#include "core/effects/pattern_hrv_hexagon.h"
+#include "core/effects/pattern_rainbow_pulse.h"
+#include "core/effects/pattern_two_dots.h"
+#include "core/mapping/mapping_tables.h"
+#include "core/mapping/pixels_map.h"
+
+namespace {
+
+using chromance::core::Rgb;
+
+constexpr size_t kLedCount = chromance::core::MappingTables::led_count();
+constexpr size_t kMaxKeyframes = 4096;
+
+struct Options {
+  uint16_t fps = 50;
+  uint32_t seconds = 20;
+  uint32_t keyframe = 50;
+  uint32_t seed = 0;  // effect start time; seeds effects that randomize on reset (breathing)
+  size_t partition_bytes = 0x20000;  // spiffs partition of min_spiffs.csv
+};
+
+// Same constructor arguments as main_runtime.cpp.
+chromance::core::IEffect* make_effect(const char* name) {
+  static chromance::core::RainbowPulseEffect rainbow_pulse{700, 2000, 700};
+  static chromance::core::TwoDotsEffect seven_comets{25};
+  static chromance::core::HrvHexagonEffect hrv_hexagon;
+  static chromance::core::BreathingEffect breathing;
+  if (strcmp(name, "rainbow_pulse") == 0) return &rainbow_pulse;
+  if (strcmp(name, "seven_comets") == 0) return &seven_comets;
+  if (strcmp(name, "hrv_hexagon") == 0) return &hrv_hexagon;
+  if (strcmp(name, "breathing") == 0) return &breathing;
+  return nullptr;
+}
+
+// Renders frame f of a run started at opt.seed. Full brightness: the player scales at playback time.
+void render_frame(chromance::core::IEffect* e, const Options& opt, uint32_t f, Rgb* out) {
+  static const chromance::core::PixelsMap map;
+  static uint32_t last_ms = 0;
+  chromance::core::EffectFrame frame;
+  frame.now_ms = opt.seed + static_cast<uint32_t>(static_cast<uint64_t>(f) * 1000U / opt.fps);
+  frame.dt_ms = f == 0 ? 0 : frame.now_ms - last_ms;
+  last_ms = frame.now_ms;
+  e->render(frame, map, out, kLedCount);
+}
+
+bool bake(const char* name, const Options& opt, std::vector<uint8_t>* out) {
+  chromance::core::IEffect* e = make_effect(name);
+  if (e == nullptr) {
+    fprintf(stderr, "unknown effect '%s' (rainbow_pulse, seven_comets, hrv_hexagon, breathing)\n", name);
+    return false;
+  }
+  const uint32_t frames = opt.seconds * opt.fps;
+  static Rgb rgb[kLedCount];
+
+  // Pass 1: palette from the colours the run actually produces.
+  static chromance::core::ClipPaletteBuilder builder;
+  builder.reset();
+  static chromance::core::ScratchBuffer<chromance::core::kDefaultEffectScratchBytes> scratch;
+  if (e->needs_prepare()) e->prepare(kLedCount);
+  e->bind_scratch(scratch.scratch());
+  e->reset(opt.seed);
+  for (uint32_t f = 0; f < frames; ++f) {
+    render_frame(e, opt, f, rgb);
+    builder.add_frame(rgb, kLedCount);
+  }
+  Rgb palette[256];
+  const size_t palette_size = builder.build(palette, 256);
+  if (palette_size == 0) {
+    fprintf(stderr, "%s: no frames\n", name);
+    return false;
+  }
+
+  // Pass 2: identical run (same start time), quantized and delta-encoded.
+  static chromance::core::ClipEncoder<kLedCount, kMaxKeyframes> enc;
+  out->assign(static_cast<size_t>(frames) * (kLedCount + 1U) + 64U * 1024U, 0);
+  const uint32_t hash = chromance::core::clip::mapping_hash(chromance::core::MappingTables::mapping_version());
+  if (!enc.begin(out->data(), out->size(), static_cast<uint16_t>(kLedCount), opt.fps, hash, palette,
+                 static_cast<uint16_t>(palette_size), opt.keyframe)) {
+    return false;
+  }
+  e->reset(opt.seed);
+  double err = 0.0;
+  for (uint32_t f = 0; f < frames; ++f) {
+    render_frame(e, opt, f, rgb);
+    for (size_t i = 0; i < kLedCount; ++i) {
+      const Rgb q = palette[chromance::core::nearest_palette_index(palette, palette_size, rgb[i])];
+      err += abs(q.r - rgb[i].r) + abs(q.g - rgb[i].g) + abs(q.b - rgb[i].b);
+    }
+    if (!enc.add_frame(rgb)) {
+      fprintf(stderr, "%s: encode failed at frame %u (too many keyframes?)\n", name, f);
+      return false;
+    }
+  }
+  const size_t size = enc.finish();
+  if (size == 0) return false;
+  out->resize(size);
+
+  const auto& s = enc.stats();
+  printf("%-14s %u frames @ %u fps, palette %u, keyframes %u, avg changed LEDs %.1f, mean abs error %.2f\n",
+         name, s.frames, opt.fps, static_cast<unsigned>(palette_size), s.keyframes,
+         s.frames > s.keyframes ? static_cast<double>(s.changed_leds) / (s.frames - s.keyframes) : 0.0,
+         err / (static_cast<double>(frames) * kLedCount * 3.0));
+  printf("%-14s %zu bytes (raw RGB %zu, %.1fx)\n", "", size, static_cast<size_t>(frames) * kLedCount * 3U,
+         static_cast<double>(frames) * kLedCount * 3.0 / size);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt;
+  int i = 1;
+  for (; i + 1 < argc && strncmp(argv[i], "--", 2) == 0; i += 2) {
+    const unsigned long v = strtoul(argv[i + 1], nullptr, 0);
+    if (strcmp(argv[i], "--fps") == 0 && v > 0 && v <= 1000) {
+      opt.fps = static_cast<uint16_t>(v);
+    } else if (strcmp(argv[i], "--seconds") == 0 && v > 0) {
+      opt.seconds = static_cast<uint32_t>(v);
+    } else if (strcmp(argv[i], "--keyframe") == 0 && v > 0) {
+      opt.keyframe = static_cast<uint32_t>(v);
+    } else if (strcmp(argv[i], "--seed") == 0) {
+      opt.seed = static_cast<uint32_t>(v);
+    } else if (strcmp(argv[i], "--partition-bytes") == 0 && v > 0) {
+      opt.partition_bytes = v;
+    } else {
+      fprintf(stderr, "bad option %s %s\n", argv[i], argv[i + 1]);
+      return 2;
+    }
+  }
+  if (argc - i < 2) {
+    fprintf(stderr, "usage: %s [--fps N] [--seconds N] [--keyframe N] [--seed MS] [--partition-bytes N] "
+                    "out.bin effect...\n", argv[0]);
+    return 2;
+  }
+  const char* out_path = argv[i++];
+  const uint16_t count = static_cast<uint16_t>(argc - i);
+  printf("mapping %s, %zu LEDs\n", chromance::core::MappingTables::mapping_version(), kLedCount);
+
+  std::vector<std::vector<uint8_t>> clips(count);
+  size_t total = 0;
+  for (uint16_t c = 0; c < count; ++c) {
+    if (!bake(argv[i + c], opt, &clips[c])) return 1;
+    total += clips[c].size() + 4U;
+  }
+
+  std::vector<uint8_t> bundle(chromance::core::clip::kBundleHeaderBytes +
+                              count * chromance::core::clip::kBundleEntryBytes + total);
+  chromance::core::ClipBundleWriter w;
+  if (!w.begin(bundle.data(), bundle.size(), count)) return 1;
+  for (uint16_t c = 0; c < count; ++c) {
+    if (!w.add(argv[i + c], clips[c].data(), clips[c].size())) return 1;
+  }
+  const size_t size = w.finish();
+  bundle.resize(size);
+  printf("bundle: %zu bytes of %zu (%.0f%%)\n", size, opt.partition_bytes, 100.0 * size / opt.partition_bytes);
+  if (size > opt.partition_bytes) {
+    fprintf(stderr, "bundle does not fit the partition: shorten clips, lower --fps or raise --keyframe\n");
+    return 1;
+  }
+
+  FILE* f = fopen(out_path, "wb");
+  if (f == nullptr || fwrite(bundle.data(), 1, size, f) != size) {
+    perror(out_path);
+    if (f != nullptr) fclose(f);
+    return 1;
+  }
+  fclose(f);
+  return 0;
+}
@@ -0,0 +1,623 @@
+// Runs the runtime's effect loop (EffectManager, catalog, crossfades, idle-frame skipping, persistence) on the
+// host with a fake clock, an in-memory settings store and a null LED output, replaying a script of inputs.
+// Prints one hash per frame for golden comparison plus perf counters, and can dump frames as PNG/GIF laid out
+// with mapping/pixels.json.
+//
+// Build and run from the repo root (needs include/generated/ from any PlatformIO build):
+//   g++ -std=gnu++11 -O2 -Isrc -Iinclude -o /tmp/headless_runtime
+//       tools/headless_runtime/headless_runtime.cpp src/core/effects/*.cpp
+//   /tmp/headless_runtime [--frames 500] [--fps 50] [--effect 4] [--script show.txt] [--hashes out.txt]
+//                         [--golden golden.txt] [--png-dir frames/ --png-every 10] [--gif run.gif --gif-every 2]
+//                         [--pixels mapping/pixels.json] [--scale 3] [--transition-ms 400] [--max-idle-ms 1000]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "core/effects/effect_catalog.h"
+#include "core/effects/effect_manager.h"
+#include "core/effects/layer_stack.h"
+#include "core/effects/legacy_effect_adapter.h"
+#include "core/effects/pattern_breathing_mode.h"
+#include "core/effects/pattern_breathing_mode_v2.h"
+#include "core/effects/pattern_coord_color.h"
+#include "core/effects/pattern_hrv_hexagon.h"
+#include "core/effects/pattern_index_walk.h"
+#include "core/effects/pattern_rainbow_pulse.h"
+#include "core/effects/pattern_strip_segment_stepper.h"
+#include "core/effects/pattern_two_dots.h"
+#include "core/mapping/mapping_tables.h"
+#include "core/mapping/pixels_map.h"
+#include "core/sim/headless_runner.h"
+#include "platform/led/led_output.h"
+
+namespace {
+
+using chromance::core::EffectDescriptor;
+using chromance::core::EffectId;
+using chromance::core::Rgb;
+
+constexpr size_t kLedCount = chromance::core::MappingTables::led_count();
+constexpr size_t kMaxEffects = 32;
+
+struct Options {
+  uint32_t frames = 500;
+  uint16_t fps = 50;
+  uint16_t effect = 4;
+  uint32_t start_ms = 0;
+  uint16_t transition_ms = 400;
+  uint32_t max_idle_ms = 1000;
+  const char* script = nullptr;
+  const char* hashes = nullptr;  // default stdout
+  const char* golden = nullptr;
+  const char* png_dir = nullptr;
+  uint32_t png_every = 1;
+  const char* gif = nullptr;
+  uint32_t gif_every = 1;
+  const char* pixels = "mapping/pixels.json";
+  uint32_t scale = 3;
+};
+
+// Stands in for DotstarOutput: accepts frames and counts what would have gone over the wire.
+class NullLedOutput final : public chromance::platform::ILedOutput {
+ public:
+  void begin() override {}
+  void show(const Rgb* /*rgb*/, size_t len, chromance::platform::PerfStats* stats) override {
+    ++shows;
+    bytes += 4U + len * 4U + (len + 15U) / 16U;  // APA102: start frame, 4 bytes per LED, end frame
+    if (stats != nullptr) *stats = chromance::platform::PerfStats{0, 0};
+  }
+
+  uint32_t shows = 0;
+  uint64_t bytes = 0;
+};
+
+// Same effects, ids and constructor arguments as main_runtime.cpp (modes 1..8; the baked clip needs flash).
+struct Effects {
+  chromance::core::IndexWalkEffect index_walk{25};
+  chromance::core::StripSegmentStepperEffect strip_segment_stepper{1000};
+  chromance::core::CoordColorEffect coord_color;
+  chromance::core::RainbowPulseEffect rainbow_pulse{700, 2000, 700};
+  chromance::core::TwoDotsEffect two_dots{25};
+  chromance::core::HrvHexagonEffect hrv_hexagon;
+  chromance::core::BreathingEffect breathing;
+  chromance::core::RainbowPulseEffect layer_rainbow{700, 2000, 700};
+  chromance::core::TwoDotsEffect layer_comets{25};
+
+  const EffectDescriptor d1{EffectId{1}, "index_walk", "Index_Walk_Test", nullptr};
+  const EffectDescriptor d2{EffectId{2}, "strip_segment_stepper", "Strip segment stepper", nullptr};
+  const EffectDescriptor d3{EffectId{3}, "coord_color", "Coord_Color_Test", nullptr};
+  const EffectDescriptor d4{EffectId{4}, "rainbow_pulse", "Rainbow_Pulse", nullptr};
+  const EffectDescriptor d5{EffectId{5}, "seven_comets", "Seven_Comets", nullptr};
+  const EffectDescriptor d6{EffectId{6}, "hrv_hexagon", "HRV hexagon", nullptr};
+  const EffectDescriptor d7{EffectId{7}, "breathing", "Breathing", nullptr};
+  const EffectDescriptor d8{EffectId{8}, "layers", "Layers: Rainbow + Comets", nullptr};
+  const EffectDescriptor dl1{EffectId{0}, "rainbow_pulse", "Rainbow_Pulse", nullptr};
+  const EffectDescriptor dl2{EffectId{0}, "seven_comets", "Seven_Comets", nullptr};
+
+  chromance::core::LegacyEffectAdapter mode1{d1, &index_walk};
+  chromance::core::LegacyEffectAdapter mode2{d2, &strip_segment_stepper};
+  chromance::core::LegacyEffectAdapter mode3{d3, &coord_color};
+  chromance::core::LegacyEffectAdapter mode4{d4, &rainbow_pulse};
+  chromance::core::LegacyEffectAdapter mode5{d5, &two_dots};
+  chromance::core::LegacyEffectAdapter mode6{d6, &hrv_hexagon};
+  chromance::core::BreathingEffectV2 mode7{d7, &breathing};
+  chromance::core::LegacyEffectAdapter layer1{dl1, &layer_rainbow};
+  chromance::core::LegacyEffectAdapter layer2{dl2, &layer_comets};
+  chromance::core::LayerStackEffect<kLedCount> mode8{d8};
+
+  void add_to(chromance::core::EffectCatalog<kMaxEffects>* catalog) {
+    (void)catalog->add(mode1.descriptor(), &mode1);
+    (void)catalog->add(mode2.descriptor(), &mode2);
+    (void)catalog->add(mode3.descriptor(), &mode3);
+    (void)catalog->add(mode4.descriptor(), &mode4);
+    (void)catalog->add(mode5.descriptor(), &mode5);
+    (void)catalog->add(mode6.descriptor(), &mode6);
+    (void)catalog->add(mode7.descriptor(), &mode7);
+    (void)mode8.add_layer(&layer1, chromance::core::BlendMode::kAlpha, 160);
+    (void)mode8.add_layer(&layer2, chromance::core::BlendMode::kScreen, 255);
+    (void)catalog->add(mode8.descriptor(), &mode8);
+  }
+};
+
+uint32_t host_micros() {
+  static const auto t0 = std::chrono::steady_clock::now();
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count());
+}
+
+bool read_file(const char* path, std::string* out) {
+  FILE* f = fopen(path, "rb");
+  if (f == nullptr) return false;
+  char buf[4096];
+  size_t n = 0;
+  out->clear();
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out->append(buf, n);
+  fclose(f);
+  return true;
+}
+
+bool write_file(const std::string& path, const std::vector<uint8_t>& bytes) {
+  FILE* f = fopen(path.c_str(), "wb");
+  const bool ok = f != nullptr && fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+  if (f != nullptr) fclose(f);
+  if (!ok) perror(path.c_str());
+  return ok;
+}
+
+bool load_script(const char* path, std::vector<chromance::core::ScriptEvent>* out) {
+  std::string text;
+  if (!read_file(path, &text)) {
+    perror(path);
+    return false;
+  }
+  size_t line_no = 0;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t end = text.find('\n', pos);
+    if (end == std::string::npos) end = text.size();
+    const std::string line = text.substr(pos, end - pos);
+    pos = end + 1;
+    ++line_no;
+    chromance::core::ScriptEvent ev;
+    const chromance::core::ScriptLine r = chromance::core::parse_script_line(line.c_str(), &ev);
+    if (r == chromance::core::ScriptLine::kBlank) continue;
+    if (r == chromance::core::ScriptLine::kError || (!out->empty() && ev.at_ms < out->back().at_ms)) {
+      fprintf(stderr, "%s:%zu: bad or out-of-order line: %s\n", path, line_no, line.c_str());
+      return false;
+    }
+    out->push_back(ev);
+  }
+  return true;
+}
+
+// Pixel placement from pixels.json ({"width", "height", "pixels": [{"i", "x", "y"}, ...]}); checked against
+// the compiled mapping so images never pair a stale layout with the firmware's LED order.
+struct Layout {
+  int width = 0;
+  int height = 0;
+  std::vector<int> x;
+  std::vector<int> y;
+};
+
+bool json_int_after(const std::string& s, const char* key, size_t from, size_t* at, int* out) {
+  const std::string k = std::string("\"") + key + "\"";
+  const size_t p = s.find(k, from);
+  if (p == std::string::npos) return false;
+  const size_t colon = s.find(':', p + k.size());
+  if (colon == std::string::npos) return false;
+  char* end = nullptr;
+  *out = static_cast<int>(strtol(s.c_str() + colon + 1, &end, 10));
+  *at = static_cast<size_t>(end - s.c_str());
+  return end != s.c_str() + colon + 1;
+}
+
+bool load_layout(const char* path, Layout* out) {
+  std::string s;
+  if (!read_file(path, &s)) {
+    perror(path);
+    return false;
+  }
+  size_t at = 0;
+  if (!json_int_after(s, "width", 0, &at, &out->width) || !json_int_after(s, "height", 0, &at, &out->height)) {
+    fprintf(stderr, "%s: missing width/height\n", path);
+    return false;
+  }
+  if (s.find(std::string("\"") + chromance::core::MappingTables::mapping_version() + "\"") == std::string::npos) {
+    fprintf(stderr, "%s: mappingVersion differs from the compiled mapping (%s)\n", path,
+            chromance::core::MappingTables::mapping_version());
+    return false;
+  }
+  out->x.assign(kLedCount, -1);
+  out->y.assign(kLedCount, -1);
+  size_t pos = s.find("\"pixels\"");
+  size_t n = 0;
+  int i = 0;
+  while (pos != std::string::npos && json_int_after(s, "i", pos, &pos, &i)) {
+    int x = 0;
+    int y = 0;
+    if (!json_int_after(s, "x", pos, &pos, &x) || !json_int_after(s, "y", pos, &pos, &y) || i < 0 ||
+        static_cast<size_t>(i) >= kLedCount || x < 0 || x >= out->width || y < 0 || y >= out->height) {
+      fprintf(stderr, "%s: bad pixel entry near LED %d\n", path, i);
+      return false;
+    }
+    out->x[i] = x;
+    out->y[i] = y;
+    ++n;
+  }
+  if (n != kLedCount) {
+    fprintf(stderr, "%s: %zu pixels, firmware has %zu LEDs\n", path, n, kLedCount);
+    return false;
+  }
+  return true;
+}
+
+// Rasterizes a frame: each LED is a scale x scale square on black.
+void rasterize(const Layout& l, uint32_t scale, const Rgb* rgb, std::vector<Rgb>* img) {
+  const size_t w = static_cast<size_t>(l.width) * scale;
+  img->assign(w * l.height * scale, chromance::core::kBlack);
+  for (size_t i = 0; i < kLedCount; ++i) {
+    for (uint32_t dy = 0; dy < scale; ++dy) {
+      for (uint32_t dx = 0; dx < scale; ++dx) {
+        (*img)[(l.y[i] * scale + dy) * w + l.x[i] * scale + dx] = rgb[i];
+      }
+    }
+  }
+}
+
+void put_be32(std::vector<uint8_t>* v, uint32_t x) {
+  v->push_back(static_cast<uint8_t>(x >> 24));
+  v->push_back(static_cast<uint8_t>(x >> 16));
+  v->push_back(static_cast<uint8_t>(x >> 8));
+  v->push_back(static_cast<uint8_t>(x));
+}
+
+void put_le16(std::vector<uint8_t>* v, uint32_t x) {
+  v->push_back(static_cast<uint8_t>(x));
+  v->push_back(static_cast<uint8_t>(x >> 8));
+}
+
+uint32_t crc32(const uint8_t* p, size_t n, uint32_t crc = 0) {
+  crc = ~crc;
+  for (size_t i = 0; i < n; ++i) {
+    crc ^= p[i];
+    for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+  }
+  return ~crc;
+}
+
+void png_chunk(std::vector<uint8_t>* png, const char* type, const std::vector<uint8_t>& data) {
+  put_be32(png, static_cast<uint32_t>(data.size()));
+  const size_t start = png->size();
+  png->insert(png->end(), type, type + 4);
+  png->insert(png->end(), data.begin(), data.end());
+  put_be32(png, crc32(png->data() + start, png->size() - start));
+}
+
+// RGB8 PNG with stored (uncompressed) deflate blocks: no zlib dependency, and debug frames are small anyway.
+std::vector<uint8_t> encode_png(const std::vector<Rgb>& img, size_t w, size_t h) {
+  std::vector<uint8_t> raw;
+  raw.reserve(h * (1 + w * 3));
+  for (size_t y = 0; y < h; ++y) {
+    raw.push_back(0);  // filter: none
+    for (size_t x = 0; x < w; ++x) {
+      raw.push_back(img[y * w + x].r);
+      raw.push_back(img[y * w + x].g);
+      raw.push_back(img[y * w + x].b);
+    }
+  }
+  std::vector<uint8_t> z = {0x78, 0x01};
+  for (size_t pos = 0; pos < raw.size() || pos == 0;) {
+    const size_t n = raw.size() - pos < 65535U ? raw.size() - pos : 65535U;
+    z.push_back(pos + n == raw.size() ? 1 : 0);
+    put_le16(&z, static_cast<uint32_t>(n));
+    put_le16(&z, static_cast<uint32_t>(~n & 0xFFFFU));
+    z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + n);
+    pos += n;
+    if (n == 0) break;
+  }
+  uint32_t a = 1;
+  uint32_t b = 0;
+  for (uint8_t c : raw) {
+    a = (a + c) % 65521U;
+    b = (b + a) % 65521U;
+  }
+  put_be32(&z, (b << 16) | a);
+
+  std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  std::vector<uint8_t> ihdr;
+  put_be32(&ihdr, static_cast<uint32_t>(w));
+  put_be32(&ihdr, static_cast<uint32_t>(h));
+  ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0});  // 8-bit RGB
+  png_chunk(&png, "IHDR", ihdr);
+  png_chunk(&png, "IDAT", z);
+  png_chunk(&png, "IEND", {});
+  return png;
+}
+
+// Animated GIF on a fixed 6x7x6 colour cube (252 colours). Frames are LZW-coded as 9-bit literals with a clear
+// code every 250 pixels, so the code table never grows: larger files, trivial encoder.
+class GifWriter {
+ public:
+  bool begin(const char* path, size_t w, size_t h, uint32_t delay_cs) {
+    f_ = fopen(path, "wb");
+    if (f_ == nullptr) return false;
+    w_ = w;
+    h_ = h;
+    delay_cs_ = delay_cs;
+    std::vector<uint8_t> v = {'G', 'I', 'F', '8', '9', 'a'};
+    put_le16(&v, static_cast<uint32_t>(w));
+    put_le16(&v, static_cast<uint32_t>(h));
+    v.insert(v.end(), {0xF7, 0, 0});  // global colour table, 256 entries
+    for (int i = 0; i < 256; ++i) {
+      const int c = i < 252 ? i : 0;
+      v.push_back(static_cast<uint8_t>((c / 42) * 51));
+      v.push_back(static_cast<uint8_t>(((c / 6) % 7) * 255 / 6));
+      v.push_back(static_cast<uint8_t>((c % 6) * 51));
+    }
+    const uint8_t loop[] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 3, 1, 0, 0, 0};
+    v.insert(v.end(), loop, loop + sizeof(loop));
+    return write(v);
+  }
+
+  bool add(const std::vector<Rgb>& img) {
+    std::vector<uint8_t> v = {0x21, 0xF9, 4, 0};
+    put_le16(&v, delay_cs_);
+    v.insert(v.end(), {0, 0, 0x2C, 0, 0, 0, 0});
+    put_le16(&v, static_cast<uint32_t>(w_));
+    put_le16(&v, static_cast<uint32_t>(h_));
+    v.push_back(0);  // no local table
+    v.push_back(8);  // LZW minimum code size
+
+    std::vector<uint8_t> data;
+    uint32_t acc = 0;
+    int bits = 0;
+    const auto emit = [&](uint32_t code) {
+      acc |= code << bits;
+      bits += 9;
+      while (bits >= 8) {
+        data.push_back(static_cast<uint8_t>(acc));
+        acc >>= 8;
+        bits -= 8;
+      }
+    };
+    for (size_t i = 0; i < img.size(); ++i) {
+      if (i % 250U == 0) emit(256);  // clear
+      emit(cube_index(img[i]));
+    }
+    emit(257);  // end of information
+    if (bits > 0) data.push_back(static_cast<uint8_t>(acc));
+    for (size_t pos = 0; pos < data.size(); pos += 255) {
+      const size_t n = data.size() - pos < 255U ? data.size() - pos : 255U;
+      v.push_back(static_cast<uint8_t>(n));
+      v.insert(v.end(), data.begin() + pos, data.begin() + pos + n);
+    }
+    v.push_back(0);
+    ++frames_;
+    return write(v);
+  }
+
+  bool end() {
+    if (f_ == nullptr) return false;
+    const bool ok = write(std::vector<uint8_t>{0x3B});
+    fclose(f_);
+    f_ = nullptr;
+    return ok;
+  }
+
+  uint32_t frames() const { return frames_; }
+
+ private:
+  static uint32_t cube_index(const Rgb& c) {
+    return static_cast<uint32_t>(((c.r + 25) / 51) * 42 + ((c.g * 6 + 127) / 255) * 6 + (c.b + 25) / 51);
+  }
+
+  bool write(const std::vector<uint8_t>& v) { return fwrite(v.data(), 1, v.size(), f_) == v.size(); }
+
+  FILE* f_ = nullptr;
+  size_t w_ = 0;
+  size_t h_ = 0;
+  uint32_t delay_cs_ = 2;
+  uint32_t frames_ = 0;
+};
+
+bool load_golden(const char* path, std::vector<uint32_t>* hashes) {
+  std::string text;
+  if (!read_file(path, &text)) {
+    perror(path);
+    return false;
+  }
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t end = text.find('\n', pos);
+    if (end == std::string::npos) end = text.size();
+    const std::string line = text.substr(pos, end - pos);
+    pos = end + 1;
+    unsigned frame = 0;
+    unsigned ms = 0;
+    unsigned hash = 0;
+    if (line.empty() || line[0] == '#') continue;
+    if (sscanf(line.c_str(), "%u %u %x", &frame, &ms, &hash) != 3 || frame != hashes->size()) {
+      fprintf(stderr, "%s: bad line: %s\n", path, line.c_str());
+      return false;
+    }
+    hashes->push_back(hash);
+  }
+  return true;
+}
+
+bool parse_options(int argc, char** argv, Options* opt) {
+  for (int i = 1; i < argc; i += 2) {
+    const char* k = argv[i];
+    const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+    const unsigned long n = v != nullptr ? strtoul(v, nullptr, 0) : 0;
+    if (v == nullptr) {
+      fprintf(stderr, "missing value for %s\n", k);
+      return false;
+    } else if (strcmp(k, "--frames") == 0 && n > 0) {
+      opt->frames = static_cast<uint32_t>(n);
+    } else if (strcmp(k, "--fps") == 0 && n > 0 && n <= 1000) {
+      opt->fps = static_cast<uint16_t>(n);
+    } else if (strcmp(k, "--effect") == 0 && n > 0 && n <= 0xFFFF) {
+      opt->effect = static_cast<uint16_t>(n);
+    } else if (strcmp(k, "--start-ms") == 0) {
+      opt->start_ms = static_cast<uint32_t>(n);
+    } else if (strcmp(k, "--transition-ms") == 0 && n <= 0xFFFF) {
+      opt->transition_ms = static_cast<uint16_t>(n);
+    } else if (strcmp(k, "--max-idle-ms") == 0) {
+      opt->max_idle_ms = static_cast<uint32_t>(n);
+    } else if (strcmp(k, "--script") == 0) {
+      opt->script = v;
+    } else if (strcmp(k, "--hashes") == 0) {
+      opt->hashes = v;
+    } else if (strcmp(k, "--golden") == 0) {
+      opt->golden = v;
+    } else if (strcmp(k, "--png-dir") == 0) {
+      opt->png_dir = v;
+    } else if (strcmp(k, "--png-every") == 0 && n > 0) {
+      opt->png_every = static_cast<uint32_t>(n);
+    } else if (strcmp(k, "--gif") == 0) {
+      opt->gif = v;
+    } else if (strcmp(k, "--gif-every") == 0 && n > 0) {
+      opt->gif_every = static_cast<uint32_t>(n);
+    } else if (strcmp(k, "--pixels") == 0) {
+      opt->pixels = v;
+    } else if (strcmp(k, "--scale") == 0 && n > 0 && n <= 16) {
+      opt->scale = static_cast<uint32_t>(n);
+    } else {
+      fprintf(stderr, "bad option %s %s\n", k, v);
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parse_options(argc, argv, &opt)) {
+    fprintf(stderr, "usage: %s [--frames N] [--fps N] [--effect ID] [--start-ms MS] [--script FILE] "
+                    "[--hashes FILE] [--golden FILE] [--png-dir DIR] [--png-every N] [--gif FILE] [--gif-every N] "
+                    "[--pixels FILE] [--scale N] [--transition-ms MS] [--max-idle-ms MS]\n", argv[0]);
+    return 2;
+  }
+
+  std::vector<chromance::core::ScriptEvent> script;
+  if (opt.script != nullptr && !load_script(opt.script, &script)) return 2;
+  std::vector<uint32_t> golden;
+  if (opt.golden != nullptr && !load_golden(opt.golden, &golden)) return 2;
+  Layout layout;
+  if ((opt.png_dir != nullptr || opt.gif != nullptr) && !load_layout(opt.pixels, &layout)) return 2;
+
+  static Effects effects;
+  static chromance::core::EffectCatalog<kMaxEffects> catalog;
+  static chromance::core::EffectManager<kMaxEffects> manager;
+  static chromance::core::MemorySettingsStore<kMaxEffects + 4> store;
+  static const chromance::core::PixelsMap map;
+  static Rgb rgb[kLedCount];
+  NullLedOutput led_out;
+  effects.add_to(&catalog);
+
+  // Boot like setup(): init, then warm every effect before the first frame (the device does this in idle time).
+  manager.init(store, catalog, map, opt.start_ms, EffectId{opt.effect});
+  manager.set_transition_ms(opt.transition_ms);
+  manager.set_max_idle_ms(opt.max_idle_ms);
+  uint64_t prepare_us = 0;
+  while (manager.prepare_pending()) {
+    const uint32_t t0 = host_micros();
+    (void)manager.prepare_next(opt.start_ms);
+    prepare_us += host_micros() - t0;
+  }
+  const uint32_t boot_writes = store.writes();
+
+  chromance::core::HeadlessRunner<chromance::core::EffectManager<kMaxEffects>> runner(manager, opt.fps,
+                                                                                       opt.start_ms);
+  runner.set_script(script.data(), script.size());
+  runner.set_timer(&host_micros);
+
+  FILE* hashes = opt.hashes != nullptr ? fopen(opt.hashes, "w") : stdout;
+  if (hashes == nullptr) {
+    perror(opt.hashes);
+    return 2;
+  }
+  GifWriter gif;
+  const size_t img_w = static_cast<size_t>(layout.width) * opt.scale;
+  const size_t img_h = static_cast<size_t>(layout.height) * opt.scale;
+  if (opt.gif != nullptr &&
+      !gif.begin(opt.gif, img_w, img_h, (opt.gif_every * 100U + opt.fps / 2U) / opt.fps)) {
+    perror(opt.gif);
+    return 2;
+  }
+
+  struct EffectPerf {
+    uint32_t rendered = 0;
+    uint64_t us = 0;
+    uint32_t max_us = 0;
+  };
+  std::vector<EffectPerf> per_effect(0x10000);
+  std::vector<Rgb> img;
+  uint32_t mismatches = 0;
+  int64_t first_mismatch = -1;
+  const uint32_t t_start = host_micros();
+
+  fprintf(hashes, "# frame now_ms hash effect rendered (mapping %s, %zu LEDs, %u fps)\n",
+          chromance::core::MappingTables::mapping_version(), kLedCount, opt.fps);
+  for (uint32_t f = 0; f < opt.frames; ++f) {
+    const chromance::core::HeadlessFrame fr = runner.step(rgb, kLedCount);
+    if (fr.rendered) {
+      chromance::platform::PerfStats stats{0, 0};
+      led_out.show(rgb, kLedCount, &stats);
+      EffectPerf& p = per_effect[fr.effect_id];
+      ++p.rendered;
+      p.us += fr.render_us;
+      if (fr.render_us > p.max_us) p.max_us = fr.render_us;
+    }
+    fprintf(hashes, "%u %u %08x %u %c\n", fr.index, fr.now_ms, fr.hash, fr.effect_id, fr.rendered ? 'R' : 'H');
+
+    if (opt.golden != nullptr && (f >= golden.size() || golden[f] != fr.hash)) {
+      ++mismatches;
+      if (first_mismatch < 0) first_mismatch = f;
+    }
+    if (opt.png_dir != nullptr && f % opt.png_every == 0) {
+      rasterize(layout, opt.scale, rgb, &img);
+      char name[32];
+      snprintf(name, sizeof(name), "/frame_%05u.png", f);
+      if (!write_file(std::string(opt.png_dir) + name, encode_png(img, img_w, img_h))) return 1;
+    }
+    if (opt.gif != nullptr && f % opt.gif_every == 0) {
+      rasterize(layout, opt.scale, rgb, &img);
+      if (!gif.add(img)) {
+        perror(opt.gif);
+        return 1;
+      }
+    }
+  }
+  const uint32_t wall_us = host_micros() - t_start;
+  if (hashes != stdout) fclose(hashes);
+  if (opt.gif != nullptr) gif.end();
+
+  // Perf counters go to stderr so stdout stays a clean hash listing.
+  const chromance::core::HeadlessStats& s = runner.stats();
+  const chromance::core::TransitionStats& ts = manager.transition_stats();
+  fprintf(stderr, "frames %u (%u rendered, %u held), %u events (%u rejected), %.1f s simulated, %.3f s wall\n",
+          s.frames, s.rendered, s.held, s.events, s.rejected_events,
+          (runner.now_ms() - opt.start_ms) / 1000.0, wall_us / 1e6);
+  fprintf(stderr, "render us: avg %.1f max %u; boot prepare %llu us\n",
+          s.rendered ? static_cast<double>(s.render_us_total) / s.rendered : 0.0, s.render_us_max,
+          static_cast<unsigned long long>(prepare_us));
+  fprintf(stderr, "transitions: %u started, %u shortened, %u hard cuts\n", ts.started, ts.shortened,
+          ts.hard_cuts);
+  fprintf(stderr, "led output: %u flushes, %llu bytes; settings writes: %u after boot (%u keys)\n", led_out.shows,
+          static_cast<unsigned long long>(led_out.bytes), store.writes() - boot_writes,
+          static_cast<unsigned>(store.key_count()));
+  for (size_t id = 0; id < per_effect.size(); ++id) {
+    const EffectPerf& p = per_effect[id];
+    if (p.rendered == 0) continue;
+    const chromance::core::IEffectV2* e = catalog.find_by_id(EffectId{static_cast<uint16_t>(id)});
+    const double avg_us = static_cast<double>(p.us) / p.rendered;
+    fprintf(stderr, "  effect %2zu %-26s %6u frames  avg %7.1f us  max %6u us  %6.1f ns/LED\n", id,
+            e != nullptr ? e->descriptor().display_name : "?", p.rendered, avg_us, p.max_us,
+            avg_us * 1000.0 / kLedCount);
+  }
+  if (opt.gif != nullptr) fprintf(stderr, "gif: %u frames -> %s\n", gif.frames(), opt.gif);
+
+  if (opt.golden != nullptr) {
+    if (golden.size() != opt.frames) {
+      fprintf(stderr, "golden: %zu frames, run has %u\n", golden.size(), opt.frames);
+      return 1;
+    }
+    if (mismatches != 0) {
+      fprintf(stderr, "golden: %u frame(s) differ, first at frame %lld\n", mismatches,
+              static_cast<long long>(first_mismatch));
+      return 1;
+    }
+    fprintf(stderr, "golden: all %u frames match\n", opt.frames);
+  }
+  return 0;
+}
@@ -0,0 +1,353 @@
+// Times per-LED mapping lookups through the flat generated tables against the same lookups decoded from the
+// compact segment runs (core/mapping/compact_mapping.h), in wiring order and in a shuffled order, and prints
+// what each encoding costs in flash. Also times the flat lookup through the generated arrays directly against
+// the active table set (MappingTables), before and after installing a mapping blob (core/mapping/mapping_blob.h).
+// Last, stages a frame into per-strip wire buffers the way index-order layouts must (scattered through
+// global_to_strip / global_to_local) and the way wire-order layouts can (one copy per strip span), and builds
+// an APA102 wire frame (core/apa102.h) by rendering Rgb and encoding it, against rendering it directly.
+// Every variant must produce the same checksum; exits 1 if one does not.
+//
+// Build and run from the repo root (include/generated/ must exist, see tools/headless_runtime/README.md):
+//   g++ -std=gnu++11 -O2 -Isrc -Iinclude tools/mapping_bench/mapping_bench.cpp -o /tmp/mapping_bench
+//   /tmp/mapping_bench [passes] [mapping.bin]
+//
+// With mapping.bin (generate_ledmap.py --out-blob) the blob timed is that file, which must match the build's
+// tables byte for byte; otherwise it is the build's own tables encoded in memory.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "core/apa102.h"
+#include "core/effects/pattern_coord_color.h"
+#include "core/mapping/compact_mapping.h"
+#include "core/mapping/mapping_blob.h"
+#include "core/layout.h"
+#include "core/mapping/mapping_tables.h"
+#include "core/mapping/pixels_map.h"
+#include "core/strip_layout.h"
+#include "core/types.h"
+
+namespace {
+
+using chromance::core::CompactMapping;
+using chromance::core::CoordColorEffect;
+using chromance::core::EffectFrame;
+using chromance::core::MappingBlob;
+using chromance::core::MappingTables;
+using chromance::core::PixelCoord;
+using chromance::core::PixelsMap;
+using chromance::core::Rgb;
+using chromance::core::StripPixel;
+
+constexpr uint8_t kLedsPerSegment = MappingTables::leds_per_segment();
+
+volatile uint32_t g_sink = 0;
+
+struct Timing {
+  double ns_per_led;
+  uint32_t checksum;
+};
+
+// Runs body(led) over order for passes passes and returns the average cost per lookup.
+template <typename Body>
+Timing time_lookups(const std::vector<uint16_t>& order, uint32_t passes, Body body) {
+  uint32_t sum = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t p = 0; p < passes; ++p) {
+    for (size_t i = 0; i < order.size(); ++i) {
+      sum = sum * 31U + body(order[i]);
+    }
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  g_sink = g_sink + sum;
+  const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+  return Timing{ns / (static_cast<double>(passes) * static_cast<double>(order.size())), sum};
+}
+
+uint32_t pack_coord(const PixelCoord& c) {
+  return static_cast<uint16_t>(c.x) ^ (static_cast<uint32_t>(static_cast<uint16_t>(c.y)) << 16);
+}
+
+uint32_t flat_coord(uint16_t i) {
+  return pack_coord(PixelCoord{MappingTables::pixel_x()[i], MappingTables::pixel_y()[i]});
+}
+
+// The generated arrays themselves, as every lookup compiled to before tables could be installed at boot.
+uint32_t direct_coord(uint16_t i) {
+  return pack_coord(PixelCoord{chromance::mapping::pixel_x[i], chromance::mapping::pixel_y[i]});
+}
+
+uint32_t compact_coord(uint16_t i) { return pack_coord(CompactMapping::coord(i)); }
+
+uint32_t flat_output(uint16_t i) {
+  return MappingTables::global_to_strip()[i] ^ (static_cast<uint32_t>(MappingTables::global_to_local()[i]) << 8);
+}
+
+uint32_t compact_output(uint16_t i) {
+  return CompactMapping::strip(i) ^ (static_cast<uint32_t>(CompactMapping::local(i)) << 8);
+}
+
+uint32_t flat_topology(uint16_t i) {
+  return MappingTables::global_to_seg()[i] ^ (static_cast<uint32_t>(MappingTables::global_to_seg_k()[i]) << 8) ^
+         (static_cast<uint32_t>(MappingTables::global_to_dir()[i]) << 16);
+}
+
+uint32_t compact_topology(uint16_t i) {
+  return CompactMapping::segment(i) ^ (static_cast<uint32_t>(CompactMapping::seg_k(i)) << 8) ^
+         (static_cast<uint32_t>(CompactMapping::dir(i)) << 16);
+}
+
+// Wiring-order sweep that decodes one run at a time, as a render loop over the whole wall would.
+Timing time_run_sweep(uint32_t passes) {
+  PixelCoord run[kLedsPerSegment];
+  uint32_t sum = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t p = 0; p < passes; ++p) {
+    for (uint16_t r = 0; r < MappingTables::run_count(); ++r) {
+      CompactMapping::run_coords(r, run);
+      for (uint8_t k = 0; k < kLedsPerSegment; ++k) {
+        sum = sum * 31U + pack_coord(run[k]);
+      }
+    }
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  g_sink = g_sink + sum;
+  const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+  return Timing{ns / (static_cast<double>(passes) * MappingTables::led_count()), sum};
+}
+
+// Hoisted like the render loops: one read of the active set per sweep, then plain pointer loads.
+Timing time_hoisted_coords(uint32_t passes) {
+  uint32_t sum = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t p = 0; p < passes; ++p) {
+    const int16_t* xs = MappingTables::pixel_x();
+    const int16_t* ys = MappingTables::pixel_y();
+    for (uint16_t i = 0; i < MappingTables::led_count(); ++i) {
+      sum = sum * 31U + pack_coord(PixelCoord{xs[i], ys[i]});
+    }
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  g_sink = g_sink + sum;
+  const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+  return Timing{ns / (static_cast<double>(passes) * MappingTables::led_count()), sum};
+}
+
+uint32_t strip_checksum(const std::vector<std::vector<Rgb>>& strips) {
+  uint32_t sum = 0;
+  for (size_t s = 0; s < strips.size(); ++s) {
+    for (size_t p = 0; p < strips[s].size(); ++p) {
+      sum = sum * 31U + (strips[s][p].r ^ (static_cast<uint32_t>(strips[s][p].g) << 8) ^
+                         (static_cast<uint32_t>(strips[s][p].b) << 16));
+    }
+  }
+  return sum;
+}
+
+// Index order: every LED goes through global_to_strip / global_to_local to find its place on the wire.
+Timing time_scatter(const std::vector<Rgb>& frame, std::vector<std::vector<Rgb>>* strips, uint32_t passes) {
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t p = 0; p < passes; ++p) {
+    const uint8_t* g2s = MappingTables::global_to_strip();
+    const uint16_t* g2l = MappingTables::global_to_local();
+    for (uint16_t i = 0; i < MappingTables::led_count(); ++i) {
+      (*strips)[g2s[i]][g2l[i]] = frame[i];
+    }
+    g_sink = g_sink + (*strips)[p % strips->size()][0].r;
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+  return Timing{ns / (static_cast<double>(passes) * MappingTables::led_count()), strip_checksum(*strips)};
+}
+
+// Wire order: each strip is a contiguous span of the frame, copied (or on the device, sent) as is.
+Timing time_span_copy(const std::vector<Rgb>& wire_frame, std::vector<std::vector<Rgb>>* strips, uint32_t passes) {
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t p = 0; p < passes; ++p) {
+    for (uint8_t s = 0; s < MappingTables::strip_count(); ++s) {
+      memcpy((*strips)[s].data(), wire_frame.data() + chromance::core::strip_first_led(s),
+             (*strips)[s].size() * sizeof(Rgb));
+    }
+    g_sink = g_sink + (*strips)[p % strips->size()][0].r;
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+  return Timing{ns / (static_cast<double>(passes) * MappingTables::led_count()), strip_checksum(*strips)};
+}
+
+uint32_t wire_checksum(const std::vector<StripPixel>& wire) {
+  uint32_t sum = 0;
+  for (size_t i = 0; i < wire.size(); ++i) {
+    sum = sum * 31U + (wire[i].bytes[0] ^ (static_cast<uint32_t>(wire[i].bytes[1]) << 8) ^
+                       (static_cast<uint32_t>(wire[i].bytes[2]) << 16) ^
+                       (static_cast<uint32_t>(wire[i].bytes[3]) << 24));
+  }
+  return sum;
+}
+
+// Wire frame for an Rgb-only effect: render into the Rgb frame, then convert every LED into wire bytes.
+Timing time_render_encode(uint32_t passes) {
+  CoordColorEffect effect;
+  const PixelsMap map;
+  EffectFrame frame;
+  std::vector<Rgb> rgb(MappingTables::led_count());
+  std::vector<StripPixel> wire(rgb.size());
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t p = 0; p < passes; ++p) {
+    frame.params.brightness = static_cast<uint8_t>(255U - (p & 1U));
+    effect.render(frame, map, rgb.data(), rgb.size());
+    chromance::core::encode_apa102(rgb.data(), wire.data(), rgb.size());
+    g_sink = g_sink + wire[p % wire.size()].bytes[1];
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+  return Timing{ns / (static_cast<double>(passes) * MappingTables::led_count()), wire_checksum(wire)};
+}
+
+// Opt-in effect (IEffect::render_wire): the same frame written straight as wire pixels.
+Timing time_render_wire(uint32_t passes) {
+  CoordColorEffect effect;
+  const PixelsMap map;
+  EffectFrame frame;
+  std::vector<StripPixel> wire(MappingTables::led_count());
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t p = 0; p < passes; ++p) {
+    frame.params.brightness = static_cast<uint8_t>(255U - (p & 1U));
+    effect.render_wire(frame, map, wire.data(), wire.size());
+    g_sink = g_sink + wire[p % wire.size()].bytes[1];
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+  return Timing{ns / (static_cast<double>(passes) * MappingTables::led_count()), wire_checksum(wire)};
+}
+
+// Reads the blob at path into blob (4-byte aligned, as flash mapping gives). False if it cannot be read.
+bool read_blob(const char* path, std::vector<uint32_t>* blob, size_t* size) {
+  FILE* f = fopen(path, "rb");
+  if (f == nullptr) return false;
+  blob->assign(65536U / 4U, 0);
+  *size = fread(blob->data(), 1, blob->size() * 4U, f);
+  fclose(f);
+  return *size > 0;
+}
+
+bool report(const char* what, const char* order, const Timing& flat, const Timing& compact) {
+  const bool same = flat.checksum == compact.checksum;
+  printf("%-22s %-8s %8.2f %8.2f %6.2fx%s\n", what, order, flat.ns_per_led, compact.ns_per_led,
+         compact.ns_per_led / flat.ns_per_led, same ? "" : "  CHECKSUM MISMATCH");
+  return same;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const uint32_t passes = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 2000U;
+  if (passes == 0) {
+    fprintf(stderr, "usage: %s [passes] [mapping.bin]\n", argv[0]);
+    return 2;
+  }
+
+  const uint16_t n = MappingTables::led_count();
+  std::vector<uint16_t> wiring(n);
+  for (uint16_t i = 0; i < n; ++i) wiring[i] = i;
+  // Fixed-seed Fisher-Yates, so runs are comparable.
+  std::vector<uint16_t> shuffled(wiring);
+  uint32_t seed = 0x2545F491U;
+  for (uint16_t i = static_cast<uint16_t>(n - 1U); i > 0; --i) {
+    seed = seed * 1664525U + 1013904223U;
+    const uint16_t j = static_cast<uint16_t>((seed >> 8) % (i + 1U));
+    const uint16_t t = shuffled[i];
+    shuffled[i] = shuffled[j];
+    shuffled[j] = t;
+  }
+
+  const size_t flat_bytes = n * (2U * sizeof(int16_t) + sizeof(uint8_t) + sizeof(uint16_t) + 3U * sizeof(uint8_t));
+  const size_t run_bytes = MappingTables::run_count() * sizeof(uint32_t);
+  const size_t vertex_bytes = 2U * MappingTables::vertex_count() + 2U * (MappingTables::segment_count() + 1U);
+  printf("mapping %s: %u LEDs, %u segment runs, %u passes\n", MappingTables::mapping_version(), n,
+         MappingTables::run_count(), passes);
+  printf("flash: flat tables %zu B (10 B/LED); compact %zu B runs + %zu B vertex/segment tables (shared)\n\n",
+         flat_bytes, run_bytes, vertex_bytes);
+
+  printf("%-22s %-8s %8s %8s %7s\n", "lookup", "order", "flat", "compact", "ratio");
+  printf("%-22s %-8s %8s %8s\n", "", "", "ns/LED", "ns/LED");
+  bool ok = true;
+  const std::vector<uint16_t>* orders[] = {&wiring, &shuffled};
+  const char* order_names[] = {"wiring", "shuffled"};
+  for (int o = 0; o < 2; ++o) {
+    const std::vector<uint16_t>& order = *orders[o];
+    ok &= report("coord (x, y)", order_names[o], time_lookups(order, passes, flat_coord),
+                 time_lookups(order, passes, compact_coord));
+    ok &= report("output (strip, local)", order_names[o], time_lookups(order, passes, flat_output),
+                 time_lookups(order, passes, compact_output));
+    ok &= report("topology (seg, k, dir)", order_names[o], time_lookups(order, passes, flat_topology),
+                 time_lookups(order, passes, compact_topology));
+  }
+  ok &= report("coord, per run", "wiring", time_lookups(wiring, passes, flat_coord), time_run_sweep(passes));
+
+  // Table source: the same flat coordinate lookup, through the generated arrays and through the active set.
+  std::vector<uint32_t> encoded(MappingBlob::build_bytes() / 4U + 1U);
+  uint8_t* encoded_bytes = reinterpret_cast<uint8_t*>(encoded.data());
+  const size_t encoded_size = MappingBlob::encode(MappingTables::compiled(), encoded_bytes, encoded.size() * 4U);
+  std::vector<uint32_t> file;
+  size_t file_size = 0;
+  const std::vector<uint32_t>* blob = &encoded;
+  size_t blob_size = encoded_size;
+  if (argc > 2) {
+    if (!read_blob(argv[2], &file, &file_size)) {
+      fprintf(stderr, "cannot read %s\n", argv[2]);
+      return 2;
+    }
+    const bool same = file_size == encoded_size && memcmp(file.data(), encoded.data(), encoded_size) == 0;
+    printf("\n%s: %zu B, %s the build's tables\n", argv[2], file_size, same ? "identical to" : "DIFFERS FROM");
+    ok &= same;
+    blob = &file;
+    blob_size = file_size;
+  }
+  MappingBlob view;
+  if (!view.open(reinterpret_cast<const uint8_t*>(blob->data()), blob_size) || !view.compatible()) {
+    fprintf(stderr, "mapping blob rejected (invalid, or shaped for another build)\n");
+    return 1;
+  }
+  printf("\n%-22s %-8s %8s %8s %7s\n", "coord (x, y) source", "order", "direct", "active", "ratio");
+  ok &= report("compiled set", "shuffled", time_lookups(shuffled, passes, direct_coord),
+               time_lookups(shuffled, passes, flat_coord));
+  ok &= report("compiled set, hoisted", "wiring", time_lookups(wiring, passes, direct_coord),
+               time_hoisted_coords(passes));
+  MappingTables::install(view.tables());
+  ok &= report("blob set", "shuffled", time_lookups(shuffled, passes, direct_coord),
+               time_lookups(shuffled, passes, flat_coord));
+  ok &= report("blob set, hoisted", "wiring", time_lookups(wiring, passes, direct_coord),
+               time_hoisted_coords(passes));
+  MappingTables::install_compiled();
+  printf("mapping blob: %zu B (%u B of it header and directory)\n", view.size(),
+         static_cast<unsigned>(chromance::core::mapping_blob::kHeaderBytes + 4U * MappingBlob::kTableCount));
+
+  // Output staging. The wire-order frame is this frame renumbered as generate_ledmap.py --wire-order would;
+  // in a wire-order build it is the same frame.
+  std::vector<Rgb> frame(n);
+  std::vector<Rgb> wire_frame(n);
+  for (uint16_t i = 0; i < n; ++i) {
+    seed = seed * 1664525U + 1013904223U;
+    frame[i] = Rgb{static_cast<uint8_t>(seed >> 8), static_cast<uint8_t>(seed >> 16), static_cast<uint8_t>(seed >> 24)};
+    const uint8_t strip = MappingTables::global_to_strip()[i];
+    wire_frame[chromance::core::strip_first_led(strip) + MappingTables::global_to_local()[i]] = frame[i];
+  }
+  std::vector<std::vector<Rgb>> strips(MappingTables::strip_count());
+  for (uint8_t s = 0; s < MappingTables::strip_count(); ++s) {
+    strips[s].assign(chromance::core::strip_led_count(chromance::core::strip_config(s)), Rgb{0, 0, 0});
+  }
+  printf("\n%-22s %-8s %8s %8s %7s\n", "frame -> strip buffers", "order", "index", "wire", "ratio");
+  const Timing scatter = time_scatter(frame, &strips, passes);
+  ok &= report("output staging", MappingTables::wire_order() ? "wire" : "index", scatter,
+               time_span_copy(wire_frame, &strips, passes));
+
+  printf("\n%-22s %-8s %8s %8s %7s\n", "effect -> wire frame", "effect", "encode", "direct", "ratio");
+  ok &= report("wire frame", "coord", time_render_encode(passes), time_render_wire(passes));
+  return ok ? 0 : 1;
+}
@@ -1,5 +1,6 @@
 import { useEffect, useState } from "preact/hooks";
 import { apiGet, apiPost } from "../lib/api";
+import { control } from "../lib/control";
 import { slugFromPathname } from "../lib/slug";
 
 type ParamType = "int" | "float" | "bool" | "enum" | "color";
@@ -17,6 +18,8 @@ type ParamDescriptor = {
 
 type Stage = { id: number; name: string; displayName: string };
 
+type Layer = { slug: string; displayName: string; opacityParam: number; modeParam?: number };
+
 type EffectDetail = {
   id: number;
   canonicalSlug: string;
@@ -27,6 +30,7 @@ type EffectDetail = {
   schema?: { params: ParamDescriptor[] };
   values?: Record<string, number | boolean>;
   stages?: { items: Stage[]; currentId: number };
+  layers?: { blendModes: string[]; items: Layer[] };
 };
 
 export default function EffectDetailIsland() {
@@ -44,6 +48,7 @@ export default function EffectDetailIsland() {
 
   useEffect(() => {
     setSlug(typeof window === "undefined" ? null : slugFromPathname(window.location.pathname));
+    control.connect();
   }, []);
 
   useEffect(() => {
@@ -55,11 +60,32 @@ export default function EffectDetailIsland() {
   if (!slug) return <div class="loading loading-spinner" />;
   if (!data) return <div class="loading loading-spinner" />;
 
+  function toRaw(p: ParamDescriptor, next: number | boolean): number {
+    if (typeof next === "boolean") return next ? 1 : 0;
+    if (p.type === "float") return Math.round(next * (p.scale ?? 1));
+    return next;
+  }
+
+  // Streams over the control channel when it is open; otherwise falls back to the REST endpoint.
   async function setParam(p: ParamDescriptor, next: number | boolean) {
-    await apiPost("/api/effects/" + data.canonicalSlug + "/params", { items: [{ id: p.id, value: next }] });
+    if (!control.setParam(data.id, p.id, toRaw(p, next))) {
+      await apiPost("/api/effects/" + data.canonicalSlug + "/params", { items: [{ id: p.id, value: next }] });
+    }
     setValues((v) => ({ ...v, [p.name]: next }));
   }
 
+  // Layer params are edited in the Layers card; everything else is listed under Parameters.
+  const layerParamIds = new Set<number>();
+  for (const l of data.layers?.items ?? []) {
+    layerParamIds.add(l.opacityParam);
+    if (l.modeParam) layerParamIds.add(l.modeParam);
+  }
+  const otherParams = (data.schema?.params ?? []).filter((p) => !layerParamIds.has(p.id));
+
+  function paramById(id?: number): ParamDescriptor | undefined {
+    return id ? data.schema?.params?.find((p) => p.id === id) : undefined;
+  }
+
   async function restart() {
     await apiPost("/api/effects/" + data.canonicalSlug + "/restart", {});
     await refresh(data.canonicalSlug);
@@ -128,7 +154,9 @@ export default function EffectDetailIsland() {
           value={Number(v)}
           onInput={(e) => {
             const t = (e.target as HTMLInputElement).value;
-            setValues((prev) => ({ ...prev, [p.name]: isFloat ? parseFloat(t) : parseInt(t, 10) }));
+            const next = isFloat ? parseFloat(t) : parseInt(t, 10);
+            setValues((prev) => ({ ...prev, [p.name]: next }));
+            control.setParam(data.id, p.id, toRaw(p, next));
           }}
           onChange={(e) => {
             const t = (e.target as HTMLInputElement).value;
@@ -183,28 +211,74 @@ export default function EffectDetailIsland() {
         </div>
       ) : null}
 
-      <div class="card bg-base-100 shadow">
-        <div class="card-body">
-          <div class="font-bold">Parameters</div>
-          {!data.schema?.params?.length ? <div class="text-sm opacity-70">No parameters</div> : null}
-          <div class="space-y-4">
-            {(data.schema?.params ?? []).map((p) => (
-              <div key={p.id} class="space-y-2">
-                <div class="flex items-center justify-between gap-3">
-                  <div class="min-w-0">
-                    <div class="font-semibold">{p.displayName}</div>
-                    <div class="text-xs opacity-70">{p.name}</div>
+      {data.layers?.items?.length ? (
+        <div class="card bg-base-100 shadow">
+          <div class="card-body">
+            <div class="font-bold">Layers</div>
+            <div class="space-y-4">
+              {data.layers.items.map((l, i) => {
+                const mode = paramById(l.modeParam);
+                const opacity = paramById(l.opacityParam);
+                return (
+                  <div key={i} class="space-y-2">
+                    <div class="flex items-center justify-between gap-3">
+                      <div class="min-w-0">
+                        <div class="font-semibold">
+                          {i + 1}. {l.displayName}
+                        </div>
+                        <div class="text-xs opacity-70">{i === 0 ? "base" : l.slug}</div>
+                      </div>
+                      {mode ? (
+                        <select
+                          class="select select-bordered select-sm"
+                          value={Number(values[mode.name] ?? mode.def)}
+                          onChange={(e) =>
+                            setParam(mode, parseInt((e.target as HTMLSelectElement).value, 10)).catch((x) =>
+                              setErr(String(x))
+                            )
+                          }
+                        >
+                          {data.layers!.blendModes.map((name, m) => (
+                            <option key={m} value={m}>
+                              {name}
+                            </option>
+                          ))}
+                        </select>
+                      ) : null}
+                    </div>
+                    {opacity ? renderParamControl(opacity) : null}
                   </div>
-                  <button class="btn btn-xs" onClick={() => setParam(p, p.def).catch((x) => setErr(String(x)))}>
-                    Reset
-                  </button>
+                );
+              })}
+            </div>
+          </div>
+        </div>
+      ) : null}
+
+      {otherParams.length || !data.layers?.items?.length ? (
+        <div class="card bg-base-100 shadow">
+          <div class="card-body">
+            <div class="font-bold">Parameters</div>
+            {!otherParams.length ? <div class="text-sm opacity-70">No parameters</div> : null}
+            <div class="space-y-4">
+              {otherParams.map((p) => (
+                <div key={p.id} class="space-y-2">
+                  <div class="flex items-center justify-between gap-3">
+                    <div class="min-w-0">
+                      <div class="font-semibold">{p.displayName}</div>
+                      <div class="text-xs opacity-70">{p.name}</div>
+                    </div>
+                    <button class="btn btn-xs" onClick={() => setParam(p, p.def).catch((x) => setErr(String(x)))}>
+                      Reset
+                    </button>
+                  </div>
+                  {renderParamControl(p)}
                 </div>
-                {renderParamControl(p)}
-              </div>
-            ))}
+              ))}
+            </div>
           </div>
         </div>
-      </div>
+      ) : null}
     </div>
   );
 }
@@ -0,0 +1,197 @@
+import { useEffect, useState } from "preact/hooks";
+import { apiGet, apiPost } from "../lib/api";
+
+type Effect = { id: number; canonicalSlug: string; displayName: string };
+type EffectsListResponse = { effects: Effect[] };
+
+type Entry = {
+  effectId: number;
+  durationS: number;
+  transitionMs?: number;
+  params: { id: number; raw: number }[];
+};
+type Playlist = {
+  running: boolean;
+  index: number;
+  remainingMs?: number;
+  maxEntries: number;
+  maxParams: number;
+  entries: Entry[];
+};
+
+// Params are edited in raw firmware units as "id=raw" pairs, e.g. "1=128, 3=-20".
+function formatParams(params: Entry["params"]): string {
+  return params.map((p) => `${p.id}=${p.raw}`).join(", ");
+}
+
+function parseParams(text: string): Entry["params"] {
+  return text
+    .split(",")
+    .map((s) => s.trim())
+    .filter((s) => s.length > 0)
+    .map((s) => {
+      const [id, raw] = s.split("=").map((v) => Number(v.trim()));
+      if (!Number.isInteger(id) || !Number.isInteger(raw)) throw new Error("Bad param: " + s);
+      return { id, raw };
+    });
+}
+
+export default function PlaylistIsland() {
+  const [effects, setEffects] = useState<Effect[]>([]);
+  const [data, setData] = useState<Playlist | null>(null);
+  const [entries, setEntries] = useState<Entry[]>([]);
+  const [paramText, setParamText] = useState<string[]>([]);
+  const [err, setErr] = useState<string | null>(null);
+
+  async function refresh(resetEditor: boolean) {
+    const d = await apiGet<Playlist>("/api/playlist");
+    setData(d);
+    if (resetEditor) {
+      setEntries(d.entries);
+      setParamText(d.entries.map((e) => formatParams(e.params)));
+    }
+  }
+
+  useEffect(() => {
+    apiGet<EffectsListResponse>("/api/effects")
+      .then((d) => setEffects(d.effects))
+      .then(() => refresh(true))
+      .catch((e) => setErr(String(e)));
+    const t = setInterval(() => refresh(false).catch(() => {}), 2000);
+    return () => clearInterval(t);
+  }, []);
+
+  function update(i: number, patch: Partial<Entry>) {
+    setEntries(entries.map((e, k) => (k === i ? { ...e, ...patch } : e)));
+  }
+
+  function save() {
+    setErr(null);
+    try {
+      const body = entries.map((e, i) => ({ ...e, params: parseParams(paramText[i] ?? "") }));
+      apiPost("/api/playlist", { entries: body })
+        .then(() => refresh(true))
+        .catch((x) => setErr(String(x)));
+    } catch (x) {
+      setErr(String(x));
+    }
+  }
+
+  function control(action: string) {
+    apiPost("/api/playlist/" + action, {})
+      .then(() => refresh(false))
+      .catch((x) => setErr(String(x)));
+  }
+
+  if (!data) return err ? <div class="alert alert-error">{err}</div> : <div class="loading loading-spinner" />;
+
+  return (
+    <div class="space-y-4">
+      {err ? <div class="alert alert-error">{err}</div> : null}
+      <div class="card bg-base-100 shadow">
+        <div class="card-body">
+          <div class="flex items-center justify-between gap-2">
+            <div>
+              <div class="font-bold">{data.running ? `Playing entry ${data.index + 1}` : "Stopped"}</div>
+              {data.running && data.remainingMs !== undefined ? (
+                <div class="text-sm opacity-70">{Math.ceil(data.remainingMs / 1000)} s left</div>
+              ) : null}
+            </div>
+            <div class="flex gap-2">
+              <button class="btn btn-sm btn-primary" disabled={data.entries.length === 0} onClick={() => control("start")}>
+                Start
+              </button>
+              <button class="btn btn-sm" disabled={!data.running} onClick={() => control("next")}>
+                Next
+              </button>
+              <button class="btn btn-sm" disabled={!data.running} onClick={() => control("stop")}>
+                Stop
+              </button>
+            </div>
+          </div>
+        </div>
+      </div>
+
+      {entries.map((e, i) => (
+        <div class="card bg-base-100 shadow" key={i}>
+          <div class="card-body space-y-2">
+            <div class="flex items-center justify-between">
+              <div class="font-bold">Entry {i + 1}</div>
+              <button
+                class="btn btn-xs btn-ghost"
+                onClick={() => {
+                  setEntries(entries.filter((_, k) => k !== i));
+                  setParamText(paramText.filter((_, k) => k !== i));
+                }}
+              >
+                Remove
+              </button>
+            </div>
+            <select
+              class="select select-bordered select-sm w-full"
+              value={String(e.effectId)}
+              onChange={(x) => update(i, { effectId: Number((x.target as HTMLSelectElement).value) })}
+            >
+              {effects.map((f) => (
+                <option key={f.id} value={String(f.id)}>
+                  {f.displayName}
+                </option>
+              ))}
+            </select>
+            <div class="grid grid-cols-2 gap-2">
+              <label class="form-control">
+                <span class="label-text">Duration (s, 0 = hold)</span>
+                <input
+                  class="input input-bordered input-sm"
+                  type="number"
+                  min={0}
+                  max={65535}
+                  value={e.durationS}
+                  onChange={(x) => update(i, { durationS: Number((x.target as HTMLInputElement).value) })}
+                />
+              </label>
+              <label class="form-control">
+                <span class="label-text">Transition (ms, empty = default)</span>
+                <input
+                  class="input input-bordered input-sm"
+                  type="number"
+                  min={0}
+                  max={65534}
+                  value={e.transitionMs ?? ""}
+                  onChange={(x) => {
+                    const v = (x.target as HTMLInputElement).value;
+                    update(i, { transitionMs: v === "" ? undefined : Number(v) });
+                  }}
+                />
+              </label>
+            </div>
+            <label class="form-control">
+              <span class="label-text">Params (id=raw, up to {data.maxParams})</span>
+              <input
+                class="input input-bordered input-sm"
+                value={paramText[i] ?? ""}
+                onChange={(x) => setParamText(paramText.map((t, k) => (k === i ? (x.target as HTMLInputElement).value : t)))}
+              />
+            </label>
+          </div>
+        </div>
+      ))}
+
+      <div class="flex gap-2">
+        <button
+          class="btn btn-sm"
+          disabled={entries.length >= data.maxEntries || effects.length === 0}
+          onClick={() => {
+            setEntries([...entries, { effectId: effects[0].id, durationS: 60, params: [] }]);
+            setParamText([...paramText, ""]);
+          }}
+        >
+          Add Entry
+        </button>
+        <button class="btn btn-sm btn-primary" onClick={save}>
+          Save Playlist
+        </button>
+      </div>
+    </div>
+  );
+}
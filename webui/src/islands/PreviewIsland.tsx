@@ -0,0 +1,82 @@
+import { useEffect, useRef, useState } from "preact/hooks";
+import { apiGet } from "../lib/api";
+import { control } from "../lib/control";
+import { applyPreviewFrame } from "../lib/preview";
+
+type MappingPixels = { mappingVersion: string; width: number; height: number; ledCount: number; x: number[]; y: number[] };
+
+const kRates = [0, 5, 10, 20, 30];
+const kScale = 3;
+
+export default function PreviewIsland() {
+  const canvasRef = useRef<HTMLCanvasElement | null>(null);
+  const [mapping, setMapping] = useState<MappingPixels | null>(null);
+  const [fps, setFps] = useState(0);
+  const [received, setReceived] = useState(0);
+  const [err, setErr] = useState<string | null>(null);
+
+  useEffect(() => {
+    apiGet<MappingPixels>("/api/mapping/pixels")
+      .then(setMapping)
+      .catch((e) => setErr(String(e)));
+    return () => control.subscribePreview(0, null);
+  }, []);
+
+  useEffect(() => {
+    if (!mapping) return;
+    const frame = new Uint8Array(mapping.ledCount * 3);
+    let count = 0;
+    control.subscribePreview(fps, (msg) => {
+      if (!applyPreviewFrame(msg, frame)) return;
+      draw(frame);
+      count++;
+      if ((count & 7) === 0) setReceived(count);
+    });
+  }, [mapping, fps]);
+
+  function draw(frame: Uint8Array) {
+    const canvas = canvasRef.current;
+    if (!canvas || !mapping) return;
+    const ctx = canvas.getContext("2d");
+    if (!ctx) return;
+    ctx.fillStyle = "#000";
+    ctx.fillRect(0, 0, canvas.width, canvas.height);
+    for (let i = 0; i < mapping.ledCount; i++) {
+      const r = frame[i * 3], g = frame[i * 3 + 1], b = frame[i * 3 + 2];
+      if ((r | g | b) === 0) continue;
+      ctx.fillStyle = `rgb(${r},${g},${b})`;
+      ctx.fillRect(mapping.x[i] * kScale, mapping.y[i] * kScale, kScale, kScale);
+    }
+  }
+
+  if (err) return <div class="alert alert-error">{err}</div>;
+  if (!mapping) return <div class="loading loading-spinner" />;
+
+  return (
+    <div class="card bg-base-100 shadow">
+      <div class="card-body">
+        <div class="flex items-center justify-between gap-2">
+          <div class="font-bold">Live preview</div>
+          <select
+            class="select select-bordered select-sm"
+            value={fps}
+            onChange={(e) => setFps(parseInt((e.target as HTMLSelectElement).value, 10))}
+          >
+            {kRates.map((r) => (
+              <option key={r} value={r}>
+                {r === 0 ? "Off" : `${r} fps`}
+              </option>
+            ))}
+          </select>
+        </div>
+        <canvas
+          ref={canvasRef}
+          class="w-full bg-black rounded"
+          width={mapping.width * kScale}
+          height={mapping.height * kScale}
+        />
+        {fps > 0 ? <div class="text-xs opacity-70">{received} frames</div> : null}
+      </div>
+    </div>
+  );
+}
@@ -0,0 +1,102 @@
+// Persistent control channel (WebSocket on port 81) for streamed param edits and the live preview.
+//
+// Values are coalesced per param and flushed at most once per animation frame, so dragging a slider sends
+// one small binary frame per frame instead of one HTTP POST per input event. Callers fall back to the
+// REST endpoint when the socket is not open.
+
+const kControlPort = 81;
+const kParamFrameSet = 0x01;
+const kPreviewSubscribe = 0x02;
+const kPreviewFrame = 0x10;
+const kMaxRecordsPerFrame = 40;
+
+export class ControlChannel {
+  private ws: WebSocket | null = null;
+  private pending = new Map<number, Map<number, number>>();
+  private flushScheduled = false;
+  private retryTimer: number | null = null;
+  private previewFps = 0;
+  private previewHandler: ((msg: DataView) => void) | null = null;
+
+  connect() {
+    if (typeof window === "undefined" || this.ws) return;
+    const ws = new WebSocket(`ws://${window.location.hostname}:${kControlPort}/ws`);
+    ws.binaryType = "arraybuffer";
+    ws.onopen = () => this.sendPreviewSubscription();
+    ws.onmessage = (ev) => {
+      if (!(ev.data instanceof ArrayBuffer) || ev.data.byteLength < 1) return;
+      const dv = new DataView(ev.data);
+      if (dv.getUint8(0) === kPreviewFrame && this.previewHandler) this.previewHandler(dv);
+    };
+    ws.onclose = () => {
+      this.ws = null;
+      if (this.retryTimer === null) {
+        this.retryTimer = window.setTimeout(() => {
+          this.retryTimer = null;
+          this.connect();
+        }, 2000);
+      }
+    };
+    this.ws = ws;
+  }
+
+  isOpen(): boolean {
+    return this.ws !== null && this.ws.readyState === WebSocket.OPEN;
+  }
+
+  // Requests preview frames at up to fps (0 stops). The device may send fewer under backpressure.
+  subscribePreview(fps: number, handler: ((msg: DataView) => void) | null) {
+    this.previewFps = Math.max(0, Math.min(30, fps | 0));
+    this.previewHandler = handler;
+    this.connect();
+    this.sendPreviewSubscription();
+  }
+
+  private sendPreviewSubscription() {
+    if (!this.isOpen()) return;
+    this.ws!.send(new Uint8Array([kPreviewSubscribe, this.previewFps]));
+  }
+
+  // raw is in firmware units (UI value * scale; colors packed 0xRRGGBB; bools 0/1).
+  setParam(effectId: number, paramId: number, raw: number): boolean {
+    if (!this.isOpen()) return false;
+    let m = this.pending.get(effectId);
+    if (!m) {
+      m = new Map();
+      this.pending.set(effectId, m);
+    }
+    m.set(paramId, raw | 0);
+    if (!this.flushScheduled) {
+      this.flushScheduled = true;
+      requestAnimationFrame(() => this.flush());
+    }
+    return true;
+  }
+
+  private flush() {
+    this.flushScheduled = false;
+    if (!this.isOpen()) {
+      this.pending.clear();
+      return;
+    }
+    for (const [effectId, params] of this.pending) {
+      const entries = Array.from(params.entries());
+      for (let start = 0; start < entries.length; start += kMaxRecordsPerFrame) {
+        const chunk = entries.slice(start, start + kMaxRecordsPerFrame);
+        const buf = new ArrayBuffer(4 + chunk.length * 6);
+        const dv = new DataView(buf);
+        dv.setUint8(0, kParamFrameSet);
+        dv.setUint16(1, effectId, true);
+        dv.setUint8(3, chunk.length);
+        chunk.forEach(([pid, raw], i) => {
+          dv.setUint16(4 + i * 6, pid, true);
+          dv.setInt32(6 + i * 6, raw, true);
+        });
+        this.ws!.send(buf);
+      }
+    }
+    this.pending.clear();
+  }
+}
+
+export const control = new ControlChannel();
@@ -0,0 +1,46 @@
+// Decoder for the live preview stream (mirror of core/protocol/frame_delta.h).
+//
+// frame holds ledCount * 3 bytes (RGB) and is updated in place; deltas apply against the previous contents.
+
+const kFlagKeyframe = 0x01;
+const kOpSkip = 0;
+const kOpRun = 1;
+const kOpLiteral = 2;
+
+export function applyPreviewFrame(msg: DataView, frame: Uint8Array): boolean {
+  if (msg.byteLength < 6) return false;
+  const count = msg.getUint16(4, true);
+  if (count * 3 !== frame.length) return false;
+  if (msg.getUint8(1) & kFlagKeyframe) frame.fill(0);
+
+  let pos = 6;
+  let i = 0;
+  while (pos < msg.byteLength) {
+    const op = msg.getUint8(pos++);
+    const code = op >> 6;
+    const cnt = (op & 0x3f) + 1;
+    if (i + cnt > count) return false;
+    if (code === kOpSkip) {
+      i += cnt;
+    } else if (code === kOpRun) {
+      if (pos + 3 > msg.byteLength) return false;
+      const r = msg.getUint8(pos), g = msg.getUint8(pos + 1), b = msg.getUint8(pos + 2);
+      pos += 3;
+      for (let k = 0; k < cnt; k++, i++) {
+        frame[i * 3] = r;
+        frame[i * 3 + 1] = g;
+        frame[i * 3 + 2] = b;
+      }
+    } else if (code === kOpLiteral) {
+      if (pos + cnt * 3 > msg.byteLength) return false;
+      for (let k = 0; k < cnt; k++, i++, pos += 3) {
+        frame[i * 3] = msg.getUint8(pos);
+        frame[i * 3 + 1] = msg.getUint8(pos + 1);
+        frame[i * 3 + 2] = msg.getUint8(pos + 2);
+      }
+    } else {
+      return false;
+    }
+  }
+  return i === count;
+}